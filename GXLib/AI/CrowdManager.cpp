@@ -0,0 +1,733 @@
+#include "pch.h"
+/// @file CrowdManager.cpp
+/// @brief Crowd simulation with ORCA local avoidance
+
+#include "AI/CrowdManager.h"
+#include "AI/NavMesh.h"
+#include "AI/NavPolyMesh.h"
+#include "Core/Logger.h"
+
+namespace GX
+{
+
+namespace
+{
+
+constexpr float k_Epsilon = 1e-5f;
+constexpr int   k_ChunkSize = 64;   ///< Agents per ParallelFor work item
+constexpr int   k_MaxLines  = 16;   ///< Matches CrowdManager::k_MaxNeighbours
+constexpr float k_PerturbScale = 0.01f;   ///< Preferred velocity jitter (fraction of speed)
+
+// ============================================================================
+// ORCA linear programs (2D, after RVO2 by van den Berg et al.)
+// ============================================================================
+struct Vec2
+{
+    float x, y;
+};
+
+inline Vec2  operator+(Vec2 a, Vec2 b)   { return { a.x + b.x, a.y + b.y }; }
+inline Vec2  operator-(Vec2 a, Vec2 b)   { return { a.x - b.x, a.y - b.y }; }
+inline Vec2  operator-(Vec2 a)           { return { -a.x, -a.y }; }
+inline Vec2  operator*(Vec2 a, float s)  { return { a.x * s, a.y * s }; }
+inline Vec2  operator*(float s, Vec2 a)  { return { a.x * s, a.y * s }; }
+inline float Dot(Vec2 a, Vec2 b)         { return a.x * b.x + a.y * b.y; }
+inline float Det(Vec2 a, Vec2 b)         { return a.x * b.y - a.y * b.x; }
+inline float AbsSq(Vec2 a)               { return Dot(a, a); }
+inline Vec2  Normalize(Vec2 a)           { const float l = std::sqrt(AbsSq(a)); return l > 0.0f ? a * (1.0f / l) : a; }
+
+/// Half-plane: velocities on the left of direction through point are allowed
+struct OrcaLine
+{
+    Vec2 point;
+    Vec2 direction;
+};
+
+/// Optimize along line lineNo subject to lines [0, lineNo) and the speed circle
+bool LinearProgram1(const OrcaLine* lines, int lineNo, float radius, Vec2 optVelocity,
+                    bool directionOpt, Vec2& result)
+{
+    const OrcaLine& line = lines[lineNo];
+    const float dotProduct = Dot(line.point, line.direction);
+    const float discriminant = dotProduct * dotProduct + radius * radius - AbsSq(line.point);
+    if (discriminant < 0.0f)
+        return false;   // The speed circle fully invalidates this line
+
+    const float sqrtDiscriminant = std::sqrt(discriminant);
+    float tLeft  = -dotProduct - sqrtDiscriminant;
+    float tRight = -dotProduct + sqrtDiscriminant;
+
+    for (int i = 0; i < lineNo; ++i)
+    {
+        const float denominator = Det(line.direction, lines[i].direction);
+        const float numerator   = Det(lines[i].direction, line.point - lines[i].point);
+
+        if (std::abs(denominator) <= k_Epsilon)
+        {
+            // Parallel lines
+            if (numerator < 0.0f) return false;
+            continue;
+        }
+
+        const float t = numerator / denominator;
+        if (denominator >= 0.0f) tRight = std::min(tRight, t);
+        else                     tLeft  = std::max(tLeft, t);
+        if (tLeft > tRight)
+            return false;
+    }
+
+    if (directionOpt)
+    {
+        result = (Dot(optVelocity, line.direction) > 0.0f)
+            ? line.point + tRight * line.direction
+            : line.point + tLeft * line.direction;
+    }
+    else
+    {
+        const float t = Dot(line.direction, optVelocity - line.point);
+        if (t < tLeft)       result = line.point + tLeft * line.direction;
+        else if (t > tRight) result = line.point + tRight * line.direction;
+        else                 result = line.point + t * line.direction;
+    }
+    return true;
+}
+
+/// Solve the 2D LP; returns the index of the first failing line (lineCount on success)
+int LinearProgram2(const OrcaLine* lines, int lineCount, float radius, Vec2 optVelocity,
+                   bool directionOpt, Vec2& result)
+{
+    if (directionOpt)
+        result = optVelocity * radius;
+    else if (AbsSq(optVelocity) > radius * radius)
+        result = Normalize(optVelocity) * radius;
+    else
+        result = optVelocity;
+
+    for (int i = 0; i < lineCount; ++i)
+    {
+        if (Det(lines[i].direction, lines[i].point - result) > 0.0f)
+        {
+            const Vec2 tempResult = result;
+            if (!LinearProgram1(lines, i, radius, optVelocity, directionOpt, result))
+            {
+                result = tempResult;
+                return i;
+            }
+        }
+    }
+    return lineCount;
+}
+
+/// Infeasible case: minimize the maximum violation of the remaining lines
+void LinearProgram3(const OrcaLine* lines, int lineCount, int beginLine, float radius, Vec2& result)
+{
+    OrcaLine projLines[k_MaxLines];
+    float distance = 0.0f;
+
+    for (int i = beginLine; i < lineCount; ++i)
+    {
+        if (Det(lines[i].direction, lines[i].point - result) <= distance)
+            continue;
+
+        int projCount = 0;
+        for (int j = 0; j < i; ++j)
+        {
+            OrcaLine line;
+            const float determinant = Det(lines[i].direction, lines[j].direction);
+            if (std::abs(determinant) <= k_Epsilon)
+            {
+                if (Dot(lines[i].direction, lines[j].direction) > 0.0f)
+                    continue;   // Same direction
+                line.point = 0.5f * (lines[i].point + lines[j].point);
+            }
+            else
+            {
+                line.point = lines[i].point +
+                    (Det(lines[j].direction, lines[i].point - lines[j].point) / determinant) * lines[i].direction;
+            }
+            line.direction = Normalize(lines[j].direction - lines[i].direction);
+            projLines[projCount++] = line;
+        }
+
+        const Vec2 tempResult = result;
+        if (LinearProgram2(projLines, projCount, radius, { -lines[i].direction.y, lines[i].direction.x },
+                           true, result) < projCount)
+        {
+            // Should not happen in theory; keep the previous result on numerical trouble
+            result = tempResult;
+        }
+        distance = Det(lines[i].direction, lines[i].point - result);
+    }
+}
+
+} // anonymous namespace
+
+CrowdManager::~CrowdManager()
+{
+    Shutdown();
+}
+
+// ============================================================================
+// Initialize / Shutdown
+// ============================================================================
+void CrowdManager::Initialize(uint32_t maxAgents, const CrowdConfig& config)
+{
+    Shutdown();
+
+    m_config = config;
+    m_config.maxNeighbours = std::max(0, std::min(k_MaxNeighbours, config.maxNeighbours));
+    m_hashCellSize = std::max(0.1f, config.neighbourDist);
+
+    for (auto* v : { &m_posX, &m_posY, &m_posZ, &m_velX, &m_velZ, &m_prefVelX, &m_prefVelZ,
+                     &m_newVelX, &m_newVelZ, &m_radius, &m_maxSpeed, &m_height })
+        v->reserve(maxAgents);
+    m_paths.reserve(maxAgents);
+    m_pathIndex.reserve(maxAgents);
+    m_indexToId.reserve(maxAgents);
+
+    uint32_t workerCount = config.workerCount;
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+    // Workers start from the current generation: a job published before a new
+    // thread first runs must still be picked up by it
+    m_running = true;
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_workers.emplace_back(&CrowdManager::WorkerLoop, this, m_jobGeneration);
+
+    Logger::Info("CrowdManager::Initialize - %u agents reserved, %u worker threads", maxAgents, workerCount);
+}
+
+void CrowdManager::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_running = false;
+    }
+    m_jobCv.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+
+    for (auto* v : { &m_posX, &m_posY, &m_posZ, &m_velX, &m_velZ, &m_prefVelX, &m_prefVelZ,
+                     &m_newVelX, &m_newVelZ, &m_radius, &m_maxSpeed, &m_height })
+        v->clear();
+    m_paths.clear();
+    m_pathIndex.clear();
+    m_indexToId.clear();
+    m_idToIndex.clear();
+    m_freeIds.clear();
+}
+
+// ============================================================================
+// Agents
+// ============================================================================
+CrowdAgentId CrowdManager::AddAgent(const XMFLOAT3& position, const CrowdAgentParams& params)
+{
+    CrowdAgentId id;
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<CrowdAgentId>(m_idToIndex.size());
+        m_idToIndex.push_back(-1);
+    }
+
+    m_idToIndex[id] = static_cast<int>(m_posX.size());
+    m_indexToId.push_back(id);
+    m_posX.push_back(position.x);
+    m_posY.push_back(position.y + params.height);
+    m_posZ.push_back(position.z);
+    m_velX.push_back(0.0f);
+    m_velZ.push_back(0.0f);
+    m_prefVelX.push_back(0.0f);
+    m_prefVelZ.push_back(0.0f);
+    m_newVelX.push_back(0.0f);
+    m_newVelZ.push_back(0.0f);
+    m_radius.push_back(params.radius);
+    m_maxSpeed.push_back(params.maxSpeed);
+    m_height.push_back(params.height);
+    m_paths.emplace_back();
+    m_pathIndex.push_back(0);
+    return id;
+}
+
+void CrowdManager::RemoveAgent(CrowdAgentId id)
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return;
+
+    // Swap the last agent into the freed slot to keep the arrays dense
+    const int index = m_idToIndex[id];
+    const int last  = static_cast<int>(m_posX.size()) - 1;
+    auto moveLast = [index, last](auto& v) {
+        if (index != last) v[index] = std::move(v[last]);
+        v.pop_back();
+    };
+    moveLast(m_posX);     moveLast(m_posY);     moveLast(m_posZ);
+    moveLast(m_velX);     moveLast(m_velZ);
+    moveLast(m_prefVelX); moveLast(m_prefVelZ);
+    moveLast(m_newVelX);  moveLast(m_newVelZ);
+    moveLast(m_radius);   moveLast(m_maxSpeed); moveLast(m_height);
+    moveLast(m_paths);    moveLast(m_pathIndex);
+    moveLast(m_indexToId);
+
+    if (index != last)
+        m_idToIndex[m_indexToId[index]] = index;
+    m_idToIndex[id] = -1;
+    m_freeIds.push_back(id);
+}
+
+bool CrowdManager::SetTarget(CrowdAgentId id, const XMFLOAT3& target)
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return false;
+
+    const int i = m_idToIndex[id];
+    const XMFLOAT3 position = { m_posX[i], m_posY[i] - m_height[i], m_posZ[i] };
+    std::vector<XMFLOAT3> path;
+
+    if (m_navMesh)
+    {
+        if (!m_navMesh->FindPath(position, target, path))
+        {
+            // Same fallback as NavAgent: go to the nearest walkable cell instead
+            XMFLOAT3 nearTarget;
+            if (m_navMesh->FindNearestWalkable(target, nearTarget))
+                m_navMesh->FindPath(position, nearTarget, path);
+        }
+    }
+    else if (m_polyMesh)
+    {
+        m_polyMesh->FindPath(position, target, path);
+    }
+    else
+    {
+        path.push_back(position);
+        path.push_back(target);
+    }
+
+    m_paths[i] = std::move(path);
+    m_pathIndex[i] = m_paths[i].size() > 1 ? 1 : 0;   // The first waypoint is the start position
+    return !m_paths[i].empty();
+}
+
+void CrowdManager::ResetTarget(CrowdAgentId id)
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return;
+    const int i = m_idToIndex[id];
+    m_paths[i].clear();
+    m_pathIndex[i] = 0;
+}
+
+XMFLOAT3 CrowdManager::GetPosition(CrowdAgentId id) const
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return { 0.0f, 0.0f, 0.0f };
+    const int i = m_idToIndex[id];
+    return { m_posX[i], m_posY[i], m_posZ[i] };
+}
+
+XMFLOAT3 CrowdManager::GetVelocity(CrowdAgentId id) const
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return { 0.0f, 0.0f, 0.0f };
+    const int i = m_idToIndex[id];
+    return { m_velX[i], 0.0f, m_velZ[i] };
+}
+
+bool CrowdManager::HasReachedTarget(CrowdAgentId id) const
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return false;
+    const int i = m_idToIndex[id];
+    return !m_paths[i].empty() && m_pathIndex[i] >= static_cast<int>(m_paths[i].size());
+}
+
+void CrowdManager::SetPosition(CrowdAgentId id, const XMFLOAT3& position)
+{
+    if (id < 0 || id >= static_cast<int>(m_idToIndex.size()) || m_idToIndex[id] < 0)
+        return;
+    const int i = m_idToIndex[id];
+    m_posX[i] = position.x;
+    m_posY[i] = position.y + m_height[i];
+    m_posZ[i] = position.z;
+}
+
+// ============================================================================
+// Update
+// ============================================================================
+void CrowdManager::Update(float deltaTime)
+{
+    const int count = static_cast<int>(m_posX.size());
+    if (count == 0 || deltaTime <= 0.0f)
+        return;
+
+    ++m_frame;
+
+    // Neighbours are found from the positions at the start of the frame
+    BuildSpatialHash();
+
+    // Every agent reads its neighbours' current velocities and writes only its own new one
+    ParallelFor(count, [this, deltaTime](int begin, int end) {
+        ComputePreferredVelocities(begin, end);
+        ComputeNewVelocities(begin, end, deltaTime);
+    });
+
+    ParallelFor(count, [this, deltaTime](int begin, int end) {
+        Integrate(begin, end, deltaTime);
+    });
+}
+
+void CrowdManager::ComputePreferredVelocities(int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const auto& path = m_paths[i];
+        const int index = m_pathIndex[i];
+        if (index >= static_cast<int>(path.size()))
+        {
+            m_prefVelX[i] = m_prefVelZ[i] = 0.0f;
+            continue;
+        }
+
+        const float dx = path[index].x - m_posX[i];
+        const float dz = path[index].z - m_posZ[i];
+        const float dist = std::sqrt(dx * dx + dz * dz);
+        if (dist < k_Epsilon)
+        {
+            m_prefVelX[i] = m_prefVelZ[i] = 0.0f;
+            continue;
+        }
+
+        // Slow down on the final approach (reach the target in about half a second)
+        float speed = m_maxSpeed[i];
+        if (index == static_cast<int>(path.size()) - 1)
+            speed = std::min(speed, dist * 2.0f);
+
+        // Tiny per-agent, per-frame perturbation so symmetric crowds do not lock in equilibrium
+        uint32_t h = static_cast<uint32_t>(m_indexToId[i]) * 2654435761u ^ m_frame * 40503u;
+        h ^= h >> 15; h *= 2246822519u; h ^= h >> 13;
+        const float angle = static_cast<float>(h & 0xffff) * (XM_2PI / 65536.0f);
+        const float jitter = k_PerturbScale * speed;
+        m_prefVelX[i] = dx / dist * speed + std::cos(angle) * jitter;
+        m_prefVelZ[i] = dz / dist * speed + std::sin(angle) * jitter;
+    }
+}
+
+void CrowdManager::BuildSpatialHash()
+{
+    const int count = static_cast<int>(m_posX.size());
+
+    uint32_t hashSize = 64;
+    while (hashSize < static_cast<uint32_t>(count) * 2)
+        hashSize <<= 1;
+    m_hashSize = hashSize;
+
+    // Counting sort of agents by bucket: count in parallel, exclusive prefix sum
+    // (bucket starts), scatter in parallel, then restore index order inside each
+    // bucket so neighbour scans do not depend on thread scheduling
+    const float invCell = 1.0f / m_hashCellSize;
+    m_agentBucket.resize(count);
+    m_bucketStart.assign(static_cast<size_t>(m_hashSize) + 1, 0);
+    ParallelFor(count, [this, invCell](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            const int cx = static_cast<int>(std::floor(m_posX[i] * invCell));
+            const int cz = static_cast<int>(std::floor(m_posZ[i] * invCell));
+            m_agentBucket[i] = HashCell(cx, cz);
+            std::atomic_ref<uint32_t>(m_bucketStart[m_agentBucket[i]]).fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    uint32_t sum = 0;
+    for (uint32_t b = 0; b <= m_hashSize; ++b)
+    {
+        const uint32_t n = m_bucketStart[b];
+        m_bucketStart[b] = sum;
+        sum += n;
+    }
+    m_bucketCursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+
+    m_sortedAgents.resize(count);
+    ParallelFor(count, [this](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            const uint32_t slot = std::atomic_ref<uint32_t>(m_bucketCursor[m_agentBucket[i]]).fetch_add(1, std::memory_order_relaxed);
+            m_sortedAgents[slot] = i;
+        }
+    });
+
+    ParallelFor(static_cast<int>(m_hashSize), [this](int begin, int end) {
+        for (int b = begin; b < end; ++b)
+        {
+            if (m_bucketStart[b + 1] - m_bucketStart[b] > 1)
+                std::sort(m_sortedAgents.begin() + m_bucketStart[b], m_sortedAgents.begin() + m_bucketStart[b + 1]);
+        }
+    });
+}
+
+void CrowdManager::ComputeNewVelocities(int begin, int end, float deltaTime)
+{
+    const float invCell = 1.0f / m_hashCellSize;
+    const float invTimeHorizon = 1.0f / m_config.timeHorizon;
+    const float invTimeStep = 1.0f / deltaTime;
+    const int maxNeighbours = m_config.maxNeighbours;
+
+    int   neighbours[k_MaxNeighbours];
+    float neighbourDistSq[k_MaxNeighbours];
+    OrcaLine lines[k_MaxNeighbours];
+
+    for (int i = begin; i < end; ++i)
+    {
+        const Vec2 position = { m_posX[i], m_posZ[i] };
+        const Vec2 velocity = { m_velX[i], m_velZ[i] };
+        const Vec2 prefVelocity = { m_prefVelX[i], m_prefVelZ[i] };
+        const float radius = m_radius[i];
+        const float maxSpeed = m_maxSpeed[i];
+
+        // k nearest neighbours from the 3x3 cells around the agent
+        int neighbourCount = 0;
+        float rangeSq = m_config.neighbourDist * m_config.neighbourDist;
+        if (maxNeighbours > 0)
+        {
+            const int cx = static_cast<int>(std::floor(position.x * invCell));
+            const int cz = static_cast<int>(std::floor(position.y * invCell));
+            uint32_t visited[9];
+            int visitedCount = 0;
+
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    // Distinct cells can share a bucket; scan each bucket once
+                    const uint32_t bucket = HashCell(cx + dx, cz + dz);
+                    if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount)
+                        continue;
+                    visited[visitedCount++] = bucket;
+
+                    for (uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; ++k)
+                    {
+                        const int j = m_sortedAgents[k];
+                        if (j == i) continue;
+                        const float ox = m_posX[j] - position.x;
+                        const float oz = m_posZ[j] - position.y;
+                        const float distSq = ox * ox + oz * oz;
+                        if (distSq >= rangeSq) continue;
+
+                        // Insertion into the sorted neighbour list
+                        int slot = neighbourCount < maxNeighbours ? neighbourCount++ : maxNeighbours - 1;
+                        while (slot > 0 && neighbourDistSq[slot - 1] > distSq)
+                        {
+                            neighbours[slot] = neighbours[slot - 1];
+                            neighbourDistSq[slot] = neighbourDistSq[slot - 1];
+                            --slot;
+                        }
+                        neighbours[slot] = j;
+                        neighbourDistSq[slot] = distSq;
+                        if (neighbourCount == maxNeighbours)
+                            rangeSq = neighbourDistSq[neighbourCount - 1];
+                    }
+                }
+            }
+        }
+
+        // One ORCA half-plane per neighbour (each agent takes half the responsibility)
+        for (int n = 0; n < neighbourCount; ++n)
+        {
+            const int j = neighbours[n];
+            const Vec2 relativePosition = { m_posX[j] - position.x, m_posZ[j] - position.y };
+            const Vec2 relativeVelocity = velocity - Vec2{ m_velX[j], m_velZ[j] };
+            const float distSq = AbsSq(relativePosition);
+            const float combinedRadius = radius + m_radius[j];
+            const float combinedRadiusSq = combinedRadius * combinedRadius;
+
+            OrcaLine& line = lines[n];
+            Vec2 u;
+            if (distSq > combinedRadiusSq)
+            {
+                // No collision yet: vector from cutoff center to relative velocity
+                const Vec2 w = relativeVelocity - invTimeHorizon * relativePosition;
+                const float wLengthSq = AbsSq(w);
+                const float dotProduct1 = Dot(w, relativePosition);
+
+                if (dotProduct1 < 0.0f && dotProduct1 * dotProduct1 > combinedRadiusSq * wLengthSq)
+                {
+                    // Project on the cut-off circle
+                    const float wLength = std::sqrt(wLengthSq);
+                    const Vec2 unitW = w * (1.0f / wLength);
+                    line.direction = { unitW.y, -unitW.x };
+                    u = (combinedRadius * invTimeHorizon - wLength) * unitW;
+                }
+                else
+                {
+                    // Project on the legs of the velocity obstacle
+                    const float leg = std::sqrt(distSq - combinedRadiusSq);
+                    if (Det(relativePosition, w) > 0.0f)
+                    {
+                        line.direction = Vec2{ relativePosition.x * leg - relativePosition.y * combinedRadius,
+                                               relativePosition.x * combinedRadius + relativePosition.y * leg } * (1.0f / distSq);
+                    }
+                    else
+                    {
+                        line.direction = -Vec2{ relativePosition.x * leg + relativePosition.y * combinedRadius,
+                                                -relativePosition.x * combinedRadius + relativePosition.y * leg } * (1.0f / distSq);
+                    }
+                    const float dotProduct2 = Dot(relativeVelocity, line.direction);
+                    u = dotProduct2 * line.direction - relativeVelocity;
+                }
+            }
+            else
+            {
+                // Already overlapping: resolve within one time step
+                const Vec2 w = relativeVelocity - invTimeStep * relativePosition;
+                const float wLength = std::sqrt(AbsSq(w));
+                const Vec2 unitW = wLength > k_Epsilon ? w * (1.0f / wLength) : Vec2{ 1.0f, 0.0f };
+                line.direction = { unitW.y, -unitW.x };
+                u = (combinedRadius * invTimeStep - wLength) * unitW;
+            }
+            line.point = velocity + 0.5f * u;
+        }
+
+        Vec2 newVelocity;
+        const int lineFail = LinearProgram2(lines, neighbourCount, maxSpeed, prefVelocity, false, newVelocity);
+        if (lineFail < neighbourCount)
+            LinearProgram3(lines, neighbourCount, lineFail, maxSpeed, newVelocity);
+
+        m_newVelX[i] = newVelocity.x;
+        m_newVelZ[i] = newVelocity.y;
+    }
+}
+
+void CrowdManager::Integrate(int begin, int end, float deltaTime)
+{
+    const float arrival = m_config.arrivalDistance;
+
+    for (int i = begin; i < end; ++i)
+    {
+        float vx = m_newVelX[i];
+        float vz = m_newVelZ[i];
+        float nx = m_posX[i] + vx * deltaTime;
+        float nz = m_posZ[i] + vz * deltaTime;
+
+        // Avoidance may push agents off the grid: slide along the blocked axis instead
+        if (m_navMesh && !m_navMesh->IsWalkable({ nx, m_posY[i], nz }))
+        {
+            if (m_navMesh->IsWalkable({ nx, m_posY[i], m_posZ[i] }))
+            {
+                nz = m_posZ[i];
+                vz = 0.0f;
+            }
+            else if (m_navMesh->IsWalkable({ m_posX[i], m_posY[i], nz }))
+            {
+                nx = m_posX[i];
+                vx = 0.0f;
+            }
+            else
+            {
+                nx = m_posX[i];
+                nz = m_posZ[i];
+                vx = vz = 0.0f;
+            }
+        }
+
+        m_posX[i] = nx;
+        m_posZ[i] = nz;
+        m_velX[i] = vx;
+        m_velZ[i] = vz;
+
+        // Advance along the path; intermediate waypoints only need to be passed nearby
+        const auto& path = m_paths[i];
+        int& index = m_pathIndex[i];
+        const int pathSize = static_cast<int>(path.size());
+        while (index < pathSize)
+        {
+            const float dx = path[index].x - nx;
+            const float dz = path[index].z - nz;
+            const float reach = (index == pathSize - 1) ? arrival : arrival + m_radius[i];
+            if (dx * dx + dz * dz > reach * reach)
+                break;
+            ++index;
+        }
+
+        // Height: interpolate between the surrounding waypoints
+        if (pathSize > 0)
+        {
+            const XMFLOAT3& to   = path[std::min(index, pathSize - 1)];
+            const XMFLOAT3& from = path[std::max(0, std::min(index, pathSize - 1) - 1)];
+            const float segX = to.x - from.x, segZ = to.z - from.z;
+            const float segLen2 = segX * segX + segZ * segZ;
+            float t = segLen2 > 1e-8f ? ((nx - from.x) * segX + (nz - from.z) * segZ) / segLen2 : 1.0f;
+            t = std::max(0.0f, std::min(1.0f, t));
+            m_posY[i] = from.y + (to.y - from.y) * t + m_height[i];
+        }
+    }
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+void CrowdManager::ParallelFor(int count, const std::function<void(int, int)>& fn)
+{
+    if (m_workers.empty() || count <= k_ChunkSize)
+    {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_job = &fn;
+        m_jobCount = count;
+        m_jobNext.store(0);
+        m_activeWorkers = static_cast<uint32_t>(m_workers.size());
+        ++m_jobGeneration;
+    }
+    m_jobCv.notify_all();
+
+    // The calling thread takes chunks too
+    for (int begin = m_jobNext.fetch_add(k_ChunkSize); begin < count; begin = m_jobNext.fetch_add(k_ChunkSize))
+        fn(begin, std::min(begin + k_ChunkSize, count));
+
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    m_doneCv.wait(lock, [this]() { return m_activeWorkers == 0; });
+    m_job = nullptr;
+}
+
+void CrowdManager::WorkerLoop(uint64_t seenGeneration)
+{
+    while (true)
+    {
+        const std::function<void(int, int)>* job;
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCv.wait(lock, [&]() { return !m_running || m_jobGeneration != seenGeneration; });
+            if (!m_running)
+                return;
+            seenGeneration = m_jobGeneration;
+            job = m_job;
+            count = m_jobCount;
+        }
+
+        for (int begin = m_jobNext.fetch_add(k_ChunkSize); begin < count; begin = m_jobNext.fetch_add(k_ChunkSize))
+            (*job)(begin, std::min(begin + k_ChunkSize, count));
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            last = --m_activeWorkers == 0;
+        }
+        if (last)
+            m_doneCv.notify_one();
+    }
+}
+
+} // namespace GX
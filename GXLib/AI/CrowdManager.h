@@ -0,0 +1,160 @@
+#pragma once
+/// @file CrowdManager.h
+/// @brief Crowd simulation with ORCA (RVO2-style) local avoidance
+///
+/// Owns many agents in structure-of-arrays storage. Each Update():
+///   1. steers every agent toward its next path waypoint (preferred velocity),
+///   2. buckets agents into a spatial hash and gathers the nearest neighbours,
+///   3. solves the ORCA half-plane linear program for a collision-free velocity,
+///   4. integrates positions (rejecting moves into unwalkable NavMesh cells).
+/// Steps 1, 3 and 4 run on persistent worker threads.
+/// Global paths come from a NavMesh or NavPolyMesh; avoidance is local only.
+
+#include "pch.h"
+
+namespace GX
+{
+
+class NavMesh;
+class NavPolyMesh;
+
+/// @brief Crowd agent handle (-1 = invalid)
+using CrowdAgentId = int;
+
+/// @brief Simulation-wide crowd parameters
+struct CrowdConfig
+{
+    float    neighbourDist = 4.0f;   ///< Neighbour search radius (also the hash cell size)
+    int      maxNeighbours = 10;     ///< Neighbours considered per agent (nearest first, max 16)
+    float    timeHorizon   = 2.0f;   ///< Seconds of look-ahead for agent-agent avoidance
+    float    arrivalDistance = 0.3f; ///< Distance at which a waypoint counts as reached
+    uint32_t workerCount   = 0;      ///< Worker threads (0 = hardware threads - 1)
+};
+
+/// @brief Per-agent parameters
+struct CrowdAgentParams
+{
+    float radius   = 0.4f;   ///< Collision radius
+    float maxSpeed = 3.5f;   ///< Maximum speed (units/sec)
+    float height   = 0.0f;   ///< Y offset above the path surface
+};
+
+/// @brief Crowd of agents with reciprocal collision avoidance
+class CrowdManager
+{
+public:
+    CrowdManager() = default;
+    ~CrowdManager();
+
+    CrowdManager(const CrowdManager&) = delete;
+    CrowdManager& operator=(const CrowdManager&) = delete;
+
+    /// @brief Start the worker threads and reserve agent storage
+    /// @param maxAgents Initial capacity (grows on demand)
+    /// @param config    Simulation parameters
+    void Initialize(uint32_t maxAgents, const CrowdConfig& config = {});
+
+    /// @brief Stop the workers and remove every agent
+    void Shutdown();
+
+    /// @brief Use a grid NavMesh for paths and walkability (must outlive the crowd)
+    void SetNavMesh(const NavMesh* navMesh) { m_navMesh = navMesh; m_polyMesh = nullptr; }
+
+    /// @brief Use a polygon navmesh for paths (must outlive the crowd)
+    void SetNavMesh(const NavPolyMesh* polyMesh) { m_polyMesh = polyMesh; m_navMesh = nullptr; }
+
+    /// @brief Add an agent
+    /// @return Agent handle
+    CrowdAgentId AddAgent(const XMFLOAT3& position, const CrowdAgentParams& params = {});
+
+    /// @brief Remove an agent (its handle may be reused later)
+    void RemoveAgent(CrowdAgentId id);
+
+    /// @brief Plan a path to a target (straight line if no navmesh is set)
+    /// @return false if the handle is invalid or no path was found
+    bool SetTarget(CrowdAgentId id, const XMFLOAT3& target);
+
+    /// @brief Clear an agent's path; it stops (while still yielding to others)
+    void ResetTarget(CrowdAgentId id);
+
+    /// @brief Advance the simulation
+    /// @param deltaTime Frame delta time in seconds
+    void Update(float deltaTime);
+
+    /// @brief Current world position of an agent
+    XMFLOAT3 GetPosition(CrowdAgentId id) const;
+
+    /// @brief Current velocity of an agent (XZ, y = 0)
+    XMFLOAT3 GetVelocity(CrowdAgentId id) const;
+
+    /// @brief Check whether an agent has reached the end of its path
+    bool HasReachedTarget(CrowdAgentId id) const;
+
+    /// @brief Teleport an agent (keeps its path)
+    void SetPosition(CrowdAgentId id, const XMFLOAT3& position);
+
+    /// @brief Number of live agents
+    uint32_t GetAgentCount() const { return static_cast<uint32_t>(m_posX.size()); }
+
+    /// @brief Number of worker threads (excluding the calling thread)
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+    const CrowdConfig& GetConfig() const { return m_config; }
+
+private:
+    static constexpr int k_MaxNeighbours = 16;
+
+    /// Run fn(begin, end) over [0, count) on the workers and the calling thread
+    void ParallelFor(int count, const std::function<void(int, int)>& fn);
+    void WorkerLoop(uint64_t seenGeneration);
+
+    void ComputePreferredVelocities(int begin, int end);
+    void BuildSpatialHash();
+    void ComputeNewVelocities(int begin, int end, float deltaTime);
+    void Integrate(int begin, int end, float deltaTime);
+
+    uint32_t HashCell(int cellX, int cellZ) const
+    {
+        const uint32_t h = static_cast<uint32_t>(cellX) * 73856093u ^ static_cast<uint32_t>(cellZ) * 19349663u;
+        return h & (m_hashSize - 1);
+    }
+
+    CrowdConfig m_config;
+    const NavMesh* m_navMesh = nullptr;
+    const NavPolyMesh* m_polyMesh = nullptr;
+    uint32_t m_frame = 0;              ///< Seeds the preferred-velocity perturbation
+
+    // Agent data (dense, index = slot; handles map through m_idToIndex)
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velZ;
+    std::vector<float> m_prefVelX, m_prefVelZ;
+    std::vector<float> m_newVelX, m_newVelZ;
+    std::vector<float> m_radius, m_maxSpeed, m_height;
+    std::vector<std::vector<XMFLOAT3>> m_paths;
+    std::vector<int> m_pathIndex;
+    std::vector<CrowdAgentId> m_indexToId;
+    std::vector<int> m_idToIndex;      ///< -1 for free handles
+    std::vector<CrowdAgentId> m_freeIds;
+
+    // Spatial hash (rebuilt every Update by a parallel counting sort)
+    float m_hashCellSize = 4.0f;
+    uint32_t m_hashSize = 0;            ///< Power of two
+    std::vector<uint32_t> m_agentBucket;
+    std::vector<uint32_t> m_bucketStart;
+    std::vector<uint32_t> m_bucketCursor;   ///< Next free slot per bucket while scattering
+    std::vector<int> m_sortedAgents;
+
+    // Persistent workers
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCv;
+    std::condition_variable m_doneCv;
+    bool m_running = false;
+    uint64_t m_jobGeneration = 0;
+    uint32_t m_activeWorkers = 0;
+    const std::function<void(int, int)>* m_job = nullptr;
+    int m_jobCount = 0;
+    std::atomic<int> m_jobNext{ 0 };
+};
+
+} // namespace GX
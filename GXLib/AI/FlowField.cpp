@@ -0,0 +1,520 @@
+#include "pch.h"
+/// @file FlowField.cpp
+/// @brief Flow-field pathfinding on a NavMesh grid
+
+#include "AI/FlowField.h"
+#include "AI/NavMesh.h"
+#include "AI/PathQueryContext.h"
+#include "Core/Logger.h"
+#include <queue>
+
+namespace GX
+{
+
+namespace
+{
+// 8-neighbour offsets (same order as NavMesh::SearchCluster; index 7 - k is the opposite step)
+constexpr int   k_DX[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+constexpr int   k_DZ[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+constexpr float k_MoveCost[] = { 1.414f, 1.0f, 1.414f, 1.0f, 1.0f, 1.414f, 1.0f, 1.414f };
+constexpr float k_InvSqrt2 = 0.70710678f;
+}
+
+FlowField::~FlowField()
+{
+    Shutdown();
+}
+
+// ============================================================================
+// Initialize / Shutdown
+// ============================================================================
+bool FlowField::Initialize(const NavMesh* navMesh)
+{
+    Shutdown();
+    if (!navMesh)
+    {
+        Logger::Error("FlowField::Initialize - navMesh is null");
+        return false;
+    }
+
+    m_navMesh = navMesh;
+    m_running = true;
+    m_worker = std::thread(&FlowField::WorkerLoop, this);
+    return true;
+}
+
+void FlowField::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hasGoal = false;
+    m_goalCell = -1;
+    m_goalDirty = false;
+    m_goalField.reset();
+    m_sectors.clear();
+    m_sectorQueued.clear();
+    m_sectorQueue.clear();
+    m_navMesh = nullptr;
+}
+
+// ============================================================================
+// Goal
+// ============================================================================
+void FlowField::SetGoal(const XMFLOAT3& goal)
+{
+    if (!m_navMesh || !m_navMesh->IsBuilt())
+        return;
+
+    XMFLOAT3 target = goal;
+    if (!m_navMesh->IsWalkable(target) && !m_navMesh->FindNearestWalkable(goal, target))
+        return;
+
+    int cellX, cellZ;
+    m_navMesh->GetCellAt(target, cellX, cellZ);
+    const int cell = cellZ * m_navMesh->GetGridWidth() + cellX;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_goal = target;
+        // Same cell: the fields are unchanged, only the final approach point moves
+        if (m_hasGoal && cell == m_goalCell)
+            return;
+        m_hasGoal = true;
+        m_goalCell = cell;
+        ResetLocked();
+    }
+    m_cv.notify_all();
+}
+
+void FlowField::ClearGoal()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ResetLocked();
+    m_hasGoal = false;
+    m_goalCell = -1;
+    m_goalDirty = false;
+}
+
+void FlowField::Invalidate()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasGoal)
+            return;
+        ResetLocked();
+    }
+    m_cv.notify_all();
+}
+
+void FlowField::ResetLocked()
+{
+    ++m_revision;
+    m_goalDirty = true;
+    m_goalField.reset();
+    m_sectors.clear();
+    m_sectorQueued.clear();
+    m_sectorQueue.clear();
+}
+
+bool FlowField::HasGoal() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasGoal;
+}
+
+XMFLOAT3 FlowField::GetGoal() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_goal;
+}
+
+uint32_t FlowField::GetGoalRevision() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_revision;
+}
+
+uint32_t FlowField::GetComputedSectorCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(std::count_if(m_sectors.begin(), m_sectors.end(),
+        [](const std::shared_ptr<const Sector>& s) { return s != nullptr; }));
+}
+
+uint32_t FlowField::GetSectorCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_sectors.size());
+}
+
+// ============================================================================
+// Sample
+// ============================================================================
+FlowFieldStatus FlowField::Sample(const XMFLOAT3& position, XMFLOAT3& direction, float* surfaceY)
+{
+    direction = { 0.0f, 0.0f, 0.0f };
+    if (!m_navMesh)
+        return FlowFieldStatus::NoGoal;
+
+    int cellX, cellZ;
+    if (!m_navMesh->GetCellAt(position, cellX, cellZ))
+        return FlowFieldStatus::NoGoal;
+
+    bool queued = false;
+    FlowFieldStatus status;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasGoal)
+            return FlowFieldStatus::NoGoal;
+        if (!m_goalField)
+            return FlowFieldStatus::Pending;
+
+        const int sectorIndex = SectorIndexOf(cellX, cellZ);
+        const Sector* sector = m_sectors[sectorIndex].get();
+        if (!sector)
+        {
+            // Compute on demand: only sectors that agents actually visit are built
+            if (!m_sectorQueued[sectorIndex])
+            {
+                m_sectorQueued[sectorIndex] = 1;
+                m_sectorQueue.push_back(sectorIndex);
+                queued = true;
+            }
+            status = FlowFieldStatus::Pending;
+        }
+        else
+        {
+            const int local = (cellZ - sector->minZ) * sector->width + (cellX - sector->minX);
+            const uint8_t code = sector->direction[local];
+            if (code == k_DirNone)
+            {
+                status = FlowFieldStatus::Unreachable;
+            }
+            else if (code == k_DirGoal)
+            {
+                const float dx = m_goal.x - position.x;
+                const float dz = m_goal.z - position.z;
+                const float len = std::sqrt(dx * dx + dz * dz);
+                if (len > 1e-4f)
+                    direction = { dx / len, 0.0f, dz / len };
+                status = FlowFieldStatus::Ready;
+            }
+            else
+            {
+                const float scale = (k_DX[code] != 0 && k_DZ[code] != 0) ? k_InvSqrt2 : 1.0f;
+                direction = { k_DX[code] * scale, 0.0f, k_DZ[code] * scale };
+                status = FlowFieldStatus::Ready;
+            }
+
+            if (surfaceY)
+                *surfaceY = m_navMesh->m_grid[static_cast<size_t>(cellZ) * m_navMesh->m_gridWidth + cellX].height;
+        }
+    }
+    if (queued)
+        m_cv.notify_all();
+    return status;
+}
+
+bool FlowField::GetCostToGoal(const XMFLOAT3& position, float& cost) const
+{
+    int cellX, cellZ;
+    if (!m_navMesh || !m_navMesh->GetCellAt(position, cellX, cellZ))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasGoal || !m_goalField)
+        return false;
+    const Sector* sector = m_sectors[SectorIndexOf(cellX, cellZ)].get();
+    if (!sector)
+        return false;
+    cost = sector->cost[(cellZ - sector->minZ) * sector->width + (cellX - sector->minX)];
+    return cost < FLT_MAX;
+}
+
+void FlowField::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this]() {
+        return !m_running || (!m_goalDirty && m_sectorQueue.empty() && !m_busy);
+    });
+}
+
+int FlowField::SectorIndexOf(int cellX, int cellZ) const
+{
+    if (m_goalField->sectorSize <= 0)
+        return 0;
+    return (cellZ / m_goalField->sectorSize) * m_goalField->sectorsX + (cellX / m_goalField->sectorSize);
+}
+
+// ============================================================================
+// WorkerLoop
+// ============================================================================
+void FlowField::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this]() {
+            return !m_running || m_goalDirty || (m_goalField && !m_sectorQueue.empty());
+        });
+        if (!m_running)
+            return;
+
+        // Results computed for an older goal revision are dropped
+        const uint32_t revision = m_revision;
+        m_busy = true;
+
+        if (m_goalDirty)
+        {
+            m_goalDirty = false;
+            const int goalCell = m_goalCell;
+            lock.unlock();
+
+            auto field = std::make_shared<GoalField>();
+            ComputeGoalField(goalCell, *field);
+
+            lock.lock();
+            if (revision == m_revision)
+            {
+                const size_t sectorCount = static_cast<size_t>(field->sectorsX) * field->sectorsZ;
+                m_goalField = std::move(field);
+                m_sectors.assign(sectorCount, nullptr);
+                m_sectorQueued.assign(sectorCount, 0);
+            }
+        }
+        else
+        {
+            const int sectorIndex = m_sectorQueue.front();
+            m_sectorQueue.pop_front();
+            std::shared_ptr<const GoalField> field = m_goalField;
+            lock.unlock();
+
+            auto sector = std::make_shared<Sector>();
+            ComputeSector(*field, sectorIndex, *sector);
+
+            lock.lock();
+            if (revision == m_revision)
+                m_sectors[sectorIndex] = std::move(sector);
+        }
+
+        m_busy = false;
+        m_idleCv.notify_all();
+    }
+}
+
+// ============================================================================
+// ComputeGoalField (abstract Dijkstra over cluster entrances)
+// ============================================================================
+void FlowField::ComputeGoalField(int goalCell, GoalField& field) const
+{
+    const NavMesh& nav = *m_navMesh;
+    field.goalCell = goalCell;
+    if (!nav.HasHierarchy())
+        return;   // One sector; ComputeSector searches the whole grid from the goal
+
+    {
+        std::lock_guard<std::mutex> lock(nav.m_hierarchyMutex);
+        if (nav.m_hierarchyDirty)
+            nav.RebuildDirtyClusters();
+    }
+
+    field.sectorSize = nav.m_clusterSize;
+    field.sectorsX   = nav.m_clustersX;
+    field.sectorsZ   = nav.m_clustersZ;
+
+    const int gridW = nav.m_gridWidth;
+    auto clusterOf = [&](int cell) -> const NavMesh::Cluster& {
+        return nav.m_clusters[nav.ClusterIndexOf(cell % gridW, cell / gridW)];
+    };
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    auto& cost = field.entranceCost;
+    auto relax = [&](int cell, float value) {
+        auto it = cost.find(cell);
+        if (it != cost.end() && it->second <= value) return;
+        cost[cell] = value;
+        open.push({ value, cell });
+    };
+
+    // Seeds: the goal cluster's entrances, at their local cost to the goal
+    const NavMesh::Cluster& goalCluster = clusterOf(goalCell);
+    const int goalW = goalCluster.maxX - goalCluster.minX + 1;
+    ClusterSearchScratch search;
+    nav.SearchCluster(goalCluster, goalCell, true, search);
+    for (const auto& node : goalCluster.nodes)
+    {
+        const float d = search.dist[(node.cell / gridW - goalCluster.minZ) * goalW + (node.cell % gridW - goalCluster.minX)];
+        if (d < FLT_MAX) relax(node.cell, d);
+    }
+
+    // Backwards over the abstract graph: relax the predecessors of each settled entrance
+    while (!open.empty())
+    {
+        auto [d, cell] = open.top();
+        open.pop();
+        if (d > cost[cell]) continue;
+
+        const NavMesh::Cluster& cluster = clusterOf(cell);
+        const size_t n = cluster.nodes.size();
+        size_t slot = 0;
+        while (slot < n && cluster.nodes[slot].cell != cell) ++slot;
+        if (slot == n) continue;
+
+        for (size_t a = 0; a < n; ++a)
+        {
+            const float c = cluster.costs[a * n + slot];
+            if (a != slot && c < FLT_MAX)
+                relax(cluster.nodes[a].cell, d + c);
+        }
+
+        // Entrance pairs are linked both ways; the step across enters this cell
+        const float enter = nav.m_grid[cell].costMultiplier;
+        for (int link : cluster.nodes[slot].links)
+        {
+            if (link >= 0)
+                relax(link, d + enter);
+        }
+    }
+}
+
+// ============================================================================
+// ComputeSector (integration + direction field)
+// ============================================================================
+void FlowField::ComputeSector(const GoalField& field, int sectorIndex, Sector& sector) const
+{
+    const NavMesh& nav = *m_navMesh;
+    const int gridW = nav.m_gridWidth;
+
+    if (field.sectorSize <= 0)
+    {
+        sector.minX = sector.minZ = 0;
+        sector.width  = gridW;
+        sector.height = nav.m_gridHeight;
+    }
+    else
+    {
+        const NavMesh::Cluster& cluster = nav.m_clusters[sectorIndex];
+        sector.minX   = cluster.minX;
+        sector.minZ   = cluster.minZ;
+        sector.width  = cluster.maxX - cluster.minX + 1;
+        sector.height = cluster.maxZ - cluster.minZ + 1;
+    }
+    const int w = sector.width;
+    const int h = sector.height;
+    sector.cost.assign(static_cast<size_t>(w) * h, FLT_MAX);
+    sector.direction.assign(static_cast<size_t>(w) * h, k_DirNone);
+
+    auto localOf = [&](int cell) {
+        return (cell / gridW - sector.minZ) * w + (cell % gridW - sector.minX);
+    };
+    auto inside = [&](int x, int z) {
+        return x >= sector.minX && x < sector.minX + w && z >= sector.minZ && z < sector.minZ + h;
+    };
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    // Seeds: the goal cell and this sector's entrances (cost to goal from the abstract solution)
+    const int goalX = field.goalCell % gridW, goalZ = field.goalCell / gridW;
+    if (inside(goalX, goalZ))
+    {
+        const int local = localOf(field.goalCell);
+        sector.cost[local] = 0.0f;
+        sector.direction[local] = k_DirGoal;
+        open.push({ 0.0f, local });
+    }
+    const NavMesh::Cluster* cluster = field.sectorSize > 0 ? &nav.m_clusters[sectorIndex] : nullptr;
+    if (cluster)
+    {
+        for (const auto& node : cluster->nodes)
+        {
+            auto it = field.entranceCost.find(node.cell);
+            const int local = localOf(node.cell);
+            if (it == field.entranceCost.end() || it->second >= sector.cost[local])
+                continue;
+            sector.cost[local] = it->second;
+            open.push({ it->second, local });
+        }
+    }
+
+    // Reverse Dijkstra: the cost of a cell is the cheapest step into an already settled one
+    while (!open.empty())
+    {
+        auto [d, cur] = open.top();
+        open.pop();
+        if (d > sector.cost[cur]) continue;
+
+        const int cx = sector.minX + cur % w;
+        const int cz = sector.minZ + cur / w;
+        const float enter = nav.m_grid[static_cast<size_t>(cz) * gridW + cx].costMultiplier;
+        for (int k = 0; k < 8; ++k)
+        {
+            const int nx = cx + k_DX[k];
+            const int nz = cz + k_DZ[k];
+            if (!inside(nx, nz) || !nav.CanStep(nx, nz, cx, cz))
+                continue;
+
+            const int ni = (nz - sector.minZ) * w + (nx - sector.minX);
+            const float value = d + k_MoveCost[k] * enter;
+            if (value < sector.cost[ni])
+            {
+                sector.cost[ni] = value;
+                sector.direction[ni] = static_cast<uint8_t>(7 - k);
+                open.push({ value, ni });
+            }
+        }
+    }
+
+    if (!cluster)
+        return;
+
+    // Entrances that kept their seed cost leave the sector (or follow an equally
+    // cheap in-sector step): pick the best neighbour, including across the border
+    for (const auto& node : cluster->nodes)
+    {
+        const int local = localOf(node.cell);
+        if (sector.direction[local] != k_DirNone || sector.cost[local] == FLT_MAX)
+            continue;
+
+        const int cx = node.cell % gridW, cz = node.cell / gridW;
+        float best = FLT_MAX;
+        for (int k = 0; k < 8; ++k)
+        {
+            const int nx = cx + k_DX[k];
+            const int nz = cz + k_DZ[k];
+            if (!nav.CanStep(cx, cz, nx, nz))
+                continue;
+
+            const int neighbour = nz * gridW + nx;
+            float next = FLT_MAX;
+            if (inside(nx, nz))
+            {
+                next = sector.cost[(nz - sector.minZ) * w + (nx - sector.minX)];
+            }
+            else if (std::find(std::begin(node.links), std::end(node.links), neighbour) != std::end(node.links))
+            {
+                auto it = field.entranceCost.find(neighbour);
+                if (it != field.entranceCost.end()) next = it->second;
+            }
+            if (next == FLT_MAX)
+                continue;
+
+            const float value = next + k_MoveCost[k] * nav.m_grid[neighbour].costMultiplier;
+            if (value < best)
+            {
+                best = value;
+                sector.direction[local] = static_cast<uint8_t>(k);
+            }
+        }
+    }
+}
+
+} // namespace GX
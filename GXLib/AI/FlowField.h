@@ -0,0 +1,151 @@
+#pragma once
+/// @file FlowField.h
+/// @brief Flow-field pathfinding on a NavMesh grid for many agents sharing one goal
+///
+/// Instead of one A* search per agent, a flow field stores for every cell the
+/// cost to the goal (integration field) and the step that reduces it fastest
+/// (direction field); any number of agents simply sample it.
+///
+/// The grid is split into sectors that match the NavMesh's HPA* clusters
+/// (one sector covering the whole grid if no hierarchy was built). Setting a
+/// goal first solves a small Dijkstra over the cluster entrances; a sector's
+/// fields are then computed only when an agent samples inside it, seeded from
+/// the entrance costs. All computation runs on a worker thread and is reused
+/// for as long as the goal stays in the same cell.
+
+#include "pch.h"
+#include <deque>
+
+namespace GX
+{
+
+class NavMesh;
+
+/// @brief Result of sampling a flow field
+enum class FlowFieldStatus
+{
+    Ready,        ///< Direction available
+    Pending,      ///< Sector (or the goal) is still being computed
+    Unreachable,  ///< No path from this cell to the goal
+    NoGoal        ///< No goal set
+};
+
+/// @brief Shared direction field towards a single goal
+///
+/// The NavMesh must not be modified while the field is being computed;
+/// call Invalidate() after editing cells to recompute with the same goal.
+class FlowField
+{
+public:
+    FlowField() = default;
+    ~FlowField();
+
+    FlowField(const FlowField&) = delete;
+    FlowField& operator=(const FlowField&) = delete;
+
+    /// @brief Start the worker thread
+    /// @param navMesh NavMesh to compute on (must outlive the field)
+    /// @return true on success
+    bool Initialize(const NavMesh* navMesh);
+
+    /// @brief Stop the worker and drop every computed sector
+    void Shutdown();
+
+    /// @brief Set the goal; a goal in the same cell as the current one keeps the cached fields
+    ///
+    /// An unwalkable goal is moved to the nearest walkable cell.
+    void SetGoal(const XMFLOAT3& goal);
+
+    /// @brief Remove the goal (Sample returns NoGoal)
+    void ClearGoal();
+
+    /// @brief Discard every computed sector and recompute for the current goal
+    void Invalidate();
+
+    /// @brief Sample the direction towards the goal
+    ///
+    /// Sampling a sector that has not been computed yet queues it and returns
+    /// Pending; it becomes Ready once the worker has finished it.
+    /// @param position  World position
+    /// @param direction Output: unit XZ direction (y = 0); towards the goal point in the goal cell
+    /// @param surfaceY  Optional output: NavMesh height of the cell
+    FlowFieldStatus Sample(const XMFLOAT3& position, XMFLOAT3& direction, float* surfaceY = nullptr);
+
+    /// @brief Get the integration (cost-to-goal) value of the cell at a position
+    /// @return false if the sector is not computed yet or the cell cannot reach the goal
+    bool GetCostToGoal(const XMFLOAT3& position, float& cost) const;
+
+    /// @brief Block until the goal and all queued sectors are computed
+    void WaitIdle();
+
+    bool     HasGoal() const;
+    XMFLOAT3 GetGoal() const;
+
+    /// @brief Incremented whenever the goal cell changes or the field is invalidated
+    uint32_t GetGoalRevision() const;
+
+    /// @brief Number of sectors whose fields are currently computed
+    uint32_t GetComputedSectorCount() const;
+
+    /// @brief Number of sectors (0 until the first goal has been processed)
+    uint32_t GetSectorCount() const;
+
+private:
+    /// Direction codes (index into the 8-neighbour offsets, or one of these)
+    static constexpr uint8_t k_DirGoal = 8;
+    static constexpr uint8_t k_DirNone = 255;
+
+    /// @brief Integration and direction fields of one sector
+    struct Sector
+    {
+        int minX = 0, minZ = 0;
+        int width = 0, height = 0;
+        std::vector<float>   cost;        ///< Cost to goal per cell (FLT_MAX = unreachable)
+        std::vector<uint8_t> direction;   ///< Next step per cell
+    };
+
+    /// @brief Abstract (cluster-entrance) solution for one goal
+    struct GoalField
+    {
+        int goalCell = -1;
+        int sectorSize = 0;                         ///< 0 = one sector covering the grid
+        int sectorsX = 1, sectorsZ = 1;
+        std::unordered_map<int, float> entranceCost; ///< Entrance cell -> cost to goal
+    };
+
+    void WorkerLoop();
+
+    /// Drop the computed fields and schedule the goal field (m_mutex held)
+    void ResetLocked();
+
+    /// Dijkstra over the cluster entrances, backwards from the goal
+    void ComputeGoalField(int goalCell, GoalField& field) const;
+
+    /// Seeded reverse Dijkstra inside one sector plus its direction field
+    void ComputeSector(const GoalField& field, int sectorIndex, Sector& sector) const;
+
+    /// Sector index containing a cell (m_mutex held)
+    int SectorIndexOf(int cellX, int cellZ) const;
+
+    const NavMesh* m_navMesh = nullptr;
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idleCv;
+    bool m_running = false;
+    bool m_busy    = false;              ///< Worker is computing outside the lock
+
+    // Goal state (m_mutex)
+    bool     m_hasGoal = false;
+    XMFLOAT3 m_goal = { 0.0f, 0.0f, 0.0f };
+    int      m_goalCell = -1;
+    uint32_t m_revision = 0;
+    bool     m_goalDirty = false;        ///< Goal field must be (re)computed
+    std::shared_ptr<const GoalField> m_goalField;
+    std::vector<std::shared_ptr<const Sector>> m_sectors;
+    std::vector<uint8_t> m_sectorQueued;
+    std::deque<int>      m_sectorQueue;
+};
+
+} // namespace GX
@@ -4,17 +4,57 @@
 
 #include "AI/NavAgent.h"
 #include "AI/NavMesh.h"
+#include "AI/NavPolyMesh.h"
+#include "AI/PathRequestQueue.h"
+#include "AI/FlowField.h"
 
 namespace GX
 {
 
+NavAgent::~NavAgent()
+{
+    CancelPendingRequest();
+}
+
 // ============================================================================
 // Initialize
 // ============================================================================
 void NavAgent::Initialize(NavMesh* navMesh)
 {
+    CancelPendingRequest();
     m_navMesh = navMesh;
+    m_polyMesh = nullptr;
+    m_flowField = nullptr;
+    m_path.clear();
+    m_pathTiles.clear();
+    m_currentPathIndex = 0;
+    m_reached = false;
+}
+
+void NavAgent::Initialize(NavPolyMesh* polyMesh)
+{
+    CancelPendingRequest();
+    m_navMesh = nullptr;
+    m_polyMesh = polyMesh;
+    m_flowField = nullptr;
+    m_path.clear();
+    m_pathTiles.clear();
+    m_currentPathIndex = 0;
+    m_reached = false;
+}
+
+void NavAgent::SetRequestQueue(PathRequestQueue* queue)
+{
+    CancelPendingRequest();
+    m_requestQueue = queue;
+}
+
+void NavAgent::SetFlowField(FlowField* flowField)
+{
+    CancelPendingRequest();
+    m_flowField = flowField;
     m_path.clear();
+    m_pathTiles.clear();
     m_currentPathIndex = 0;
     m_reached = false;
 }
@@ -24,24 +64,70 @@ void NavAgent::Initialize(NavMesh* navMesh)
 // ============================================================================
 void NavAgent::SetDestination(const XMFLOAT3& target)
 {
+    m_flowField = nullptr;
+
+    // Poly meshes are always searched synchronously (PathRequestQueue only serves grid NavMeshes)
+    if (m_polyMesh)
+    {
+        if (!m_polyMesh->IsBuilt())
+            return;
+        std::vector<XMFLOAT3> path;
+        std::vector<NavPolyRef> corridor;
+        m_polyMesh->FindPath(m_position, target, path, &corridor);
+
+        // Remember which tile versions the path relies on
+        m_destination = target;
+        m_polyMeshRevision = m_polyMesh->GetRevision();
+        m_pathTiles.clear();
+        for (NavPolyRef ref : corridor)
+        {
+            const int tileIndex = NavPolyMesh::GetTileIndex(ref);
+            if (m_pathTiles.empty() || m_pathTiles.back().first != tileIndex)
+                m_pathTiles.emplace_back(tileIndex, m_polyMesh->GetTileRevision(tileIndex));
+        }
+
+        // No path (e.g. a closed door): try again whenever any tile changes
+        if (corridor.empty())
+            m_pathTiles.emplace_back(-1, 0);
+
+        ApplyPath(std::move(path));
+        return;
+    }
+
     if (!m_navMesh || !m_navMesh->IsBuilt())
         return;
 
-    m_path.clear();
-    m_currentPathIndex = 0;
-    m_reached = false;
+    // Asynchronous: keep following the current path until the result arrives
+    if (m_requestQueue)
+    {
+        m_destination = target;
+        m_pendingRequest = m_requestQueue->Request(m_position, target, m_pendingRequest);
+        if (m_pendingRequest != 0)
+            return;
+    }
+
+    std::vector<XMFLOAT3> path;
 
     // Try to find a path
-    if (!m_navMesh->FindPath(m_position, target, m_path))
+    if (!m_navMesh->FindPath(m_position, target, path))
     {
         // Path not found -- try to find nearest walkable to destination
         XMFLOAT3 nearTarget;
         if (m_navMesh->FindNearestWalkable(target, nearTarget))
         {
-            m_navMesh->FindPath(m_position, nearTarget, m_path);
+            m_navMesh->FindPath(m_position, nearTarget, path);
         }
     }
 
+    ApplyPath(std::move(path));
+}
+
+void NavAgent::ApplyPath(std::vector<XMFLOAT3>&& path)
+{
+    m_path = std::move(path);
+    m_currentPathIndex = 0;
+    m_reached = false;
+
     // Skip the first waypoint if it is very close to current position
     // (it corresponds to the start cell)
     if (m_path.size() > 1)
@@ -54,12 +140,67 @@ void NavAgent::SetDestination(const XMFLOAT3& target)
     }
 }
 
+// ============================================================================
+// Asynchronous requests
+// ============================================================================
+void NavAgent::PollPendingRequest()
+{
+    if (!m_requestQueue || m_pendingRequest == 0)
+        return;
+
+    std::vector<XMFLOAT3> path;
+    switch (m_requestQueue->Poll(m_pendingRequest, path))
+    {
+    case PathRequestStatus::Pending:
+        return;
+    case PathRequestStatus::Succeeded:
+        ApplyPath(std::move(path));
+        break;
+    case PathRequestStatus::Failed:
+        ApplyPath({});
+        break;
+    case PathRequestStatus::Unknown:
+        // The queue lost the ticket (e.g. it was shut down): ask again
+        m_pendingRequest = 0;
+        SetDestination(m_destination);
+        return;
+    }
+    m_pendingRequest = 0;
+}
+
+void NavAgent::CancelPendingRequest()
+{
+    if (m_requestQueue && m_pendingRequest != 0)
+        m_requestQueue->Cancel(m_pendingRequest);
+    m_pendingRequest = 0;
+}
+
+void NavAgent::CheckPolyMeshTiles()
+{
+    const uint32_t revision = m_polyMesh->GetRevision();
+    if (revision == m_polyMeshRevision)
+        return;
+    m_polyMeshRevision = revision;
+
+    for (const auto& [tileIndex, tileRevision] : m_pathTiles)
+    {
+        if (tileIndex < 0 || m_polyMesh->GetTileRevision(tileIndex) != tileRevision)
+        {
+            SetDestination(m_destination);
+            return;
+        }
+    }
+}
+
 // ============================================================================
 // Stop
 // ============================================================================
 void NavAgent::Stop()
 {
+    CancelPendingRequest();
+    m_flowField = nullptr;
     m_path.clear();
+    m_pathTiles.clear();
     m_currentPathIndex = 0;
     m_reached = false;
 }
@@ -69,6 +210,16 @@ void NavAgent::Stop()
 // ============================================================================
 void NavAgent::Update(float deltaTime)
 {
+    if (m_flowField)
+    {
+        UpdateFlowField(deltaTime);
+        return;
+    }
+
+    PollPendingRequest();
+    if (m_polyMesh && !m_reached && !m_pathTiles.empty())
+        CheckPolyMeshTiles();
+
     if (m_reached || m_path.empty())
         return;
     if (m_currentPathIndex >= static_cast<int>(m_path.size()))
@@ -104,6 +255,59 @@ void NavAgent::Update(float deltaTime)
         if (dist < 1e-6f) return;
     }
 
+    TurnAndMove(dx, dz, dist, deltaTime);
+
+    // Update Y from navmesh cell height
+    if (m_navMesh && m_navMesh->IsBuilt() && m_currentPathIndex < static_cast<int>(m_path.size()))
+    {
+        XMFLOAT3 wp = m_path[m_currentPathIndex];
+        m_position.y = wp.y + height;
+    }
+    else if (m_polyMesh && m_currentPathIndex > 0)
+    {
+        // Polygon paths only have corner waypoints: interpolate the height along the segment
+        const XMFLOAT3& from = m_path[m_currentPathIndex - 1];
+        const XMFLOAT3& to   = m_path[m_currentPathIndex];
+        const float segX = to.x - from.x, segZ = to.z - from.z;
+        const float segLen2 = segX * segX + segZ * segZ;
+        float t = segLen2 > 1e-8f ? ((m_position.x - from.x) * segX + (m_position.z - from.z) * segZ) / segLen2 : 1.0f;
+        t = std::max(0.0f, std::min(1.0f, t));
+        m_position.y = from.y + (to.y - from.y) * t + height;
+    }
+}
+
+// ============================================================================
+// Flow-field mode
+// ============================================================================
+void NavAgent::UpdateFlowField(float deltaTime)
+{
+    if (!m_flowField->HasGoal())
+        return;
+
+    const XMFLOAT3 goal = m_flowField->GetGoal();
+    const float gx = goal.x - m_position.x;
+    const float gz = goal.z - m_position.z;
+    const float goalDist = std::sqrt(gx * gx + gz * gz);
+
+    // Not latched: the goal may move (within its cell) while the agent waits there
+    m_reached = goalDist <= stoppingDistance;
+    if (m_reached)
+        return;
+
+    // Pending sector or unreachable cell: wait in place
+    XMFLOAT3 direction;
+    float surfaceY = m_position.y - height;
+    if (m_flowField->Sample(m_position, direction, &surfaceY) != FlowFieldStatus::Ready)
+        return;
+    if (direction.x == 0.0f && direction.z == 0.0f)
+        return;
+
+    TurnAndMove(direction.x * goalDist, direction.z * goalDist, goalDist, deltaTime);
+    m_position.y = surfaceY + height;
+}
+
+void NavAgent::TurnAndMove(float dx, float dz, float dist, float deltaTime)
+{
     // Compute desired yaw (atan2 gives angle from +Z axis in XZ plane)
     float desiredYaw = std::atan2(dx, dz);
 
@@ -138,13 +342,6 @@ void NavAgent::Update(float deltaTime)
     float invDist = 1.0f / dist;
     m_position.x += dx * invDist * moveStep;
     m_position.z += dz * invDist * moveStep;
-
-    // Update Y from navmesh cell height
-    if (m_navMesh && m_navMesh->IsBuilt() && m_currentPathIndex < static_cast<int>(m_path.size()))
-    {
-        XMFLOAT3 wp = m_path[m_currentPathIndex];
-        m_position.y = wp.y + height;
-    }
 }
 
 } // namespace GX
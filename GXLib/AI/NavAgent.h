@@ -4,6 +4,12 @@
 ///
 /// Automatically computes a path to a destination using NavMesh::FindPath,
 /// then smoothly moves and rotates along the waypoints each frame.
+/// With a PathRequestQueue attached, the search runs asynchronously and the
+/// agent keeps following its previous path until the new one arrives.
+/// The agent can also follow string-pulled paths on a NavPolyMesh; it re-plans
+/// when a tile its path crosses is rebuilt (e.g. by an obstacle change).
+/// In flow-field mode it samples a FlowField shared with other agents
+/// instead of following its own path.
 
 #include "pch.h"
 
@@ -11,25 +17,54 @@ namespace GX
 {
 
 class NavMesh;
+class NavPolyMesh;
+class PathRequestQueue;
+class FlowField;
 
 /// @brief Agent that moves along NavMesh paths
 class NavAgent
 {
 public:
     NavAgent() = default;
-    ~NavAgent() = default;
+    ~NavAgent();
 
     /// @brief Associate this agent with a NavMesh
     void Initialize(NavMesh* navMesh);
 
-    /// @brief Set a destination and compute a path to it
+    /// @brief Associate this agent with a polygon navmesh (searches are synchronous)
+    void Initialize(NavPolyMesh* polyMesh);
+
+    /// @brief Route path searches through an asynchronous request queue
+    ///
+    /// The queue must search the same NavMesh and outlive the agent.
+    /// Pass nullptr to go back to synchronous searches.
+    /// Only grid NavMesh searches use the queue: an agent initialized with a
+    /// NavPolyMesh ignores it and still searches synchronously in SetDestination.
+    void SetRequestQueue(PathRequestQueue* queue);
+
+    /// @brief Set a destination and compute a path to it (leaves flow-field mode)
+    ///
+    /// With a request queue the path is delivered by a later Update();
+    /// a newer destination supersedes (cancels) a request still in flight.
     void SetDestination(const XMFLOAT3& target);
 
+    /// @brief Follow a shared flow field towards its goal instead of a path
+    ///
+    /// The field must outlive the agent (or be detached with nullptr / Stop()).
+    /// The agent waits in place while the sector it stands in is being computed.
+    void SetFlowField(FlowField* flowField);
+
+    /// @brief Check if the agent is in flow-field mode
+    bool IsFollowingFlowField() const { return m_flowField != nullptr; }
+
+    /// @brief Check if an asynchronous path request is still in flight
+    bool IsPathPending() const { return m_pendingRequest != 0; }
+
     /// @brief Update the agent (move along the path each frame)
     /// @param deltaTime Frame delta time in seconds
     void Update(float deltaTime);
 
-    /// @brief Stop the agent and clear its path
+    /// @brief Stop the agent, clear its path and leave flow-field mode
     void Stop();
 
     /// @brief Get the current world position
@@ -64,7 +99,32 @@ public:
     float height           = 0.0f;    ///< Agent Y offset above navmesh surface
 
 private:
+    /// Adopt a freshly computed path
+    void ApplyPath(std::vector<XMFLOAT3>&& path);
+
+    /// Pick up the result of the pending request, if any
+    void PollPendingRequest();
+
+    /// Cancel the pending request, if any
+    void CancelPendingRequest();
+
+    /// Re-plan if a NavPolyMesh tile on the current path has been rebuilt
+    void CheckPolyMeshTiles();
+
+    /// Flow-field mode: sample the field and move along it
+    void UpdateFlowField(float deltaTime);
+
+    /// Rotate towards (dx, dz) and move up to dist along it
+    void TurnAndMove(float dx, float dz, float dist, float deltaTime);
+
     NavMesh* m_navMesh = nullptr;
+    NavPolyMesh* m_polyMesh = nullptr;
+    uint32_t m_polyMeshRevision = 0;                    ///< Mesh revision the path tiles were checked against
+    std::vector<std::pair<int, uint32_t>> m_pathTiles;  ///< (tile index, tile revision) crossed by the path
+    XMFLOAT3 m_destination = { 0.0f, 0.0f, 0.0f };
+    PathRequestQueue* m_requestQueue = nullptr;
+    FlowField* m_flowField = nullptr;
+    uint32_t m_pendingRequest = 0;
     std::vector<XMFLOAT3> m_path;
     int      m_currentPathIndex = 0;
     XMFLOAT3 m_position = { 0.0f, 0.0f, 0.0f };
@@ -3,10 +3,13 @@
 /// @brief Grid-based navigation mesh with A* pathfinding
 
 #include "AI/NavMesh.h"
+#include "AI/PathQueryContext.h"
 #include "Graphics/3D/Terrain.h"
 #include "Graphics/3D/PrimitiveBatch3D.h"
 #include "Core/Logger.h"
-#include <queue>
+#include "IO/FileSystem.h"
+#include "gxnav.h"
+#include <algorithm>
 
 namespace GX
 {
@@ -51,8 +54,17 @@ bool NavMesh::Build(float worldMinX, float worldMinZ,
         cell.walkable       = true;
         cell.costMultiplier = 1.0f;
     }
+    m_nonUniformCount = 0;
 
     m_built = true;
+
+    // Keep the hierarchy enabled across rebuilds; every cluster starts dirty
+    if (m_clusterSize > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+        ResetClusters();
+    }
+
     Logger::Info("NavMesh::Build - %dx%d grid (cellSize=%.2f)", m_gridWidth, m_gridHeight, cellSize);
     return true;
 }
@@ -278,6 +290,202 @@ void NavMesh::ApplySlopeFilter(float maxClimb, float maxSlope)
     }
 }
 
+// ============================================================================
+// Serialize / SaveToFile (.gxnav)
+// ============================================================================
+bool NavMesh::Serialize(std::vector<uint8_t>& out) const
+{
+    out.clear();
+    if (!m_built)
+    {
+        Logger::Error("NavMesh::Serialize - navmesh is not built");
+        return false;
+    }
+
+    float heightMin = FLT_MAX, heightMax = -FLT_MAX;
+    for (const auto& cell : m_grid)
+    {
+        heightMin = std::min(heightMin, cell.height);
+        heightMax = std::max(heightMax, cell.height);
+    }
+    const float heightScale = (heightMax - heightMin) / 65535.0f;
+
+    const size_t cellCount = m_grid.size();
+    const uint64_t tableOffset = sizeof(gxfmt::GxnavHeader);
+    const uint64_t cellOffset  = (tableOffset + sizeof(gxfmt::GxnavSection) + 15) & ~uint64_t(15);
+    out.resize(static_cast<size_t>(cellOffset) + cellCount * sizeof(gxfmt::GxnavCell), 0);
+
+    gxfmt::GxnavHeader header = {};
+    header.magic        = gxfmt::k_GxnavMagic;
+    header.version      = gxfmt::k_GxnavVersion;
+    header.sectionCount = 1;
+    header.gridWidth    = static_cast<uint32_t>(m_gridWidth);
+    header.gridHeight   = static_cast<uint32_t>(m_gridHeight);
+    header.cellSize     = m_cellSize;
+    header.worldMinX    = m_worldMinX;
+    header.worldMinZ    = m_worldMinZ;
+    header.heightMin    = heightMin;
+    header.heightScale  = heightScale;
+    header.clusterSize  = static_cast<uint32_t>(m_clusterSize);
+    header.sectionTableOffset = tableOffset;
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    gxfmt::GxnavSection section = {};
+    section.type   = gxfmt::GxnavSectionType::GridCells;
+    section.count  = static_cast<uint32_t>(cellCount);
+    section.offset = cellOffset;
+    std::memcpy(out.data() + tableOffset, &section, sizeof(section));
+
+    auto* cells = reinterpret_cast<gxfmt::GxnavCell*>(out.data() + cellOffset);
+    const float invScale = heightScale > 0.0f ? 1.0f / heightScale : 0.0f;
+    size_t clampedCosts = 0;
+    for (size_t i = 0; i < cellCount; ++i)
+    {
+        const Cell& src = m_grid[i];
+        const float q = std::round((src.height - heightMin) * invScale);
+        cells[i].height = static_cast<uint16_t>(std::max(0.0f, std::min(65535.0f, q)));
+        cells[i].flags  = src.walkable ? gxfmt::k_GxnavCellWalkable : 0;
+        cells[i].cost   = gxfmt::EncodeGxnavCost(src.costMultiplier);
+        if (src.costMultiplier < gxfmt::k_GxnavCostMin || src.costMultiplier > gxfmt::k_GxnavCostMax)
+            ++clampedCosts;
+    }
+    if (clampedCosts > 0)
+    {
+        Logger::Warn("NavMesh::Serialize - %zu cell cost(s) outside [%.4f, %.0f] were clamped",
+                     clampedCosts, gxfmt::k_GxnavCostMin, gxfmt::k_GxnavCostMax);
+    }
+    return true;
+}
+
+bool NavMesh::SaveToFile(const std::string& path) const
+{
+    std::vector<uint8_t> blob;
+    if (!Serialize(blob))
+        return false;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::Error("NavMesh::SaveToFile - cannot open %s", path.c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    return file.good();
+}
+
+// ============================================================================
+// LoadFromMemory / LoadFromFile (.gxnav)
+// ============================================================================
+bool NavMesh::LoadFromMemory(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    if (!bytes || size < sizeof(gxfmt::GxnavHeader))
+    {
+        Logger::Error("NavMesh::LoadFromMemory - blob too small");
+        return false;
+    }
+
+    gxfmt::GxnavHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.magic != gxfmt::k_GxnavMagic)
+    {
+        Logger::Error("NavMesh::LoadFromMemory - invalid magic");
+        return false;
+    }
+    if (header.version != gxfmt::k_GxnavVersion)
+    {
+        Logger::Error("NavMesh::LoadFromMemory - unsupported version %u", header.version);
+        return false;
+    }
+    if (header.gridWidth == 0 || header.gridHeight == 0 || !(header.cellSize > 0.0f) ||
+        header.sectionTableOffset > size ||
+        header.sectionCount > (size - header.sectionTableOffset) / sizeof(gxfmt::GxnavSection))
+    {
+        Logger::Error("NavMesh::LoadFromMemory - corrupt header");
+        return false;
+    }
+
+    // Locate the cell section; other sections belong to other navmesh types
+    const uint64_t cellCount = static_cast<uint64_t>(header.gridWidth) * header.gridHeight;
+    const uint8_t* cellData = nullptr;
+    for (uint32_t i = 0; i < header.sectionCount; ++i)
+    {
+        gxfmt::GxnavSection section;
+        std::memcpy(&section, bytes + header.sectionTableOffset + i * sizeof(section), sizeof(section));
+        if (section.type != gxfmt::GxnavSectionType::GridCells)
+            continue;
+        if (section.count != cellCount || section.offset > size ||
+            cellCount > (size - section.offset) / sizeof(gxfmt::GxnavCell))
+        {
+            Logger::Error("NavMesh::LoadFromMemory - corrupt cell section");
+            return false;
+        }
+        cellData = bytes + section.offset;
+    }
+    if (!cellData)
+    {
+        Logger::Error("NavMesh::LoadFromMemory - no grid cell section");
+        return false;
+    }
+
+    m_gridWidth  = static_cast<int>(header.gridWidth);
+    m_gridHeight = static_cast<int>(header.gridHeight);
+    m_cellSize   = header.cellSize;
+    m_worldMinX  = header.worldMinX;
+    m_worldMinZ  = header.worldMinZ;
+
+    // Decode straight from the caller's memory (no intermediate copy of the blob)
+    m_grid.resize(static_cast<size_t>(cellCount));
+    m_nonUniformCount = 0;
+    for (size_t i = 0; i < m_grid.size(); ++i)
+    {
+        gxfmt::GxnavCell src;
+        std::memcpy(&src, cellData + i * sizeof(src), sizeof(src));
+        Cell& cell = m_grid[i];
+        cell.height         = header.heightMin + src.height * header.heightScale;
+        cell.walkable       = (src.flags & gxfmt::k_GxnavCellWalkable) != 0;
+        cell.costMultiplier = gxfmt::DecodeGxnavCost(src.cost);
+        if (cell.costMultiplier != 1.0f)
+            ++m_nonUniformCount;
+    }
+    m_built = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+        if (header.clusterSize >= 4)
+            m_clusterSize = static_cast<int>(header.clusterSize);
+        if (m_clusterSize > 0)
+            ResetClusters();
+    }
+
+    Logger::Info("NavMesh::LoadFromMemory - %dx%d grid (cellSize=%.2f)", m_gridWidth, m_gridHeight, m_cellSize);
+    return true;
+}
+
+bool NavMesh::LoadFromFile(const std::string& path)
+{
+    auto fileData = FileSystem::Instance().ReadFile(path);
+    if (fileData.IsValid())
+        return LoadFromMemory(fileData.Data(), fileData.Size());
+
+    // Direct file I/O fallback
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        Logger::Error("NavMesh::LoadFromFile - cannot open %s", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> blob(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    if (!file)
+    {
+        Logger::Error("NavMesh::LoadFromFile - read failed %s", path.c_str());
+        return false;
+    }
+    return LoadFromMemory(blob.data(), blob.size());
+}
+
 // ============================================================================
 // SetCellWalkable / SetCellCost
 // ============================================================================
@@ -285,21 +493,38 @@ void NavMesh::SetCellWalkable(int cellX, int cellZ, bool walkable)
 {
     if (!m_built) return;
     if (cellX < 0 || cellX >= m_gridWidth || cellZ < 0 || cellZ >= m_gridHeight) return;
-    m_grid[static_cast<size_t>(cellZ) * m_gridWidth + cellX].walkable = walkable;
+
+    auto& cell = m_grid[static_cast<size_t>(cellZ) * m_gridWidth + cellX];
+    if (cell.walkable == walkable) return;
+    cell.walkable = walkable;
+    InvalidateCluster(cellX, cellZ, true);
 }
 
 void NavMesh::SetCellCost(int cellX, int cellZ, float costMultiplier)
 {
     if (!m_built) return;
     if (cellX < 0 || cellX >= m_gridWidth || cellZ < 0 || cellZ >= m_gridHeight) return;
-    m_grid[static_cast<size_t>(cellZ) * m_gridWidth + cellX].costMultiplier = costMultiplier;
+
+    auto& cell = m_grid[static_cast<size_t>(cellZ) * m_gridWidth + cellX];
+    if (cell.costMultiplier == costMultiplier) return;
+    if (cell.costMultiplier == 1.0f) ++m_nonUniformCount;
+    if (costMultiplier == 1.0f)      --m_nonUniformCount;
+    cell.costMultiplier = costMultiplier;
+    // Costs only affect the cached paths inside the cluster, not its entrances
+    InvalidateCluster(cellX, cellZ, false);
 }
 
 // ============================================================================
-// FindPath (A*)
+// FindPath
 // ============================================================================
 bool NavMesh::FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
                        std::vector<XMFLOAT3>& path) const
+{
+    return FindPath(start, end, path, PathQueryContext::ForCurrentThread());
+}
+
+bool NavMesh::FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
+                       std::vector<XMFLOAT3>& path, PathQueryContext& context) const
 {
     path.clear();
     if (!m_built) return false;
@@ -327,108 +552,376 @@ bool NavMesh::FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
         return true;
     }
 
-    size_t gridSize = static_cast<size_t>(m_gridWidth) * m_gridHeight;
-
-    // Closed set + g-scores + parent tracking
-    std::vector<bool>  closed(gridSize, false);
-    std::vector<float> gScore(gridSize, FLT_MAX);
-    std::vector<int>   parentX(gridSize, -1);
-    std::vector<int>   parentZ(gridSize, -1);
-
-    // Min-heap priority queue
-    auto cmp = [](const AStarNode& a, const AStarNode& b) { return a.f > b.f; };
-    std::priority_queue<AStarNode, std::vector<AStarNode>, decltype(cmp)> openList(cmp);
+    std::vector<int>& cells = context.GetCellPath();
+    bool found = HasHierarchy()
+        ? FindPathHierarchical(sx, sz, ex, ez, cells, context)
+        : FindPathGrid(sx, sz, ex, ez, cells, context);
+    if (!found) return false;
 
-    // Start node
-    size_t startIdx = static_cast<size_t>(sz) * m_gridWidth + sx;
-    gScore[startIdx] = 0.0f;
-    float startH = Heuristic(sx, sz, ex, ez);
-    openList.push({ sx, sz, 0.0f, startH, startH, -1, -1 });
+    CellsToPath(cells, start, end, path);
+    return true;
+}
 
+// ============================================================================
+// FindPathGrid (A* with Jump Point Search)
+// ============================================================================
+bool NavMesh::FindPathGrid(int sx, int sz, int ex, int ez, std::vector<int>& cells,
+                           PathQueryContext& context) const
+{
     // 8-directional movement
     static const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
     static const int dz[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
     static const float moveCost[] = { 1.414f, 1.0f, 1.414f, 1.0f, 1.0f, 1.414f, 1.0f, 1.414f };
 
+    const int startIdx = sz * m_gridWidth + sx;
+    const int goalIdx  = ez * m_gridWidth + ex;
+
+    context.Begin(static_cast<size_t>(m_gridWidth) * m_gridHeight);
+    context.Push(startIdx, 0.0f, Heuristic(sx, sz, ex, ez), -1);
+
     bool found = false;
+    while (!context.IsOpenEmpty())
+    {
+        const int cur = context.PopMin();
+        if (cur == goalIdx)
+        {
+            found = true;
+            break;
+        }
+
+        const int   cx = cur % m_gridWidth;
+        const int   cz = cur / m_gridWidth;
+        const float g  = context.GetCost(cur);
+
+        // Cells with a non-unit cost (and their direct neighbours) are expanded
+        // like plain A*; everything else is open space handled by JPS
+        const bool fullExpand = !m_useJumpPoints || !IsJumpOpen(cx, cz) ||
+                                (m_nonUniformCount > 0 && HasNonUniformNeighbour(cx, cz));
+        if (fullExpand)
+        {
+            for (int d = 0; d < 8; ++d)
+            {
+                const int nx = cx + dx[d];
+                const int nz = cz + dz[d];
+                if (!CanStep(cx, cz, nx, nz)) continue;
+
+                const int   nIdx = nz * m_gridWidth + nx;
+                const float ng   = g + moveCost[d] * m_grid[nIdx].costMultiplier;
+                context.Push(nIdx, ng, ng + Heuristic(nx, nz, ex, ez), cur);
+            }
+            continue;
+        }
+
+        // Pruned successor directions, based on the direction we arrived from
+        int dirX[8], dirZ[8];
+        int dirCount = 0;
+        const int parent = context.GetParent(cur);
+        if (parent < 0)
+        {
+            for (int d = 0; d < 8; ++d)
+            {
+                dirX[dirCount] = dx[d];
+                dirZ[dirCount] = dz[d];
+                ++dirCount;
+            }
+        }
+        else
+        {
+            const int pdx = (cx > parent % m_gridWidth) - (cx < parent % m_gridWidth);
+            const int pdz = (cz > parent / m_gridWidth) - (cz < parent / m_gridWidth);
+            auto add = [&](int x, int z) { dirX[dirCount] = x; dirZ[dirCount] = z; ++dirCount; };
+            if (pdx != 0 && pdz != 0)
+            {
+                add(0, pdz); add(pdx, 0); add(pdx, pdz);
+            }
+            else if (pdx != 0)
+            {
+                add(pdx, 0); add(pdx, 1); add(pdx, -1); add(0, 1); add(0, -1);
+            }
+            else
+            {
+                add(0, pdz); add(1, pdz); add(-1, pdz); add(1, 0); add(-1, 0);
+            }
+        }
 
-    while (!openList.empty())
+        for (int i = 0; i < dirCount; ++i)
+        {
+            const int nx = cx + dirX[i];
+            const int nz = cz + dirZ[i];
+            if (!CanStep(cx, cz, nx, nz)) continue;
+
+            const int jp = Jump(nx, nz, dirX[i], dirZ[i], ex, ez);
+            if (jp < 0) continue;
+
+            // Jumps are straight runs of unit-cost cells, so octile distance is exact
+            const int   jx = jp % m_gridWidth;
+            const int   jz = jp / m_gridWidth;
+            const float ng = g + Heuristic(cx, cz, jx, jz);
+            context.Push(jp, ng, ng + Heuristic(jx, jz, ex, ez), cur);
+        }
+    }
+
+    if (!found) return false;
+
+    // Reconstruct path (from end to start), filling in the cells skipped by jumps
+    cells.clear();
+    for (int node = goalIdx; node >= 0; )
     {
-        AStarNode current = openList.top();
-        openList.pop();
+        const int parent = context.GetParent(node);
+        cells.push_back(node);
+        if (parent < 0) break;
+
+        int x = node % m_gridWidth, z = node / m_gridWidth;
+        const int px = parent % m_gridWidth, pz = parent / m_gridWidth;
+        const int stepX = (px > x) - (px < x);
+        const int stepZ = (pz > z) - (pz < z);
+        for (x += stepX, z += stepZ; x != px || z != pz; x += stepX, z += stepZ)
+            cells.push_back(z * m_gridWidth + x);
+        node = parent;
+    }
+    std::reverse(cells.begin(), cells.end());
+    return true;
+}
 
-        size_t curIdx = static_cast<size_t>(current.z) * m_gridWidth + current.x;
+// ============================================================================
+// Jump Point Search helpers
+// ============================================================================
+bool NavMesh::HasNonUniformNeighbour(int x, int z) const
+{
+    for (int nz = z - 1; nz <= z + 1; ++nz)
+    {
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+        {
+            if (nx < 0 || nx >= m_gridWidth || nz < 0 || nz >= m_gridHeight) continue;
+            const Cell& c = m_grid[static_cast<size_t>(nz) * m_gridWidth + nx];
+            if (c.walkable && c.costMultiplier != 1.0f)
+                return true;
+        }
+    }
+    return false;
+}
+
+int NavMesh::Jump(int x, int z, int dx, int dz, int ex, int ez) const
+{
+    // Diagonal moves may not cut corners, so the forced-neighbour rules are the
+    // "no corner cutting" variant: a cardinal run stops where a side opens up,
+    // a diagonal run stops where either of its cardinal sub-runs finds a jump point.
+    while (true)
+    {
+        if (!IsJumpOpen(x, z))
+            return -1;
+
+        const int idx = z * m_gridWidth + x;
+        if (x == ex && z == ez)
+            return idx;
 
-        // Skip if already processed
-        if (closed[curIdx]) continue;
-        closed[curIdx] = true;
+        // Cells next to non-unit costs must be expanded normally
+        if (m_nonUniformCount > 0 && HasNonUniformNeighbour(x, z))
+            return idx;
 
-        // Goal reached
-        if (current.x == ex && current.z == ez)
+        if (dx != 0 && dz != 0)
         {
-            found = true;
-            break;
+            if (Jump(x + dx, z, dx, 0, ex, ez) >= 0 || Jump(x, z + dz, 0, dz, ex, ez) >= 0)
+                return idx;
+            if (!IsJumpOpen(x + dx, z) || !IsJumpOpen(x, z + dz))
+                return -1;
         }
+        else if (dx != 0)
+        {
+            if ((IsJumpOpen(x, z - 1) && !IsJumpOpen(x - dx, z - 1)) ||
+                (IsJumpOpen(x, z + 1) && !IsJumpOpen(x - dx, z + 1)))
+                return idx;
+        }
+        else
+        {
+            if ((IsJumpOpen(x - 1, z) && !IsJumpOpen(x - 1, z - dz)) ||
+                (IsJumpOpen(x + 1, z) && !IsJumpOpen(x + 1, z - dz)))
+                return idx;
+        }
+
+        x += dx;
+        z += dz;
+    }
+}
+
+// ============================================================================
+// FindPathHierarchical (HPA*)
+// ============================================================================
+bool NavMesh::FindPathHierarchical(int sx, int sz, int ex, int ez, std::vector<int>& cells,
+                                   PathQueryContext& context) const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+        if (m_hierarchyDirty)
+            RebuildDirtyClusters();
+    }
 
-        // Explore neighbours
-        for (int d = 0; d < 8; ++d)
+    const int startCell = sz * m_gridWidth + sx;
+    const int goalCell  = ez * m_gridWidth + ex;
+    const Cluster& startCluster = m_clusters[ClusterIndexOf(sx, sz)];
+    const Cluster& goalCluster  = m_clusters[ClusterIndexOf(ex, ez)];
+    const int startW = startCluster.maxX - startCluster.minX + 1;
+    const int goalW  = goalCluster.maxX - goalCluster.minX + 1;
+
+    auto localIndex = [](const Cluster& c, int w, int cell, int gridW) {
+        return (cell / gridW - c.minZ) * w + (cell % gridW - c.minX);
+    };
+
+    // Connect start and goal to their cluster's entrances with local searches.
+    // These are the only cells expanded at the low level; everything else comes
+    // from the cached intra-cluster paths.
+    ClusterSearchScratch& startSearch = context.GetClusterSearch(0);
+    ClusterSearchScratch& goalSearch  = context.GetClusterSearch(1);
+    SearchCluster(startCluster, startCell, false, startSearch);
+    SearchCluster(goalCluster,  goalCell,  true,  goalSearch);
+
+    // Abstract A*: entrance node i of cluster c is node c * stride + i,
+    // followed by two virtual nodes for the start and the goal
+    const int stride   = NodeStride();
+    const int startKey = static_cast<int>(m_clusters.size()) * stride;
+    const int goalKey  = startKey + 1;
+
+    auto nodeCell = [&](int key) {
+        return m_clusters[key / stride].nodes[key % stride].cell;
+    };
+    auto relax = [&](int from, int to, float g) {
+        float h = 0.0f;
+        if (to != goalKey)
         {
-            int nx = current.x + dx[d];
-            int nz = current.z + dz[d];
+            const int cell = nodeCell(to);
+            h = Heuristic(cell % m_gridWidth, cell / m_gridWidth, ex, ez);
+        }
+        context.Push(to, g, g + h, from);
+    };
 
-            if (nx < 0 || nx >= m_gridWidth || nz < 0 || nz >= m_gridHeight)
-                continue;
+    context.Begin(static_cast<size_t>(goalKey) + 1);
+    context.Push(startKey, 0.0f, Heuristic(sx, sz, ex, ez), -1);
 
-            size_t nIdx = static_cast<size_t>(nz) * m_gridWidth + nx;
-            if (closed[nIdx]) continue;
+    bool found = false;
+    while (!context.IsOpenEmpty())
+    {
+        const int key = context.PopMin();
+        const float g = context.GetCost(key);
 
-            const Cell& nCell = m_grid[nIdx];
-            if (!nCell.walkable) continue;
+        if (key == goalKey)
+        {
+            found = true;
+            break;
+        }
 
-            // For diagonal moves, check that both adjacent cardinal cells are walkable
-            // to prevent cutting corners around obstacles
-            if (dx[d] != 0 && dz[d] != 0)
+        if (key == startKey)
+        {
+            const int clusterBase = ClusterIndexOf(sx, sz) * stride;
+            for (size_t i = 0; i < startCluster.nodes.size(); ++i)
             {
-                size_t adjX = static_cast<size_t>(current.z) * m_gridWidth + nx;
-                size_t adjZ = static_cast<size_t>(nz) * m_gridWidth + current.x;
-                if (!m_grid[adjX].walkable || !m_grid[adjZ].walkable)
-                    continue;
+                float d = startSearch.dist[localIndex(startCluster, startW, startCluster.nodes[i].cell, m_gridWidth)];
+                if (d < FLT_MAX) relax(key, clusterBase + static_cast<int>(i), g + d);
             }
+            if (&startCluster == &goalCluster)
+            {
+                float d = startSearch.dist[localIndex(startCluster, startW, goalCell, m_gridWidth)];
+                if (d < FLT_MAX) relax(key, goalKey, g + d);
+            }
+            continue;
+        }
 
-            float stepCost = moveCost[d] * nCell.costMultiplier;
-            float tentativeG = gScore[curIdx] + stepCost;
+        const Cluster& cluster = m_clusters[key / stride];
+        const size_t nodeCount = cluster.nodes.size();
+        const size_t slot = static_cast<size_t>(key % stride);
+        const int clusterBase = key - static_cast<int>(slot);
 
-            if (tentativeG < gScore[nIdx])
-            {
-                gScore[nIdx]  = tentativeG;
-                parentX[nIdx] = current.x;
-                parentZ[nIdx] = current.z;
+        // Intra-cluster edges (cached)
+        for (size_t j = 0; j < nodeCount; ++j)
+        {
+            float c = cluster.costs[slot * nodeCount + j];
+            if (j != slot && c < FLT_MAX)
+                relax(key, clusterBase + static_cast<int>(j), g + c);
+        }
 
-                float h = Heuristic(nx, nz, ex, ez);
-                openList.push({ nx, nz, tentativeG, h, tentativeG + h, current.x, current.z });
-            }
+        // Inter-cluster edges (a single cardinal step across the border)
+        for (int link : cluster.nodes[slot].links)
+        {
+            const int linkKey = link >= 0 ? EntranceNodeOf(link) : -1;
+            if (linkKey >= 0)
+                relax(key, linkKey, g + m_grid[link].costMultiplier);
+        }
+
+        // Edge to the goal
+        if (&cluster == &goalCluster)
+        {
+            float d = goalSearch.dist[localIndex(goalCluster, goalW, cluster.nodes[slot].cell, m_gridWidth)];
+            if (d < FLT_MAX) relax(key, goalKey, g + d);
         }
     }
 
     if (!found) return false;
 
-    // Reconstruct path (from end to start)
-    std::vector<XMFLOAT3> reversePath;
-    int cx = ex, cz = ez;
-    while (cx != -1 && cz != -1)
+    // Collect the abstract path (start -> goal)
+    std::vector<int>& keys = context.GetNodePath();
+    keys.clear();
+    for (int key = goalKey; key != -1; key = context.GetParent(key))
+        keys.push_back(key);
+    std::reverse(keys.begin(), keys.end());
+
+    // Refine: splice local search results and cached cluster paths
+    cells.clear();
+    cells.push_back(startCell);
+    for (size_t i = 1; i < keys.size(); ++i)
+    {
+        const int from = keys[i - 1];
+        const int to   = keys[i];
+
+        if (from == startKey)
+        {
+            // Walk the forward search tree back from the target
+            const int target = (to == goalKey) ? goalCell : nodeCell(to);
+            const size_t first = cells.size();
+            for (int li = localIndex(startCluster, startW, target, m_gridWidth); startSearch.parent[li] >= 0; li = startSearch.parent[li])
+                cells.push_back((startCluster.minZ + li / startW) * m_gridWidth + startCluster.minX + li % startW);
+            std::reverse(cells.begin() + first, cells.end());
+        }
+        else if (to == goalKey)
+        {
+            // The reverse search tree points towards the goal
+            for (int li = goalSearch.parent[localIndex(goalCluster, goalW, nodeCell(from), m_gridWidth)]; li >= 0; li = goalSearch.parent[li])
+                cells.push_back((goalCluster.minZ + li / goalW) * m_gridWidth + goalCluster.minX + li % goalW);
+        }
+        else if (from / stride == to / stride)
+        {
+            const Cluster& cluster = m_clusters[from / stride];
+            const auto& cached = cluster.paths[(from % stride) * cluster.nodes.size() + (to % stride)];
+            cells.insert(cells.end(), cached.begin(), cached.end());
+        }
+        else
+        {
+            cells.push_back(nodeCell(to));
+        }
+    }
+    return true;
+}
+
+int NavMesh::EntranceNodeOf(int cell) const
+{
+    const int cluster = ClusterIndexOf(cell % m_gridWidth, cell / m_gridWidth);
+    const auto& nodes = m_clusters[cluster].nodes;
+    for (size_t i = 0; i < nodes.size(); ++i)
     {
-        reversePath.push_back(CellToWorld(cx, cz));
-        size_t idx = static_cast<size_t>(cz) * m_gridWidth + cx;
-        int px = parentX[idx];
-        int pz = parentZ[idx];
-        cx = px;
-        cz = pz;
+        if (nodes[i].cell == cell)
+            return cluster * NodeStride() + static_cast<int>(i);
     }
+    return -1;
+}
 
-    // Reverse to get start->end order
-    path.reserve(reversePath.size());
-    for (int i = static_cast<int>(reversePath.size()) - 1; i >= 0; --i)
-        path.push_back(reversePath[i]);
+// ============================================================================
+// CellsToPath / CanStep
+// ============================================================================
+void NavMesh::CellsToPath(const std::vector<int>& cells, const XMFLOAT3& start, const XMFLOAT3& end,
+                          std::vector<XMFLOAT3>& path) const
+{
+    path.clear();
+    path.reserve(cells.size());
+    for (int cell : cells)
+        path.push_back(CellToWorld(cell % m_gridWidth, cell / m_gridWidth));
 
     // Set the first waypoint's height to start height and last to end height
     if (!path.empty())
@@ -436,10 +929,293 @@ bool NavMesh::FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
         path.front().y = start.y;
         path.back().y  = end.y;
     }
+}
 
+bool NavMesh::CanStep(int fromX, int fromZ, int toX, int toZ) const
+{
+    if (toX < 0 || toX >= m_gridWidth || toZ < 0 || toZ >= m_gridHeight)
+        return false;
+    if (!m_grid[static_cast<size_t>(toZ) * m_gridWidth + toX].walkable)
+        return false;
+
+    // Diagonal moves must not cut corners around obstacles
+    if (fromX != toX && fromZ != toZ)
+    {
+        if (!m_grid[static_cast<size_t>(fromZ) * m_gridWidth + toX].walkable ||
+            !m_grid[static_cast<size_t>(toZ) * m_gridWidth + fromX].walkable)
+            return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Hierarchy management
+// ============================================================================
+bool NavMesh::BuildHierarchy(int clusterSize)
+{
+    if (clusterSize < 4)
+    {
+        Logger::Error("NavMesh::BuildHierarchy - clusterSize must be >= 4");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+    m_clusterSize = clusterSize;
+    ResetClusters();
+    if (m_built)
+    {
+        RebuildDirtyClusters();
+
+        size_t nodeCount = 0;
+        for (const auto& cluster : m_clusters)
+            nodeCount += cluster.nodes.size();
+        Logger::Info("NavMesh::BuildHierarchy - %dx%d clusters, %zu entrance nodes",
+                     m_clustersX, m_clustersZ, nodeCount);
+    }
     return true;
 }
 
+void NavMesh::ClearHierarchy()
+{
+    std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+    m_clusterSize = 0;
+    m_clustersX = m_clustersZ = 0;
+    m_clusters.clear();
+    m_hierarchyDirty = false;
+}
+
+void NavMesh::UpdateHierarchy()
+{
+    std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+    if (m_hierarchyDirty)
+        RebuildDirtyClusters();
+}
+
+void NavMesh::ResetClusters()
+{
+    m_clusters.clear();
+    m_clustersX = m_clustersZ = 0;
+    if (m_clusterSize <= 0 || m_gridWidth <= 0 || m_gridHeight <= 0)
+    {
+        m_hierarchyDirty = false;
+        return;
+    }
+
+    m_clustersX = (m_gridWidth  + m_clusterSize - 1) / m_clusterSize;
+    m_clustersZ = (m_gridHeight + m_clusterSize - 1) / m_clusterSize;
+    m_clusters.resize(static_cast<size_t>(m_clustersX) * m_clustersZ);
+
+    for (int cz = 0; cz < m_clustersZ; ++cz)
+    {
+        for (int cx = 0; cx < m_clustersX; ++cx)
+        {
+            Cluster& c = m_clusters[static_cast<size_t>(cz) * m_clustersX + cx];
+            c.minX = cx * m_clusterSize;
+            c.minZ = cz * m_clusterSize;
+            c.maxX = std::min(m_gridWidth,  c.minX + m_clusterSize) - 1;
+            c.maxZ = std::min(m_gridHeight, c.minZ + m_clusterSize) - 1;
+            c.dirty = true;
+        }
+    }
+    m_hierarchyDirty = true;
+}
+
+void NavMesh::InvalidateCluster(int cellX, int cellZ, bool includeNeighbours)
+{
+    if (m_clusterSize <= 0 || m_clusters.empty()) return;
+
+    std::lock_guard<std::mutex> lock(m_hierarchyMutex);
+    const int cx = cellX / m_clusterSize;
+    const int cz = cellZ / m_clusterSize;
+    m_clusters[static_cast<size_t>(cz) * m_clustersX + cx].dirty = true;
+    m_hierarchyDirty = true;
+
+    if (!includeNeighbours) return;
+
+    // Entrances on a border depend on the cells on both sides of it
+    const Cluster& c = m_clusters[static_cast<size_t>(cz) * m_clustersX + cx];
+    if (cellX == c.minX && cx > 0)               m_clusters[static_cast<size_t>(cz) * m_clustersX + cx - 1].dirty = true;
+    if (cellX == c.maxX && cx + 1 < m_clustersX) m_clusters[static_cast<size_t>(cz) * m_clustersX + cx + 1].dirty = true;
+    if (cellZ == c.minZ && cz > 0)               m_clusters[static_cast<size_t>(cz - 1) * m_clustersX + cx].dirty = true;
+    if (cellZ == c.maxZ && cz + 1 < m_clustersZ) m_clusters[static_cast<size_t>(cz + 1) * m_clustersX + cx].dirty = true;
+}
+
+void NavMesh::RebuildDirtyClusters() const
+{
+    for (auto& cluster : m_clusters)
+    {
+        if (cluster.dirty)
+        {
+            RebuildCluster(cluster);
+            cluster.dirty = false;
+        }
+    }
+    m_hierarchyDirty = false;
+}
+
+void NavMesh::RebuildCluster(Cluster& cluster) const
+{
+    // Borders with open runs longer than this get an entrance at each end,
+    // shorter ones a single entrance in the middle
+    constexpr int k_EntranceSplitLength = 6;
+
+    cluster.nodes.clear();
+    cluster.costs.clear();
+    cluster.paths.clear();
+
+    auto walkable = [this](int x, int z) {
+        return m_grid[static_cast<size_t>(z) * m_gridWidth + x].walkable;
+    };
+    auto addNode = [&](int x, int z, int linkX, int linkZ) {
+        const int cell = z * m_gridWidth + x;
+        const int link = linkZ * m_gridWidth + linkX;
+        for (auto& node : cluster.nodes)
+        {
+            if (node.cell != cell) continue;
+            for (int& l : node.links)
+            {
+                if (l < 0) { l = link; break; }
+            }
+            return;
+        }
+        ClusterNode node;
+        node.cell = cell;
+        node.links[0] = link;
+        cluster.nodes.push_back(node);
+    };
+
+    // Scan one border. Both clusters sharing the border scan it in the same
+    // order, so they agree on where the entrance pairs are.
+    auto scanBorder = [&](int ax, int az, int bx, int bz, int stepX, int stepZ, int length) {
+        int runStart = -1;
+        for (int i = 0; i <= length; ++i)
+        {
+            bool open = i < length &&
+                        walkable(ax + stepX * i, az + stepZ * i) &&
+                        walkable(bx + stepX * i, bz + stepZ * i);
+            if (open)
+            {
+                if (runStart < 0) runStart = i;
+                continue;
+            }
+            if (runStart < 0) continue;
+
+            const int runEnd = i - 1;
+            if (runEnd - runStart + 1 >= k_EntranceSplitLength)
+            {
+                addNode(ax + stepX * runStart, az + stepZ * runStart, bx + stepX * runStart, bz + stepZ * runStart);
+                addNode(ax + stepX * runEnd,   az + stepZ * runEnd,   bx + stepX * runEnd,   bz + stepZ * runEnd);
+            }
+            else
+            {
+                const int mid = (runStart + runEnd) / 2;
+                addNode(ax + stepX * mid, az + stepZ * mid, bx + stepX * mid, bz + stepZ * mid);
+            }
+            runStart = -1;
+        }
+    };
+
+    const int w = cluster.maxX - cluster.minX + 1;
+    const int h = cluster.maxZ - cluster.minZ + 1;
+    if (cluster.minX > 0)                scanBorder(cluster.minX, cluster.minZ, cluster.minX - 1, cluster.minZ, 0, 1, h);
+    if (cluster.maxX < m_gridWidth - 1)  scanBorder(cluster.maxX, cluster.minZ, cluster.maxX + 1, cluster.minZ, 0, 1, h);
+    if (cluster.minZ > 0)                scanBorder(cluster.minX, cluster.minZ, cluster.minX, cluster.minZ - 1, 1, 0, w);
+    if (cluster.maxZ < m_gridHeight - 1) scanBorder(cluster.minX, cluster.maxZ, cluster.minX, cluster.maxZ + 1, 1, 0, w);
+
+    // Intra-cluster path cache: one Dijkstra per entrance gives the paths to all others
+    const size_t n = cluster.nodes.size();
+    cluster.costs.assign(n * n, FLT_MAX);
+    cluster.paths.resize(n * n);
+
+    ClusterSearchScratch search;
+    const std::vector<float>& dist   = search.dist;
+    const std::vector<int>&   parent = search.parent;
+    for (size_t i = 0; i < n; ++i)
+    {
+        SearchCluster(cluster, cluster.nodes[i].cell, false, search);
+        cluster.costs[i * n + i] = 0.0f;
+
+        for (size_t j = 0; j < n; ++j)
+        {
+            if (i == j) continue;
+            const int cell = cluster.nodes[j].cell;
+            int li = (cell / m_gridWidth - cluster.minZ) * w + (cell % m_gridWidth - cluster.minX);
+            if (dist[li] == FLT_MAX) continue;
+
+            cluster.costs[i * n + j] = dist[li];
+            auto& cached = cluster.paths[i * n + j];
+            for (; parent[li] >= 0; li = parent[li])
+                cached.push_back((cluster.minZ + li / w) * m_gridWidth + cluster.minX + li % w);
+            std::reverse(cached.begin(), cached.end());
+        }
+    }
+}
+
+void NavMesh::SearchCluster(const Cluster& cluster, int sourceCell, bool reverse,
+                            ClusterSearchScratch& search) const
+{
+    static const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    static const int dz[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static const float moveCost[] = { 1.414f, 1.0f, 1.414f, 1.0f, 1.0f, 1.414f, 1.0f, 1.414f };
+
+    const int w = cluster.maxX - cluster.minX + 1;
+    const int h = cluster.maxZ - cluster.minZ + 1;
+    std::vector<float>& dist   = search.dist;
+    std::vector<int>&   parent = search.parent;
+    dist.assign(static_cast<size_t>(w) * h, FLT_MAX);
+    parent.assign(static_cast<size_t>(w) * h, -1);
+
+    // Binary heap on a reused vector (same order as a std::priority_queue with std::greater)
+    auto& open = search.open;
+    open.clear();
+    const std::greater<std::pair<float, int>> later;
+
+    const int source = (sourceCell / m_gridWidth - cluster.minZ) * w + (sourceCell % m_gridWidth - cluster.minX);
+    dist[source] = 0.0f;
+    open.push_back({ 0.0f, source });
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), later);
+        auto [d, cur] = open.back();
+        open.pop_back();
+        if (d > dist[cur]) continue;
+
+        const int cx = cluster.minX + cur % w;
+        const int cz = cluster.minZ + cur / w;
+        for (int k = 0; k < 8; ++k)
+        {
+            const int nx = cx + dx[k];
+            const int nz = cz + dz[k];
+            if (nx < cluster.minX || nx > cluster.maxX || nz < cluster.minZ || nz > cluster.maxZ)
+                continue;
+
+            // Forward: cost of entering the neighbour.
+            // Reverse: cost of the step neighbour -> current (entering current).
+            float step;
+            if (reverse)
+            {
+                if (!CanStep(nx, nz, cx, cz)) continue;
+                step = moveCost[k] * m_grid[static_cast<size_t>(cz) * m_gridWidth + cx].costMultiplier;
+            }
+            else
+            {
+                if (!CanStep(cx, cz, nx, nz)) continue;
+                step = moveCost[k] * m_grid[static_cast<size_t>(nz) * m_gridWidth + nx].costMultiplier;
+            }
+
+            const int ni = (nz - cluster.minZ) * w + (nx - cluster.minX);
+            if (d + step < dist[ni])
+            {
+                dist[ni] = d + step;
+                parent[ni] = cur;
+                open.push_back({ dist[ni], ni });
+                std::push_heap(open.begin(), open.end(), later);
+            }
+        }
+    }
+}
+
 // ============================================================================
 // FindNearestWalkable (spiral search)
 // ============================================================================
@@ -504,6 +1280,16 @@ bool NavMesh::IsWalkable(const XMFLOAT3& position) const
     return m_grid[static_cast<size_t>(cz) * m_gridWidth + cx].walkable;
 }
 
+bool NavMesh::GetCellAt(const XMFLOAT3& position, int& cellX, int& cellZ) const
+{
+    if (!m_built) return false;
+
+    WorldToCell(position.x, position.z, cellX, cellZ);
+    cellX = std::max(0, std::min(m_gridWidth - 1, cellX));
+    cellZ = std::max(0, std::min(m_gridHeight - 1, cellZ));
+    return true;
+}
+
 // ============================================================================
 // DebugDraw
 // ============================================================================
@@ -5,13 +5,18 @@
 /// Recast/Detour not used. Lightweight standalone implementation.
 /// Divides world space into a cell grid, determines walkable cells from
 /// height map data (terrain sampling or manual geometry), and runs
-/// A* search for shortest paths.
+/// A* search for shortest paths. Searches run on a reusable
+/// PathQueryContext and use Jump Point Search through uniform-cost
+/// areas. Large grids can additionally build a hierarchical
+/// abstraction (HPA*) to keep long queries cheap.
 
 #include "pch.h"
 
 namespace GX
 {
 
+class PathQueryContext;
+struct ClusterSearchScratch;
 class Terrain;
 class PrimitiveBatch3D;
 
@@ -54,6 +59,32 @@ public:
                            const int* indices, int indexCount,
                            float maxClimb = 0.9f, float maxSlope = 45.0f);
 
+    // -- Serialization (.gxnav) --
+
+    /// @brief Serialize the built grid to a .gxnav blob
+    ///
+    /// Heights are quantized to 16 bits over the grid's height range. Cost
+    /// multipliers are exact in steps of 1/16 up to 10 and logarithmic (~6%
+    /// steps) up to ~2416; values outside that range are clamped with a warning
+    /// (see gxfmt::EncodeGxnavCost). The cluster size is stored so a loaded
+    /// navmesh gets the same hierarchy.
+    /// @param out Output: blob (see gxformat/gxnav.h)
+    /// @return false if the navmesh is not built
+    bool Serialize(std::vector<uint8_t>& out) const;
+
+    /// @brief Serialize the built grid and write it to a file
+    bool SaveToFile(const std::string& path) const;
+
+    /// @brief Load a .gxnav blob directly from memory (memory-mapped file, .gxpak entry, ...)
+    ///
+    /// The blob is validated and decoded in a single pass; the buffer is not
+    /// retained. Unknown sections are skipped.
+    /// @return false if the blob is malformed (the navmesh is left unchanged)
+    bool LoadFromMemory(const void* data, size_t size);
+
+    /// @brief Load a .gxnav file through the FileSystem (falls back to direct file I/O)
+    bool LoadFromFile(const std::string& path);
+
     /// @brief Manually set a cell's walkable state
     void SetCellWalkable(int cellX, int cellZ, bool walkable);
 
@@ -61,6 +92,7 @@ public:
     void SetCellCost(int cellX, int cellZ, float costMultiplier);
 
     /// @brief Find a path between two world positions using A*
+    ///        (HPA* when BuildHierarchy() has been called)
     /// @param start Start world position
     /// @param end   Goal world position
     /// @param path  Output: waypoints in world coordinates
@@ -68,12 +100,62 @@ public:
     bool FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
                   std::vector<XMFLOAT3>& path) const;
 
+    /// @brief Find a path using caller-provided search scratch state
+    ///
+    /// The overload without a context uses PathQueryContext::ForCurrentThread().
+    /// @param context Search state (must not be used by another thread concurrently)
+    bool FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
+                  std::vector<XMFLOAT3>& path, PathQueryContext& context) const;
+
+    /// @brief Enable/disable Jump Point Search through cells with costMultiplier == 1
+    ///
+    /// JPS returns paths of the same cost as plain A* while expanding far fewer
+    /// nodes in open areas. Cells with other costs are always expanded normally.
+    void SetJumpPointSearch(bool enable) { m_useJumpPoints = enable; }
+
+    /// @brief Check if Jump Point Search is enabled (default: true)
+    bool IsJumpPointSearchEnabled() const { return m_useJumpPoints; }
+
     /// @brief Find the nearest walkable cell to a world position
     bool FindNearestWalkable(const XMFLOAT3& position, XMFLOAT3& nearest) const;
 
     /// @brief Check if a world position is on a walkable cell
     bool IsWalkable(const XMFLOAT3& position) const;
 
+    /// @brief Get the cell containing a world position (clamped to the grid)
+    /// @return false if the navmesh is not built
+    bool GetCellAt(const XMFLOAT3& position, int& cellX, int& cellZ) const;
+
+    // -- Hierarchical pathfinding (HPA*) --
+
+    /// @brief Build the cluster hierarchy used to accelerate FindPath on large grids
+    ///
+    /// The grid is divided into square clusters. Entrance nodes are placed on the
+    /// borders between neighbouring clusters and the paths between the entrances
+    /// of each cluster are precomputed and cached. With the hierarchy built,
+    /// FindPath searches the small abstract graph and only expands cells inside
+    /// the start and goal clusters, concatenating cached paths elsewhere.
+    /// Resulting paths may be slightly longer than plain A* (a few percent).
+    ///
+    /// SetCellWalkable / SetCellCost invalidate only the affected clusters;
+    /// they are rebuilt by UpdateHierarchy() or lazily by the next query.
+    /// The hierarchy survives a rebuild of the grid (all clusters become dirty).
+    /// @param clusterSize Cluster edge length in cells (minimum 4)
+    /// @return true on success
+    bool BuildHierarchy(int clusterSize = 16);
+
+    /// @brief Discard the hierarchy (FindPath falls back to plain A*)
+    void ClearHierarchy();
+
+    /// @brief Rebuild clusters invalidated by cell edits since the last update
+    void UpdateHierarchy();
+
+    /// @brief Check if the hierarchical abstraction is enabled
+    bool HasHierarchy() const { return m_clusterSize > 0; }
+
+    /// @brief Get the cluster edge length in cells (0 if no hierarchy)
+    int GetClusterSize() const { return m_clusterSize; }
+
     /// @brief Debug draw using PrimitiveBatch3D (green = walkable, red = blocked)
     void DebugDraw(PrimitiveBatch3D& batch) const;
 
@@ -88,6 +170,8 @@ public:
     bool  IsBuilt()       const { return m_built; }
 
 private:
+    friend class FlowField;   // Reads cells and the cluster hierarchy directly
+
     /// @brief Internal cell data
     struct Cell
     {
@@ -96,17 +180,83 @@ private:
         float costMultiplier = 1.0f;   ///< Cost modifier (1.0 = normal)
     };
 
-    /// @brief A* search node (used during pathfinding)
-    struct AStarNode
+    /// @brief Entrance node of a cluster (a walkable cell on a cluster border)
+    struct ClusterNode
     {
-        int   x, z;
-        float g, h, f;
-        int   parentX, parentZ;
+        int cell = -1;                          ///< Grid index of the entrance cell
+        int links[4] = { -1, -1, -1, -1 };      ///< Grid indices of paired entrance cells in neighbouring clusters
+    };
 
-        /// For priority queue (min-heap by f)
-        bool operator>(const AStarNode& other) const { return f > other.f; }
+    /// @brief Cached abstraction of one cluster
+    struct Cluster
+    {
+        int minX = 0, minZ = 0;                 ///< First cell (inclusive)
+        int maxX = 0, maxZ = 0;                 ///< Last cell (inclusive)
+        std::vector<ClusterNode> nodes;         ///< Entrance nodes
+        std::vector<float> costs;               ///< nodes x nodes path costs (FLT_MAX = unreachable)
+        std::vector<std::vector<int>> paths;    ///< nodes x nodes cell paths (first cell excluded)
+        bool dirty = true;                      ///< Needs rebuilding before use
     };
 
+    /// A* / JPS over the full grid (cell indices from start to goal)
+    bool FindPathGrid(int sx, int sz, int ex, int ez, std::vector<int>& cells,
+                      PathQueryContext& context) const;
+
+    /// JPS: cell is walkable with unit cost (treated as open space)
+    bool IsJumpOpen(int x, int z) const
+    {
+        if (x < 0 || x >= m_gridWidth || z < 0 || z >= m_gridHeight) return false;
+        const Cell& c = m_grid[static_cast<size_t>(z) * m_gridWidth + x];
+        return c.walkable && c.costMultiplier == 1.0f;
+    }
+
+    /// JPS: cell touches a walkable cell whose cost is not 1
+    bool HasNonUniformNeighbour(int x, int z) const;
+
+    /// JPS: scan from (x, z) in direction (dx, dz); returns the jump point cell index or -1
+    int Jump(int x, int z, int dx, int dz, int ex, int ez) const;
+
+    /// HPA* over the cluster hierarchy (cell indices from start to goal).
+    /// The abstract search runs on the context's node records, indexed by entrance node.
+    bool FindPathHierarchical(int sx, int sz, int ex, int ez, std::vector<int>& cells,
+                              PathQueryContext& context) const;
+
+    /// Entrance node slots reserved per cluster (a cluster has at most one node per border cell)
+    int NodeStride() const { return 4 * m_clusterSize; }
+
+    /// Abstract node index of an entrance cell (cluster * NodeStride() + slot), -1 if not an entrance
+    int EntranceNodeOf(int cell) const;
+
+    /// Convert a cell index path into world waypoints
+    void CellsToPath(const std::vector<int>& cells, const XMFLOAT3& start, const XMFLOAT3& end,
+                     std::vector<XMFLOAT3>& path) const;
+
+    /// Check if a single 8-directional step is allowed (bounds, walkable, no corner cutting)
+    bool CanStep(int fromX, int fromZ, int toX, int toZ) const;
+
+    /// Allocate the cluster layout for the current grid (all clusters dirty)
+    void ResetClusters();
+
+    /// Mark the cluster containing a cell dirty (and neighbours if the cell is on a border)
+    void InvalidateCluster(int cellX, int cellZ, bool includeNeighbours);
+
+    /// Rebuild every dirty cluster (caller holds m_hierarchyMutex)
+    void RebuildDirtyClusters() const;
+
+    /// Recompute a cluster's entrances and intra-cluster path cache
+    void RebuildCluster(Cluster& cluster) const;
+
+    /// Dijkstra restricted to a cluster. reverse=true computes costs *to* the source.
+    /// search.dist/parent are indexed by cluster-local cell index.
+    void SearchCluster(const Cluster& cluster, int sourceCell, bool reverse,
+                       ClusterSearchScratch& search) const;
+
+    /// Cluster index that contains a cell
+    int ClusterIndexOf(int cellX, int cellZ) const
+    {
+        return (cellZ / m_clusterSize) * m_clustersX + (cellX / m_clusterSize);
+    }
+
     /// World coords -> cell indices
     void WorldToCell(float worldX, float worldZ, int& cellX, int& cellZ) const;
 
@@ -126,6 +276,16 @@ private:
     float m_worldMinX  = 0.0f;
     float m_worldMinZ  = 0.0f;
     bool  m_built      = false;
+    bool  m_useJumpPoints   = true;
+    int   m_nonUniformCount = 0;    ///< Cells with costMultiplier != 1 (0 = JPS needs no cost checks)
+
+    // Hierarchy (clusters are rebuilt lazily from const queries)
+    int m_clusterSize = 0;
+    int m_clustersX   = 0;
+    int m_clustersZ   = 0;
+    mutable std::vector<Cluster> m_clusters;
+    mutable bool                 m_hierarchyDirty = false;
+    mutable std::mutex           m_hierarchyMutex;
 };
 
 } // namespace GX
@@ -0,0 +1,2275 @@
+#include "pch.h"
+/// @file NavPolyMesh.cpp
+/// @brief Tiled polygon navigation mesh (Recast-style build pipeline)
+
+#include "AI/NavPolyMesh.h"
+#include "AI/PathQueryContext.h"
+#include "Graphics/3D/PrimitiveBatch3D.h"
+#include "Core/Logger.h"
+
+namespace GX
+{
+
+namespace
+{
+
+// Direction convention shared by every stage: 0 = -X, 1 = +Z, 2 = +X, 3 = -Z
+const int k_DirX[4] = { -1, 0, 1, 0 };
+const int k_DirZ[4] = { 0, 1, 0, -1 };
+
+constexpr int      k_SpanMaxHeight  = 0xFFFF;
+constexpr int      k_NotConnected   = -1;
+constexpr uint16_t k_BorderRegion   = 0x8000;   ///< Region id flag for the tile border padding
+constexpr int      k_RegionMask     = 0xFFFF;
+constexpr int      k_AreaBorderFlag = 0x20000;  ///< Contour vertex flag: edge between walkable/unwalkable
+constexpr uint16_t k_ExternalEdge   = 0x8000;   ///< Poly neighbour flag: edge lies on the tile border
+constexpr int      k_MaxVerts       = NavPolyTile::k_MaxVertsPerPoly;
+
+// ============================================================================
+// Heightfield (solid spans per column)
+// ============================================================================
+struct Span
+{
+    uint16_t smin;
+    uint16_t smax;
+    bool     walkable;
+};
+
+struct Heightfield
+{
+    int width = 0, depth = 0;
+    float bminX = 0.0f, bminY = 0.0f, bminZ = 0.0f;
+    float cs = 0.0f, ch = 0.0f;
+    std::vector<std::vector<Span>> columns;   ///< Sorted bottom to top, non-overlapping
+
+    /// Insert a span, merging it with the spans it overlaps
+    void AddSpan(int x, int z, uint16_t smin, uint16_t smax, bool walkable, int mergeThreshold)
+    {
+        auto& column = columns[static_cast<size_t>(z) * width + x];
+        Span s = { smin, smax, walkable };
+
+        size_t insertAt = 0;
+        for (size_t i = 0; i < column.size(); )
+        {
+            Span& cur = column[i];
+            if (cur.smin > s.smax)
+                break;
+            if (cur.smax < s.smin)
+            {
+                insertAt = ++i;
+                continue;
+            }
+
+            // Overlap: merge into the new span
+            if (cur.smin < s.smin) s.smin = cur.smin;
+            if (cur.smax > s.smax) s.smax = cur.smax;
+            if (std::abs(static_cast<int>(s.smax) - static_cast<int>(cur.smax)) <= mergeThreshold)
+                s.walkable = s.walkable || cur.walkable;
+            column.erase(column.begin() + i);
+        }
+        column.insert(column.begin() + insertAt, s);
+    }
+};
+
+/// Split a convex polygon by the plane coord[axis] = split.
+/// out1 receives the part below the plane, out2 the part above.
+void DividePoly(const float* in, int nin, float* out1, int& nout1, float* out2, int& nout2,
+                float split, int axis)
+{
+    float d[12];
+    for (int i = 0; i < nin; ++i)
+        d[i] = split - in[i * 3 + axis];
+
+    int m = 0, n = 0;
+    for (int i = 0, j = nin - 1; i < nin; j = i, ++i)
+    {
+        const bool ina = d[j] >= 0.0f;
+        const bool inb = d[i] >= 0.0f;
+        if (ina != inb)
+        {
+            const float s = d[j] / (d[j] - d[i]);
+            for (int k = 0; k < 3; ++k)
+            {
+                out1[m * 3 + k] = in[j * 3 + k] + (in[i * 3 + k] - in[j * 3 + k]) * s;
+                out2[n * 3 + k] = out1[m * 3 + k];
+            }
+            ++m;
+            ++n;
+            // Points on the dividing line go to neither side a second time
+            if (d[i] > 0.0f)
+            {
+                std::memcpy(&out1[m * 3], &in[i * 3], sizeof(float) * 3);
+                ++m;
+            }
+            else if (d[i] < 0.0f)
+            {
+                std::memcpy(&out2[n * 3], &in[i * 3], sizeof(float) * 3);
+                ++n;
+            }
+        }
+        else
+        {
+            if (d[i] >= 0.0f)
+            {
+                std::memcpy(&out1[m * 3], &in[i * 3], sizeof(float) * 3);
+                ++m;
+                if (d[i] != 0.0f)
+                    continue;
+            }
+            std::memcpy(&out2[n * 3], &in[i * 3], sizeof(float) * 3);
+            ++n;
+        }
+    }
+    nout1 = m;
+    nout2 = n;
+}
+
+/// Rasterize a triangle into the heightfield by clipping it against each cell
+void RasterizeTriangle(Heightfield& hf, const float* v0, const float* v1, const float* v2,
+                       bool walkable, float maxY, int mergeThreshold)
+{
+    const float bmaxX = hf.bminX + hf.width * hf.cs;
+    const float bmaxZ = hf.bminZ + hf.depth * hf.cs;
+    const float triMinX = std::min({ v0[0], v1[0], v2[0] });
+    const float triMaxX = std::max({ v0[0], v1[0], v2[0] });
+    const float triMinZ = std::min({ v0[2], v1[2], v2[2] });
+    const float triMaxZ = std::max({ v0[2], v1[2], v2[2] });
+    if (triMaxX < hf.bminX || triMinX > bmaxX || triMaxZ < hf.bminZ || triMinZ > bmaxZ)
+        return;
+
+    const float ics = 1.0f / hf.cs;
+    const float ich = 1.0f / hf.ch;
+    const float rangeY = maxY - hf.bminY;
+
+    int z0 = static_cast<int>((triMinZ - hf.bminZ) * ics);
+    int z1 = static_cast<int>((triMaxZ - hf.bminZ) * ics);
+    z0 = std::max(0, std::min(hf.depth - 1, z0));
+    z1 = std::max(0, std::min(hf.depth - 1, z1));
+
+    // Clipping a triangle against axis planes yields at most 7 vertices
+    float bufA[12 * 3], bufB[12 * 3], row[12 * 3], cellA[12 * 3], cellB[12 * 3], cell[12 * 3];
+    std::memcpy(&bufA[0], v0, sizeof(float) * 3);
+    std::memcpy(&bufA[3], v1, sizeof(float) * 3);
+    std::memcpy(&bufA[6], v2, sizeof(float) * 3);
+    int nvIn = 3;
+    float* rest = bufA;
+    float* tmp  = bufB;
+
+    for (int z = z0; z <= z1; ++z)
+    {
+        const float cz = hf.bminZ + z * hf.cs;
+        int nvRow = 0, nvRest = 0;
+        DividePoly(rest, nvIn, row, nvRow, tmp, nvRest, cz + hf.cs, 2);
+        std::swap(rest, tmp);
+        nvIn = nvRest;
+        if (nvRow < 3) continue;
+
+        float minX = row[0], maxX = row[0];
+        for (int i = 1; i < nvRow; ++i)
+        {
+            minX = std::min(minX, row[i * 3]);
+            maxX = std::max(maxX, row[i * 3]);
+        }
+        int x0 = static_cast<int>((minX - hf.bminX) * ics);
+        int x1 = static_cast<int>((maxX - hf.bminX) * ics);
+        x0 = std::max(0, std::min(hf.width - 1, x0));
+        x1 = std::max(0, std::min(hf.width - 1, x1));
+
+        std::memcpy(cellA, row, sizeof(float) * 3 * nvRow);
+        float* cellRest = cellA;
+        float* cellTmp  = cellB;
+
+        int nv2 = nvRow;
+        for (int x = x0; x <= x1; ++x)
+        {
+            const float cx = hf.bminX + x * hf.cs;
+            int nv = 0, nvNext = 0;
+            DividePoly(cellRest, nv2, cell, nv, cellTmp, nvNext, cx + hf.cs, 0);
+            std::swap(cellRest, cellTmp);
+            nv2 = nvNext;
+            if (nv < 3) continue;
+
+            float smin = cell[1], smax = cell[1];
+            for (int i = 1; i < nv; ++i)
+            {
+                smin = std::min(smin, cell[i * 3 + 1]);
+                smax = std::max(smax, cell[i * 3 + 1]);
+            }
+            smin -= hf.bminY;
+            smax -= hf.bminY;
+            if (smax < 0.0f || smin > rangeY) continue;
+            smin = std::max(0.0f, smin);
+            smax = std::min(rangeY, smax);
+
+            const int ismin = std::max(0, std::min(k_SpanMaxHeight, static_cast<int>(std::floor(smin * ich))));
+            const int ismax = std::max(ismin + 1, std::min(k_SpanMaxHeight, static_cast<int>(std::ceil(smax * ich))));
+            hf.AddSpan(x, z, static_cast<uint16_t>(ismin), static_cast<uint16_t>(ismax), walkable, mergeThreshold);
+        }
+    }
+}
+
+/// Let walkable surfaces continue over small obstacles (curbs, stair steps)
+void FilterLowHangingObstacles(Heightfield& hf, int walkableClimb)
+{
+    for (auto& column : hf.columns)
+    {
+        bool previousWalkable = false;
+        int previousTop = 0;
+        for (auto& s : column)
+        {
+            const bool walkable = s.walkable;
+            if (!walkable && previousWalkable && std::abs(static_cast<int>(s.smax) - previousTop) <= walkableClimb)
+                s.walkable = true;
+            previousWalkable = walkable;
+            previousTop = s.smax;
+        }
+    }
+}
+
+/// Remove walkable spans next to drops larger than walkableClimb, or on steep stairs
+void FilterLedgeSpans(Heightfield& hf, int walkableHeight, int walkableClimb)
+{
+    for (int z = 0; z < hf.depth; ++z)
+    {
+        for (int x = 0; x < hf.width; ++x)
+        {
+            auto& column = hf.columns[static_cast<size_t>(z) * hf.width + x];
+            for (size_t si = 0; si < column.size(); ++si)
+            {
+                Span& s = column[si];
+                if (!s.walkable) continue;
+
+                const int bot = s.smax;
+                const int top = (si + 1 < column.size()) ? column[si + 1].smin : k_SpanMaxHeight;
+                int minh = k_SpanMaxHeight;
+                int asmin = s.smax, asmax = s.smax;
+
+                for (int dir = 0; dir < 4; ++dir)
+                {
+                    const int nx = x + k_DirX[dir];
+                    const int nz = z + k_DirZ[dir];
+                    if (nx < 0 || nz < 0 || nx >= hf.width || nz >= hf.depth)
+                    {
+                        minh = std::min(minh, -walkableClimb - bot);
+                        continue;
+                    }
+
+                    const auto& ncol = hf.columns[static_cast<size_t>(nz) * hf.width + nx];
+                    // From minus infinity to the first span
+                    int nbot = -walkableClimb;
+                    int ntop = ncol.empty() ? k_SpanMaxHeight : ncol[0].smin;
+                    if (std::min(top, ntop) - std::max(bot, nbot) > walkableHeight)
+                        minh = std::min(minh, nbot - bot);
+
+                    for (size_t ni = 0; ni < ncol.size(); ++ni)
+                    {
+                        nbot = ncol[ni].smax;
+                        ntop = (ni + 1 < ncol.size()) ? ncol[ni + 1].smin : k_SpanMaxHeight;
+                        if (std::min(top, ntop) - std::max(bot, nbot) > walkableHeight)
+                        {
+                            minh = std::min(minh, nbot - bot);
+                            if (std::abs(nbot - bot) <= walkableClimb)
+                            {
+                                asmin = std::min(asmin, nbot);
+                                asmax = std::max(asmax, nbot);
+                            }
+                        }
+                    }
+                }
+
+                if (minh < -walkableClimb)
+                    s.walkable = false;
+                else if (asmax - asmin > walkableClimb)
+                    s.walkable = false;
+            }
+        }
+    }
+}
+
+/// Remove walkable spans without enough head room
+void FilterLowHeightSpans(Heightfield& hf, int walkableHeight)
+{
+    for (auto& column : hf.columns)
+    {
+        for (size_t i = 0; i < column.size(); ++i)
+        {
+            const int bot = column[i].smax;
+            const int top = (i + 1 < column.size()) ? column[i + 1].smin : k_SpanMaxHeight;
+            if (top - bot < walkableHeight)
+                column[i].walkable = false;
+        }
+    }
+}
+
+// ============================================================================
+// Compact heightfield (open space above walkable spans)
+// ============================================================================
+struct CompactSpan
+{
+    uint16_t y = 0;          ///< Floor height
+    uint16_t h = 0;          ///< Clearance
+    int      con[4] = { k_NotConnected, k_NotConnected, k_NotConnected, k_NotConnected };  ///< Neighbour span index (absolute)
+    uint16_t reg = 0;
+    bool     walkable = true;
+};
+
+struct CompactCell
+{
+    uint32_t index = 0;
+    uint32_t count = 0;
+};
+
+struct CompactHeightfield
+{
+    int width = 0, depth = 0, border = 0;
+    std::vector<CompactCell> cells;
+    std::vector<CompactSpan> spans;
+};
+
+void BuildCompactHeightfield(const Heightfield& hf, int walkableHeight, int walkableClimb,
+                             CompactHeightfield& chf)
+{
+    chf.width = hf.width;
+    chf.depth = hf.depth;
+    chf.cells.assign(static_cast<size_t>(hf.width) * hf.depth, {});
+    chf.spans.clear();
+
+    for (size_t c = 0; c < hf.columns.size(); ++c)
+    {
+        const auto& column = hf.columns[c];
+        chf.cells[c].index = static_cast<uint32_t>(chf.spans.size());
+        for (size_t i = 0; i < column.size(); ++i)
+        {
+            if (!column[i].walkable) continue;
+            const int bot = column[i].smax;
+            const int top = (i + 1 < column.size()) ? column[i + 1].smin : k_SpanMaxHeight;
+            CompactSpan s;
+            s.y = static_cast<uint16_t>(bot);
+            s.h = static_cast<uint16_t>(std::min(k_SpanMaxHeight, top - bot));
+            chf.spans.push_back(s);
+        }
+        chf.cells[c].count = static_cast<uint32_t>(chf.spans.size()) - chf.cells[c].index;
+    }
+
+    // Connect neighbours that can be stepped to with enough head room
+    for (int z = 0; z < chf.depth; ++z)
+    {
+        for (int x = 0; x < chf.width; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * chf.width + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                CompactSpan& s = chf.spans[i];
+                for (int dir = 0; dir < 4; ++dir)
+                {
+                    const int nx = x + k_DirX[dir];
+                    const int nz = z + k_DirZ[dir];
+                    if (nx < 0 || nz < 0 || nx >= chf.width || nz >= chf.depth) continue;
+
+                    const CompactCell& ncell = chf.cells[static_cast<size_t>(nz) * chf.width + nx];
+                    for (uint32_t k = ncell.index; k < ncell.index + ncell.count; ++k)
+                    {
+                        const CompactSpan& ns = chf.spans[k];
+                        const int bot = std::max(s.y, ns.y);
+                        const int top = std::min(s.y + s.h, ns.y + ns.h);
+                        if (top - bot >= walkableHeight && std::abs(static_cast<int>(ns.y) - static_cast<int>(s.y)) <= walkableClimb)
+                        {
+                            s.con[dir] = static_cast<int>(k);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Erode the walkable area by the agent radius (breadth-first distance from boundaries)
+void ErodeWalkableArea(CompactHeightfield& chf, int radius)
+{
+    if (radius <= 0) return;
+
+    std::vector<int> dist(chf.spans.size(), INT_MAX);
+    std::vector<int> queue;
+    queue.reserve(chf.spans.size());
+
+    for (size_t i = 0; i < chf.spans.size(); ++i)
+    {
+        const CompactSpan& s = chf.spans[i];
+        if (!s.walkable) continue;
+        bool boundary = false;
+        for (int dir = 0; dir < 4 && !boundary; ++dir)
+            boundary = s.con[dir] == k_NotConnected || !chf.spans[s.con[dir]].walkable;
+        if (boundary)
+        {
+            dist[i] = 0;
+            queue.push_back(static_cast<int>(i));
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const int i = queue[head];
+        if (dist[i] + 1 >= radius) continue;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const int n = chf.spans[i].con[dir];
+            if (n == k_NotConnected || !chf.spans[n].walkable || dist[n] != INT_MAX) continue;
+            dist[n] = dist[i] + 1;
+            queue.push_back(n);
+        }
+    }
+
+    for (size_t i = 0; i < chf.spans.size(); ++i)
+    {
+        if (dist[i] < radius)
+            chf.spans[i].walkable = false;
+    }
+}
+
+/// Remove small isolated walkable islands that do not reach the tile border
+void RemoveSmallIslands(CompactHeightfield& chf, int minArea)
+{
+    if (minArea <= 1) return;
+
+    std::vector<int> component(chf.spans.size(), -1);
+    std::vector<int> stack;
+    std::vector<int> members;
+    int next = 0;
+
+    for (int z = 0; z < chf.depth; ++z)
+    {
+        for (int x = 0; x < chf.width; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * chf.width + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                if (!chf.spans[i].walkable || component[i] >= 0) continue;
+
+                members.clear();
+                bool touchesBorder = false;
+                stack.push_back(static_cast<int>(i));
+                component[i] = next;
+                while (!stack.empty())
+                {
+                    const int cur = stack.back();
+                    stack.pop_back();
+                    members.push_back(cur);
+                    for (int dir = 0; dir < 4; ++dir)
+                    {
+                        const int n = chf.spans[cur].con[dir];
+                        if (n == k_NotConnected || !chf.spans[n].walkable || component[n] >= 0) continue;
+                        component[n] = next;
+                        stack.push_back(n);
+                    }
+                }
+
+                // Locate member cells to test the border (spans are stored cell by cell)
+                if (static_cast<int>(members.size()) < minArea)
+                {
+                    for (int m : members)
+                    {
+                        auto it = std::upper_bound(chf.cells.begin(), chf.cells.end(), static_cast<uint32_t>(m),
+                            [](uint32_t value, const CompactCell& c) { return value < c.index; });
+                        const size_t c = static_cast<size_t>(it - chf.cells.begin()) - 1;
+                        const int cx = static_cast<int>(c % chf.width);
+                        const int cz = static_cast<int>(c / chf.width);
+                        if (cx < chf.border || cz < chf.border ||
+                            cx >= chf.width - chf.border || cz >= chf.depth - chf.border)
+                        {
+                            touchesBorder = true;
+                            break;
+                        }
+                    }
+                    if (!touchesBorder)
+                    {
+                        for (int m : members)
+                            chf.spans[m].walkable = false;
+                    }
+                }
+                ++next;
+            }
+        }
+    }
+}
+
+/// Partition the walkable area into monotone regions (no holes, cheap to build)
+void BuildRegionsMonotone(CompactHeightfield& chf)
+{
+    const int w = chf.width, d = chf.depth, border = chf.border;
+
+    // Tile padding gets one border region per side so that contours stop at the tile edge
+    auto paintRect = [&](int minX, int maxX, int minZ, int maxZ, uint16_t reg) {
+        for (int z = minZ; z < maxZ; ++z)
+        {
+            for (int x = minX; x < maxX; ++x)
+            {
+                const CompactCell& cell = chf.cells[static_cast<size_t>(z) * w + x];
+                for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+                {
+                    if (chf.spans[i].walkable)
+                        chf.spans[i].reg = reg;
+                }
+            }
+        }
+    };
+    const int bw = std::min(w, border);
+    const int bh = std::min(d, border);
+    paintRect(0, bw, 0, d, k_BorderRegion | 1);
+    paintRect(w - bw, w, 0, d, k_BorderRegion | 2);
+    paintRect(0, w, 0, bh, k_BorderRegion | 3);
+    paintRect(0, w, d - bh, d, k_BorderRegion | 4);
+
+    struct Sweep
+    {
+        int rid = 0;
+        int id  = 0;
+        int ns  = 0;    ///< Samples connected to the neighbour region below
+        int nei = 0;    ///< Neighbour region below (-1 = more than one)
+    };
+    std::vector<Sweep> sweeps;
+    std::vector<int> prev;
+    int id = 1;
+
+    for (int z = border; z < d - border; ++z)
+    {
+        prev.assign(static_cast<size_t>(id) + 1, 0);
+        int rid = 1;
+
+        for (int x = border; x < w - border; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * w + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                CompactSpan& s = chf.spans[i];
+                if (!s.walkable) continue;
+
+                // Continue the run from -X
+                int previd = 0;
+                if (s.con[0] != k_NotConnected)
+                {
+                    const CompactSpan& as = chf.spans[s.con[0]];
+                    if (as.walkable && (as.reg & k_BorderRegion) == 0)
+                        previd = as.reg;
+                }
+                if (!previd)
+                {
+                    previd = rid++;
+                    if (static_cast<size_t>(previd) >= sweeps.size())
+                        sweeps.resize(static_cast<size_t>(previd) * 2 + 16);
+                    sweeps[previd].rid = previd;
+                    sweeps[previd].ns  = 0;
+                    sweeps[previd].nei = 0;
+                }
+
+                // Track which region of the previous row (-Z) this run touches
+                if (s.con[3] != k_NotConnected)
+                {
+                    const CompactSpan& as = chf.spans[s.con[3]];
+                    const int nr = as.reg;
+                    if (nr && as.walkable && (nr & k_BorderRegion) == 0)
+                    {
+                        Sweep& sw = sweeps[previd];
+                        if (!sw.nei || sw.nei == nr)
+                        {
+                            sw.nei = nr;
+                            ++sw.ns;
+                            ++prev[nr];
+                        }
+                        else
+                        {
+                            sw.nei = -1;
+                        }
+                    }
+                }
+                s.reg = static_cast<uint16_t>(previd);
+            }
+        }
+
+        // A run continues the region below only if it is that region's sole continuation
+        for (int i = 1; i < rid; ++i)
+        {
+            Sweep& sw = sweeps[i];
+            if (sw.nei > 0 && prev[sw.nei] == sw.ns)
+                sw.id = sw.nei;
+            else
+                sw.id = id++;
+        }
+
+        for (int x = border; x < w - border; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * w + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                CompactSpan& s = chf.spans[i];
+                if (s.walkable && s.reg > 0 && s.reg < rid)
+                    s.reg = static_cast<uint16_t>(sweeps[s.reg].id);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Contours
+// ============================================================================
+int GetCornerHeight(const CompactHeightfield& chf, int i, int dir)
+{
+    const CompactSpan& s = chf.spans[i];
+    int h = s.y;
+    const int dirp = (dir + 1) & 3;
+
+    if (s.con[dir] != k_NotConnected)
+    {
+        const CompactSpan& as = chf.spans[s.con[dir]];
+        h = std::max(h, static_cast<int>(as.y));
+        if (as.con[dirp] != k_NotConnected)
+            h = std::max(h, static_cast<int>(chf.spans[as.con[dirp]].y));
+    }
+    if (s.con[dirp] != k_NotConnected)
+    {
+        const CompactSpan& as = chf.spans[s.con[dirp]];
+        h = std::max(h, static_cast<int>(as.y));
+        if (as.con[dir] != k_NotConnected)
+            h = std::max(h, static_cast<int>(chf.spans[as.con[dir]].y));
+    }
+    return h;
+}
+
+/// Neighbour region across an edge (0 = wall / unwalkable)
+int GetNeighbourRegion(const CompactHeightfield& chf, int i, int dir)
+{
+    const int n = chf.spans[i].con[dir];
+    if (n == k_NotConnected || !chf.spans[n].walkable)
+        return 0;
+    return chf.spans[n].reg;
+}
+
+/// Walk the boundary of a region, emitting (x, y, z, neighbourRegion) per corner
+void WalkContour(const CompactHeightfield& chf, int x, int z, int i,
+                 std::vector<uint8_t>& flags, std::vector<int>& points)
+{
+    int dir = 0;
+    while ((flags[i] & (1 << dir)) == 0)
+        ++dir;
+
+    const int startDir = dir;
+    const int startI = i;
+
+    for (int iter = 0; iter < 40000; ++iter)
+    {
+        if (flags[i] & (1 << dir))
+        {
+            int px = x;
+            const int py = GetCornerHeight(chf, i, dir);
+            int pz = z;
+            switch (dir)
+            {
+            case 0: ++pz; break;
+            case 1: ++px; ++pz; break;
+            case 2: ++px; break;
+            default: break;
+            }
+
+            int r = GetNeighbourRegion(chf, i, dir);
+            if (r == 0 && chf.spans[i].con[dir] != k_NotConnected)
+                r |= k_AreaBorderFlag;
+
+            points.push_back(px);
+            points.push_back(py);
+            points.push_back(pz);
+            points.push_back(r);
+
+            flags[i] &= static_cast<uint8_t>(~(1 << dir));
+            dir = (dir + 1) & 3;    // Rotate clockwise
+        }
+        else
+        {
+            const int ni = chf.spans[i].con[dir];
+            if (ni == k_NotConnected)
+                return;
+            x += k_DirX[dir];
+            z += k_DirZ[dir];
+            i = ni;
+            dir = (dir + 3) & 3;    // Rotate counter-clockwise
+        }
+
+        if (i == startI && dir == startDir)
+            break;
+    }
+}
+
+float DistancePtSegSqr(int x, int z, int px, int pz, int qx, int qz)
+{
+    const float pqx = static_cast<float>(qx - px);
+    const float pqz = static_cast<float>(qz - pz);
+    float dx = static_cast<float>(x - px);
+    float dz = static_cast<float>(z - pz);
+    const float len = pqx * pqx + pqz * pqz;
+    float t = pqx * dx + pqz * dz;
+    if (len > 0.0f) t /= len;
+    t = std::max(0.0f, std::min(1.0f, t));
+    dx = px + t * pqx - x;
+    dz = pz + t * pqz - z;
+    return dx * dx + dz * dz;
+}
+
+/// Reduce a raw contour to the vertices where the neighbour changes plus
+/// enough wall vertices to stay within maxError
+void SimplifyContour(const std::vector<int>& points, std::vector<int>& simplified, float maxError)
+{
+    const int pn = static_cast<int>(points.size() / 4);
+    simplified.clear();
+
+    bool hasConnections = false;
+    for (int i = 0; i < pn && !hasConnections; ++i)
+        hasConnections = (points[i * 4 + 3] & k_RegionMask) != 0;
+
+    if (hasConnections)
+    {
+        for (int i = 0; i < pn; ++i)
+        {
+            const int ii = (i + 1) % pn;
+            const bool differentRegs = (points[i * 4 + 3] & k_RegionMask) != (points[ii * 4 + 3] & k_RegionMask);
+            const bool areaBorders = (points[i * 4 + 3] & k_AreaBorderFlag) != (points[ii * 4 + 3] & k_AreaBorderFlag);
+            if (differentRegs || areaBorders)
+            {
+                simplified.insert(simplified.end(), { points[i * 4 + 0], points[i * 4 + 1], points[i * 4 + 2], i });
+            }
+        }
+    }
+
+    if (simplified.empty())
+    {
+        // No portals: seed with the lower-left and upper-right vertices
+        int lli = 0, uri = 0;
+        for (int i = 0; i < pn; ++i)
+        {
+            const int x = points[i * 4 + 0], z = points[i * 4 + 2];
+            if (x < points[lli * 4] || (x == points[lli * 4] && z < points[lli * 4 + 2])) lli = i;
+            if (x > points[uri * 4] || (x == points[uri * 4] && z > points[uri * 4 + 2])) uri = i;
+        }
+        simplified.insert(simplified.end(), { points[lli * 4], points[lli * 4 + 1], points[lli * 4 + 2], lli });
+        simplified.insert(simplified.end(), { points[uri * 4], points[uri * 4 + 1], points[uri * 4 + 2], uri });
+    }
+
+    // Douglas-Peucker on wall edges
+    const float maxErrorSqr = maxError * maxError;
+    for (size_t i = 0; i < simplified.size() / 4; )
+    {
+        const size_t ii = (i + 1) % (simplified.size() / 4);
+        int ax = simplified[i * 4 + 0], az = simplified[i * 4 + 2], ai = simplified[i * 4 + 3];
+        int bx = simplified[ii * 4 + 0], bz = simplified[ii * 4 + 2], bi = simplified[ii * 4 + 3];
+
+        // Traverse in lexicographic order so opposite segments are simplified identically
+        int ci, cinc, endi;
+        if (bx > ax || (bx == ax && bz > az))
+        {
+            cinc = 1;
+            ci = (ai + cinc) % pn;
+            endi = bi;
+        }
+        else
+        {
+            cinc = pn - 1;
+            ci = (bi + cinc) % pn;
+            endi = ai;
+            std::swap(ax, bx);
+            std::swap(az, bz);
+        }
+
+        float maxd = 0.0f;
+        int maxi = -1;
+        if ((points[ci * 4 + 3] & k_RegionMask) == 0 || (points[ci * 4 + 3] & k_AreaBorderFlag))
+        {
+            while (ci != endi)
+            {
+                const float dist = DistancePtSegSqr(points[ci * 4 + 0], points[ci * 4 + 2], ax, az, bx, bz);
+                if (dist > maxd)
+                {
+                    maxd = dist;
+                    maxi = ci;
+                }
+                ci = (ci + cinc) % pn;
+            }
+        }
+
+        if (maxi != -1 && maxd > maxErrorSqr)
+        {
+            simplified.insert(simplified.begin() + (i + 1) * 4,
+                { points[maxi * 4 + 0], points[maxi * 4 + 1], points[maxi * 4 + 2], maxi });
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // The neighbour region of an edge is taken from the raw point after the vertex
+    for (size_t i = 0; i < simplified.size() / 4; ++i)
+    {
+        const int ai = (simplified[i * 4 + 3] + 1) % pn;
+        simplified[i * 4 + 3] = points[ai * 4 + 3] & (k_RegionMask | k_AreaBorderFlag);
+    }
+
+    // Remove degenerate (zero-length) segments
+    for (size_t i = 0; simplified.size() >= 12 && i < simplified.size() / 4; )
+    {
+        const size_t ni = (i + 1) % (simplified.size() / 4);
+        if (simplified[i * 4] == simplified[ni * 4] && simplified[i * 4 + 2] == simplified[ni * 4 + 2])
+            simplified.erase(simplified.begin() + i * 4, simplified.begin() + i * 4 + 4);
+        else
+            ++i;
+    }
+}
+
+// ============================================================================
+// Triangulation (ear clipping on integer contour coordinates)
+// ============================================================================
+inline int Prev(int i, int n) { return i - 1 >= 0 ? i - 1 : n - 1; }
+inline int Next(int i, int n) { return i + 1 < n ? i + 1 : 0; }
+
+inline int Area2(const int* a, const int* b, const int* c)
+{
+    return (b[0] - a[0]) * (c[2] - a[2]) - (c[0] - a[0]) * (b[2] - a[2]);
+}
+inline bool Left(const int* a, const int* b, const int* c)      { return Area2(a, b, c) < 0; }
+inline bool LeftOn(const int* a, const int* b, const int* c)    { return Area2(a, b, c) <= 0; }
+inline bool Collinear(const int* a, const int* b, const int* c) { return Area2(a, b, c) == 0; }
+inline bool VEqual(const int* a, const int* b) { return a[0] == b[0] && a[2] == b[2]; }
+
+bool IntersectProp(const int* a, const int* b, const int* c, const int* d)
+{
+    if (Collinear(a, b, c) || Collinear(a, b, d) || Collinear(c, d, a) || Collinear(c, d, b))
+        return false;
+    return (Left(a, b, c) != Left(a, b, d)) && (Left(c, d, a) != Left(c, d, b));
+}
+
+bool Between(const int* a, const int* b, const int* c)
+{
+    if (!Collinear(a, b, c))
+        return false;
+    if (a[0] != b[0])
+        return (a[0] <= c[0] && c[0] <= b[0]) || (a[0] >= c[0] && c[0] >= b[0]);
+    return (a[2] <= c[2] && c[2] <= b[2]) || (a[2] >= c[2] && c[2] >= b[2]);
+}
+
+bool Intersect(const int* a, const int* b, const int* c, const int* d)
+{
+    return IntersectProp(a, b, c, d) || Between(a, b, c) || Between(a, b, d) ||
+           Between(c, d, a) || Between(c, d, b);
+}
+
+constexpr int k_IndexMask = 0x0FFFFFFF;
+constexpr int k_EarFlag   = static_cast<int>(0x80000000);
+
+inline const int* Vert(const std::vector<int>& verts, int index) { return &verts[(index & k_IndexMask) * 4]; }
+
+/// (i, j) is a proper diagonal, ignoring edges incident to i and j
+bool Diagonalie(int i, int j, int n, const std::vector<int>& verts, const std::vector<int>& indices)
+{
+    const int* d0 = Vert(verts, indices[i]);
+    const int* d1 = Vert(verts, indices[j]);
+    for (int k = 0; k < n; ++k)
+    {
+        const int k1 = Next(k, n);
+        if (k == i || k1 == i || k == j || k1 == j) continue;
+        const int* p0 = Vert(verts, indices[k]);
+        const int* p1 = Vert(verts, indices[k1]);
+        if (VEqual(d0, p0) || VEqual(d1, p0) || VEqual(d0, p1) || VEqual(d1, p1)) continue;
+        if (Intersect(d0, d1, p0, p1)) return false;
+    }
+    return true;
+}
+
+/// The diagonal (i, j) is strictly internal near vertex i
+bool InCone(int i, int j, int n, const std::vector<int>& verts, const std::vector<int>& indices)
+{
+    const int* pi   = Vert(verts, indices[i]);
+    const int* pj   = Vert(verts, indices[j]);
+    const int* pi1  = Vert(verts, indices[Next(i, n)]);
+    const int* pin1 = Vert(verts, indices[Prev(i, n)]);
+    if (LeftOn(pin1, pi, pi1))
+        return Left(pi, pj, pin1) && Left(pj, pi, pi1);
+    return !(LeftOn(pi, pj, pi1) && LeftOn(pj, pi, pin1));
+}
+
+bool Diagonal(int i, int j, int n, const std::vector<int>& verts, const std::vector<int>& indices)
+{
+    return InCone(i, j, n, verts, indices) && Diagonalie(i, j, n, verts, indices);
+}
+
+/// Triangulate a contour; returns false if it had to give up (partial result kept)
+bool Triangulate(const std::vector<int>& verts, std::vector<int>& tris)
+{
+    int n = static_cast<int>(verts.size() / 4);
+    std::vector<int> indices(n);
+    for (int i = 0; i < n; ++i)
+        indices[i] = i;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const int i1 = Next(i, n);
+        const int i2 = Next(i1, n);
+        if (Diagonal(i, i2, n, verts, indices))
+            indices[i1] |= k_EarFlag;
+    }
+
+    while (n > 3)
+    {
+        int minLen = -1, mini = -1;
+        for (int i = 0; i < n; ++i)
+        {
+            const int i1 = Next(i, n);
+            if (indices[i1] & k_EarFlag)
+            {
+                const int* p0 = Vert(verts, indices[i]);
+                const int* p2 = Vert(verts, indices[Next(i1, n)]);
+                const int dx = p2[0] - p0[0], dz = p2[2] - p0[2];
+                const int len = dx * dx + dz * dz;
+                if (minLen < 0 || len < minLen)
+                {
+                    minLen = len;
+                    mini = i;
+                }
+            }
+        }
+        if (mini == -1)
+            return false;
+
+        int i = mini;
+        int i1 = Next(i, n);
+        const int i2 = Next(i1, n);
+        tris.push_back(indices[i] & k_IndexMask);
+        tris.push_back(indices[i1] & k_IndexMask);
+        tris.push_back(indices[i2] & k_IndexMask);
+
+        // Remove P[i1]
+        --n;
+        for (int k = i1; k < n; ++k)
+            indices[k] = indices[k + 1];
+        if (i1 >= n) i1 = 0;
+        i = Prev(i1, n);
+
+        if (Diagonal(Prev(i, n), i1, n, verts, indices)) indices[i] |= k_EarFlag;
+        else                                             indices[i] &= k_IndexMask;
+        if (Diagonal(i, Next(i1, n), n, verts, indices)) indices[i1] |= k_EarFlag;
+        else                                             indices[i1] &= k_IndexMask;
+    }
+
+    tris.push_back(indices[0] & k_IndexMask);
+    tris.push_back(indices[1] & k_IndexMask);
+    tris.push_back(indices[2] & k_IndexMask);
+    return true;
+}
+
+// ============================================================================
+// Polygon merging
+// ============================================================================
+struct MeshVert
+{
+    int x, y, z;
+};
+
+struct MeshPoly
+{
+    uint16_t verts[k_MaxVerts];
+    int count;
+};
+
+inline bool ULeft(const MeshVert& a, const MeshVert& b, const MeshVert& c)
+{
+    return (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z) < 0;
+}
+
+/// Length^2 of the shared edge if merging keeps the result convex, else -1
+int GetPolyMergeValue(const MeshPoly& pa, const MeshPoly& pb, const std::vector<MeshVert>& verts,
+                      int& ea, int& eb)
+{
+    const int na = pa.count, nb = pb.count;
+    if (na + nb - 2 > k_MaxVerts)
+        return -1;
+
+    ea = eb = -1;
+    for (int i = 0; i < na && ea < 0; ++i)
+    {
+        uint16_t va0 = pa.verts[i], va1 = pa.verts[(i + 1) % na];
+        if (va0 > va1) std::swap(va0, va1);
+        for (int j = 0; j < nb; ++j)
+        {
+            uint16_t vb0 = pb.verts[j], vb1 = pb.verts[(j + 1) % nb];
+            if (vb0 > vb1) std::swap(vb0, vb1);
+            if (va0 == vb0 && va1 == vb1)
+            {
+                ea = i;
+                eb = j;
+                break;
+            }
+        }
+    }
+    if (ea < 0 || eb < 0)
+        return -1;
+
+    if (!ULeft(verts[pa.verts[(ea + na - 1) % na]], verts[pa.verts[ea]], verts[pb.verts[(eb + 2) % nb]]))
+        return -1;
+    if (!ULeft(verts[pb.verts[(eb + nb - 1) % nb]], verts[pb.verts[eb]], verts[pa.verts[(ea + 2) % na]]))
+        return -1;
+
+    const MeshVert& a = verts[pa.verts[ea]];
+    const MeshVert& b = verts[pa.verts[(ea + 1) % na]];
+    return (a.x - b.x) * (a.x - b.x) + (a.z - b.z) * (a.z - b.z);
+}
+
+void MergePolys(MeshPoly& pa, const MeshPoly& pb, int ea, int eb)
+{
+    MeshPoly merged = {};
+    int n = 0;
+    for (int i = 0; i < pa.count - 1; ++i)
+        merged.verts[n++] = pa.verts[(ea + 1 + i) % pa.count];
+    for (int i = 0; i < pb.count - 1; ++i)
+        merged.verts[n++] = pb.verts[(eb + 1 + i) % pb.count];
+    merged.count = n;
+    pa = merged;
+}
+
+// ============================================================================
+// Geometry helpers for queries
+// ============================================================================
+inline float Cross2D(const XMFLOAT3& o, const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    return (a.x - o.x) * (b.z - o.z) - (a.z - o.z) * (b.x - o.x);
+}
+
+/// Funnel orientation test (same convention as the classic string-pulling code)
+inline float TriArea2(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+{
+    const float ax = b.x - a.x, az = b.z - a.z;
+    const float bx = c.x - a.x, bz = c.z - a.z;
+    return bx * az - ax * bz;
+}
+
+inline float DistSqr(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    const float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+inline bool NearlyEqual(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    return DistSqr(a, b) < 1e-8f;
+}
+
+inline XMFLOAT3 Lerp3(const XMFLOAT3& a, const XMFLOAT3& b, float t)
+{
+    return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+}
+
+/// Point where the segment from -> to crosses the portal (clamped to the portal).
+/// Using it instead of the portal midpoint keeps long tile-border portals from
+/// skewing the corridor cost.
+XMFLOAT3 PortalCrossing(const XMFLOAT3& from, const XMFLOAT3& to, const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    const float dx = to.x - from.x, dz = to.z - from.z;
+    const float ex = b.x - a.x, ez = b.z - a.z;
+    const float denom = dx * ez - dz * ex;
+    float t = 0.5f;
+    if (std::abs(denom) > 1e-6f)
+        t = ((a.x - from.x) * dz - (a.z - from.z) * dx) / denom;
+    return Lerp3(a, b, std::max(0.0f, std::min(1.0f, t)));
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Build
+// ============================================================================
+bool NavPolyMesh::Build(const float* vertices, int vertexCount,
+                        const int* indices, int indexCount,
+                        const NavPolyMeshConfig& config)
+{
+    // Obstacles survive a rebuild; everything else is reset
+    StopRebuildThread();
+    m_tileSet.store(nullptr);
+    m_tileTriangles.clear();
+    m_dirtyTiles.clear();
+    m_tilesX = m_tilesZ = 0;
+
+    if (!vertices || vertexCount <= 0 || !indices || indexCount <= 0 || indexCount % 3 != 0)
+    {
+        Logger::Error("NavPolyMesh::Build - invalid input");
+        return false;
+    }
+    if (config.cellSize <= 0.0f || config.cellHeight <= 0.0f || config.tileSize < 8)
+    {
+        Logger::Error("NavPolyMesh::Build - invalid config (cellSize/cellHeight > 0, tileSize >= 8)");
+        return false;
+    }
+
+    m_config = config;
+    m_sourceVertices.assign(vertices, vertices + static_cast<size_t>(vertexCount) * 3);
+    m_sourceIndices.assign(indices, indices + indexCount);
+
+    float minX = FLT_MAX, minZ = FLT_MAX, maxX = -FLT_MAX, maxZ = -FLT_MAX;
+    m_minY = FLT_MAX;
+    m_maxY = -FLT_MAX;
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        minX = std::min(minX, vertices[i * 3 + 0]);
+        maxX = std::max(maxX, vertices[i * 3 + 0]);
+        m_minY = std::min(m_minY, vertices[i * 3 + 1]);
+        m_maxY = std::max(m_maxY, vertices[i * 3 + 1]);
+        minZ = std::min(minZ, vertices[i * 3 + 2]);
+        maxZ = std::max(maxZ, vertices[i * 3 + 2]);
+    }
+    m_maxY += config.agentHeight;
+
+    const float tileWorld = config.tileSize * config.cellSize;
+    m_originX = minX;
+    m_originZ = minZ;
+    m_tilesX = std::max(1, static_cast<int>(std::ceil((maxX - minX) / tileWorld)));
+    m_tilesZ = std::max(1, static_cast<int>(std::ceil((maxZ - minZ) / tileWorld)));
+    if (m_tilesX * m_tilesZ > 0xFFFF)
+    {
+        Logger::Error("NavPolyMesh::Build - too many tiles (%d x %d), increase tileSize", m_tilesX, m_tilesZ);
+        Clear();
+        return false;
+    }
+
+    // Bucket triangles into every tile their XZ bounds touch (including the padding)
+    const int border = static_cast<int>(std::ceil(config.agentRadius / config.cellSize)) + 3;
+    const float pad = border * config.cellSize;
+    std::vector<std::vector<int>> buckets(static_cast<size_t>(m_tilesX) * m_tilesZ);
+    const int triCount = indexCount / 3;
+    for (int t = 0; t < triCount; ++t)
+    {
+        const int* tri = &indices[t * 3];
+        if (tri[0] < 0 || tri[0] >= vertexCount || tri[1] < 0 || tri[1] >= vertexCount ||
+            tri[2] < 0 || tri[2] >= vertexCount)
+            continue;
+
+        float tMinX = FLT_MAX, tMaxX = -FLT_MAX, tMinZ = FLT_MAX, tMaxZ = -FLT_MAX;
+        for (int k = 0; k < 3; ++k)
+        {
+            tMinX = std::min(tMinX, vertices[tri[k] * 3 + 0]);
+            tMaxX = std::max(tMaxX, vertices[tri[k] * 3 + 0]);
+            tMinZ = std::min(tMinZ, vertices[tri[k] * 3 + 2]);
+            tMaxZ = std::max(tMaxZ, vertices[tri[k] * 3 + 2]);
+        }
+        const int tx0 = std::max(0, static_cast<int>(std::floor((tMinX - pad - m_originX) / tileWorld)));
+        const int tx1 = std::min(m_tilesX - 1, static_cast<int>(std::floor((tMaxX + pad - m_originX) / tileWorld)));
+        const int tz0 = std::max(0, static_cast<int>(std::floor((tMinZ - pad - m_originZ) / tileWorld)));
+        const int tz1 = std::min(m_tilesZ - 1, static_cast<int>(std::floor((tMaxZ + pad - m_originZ) / tileWorld)));
+        for (int tz = tz0; tz <= tz1; ++tz)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                buckets[static_cast<size_t>(tz) * m_tilesX + tx].push_back(t);
+    }
+
+    // Build tiles on worker threads (tiles are independent until linking)
+    std::vector<std::shared_ptr<NavPolyTile>> built(buckets.size());
+    std::atomic<int> nextTile{ 0 };
+    auto worker = [&]() {
+        for (int ti = nextTile.fetch_add(1); ti < static_cast<int>(buckets.size()); ti = nextTile.fetch_add(1))
+        {
+            if (!buckets[ti].empty())
+                built[ti] = BuildTile(ti % m_tilesX, ti / m_tilesX, buckets[ti], m_obstacles);
+        }
+    };
+
+    uint32_t threadCount = config.workerCount ? config.workerCount : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<uint32_t>(threadCount, static_cast<uint32_t>(buckets.size()));
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+
+    auto tileSet = std::make_shared<TileSet>();
+    tileSet->tiles.assign(built.begin(), built.end());
+    for (auto& tile : built)
+    {
+        if (tile) LinkTile(*tile, *tileSet);
+    }
+    UpdatePolyBase(*tileSet);
+
+    if (tileSet->totalPolys == 0)
+    {
+        Logger::Error("NavPolyMesh::Build - no walkable polygons generated");
+        Clear();
+        return false;
+    }
+
+    m_tileTriangles = std::move(buckets);
+    m_tileQueued.assign(m_tileTriangles.size(), 0);
+    m_tileSet.store(tileSet);
+
+    Logger::Info("NavPolyMesh::Build - %d tris -> %u polys in %dx%d tiles",
+                 triCount, tileSet->totalPolys, m_tilesX, m_tilesZ);
+    return true;
+}
+
+void NavPolyMesh::Clear()
+{
+    StopRebuildThread();
+    m_tileSet.store(nullptr);
+    m_tileTriangles.clear();
+    m_tileQueued.clear();
+    m_tilesX = m_tilesZ = 0;
+    m_sourceVertices.clear();
+    m_sourceIndices.clear();
+    m_obstacles.clear();
+    m_dirtyTiles.clear();
+}
+
+NavPolyMesh::~NavPolyMesh()
+{
+    StopRebuildThread();
+}
+
+// ============================================================================
+// BuildTile
+// ============================================================================
+std::shared_ptr<NavPolyTile> NavPolyMesh::BuildTile(int tileX, int tileZ, const std::vector<int>& triangles,
+                                                     const std::vector<Obstacle>& obstacles) const
+{
+    const NavPolyMeshConfig& cfg = m_config;
+    const int walkableHeight = static_cast<int>(std::ceil(cfg.agentHeight / cfg.cellHeight));
+    const int walkableClimb  = static_cast<int>(std::floor(cfg.maxClimb / cfg.cellHeight));
+    const int walkableRadius = static_cast<int>(std::ceil(cfg.agentRadius / cfg.cellSize));
+    const int border = walkableRadius + 3;
+    const float walkableThreshold = std::cos(cfg.maxSlope * (XM_PI / 180.0f));
+
+    const float tileMinX = m_originX + tileX * cfg.tileSize * cfg.cellSize;
+    const float tileMinZ = m_originZ + tileZ * cfg.tileSize * cfg.cellSize;
+
+    // 1. Voxelize
+    Heightfield hf;
+    hf.width  = cfg.tileSize + border * 2;
+    hf.depth  = cfg.tileSize + border * 2;
+    hf.bminX  = tileMinX - border * cfg.cellSize;
+    hf.bminY  = m_minY;
+    hf.bminZ  = tileMinZ - border * cfg.cellSize;
+    hf.cs     = cfg.cellSize;
+    hf.ch     = cfg.cellHeight;
+    hf.columns.resize(static_cast<size_t>(hf.width) * hf.depth);
+
+    for (int t : triangles)
+    {
+        const float* v0 = &m_sourceVertices[static_cast<size_t>(m_sourceIndices[t * 3 + 0]) * 3];
+        const float* v1 = &m_sourceVertices[static_cast<size_t>(m_sourceIndices[t * 3 + 1]) * 3];
+        const float* v2 = &m_sourceVertices[static_cast<size_t>(m_sourceIndices[t * 3 + 2]) * 3];
+
+        const float e0[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+        const float e1[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+        const float nx = e0[1] * e1[2] - e0[2] * e1[1];
+        const float ny = e0[2] * e1[0] - e0[0] * e1[2];
+        const float nz = e0[0] * e1[1] - e0[1] * e1[0];
+        const float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        // Either winding is accepted, as in NavMesh::BuildFromGeometry
+        const bool walkable = len > 0.0f && std::abs(ny) / len > walkableThreshold;
+
+        RasterizeTriangle(hf, v0, v1, v2, walkable, m_maxY, walkableClimb);
+    }
+
+    // 2. Filter
+    FilterLowHangingObstacles(hf, walkableClimb);
+    FilterLedgeSpans(hf, walkableHeight, walkableClimb);
+    FilterLowHeightSpans(hf, walkableHeight);
+
+    // 3. Compact, erode, partition
+    CompactHeightfield chf;
+    chf.border = border;
+    BuildCompactHeightfield(hf, walkableHeight, walkableClimb, chf);
+    hf.columns.clear();
+    hf.columns.shrink_to_fit();
+
+    // Dynamic obstacles: covered spans become unwalkable, erosion then keeps agents a radius away
+    for (const Obstacle& obstacle : obstacles)
+    {
+        XMFLOAT3 bmin, bmax;
+        obstacle.GetBounds(bmin, bmax);
+        const int x0 = std::max(0, static_cast<int>(std::floor((bmin.x - hf.bminX) / cfg.cellSize)));
+        const int x1 = std::min(chf.width - 1, static_cast<int>(std::floor((bmax.x - hf.bminX) / cfg.cellSize)));
+        const int z0 = std::max(0, static_cast<int>(std::floor((bmin.z - hf.bminZ) / cfg.cellSize)));
+        const int z1 = std::min(chf.depth - 1, static_cast<int>(std::floor((bmax.z - hf.bminZ) / cfg.cellSize)));
+        for (int z = z0; z <= z1; ++z)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                if (!obstacle.ContainsXZ(hf.bminX + (x + 0.5f) * cfg.cellSize, hf.bminZ + (z + 0.5f) * cfg.cellSize))
+                    continue;
+                const CompactCell& cell = chf.cells[static_cast<size_t>(z) * chf.width + x];
+                for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+                {
+                    const float floorY = m_minY + chf.spans[i].y * cfg.cellHeight;
+                    if (floorY >= bmin.y - cfg.maxClimb && floorY <= bmax.y)
+                        chf.spans[i].walkable = false;
+                }
+            }
+        }
+    }
+
+    ErodeWalkableArea(chf, walkableRadius);
+    RemoveSmallIslands(chf, cfg.minRegionArea);
+    BuildRegionsMonotone(chf);
+
+    // 4. Contours -> polygons
+    std::vector<uint8_t> flags(chf.spans.size(), 0);
+    for (int z = 0; z < chf.depth; ++z)
+    {
+        for (int x = 0; x < chf.width; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * chf.width + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                const CompactSpan& s = chf.spans[i];
+                if (!s.walkable || !s.reg || (s.reg & k_BorderRegion)) continue;
+                uint8_t same = 0;
+                for (int dir = 0; dir < 4; ++dir)
+                {
+                    if (GetNeighbourRegion(chf, static_cast<int>(i), dir) == s.reg)
+                        same |= static_cast<uint8_t>(1 << dir);
+                }
+                flags[i] = same ^ 0xF;   // Boundary edges
+            }
+        }
+    }
+
+    std::vector<MeshVert> meshVerts;
+    std::vector<MeshPoly> meshPolys;
+    std::unordered_map<uint64_t, std::vector<uint16_t>> vertLookup;
+    const float maxError = cfg.maxEdgeError / cfg.cellSize;
+
+    auto addVertex = [&](int x, int y, int z) -> int {
+        const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+        auto& bucket = vertLookup[key];
+        for (uint16_t v : bucket)
+        {
+            if (std::abs(meshVerts[v].y - y) <= 2)
+                return v;
+        }
+        if (meshVerts.size() >= 0xFFFF)
+            return -1;
+        meshVerts.push_back({ x, y, z });
+        bucket.push_back(static_cast<uint16_t>(meshVerts.size() - 1));
+        return static_cast<int>(meshVerts.size() - 1);
+    };
+
+    std::vector<int> raw, simplified, tris;
+    for (int z = 0; z < chf.depth; ++z)
+    {
+        for (int x = 0; x < chf.width; ++x)
+        {
+            const CompactCell& cell = chf.cells[static_cast<size_t>(z) * chf.width + x];
+            for (uint32_t i = cell.index; i < cell.index + cell.count; ++i)
+            {
+                if (flags[i] == 0 || flags[i] == 0xF)
+                {
+                    flags[i] = 0;
+                    continue;
+                }
+
+                raw.clear();
+                WalkContour(chf, x, z, static_cast<int>(i), flags, raw);
+                SimplifyContour(raw, simplified, maxError);
+                if (simplified.size() < 12) continue;
+
+                // Contour coordinates relative to the tile (border removed)
+                for (size_t v = 0; v < simplified.size(); v += 4)
+                {
+                    simplified[v + 0] -= border;
+                    simplified[v + 2] -= border;
+                }
+
+                tris.clear();
+                if (!Triangulate(simplified, tris))
+                    Logger::Warn("NavPolyMesh: tile (%d,%d) has a contour that could not be fully triangulated", tileX, tileZ);
+
+                // Weld contour vertices with the rest of the tile
+                const int nv = static_cast<int>(simplified.size() / 4);
+                std::vector<int> remap(nv);
+                bool ok = true;
+                for (int v = 0; v < nv && ok; ++v)
+                {
+                    remap[v] = addVertex(simplified[v * 4 + 0], simplified[v * 4 + 1], simplified[v * 4 + 2]);
+                    ok = remap[v] >= 0;
+                }
+                if (!ok) continue;
+
+                // Triangles, then greedily merge into convex polygons (longest shared edge first)
+                std::vector<MeshPoly> polys;
+                for (size_t t = 0; t + 2 < tris.size(); t += 3)
+                {
+                    const int a = remap[tris[t]], b = remap[tris[t + 1]], c = remap[tris[t + 2]];
+                    if (a == b || a == c || b == c) continue;
+                    MeshPoly p = {};
+                    p.verts[0] = static_cast<uint16_t>(a);
+                    p.verts[1] = static_cast<uint16_t>(b);
+                    p.verts[2] = static_cast<uint16_t>(c);
+                    p.count = 3;
+                    polys.push_back(p);
+                }
+
+                while (polys.size() > 1)
+                {
+                    int bestValue = 0, bestA = 0, bestB = 0, bestEa = 0, bestEb = 0;
+                    for (size_t a = 0; a + 1 < polys.size(); ++a)
+                    {
+                        for (size_t b = a + 1; b < polys.size(); ++b)
+                        {
+                            int ea, eb;
+                            const int value = GetPolyMergeValue(polys[a], polys[b], meshVerts, ea, eb);
+                            if (value > bestValue)
+                            {
+                                bestValue = value;
+                                bestA = static_cast<int>(a);
+                                bestB = static_cast<int>(b);
+                                bestEa = ea;
+                                bestEb = eb;
+                            }
+                        }
+                    }
+                    if (bestValue <= 0) break;
+                    MergePolys(polys[bestA], polys[bestB], bestEa, bestEb);
+                    polys[bestB] = polys.back();
+                    polys.pop_back();
+                }
+                meshPolys.insert(meshPolys.end(), polys.begin(), polys.end());
+            }
+        }
+    }
+
+    if (meshPolys.empty() || meshPolys.size() >= 0x7FFF)
+    {
+        if (!meshPolys.empty())
+            Logger::Warn("NavPolyMesh: tile (%d,%d) has too many polygons, reduce tileSize", tileX, tileZ);
+        return nullptr;
+    }
+
+    // 5. Convert to the runtime tile format
+    auto tile = std::make_shared<NavPolyTile>();
+    tile->tileX = tileX;
+    tile->tileZ = tileZ;
+    tile->revision = m_nextTileRevision.fetch_add(1);
+    tile->vertices.reserve(meshVerts.size());
+    tile->boundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    tile->boundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const auto& v : meshVerts)
+    {
+        XMFLOAT3 p = { tileMinX + v.x * cfg.cellSize, m_minY + v.y * cfg.cellHeight, tileMinZ + v.z * cfg.cellSize };
+        tile->vertices.push_back(p);
+        tile->boundsMin = { std::min(tile->boundsMin.x, p.x), std::min(tile->boundsMin.y, p.y), std::min(tile->boundsMin.z, p.z) };
+        tile->boundsMax = { std::max(tile->boundsMax.x, p.x), std::max(tile->boundsMax.y, p.y), std::max(tile->boundsMax.z, p.z) };
+    }
+
+    // Internal adjacency via shared edges
+    std::unordered_map<uint32_t, std::pair<int, int>> edgeOwner;
+    tile->polys.resize(meshPolys.size());
+    for (size_t p = 0; p < meshPolys.size(); ++p)
+    {
+        const MeshPoly& mp = meshPolys[p];
+        NavPolyTile::Poly& poly = tile->polys[p];
+        poly.vertCount = static_cast<uint8_t>(mp.count);
+        XMFLOAT3 center = { 0.0f, 0.0f, 0.0f };
+        for (int v = 0; v < mp.count; ++v)
+        {
+            poly.verts[v] = mp.verts[v];
+            const XMFLOAT3& pv = tile->vertices[mp.verts[v]];
+            center.x += pv.x;
+            center.y += pv.y;
+            center.z += pv.z;
+        }
+        const float inv = 1.0f / mp.count;
+        poly.center = { center.x * inv, center.y * inv, center.z * inv };
+
+        for (int v = 0; v < mp.count; ++v)
+        {
+            uint16_t a = mp.verts[v], b = mp.verts[(v + 1) % mp.count];
+            if (a > b) std::swap(a, b);
+            const uint32_t key = (static_cast<uint32_t>(a) << 16) | b;
+            auto it = edgeOwner.find(key);
+            if (it == edgeOwner.end())
+            {
+                edgeOwner[key] = { static_cast<int>(p), v };
+            }
+            else
+            {
+                poly.neighbours[v] = static_cast<uint16_t>(it->second.first + 1);
+                tile->polys[it->second.first].neighbours[it->second.second] = static_cast<uint16_t>(p + 1);
+            }
+        }
+    }
+
+    // Edges lying on the tile boundary can connect to the neighbouring tile
+    for (size_t p = 0; p < meshPolys.size(); ++p)
+    {
+        const MeshPoly& mp = meshPolys[p];
+        NavPolyTile::Poly& poly = tile->polys[p];
+        for (int v = 0; v < mp.count; ++v)
+        {
+            if (poly.neighbours[v] != 0) continue;
+            const MeshVert& va = meshVerts[mp.verts[v]];
+            const MeshVert& vb = meshVerts[mp.verts[(v + 1) % mp.count]];
+            if (va.x == 0 && vb.x == 0)                               poly.neighbours[v] = k_ExternalEdge | 0;
+            else if (va.z == cfg.tileSize && vb.z == cfg.tileSize)    poly.neighbours[v] = k_ExternalEdge | 1;
+            else if (va.x == cfg.tileSize && vb.x == cfg.tileSize)    poly.neighbours[v] = k_ExternalEdge | 2;
+            else if (va.z == 0 && vb.z == 0)                          poly.neighbours[v] = k_ExternalEdge | 3;
+        }
+    }
+
+    return tile;
+}
+
+// ============================================================================
+// LinkTile
+// ============================================================================
+void NavPolyMesh::LinkTile(NavPolyTile& tile, const TileSet& tiles) const
+{
+    const int tileIndex = tile.tileZ * m_tilesX + tile.tileX;
+    tile.links.clear();
+
+    for (size_t p = 0; p < tile.polys.size(); ++p)
+    {
+        NavPolyTile::Poly& poly = tile.polys[p];
+        poly.firstLink = static_cast<uint32_t>(tile.links.size());
+
+        for (int e = 0; e < poly.vertCount; ++e)
+        {
+            const uint16_t nei = poly.neighbours[e];
+            if (nei == 0) continue;
+
+            const XMFLOAT3& va = tile.vertices[poly.verts[e]];
+            const XMFLOAT3& vb = tile.vertices[poly.verts[(e + 1) % poly.vertCount]];
+
+            if ((nei & k_ExternalEdge) == 0)
+            {
+                NavPolyTile::Link link;
+                link.target  = MakeRef(tileIndex, nei - 1);
+                link.portalA = va;
+                link.portalB = vb;
+                tile.links.push_back(link);
+                continue;
+            }
+
+            // Cross-tile: match against opposite border edges of the neighbour tile
+            const int side = nei & 0x3;
+            const int nx = tile.tileX + k_DirX[side];
+            const int nz = tile.tileZ + k_DirZ[side];
+            if (nx < 0 || nz < 0 || nx >= m_tilesX || nz >= m_tilesZ) continue;
+            const int neighbourIndex = nz * m_tilesX + nx;
+            const NavPolyTile* other = tiles.tiles[neighbourIndex].get();
+            if (!other) continue;
+
+            const uint16_t opposite = static_cast<uint16_t>(k_ExternalEdge | ((side + 2) & 3));
+            const bool alongZ = (side == 0 || side == 2);   // Border line runs along Z
+            const float aMin = alongZ ? std::min(va.z, vb.z) : std::min(va.x, vb.x);
+            const float aMax = alongZ ? std::max(va.z, vb.z) : std::max(va.x, vb.x);
+
+            for (size_t op = 0; op < other->polys.size(); ++op)
+            {
+                const NavPolyTile::Poly& opoly = other->polys[op];
+                for (int oe = 0; oe < opoly.vertCount; ++oe)
+                {
+                    if (opoly.neighbours[oe] != opposite) continue;
+
+                    const XMFLOAT3& wa = other->vertices[opoly.verts[oe]];
+                    const XMFLOAT3& wb = other->vertices[opoly.verts[(oe + 1) % opoly.vertCount]];
+                    const float bMin = alongZ ? std::min(wa.z, wb.z) : std::min(wa.x, wb.x);
+                    const float bMax = alongZ ? std::max(wa.z, wb.z) : std::max(wa.x, wb.x);
+                    const float lo = std::max(aMin, bMin);
+                    const float hi = std::min(aMax, bMax);
+                    if (hi - lo < m_config.cellSize * 0.5f) continue;
+
+                    // Heights of both edges at the overlap ends must match within a step
+                    auto heightAt = [alongZ](const XMFLOAT3& p0, const XMFLOAT3& p1, float coord) {
+                        const float c0 = alongZ ? p0.z : p0.x;
+                        const float c1 = alongZ ? p1.z : p1.x;
+                        const float t = (c1 != c0) ? (coord - c0) / (c1 - c0) : 0.0f;
+                        return p0.y + (p1.y - p0.y) * t;
+                    };
+                    const float ha0 = heightAt(va, vb, lo), ha1 = heightAt(va, vb, hi);
+                    const float hb0 = heightAt(wa, wb, lo), hb1 = heightAt(wa, wb, hi);
+                    if (std::abs(ha0 - hb0) > m_config.maxClimb || std::abs(ha1 - hb1) > m_config.maxClimb)
+                        continue;
+
+                    NavPolyTile::Link link;
+                    link.target = MakeRef(neighbourIndex, static_cast<int>(op));
+                    const float fixed = alongZ ? va.x : va.z;
+                    link.portalA = alongZ ? XMFLOAT3{ fixed, ha0, lo } : XMFLOAT3{ lo, ha0, fixed };
+                    link.portalB = alongZ ? XMFLOAT3{ fixed, ha1, hi } : XMFLOAT3{ hi, ha1, fixed };
+                    tile.links.push_back(link);
+                }
+            }
+        }
+        poly.linkCount = static_cast<uint32_t>(tile.links.size()) - poly.firstLink;
+    }
+}
+
+void NavPolyMesh::UpdatePolyBase(TileSet& tiles)
+{
+    tiles.polyBase.assign(tiles.tiles.size(), 0);
+    tiles.totalPolys = 0;
+    for (size_t i = 0; i < tiles.tiles.size(); ++i)
+    {
+        tiles.polyBase[i] = tiles.totalPolys;
+        if (tiles.tiles[i])
+            tiles.totalPolys += static_cast<uint32_t>(tiles.tiles[i]->polys.size());
+    }
+}
+
+// ============================================================================
+// Dynamic obstacles
+// ============================================================================
+void NavPolyMesh::Obstacle::GetBounds(XMFLOAT3& bmin, XMFLOAT3& bmax) const
+{
+    if (cylinder)
+    {
+        bmin = { position.x - halfExtents.x, position.y, position.z - halfExtents.x };
+        bmax = { position.x + halfExtents.x, position.y + halfExtents.y, position.z + halfExtents.x };
+        return;
+    }
+    const float c = std::abs(std::cos(yaw));
+    const float s = std::abs(std::sin(yaw));
+    const float ex = c * halfExtents.x + s * halfExtents.z;
+    const float ez = s * halfExtents.x + c * halfExtents.z;
+    bmin = { position.x - ex, position.y - halfExtents.y, position.z - ez };
+    bmax = { position.x + ex, position.y + halfExtents.y, position.z + ez };
+}
+
+bool NavPolyMesh::Obstacle::ContainsXZ(float x, float z) const
+{
+    const float dx = x - position.x;
+    const float dz = z - position.z;
+    if (cylinder)
+        return dx * dx + dz * dz <= halfExtents.x * halfExtents.x;
+
+    // Rotate into the box's local frame (yaw around +Y)
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    const float lx = c * dx - s * dz;
+    const float lz = s * dx + c * dz;
+    return std::abs(lx) <= halfExtents.x && std::abs(lz) <= halfExtents.z;
+}
+
+NavObstacleId NavPolyMesh::AddBoxObstacle(const XMFLOAT3& center, const XMFLOAT3& halfExtents, float yaw)
+{
+    Obstacle obstacle;
+    obstacle.id = m_nextObstacleId++;
+    obstacle.position = center;
+    obstacle.halfExtents = halfExtents;
+    obstacle.yaw = yaw;
+    m_obstacles.push_back(obstacle);
+    MarkObstacleTiles(obstacle);
+    return obstacle.id;
+}
+
+NavObstacleId NavPolyMesh::AddCylinderObstacle(const XMFLOAT3& position, float radius, float height)
+{
+    Obstacle obstacle;
+    obstacle.id = m_nextObstacleId++;
+    obstacle.cylinder = true;
+    obstacle.position = position;
+    obstacle.halfExtents = { radius, height, radius };
+    m_obstacles.push_back(obstacle);
+    MarkObstacleTiles(obstacle);
+    return obstacle.id;
+}
+
+bool NavPolyMesh::RemoveObstacle(NavObstacleId id)
+{
+    auto it = std::find_if(m_obstacles.begin(), m_obstacles.end(),
+        [id](const Obstacle& o) { return o.id == id; });
+    if (it == m_obstacles.end())
+        return false;
+
+    const Obstacle removed = *it;
+    m_obstacles.erase(it);
+    MarkObstacleTiles(removed);
+    return true;
+}
+
+void NavPolyMesh::MarkObstacleTiles(const Obstacle& obstacle)
+{
+    if (m_tilesX == 0 || m_tilesZ == 0)
+        return;
+
+    // A tile sees geometry within its padding border, so obstacles that close affect it too
+    XMFLOAT3 bmin, bmax;
+    obstacle.GetBounds(bmin, bmax);
+    const float tileWorld = m_config.tileSize * m_config.cellSize;
+    const float pad = (std::ceil(m_config.agentRadius / m_config.cellSize) + 3.0f) * m_config.cellSize;
+    const int tx0 = std::max(0, static_cast<int>(std::floor((bmin.x - pad - m_originX) / tileWorld)));
+    const int tx1 = std::min(m_tilesX - 1, static_cast<int>(std::floor((bmax.x + pad - m_originX) / tileWorld)));
+    const int tz0 = std::max(0, static_cast<int>(std::floor((bmin.z - pad - m_originZ) / tileWorld)));
+    const int tz1 = std::min(m_tilesZ - 1, static_cast<int>(std::floor((bmax.z + pad - m_originZ) / tileWorld)));
+    for (int tz = tz0; tz <= tz1; ++tz)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            const int tileIndex = tz * m_tilesX + tx;
+            if (std::find(m_dirtyTiles.begin(), m_dirtyTiles.end(), tileIndex) == m_dirtyTiles.end())
+                m_dirtyTiles.push_back(tileIndex);
+        }
+    }
+}
+
+// ============================================================================
+// Background tile rebuild
+// ============================================================================
+int NavPolyMesh::Update()
+{
+    if (!m_tileSet.load())
+        return 0;
+
+    // Queue tiles touched since the last call, with the obstacle set as of now
+    if (!m_dirtyTiles.empty())
+    {
+        auto obstacles = std::make_shared<const std::vector<Obstacle>>(m_obstacles);
+        {
+            std::lock_guard<std::mutex> lock(m_rebuildMutex);
+            m_obstacleSnapshot = std::move(obstacles);
+            for (int tileIndex : m_dirtyTiles)
+            {
+                if (m_tileQueued[tileIndex]) continue;
+                m_tileQueued[tileIndex] = 1;
+                m_rebuildQueue.push_back(tileIndex);
+            }
+            if (!m_rebuildRunning)
+            {
+                m_rebuildRunning = true;
+                m_rebuildThread = std::thread(&NavPolyMesh::RebuildLoop, this);
+            }
+        }
+        m_dirtyTiles.clear();
+        m_rebuildCv.notify_one();
+    }
+
+    std::vector<std::pair<int, std::shared_ptr<NavPolyTile>>> rebuilt;
+    {
+        std::lock_guard<std::mutex> lock(m_rebuildMutex);
+        rebuilt.swap(m_rebuiltTiles);
+    }
+    if (rebuilt.empty())
+        return 0;
+
+    PublishTiles(rebuilt);
+    return static_cast<int>(rebuilt.size());
+}
+
+bool NavPolyMesh::IsRebuildPending() const
+{
+    if (!m_dirtyTiles.empty())
+        return true;
+    std::lock_guard<std::mutex> lock(m_rebuildMutex);
+    return !m_rebuildQueue.empty() || m_rebuildBusy || !m_rebuiltTiles.empty();
+}
+
+void NavPolyMesh::WaitForRebuilds()
+{
+    Update();
+    {
+        std::unique_lock<std::mutex> lock(m_rebuildMutex);
+        m_rebuildIdleCv.wait(lock, [this]() { return m_rebuildQueue.empty() && !m_rebuildBusy; });
+    }
+    Update();
+}
+
+uint32_t NavPolyMesh::GetRevision() const
+{
+    const auto tiles = m_tileSet.load();
+    return tiles ? tiles->revision : 0;
+}
+
+uint32_t NavPolyMesh::GetTileRevision(int tileIndex) const
+{
+    const NavPolyTile* tile = GetTile(tileIndex);
+    return tile ? tile->revision : 0;
+}
+
+void NavPolyMesh::RebuildLoop()
+{
+    while (true)
+    {
+        int tileIndex;
+        std::shared_ptr<const std::vector<Obstacle>> obstacles;
+        {
+            std::unique_lock<std::mutex> lock(m_rebuildMutex);
+            m_rebuildCv.wait(lock, [this]() { return !m_rebuildRunning || !m_rebuildQueue.empty(); });
+            if (!m_rebuildRunning)
+                return;
+
+            tileIndex = m_rebuildQueue.front();
+            m_rebuildQueue.pop_front();
+            m_tileQueued[tileIndex] = 0;   // Edits from now on queue the tile again
+            obstacles = m_obstacleSnapshot;
+            m_rebuildBusy = true;
+        }
+
+        std::shared_ptr<NavPolyTile> tile;
+        if (!m_tileTriangles[tileIndex].empty())
+            tile = BuildTile(tileIndex % m_tilesX, tileIndex / m_tilesX, m_tileTriangles[tileIndex], *obstacles);
+
+        {
+            std::lock_guard<std::mutex> lock(m_rebuildMutex);
+            m_rebuiltTiles.emplace_back(tileIndex, std::move(tile));
+            m_rebuildBusy = false;
+        }
+        m_rebuildIdleCv.notify_all();
+    }
+}
+
+void NavPolyMesh::StopRebuildThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_rebuildMutex);
+        m_rebuildRunning = false;
+    }
+    m_rebuildCv.notify_all();
+    if (m_rebuildThread.joinable())
+        m_rebuildThread.join();
+
+    std::lock_guard<std::mutex> lock(m_rebuildMutex);
+    m_rebuildQueue.clear();
+    m_rebuiltTiles.clear();
+    m_rebuildBusy = false;
+    std::fill(m_tileQueued.begin(), m_tileQueued.end(), 0);
+    m_obstacleSnapshot.reset();
+}
+
+void NavPolyMesh::PublishTiles(const std::vector<std::pair<int, std::shared_ptr<NavPolyTile>>>& rebuilt)
+{
+    const auto current = m_tileSet.load();
+    auto next = std::make_shared<TileSet>(*current);
+
+    // Rebuilt tiles go in first (later results for the same tile win),
+    // then they and their neighbours are relinked against the new set
+    std::vector<std::shared_ptr<NavPolyTile>> relink(next->tiles.size());
+    for (const auto& [tileIndex, tile] : rebuilt)
+    {
+        next->tiles[tileIndex] = tile;
+        relink[tileIndex] = tile;
+    }
+    for (const auto& [tileIndex, tile] : rebuilt)
+    {
+        const int tx = tileIndex % m_tilesX;
+        const int tz = tileIndex / m_tilesX;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const int nx = tx + k_DirX[dir];
+            const int nz = tz + k_DirZ[dir];
+            if (nx < 0 || nz < 0 || nx >= m_tilesX || nz >= m_tilesZ) continue;
+            const int neighbourIndex = nz * m_tilesX + nx;
+            if (relink[neighbourIndex] || !next->tiles[neighbourIndex]) continue;
+
+            // Published tiles are immutable: relink a copy (same polygons, same revision)
+            auto copy = std::make_shared<NavPolyTile>(*next->tiles[neighbourIndex]);
+            next->tiles[neighbourIndex] = copy;
+            relink[neighbourIndex] = std::move(copy);
+        }
+    }
+    for (const auto& tile : relink)
+    {
+        if (tile) LinkTile(*tile, *next);
+    }
+
+    UpdatePolyBase(*next);
+    next->revision = current->revision + 1;
+    m_tileSet.store(std::move(next));
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+const NavPolyTile* NavPolyMesh::GetTile(int tileIndex) const
+{
+    const auto tiles = m_tileSet.load();
+    if (!tiles || tileIndex < 0 || tileIndex >= static_cast<int>(tiles->tiles.size()))
+        return nullptr;
+    return tiles->tiles[tileIndex].get();
+}
+
+uint32_t NavPolyMesh::GetPolyCount() const
+{
+    const auto tiles = m_tileSet.load();
+    return tiles ? tiles->totalPolys : 0;
+}
+
+const NavPolyTile::Poly* NavPolyMesh::GetPoly(const TileSet& tiles, NavPolyRef ref, const NavPolyTile** tile)
+{
+    const int tileIndex = GetTileIndex(ref);
+    if (tileIndex >= static_cast<int>(tiles.tiles.size()))
+        return nullptr;
+    const NavPolyTile* t = tiles.tiles[tileIndex].get();
+    if (!t || GetPolyIndex(ref) >= static_cast<int>(t->polys.size()))
+        return nullptr;
+    if (tile) *tile = t;
+    return &t->polys[GetPolyIndex(ref)];
+}
+
+bool NavPolyMesh::ClosestPointOnPoly(const NavPolyTile& tile, const NavPolyTile::Poly& poly,
+                                     const XMFLOAT3& position, XMFLOAT3& closest)
+{
+    const int n = poly.vertCount;
+
+    // Inside test on XZ (convex, either winding)
+    bool positive = false, negative = false;
+    for (int i = 0; i < n; ++i)
+    {
+        const float c = Cross2D(tile.vertices[poly.verts[i]], tile.vertices[poly.verts[(i + 1) % n]], position);
+        positive |= c > 0.0f;
+        negative |= c < 0.0f;
+    }
+
+    if (!(positive && negative))
+    {
+        // Height from the triangle fan containing the point
+        const XMFLOAT3& a = tile.vertices[poly.verts[0]];
+        for (int i = 1; i + 1 < n; ++i)
+        {
+            const XMFLOAT3& b = tile.vertices[poly.verts[i]];
+            const XMFLOAT3& c = tile.vertices[poly.verts[i + 1]];
+            const float v0x = c.x - a.x, v0z = c.z - a.z;
+            const float v1x = b.x - a.x, v1z = b.z - a.z;
+            const float v2x = position.x - a.x, v2z = position.z - a.z;
+            const float denom = v0x * v1z - v0z * v1x;
+            if (std::abs(denom) < 1e-12f) continue;
+            const float u = (v2x * v1z - v2z * v1x) / denom;
+            const float v = (v0x * v2z - v0z * v2x) / denom;
+            const float eps = 1e-4f;
+            if (u >= -eps && v >= -eps && u + v <= 1.0f + eps)
+            {
+                closest = { position.x, a.y + (c.y - a.y) * u + (b.y - a.y) * v, position.z };
+                return true;
+            }
+        }
+        closest = { position.x, poly.center.y, position.z };
+        return true;
+    }
+
+    // Outside: closest point on the boundary
+    float best = FLT_MAX;
+    for (int i = 0; i < n; ++i)
+    {
+        const XMFLOAT3& a = tile.vertices[poly.verts[i]];
+        const XMFLOAT3& b = tile.vertices[poly.verts[(i + 1) % n]];
+        const float abx = b.x - a.x, abz = b.z - a.z;
+        const float len = abx * abx + abz * abz;
+        float t = len > 0.0f ? ((position.x - a.x) * abx + (position.z - a.z) * abz) / len : 0.0f;
+        t = std::max(0.0f, std::min(1.0f, t));
+        const XMFLOAT3 p = Lerp3(a, b, t);
+        const float d = DistSqr(p, position);
+        if (d < best)
+        {
+            best = d;
+            closest = p;
+        }
+    }
+    return false;
+}
+
+NavPolyRef NavPolyMesh::FindNearestPoly(const XMFLOAT3& position, const XMFLOAT3& extents,
+                                        XMFLOAT3* nearest) const
+{
+    const auto tiles = m_tileSet.load();
+    if (!tiles)
+        return k_InvalidNavPolyRef;
+    return FindNearestPoly(*tiles, position, extents, nearest);
+}
+
+NavPolyRef NavPolyMesh::FindNearestPoly(const TileSet& tiles, const XMFLOAT3& position,
+                                        const XMFLOAT3& extents, XMFLOAT3* nearest) const
+{
+    const float tileWorld = m_config.tileSize * m_config.cellSize;
+    const int tx0 = std::max(0, static_cast<int>(std::floor((position.x - extents.x - m_originX) / tileWorld)));
+    const int tx1 = std::min(m_tilesX - 1, static_cast<int>(std::floor((position.x + extents.x - m_originX) / tileWorld)));
+    const int tz0 = std::max(0, static_cast<int>(std::floor((position.z - extents.z - m_originZ) / tileWorld)));
+    const int tz1 = std::min(m_tilesZ - 1, static_cast<int>(std::floor((position.z + extents.z - m_originZ) / tileWorld)));
+
+    NavPolyRef bestRef = k_InvalidNavPolyRef;
+    float bestDist = FLT_MAX;
+    XMFLOAT3 bestPoint = position;
+
+    for (int tz = tz0; tz <= tz1; ++tz)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            const int tileIndex = tz * m_tilesX + tx;
+            const NavPolyTile* tile = tiles.tiles[tileIndex].get();
+            if (!tile) continue;
+            if (position.y + extents.y < tile->boundsMin.y || position.y - extents.y > tile->boundsMax.y)
+                continue;
+
+            for (size_t p = 0; p < tile->polys.size(); ++p)
+            {
+                XMFLOAT3 closest;
+                const bool inside = ClosestPointOnPoly(*tile, tile->polys[p], position, closest);
+                if (std::abs(closest.x - position.x) > extents.x ||
+                    std::abs(closest.y - position.y) > extents.y ||
+                    std::abs(closest.z - position.z) > extents.z)
+                    continue;
+
+                // Prefer polygons directly below/above the point
+                float d = DistSqr(closest, position);
+                if (!inside) d += m_config.cellSize * m_config.cellSize;
+                if (d < bestDist)
+                {
+                    bestDist = d;
+                    bestRef = MakeRef(tileIndex, static_cast<int>(p));
+                    bestPoint = closest;
+                }
+            }
+        }
+    }
+
+    if (nearest && bestRef != k_InvalidNavPolyRef)
+        *nearest = bestPoint;
+    return bestRef;
+}
+
+bool NavPolyMesh::FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
+                           std::vector<XMFLOAT3>& path,
+                           std::vector<NavPolyRef>* corridor) const
+{
+    path.clear();
+    if (corridor) corridor->clear();
+
+    // One snapshot for the whole query: tiles swapped in meanwhile are not seen
+    const auto tiles = m_tileSet.load();
+    if (!tiles || tiles->totalPolys == 0) return false;
+
+    XMFLOAT3 startPos, endPos;
+    const NavPolyRef startRef = FindNearestPoly(*tiles, start, m_queryExtents, &startPos);
+    const NavPolyRef endRef   = FindNearestPoly(*tiles, end, m_queryExtents, &endPos);
+    if (startRef == k_InvalidNavPolyRef || endRef == k_InvalidNavPolyRef)
+        return false;
+
+    std::vector<NavPolyRef> polys;
+    if (!FindPolyPath(*tiles, startRef, endRef, startPos, endPos, polys))
+        return false;
+
+    StringPull(*tiles, polys, startPos, endPos, path);
+    if (corridor)
+        *corridor = std::move(polys);
+    return !path.empty();
+}
+
+bool NavPolyMesh::FindPolyPath(NavPolyRef startRef, NavPolyRef endRef,
+                               const XMFLOAT3& start, const XMFLOAT3& end,
+                               std::vector<NavPolyRef>& polys) const
+{
+    polys.clear();
+    const auto tiles = m_tileSet.load();
+    return tiles && FindPolyPath(*tiles, startRef, endRef, start, end, polys);
+}
+
+bool NavPolyMesh::FindPolyPath(const TileSet& tiles, NavPolyRef startRef, NavPolyRef endRef,
+                               const XMFLOAT3& start, const XMFLOAT3& end,
+                               std::vector<NavPolyRef>& polys) const
+{
+    polys.clear();
+    if (!GetPoly(tiles, startRef) || !GetPoly(tiles, endRef))
+        return false;
+
+    if (startRef == endRef)
+    {
+        polys.push_back(startRef);
+        return true;
+    }
+
+    auto toNode = [&tiles](NavPolyRef ref) {
+        return static_cast<int>(tiles.polyBase[GetTileIndex(ref)] + GetPolyIndex(ref));
+    };
+
+    // Node positions: the point on the portal through which each polygon was entered
+    thread_local std::vector<XMFLOAT3> s_nodePos;
+    thread_local std::vector<NavPolyRef> s_nodeRef;
+    if (s_nodePos.size() < tiles.totalPolys)
+    {
+        s_nodePos.resize(tiles.totalPolys);
+        s_nodeRef.resize(tiles.totalPolys);
+    }
+
+    PathQueryContext& ctx = PathQueryContext::ForCurrentThread();
+    ctx.Begin(tiles.totalPolys);
+
+    const int startNode = toNode(startRef);
+    const int endNode   = toNode(endRef);
+    s_nodePos[startNode] = start;
+    s_nodeRef[startNode] = startRef;
+    ctx.Push(startNode, 0.0f, std::sqrt(DistSqr(start, end)), -1);
+
+    bool found = false;
+    while (!ctx.IsOpenEmpty())
+    {
+        const int node = ctx.PopMin();
+        if (node == endNode)
+        {
+            found = true;
+            break;
+        }
+
+        const NavPolyTile* tile = nullptr;
+        const NavPolyTile::Poly* poly = GetPoly(tiles, s_nodeRef[node], &tile);
+        const float g = ctx.GetCost(node);
+        const XMFLOAT3& pos = s_nodePos[node];
+
+        for (uint32_t l = poly->firstLink; l < poly->firstLink + poly->linkCount; ++l)
+        {
+            const NavPolyTile::Link& link = tile->links[l];
+            if (!GetPoly(tiles, link.target)) continue;
+
+            const int next = toNode(link.target);
+            if (ctx.IsClosed(next)) continue;
+
+            const XMFLOAT3 cross = PortalCrossing(pos, end, link.portalA, link.portalB);
+            float cost = g + std::sqrt(DistSqr(pos, cross));
+            if (next == endNode)
+                cost += std::sqrt(DistSqr(cross, end));
+
+            const float h = (next == endNode) ? 0.0f : std::sqrt(DistSqr(cross, end));
+            if (ctx.Push(next, cost, cost + h, node))
+            {
+                s_nodePos[next] = cross;
+                s_nodeRef[next] = link.target;
+            }
+        }
+    }
+
+    if (!found)
+        return false;
+
+    for (int node = endNode; node >= 0; node = ctx.GetParent(node))
+        polys.push_back(s_nodeRef[node]);
+    std::reverse(polys.begin(), polys.end());
+    return true;
+}
+
+void NavPolyMesh::StringPull(const std::vector<NavPolyRef>& polys,
+                             const XMFLOAT3& start, const XMFLOAT3& end,
+                             std::vector<XMFLOAT3>& path) const
+{
+    path.clear();
+    if (const auto tiles = m_tileSet.load())
+        StringPull(*tiles, polys, start, end, path);
+}
+
+void NavPolyMesh::StringPull(const TileSet& tiles, const std::vector<NavPolyRef>& polys,
+                             const XMFLOAT3& start, const XMFLOAT3& end,
+                             std::vector<XMFLOAT3>& path) const
+{
+    path.clear();
+    if (polys.empty()) return;
+
+    // Portals as (left, right) pairs, seen from the direction of travel
+    std::vector<XMFLOAT3> portals;
+    portals.reserve(polys.size() * 2 + 2);
+    portals.push_back(start);
+    portals.push_back(start);
+    for (size_t i = 0; i + 1 < polys.size(); ++i)
+    {
+        const NavPolyTile* tile = nullptr;
+        const NavPolyTile::Poly* poly = GetPoly(tiles, polys[i], &tile);
+        if (!poly) break;
+        const NavPolyTile::Link* portal = nullptr;
+        for (uint32_t l = poly->firstLink; l < poly->firstLink + poly->linkCount && !portal; ++l)
+        {
+            if (tile->links[l].target == polys[i + 1])
+                portal = &tile->links[l];
+        }
+        if (!portal) break;
+
+        XMFLOAT3 left = portal->portalA, right = portal->portalB;
+        if (Cross2D(poly->center, portal->portalA, portal->portalB) > 0.0f)
+            std::swap(left, right);
+        portals.push_back(left);
+        portals.push_back(right);
+    }
+    portals.push_back(end);
+    portals.push_back(end);
+
+    // Simple stupid funnel algorithm
+    const int portalCount = static_cast<int>(portals.size() / 2);
+    XMFLOAT3 apex = portals[0], left = portals[0], right = portals[1];
+    int apexIndex = 0, leftIndex = 0, rightIndex = 0;
+    path.push_back(apex);
+
+    for (int i = 1; i < portalCount; ++i)
+    {
+        const XMFLOAT3& pl = portals[i * 2 + 0];
+        const XMFLOAT3& pr = portals[i * 2 + 1];
+
+        // Tighten the right side
+        if (TriArea2(apex, right, pr) <= 0.0f)
+        {
+            if (NearlyEqual(apex, right) || TriArea2(apex, left, pr) > 0.0f)
+            {
+                right = pr;
+                rightIndex = i;
+            }
+            else
+            {
+                // Right crossed over left: left becomes a corner
+                if (!NearlyEqual(path.back(), left)) path.push_back(left);
+                apex = left;
+                apexIndex = leftIndex;
+                right = apex;
+                rightIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+
+        // Tighten the left side
+        if (TriArea2(apex, left, pl) >= 0.0f)
+        {
+            if (NearlyEqual(apex, left) || TriArea2(apex, right, pl) < 0.0f)
+            {
+                left = pl;
+                leftIndex = i;
+            }
+            else
+            {
+                // Left crossed over right: right becomes a corner
+                if (!NearlyEqual(path.back(), right)) path.push_back(right);
+                apex = right;
+                apexIndex = rightIndex;
+                left = apex;
+                leftIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+    }
+
+    if (!NearlyEqual(path.back(), end) || path.size() == 1)
+        path.push_back(end);
+}
+
+// ============================================================================
+// DebugDraw
+// ============================================================================
+void NavPolyMesh::DebugDraw(PrimitiveBatch3D& batch) const
+{
+    const XMFLOAT4 internalColor = { 0.1f, 0.7f, 0.9f, 0.35f };
+    const XMFLOAT4 wallColor     = { 1.0f, 0.55f, 0.1f, 0.9f };
+    const float yOffset = 0.05f;
+
+    const auto tiles = m_tileSet.load();
+    if (!tiles) return;
+    for (const auto& tile : tiles->tiles)
+    {
+        if (!tile) continue;
+        for (const auto& poly : tile->polys)
+        {
+            for (int e = 0; e < poly.vertCount; ++e)
+            {
+                XMFLOAT3 a = tile->vertices[poly.verts[e]];
+                XMFLOAT3 b = tile->vertices[poly.verts[(e + 1) % poly.vertCount]];
+                a.y += yOffset;
+                b.y += yOffset;
+                batch.DrawLine(a, b, poly.neighbours[e] != 0 ? internalColor : wallColor);
+            }
+        }
+    }
+}
+
+} // namespace GX
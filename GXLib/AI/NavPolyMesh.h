@@ -0,0 +1,291 @@
+#pragma once
+/// @file NavPolyMesh.h
+/// @brief Tiled polygon navigation mesh (Recast-style build pipeline)
+///
+/// Builds convex walkable polygons from triangle geometry: the input is
+/// voxelized into height spans, filtered by agent height / climb / slope,
+/// eroded by the agent radius, partitioned into monotone regions whose
+/// contours are traced, simplified, triangulated and merged into convex
+/// polygons. Unlike the NavMesh grid, floors may overlap and paths are
+/// string-pulled through polygon portals instead of visiting every cell.
+/// The world is split into fixed-size tiles that are built on worker threads.
+///
+/// Dynamic obstacles (boxes, cylinders) carve the mesh at runtime: tiles they
+/// touch are rebuilt on a background thread and swapped in atomically by
+/// Update(), so queries running on other threads always see a consistent set.
+
+#include "pch.h"
+#include <deque>
+
+namespace GX
+{
+
+class PrimitiveBatch3D;
+
+/// @brief Polygon reference: tile index in the upper 16 bits, polygon index in the lower 16
+using NavPolyRef = uint32_t;
+
+/// @brief Invalid polygon reference
+constexpr NavPolyRef k_InvalidNavPolyRef = 0xFFFFFFFFu;
+
+/// @brief Dynamic obstacle handle (0 = invalid)
+using NavObstacleId = uint32_t;
+
+/// @brief Build parameters for NavPolyMesh
+struct NavPolyMeshConfig
+{
+    float cellSize      = 0.3f;   ///< Voxel size on XZ (world units)
+    float cellHeight    = 0.2f;   ///< Voxel size on Y (world units)
+    float agentHeight   = 2.0f;   ///< Minimum ceiling clearance
+    float agentRadius   = 0.5f;   ///< Walkable area is eroded by this distance
+    float maxClimb      = 0.9f;   ///< Maximum step height
+    float maxSlope      = 45.0f;  ///< Maximum walkable slope (degrees)
+    int   tileSize      = 64;     ///< Tile edge length in cells
+    int   minRegionArea = 8;      ///< Isolated walkable islands smaller than this (cells) are removed
+    float maxEdgeError  = 1.3f;   ///< Contour simplification tolerance (world units)
+    uint32_t workerCount = 0;     ///< Tile build threads (0 = hardware concurrency)
+};
+
+/// @brief One built tile of polygons (immutable once published)
+struct NavPolyTile
+{
+    static constexpr int k_MaxVertsPerPoly = 6;
+
+    /// @brief Connection from a polygon edge to a neighbouring polygon
+    struct Link
+    {
+        NavPolyRef target = k_InvalidNavPolyRef;  ///< Neighbour polygon
+        XMFLOAT3   portalA = {};                  ///< Portal endpoint (shared edge or overlap)
+        XMFLOAT3   portalB = {};                  ///< Portal endpoint
+    };
+
+    /// @brief Convex polygon
+    struct Poly
+    {
+        uint16_t verts[k_MaxVertsPerPoly] = {};
+        /// Per edge: 0 = wall, 1..0x7FFF = internal neighbour + 1, 0x8000 | side = tile border edge
+        uint16_t neighbours[k_MaxVertsPerPoly] = {};
+        uint8_t  vertCount = 0;
+        uint32_t firstLink = 0;   ///< Index into links
+        uint32_t linkCount = 0;
+        XMFLOAT3 center = {};
+    };
+
+    int tileX = 0;                 ///< Tile column
+    int tileZ = 0;                 ///< Tile row
+    uint32_t revision = 0;         ///< Unique per build; changes whenever the tile is rebuilt
+    XMFLOAT3 boundsMin = {};       ///< World bounds of the polygons
+    XMFLOAT3 boundsMax = {};
+    std::vector<XMFLOAT3> vertices;
+    std::vector<Poly> polys;
+    std::vector<Link> links;       ///< Grouped per polygon (internal + cross-tile)
+};
+
+/// @brief Tiled polygon navigation mesh
+class NavPolyMesh
+{
+public:
+    NavPolyMesh() = default;
+    ~NavPolyMesh();
+
+    NavPolyMesh(const NavPolyMesh&) = delete;
+    NavPolyMesh& operator=(const NavPolyMesh&) = delete;
+
+    /// @brief Build from raw geometry (same input layout as NavMesh::BuildFromGeometry)
+    /// @param vertices    Vertex positions (x,y,z repeated, stride = 3 floats)
+    /// @param vertexCount Number of vertices
+    /// @param indices     Triangle index array
+    /// @param indexCount  Number of indices (must be multiple of 3)
+    /// @param config      Build parameters
+    /// @return true if at least one polygon was generated
+    /// @note Obstacles added earlier are kept and carved into the new mesh
+    bool Build(const float* vertices, int vertexCount,
+               const int* indices, int indexCount,
+               const NavPolyMeshConfig& config = {});
+
+    /// @brief Release all tiles and obstacles
+    void Clear();
+
+    /// @brief Add an obstacle box (rotated around Y by yaw radians)
+    /// @return Obstacle handle. The mesh changes after the rebuild is published by Update().
+    NavObstacleId AddBoxObstacle(const XMFLOAT3& center, const XMFLOAT3& halfExtents, float yaw = 0.0f);
+
+    /// @brief Add an upright cylinder obstacle
+    /// @param position Center of the cylinder's bottom
+    NavObstacleId AddCylinderObstacle(const XMFLOAT3& position, float radius, float height);
+
+    /// @brief Remove an obstacle
+    /// @return false if the handle is unknown
+    bool RemoveObstacle(NavObstacleId id);
+
+    /// @brief Queue rebuilds for tiles touched by obstacle changes and publish finished tiles
+    ///
+    /// Call once per frame from the thread that owns the mesh. Tiles are built
+    /// on a background thread; finished tiles and their relinked neighbours are
+    /// swapped in together, bumping GetRevision() and the tiles' revisions.
+    /// @return Number of rebuilt tiles published by this call
+    int Update();
+
+    /// @brief Check whether tile rebuilds are queued or running
+    bool IsRebuildPending() const;
+
+    /// @brief Block until all queued rebuilds are finished, then publish them
+    void WaitForRebuilds();
+
+    /// @brief Counter bumped whenever a new set of tiles is published
+    uint32_t GetRevision() const;
+
+    /// @brief Revision of a tile (0 if empty); compare to detect rebuilt tiles on a path
+    uint32_t GetTileRevision(int tileIndex) const;
+
+    /// @brief Find a smoothed path between two world positions
+    ///
+    /// Both positions are snapped to the nearest polygon within the query
+    /// extents. The polygon corridor is found with A* and then string-pulled
+    /// (funnel algorithm) so waypoints only appear at corners.
+    /// @param start Start world position
+    /// @param end   Goal world position
+    /// @param path     Output: waypoints in world coordinates
+    /// @param corridor Optional output: polygons the path passes through
+    /// @return true if a path was found
+    bool FindPath(const XMFLOAT3& start, const XMFLOAT3& end,
+                  std::vector<XMFLOAT3>& path,
+                  std::vector<NavPolyRef>* corridor = nullptr) const;
+
+    /// @brief Find the polygon corridor between two polygons (A* over polygon adjacency)
+    /// @return true if endRef was reached
+    /// @note Polygon references are only stable until the next Update() publishes new tiles
+    bool FindPolyPath(NavPolyRef startRef, NavPolyRef endRef,
+                      const XMFLOAT3& start, const XMFLOAT3& end,
+                      std::vector<NavPolyRef>& polys) const;
+
+    /// @brief Turn a polygon corridor into corner waypoints (funnel / string pulling)
+    void StringPull(const std::vector<NavPolyRef>& polys,
+                    const XMFLOAT3& start, const XMFLOAT3& end,
+                    std::vector<XMFLOAT3>& path) const;
+
+    /// @brief Find the polygon closest to a position
+    /// @param position Query position
+    /// @param extents  Half-size of the search box
+    /// @param nearest  Optional output: closest point on the polygon
+    /// @return Polygon reference, or k_InvalidNavPolyRef if none within the box
+    NavPolyRef FindNearestPoly(const XMFLOAT3& position, const XMFLOAT3& extents,
+                               XMFLOAT3* nearest = nullptr) const;
+
+    /// @brief Debug draw polygon outlines (cyan = internal edge, orange = wall)
+    void DebugDraw(PrimitiveBatch3D& batch) const;
+
+    /// @brief Search box half-size used by FindPath to snap its endpoints
+    void SetQueryExtents(const XMFLOAT3& extents) { m_queryExtents = extents; }
+
+    bool IsBuilt() const { return GetPolyCount() > 0; }
+    int  GetTileCountX() const { return m_tilesX; }
+    int  GetTileCountZ() const { return m_tilesZ; }
+    uint32_t GetPolyCount() const;
+    const NavPolyMeshConfig& GetConfig() const { return m_config; }
+
+    /// @brief Get a tile by index (nullptr if empty; valid until the next Update())
+    const NavPolyTile* GetTile(int tileIndex) const;
+
+    /// @brief Decode a polygon reference
+    static int GetTileIndex(NavPolyRef ref) { return static_cast<int>(ref >> 16); }
+    static int GetPolyIndex(NavPolyRef ref) { return static_cast<int>(ref & 0xFFFF); }
+    static NavPolyRef MakeRef(int tileIndex, int polyIndex)
+    {
+        return (static_cast<NavPolyRef>(tileIndex) << 16) | static_cast<NavPolyRef>(polyIndex);
+    }
+
+private:
+    /// Dynamic obstacle shape
+    struct Obstacle
+    {
+        NavObstacleId id = 0;
+        bool     cylinder = false;
+        XMFLOAT3 position = {};      ///< Box: center / Cylinder: bottom center
+        XMFLOAT3 halfExtents = {};   ///< Box: half size / Cylinder: (radius, height, radius)
+        float    yaw = 0.0f;
+
+        void GetBounds(XMFLOAT3& bmin, XMFLOAT3& bmax) const;
+        bool ContainsXZ(float x, float z) const;
+    };
+
+    /// Immutable published tile set; replaced as a whole on every swap
+    struct TileSet
+    {
+        std::vector<std::shared_ptr<const NavPolyTile>> tiles;
+        std::vector<uint32_t> polyBase;   ///< First global polygon index per tile
+        uint32_t totalPolys = 0;
+        uint32_t revision = 0;
+    };
+
+    /// Build one tile from its bucket of source triangles (thread-safe)
+    std::shared_ptr<NavPolyTile> BuildTile(int tileX, int tileZ, const std::vector<int>& triangles,
+                                           const std::vector<Obstacle>& obstacles) const;
+
+    /// Rebuild the link list of a tile (internal + cross-tile portals)
+    void LinkTile(NavPolyTile& tile, const TileSet& tiles) const;
+
+    /// Recompute polygon index offsets used by path searches
+    static void UpdatePolyBase(TileSet& tiles);
+
+    /// Swap rebuilt tiles in, relinking their neighbours
+    void PublishTiles(const std::vector<std::pair<int, std::shared_ptr<NavPolyTile>>>& rebuilt);
+
+    /// Queue the tiles an obstacle overlaps for rebuild at the next Update()
+    void MarkObstacleTiles(const Obstacle& obstacle);
+
+    void RebuildLoop();
+    void StopRebuildThread();
+
+    bool FindPolyPath(const TileSet& tiles, NavPolyRef startRef, NavPolyRef endRef,
+                      const XMFLOAT3& start, const XMFLOAT3& end,
+                      std::vector<NavPolyRef>& polys) const;
+    void StringPull(const TileSet& tiles, const std::vector<NavPolyRef>& polys,
+                    const XMFLOAT3& start, const XMFLOAT3& end,
+                    std::vector<XMFLOAT3>& path) const;
+    NavPolyRef FindNearestPoly(const TileSet& tiles, const XMFLOAT3& position,
+                               const XMFLOAT3& extents, XMFLOAT3* nearest) const;
+
+    /// Closest point on a polygon; returns true if the position projects inside it
+    static bool ClosestPointOnPoly(const NavPolyTile& tile, const NavPolyTile::Poly& poly,
+                                   const XMFLOAT3& position, XMFLOAT3& closest);
+
+    static const NavPolyTile::Poly* GetPoly(const TileSet& tiles, NavPolyRef ref,
+                                            const NavPolyTile** tile = nullptr);
+
+    NavPolyMeshConfig m_config;
+    XMFLOAT3 m_queryExtents = { 2.0f, 4.0f, 2.0f };
+
+    // Source geometry (kept so that tiles can be rebuilt)
+    std::vector<float> m_sourceVertices;
+    std::vector<int>   m_sourceIndices;
+    float m_originX = 0.0f;
+    float m_originZ = 0.0f;
+    float m_minY    = 0.0f;
+    float m_maxY    = 0.0f;
+    int   m_tilesX  = 0;
+    int   m_tilesZ  = 0;
+    std::vector<std::vector<int>> m_tileTriangles;   ///< Source triangles per tile (incl. padding)
+
+    std::atomic<std::shared_ptr<const TileSet>> m_tileSet;
+    mutable std::atomic<uint32_t> m_nextTileRevision{ 1 };
+
+    // Obstacles (owner thread)
+    std::vector<Obstacle> m_obstacles;
+    NavObstacleId m_nextObstacleId = 1;
+    std::vector<int> m_dirtyTiles;
+
+    // Background rebuild thread
+    std::thread m_rebuildThread;
+    mutable std::mutex m_rebuildMutex;
+    std::condition_variable m_rebuildCv;
+    std::condition_variable m_rebuildIdleCv;
+    bool m_rebuildRunning = false;
+    bool m_rebuildBusy = false;
+    std::deque<int> m_rebuildQueue;
+    std::vector<uint8_t> m_tileQueued;
+    std::shared_ptr<const std::vector<Obstacle>> m_obstacleSnapshot;
+    std::vector<std::pair<int, std::shared_ptr<NavPolyTile>>> m_rebuiltTiles;
+};
+
+} // namespace GX
@@ -0,0 +1,127 @@
+#include "pch.h"
+/// @file PathQueryContext.cpp
+/// @brief Reusable scratch state for grid path searches
+
+#include "AI/PathQueryContext.h"
+
+namespace GX
+{
+
+PathQueryContext& PathQueryContext::ForCurrentThread()
+{
+    thread_local PathQueryContext context;
+    return context;
+}
+
+// ============================================================================
+// Begin
+// ============================================================================
+void PathQueryContext::Begin(size_t nodeCount)
+{
+    if (m_nodes.size() < nodeCount)
+        m_nodes.resize(nodeCount);
+
+    m_heap.clear();
+    m_expanded = 0;
+
+    // Bumping the generation invalidates every record at once. Only on
+    // wrap-around do the stamps need an actual reset.
+    if (++m_generation == 0)
+    {
+        for (auto& node : m_nodes)
+            node.stamp = 0;
+        m_generation = 1;
+    }
+}
+
+// ============================================================================
+// Open list (indexed binary heap)
+// ============================================================================
+bool PathQueryContext::Push(int node, float g, float f, int parent)
+{
+    NodeRecord& rec = m_nodes[node];
+    if (rec.stamp != m_generation)
+    {
+        rec.stamp     = m_generation;
+        rec.g         = FLT_MAX;
+        rec.heapIndex = k_NotInHeap;
+    }
+
+    if (rec.heapIndex == k_Closed || g >= rec.g)
+        return false;
+
+    rec.g      = g;
+    rec.parent = parent;
+
+    if (rec.heapIndex == k_NotInHeap)
+    {
+        rec.heapIndex = static_cast<int>(m_heap.size());
+        m_heap.push_back({ f, node });
+    }
+    else
+    {
+        // Decrease-key: the entry can only move towards the root
+        m_heap[rec.heapIndex].f = f;
+    }
+    SiftUp(static_cast<size_t>(rec.heapIndex));
+    return true;
+}
+
+int PathQueryContext::PopMin()
+{
+    if (m_heap.empty())
+        return -1;
+
+    const int node = m_heap.front().node;
+    m_nodes[node].heapIndex = k_Closed;
+    ++m_expanded;
+
+    const HeapEntry last = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty())
+    {
+        m_heap.front() = last;
+        m_nodes[last.node].heapIndex = 0;
+        SiftDown(0);
+    }
+    return node;
+}
+
+void PathQueryContext::SiftUp(size_t index)
+{
+    const HeapEntry entry = m_heap[index];
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+        if (m_heap[parent].f <= entry.f)
+            break;
+        m_heap[index] = m_heap[parent];
+        m_nodes[m_heap[index].node].heapIndex = static_cast<int>(index);
+        index = parent;
+    }
+    m_heap[index] = entry;
+    m_nodes[entry.node].heapIndex = static_cast<int>(index);
+}
+
+void PathQueryContext::SiftDown(size_t index)
+{
+    const HeapEntry entry = m_heap[index];
+    const size_t count = m_heap.size();
+    while (true)
+    {
+        size_t child = index * 2 + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && m_heap[child + 1].f < m_heap[child].f)
+            ++child;
+        if (entry.f <= m_heap[child].f)
+            break;
+        m_heap[index] = m_heap[child];
+        m_nodes[m_heap[index].node].heapIndex = static_cast<int>(index);
+        index = child;
+    }
+    m_heap[index] = entry;
+    m_nodes[entry.node].heapIndex = static_cast<int>(index);
+}
+
+} // namespace GX
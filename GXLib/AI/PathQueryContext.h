@@ -0,0 +1,119 @@
+#pragma once
+/// @file PathQueryContext.h
+/// @brief Reusable scratch state for grid path searches
+///
+/// Holds the per-node search data (g-cost, parent, open/closed state) and an
+/// indexed binary min-heap. Node records are stamped with a query generation,
+/// so starting a new query is O(1) regardless of grid size: stale records are
+/// simply treated as untouched. Buffers only grow, so a context that has been
+/// used once on a grid performs no further allocations on it. Hierarchical
+/// (HPA*) queries run their abstract search on the same node records and keep
+/// their cluster-local searches in the context as well.
+
+#include "pch.h"
+
+namespace GX
+{
+
+/// @brief Buffers for a Dijkstra search restricted to one HPA* cluster
+///
+/// Indexed by cluster-local cell. Sized on first use; clusters of a navmesh
+/// share one size, so later searches reuse the capacity.
+struct ClusterSearchScratch
+{
+    std::vector<float> dist;                    ///< Cost per local cell (FLT_MAX = unreached)
+    std::vector<int>   parent;                  ///< Predecessor per local cell (-1 = none)
+    std::vector<std::pair<float, int>> open;    ///< Min-heap of (cost, local cell), lazy deletion
+};
+
+/// @brief Scratch state for one path search at a time
+///
+/// A context is not thread-safe; give each thread its own. ForCurrentThread()
+/// returns a lazily created per-thread instance for that purpose.
+class PathQueryContext
+{
+public:
+    PathQueryContext() = default;
+    ~PathQueryContext() = default;
+
+    PathQueryContext(const PathQueryContext&) = delete;
+    PathQueryContext& operator=(const PathQueryContext&) = delete;
+
+    /// @brief Get the context owned by the calling thread
+    static PathQueryContext& ForCurrentThread();
+
+    /// @brief Start a new query over nodeCount nodes (invalidates all previous node data)
+    void Begin(size_t nodeCount);
+
+    /// @brief Check if a node has been reached in the current query
+    bool IsTouched(int node) const { return m_nodes[node].stamp == m_generation; }
+
+    /// @brief Check if a node has been expanded in the current query
+    bool IsClosed(int node) const { return IsTouched(node) && m_nodes[node].heapIndex == k_Closed; }
+
+    /// @brief Best known cost to a node (FLT_MAX if not reached)
+    float GetCost(int node) const { return IsTouched(node) ? m_nodes[node].g : FLT_MAX; }
+
+    /// @brief Predecessor of a node on its best known path (-1 for the start node)
+    int GetParent(int node) const { return IsTouched(node) ? m_nodes[node].parent : -1; }
+
+    /// @brief Insert a node into the open list, or lower its key if already open
+    /// @param node   Node index
+    /// @param g      Cost from the start
+    /// @param f      Priority (g + heuristic)
+    /// @param parent Predecessor node (-1 for the start)
+    /// @return true if the node was inserted or improved
+    bool Push(int node, float g, float f, int parent);
+
+    /// @brief Remove the open node with the smallest priority and mark it closed
+    /// @return Node index, or -1 if the open list is empty
+    int PopMin();
+
+    /// @brief Check if the open list is empty
+    bool IsOpenEmpty() const { return m_heap.empty(); }
+
+    /// @brief Number of nodes expanded by the current query
+    uint32_t GetExpandedCount() const { return m_expanded; }
+
+    // -- Buffers reused across queries --
+
+    /// @brief Cell path of the current query (grid cell indices, start to goal)
+    std::vector<int>& GetCellPath() { return m_cellPath; }
+
+    /// @brief Abstract node path of a hierarchical query (start to goal)
+    std::vector<int>& GetNodePath() { return m_nodePath; }
+
+    /// @brief Local search around the start (index 0) or goal (index 1) of a hierarchical query
+    ClusterSearchScratch& GetClusterSearch(int index) { return m_clusterSearch[index]; }
+
+private:
+    static constexpr int k_NotInHeap = -1;
+    static constexpr int k_Closed    = -2;
+
+    struct NodeRecord
+    {
+        uint32_t stamp     = 0;
+        float    g         = FLT_MAX;
+        int      parent    = -1;
+        int      heapIndex = k_NotInHeap;
+    };
+
+    struct HeapEntry
+    {
+        float f;
+        int   node;
+    };
+
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+
+    std::vector<NodeRecord> m_nodes;
+    std::vector<HeapEntry>  m_heap;
+    std::vector<int>        m_cellPath;
+    std::vector<int>        m_nodePath;
+    ClusterSearchScratch    m_clusterSearch[2];
+    uint32_t m_generation = 0;
+    uint32_t m_expanded   = 0;
+};
+
+} // namespace GX
@@ -0,0 +1,276 @@
+#include "pch.h"
+/// @file PathRequestQueue.cpp
+/// @brief Asynchronous, batched path requests for NavAgents
+
+#include "AI/PathRequestQueue.h"
+#include "AI/NavMesh.h"
+#include "Core/Logger.h"
+#include <chrono>
+
+namespace GX
+{
+
+PathRequestQueue::~PathRequestQueue()
+{
+    Shutdown();
+}
+
+// ============================================================================
+// Initialize / Shutdown
+// ============================================================================
+bool PathRequestQueue::Initialize(const NavMesh* navMesh, uint32_t workerCount)
+{
+    Shutdown();
+    if (!navMesh)
+    {
+        Logger::Error("PathRequestQueue::Initialize - navMesh is null");
+        return false;
+    }
+
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    m_navMesh = navMesh;
+    m_running = true;
+    m_paused  = false;
+    m_budgetUsed = 0;
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_workers.emplace_back(&PathRequestQueue::WorkerLoop, this);
+
+    Logger::Info("PathRequestQueue::Initialize - %u worker threads", workerCount);
+    return true;
+}
+
+void PathRequestQueue::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingQueue.clear();
+    m_jobsByKey.clear();
+    m_jobsByTicket.clear();
+    m_finished.clear();
+    m_results.clear();
+    m_navMesh = nullptr;
+}
+
+// ============================================================================
+// Request / Cancel / Poll
+// ============================================================================
+uint32_t PathRequestQueue::Request(const XMFLOAT3& start, const XMFLOAT3& end, uint32_t previousTicket)
+{
+    if (!m_navMesh || !m_navMesh->IsBuilt())
+        return 0;
+
+    int sx, sz, ex, ez;
+    m_navMesh->GetCellAt(start, sx, sz);
+    m_navMesh->GetCellAt(end, ex, ez);
+    const int width = m_navMesh->GetGridWidth();
+    const uint64_t key = (static_cast<uint64_t>(sz * width + sx) << 32) |
+                         static_cast<uint32_t>(ez * width + ex);
+
+    uint32_t ticket;
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (previousTicket != 0)
+            CancelLocked(previousTicket);
+
+        ticket = m_nextTicket++;
+        if (m_nextTicket == 0) m_nextTicket = 1;
+
+        // Identical requests (same cells) share one search, even if it already started
+        std::shared_ptr<Job>& job = m_jobsByKey[key];
+        if (!job)
+        {
+            job = std::make_shared<Job>();
+            job->key   = key;
+            job->start = start;
+            job->end   = end;
+            m_pendingQueue.push_back(job);
+            queued = true;
+        }
+        job->subscribers.push_back({ ticket, start, end });
+        m_jobsByTicket[ticket] = job;
+    }
+    if (queued)
+        m_cv.notify_one();
+    return ticket;
+}
+
+void PathRequestQueue::Cancel(uint32_t ticket)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CancelLocked(ticket);
+}
+
+void PathRequestQueue::CancelLocked(uint32_t ticket)
+{
+    m_results.erase(ticket);
+
+    auto it = m_jobsByTicket.find(ticket);
+    if (it == m_jobsByTicket.end())
+        return;
+
+    std::shared_ptr<Job> job = it->second;
+    m_jobsByTicket.erase(it);
+
+    auto& subs = job->subscribers;
+    subs.erase(std::remove_if(subs.begin(), subs.end(),
+        [ticket](const Subscriber& s) { return s.ticket == ticket; }), subs.end());
+
+    // Nobody wants this search any more: drop it if it has not started yet.
+    // A running search finishes and its result is discarded.
+    if (subs.empty() && !job->running)
+    {
+        auto pending = std::find(m_pendingQueue.begin(), m_pendingQueue.end(), job);
+        if (pending != m_pendingQueue.end())
+        {
+            m_pendingQueue.erase(pending);
+            m_jobsByKey.erase(job->key);
+        }
+    }
+}
+
+PathRequestStatus PathRequestQueue::Poll(uint32_t ticket, std::vector<XMFLOAT3>& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_results.find(ticket);
+    if (it != m_results.end())
+    {
+        const bool found = it->second.found;
+        if (found)
+            path = std::move(it->second.path);
+        m_results.erase(it);
+        return found ? PathRequestStatus::Succeeded : PathRequestStatus::Failed;
+    }
+    if (m_jobsByTicket.count(ticket))
+        return PathRequestStatus::Pending;
+    return PathRequestStatus::Unknown;
+}
+
+// ============================================================================
+// Update (main thread)
+// ============================================================================
+void PathRequestQueue::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Fan finished searches out to their subscribers. Results stay until
+        // polled or cancelled, however many frames the subscriber skips.
+        for (auto& job : m_finished)
+        {
+            for (const auto& sub : job->subscribers)
+            {
+                Result& result = m_results[sub.ticket];
+                result.found = job->found;
+                if (job->found)
+                {
+                    result.path = job->path;
+                    // Shared searches: match the endpoints' heights to this subscriber
+                    if (!result.path.empty())
+                    {
+                        result.path.front().y = sub.start.y;
+                        result.path.back().y  = sub.end.y;
+                    }
+                }
+                m_jobsByTicket.erase(sub.ticket);
+            }
+        }
+        m_finished.clear();
+
+        m_budgetUsed = 0;
+    }
+    m_cv.notify_all();
+}
+
+// ============================================================================
+// Pause / Resume
+// ============================================================================
+void PathRequestQueue::Pause()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_paused = true;
+    m_idleCv.wait(lock, [this]() { return m_activeSearches == 0; });
+}
+
+void PathRequestQueue::Resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_paused = false;
+    }
+    m_cv.notify_all();
+}
+
+uint32_t PathRequestQueue::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_pendingQueue.size());
+}
+
+// ============================================================================
+// WorkerLoop
+// ============================================================================
+void PathRequestQueue::WorkerLoop()
+{
+    using Clock = std::chrono::steady_clock;
+
+    while (true)
+    {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() {
+                if (!m_running) return true;
+                if (m_paused || m_pendingQueue.empty()) return false;
+                const int64_t budget = m_budgetMicroseconds.load();
+                return budget <= 0 || m_budgetUsed < budget;
+            });
+            if (!m_running)
+                return;
+
+            job = std::move(m_pendingQueue.front());
+            m_pendingQueue.pop_front();
+            job->running = true;
+            ++m_activeSearches;
+        }
+
+        // Search outside the lock; each worker thread has its own PathQueryContext
+        const auto t0 = Clock::now();
+        job->found = m_navMesh->FindPath(job->start, job->end, job->path);
+        if (!job->found)
+        {
+            // Path not found -- try the nearest walkable cell to the destination
+            XMFLOAT3 nearTarget;
+            if (m_navMesh->FindNearestWalkable(job->end, nearTarget))
+                job->found = m_navMesh->FindPath(job->start, nearTarget, job->path);
+        }
+        const int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_budgetUsed += elapsed;
+            job->running = false;
+            --m_activeSearches;
+            m_jobsByKey.erase(job->key);
+            if (!job->subscribers.empty())
+                m_finished.push_back(std::move(job));
+        }
+        m_idleCv.notify_all();
+    }
+}
+
+} // namespace GX
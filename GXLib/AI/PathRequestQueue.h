@@ -0,0 +1,140 @@
+#pragma once
+/// @file PathRequestQueue.h
+/// @brief Asynchronous, batched path requests for NavAgents
+///
+/// Moves NavMesh::FindPath off the caller's thread. Requests are queued,
+/// identical requests (same start and goal cell) are computed once, and
+/// worker threads process the queue within a per-frame time budget.
+/// Results become visible after the next Update() and are picked up with
+/// Poll() (NavAgent does this automatically in its Update).
+
+#include "pch.h"
+#include <deque>
+
+namespace GX
+{
+
+class NavMesh;
+
+/// @brief State of a queued path request
+enum class PathRequestStatus
+{
+    Pending,    ///< Queued or being computed
+    Succeeded,  ///< Path available (returned by Poll)
+    Failed,     ///< No path could be found
+    Unknown     ///< Ticket was cancelled, already polled, dropped by Shutdown(), or never issued
+};
+
+/// @brief Worker-thread path request queue
+///
+/// The NavMesh must not be modified while workers are searching:
+/// call Pause() before editing cells and Resume() afterwards.
+class PathRequestQueue
+{
+public:
+    PathRequestQueue() = default;
+    ~PathRequestQueue();
+
+    PathRequestQueue(const PathRequestQueue&) = delete;
+    PathRequestQueue& operator=(const PathRequestQueue&) = delete;
+
+    /// @brief Start the worker threads
+    /// @param navMesh     NavMesh to search (must outlive the queue)
+    /// @param workerCount Number of worker threads (0 = hardware threads / 2)
+    /// @return true on success
+    bool Initialize(const NavMesh* navMesh, uint32_t workerCount = 0);
+
+    /// @brief Stop the workers and drop every request and result
+    void Shutdown();
+
+    /// @brief Queue a path request
+    ///
+    /// If no path reaches the target, the path to the nearest walkable cell
+    /// is returned instead (same behaviour as NavAgent's synchronous search).
+    /// @param start          Start world position
+    /// @param end            Goal world position
+    /// @param previousTicket Ticket superseded by this request (cancelled), or 0
+    /// @return Ticket used with Poll() / Cancel() (0 on failure)
+    uint32_t Request(const XMFLOAT3& start, const XMFLOAT3& end, uint32_t previousTicket = 0);
+
+    /// @brief Cancel a request; its result is discarded even if already computed
+    void Cancel(uint32_t ticket);
+
+    /// @brief Take the result of a request
+    /// @param ticket Ticket returned by Request()
+    /// @param path   Output: waypoints (only written on Succeeded)
+    /// @return Request status. Succeeded/Failed consume the ticket.
+    PathRequestStatus Poll(uint32_t ticket, std::vector<XMFLOAT3>& path);
+
+    /// @brief Publish results finished since the last call and start a new frame budget
+    ///
+    /// Call once per frame on the main thread, before updating agents.
+    /// Published results are kept until polled or cancelled, so callers that
+    /// abandon a ticket must Cancel() it.
+    void Update();
+
+    /// @brief Wait for in-flight searches to finish and stop starting new ones
+    void Pause();
+
+    /// @brief Resume processing after Pause()
+    void Resume();
+
+    /// @brief Set the total worker search time allowed per frame
+    /// @param milliseconds Budget in ms (0 = unlimited)
+    void SetFrameBudget(float milliseconds) { m_budgetMicroseconds.store(static_cast<int64_t>(milliseconds * 1000.0f)); }
+
+    /// @brief Number of requests waiting for a worker
+    uint32_t GetPendingCount() const;
+
+private:
+    /// One agent waiting for a job's result
+    struct Subscriber
+    {
+        uint32_t ticket;
+        XMFLOAT3 start;
+        XMFLOAT3 end;
+    };
+
+    /// A unique (start cell, goal cell) search shared by all its subscribers
+    struct Job
+    {
+        uint64_t key = 0;
+        XMFLOAT3 start = {};
+        XMFLOAT3 end = {};
+        std::vector<Subscriber> subscribers;
+        std::vector<XMFLOAT3> path;
+        bool found = false;
+        bool running = false;
+    };
+
+    /// Finished result waiting to be polled
+    struct Result
+    {
+        std::vector<XMFLOAT3> path;
+        bool found = false;
+    };
+
+    void WorkerLoop();
+    void CancelLocked(uint32_t ticket);
+
+    const NavMesh* m_navMesh = nullptr;
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idleCv;
+    bool m_running = false;
+    bool m_paused  = false;
+    uint32_t m_activeSearches = 0;
+    uint32_t m_nextTicket = 1;
+
+    std::atomic<int64_t> m_budgetMicroseconds{ 2000 };
+    int64_t m_budgetUsed = 0;   ///< Worker time spent this frame (us)
+
+    std::deque<std::shared_ptr<Job>> m_pendingQueue;
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> m_jobsByKey;     ///< Pending + running jobs
+    std::unordered_map<uint32_t, std::shared_ptr<Job>> m_jobsByTicket;
+    std::vector<std::shared_ptr<Job>> m_finished;                       ///< Done, not yet published
+    std::unordered_map<uint32_t, Result> m_results;                     ///< Published, not yet polled
+};
+
+} // namespace GX
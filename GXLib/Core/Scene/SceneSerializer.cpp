@@ -4,6 +4,7 @@
 
 #include "Core/Scene/SceneSerializer.h"
 #include "Core/Logger.h"
+#include "IO/FileSystem.h"
 #include "ThirdParty/json.hpp"
 
 using json = nlohmann::json;
@@ -217,7 +218,7 @@ bool SceneSerializer::SaveToJson(const Scene& scene, const std::string& filePath
     return true;
 }
 
-bool SceneSerializer::FromJsonString(Scene& scene, const std::string& jsonStr,
+bool SceneSerializer::FromJsonString(Scene& scene, std::string_view jsonStr,
                                       ModelLoadCallback modelLoader)
 {
     json root;
@@ -275,6 +276,12 @@ bool SceneSerializer::FromJsonString(Scene& scene, const std::string& jsonStr,
 bool SceneSerializer::LoadFromJson(Scene& scene, const std::string& filePath,
                                     ModelLoadCallback modelLoader)
 {
+    // VFS経由ならマップ済みメモリやアーカイブエントリをコピーせずに解析できる
+    auto fileView = FileSystem::Instance().ReadFileView(filePath);
+    if (fileView.IsValid())
+        return FromJsonString(scene, fileView.AsStringView(), modelLoader);
+
+    // 直接ファイルI/Oにフォールバック
     std::ifstream file(filePath);
     if (!file.is_open())
     {
@@ -18,7 +18,7 @@ public:
     /// @brief シーンをJSONファイルに保存する
     static bool SaveToJson(const Scene& scene, const std::string& filePath);
 
-    /// @brief JSONファイルからシーンを読み込む
+    /// @brief JSONファイルからシーンを読み込む (VFS対応)
     static bool LoadFromJson(Scene& scene, const std::string& filePath,
                               ModelLoadCallback modelLoader = nullptr);
 
@@ -26,7 +26,7 @@ public:
     static std::string ToJsonString(const Scene& scene);
 
     /// @brief JSON文字列からシーンを復元する
-    static bool FromJsonString(Scene& scene, const std::string& json,
+    static bool FromJsonString(Scene& scene, std::string_view json,
                                 ModelLoadCallback modelLoader = nullptr);
 };
 
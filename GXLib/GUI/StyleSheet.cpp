@@ -120,7 +120,7 @@ StyleSelector StyleSelector::Parse(const std::string& str)
 // トークナイザ
 // ============================================================================
 
-std::vector<StyleSheet::Token> StyleSheet::Tokenize(const std::string& source)
+std::vector<StyleSheet::Token> StyleSheet::Tokenize(std::string_view source)
 {
     std::vector<Token> tokens;
     size_t i = 0;
@@ -170,7 +170,7 @@ std::vector<StyleSheet::Token> StyleSheet::Tokenize(const std::string& source)
             size_t start = i;
             while (i < len && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_'))
                 ++i;
-            tokens.push_back({ TokenType::Hash, source.substr(start, i - start) });
+            tokens.push_back({ TokenType::Hash, std::string(source.substr(start, i - start)) });
             continue;
         }
 
@@ -182,7 +182,7 @@ std::vector<StyleSheet::Token> StyleSheet::Tokenize(const std::string& source)
             size_t start = i;
             while (i < len && source[i] != quote)
                 ++i;
-            tokens.push_back({ TokenType::String, source.substr(start, i - start) });
+            tokens.push_back({ TokenType::String, std::string(source.substr(start, i - start)) });
             if (i < len) ++i;
             continue;
         }
@@ -195,7 +195,7 @@ std::vector<StyleSheet::Token> StyleSheet::Tokenize(const std::string& source)
             if (c == '-') ++i;
             while (i < len && (std::isdigit(static_cast<unsigned char>(source[i])) || source[i] == '.'))
                 ++i;
-            std::string numStr = source.substr(start, i - start);
+            std::string numStr(source.substr(start, i - start));
 
             // % の場合
             if (i < len && source[i] == '%')
@@ -216,7 +216,7 @@ std::vector<StyleSheet::Token> StyleSheet::Tokenize(const std::string& source)
             size_t start = i;
             while (i < len && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_' || source[i] == '-'))
                 ++i;
-            tokens.push_back({ TokenType::Ident, source.substr(start, i - start) });
+            tokens.push_back({ TokenType::Ident, std::string(source.substr(start, i - start)) });
             continue;
         }
 
@@ -344,8 +344,8 @@ std::vector<StyleProperty> StyleSheet::ParsePropertyBlock(const std::vector<Toke
 
 bool StyleSheet::LoadFromFile(const std::string& path)
 {
-    auto fileData = GX::FileSystem::Instance().ReadFile(path);
-    if (!fileData.IsValid())
+    auto fileView = GX::FileSystem::Instance().ReadFileView(path);
+    if (!fileView.IsValid())
     {
         // 直接ファイルI/Oにフォールバック
         std::ifstream file(path);
@@ -354,10 +354,10 @@ bool StyleSheet::LoadFromFile(const std::string& path)
                             std::istreambuf_iterator<char>());
         return LoadFromString(source);
     }
-    return LoadFromString(fileData.AsString());
+    return LoadFromString(fileView.AsStringView());
 }
 
-bool StyleSheet::LoadFromString(const std::string& source)
+bool StyleSheet::LoadFromString(std::string_view source)
 {
     auto tokens = Tokenize(source);
     ParseTokens(tokens);
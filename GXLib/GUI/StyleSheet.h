@@ -89,7 +89,7 @@ public:
     /// @brief CSS文字列からスタイルルールを読み込む
     /// @param source CSS形式の文字列
     /// @return 成功なら true
-    bool LoadFromString(const std::string& source);
+    bool LoadFromString(std::string_view source);
 
     /// @brief 単一ウィジェットにマッチするルールを適用する
     /// @param widget 適用対象のウィジェット
@@ -139,7 +139,7 @@ private:
         std::string text;
     };
 
-    static std::vector<Token> Tokenize(const std::string& source);
+    static std::vector<Token> Tokenize(std::string_view source);
 
     // --- パーサー ---
     void ParseTokens(const std::vector<Token>& tokens);
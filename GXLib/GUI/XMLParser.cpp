@@ -11,8 +11,8 @@ namespace GX { namespace GUI {
 
 bool XMLDocument::LoadFromFile(const std::string& path)
 {
-    auto fileData = GX::FileSystem::Instance().ReadFile(path);
-    if (!fileData.IsValid())
+    auto fileView = GX::FileSystem::Instance().ReadFileView(path);
+    if (!fileView.IsValid())
     {
         // 直接ファイルI/Oにフォールバック
         std::ifstream file(path, std::ios::binary);
@@ -25,14 +25,14 @@ bool XMLDocument::LoadFromFile(const std::string& path)
                             std::istreambuf_iterator<char>());
         return LoadFromString(source);
     }
-    return LoadFromString(fileData.AsString());
+    return LoadFromString(fileView.AsStringView());
 }
 
 // ============================================================================
 // LoadFromString（文字列読み込み）
 // ============================================================================
 
-bool XMLDocument::LoadFromString(const std::string& source)
+bool XMLDocument::LoadFromString(std::string_view source)
 {
     ParseContext ctx{ source, 0 };
 
@@ -191,7 +191,7 @@ std::string XMLDocument::ParseTagName(ParseContext& ctx)
     {
         ++ctx.pos;
     }
-    return ctx.source.substr(start, ctx.pos - start);
+    return std::string(ctx.source.substr(start, ctx.pos - start));
 }
 
 // ============================================================================
@@ -247,7 +247,7 @@ std::string XMLDocument::ParseAttributeValue(ParseContext& ctx)
         size_t start = ctx.pos;
         while (ctx.pos < ctx.source.size() && ctx.source[ctx.pos] != quote)
             ++ctx.pos;
-        std::string value = ctx.source.substr(start, ctx.pos - start);
+        std::string value(ctx.source.substr(start, ctx.pos - start));
         if (ctx.pos < ctx.source.size())
             ++ctx.pos; // skip closing quote
         return value;
@@ -261,7 +261,7 @@ std::string XMLDocument::ParseAttributeValue(ParseContext& ctx)
     {
         ++ctx.pos;
     }
-    return ctx.source.substr(start, ctx.pos - start);
+    return std::string(ctx.source.substr(start, ctx.pos - start));
 }
 
 // ============================================================================
@@ -274,7 +274,7 @@ std::string XMLDocument::ParseTextContent(ParseContext& ctx)
     while (ctx.pos < ctx.source.size() && ctx.source[ctx.pos] != '<')
         ++ctx.pos;
 
-    std::string text = ctx.source.substr(start, ctx.pos - start);
+    std::string text(ctx.source.substr(start, ctx.pos - start));
 
     // 前後の空白をトリム
     size_t begin = text.find_first_not_of(" \t\r\n");
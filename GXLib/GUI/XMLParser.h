@@ -52,7 +52,7 @@ public:
     /// @brief XML文字列からDOMツリーを読み込む
     /// @param source XML形式の文字列
     /// @return 成功なら true
-    bool LoadFromString(const std::string& source);
+    bool LoadFromString(std::string_view source);
 
     /// @brief ルートノードを取得する
     /// @return ルートXMLノード。読み込み前は nullptr
@@ -61,7 +61,7 @@ public:
 private:
     struct ParseContext
     {
-        const std::string& source;
+        std::string_view source;
         size_t pos = 0;
     };
 
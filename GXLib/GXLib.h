@@ -12,3 +12,4 @@
 #include "Physics/PhysicsWorld3D.h"
 #include "Physics/RigidBody3D.h"
 #include "Physics/MeshCollider.h"
+#include "Physics/CharacterController3D.h"
@@ -8,6 +8,7 @@
 #include "Graphics/3D/Skeleton.h"
 #include "Graphics/3D/AnimationClip.h"
 #include "Core/Logger.h"
+#include "IO/FileSystem.h"
 
 #include <model_loader.h>
 #include <filesystem>
@@ -30,6 +31,15 @@ static std::wstring Utf8ToWide(const std::string& str)
     return result;
 }
 
+static std::string WideToUtf8(const std::wstring& str)
+{
+    if (str.empty()) return "";
+    int size = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), -1, nullptr, 0, nullptr, nullptr);
+    std::string result(size - 1, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, str.c_str(), -1, result.data(), size, nullptr, nullptr);
+    return result;
+}
+
 static std::wstring GetDirectory(const std::wstring& filePath)
 {
     size_t pos = filePath.find_last_of(L"/\\");
@@ -42,7 +52,13 @@ std::unique_ptr<Model> GxmdModelLoader::LoadFromGxmd(const std::wstring& filePat
                                                        TextureManager& texManager,
                                                        MaterialManager& matManager)
 {
-    auto loaded = gxloader::LoadGxmdW(filePath);
+    // VFS (アーカイブ・メモリマップ) から読めればコピーせずにそのまま解析する
+    std::unique_ptr<gxloader::LoadedModel> loaded;
+    auto fileView = FileSystem::Instance().ReadFileView(WideToUtf8(filePath));
+    if (fileView.IsValid())
+        loaded = gxloader::LoadGxmdFromMemory(fileView.Data(), fileView.Size());
+    else
+        loaded = gxloader::LoadGxmdW(filePath);
     if (!loaded)
         return nullptr;
 
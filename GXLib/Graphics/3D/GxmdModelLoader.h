@@ -12,7 +12,8 @@ namespace GX
 
 /// @brief GXMDバイナリ形式(.gxmd)のモデルローダー
 /// gxconv で変換した .gxmd ファイルを読み込み、GX::Model に変換する。
-/// gxloader::LoadGxmdW でバイナリデータを読み込み、頂点レイアウト互換を利用してゼロコピーに近い形で構築する
+/// VFS (FileSystem::ReadFileView) で読めればマップ済みメモリから直接、読めなければ gxloader::LoadGxmdW で読み込み、
+/// 頂点レイアウト互換を利用してゼロコピーに近い形で構築する
 class GxmdModelLoader
 {
 public:
@@ -3,6 +3,10 @@
 #include "IO/Crypto.h"
 #include "Core/Logger.h"
 #include "ThirdParty/lz4.h"
+#include "lz4hc.h"
+#include "zstd.h"
+#include "gxpak.h"
+#include <filesystem>
 
 namespace GX {
 
@@ -11,6 +15,144 @@ static constexpr uint8_t k_Magic[8] = { 'G','X','A','R','C',0,0,0 };
 static constexpr uint32_t k_FlagEncrypted  = 0x01;
 static constexpr uint32_t k_FlagCompressed = 0x02;
 static constexpr uint8_t  k_EntryFlagCompressed = 0x01;
+static constexpr uint8_t  k_EntryFlagChunked    = 0x02;
+
+// TOCヘッダのバージョン (旧形式は予約フィールド=0または1で、サイズが32bit・圧縮はLZ4のみ。
+// 2はサイズが64bitで、各エントリにコーデック (gxfmt::GxpakCodec)・パスハッシュ・内容ハッシュを持ち、
+// チャンク形式のエントリを含み得る)
+static constexpr uint32_t k_ArchiveVersion = 2;
+
+// チャンク形式エントリのデータ先頭:
+//   [chunkSize u32][chunkCount u32][チャンク列内オフセット u64 x (chunkCount + 1)][チャンク列]
+// 各チャンクはエントリのコーデックで独立に圧縮したブロック。圧縮で小さくならなかったチャンクはそのまま格納する
+// (格納サイズ == 展開後サイズ で判別)。
+static constexpr size_t k_ChunkHeaderSize = 8;
+
+// この数以上のチャンクを展開する場合はスレッドに分担させる
+static constexpr uint32_t k_ParallelChunkThreshold = 4;
+static constexpr uint32_t k_MaxChunkThreads = 8;
+
+namespace {
+
+/// スレッドごとのZstd圧縮コンテキスト (ワーカーがブロックごとに作り直さない)
+ZSTD_CCtx* ThreadCCtx()
+{
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    return cctx.get();
+}
+
+/// スレッドごとのZstd展開コンテキスト (チャンクの並列展開でも共有しない)
+ZSTD_DCtx* ThreadDCtx()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    return dctx.get();
+}
+
+/// .gxarcの圧縮エントリで使えるコーデックか (共有辞書を持たないため辞書付きは使えない)
+bool IsArchiveCodec(gxfmt::GxpakCodec codec)
+{
+    return codec == gxfmt::GxpakCodec::LZ4 || codec == gxfmt::GxpakCodec::LZ4HC || codec == gxfmt::GxpakCodec::Zstd;
+}
+
+/// 圧縮結果の最大サイズ
+size_t CompressBound(gxfmt::GxpakCodec codec, size_t size)
+{
+    if (codec == gxfmt::GxpakCodec::Zstd)
+        return ZSTD_compressBound(size);
+    return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+}
+
+/// srcを圧縮してdstへ書き込む (dstはCompressBound()以上)
+/// @return 圧縮後のサイズ。失敗した・小さくならなかった場合は0
+size_t EncodeBlock(const ArchiveCodec& codec, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+{
+    size_t size = 0;
+    if (codec.codec == gxfmt::GxpakCodec::Zstd)
+    {
+        const size_t result = ZSTD_compressCCtx(ThreadCCtx(), dst, dstCapacity, src, srcSize,
+                                                codec.level > 0 ? codec.level : ZSTD_CLEVEL_DEFAULT);
+        size = ZSTD_isError(result) ? 0 : result;
+    }
+    else
+    {
+        const int result = codec.codec == gxfmt::GxpakCodec::LZ4HC
+            ? LZ4_compress_HC(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                              static_cast<int>(srcSize), static_cast<int>(dstCapacity),
+                              codec.level > 0 ? codec.level : LZ4HC_CLEVEL_DEFAULT)
+            : LZ4_compress_default(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                                   static_cast<int>(srcSize), static_cast<int>(dstCapacity));
+        size = result > 0 ? static_cast<size_t>(result) : 0;
+    }
+    return size < srcSize ? size : 0;
+}
+
+/// 圧縮ブロックを展開する (LZ4HCの出力はLZ4ブロックなのでLZ4で展開する)
+bool DecodeBlock(gxfmt::GxpakCodec codec, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    if (codec == gxfmt::GxpakCodec::Zstd)
+        return ZSTD_decompressDCtx(ThreadDCtx(), dst, dstSize, src, srcSize) == dstSize;
+    return LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                               static_cast<int>(srcSize), static_cast<int>(dstSize)) == static_cast<int>(dstSize);
+}
+
+/// マップ上のチャンク索引 (アライメントされていないためmemcpyで読む)
+struct ChunkLayout
+{
+    uint32_t chunkSize = 0;
+    uint32_t chunkCount = 0;
+    const uint8_t* table = nullptr;   ///< オフセット表
+    const uint8_t* data = nullptr;    ///< チャンク列の先頭
+
+    uint64_t Offset(uint32_t index) const
+    {
+        uint64_t value;
+        memcpy(&value, table + static_cast<size_t>(index) * 8, 8);
+        return value;
+    }
+};
+
+ChunkLayout GetChunkLayout(const uint8_t* entryData)
+{
+    ChunkLayout layout;
+    memcpy(&layout.chunkSize, entryData, 4);
+    memcpy(&layout.chunkCount, entryData + 4, 4);
+    layout.table = entryData + k_ChunkHeaderSize;
+    layout.data = layout.table + (static_cast<size_t>(layout.chunkCount) + 1) * 8;
+    return layout;
+}
+
+/// チャンク索引がエントリの格納範囲に収まり、展開後サイズと矛盾しないか検証する
+bool ValidateChunks(const uint8_t* entryData, const ArchiveEntry& entry)
+{
+    if (entry.compressedSize < k_ChunkHeaderSize)
+        return false;
+
+    ChunkLayout layout = GetChunkLayout(entryData);
+    if (layout.chunkSize == 0 || layout.chunkSize > k_ArchiveMaxChunkSize)
+        return false;
+    const uint64_t expectedCount = (entry.originalSize + layout.chunkSize - 1) / layout.chunkSize;
+    if (layout.chunkCount != expectedCount)
+        return false;
+
+    const uint64_t indexSize = k_ChunkHeaderSize + (static_cast<uint64_t>(layout.chunkCount) + 1) * 8;
+    if (indexSize > entry.compressedSize)
+        return false;
+
+    const uint64_t dataSize = entry.compressedSize - indexSize;
+    if (layout.Offset(0) != 0)
+        return false;
+    for (uint32_t i = 0; i < layout.chunkCount; ++i)
+    {
+        const uint64_t begin = layout.Offset(i);
+        const uint64_t end = layout.Offset(i + 1);
+        if (end < begin || end > dataSize ||
+            end - begin > CompressBound(entry.codec, layout.chunkSize))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
 
 // ============================================================================
 // アーカイブ読み取り (Reader)
@@ -19,32 +161,36 @@ static constexpr uint8_t  k_EntryFlagCompressed = 0x01;
 bool Archive::Open(const std::string& filePath, const std::string& password)
 {
     Close();
-    m_filePath = filePath;
 
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open())
+    // ファイル全体を一度だけマップする (以降のReadはマップから直接読む)
+    auto file = gxloader::MappedFile::Open(filePath);
+    if (!file)
     {
         GX_LOG_ERROR("Archive::Open: Failed to open: %s", filePath.c_str());
         return false;
     }
 
     // マジックを読み込む (形式識別)
-    uint8_t magic[8];
-    file.read(reinterpret_cast<char*>(magic), 8);
-    if (memcmp(magic, k_Magic, 8) != 0)
+    if (file->Size() < 8 + 16 || memcmp(file->Data(), k_Magic, 8) != 0)
     {
         GX_LOG_ERROR("Archive::Open: Invalid magic in: %s", filePath.c_str());
         return false;
     }
 
     // TOCヘッダを読む (目次の情報)
-    uint32_t entryCount, tocSize, flags, reserved;
-    file.read(reinterpret_cast<char*>(&entryCount), 4);
-    file.read(reinterpret_cast<char*>(&tocSize), 4);
-    file.read(reinterpret_cast<char*>(&flags), 4);
-    file.read(reinterpret_cast<char*>(&reserved), 4);
+    uint32_t entryCount, tocSize, flags, version;
+    memcpy(&entryCount, file->Data() + 8, 4);
+    memcpy(&tocSize, file->Data() + 12, 4);
+    memcpy(&flags, file->Data() + 16, 4);
+    memcpy(&version, file->Data() + 20, 4);
 
-    if (tocSize > 256 * 1024 * 1024)
+    if (version > k_ArchiveVersion)
+    {
+        GX_LOG_ERROR("Archive::Open: Unsupported version %u in: %s", version, filePath.c_str());
+        return false;
+    }
+
+    if (tocSize > 256 * 1024 * 1024 || tocSize > file->Size() - (8 + 16))
     {
         GX_LOG_ERROR("Archive: TOC too large (%u bytes)", tocSize);
         return false;
@@ -63,8 +209,7 @@ bool Archive::Open(const std::string& filePath, const std::string& password)
     }
 
     // TOCデータを読む（各ファイルのパス・オフセット・サイズが格納されている）
-    std::vector<uint8_t> tocData(tocSize);
-    file.read(reinterpret_cast<char*>(tocData.data()), tocSize);
+    std::vector<uint8_t> tocData(file->Data() + 8 + 16, file->Data() + 8 + 16 + tocSize);
 
     // 暗号化されていればTOCを復号する
     if (m_encrypted)
@@ -87,7 +232,12 @@ bool Archive::Open(const std::string& filePath, const std::string& password)
         tocData = std::move(decrypted);
     }
 
+    // データ開始位置 = magic(8) + TOCヘッダ(16) + TOCデータ(tocSize)
+    m_dataOffset = 8 + 16 + tocSize;
+    const uint64_t dataSize = file->Size() - m_dataOffset;
+
     // TOCエントリを解析する
+    const bool legacy = version < k_ArchiveVersion; // バージョン導入前の形式
     size_t pos = 0;
     m_entries.reserve(entryCount);
     for (uint32_t i = 0; i < entryCount; ++i)
@@ -102,17 +252,59 @@ bool Archive::Open(const std::string& filePath, const std::string& password)
         entry.path.assign(reinterpret_cast<const char*>(&tocData[pos]), pathLen);
         pos += pathLen;
 
-        if (pos + 8 + 4 + 4 + 1 > tocData.size()) break;
+        // 旧形式はサイズが32bit
+        const size_t sizeBytes = legacy ? 4 : 8;
+        if (pos + 8 + sizeBytes * 2 + 1 > tocData.size()) break;
         entry.offset = *reinterpret_cast<const uint64_t*>(&tocData[pos]); pos += 8;
-        entry.compressedSize = *reinterpret_cast<const uint32_t*>(&tocData[pos]); pos += 4;
-        entry.originalSize = *reinterpret_cast<const uint32_t*>(&tocData[pos]); pos += 4;
+        entry.compressedSize = 0;
+        entry.originalSize = 0;
+        memcpy(&entry.compressedSize, &tocData[pos], sizeBytes); pos += sizeBytes;
+        memcpy(&entry.originalSize, &tocData[pos], sizeBytes); pos += sizeBytes;
         entry.flags = tocData[pos]; pos += 1;
 
+        if (legacy)
+        {
+            // 旧形式にチャンク形式はなく、圧縮エントリはLZ4
+            if (entry.flags & k_EntryFlagChunked)
+            {
+                GX_LOG_ERROR("Archive::Open: Chunked entry in legacy archive: %s", entry.path.c_str());
+                break;
+            }
+            entry.codec = (entry.flags & k_EntryFlagCompressed) ? gxfmt::GxpakCodec::LZ4 : gxfmt::GxpakCodec::None;
+            entry.pathHash = HashPath(entry.path);
+            entry.contentHash = 0;
+        }
+        else
+        {
+            if (pos + 1 + 8 + 8 > tocData.size()) break;
+            entry.codec = static_cast<gxfmt::GxpakCodec>(tocData[pos]); pos += 1;
+            memcpy(&entry.pathHash, &tocData[pos], 8); pos += 8;
+            memcpy(&entry.contentHash, &tocData[pos], 8); pos += 8;
+        }
+
+        // 読み込み時に範囲チェックを省けるよう、ここでデータ範囲を検証する
+        if (entry.offset > dataSize || entry.compressedSize > dataSize - entry.offset)
+        {
+            GX_LOG_ERROR("Archive::Open: Entry out of range: %s", entry.path.c_str());
+            break;
+        }
+        if ((entry.flags & (k_EntryFlagCompressed | k_EntryFlagChunked)) && !IsArchiveCodec(entry.codec))
+        {
+            GX_LOG_ERROR("Archive::Open: Unsupported codec %u: %s",
+                static_cast<uint32_t>(entry.codec), entry.path.c_str());
+            break;
+        }
+        if ((entry.flags & k_EntryFlagChunked) &&
+            !ValidateChunks(file->Data() + m_dataOffset + entry.offset, entry))
+        {
+            GX_LOG_ERROR("Archive::Open: Invalid chunk index: %s", entry.path.c_str());
+            break;
+        }
+
         m_entries.push_back(std::move(entry));
     }
-
-    // データ開始位置 = magic(8) + TOCヘッダ(16) + TOCデータ(tocSize)
-    m_dataOffset = 8 + 16 + tocSize;
+    m_file = std::move(file);
+    BuildIndex();
 
     GX_LOG_INFO("Archive::Open: Loaded %s (%u entries, encrypted=%s)",
         filePath.c_str(), entryCount, m_encrypted ? "true" : "false");
@@ -122,72 +314,312 @@ bool Archive::Open(const std::string& filePath, const std::string& password)
 void Archive::Close()
 {
     m_entries.clear();
-    m_filePath.clear();
+    m_slots.clear();
+    m_file.reset();
     m_encrypted = false;
     m_dataOffset = 0;
     m_key = {};
 }
 
-bool Archive::Contains(const std::string& path) const
+std::span<const uint8_t> Archive::GetStoredData(const ArchiveEntry& entry) const
+{
+    if (!m_file) return {};
+    return { m_file->Data() + m_dataOffset + entry.offset, static_cast<size_t>(entry.compressedSize) };
+}
+
+uint64_t Archive::HashPath(const std::string& path)
+{
+    return gxfmt::HashPath(path.data(), path.size());
+}
+
+void Archive::BuildIndex()
 {
-    for (const auto& e : m_entries)
+    // 負荷率50%以下のテーブルを線形探索で引く
+    size_t capacity = 16;
+    while (capacity < m_entries.size() * 2) capacity <<= 1;
+    m_slots.assign(capacity, Slot{ 0, k_EmptySlot });
+
+    const size_t mask = capacity - 1;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_entries.size()); ++i)
     {
-        if (e.path == path)
-            return true;
+        const uint64_t hash = m_entries[i].pathHash;
+        size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+        while (m_slots[slot].index != k_EmptySlot)
+            slot = (slot + 1) & mask;
+        m_slots[slot] = { hash, i };
     }
-    return false;
+}
+
+const ArchiveEntry* Archive::Find(uint64_t pathHash) const
+{
+    if (m_slots.empty()) return nullptr;
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(pathHash ^ (pathHash >> 32)) & mask;
+         m_slots[slot].index != k_EmptySlot; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot].hash == pathHash)
+            return &m_entries[m_slots[slot].index];
+    }
+    return nullptr;
+}
+
+const ArchiveEntry* Archive::Find(const std::string& path) const
+{
+    if (m_slots.empty()) return nullptr;
+
+    // ハッシュ一致後にパスも照合する (旧形式ではハッシュ衝突があり得る)
+    const uint64_t hash = HashPath(path);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+         m_slots[slot].index != k_EmptySlot; slot = (slot + 1) & mask)
+    {
+        const ArchiveEntry& entry = m_entries[m_slots[slot].index];
+        if (m_slots[slot].hash == hash && entry.path == path)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool Archive::Contains(const std::string& path) const
+{
+    return Find(path) != nullptr;
+}
+
+bool Archive::Contains(uint64_t pathHash) const
+{
+    return Find(pathHash) != nullptr;
 }
 
 FileData Archive::Read(const std::string& path) const
 {
-    const ArchiveEntry* found = nullptr;
-    for (const auto& e : m_entries)
+    return ReadEntry(Find(path));
+}
+
+FileData Archive::Read(uint64_t pathHash) const
+{
+    return ReadEntry(Find(pathHash));
+}
+
+gxloader::MappedView Archive::ReadView(const std::string& path) const
+{
+    return ReadEntryView(Find(path));
+}
+
+gxloader::MappedView Archive::ReadView(uint64_t pathHash) const
+{
+    return ReadEntryView(Find(pathHash));
+}
+
+bool Archive::ReadInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    const ArchiveEntry* entry = Find(path);
+    return entry && ReadEntryInto(*entry, destination);
+}
+
+bool Archive::ReadInto(uint64_t pathHash, std::span<uint8_t> destination) const
+{
+    const ArchiveEntry* entry = Find(pathHash);
+    return entry && ReadEntryInto(*entry, destination);
+}
+
+void Archive::Prefetch(std::span<const ArchiveEntry* const> entries) const
+{
+    if (!m_file)
+        return;
+
+    std::vector<gxloader::MappedRange> ranges;
+    ranges.reserve(entries.size());
+    for (const ArchiveEntry* entry : entries)
+    {
+        if (entry)
+            ranges.push_back({ m_dataOffset + entry->offset, entry->compressedSize });
+    }
+    m_file->Prefetch(std::move(ranges));
+}
+
+FileData Archive::ReadEntry(const ArchiveEntry* entry) const
+{
+    FileData result;
+    if (!entry)
+        return result;
+
+    result.data.resize(entry->originalSize);
+    if (!ReadEntryInto(*entry, result.data))
+        result.data.clear();
+    return result;
+}
+
+gxloader::MappedView Archive::ReadEntryView(const ArchiveEntry* entry) const
+{
+    if (!entry || (entry->flags & (k_EntryFlagCompressed | k_EntryFlagChunked)))
+        return {};
+
+    gxloader::MappedView view;
+    view.data = m_file->Data() + m_dataOffset + entry->offset;
+    view.size = entry->originalSize;
+    view.owner = m_file;
+    return view;
+}
+
+bool Archive::ReadEntryInto(const ArchiveEntry& entry, std::span<uint8_t> destination) const
+{
+    if (destination.size() < entry.originalSize)
+        return false;
+
+    if (entry.flags & k_EntryFlagChunked)
+        return entry.originalSize == 0 || ReadChunks(entry, 0, destination.first(static_cast<size_t>(entry.originalSize)));
+
+    const uint8_t* src = m_file->Data() + m_dataOffset + entry.offset;
+    if (entry.flags & k_EntryFlagCompressed)
     {
-        if (e.path == path)
+        // マップから書き込み先へ直接伸長する
+        if (!DecodeBlock(entry.codec, src, static_cast<size_t>(entry.compressedSize),
+                         destination.data(), static_cast<size_t>(entry.originalSize)))
         {
-            found = &e;
-            break;
+            GX_LOG_ERROR("Archive::Read: Decompression failed for: %s", entry.path.c_str());
+            return false;
         }
+        return true;
     }
 
-    if (!found)
-        return FileData{};
+    // 非圧縮データ
+    if (entry.compressedSize != entry.originalSize)
+        return false;
+    if (entry.originalSize > 0)
+        memcpy(destination.data(), src, static_cast<size_t>(entry.originalSize));
+    return true;
+}
 
-    std::ifstream file(m_filePath, std::ios::binary);
-    if (!file.is_open())
-        return FileData{};
+FileData Archive::ReadRange(const std::string& path, uint64_t offset, size_t length) const
+{
+    return ReadEntryRange(Find(path), offset, length);
+}
 
-    // ファイルデータ位置にシーク
-    file.seekg(m_dataOffset + found->offset);
+FileData Archive::ReadRange(uint64_t pathHash, uint64_t offset, size_t length) const
+{
+    return ReadEntryRange(Find(pathHash), offset, length);
+}
 
-    std::vector<uint8_t> compressed(found->compressedSize);
-    file.read(reinterpret_cast<char*>(compressed.data()), found->compressedSize);
+size_t Archive::ReadRangeInto(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const
+{
+    const ArchiveEntry* entry = Find(path);
+    return entry ? ReadEntryRange(*entry, offset, destination) : 0;
+}
 
+FileData Archive::ReadEntryRange(const ArchiveEntry* entry, uint64_t offset, size_t length) const
+{
     FileData result;
+    if (!entry || offset >= entry->originalSize)
+        return result;
+
+    result.data.resize(static_cast<size_t>((std::min<uint64_t>)(length, entry->originalSize - offset)));
+    if (ReadEntryRange(*entry, offset, result.data) != result.data.size())
+        result.data.clear();
+    return result;
+}
+
+size_t Archive::ReadEntryRange(const ArchiveEntry& entry, uint64_t offset, std::span<uint8_t> destination) const
+{
+    if (offset >= entry.originalSize || destination.empty())
+        return 0;
 
-    if (found->flags & k_EntryFlagCompressed)
+    const size_t length = static_cast<size_t>((std::min<uint64_t>)(destination.size(), entry.originalSize - offset));
+    destination = destination.first(length);
+
+    if (entry.flags & k_EntryFlagChunked)
+        return ReadChunks(entry, offset, destination) ? length : 0;
+
+    if (!(entry.flags & k_EntryFlagCompressed))
     {
-        // LZ4で伸長する
-        result.data.resize(found->originalSize);
-        int decompressed = LZ4_decompress_safe(
-            reinterpret_cast<const char*>(compressed.data()),
-            reinterpret_cast<char*>(result.data.data()),
-            static_cast<int>(found->compressedSize),
-            static_cast<int>(found->originalSize));
+        // 非圧縮: マップから必要な部分だけコピーする
+        memcpy(destination.data(), m_file->Data() + m_dataOffset + entry.offset + offset, length);
+        return length;
+    }
 
-        if (decompressed <= 0)
+    // 単一ブロックの圧縮エントリは全体を展開してから切り出す
+    FileData whole = ReadEntry(&entry);
+    if (!whole.IsValid())
+        return 0;
+    memcpy(destination.data(), whole.Data() + offset, length);
+    return length;
+}
+
+bool Archive::ReadChunks(const ArchiveEntry& entry, uint64_t offset, std::span<uint8_t> destination) const
+{
+    const ChunkLayout layout = GetChunkLayout(m_file->Data() + m_dataOffset + entry.offset);
+    const uint64_t end = offset + destination.size();
+    const uint32_t firstChunk = static_cast<uint32_t>(offset / layout.chunkSize);
+    const uint32_t lastChunk = static_cast<uint32_t>((end - 1) / layout.chunkSize);
+
+    // [begin, stop) のチャンクを展開する。範囲に丸ごと含まれるチャンクは書き込み先へ直接展開し、
+    // 両端で一部だけ必要なチャンクは作業バッファに展開してから切り出す
+    auto decodeChunks = [&](uint32_t begin, uint32_t stop) -> bool {
+        std::vector<uint8_t> scratch;
+        for (uint32_t c = begin; c < stop; ++c)
         {
-            GX_LOG_ERROR("Archive::Read: LZ4 decompression failed for: %s", path.c_str());
-            result.data.clear();
+            const uint64_t chunkBegin = static_cast<uint64_t>(c) * layout.chunkSize;
+            const uint32_t rawSize = static_cast<uint32_t>(
+                (std::min<uint64_t>)(layout.chunkSize, entry.originalSize - chunkBegin));
+            const uint8_t* src = layout.data + layout.Offset(c);
+            const uint32_t storedSize = static_cast<uint32_t>(layout.Offset(c + 1) - layout.Offset(c));
+
+            const uint64_t copyBegin = (std::max)(chunkBegin, offset);
+            const uint64_t copyEnd = (std::min)(chunkBegin + rawSize, end);
+            uint8_t* out = destination.data() + (copyBegin - offset);
+            const size_t copySize = static_cast<size_t>(copyEnd - copyBegin);
+
+            if (storedSize == rawSize)
+            {
+                memcpy(out, src + (copyBegin - chunkBegin), copySize);
+                continue;
+            }
+
+            const bool whole = copySize == rawSize;
+            if (!whole)
+                scratch.resize(rawSize);
+            if (!DecodeBlock(entry.codec, src, storedSize, whole ? out : scratch.data(), rawSize))
+                return false;
+            if (!whole)
+                memcpy(out, scratch.data() + (copyBegin - chunkBegin), copySize);
         }
+        return true;
+    };
+
+    const uint32_t chunkCount = lastChunk - firstChunk + 1;
+    const uint32_t threadCount = (std::min)(
+        (std::min)((std::max)(std::thread::hardware_concurrency(), 1u), k_MaxChunkThreads),
+        chunkCount);
+
+    bool ok = true;
+    if (chunkCount < k_ParallelChunkThreshold || threadCount <= 1)
+    {
+        ok = decodeChunks(firstChunk, lastChunk + 1);
     }
     else
     {
-        // 非圧縮データ
-        result.data = std::move(compressed);
+        // チャンクは独立しているので、連続した区間ごとにスレッドへ割り当てる
+        std::atomic<bool> allOk{ true };
+        auto runPart = [&](uint32_t part) {
+            const uint32_t begin = firstChunk + static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * part / threadCount);
+            const uint32_t stop = firstChunk + static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * (part + 1) / threadCount);
+            if (!decodeChunks(begin, stop))
+                allOk = false;
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (uint32_t part = 1; part < threadCount; ++part)
+            threads.emplace_back(runPart, part);
+        runPart(0);
+        for (auto& t : threads)
+            t.join();
+        ok = allOk;
     }
 
-    return result;
+    if (!ok)
+        GX_LOG_ERROR("Archive::Read: Chunk decompression failed for: %s", entry.path.c_str());
+    return ok;
 }
 
 // ============================================================================
@@ -204,23 +636,56 @@ void ArchiveWriter::SetCompression(bool enable)
     m_compress = enable;
 }
 
+void ArchiveWriter::SetChunkSize(uint32_t chunkSize)
+{
+    m_chunkSize = (std::clamp)(chunkSize, k_ArchiveMinChunkSize, k_ArchiveMaxChunkSize);
+}
+
+void ArchiveWriter::SetCodec(const ArchiveCodec& codec)
+{
+    m_codec = codec;
+}
+
+void ArchiveWriter::SetThreadCount(uint32_t threadCount)
+{
+    m_threadCount = threadCount;
+}
+
+bool ArchiveWriter::SetBaseArchive(const std::string& filePath, const std::string& password)
+{
+    m_baseByContent.clear();
+    m_base = std::make_unique<Archive>();
+    if (!m_base->Open(filePath, password))
+    {
+        GX_LOG_WARN("ArchiveWriter::SetBaseArchive: Cannot open: %s", filePath.c_str());
+        m_base.reset();
+        return false;
+    }
+
+    // 内容ハッシュを持たない旧形式のエントリは再利用できない
+    for (const auto& entry : m_base->GetEntries())
+    {
+        if (entry.contentHash != 0)
+            m_baseByContent.emplace(entry.contentHash, &entry);
+    }
+    return true;
+}
+
 void ArchiveWriter::AddFile(const std::string& archivePath, const std::string& diskPath)
 {
-    std::ifstream file(diskPath, std::ios::binary | std::ios::ate);
-    if (!file.is_open())
+    std::error_code ec;
+    const uint64_t fileSize = std::filesystem::file_size(diskPath, ec);
+    if (ec)
     {
         GX_LOG_WARN("ArchiveWriter::AddFile: Cannot open: %s", diskPath.c_str());
         return;
     }
-
-    auto fileSize = file.tellg();
-    if (fileSize <= 0) return;
+    if (fileSize == 0) return;
 
     PendingFile pf;
     pf.archivePath = archivePath;
-    pf.data.resize(static_cast<size_t>(fileSize));
-    file.seekg(0);
-    file.read(reinterpret_cast<char*>(pf.data.data()), fileSize);
+    pf.diskPath = diskPath;
+    pf.size = fileSize;
     m_files.push_back(std::move(pf));
 }
 
@@ -230,9 +695,164 @@ void ArchiveWriter::AddFile(const std::string& archivePath, const void* data, si
     pf.archivePath = archivePath;
     pf.data.assign(static_cast<const uint8_t*>(data),
                    static_cast<const uint8_t*>(data) + size);
+    pf.size = size;
     m_files.push_back(std::move(pf));
 }
 
+void ArchiveWriter::AddFile(const std::string& archivePath, const std::string& diskPath, const ArchiveCodec& codec)
+{
+    const size_t count = m_files.size();
+    AddFile(archivePath, diskPath);
+    if (m_files.size() > count)
+        m_files.back().codec = codec;
+}
+
+void ArchiveWriter::AddFile(const std::string& archivePath, const void* data, size_t size, const ArchiveCodec& codec)
+{
+    AddFile(archivePath, data, size);
+    m_files.back().codec = codec;
+}
+
+struct ArchiveWriter::Block
+{
+    std::vector<uint8_t> data;          ///< 読み込んだ元データまたは圧縮結果
+    std::span<const uint8_t> stored;    ///< 書き出すバイト列 (data・メモリ上の元データ・元アーカイブのいずれかを指す)
+    uint64_t originalSize = 0;
+    uint64_t contentHash = 0;
+    uint8_t flags = 0;
+    gxfmt::GxpakCodec codec = gxfmt::GxpakCodec::None;
+    bool reused = false;
+};
+
+bool ArchiveWriter::BuildBlock(const PendingFile& pf, Block& block) const
+{
+    // ディスク上のファイルはここで初めて読み込む
+    std::vector<uint8_t> fileData;
+    std::span<const uint8_t> source = pf.data;
+    if (!pf.diskPath.empty())
+    {
+        std::ifstream file(pf.diskPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            GX_LOG_ERROR("ArchiveWriter::Save: Cannot open: %s", pf.diskPath.c_str());
+            return false;
+        }
+        fileData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+        if (!file)
+        {
+            GX_LOG_ERROR("ArchiveWriter::Save: Read failed: %s", pf.diskPath.c_str());
+            return false;
+        }
+        source = fileData;
+    }
+
+    block.originalSize = source.size();
+    block.contentHash = gxfmt::HashContent(source.data(), source.size());
+    block.flags = 0;
+    block.codec = gxfmt::GxpakCodec::None;
+
+    // 辞書付きコーデックは辞書なしの版にする (.gxarcは共有辞書を持たない)
+    ArchiveCodec codec = pf.codec.value_or(m_codec);
+    if (codec.codec == gxfmt::GxpakCodec::LZ4Dict)
+        codec.codec = gxfmt::GxpakCodec::LZ4;
+    else if (codec.codec == gxfmt::GxpakCodec::ZstdDict)
+        codec.codec = gxfmt::GxpakCodec::Zstd;
+    const bool compress = m_compress && IsArchiveCodec(codec.codec);
+
+    const bool chunked = compress && source.size() > m_chunkSize;
+    const bool compressible = compress && source.size() > 64; // 64バイト以上のみ圧縮 (小さすぎると効果が薄い)
+
+    // 差分再パック: 同じ内容で、今回の設定でも同じ形式になる格納データはそのまま使う。
+    // 非圧縮で格納されていたエントリは圧縮を試していない可能性があるため、圧縮有効時は作り直す
+    auto baseIt = m_baseByContent.find(block.contentHash);
+    if (baseIt != m_baseByContent.end() && baseIt->second->originalSize == source.size())
+    {
+        const ArchiveEntry& baseEntry = *baseIt->second;
+        std::span<const uint8_t> stored = m_base->GetStoredData(baseEntry);
+        bool match = false;
+        if (baseEntry.flags & k_EntryFlagChunked)
+        {
+            uint32_t chunkSize = 0;
+            memcpy(&chunkSize, stored.data(), 4);
+            match = chunked && chunkSize == m_chunkSize && baseEntry.codec == codec.codec;
+        }
+        else if (baseEntry.flags & k_EntryFlagCompressed)
+        {
+            match = compressible && !chunked && baseEntry.codec == codec.codec;
+        }
+        else
+        {
+            match = !compressible;
+        }
+
+        if (match)
+        {
+            block.stored = stored;
+            block.flags = baseEntry.flags;
+            block.codec = baseEntry.codec;
+            block.reused = true;
+            return true;
+        }
+    }
+
+    if (chunked)
+    {
+        // チャンクごとに独立して圧縮する (部分読み込み・並列展開のため)
+        const uint32_t chunkCount = static_cast<uint32_t>((source.size() + m_chunkSize - 1) / m_chunkSize);
+        const size_t indexSize = k_ChunkHeaderSize + (static_cast<size_t>(chunkCount) + 1) * 8;
+        block.data.resize(indexSize);
+        memcpy(block.data.data(), &m_chunkSize, 4);
+        memcpy(block.data.data() + 4, &chunkCount, 4);
+
+        std::vector<uint8_t> compressed(CompressBound(codec.codec, m_chunkSize));
+        uint64_t chunkOffset = 0;
+        for (uint32_t c = 0; c < chunkCount; ++c)
+        {
+            memcpy(block.data.data() + k_ChunkHeaderSize + static_cast<size_t>(c) * 8, &chunkOffset, 8);
+
+            const uint8_t* raw = source.data() + static_cast<size_t>(c) * m_chunkSize;
+            const size_t rawSize = (std::min<size_t>)(m_chunkSize, source.size() - static_cast<size_t>(c) * m_chunkSize);
+            const size_t compressedSize = EncodeBlock(codec, raw, rawSize, compressed.data(), compressed.size());
+
+            // 小さくならなかったチャンクは非圧縮のまま格納する
+            if (compressedSize > 0)
+                block.data.insert(block.data.end(), compressed.begin(), compressed.begin() + compressedSize);
+            else
+                block.data.insert(block.data.end(), raw, raw + rawSize);
+            chunkOffset = block.data.size() - indexSize;
+        }
+        memcpy(block.data.data() + k_ChunkHeaderSize + static_cast<size_t>(chunkCount) * 8, &chunkOffset, 8);
+        block.flags = k_EntryFlagChunked;
+        block.codec = codec.codec;
+        block.stored = block.data;
+        return true;
+    }
+
+    if (compressible)
+    {
+        std::vector<uint8_t> compressed(CompressBound(codec.codec, source.size()));
+        const size_t compressedSize = EncodeBlock(codec, source.data(), source.size(), compressed.data(), compressed.size());
+
+        // 実際に小さくなった場合のみ圧縮版を採用する
+        if (compressedSize > 0)
+        {
+            compressed.resize(compressedSize);
+            block.data = std::move(compressed);
+            block.flags = k_EntryFlagCompressed;
+            block.codec = codec.codec;
+            block.stored = block.data;
+            return true;
+        }
+    }
+
+    // 非圧縮: 読み込んだバッファはそのまま、メモリ上のデータはコピーせずに書き出す
+    block.data = std::move(fileData);
+    block.stored = pf.diskPath.empty() ? source : std::span<const uint8_t>(block.data);
+    return true;
+}
+
 bool ArchiveWriter::Save(const std::string& outputPath)
 {
     bool encrypted = !m_password.empty();
@@ -240,65 +860,179 @@ bool ArchiveWriter::Save(const std::string& outputPath)
     if (encrypted)
         key = Crypto::SHA256(m_password.c_str(), m_password.size());
 
-    // ファイルを圧縮しエントリを構築する
-    struct FileBlock {
-        std::vector<uint8_t> data;
-        uint32_t originalSize;
-        uint8_t flags;
-    };
-    std::vector<FileBlock> blocks;
-    std::vector<ArchiveEntry> entries;
-    blocks.reserve(m_files.size());
-    entries.reserve(m_files.size());
+    // パスハッシュの衝突を検出する (ハッシュのみでエントリを引けるため)
+    {
+        std::vector<std::pair<uint64_t, size_t>> hashes;
+        hashes.reserve(m_files.size());
+        for (size_t i = 0; i < m_files.size(); ++i)
+            hashes.push_back({ Archive::HashPath(m_files[i].archivePath), i });
+        std::sort(hashes.begin(), hashes.end());
+        for (size_t i = 1; i < hashes.size(); ++i)
+        {
+            if (hashes[i].first != hashes[i - 1].first)
+                continue;
+            const std::string& a = m_files[hashes[i - 1].second].archivePath;
+            const std::string& b = m_files[hashes[i].second].archivePath;
+            if (a == b)
+            {
+                // 同一パスの重複は従来通り先に追加した方が読まれる
+                GX_LOG_WARN("ArchiveWriter::Save: Duplicate path: %s", a.c_str());
+                continue;
+            }
+            GX_LOG_ERROR("ArchiveWriter::Save: Path hash collision: %s / %s", a.c_str(), b.c_str());
+            return false;
+        }
+    }
 
-    uint64_t currentOffset = 0;
+    // TOCはデータの前に置かれるが、サイズはパスだけで決まるため先に領域を確保し、最後に書き込む
+    // (エントリごと: pathLen(2) + path + offset(8) + compressedSize(8) + originalSize(8) + flags(1) + codec(1) + pathHash(8) + contentHash(8))
+    size_t tocPlainSize = 0;
     for (const auto& pf : m_files)
+        tocPlainSize += 2 + pf.archivePath.size() + 8 + 8 + 8 + 1 + 1 + 8 + 8;
+    // 暗号化時: IV(16) + PKCS#7パディング込みの暗号文
+    const uint32_t tocSize = static_cast<uint32_t>(encrypted ? 16 + (tocPlainSize / 16 + 1) * 16 : tocPlainSize);
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.is_open())
     {
-        FileBlock block;
-        block.originalSize = static_cast<uint32_t>(pf.data.size());
-        block.flags = 0;
+        GX_LOG_ERROR("ArchiveWriter::Save: Cannot create: %s", outputPath.c_str());
+        return false;
+    }
+
+    // マジック
+    out.write(reinterpret_cast<const char*>(k_Magic), 8);
+
+    // TOCヘッダ
+    uint32_t entryCount = static_cast<uint32_t>(m_files.size());
+    uint32_t flags = 0;
+    if (encrypted) flags |= k_FlagEncrypted;
+    if (m_compress) flags |= k_FlagCompressed;
+    uint32_t version = k_ArchiveVersion;
+
+    out.write(reinterpret_cast<const char*>(&entryCount), 4);
+    out.write(reinterpret_cast<const char*>(&tocSize), 4);
+    out.write(reinterpret_cast<const char*>(&flags), 4);
+    out.write(reinterpret_cast<const char*>(&version), 4);
+
+    // TOCデータの領域 (後で上書き)
+    std::vector<char> tocPlaceholder(tocSize, 0);
+    out.write(tocPlaceholder.data(), tocPlaceholder.size());
+    tocPlaceholder = {};
+
+    // ワーカーがファイルを読み込み・圧縮し、このスレッドが追加順に書き出す。
+    // ワーカーは書き出し待ちが上限を超えない範囲で先のファイルを取る
+    const size_t fileCount = m_files.size();
+    uint32_t threadCount = m_threadCount ? m_threadCount : (std::max)(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<uint32_t>((std::min<size_t>)(threadCount, (std::max<size_t>)(fileCount, 1)));
+    const size_t maxAhead = static_cast<size_t>(threadCount) * 4;
 
-        if (m_compress && pf.data.size() > 64) // 64バイト以上のみ圧縮 (小さすぎると効果が薄い)
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Block> blocks(fileCount);
+    std::vector<uint8_t> ready(fileCount, 0);
+    size_t nextFile = 0;
+    size_t writtenCount = 0;
+    uint64_t pendingBytes = 0;
+    bool failed = false;
+
+    auto worker = [&]() {
+        for (;;)
         {
-            int maxCompressed = LZ4_compressBound(static_cast<int>(pf.data.size()));
-            std::vector<uint8_t> compressed(maxCompressed);
-            int compressedSize = LZ4_compress_default(
-                reinterpret_cast<const char*>(pf.data.data()),
-                reinterpret_cast<char*>(compressed.data()),
-                static_cast<int>(pf.data.size()),
-                maxCompressed);
-
-            // 実際に小さくなった場合のみ圧縮版を採用する
-            if (compressedSize > 0 && static_cast<size_t>(compressedSize) < pf.data.size())
+            size_t index;
             {
-                compressed.resize(compressedSize);
-                block.data = std::move(compressed);
-                block.flags = k_EntryFlagCompressed;
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() {
+                    return failed || nextFile >= fileCount ||
+                           (nextFile - writtenCount < maxAhead &&
+                            (pendingBytes == 0 || pendingBytes + m_files[nextFile].size <= k_MaxPendingBytes));
+                });
+                if (failed || nextFile >= fileCount) return;
+                index = nextFile++;
+                pendingBytes += m_files[index].size;
             }
-            else
+
+            Block block;
+            const bool ok = BuildBlock(m_files[index], block);
             {
-                block.data = pf.data;
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok)
+                {
+                    blocks[index] = std::move(block);
+                    ready[index] = 1;
+                }
+                else
+                {
+                    failed = true;
+                }
             }
+            cv.notify_all();
         }
-        else
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (uint32_t t = 0; t < threadCount; ++t)
+        workers.emplace_back(worker);
+
+    std::vector<ArchiveEntry> entries;
+    entries.reserve(fileCount);
+    uint64_t currentOffset = 0;
+    uint32_t reusedCount = 0;
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        Block block;
         {
-            block.data = pf.data;
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return failed || ready[i]; });
+            if (failed) break;
+            block = std::move(blocks[i]);
         }
 
+        // ファイル本体データ
+        out.write(reinterpret_cast<const char*>(block.stored.data()), static_cast<std::streamsize>(block.stored.size()));
+
         ArchiveEntry entry;
-        entry.path = pf.archivePath;
+        entry.path = m_files[i].archivePath;
         entry.offset = currentOffset;
-        entry.compressedSize = static_cast<uint32_t>(block.data.size());
+        entry.compressedSize = block.stored.size();
         entry.originalSize = block.originalSize;
         entry.flags = block.flags;
+        entry.codec = block.codec;
+        entry.pathHash = Archive::HashPath(entry.path);
+        entry.contentHash = block.contentHash;
         entries.push_back(std::move(entry));
 
-        currentOffset += block.data.size();
-        blocks.push_back(std::move(block));
+        currentOffset += block.stored.size();
+        if (block.reused) ++reusedCount;
+        block = {};
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writtenCount = i + 1;
+            pendingBytes -= m_files[i].size;
+        }
+        cv.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!out) failed = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers)
+        t.join();
+
+    if (failed)
+    {
+        out.close();
+        std::remove(outputPath.c_str());
+        GX_LOG_ERROR("ArchiveWriter::Save: Failed to write: %s", outputPath.c_str());
+        return false;
     }
 
     // TOCを構築する
     std::vector<uint8_t> tocData;
+    tocData.reserve(tocPlainSize);
     for (const auto& entry : entries)
     {
         uint16_t pathLen = static_cast<uint16_t>(entry.path.size());
@@ -311,15 +1045,21 @@ bool ArchiveWriter::Save(const std::string& outputPath)
             reinterpret_cast<const uint8_t*>(&entry.offset) + 8);
         tocData.insert(tocData.end(),
             reinterpret_cast<const uint8_t*>(&entry.compressedSize),
-            reinterpret_cast<const uint8_t*>(&entry.compressedSize) + 4);
+            reinterpret_cast<const uint8_t*>(&entry.compressedSize) + 8);
         tocData.insert(tocData.end(),
             reinterpret_cast<const uint8_t*>(&entry.originalSize),
-            reinterpret_cast<const uint8_t*>(&entry.originalSize) + 4);
+            reinterpret_cast<const uint8_t*>(&entry.originalSize) + 8);
         tocData.push_back(entry.flags);
+        tocData.push_back(static_cast<uint8_t>(entry.codec));
+        tocData.insert(tocData.end(),
+            reinterpret_cast<const uint8_t*>(&entry.pathHash),
+            reinterpret_cast<const uint8_t*>(&entry.pathHash) + 8);
+        tocData.insert(tocData.end(),
+            reinterpret_cast<const uint8_t*>(&entry.contentHash),
+            reinterpret_cast<const uint8_t*>(&entry.contentHash) + 8);
     }
 
     // 必要ならTOCを暗号化する
-    uint32_t tocSize;
     std::vector<uint8_t> tocFinal;
     if (encrypted)
     {
@@ -331,48 +1071,32 @@ bool ArchiveWriter::Save(const std::string& outputPath)
         tocFinal.reserve(16 + encryptedToc.size());
         tocFinal.insert(tocFinal.end(), iv, iv + 16);
         tocFinal.insert(tocFinal.end(), encryptedToc.begin(), encryptedToc.end());
-        tocSize = static_cast<uint32_t>(tocFinal.size());
     }
     else
     {
         tocFinal = std::move(tocData);
-        tocSize = static_cast<uint32_t>(tocFinal.size());
     }
 
-    // アーカイブを書き込む
-    std::ofstream out(outputPath, std::ios::binary);
-    if (!out.is_open())
+    if (tocFinal.size() != tocSize)
     {
-        GX_LOG_ERROR("ArchiveWriter::Save: Cannot create: %s", outputPath.c_str());
+        out.close();
+        std::remove(outputPath.c_str());
+        GX_LOG_ERROR("ArchiveWriter::Save: Unexpected TOC size (%zu, reserved %u)", tocFinal.size(), tocSize);
         return false;
     }
 
-    // マジック
-    out.write(reinterpret_cast<const char*>(k_Magic), 8);
-
-    // TOCヘッダ
-    uint32_t entryCount = static_cast<uint32_t>(entries.size());
-    uint32_t flags = 0;
-    if (encrypted) flags |= k_FlagEncrypted;
-    if (m_compress) flags |= k_FlagCompressed;
-    uint32_t reserved = 0;
-
-    out.write(reinterpret_cast<const char*>(&entryCount), 4);
-    out.write(reinterpret_cast<const char*>(&tocSize), 4);
-    out.write(reinterpret_cast<const char*>(&flags), 4);
-    out.write(reinterpret_cast<const char*>(&reserved), 4);
-
     // TOCデータ
+    out.seekp(8 + 16);
     out.write(reinterpret_cast<const char*>(tocFinal.data()), tocFinal.size());
-
-    // ファイル本体データ
-    for (const auto& block : blocks)
+    out.close();
+    if (!out)
     {
-        out.write(reinterpret_cast<const char*>(block.data.data()), block.data.size());
+        GX_LOG_ERROR("ArchiveWriter::Save: Failed to write: %s", outputPath.c_str());
+        return false;
     }
 
-    GX_LOG_INFO("ArchiveWriter::Save: Created %s (%u files, %llu bytes)",
-        outputPath.c_str(), entryCount,
+    GX_LOG_INFO("ArchiveWriter::Save: Created %s (%u files, %u reused, %llu bytes)",
+        outputPath.c_str(), entryCount, reusedCount,
         static_cast<unsigned long long>(8 + 16 + tocFinal.size() + currentOffset));
     return true;
 }
@@ -1,22 +1,45 @@
 #pragma once
 /// @file Archive.h
-/// @brief カスタムアーカイブ形式 (.gxarc) — AES-256暗号化 + LZ4圧縮
+/// @brief カスタムアーカイブ形式 (.gxarc) — AES-256暗号化 + LZ4/LZ4HC/Zstd圧縮
 ///
 /// ゲーム用アセットを1つの .gxarc ファイルにパッキングし、
-/// オプションでAES-256-CBC暗号化とLZ4圧縮をサポートする。
+/// オプションでAES-256-CBC暗号化と圧縮をサポートする。圧縮コーデックはエントリごとに選べる。
 /// ArchiveWriter でパック、Archive で読み込み、ArchiveFileProvider でVFSマウント可能。
+/// TOCには各パスの64bitハッシュが格納され、読み込み時にハッシュテーブルで索引される。
+/// 読み込み側はファイルを一度だけメモリマップし、エントリをマップから直接取り出す。
+/// チャンクサイズを超えるエントリは独立に圧縮したチャンク列として格納され、
+/// ReadRange() で必要なチャンクだけを展開できる (全体の展開は複数スレッドで並列に行う)。
 
 #include "IO/FileSystem.h"
+#include <mapped_file.h>
+#include <gxpak.h>
+#include <optional>
+#include <span>
 
 namespace GX {
 
+/// @brief チャンク分割の既定サイズ (展開後 128KB)
+static constexpr uint32_t k_ArchiveDefaultChunkSize = 128 * 1024;
+static constexpr uint32_t k_ArchiveMinChunkSize = 64 * 1024;   ///< チャンクサイズの下限
+static constexpr uint32_t k_ArchiveMaxChunkSize = 256 * 1024;  ///< チャンクサイズの上限
+
 /// @brief アーカイブ内のファイルエントリ情報
 struct ArchiveEntry {
     std::string path;           ///< アーカイブ内パス
     uint64_t offset;            ///< データ領域内のオフセット
-    uint32_t compressedSize;    ///< 圧縮後のサイズ (非圧縮時はoriginalSizeと同じ)
-    uint32_t originalSize;      ///< 元のサイズ
-    uint8_t flags;              ///< フラグ (bit0: 圧縮済み)
+    uint64_t compressedSize;    ///< 格納サイズ (非圧縮時はoriginalSizeと同じ、チャンク形式は索引を含む)
+    uint64_t originalSize;      ///< 元のサイズ
+    uint8_t flags;              ///< フラグ (bit0: 圧縮済み、bit1: チャンク形式)
+    gxfmt::GxpakCodec codec;    ///< 圧縮・チャンク形式のエントリのコーデック (非圧縮はNone、旧形式はLZ4)
+    uint64_t pathHash;          ///< Archive::HashPath(path)
+    uint64_t contentHash;       ///< 元データの gxfmt::HashContent() (旧形式は0)
+};
+
+/// @brief ArchiveWriterでエントリを圧縮する方法
+/// @details 共有辞書を持たないため、辞書付きコーデック (LZ4Dict / ZstdDict) は辞書なしの版で圧縮する。
+struct ArchiveCodec {
+    gxfmt::GxpakCodec codec = gxfmt::GxpakCodec::LZ4; ///< None / LZ4 / LZ4HC / Zstd
+    int level = 0;              ///< LZ4HC: 3～12、Zstd: 1～22 (0 = コーデックの既定値、LZ4では無視)
 };
 
 /// @brief アーカイブリーダー
@@ -40,18 +63,110 @@ public:
     /// @return 存在すればtrue
     bool Contains(const std::string& path) const;
 
+    /// @brief 指定ハッシュのファイルがアーカイブ内に存在するか判定する
+    /// @param pathHash HashPath()で計算したパスハッシュ
+    /// @return 存在すればtrue
+    bool Contains(uint64_t pathHash) const;
+
+    /// @brief 指定パスのエントリを検索する
+    /// @param path アーカイブ内パス
+    /// @return エントリへのポインタ。見つからない場合はnullptr
+    const ArchiveEntry* Find(const std::string& path) const;
+
+    /// @brief 事前計算したパスハッシュでエントリを検索する
+    /// @param pathHash HashPath()で計算したパスハッシュ
+    /// @return エントリへのポインタ。見つからない場合はnullptr
+    const ArchiveEntry* Find(uint64_t pathHash) const;
+
     /// @brief アーカイブからファイルを読み込む
     /// @param path アーカイブ内パス
     /// @return ファイルデータ (失敗時はIsValid()==false)
     FileData Read(const std::string& path) const;
 
+    /// @brief 事前計算したパスハッシュでファイルを読み込む (文字列比較なし)
+    /// @param pathHash HashPath()で計算したパスハッシュ
+    /// @return ファイルデータ (失敗時はIsValid()==false)
+    FileData Read(uint64_t pathHash) const;
+
+    /// @brief 非圧縮エントリをコピーせずにマップ上で参照する
+    /// @details ビューはマッピングを保持するため、Close()後も有効なまま使える。
+    /// @param path アーカイブ内パス
+    /// @return マップ上のビュー。見つからない・圧縮エントリの場合は無効 (IsValid()==false)
+    gxloader::MappedView ReadView(const std::string& path) const;
+
+    /// @brief 事前計算したパスハッシュで非圧縮エントリを参照する
+    gxloader::MappedView ReadView(uint64_t pathHash) const;
+
+    /// @brief ファイルを呼び出し側のバッファへ直接読み込む (中間バッファなし)
+    /// @details 圧縮エントリはマップからdestinationへ直接伸長する。
+    ///          必要なサイズはFind()->originalSizeで得られる。
+    /// @param path アーカイブ内パス
+    /// @param destination 書き込み先 (originalSize以上)
+    /// @return 成功した場合true
+    bool ReadInto(const std::string& path, std::span<uint8_t> destination) const;
+
+    /// @brief 事前計算したパスハッシュでファイルをバッファへ読み込む
+    bool ReadInto(uint64_t pathHash, std::span<uint8_t> destination) const;
+
+    /// @brief エントリの一部を読み込む (チャンク形式なら範囲に掛かるチャンクだけを展開する)
+    /// @param path アーカイブ内パス
+    /// @param offset 展開後データ内の開始位置
+    /// @param length 読み込むバイト数 (エントリ末尾で切り詰める)
+    /// @return 読み込んだデータ (見つからない・範囲外・失敗時はIsValid()==false)
+    FileData ReadRange(const std::string& path, uint64_t offset, size_t length) const;
+
+    /// @brief 事前計算したパスハッシュでエントリの一部を読み込む
+    FileData ReadRange(uint64_t pathHash, uint64_t offset, size_t length) const;
+
+    /// @brief エントリの一部を呼び出し側のバッファへ読み込む
+    /// @param path アーカイブ内パス
+    /// @param offset 展開後データ内の開始位置
+    /// @param destination 書き込み先 (エントリ末尾を越える分は書き込まない)
+    /// @return 書き込んだバイト数 (失敗時は0)
+    size_t ReadRangeInto(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const;
+
+    /// @brief 複数エントリのデータ領域の先読みをまとめて要求する
+    /// @details データ位置順に並べて近接する範囲を結合し、1回の要求でOSに渡す。
+    ///          多数の小さなエントリを続けて読む前に呼ぶとページフォルトが減る。
+    /// @param entries Find()で得たエントリ (nullptrは無視)
+    void Prefetch(std::span<const ArchiveEntry* const> entries) const;
+
+    /// @brief エントリの格納データ (圧縮・チャンク形式のまま) を参照する
+    /// @param entry GetEntries() または Find() で得たエントリ
+    /// @return マップ上のバイト列 (アーカイブを開いている間有効)
+    std::span<const uint8_t> GetStoredData(const ArchiveEntry& entry) const;
+
+    /// @brief アーカイブ内パスのハッシュを計算する (.gxpak と同じ FNV-1a 64bit)
+    /// @param path アーカイブ内パス
+    /// @return 64bitハッシュ値
+    static uint64_t HashPath(const std::string& path);
+
     /// @brief 全エントリ一覧を取得する
     /// @return エントリの配列への参照
     const std::vector<ArchiveEntry>& GetEntries() const { return m_entries; }
 
 private:
-    std::string m_filePath;
+    /// @brief ハッシュテーブルのスロット (index == k_EmptySlot で空き)
+    struct Slot
+    {
+        uint64_t hash;
+        uint32_t index;
+    };
+    static constexpr uint32_t k_EmptySlot = 0xFFFFFFFF;
+
+    void BuildIndex();
+    FileData ReadEntry(const ArchiveEntry* entry) const;
+    gxloader::MappedView ReadEntryView(const ArchiveEntry* entry) const;
+    bool ReadEntryInto(const ArchiveEntry& entry, std::span<uint8_t> destination) const;
+    FileData ReadEntryRange(const ArchiveEntry* entry, uint64_t offset, size_t length) const;
+    size_t ReadEntryRange(const ArchiveEntry& entry, uint64_t offset, std::span<uint8_t> destination) const;
+
+    /// チャンク形式エントリの [offset, offset + destination.size()) を展開する
+    bool ReadChunks(const ArchiveEntry& entry, uint64_t offset, std::span<uint8_t> destination) const;
+
+    std::shared_ptr<const gxloader::MappedFile> m_file; ///< アーカイブ全体のマッピング
     std::vector<ArchiveEntry> m_entries;
+    std::vector<Slot> m_slots;          ///< パスハッシュ → エントリ番号 (オープンアドレス法、サイズは2の冪)
     std::array<uint8_t, 32> m_key{};
     bool m_encrypted = false;
     uint64_t m_dataOffset = 0;
@@ -60,7 +175,10 @@ private:
 /// @brief アーカイブライター (パックツール)
 ///
 /// 複数ファイルを .gxarc 形式にパッキングする。
-/// オプションでAES-256暗号化とLZ4圧縮を適用できる。
+/// オプションでAES-256暗号化と圧縮を適用できる。コーデックは既定値をSetCodec()で、
+/// ファイルごとにAddFile()の引数で指定する (読み込みの多いファイルはLZ4、配布サイズを詰めたいファイルはZstdなど)。
+/// Save() はワーカースレッドで読み込み・圧縮を並列に行い、完成したエントリから順に書き出す。
+/// 書き出し待ちのデータ量には上限があるため、ディスク上のファイルは全体をメモリに載せずにパックできる。
 class ArchiveWriter
 {
 public:
@@ -68,21 +186,58 @@ public:
     /// @param password パスワード
     void SetPassword(const std::string& password);
 
-    /// @brief LZ4圧縮の有効/無効を設定する
-    /// @param enable trueで圧縮有効 (デフォルト: true)
+    /// @brief 圧縮の有効/無効を設定する
+    /// @param enable trueで圧縮有効 (デフォルト: true)。falseなら全エントリを非圧縮で格納する
     void SetCompression(bool enable);
 
-    /// @brief ディスク上のファイルをアーカイブに追加する
+    /// @brief コーデックを指定せずに追加したファイルの圧縮方法を設定する
+    /// @param codec コーデックとレベル (デフォルト: LZ4)
+    void SetCodec(const ArchiveCodec& codec);
+
+    /// @brief ディスク上のファイルをアーカイブに追加する (読み込みは Save() 時に行う)
     /// @param archivePath アーカイブ内でのパス
     /// @param diskPath ディスク上のファイルパス
     void AddFile(const std::string& archivePath, const std::string& diskPath);
 
+    /// @brief ディスク上のファイルを圧縮方法を指定して追加する
+    /// @param archivePath アーカイブ内でのパス
+    /// @param diskPath ディスク上のファイルパス
+    /// @param codec このファイルのコーデックとレベル
+    void AddFile(const std::string& archivePath, const std::string& diskPath, const ArchiveCodec& codec);
+
     /// @brief メモリ上のデータをアーカイブに追加する
     /// @param archivePath アーカイブ内でのパス
     /// @param data データポインタ
     /// @param size データサイズ (バイト)
     void AddFile(const std::string& archivePath, const void* data, size_t size);
 
+    /// @brief メモリ上のデータを圧縮方法を指定して追加する
+    /// @param archivePath アーカイブ内でのパス
+    /// @param data データポインタ
+    /// @param size データサイズ (バイト)
+    /// @param codec このファイルのコーデックとレベル
+    void AddFile(const std::string& archivePath, const void* data, size_t size, const ArchiveCodec& codec);
+
+    /// @brief チャンク分割のサイズを設定する (64KB～256KBに丸める)
+    /// @details 圧縮有効時、これを超えるファイルはチャンクごとに独立して圧縮され、
+    ///          読み込み側で部分読み込みと並列展開ができる。
+    /// @param chunkSize チャンクの展開後サイズ (デフォルト: 128KB)
+    void SetChunkSize(uint32_t chunkSize);
+
+    /// @brief 読み込み・圧縮に使うワーカースレッド数を設定する
+    /// @param threadCount スレッド数 (0 = 論理コア数、デフォルト: 0)
+    void SetThreadCount(uint32_t threadCount);
+
+    /// @brief 差分再パックの元になるアーカイブを指定する
+    /// @details Save() 時、内容ハッシュとサイズが一致し、現在の設定と同じ格納形式
+    ///          (コーデック・チャンクサイズ) のエントリは再圧縮せずに元の格納データをそのまま書き出す
+    ///          (圧縮レベルは比較しない)。
+    ///          元アーカイブはSave()が終わるまで開いたままにする。
+    /// @param filePath 前回出力した .gxarc (出力先と同じパスは不可)
+    /// @param password 元アーカイブのパスワード (暗号化されていない場合は空文字)
+    /// @return 開けた場合true
+    bool SetBaseArchive(const std::string& filePath, const std::string& password = "");
+
     /// @brief アーカイブを保存する
     /// @param outputPath 出力ファイルパス
     /// @return 成功した場合true
@@ -91,11 +246,29 @@ public:
 private:
     struct PendingFile {
         std::string archivePath;
-        std::vector<uint8_t> data;
+        std::string diskPath;       ///< 空でなければ Save() 時にここから読む
+        std::vector<uint8_t> data;  ///< メモリから追加したデータ
+        uint64_t size = 0;          ///< 追加時点のサイズ (書き出し待ちの量の見積もりに使う)
+        std::optional<ArchiveCodec> codec; ///< 未指定ならSetCodec()の設定で圧縮する
     };
+
+    /// Save() のワーカーが作る書き出し単位
+    struct Block;
+
+    /// ファイルを読み込み、差分再パックの再利用または圧縮で格納データを作る (ワーカースレッド)
+    bool BuildBlock(const PendingFile& file, Block& block) const;
+
+    /// 書き出し待ちのデータ量の上限 (これを超えるとワーカーは次のファイルを取らない)
+    static constexpr uint64_t k_MaxPendingBytes = 256ull * 1024 * 1024;
+
     std::vector<PendingFile> m_files;
     std::string m_password;
     bool m_compress = true;
+    uint32_t m_chunkSize = k_ArchiveDefaultChunkSize;
+    ArchiveCodec m_codec;
+    uint32_t m_threadCount = 0;
+    std::unique_ptr<Archive> m_base;                                    ///< 差分再パックの元
+    std::unordered_map<uint64_t, const ArchiveEntry*> m_baseByContent;  ///< 内容ハッシュ → 元エントリ
 };
 
 } // namespace GX
@@ -2,6 +2,7 @@
 /// @brief アーカイブプロバイダー実装 — Archive への委譲
 #include "pch.h"
 #include "IO/ArchiveFileProvider.h"
+#include <numeric>
 
 namespace GX {
 
@@ -20,4 +21,71 @@ FileData ArchiveFileProvider::Read(const std::string& path) const
     return m_archive.Read(path);
 }
 
+FileView ArchiveFileProvider::ReadView(const std::string& path) const
+{
+    const ArchiveEntry* entry = m_archive.Find(path);
+    return entry ? ReadEntryView(*entry) : FileView{};
+}
+
+FileView ArchiveFileProvider::ReadEntryView(const ArchiveEntry& entry) const
+{
+    gxloader::MappedView view = m_archive.ReadView(entry.pathHash);
+    if (view.IsValid())
+        return FileView(view.data, view.size, std::move(view.owner));
+    return FileView::FromFileData(m_archive.Read(entry.pathHash));
+}
+
+bool ArchiveFileProvider::GetSize(const std::string& path, size_t& size) const
+{
+    const ArchiveEntry* entry = m_archive.Find(path);
+    size = entry ? static_cast<size_t>(entry->originalSize) : 0;
+    return entry != nullptr;
+}
+
+size_t ArchiveFileProvider::ReadInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    const ArchiveEntry* entry = m_archive.Find(path);
+    if (!entry || !m_archive.ReadInto(entry->pathHash, destination))
+        return 0;
+    return static_cast<size_t>(entry->originalSize);
+}
+
+size_t ArchiveFileProvider::ReadRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const
+{
+    return m_archive.ReadRangeInto(path, offset, destination);
+}
+
+void ArchiveFileProvider::ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const
+{
+    const size_t count = (std::min)(paths.size(), results.size());
+    std::vector<const ArchiveEntry*> entries(count);
+    for (size_t i = 0; i < count; ++i)
+        entries[i] = m_archive.Find(paths[i]);
+
+    // 先読みをまとめて要求し、データ位置順に取り出す (シークとページフォルトを減らす)
+    m_archive.Prefetch(entries);
+
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        uint64_t offsetA = entries[a] ? entries[a]->offset : 0;
+        uint64_t offsetB = entries[b] ? entries[b]->offset : 0;
+        return offsetA < offsetB;
+    });
+
+    for (size_t i : order)
+        results[i] = entries[i] ? ReadEntryView(*entries[i]) : FileView{};
+}
+
+bool ArchiveFileProvider::ListFiles(std::vector<std::string>& paths) const
+{
+    const auto& entries = m_archive.GetEntries();
+    if (entries.empty())
+        return false;
+    paths.reserve(paths.size() + entries.size());
+    for (const auto& entry : entries)
+        paths.push_back(entry.path);
+    return true;
+}
+
 } // namespace GX
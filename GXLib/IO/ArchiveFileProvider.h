@@ -33,13 +33,35 @@ public:
     /// @return ファイルデータ（失敗時はIsValid()==false）
     FileData Read(const std::string& path) const override;
 
+    /// @brief ファイルをビューとして読み込む (非圧縮エントリはマップを直接参照する)
+    /// @param path アーカイブ内パス
+    /// @return ファイルビュー（失敗時はIsValid()==false）
+    FileView ReadView(const std::string& path) const override;
+
+    /// @brief 展開後のサイズを取得する (TOCから取得、読み込みなし)
+    bool GetSize(const std::string& path, size_t& size) const override;
+
+    /// @brief バッファへ直接読み込む (圧縮エントリはマップから直接伸長する)
+    size_t ReadInto(const std::string& path, std::span<uint8_t> destination) const override;
+
+    /// @brief エントリの一部を読み込む (チャンク形式なら該当チャンクのみ展開する)
+    size_t ReadRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const override;
+
+    /// @brief 複数ファイルをまとめて読み込む (データ位置順に並べ、先読みを一括要求する)
+    void ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const override;
+
     /// @brief 書き込みは非サポート (常にfalse)
     bool Write(const std::string& path, const void* data, size_t size) override { return false; }
 
     /// @brief プロバイダー優先度 (100: 物理ファイルより優先)
     int Priority() const override { return 100; }
 
+    /// @brief TOCの全パスを返す (開いていない・空の場合はfalse。FileSystemのパス索引に使われる)
+    bool ListFiles(std::vector<std::string>& paths) const override;
+
 private:
+    FileView ReadEntryView(const ArchiveEntry& entry) const;
+
     Archive m_archive;
 };
 
@@ -1,48 +1,137 @@
 #include "pch.h"
 #include "IO/AsyncLoader.h"
 #include "Core/Logger.h"
+#include "ThirdParty/lz4.h"
+
+// stb_imageの実装定義(STB_IMAGE_IMPLEMENTATION)はTexture.cppにあるため、ここではヘッダのみ
+#include "ThirdParty/stb_image.h"
+
+#include <model_loader.h>
+#include <climits>
 
 namespace GX {
 
+// ============================================================================
+// 起動・停止
+// ============================================================================
+
 AsyncLoader::AsyncLoader()
 {
-    m_workerThread = std::thread(&AsyncLoader::WorkerLoop, this);
+    Start(AsyncLoaderConfig{});
+}
+
+AsyncLoader::AsyncLoader(const AsyncLoaderConfig& config)
+{
+    Start(config);
+}
+
+void AsyncLoader::Start(const AsyncLoaderConfig& config)
+{
+    uint32_t ioCount = (std::max)(config.ioThreadCount, 1u);
+    uint32_t decodeCount = config.decodeThreadCount;
+    if (decodeCount == 0)
+    {
+        uint32_t cores = std::thread::hardware_concurrency();
+        decodeCount = (std::min)((std::max)(cores, 2u) - 1, 4u);
+    }
+
+    m_ioThreadCount = ioCount;
+    for (uint32_t i = 0; i < ioCount; ++i)
+        m_ioThreads.emplace_back(&AsyncLoader::IoLoop, this);
+    for (uint32_t i = 0; i < decodeCount; ++i)
+        m_decodeThreads.emplace_back(&AsyncLoader::DecodeLoop, this);
 }
 
 AsyncLoader::~AsyncLoader()
 {
-    m_running.store(false);
-    m_cv.notify_one();
-    if (m_workerThread.joinable())
-        m_workerThread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_ioCv.notify_all();
+    m_decodeCv.notify_all();
+    for (auto& t : m_ioThreads)
+        t.join();
+    for (auto& t : m_decodeThreads)
+        t.join();
 }
 
+// ============================================================================
+// リクエスト
+// ============================================================================
+
 uint32_t AsyncLoader::Load(const std::string& path,
                             std::function<void(FileData&)> onComplete)
 {
-    auto req = std::make_shared<LoadRequest>();
-    req->path = path;
-    req->onComplete = std::move(onComplete);
+    // 従来のFileDataコールバック: バッファへのコピーはデコードスレッドで行う
+    LoadRequestDesc desc;
+    desc.path = path;
+    desc.decoder = [](const FileView& data) -> std::shared_ptr<void> {
+        auto fileData = std::make_shared<FileData>();
+        fileData->data.assign(data.Data(), data.Data() + data.Size());
+        return fileData;
+    };
+    if (onComplete)
+    {
+        desc.onComplete = [cb = std::move(onComplete)](LoadResult& result) {
+            if (FileData* fileData = result.GetDecoded<FileData>())
+            {
+                cb(*fileData);
+                return;
+            }
+            FileData empty;
+            cb(empty);
+        };
+    }
+    return Load(desc);
+}
+
+uint32_t AsyncLoader::Load(const LoadRequestDesc& desc)
+{
+    auto req = std::make_shared<Request>();
+    req->path = desc.path;
+    req->priority = desc.priority;
+    req->decoder = desc.decoder;
+    req->onComplete = desc.onComplete;
 
-    uint32_t id;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        id = m_nextId++;
-        m_statusMap[id] = LoadStatus::Pending;
-        m_pendingQueue.push_back({ id, req });
+        req->id = m_nextId++;
+        req->result.requestId = req->id;
+        m_requests[req->id] = req;
+        m_statusMap[req->id] = LoadStatus::Pending;
+
+        // 同じパスのI/Oが待機中・読み込み中ならそれに相乗りする
+        auto it = m_jobsByPath.find(desc.path);
+        if (it != m_jobsByPath.end())
+        {
+            req->status = it->second->loading ? LoadStatus::Loading : LoadStatus::Pending;
+            m_statusMap[req->id] = req->status;
+            it->second->requests.push_back(req);
+            return req->id;
+        }
+
+        auto job = std::make_shared<IoJob>();
+        job->path = desc.path;
+        job->sequence = m_nextSequence++;
+        job->requests.push_back(req);
+        m_jobsByPath[desc.path] = job;
+        m_ioQueue.push_back(std::move(job));
     }
-    m_cv.notify_one();
-    return id;
+    m_ioCv.notify_one();
+    return req->id;
 }
 
 // 完了キューをswapで一括取得し、ロックの外でコールバックを発火する。
 // これによりコールバック内からLoad()を呼んでもデッドロックしない。
 void AsyncLoader::Update()
 {
-    std::vector<std::shared_ptr<LoadRequest>> completed;
+    std::vector<std::shared_ptr<Request>> completed;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         completed.swap(m_completedQueue);
+        for (auto& req : completed)
+            m_requests.erase(req->id);
     }
 
     for (auto& req : completed)
@@ -52,12 +141,79 @@ void AsyncLoader::Update()
     }
 }
 
+bool AsyncLoader::Cancel(uint32_t requestId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return CancelLocked(requestId);
+}
+
 void AsyncLoader::CancelAll()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto& [id, req] : m_pendingQueue)
-        m_statusMap[id] = LoadStatus::Error;
-    m_pendingQueue.clear();
+    std::vector<uint32_t> ids;
+    ids.reserve(m_requests.size());
+    for (auto& [id, req] : m_requests)
+        ids.push_back(id);
+    for (uint32_t id : ids)
+        CancelLocked(id);
+}
+
+bool AsyncLoader::CancelLocked(uint32_t requestId)
+{
+    auto it = m_requests.find(requestId);
+    if (it == m_requests.end())
+        return false;
+    std::shared_ptr<Request> req = it->second;
+    m_requests.erase(it);
+
+    auto removeFrom = [&](std::vector<std::shared_ptr<Request>>& list) {
+        list.erase(std::remove(list.begin(), list.end(), req), list.end());
+    };
+
+    switch (req->status)
+    {
+    case LoadStatus::Pending:
+    case LoadStatus::Loading:
+    {
+        // I/Oから外す。誰も待っていない未開始のI/Oは取り消す
+        // (読み込み中のI/Oは完了時に結果を捨てる)
+        auto jobIt = m_jobsByPath.find(req->path);
+        if (jobIt != m_jobsByPath.end())
+        {
+            std::shared_ptr<IoJob> job = jobIt->second;
+            job->requests.erase(std::remove(job->requests.begin(), job->requests.end(), req),
+                                job->requests.end());
+            if (job->requests.empty() && !job->loading)
+            {
+                m_ioQueue.erase(std::remove(m_ioQueue.begin(), m_ioQueue.end(), job), m_ioQueue.end());
+                m_jobsByPath.erase(jobIt);
+            }
+        }
+        break;
+    }
+    case LoadStatus::Decoding:
+        // デコード中ならDecodeLoopが結果を捨てる
+        removeFrom(m_decodeQueue);
+        break;
+    default:
+        // 完了済みでコールバック待ち
+        removeFrom(m_completedQueue);
+        break;
+    }
+
+    req->status = LoadStatus::Cancelled;
+    m_statusMap[requestId] = LoadStatus::Cancelled;
+    return true;
+}
+
+bool AsyncLoader::SetPriority(uint32_t requestId, int priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_requests.find(requestId);
+    if (it == m_requests.end())
+        return false;
+    it->second->priority = priority;
+    return true;
 }
 
 LoadStatus AsyncLoader::GetStatus(uint32_t requestId) const
@@ -69,38 +225,193 @@ LoadStatus AsyncLoader::GetStatus(uint32_t requestId) const
     return LoadStatus::Error;
 }
 
-void AsyncLoader::WorkerLoop()
+uint32_t AsyncLoader::GetActiveCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_requests.size());
+}
+
+// ============================================================================
+// ワーカー
+// ============================================================================
+
+void AsyncLoader::IoLoop()
 {
+    std::vector<std::shared_ptr<IoJob>> batch;
+    std::vector<std::string> paths;
+
     while (true)
     {
-        std::pair<uint32_t, std::shared_ptr<LoadRequest>> work;
-
+        batch.clear();
+        paths.clear();
         {
             std::unique_lock<std::mutex> lock(m_mutex);
-            m_cv.wait(lock, [this]() { return !m_running.load() || !m_pendingQueue.empty(); });
-
-            if (!m_running.load() && m_pendingQueue.empty())
+            m_ioCv.wait(lock, [this]() { return !m_running || !m_ioQueue.empty(); });
+            if (!m_running)
                 return;
 
-            if (m_pendingQueue.empty())
-                continue;
+            // I/Oの優先度 = 待っているリクエストの最大値 (SetPriorityを反映するため毎回計算する)
+            for (auto& job : m_ioQueue)
+            {
+                job->priority = INT_MIN;
+                for (auto& r : job->requests)
+                    job->priority = (std::max)(job->priority, r->priority);
+            }
 
-            work = std::move(m_pendingQueue.front());
-            m_pendingQueue.erase(m_pendingQueue.begin());
-            m_statusMap[work.first] = LoadStatus::Loading;
+            // 優先度の高い順に取り出す。他のI/Oスレッドにも仕事が残るよう均等に割る
+            const size_t batchSize = (std::min)(k_MaxIoBatch,
+                (m_ioQueue.size() + m_ioThreadCount - 1) / m_ioThreadCount);
+            std::partial_sort(m_ioQueue.begin(), m_ioQueue.begin() + batchSize, m_ioQueue.end(),
+                [](const std::shared_ptr<IoJob>& a, const std::shared_ptr<IoJob>& b) {
+                    if (a->priority != b->priority)
+                        return a->priority > b->priority;
+                    return a->sequence < b->sequence;
+                });
+            batch.assign(std::make_move_iterator(m_ioQueue.begin()),
+                         std::make_move_iterator(m_ioQueue.begin() + batchSize));
+            m_ioQueue.erase(m_ioQueue.begin(), m_ioQueue.begin() + batchSize);
+
+            for (auto& job : batch)
+            {
+                job->loading = true;
+                paths.push_back(job->path);
+                for (auto& req : job->requests)
+                {
+                    req->status = LoadStatus::Loading;
+                    m_statusMap[req->id] = LoadStatus::Loading;
+                }
+            }
         }
 
-        // ロックの外で読み込みを行う (I/Oで他スレッドを止めないため)
-        work.second->result = FileSystem::Instance().ReadFile(work.second->path);
-        work.second->status = work.second->result.IsValid()
-            ? LoadStatus::Complete : LoadStatus::Error;
+        // ロックの外でまとめて読み込む (プロバイダーがデータ位置順の並べ替え・先読みを行う)
+        std::vector<FileView> data = FileSystem::Instance().ReadFileBatch(paths);
 
         {
             std::lock_guard<std::mutex> lock(m_mutex);
-            m_statusMap[work.first] = work.second->status;
-            m_completedQueue.push_back(std::move(work.second));
+            for (size_t i = 0; i < batch.size(); ++i)
+                FinishIoLocked(*batch[i], data[i]);
+        }
+        m_decodeCv.notify_all();
+    }
+}
+
+void AsyncLoader::FinishIoLocked(IoJob& job, const FileView& data)
+{
+    m_jobsByPath.erase(job.path);
+
+    for (auto& req : job.requests)
+    {
+        // 読み込み中にキャンセルされたリクエストは既にjobから外れている
+        req->result.data = data;
+        if (!data.IsValid())
+        {
+            req->status = LoadStatus::Error;
+            req->result.status = LoadStatus::Error;
+            m_completedQueue.push_back(req);
+        }
+        else if (req->decoder)
+        {
+            req->status = LoadStatus::Decoding;
+            m_decodeQueue.push_back(req);
+        }
+        else
+        {
+            req->status = LoadStatus::Complete;
+            req->result.status = LoadStatus::Complete;
+            m_completedQueue.push_back(req);
+        }
+        m_statusMap[req->id] = req->status;
+    }
+}
+
+void AsyncLoader::DecodeLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<Request> req;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_decodeCv.wait(lock, [this]() { return !m_running || !m_decodeQueue.empty(); });
+            if (!m_running)
+                return;
+
+            // 優先度が最も高く、同値なら先に登録されたリクエスト
+            size_t best = 0;
+            for (size_t i = 1; i < m_decodeQueue.size(); ++i)
+            {
+                const Request& a = *m_decodeQueue[i];
+                const Request& b = *m_decodeQueue[best];
+                if (a.priority > b.priority || (a.priority == b.priority && a.id < b.id))
+                    best = i;
+            }
+            req = std::move(m_decodeQueue[best]);
+            m_decodeQueue.erase(m_decodeQueue.begin() + best);
         }
+
+        // ロックの外でデコードする
+        std::shared_ptr<void> decoded = req->decoder(req->result.data);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (req->status == LoadStatus::Cancelled)
+            continue;
+        req->result.decoded = std::move(decoded);
+        req->status = req->result.decoded ? LoadStatus::Complete : LoadStatus::Error;
+        req->result.status = req->status;
+        m_statusMap[req->id] = req->status;
+        m_completedQueue.push_back(std::move(req));
     }
 }
 
+// ============================================================================
+// 組み込みデコードステージ
+// ============================================================================
+
+LoadDecoder AsyncLoader::DecodeLZ4(size_t originalSize)
+{
+    return [originalSize](const FileView& data) -> std::shared_ptr<void> {
+        auto out = std::make_shared<std::vector<uint8_t>>(originalSize);
+        int result = LZ4_decompress_safe(
+            reinterpret_cast<const char*>(data.Data()),
+            reinterpret_cast<char*>(out->data()),
+            static_cast<int>(data.Size()),
+            static_cast<int>(originalSize));
+        if (result != static_cast<int>(originalSize))
+        {
+            GX_LOG_ERROR("AsyncLoader: LZ4 decompression failed");
+            return nullptr;
+        }
+        return out;
+    };
+}
+
+LoadDecoder AsyncLoader::DecodeGxmd()
+{
+    return [](const FileView& data) -> std::shared_ptr<void> {
+        std::shared_ptr<gxloader::LoadedModel> model =
+            gxloader::LoadGxmdFromMemory(data.Data(), data.Size());
+        return model;
+    };
+}
+
+LoadDecoder AsyncLoader::DecodeImage()
+{
+    return [](const FileView& data) -> std::shared_ptr<void> {
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = stbi_load_from_memory(
+            data.Data(), static_cast<int>(data.Size()), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            GX_LOG_ERROR("AsyncLoader: Image decode failed (stb_image: %s)", stbi_failure_reason());
+            return nullptr;
+        }
+
+        auto image = std::make_shared<DecodedImage>();
+        image->width = static_cast<uint32_t>(width);
+        image->height = static_cast<uint32_t>(height);
+        image->pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        return image;
+    };
+}
+
 } // namespace GX
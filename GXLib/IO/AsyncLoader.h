@@ -2,8 +2,13 @@
 /// @file AsyncLoader.h
 /// @brief バックグラウンドスレッドによる非同期アセットローダー
 ///
-/// ワーカースレッドでファイルを読み込み、メインスレッドでコールバックを発火する。
-/// Update() をフレームループ内で呼び出すこと。
+/// I/Oスレッドでファイルを読み込み、必要ならデコードスレッドで変換してから
+/// メインスレッドでコールバックを発火する。Update() をフレームループ内で呼び出すこと。
+///
+/// - リクエストごとに優先度を持ち、読み込み前・デコード前なら SetPriority() で変更できる。
+/// - Cancel() で個別にキャンセルできる (読み込み中・デコード中なら結果を破棄する)。
+/// - 同じパスへの読み込みは1回のI/Oにまとめられ、各リクエストに同じデータが渡る。
+/// - 待機中のI/Oは優先度順に最大 k_MaxIoBatch 件ずつ FileSystem::ReadFileBatch() で一括読み込みする。
 
 #include "IO/FileSystem.h"
 
@@ -13,61 +18,176 @@ namespace GX {
 enum class LoadStatus {
     Pending,    ///< キューに入っている (未開始)
     Loading,    ///< 読み込み中
+    Decoding,   ///< デコード待ち・デコード中
     Complete,   ///< 完了
-    Error       ///< エラー発生
+    Error,      ///< エラー発生
+    Cancelled   ///< キャンセル済み (コールバックは呼ばれない)
 };
 
-/// @brief 読み込みリクエスト (内部用)
-struct LoadRequest {
-    std::string path;                           ///< ファイルパス
-    LoadStatus status = LoadStatus::Pending;    ///< 現在の状態
-    FileData result;                            ///< 読み込み結果
-    std::function<void(FileData&)> onComplete;  ///< 完了コールバック
+/// @brief 読み込み結果 (コールバックに渡される)
+struct LoadResult
+{
+    uint32_t requestId = 0;                 ///< リクエストID
+    LoadStatus status = LoadStatus::Error;  ///< Complete または Error
+    FileView data;                          ///< 読み込んだバイト列
+    std::shared_ptr<void> decoded;          ///< デコードステージの生成物 (デコーダー未指定時はnullptr)
+
+    /// @brief デコード結果を型付きで取得する
+    /// @tparam T デコーダーが生成した型
+    template<typename T>
+    T* GetDecoded() const { return static_cast<T*>(decoded.get()); }
+};
+
+/// @brief デコードステージ (デコードスレッドで実行される)。nullptrを返すとError
+using LoadDecoder = std::function<std::shared_ptr<void>(const FileView& data)>;
+
+/// @brief 完了コールバック (メインスレッドの Update() で呼ばれる)
+using LoadCallback = std::function<void(LoadResult& result)>;
+
+/// @brief 読み込みリクエストの記述
+struct LoadRequestDesc
+{
+    std::string path;           ///< ファイルパス (VFS経由)
+    int priority = 0;           ///< 優先度 (大きいほど先に処理、同値は登録順)
+    LoadDecoder decoder;        ///< デコードステージ (省略可)
+    LoadCallback onComplete;    ///< 完了コールバック
+};
+
+/// @brief AsyncLoaderのスレッド構成
+struct AsyncLoaderConfig
+{
+    uint32_t ioThreadCount = 2;     ///< I/Oスレッド数 (最低1)
+    uint32_t decodeThreadCount = 0; ///< デコードスレッド数 (0 = 論理コア数-1、1～4に制限)
+};
+
+/// @brief デコード済み画像 (DecodeImage() の生成物)
+struct DecodedImage
+{
+    uint32_t width = 0;             ///< 幅 (ピクセル)
+    uint32_t height = 0;            ///< 高さ (ピクセル)
+    std::vector<uint8_t> pixels;    ///< RGBA8 ピクセル (width * height * 4)
 };
 
 /// @brief 非同期アセットローダー
 ///
-/// バックグラウンドスレッドでファイルを読み込み、
+/// I/Oスレッドとデコードスレッドで読み込み・変換を行い、
 /// メインスレッドの Update() 呼び出し時にコールバックを発火する。
 class AsyncLoader
 {
 public:
-    /// @brief ワーカースレッドを起動する
+    /// @brief 既定の構成 (I/O 2スレッド) でワーカーを起動する
     AsyncLoader();
 
-    /// @brief ワーカースレッドを停止し、保留リクエストをキャンセルする
+    /// @brief スレッド構成を指定してワーカーを起動する
+    explicit AsyncLoader(const AsyncLoaderConfig& config);
+
+    /// @brief ワーカースレッドを停止し、保留リクエストを破棄する
     ~AsyncLoader();
 
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
     /// @brief 非同期読み込みリクエストを送信する
     /// @param path ファイルパス (VFS経由)
-    /// @param onComplete 完了時のコールバック (メインスレッドで呼ばれる)
+    /// @param onComplete 完了時のコールバック (メインスレッドで呼ばれる。失敗時は空のFileData)
     /// @return リクエストID (GetStatus()で状態確認に使用)
     uint32_t Load(const std::string& path,
                   std::function<void(FileData&)> onComplete);
 
+    /// @brief 優先度・デコードステージ付きの読み込みリクエストを送信する
+    /// @param desc リクエスト記述
+    /// @return リクエストID
+    uint32_t Load(const LoadRequestDesc& desc);
+
     /// @brief 完了したリクエストのコールバックを発火する (メインスレッドで毎フレーム呼ぶ)
     void Update();
 
-    /// @brief 全ての保留リクエストをキャンセルする
+    /// @brief リクエストをキャンセルする
+    /// @param requestId Load()が返したリクエストID
+    /// @return 完了前にキャンセルできた場合true
+    bool Cancel(uint32_t requestId);
+
+    /// @brief 全ての未完了リクエストをキャンセルする
     void CancelAll();
 
+    /// @brief リクエストの優先度を変更する (読み込み前・デコード前のリクエストに反映される)
+    /// @param requestId Load()が返したリクエストID
+    /// @param priority 新しい優先度
+    /// @return リクエストが未完了ならtrue
+    bool SetPriority(uint32_t requestId, int priority);
+
     /// @brief リクエストの現在の状態を取得する
     /// @param requestId Load()が返したリクエストID
     /// @return 読み込み状態
     LoadStatus GetStatus(uint32_t requestId) const;
 
+    /// @brief 未完了 (コールバック未発火) のリクエスト数を取得する
+    uint32_t GetActiveCount() const;
+
+    // --- 組み込みデコードステージ ---
+
+    /// @brief LZ4ブロックを展開する (生成物: std::vector<uint8_t>)
+    /// @param originalSize 展開後のサイズ
+    static LoadDecoder DecodeLZ4(size_t originalSize);
+
+    /// @brief GXMDモデルを解析する (生成物: gxloader::LoadedModel)
+    static LoadDecoder DecodeGxmd();
+
+    /// @brief PNG/JPG/TGA/BMP等の画像をRGBA8に展開する (生成物: DecodedImage)
+    static LoadDecoder DecodeImage();
+
 private:
-    std::thread m_workerThread;
+    /// @brief リクエスト (m_mutexで保護)
+    struct Request
+    {
+        uint32_t id = 0;
+        std::string path;
+        int priority = 0;
+        LoadStatus status = LoadStatus::Pending;
+        LoadDecoder decoder;
+        LoadCallback onComplete;
+        LoadResult result;
+    };
+
+    /// @brief 1パス分のI/O (同じパスのリクエストをまとめる)
+    struct IoJob
+    {
+        std::string path;
+        uint64_t sequence = 0;                          ///< 同優先度での登録順
+        int priority = 0;                               ///< 選択時に計算 (リクエストの最大値)
+        bool loading = false;                           ///< I/Oスレッドが読み込み中
+        std::vector<std::shared_ptr<Request>> requests; ///< 結果を受け取るリクエスト
+    };
+
+    /// 1回の一括読み込みで取り出すI/Oの上限
+    static constexpr size_t k_MaxIoBatch = 32;
+
+    void Start(const AsyncLoaderConfig& config);
+    void IoLoop();
+    void DecodeLoop();
+
+    /// I/O完了後にリクエストをデコードまたは完了キューへ送る (m_mutex保持)
+    void FinishIoLocked(IoJob& job, const FileView& data);
+
+    /// キャンセル処理の本体 (m_mutex保持)
+    bool CancelLocked(uint32_t requestId);
+
+    std::vector<std::thread> m_ioThreads;
+    std::vector<std::thread> m_decodeThreads;
+    uint32_t m_ioThreadCount = 1;
     mutable std::mutex m_mutex;
-    std::condition_variable m_cv;
-    std::atomic<bool> m_running{ true };
+    std::condition_variable m_ioCv;
+    std::condition_variable m_decodeCv;
+    bool m_running = true;
     uint32_t m_nextId = 1;
+    uint64_t m_nextSequence = 0;
 
-    std::vector<std::pair<uint32_t, std::shared_ptr<LoadRequest>>> m_pendingQueue;
-    std::vector<std::shared_ptr<LoadRequest>> m_completedQueue;
+    std::unordered_map<uint32_t, std::shared_ptr<Request>> m_requests;     ///< 未完了リクエスト
+    std::unordered_map<std::string, std::shared_ptr<IoJob>> m_jobsByPath;  ///< 待機中・読み込み中のI/O
+    std::vector<std::shared_ptr<IoJob>> m_ioQueue;                         ///< 未開始のI/O
+    std::vector<std::shared_ptr<Request>> m_decodeQueue;                   ///< デコード待ち
+    std::vector<std::shared_ptr<Request>> m_completedQueue;                ///< コールバック待ち
     std::unordered_map<uint32_t, LoadStatus> m_statusMap;
-
-    void WorkerLoop();
 };
 
 } // namespace GX
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "IO/FileSystem.h"
 #include "Core/Logger.h"
+#include "IO/FileWatcher.h"
 
 namespace GX {
 
@@ -12,119 +13,369 @@ FileSystem& FileSystem::Instance()
 
 std::string FileSystem::NormalizePath(const std::string& path)
 {
-    std::string result = path;
-    // バックスラッシュをスラッシュに統一する (Windows表記→共通表記)
-    for (auto& c : result)
+    std::string result;
+    result.reserve(path.size());
+    // バックスラッシュをスラッシュに統一し (Windows表記→共通表記)、
+    // 先頭・末尾・連続するスラッシュを除去する
+    for (char c : path)
     {
         if (c == '\\') c = '/';
+        if (c == '/' && (result.empty() || result.back() == '/'))
+            continue;
+        result += c;
     }
-    // 先頭スラッシュを除去する
-    while (!result.empty() && result[0] == '/')
-        result.erase(result.begin());
+    if (!result.empty() && result.back() == '/')
+        result.pop_back();
     return result;
 }
 
+// ============================================================================
+// マウント表
+// ============================================================================
+
 void FileSystem::Mount(const std::string& mountPoint, std::shared_ptr<IFileProvider> provider)
 {
+    std::unique_lock<std::shared_mutex> lock(m_mountMutex);
+
     MountEntry entry;
     entry.mountPoint = NormalizePath(mountPoint);
+    entry.priority = provider->Priority();
+    entry.sequence = m_nextSequence++;
     entry.provider = std::move(provider);
     m_mounts.push_back(std::move(entry));
 
-    // 優先度の高い順に並べ替える
-    std::sort(m_mounts.begin(), m_mounts.end(),
+    // 優先度の高い順に並べ替える (同じ優先度はマウント順を保つ)
+    std::stable_sort(m_mounts.begin(), m_mounts.end(),
         [](const MountEntry& a, const MountEntry& b) {
-            return a.provider->Priority() > b.provider->Priority();
+            return a.priority > b.priority;
         });
+    RebuildMountTable();
 }
 
 void FileSystem::Unmount(const std::string& mountPoint)
 {
+    std::unique_lock<std::shared_mutex> lock(m_mountMutex);
+
     std::string normalized = NormalizePath(mountPoint);
     m_mounts.erase(
         std::remove_if(m_mounts.begin(), m_mounts.end(),
             [&](const MountEntry& e) { return e.mountPoint == normalized; }),
         m_mounts.end());
+    RebuildMountTable();
 }
 
-bool FileSystem::Exists(const std::string& path) const
+void FileSystem::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mountMutex);
+    m_mounts.clear();
+    RebuildMountTable();
+}
+
+void FileSystem::RebuildMountTable()
 {
-    std::string normalized = NormalizePath(path);
+    m_mountRoot = MountNode{};
+    m_pathIndex.clear();
+
+    std::vector<std::string> files;
+    for (uint32_t i = 0; i < m_mounts.size(); ++i)
+    {
+        MountEntry& mount = m_mounts[i];
+
+        // マウントポイントを区切りごとにたどってノードに登録する
+        MountNode* node = &m_mountRoot;
+        size_t pos = 0;
+        while (pos < mount.mountPoint.size())
+        {
+            size_t end = mount.mountPoint.find('/', pos);
+            if (end == std::string::npos) end = mount.mountPoint.size();
+            auto& child = node->children[mount.mountPoint.substr(pos, end - pos)];
+            if (!child) child = std::make_unique<MountNode>();
+            node = child.get();
+            pos = end + 1;
+        }
+        node->mounts.push_back(i);
+
+        // 一覧を返すプロバイダーはパス索引へ統合する (m_mountsは優先度順なので最初の登録が最優先)
+        files.clear();
+        mount.indexed = mount.provider->ListFiles(files);
+        for (const auto& file : files)
+        {
+            std::string key = NormalizePath(file);
+            if (!mount.mountPoint.empty())
+                key = mount.mountPoint + "/" + key;
+            m_pathIndex.emplace(std::move(key), i);
+        }
+    }
 
-    for (const auto& mount : m_mounts)
+    InvalidateLookupCache();
+}
+
+void FileSystem::MatchMounts(const std::string& normalized, std::vector<MountMatch>& matches) const
+{
+    // トライ木を区切りごとにたどり、途中のノードのマウントを集める
+    const MountNode* node = &m_mountRoot;
+    size_t pos = 0;
+    for (;;)
     {
-        // パスがマウントポイントで始まるか確認する
-        if (mount.mountPoint.empty() ||
-            (normalized.size() >= mount.mountPoint.size() &&
-             normalized.compare(0, mount.mountPoint.size(), mount.mountPoint) == 0))
+        for (uint32_t mount : node->mounts)
         {
-            std::string relativePath = mount.mountPoint.empty()
-                ? normalized
-                : normalized.substr(mount.mountPoint.size());
-            // 相対パスの先頭スラッシュを除去する
-            while (!relativePath.empty() && relativePath[0] == '/')
-                relativePath.erase(relativePath.begin());
-
-            if (mount.provider->Exists(relativePath.empty() ? normalized : relativePath))
-                return true;
+            // マウントポイントそのものを指すパスは全体で問い合わせる (従来の挙動)
+            matches.push_back({ mount, pos < normalized.size() ? normalized.substr(pos) : normalized });
         }
+        if (pos >= normalized.size())
+            break;
+
+        size_t end = normalized.find('/', pos);
+        if (end == std::string::npos) end = normalized.size();
+        auto it = node->children.find(normalized.substr(pos, end - pos));
+        if (it == node->children.end())
+            break;
+        node = it->second.get();
+        pos = end + 1;
+    }
+
+    // m_mountsの番号順 = 優先度順
+    std::sort(matches.begin(), matches.end(),
+        [](const MountMatch& a, const MountMatch& b) { return a.mount < b.mount; });
+}
+
+bool FileSystem::Resolve(const std::string& path,
+                         const std::function<bool(const IFileProvider&, const std::string&)>& probe) const
+{
+    const std::string normalized = NormalizePath(path);
+
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_missingMutex);
+        if (m_missingPaths.count(normalized) > 0)
+            return false;
+        generation = m_missingGeneration;
+    }
+
+    std::vector<MountMatch> matches;
+    MatchMounts(normalized, matches);
+
+    const auto indexed = m_pathIndex.find(normalized);
+    bool cacheable = true;
+    for (const MountMatch& match : matches)
+    {
+        // 索引済みのプロバイダーは索引が指すものだけに問い合わせる
+        const MountEntry& mount = m_mounts[match.mount];
+        if (mount.indexed && (indexed == m_pathIndex.end() || indexed->second != match.mount))
+            continue;
+        if (probe(*mount.provider, match.lookupPath))
+            return true;
+
+        // 索引も監視もないプロバイダーは後からファイルが増えても通知が来ない
+        if (!mount.indexed && !mount.watched)
+            cacheable = false;
+    }
+    if (!cacheable)
+        return false;
+
+    // どこにも無かったパスを記憶する (解決中に破棄が入った場合は記憶しない)
+    std::lock_guard<std::mutex> lock(m_missingMutex);
+    if (generation == m_missingGeneration)
+    {
+        if (m_missingPaths.size() >= k_MaxMissingPaths)
+            m_missingPaths.clear();
+        m_missingPaths.insert(normalized);
     }
     return false;
 }
 
-FileData FileSystem::ReadFile(const std::string& path) const
+void FileSystem::InvalidateLookupCache(const std::string& path)
 {
-    std::string normalized = NormalizePath(path);
+    std::lock_guard<std::mutex> lock(m_missingMutex);
+    ++m_missingGeneration;
+
+    const std::string normalized = NormalizePath(path);
+    if (normalized.empty())
+    {
+        m_missingPaths.clear();
+        return;
+    }
 
-    for (const auto& mount : m_mounts)
+    // ディレクトリの作成・名前変更で現れるファイルも対象にする
+    const std::string directory = normalized + "/";
+    for (auto it = m_missingPaths.begin(); it != m_missingPaths.end(); )
     {
-        if (mount.mountPoint.empty() ||
-            (normalized.size() >= mount.mountPoint.size() &&
-             normalized.compare(0, mount.mountPoint.size(), mount.mountPoint) == 0))
+        if (*it == normalized || it->compare(0, directory.size(), directory) == 0)
+            it = m_missingPaths.erase(it);
+        else
+            ++it;
+    }
+}
+
+void FileSystem::WatchDirectory(FileWatcher& watcher, const std::string& mountPoint, const std::string& directory)
+{
+    const std::string prefix = NormalizePath(mountPoint);
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mountMutex);
+        for (MountEntry& mount : m_mounts)
         {
-            std::string relativePath = mount.mountPoint.empty()
-                ? normalized
-                : normalized.substr(mount.mountPoint.size());
-            while (!relativePath.empty() && relativePath[0] == '/')
-                relativePath.erase(relativePath.begin());
-
-            const std::string& lookupPath = relativePath.empty() ? normalized : relativePath;
-            if (mount.provider->Exists(lookupPath))
-                return mount.provider->Read(lookupPath);
+            if (mount.mountPoint == prefix && !mount.indexed)
+                mount.watched = true;
         }
     }
 
-    return FileData{};
+    const size_t directoryLength = directory.size() + 1; // FileWatcherは directory + "/" + 相対パス で通知する
+    watcher.Watch(directory, [this, prefix, directoryLength](const std::string& changedPath) {
+        if (changedPath.size() <= directoryLength)
+        {
+            InvalidateLookupCache();
+            return;
+        }
+        const std::string relative = changedPath.substr(directoryLength);
+        InvalidateLookupCache(prefix.empty() ? relative : prefix + "/" + relative);
+    });
+}
+
+// ============================================================================
+// 読み込み
+// ============================================================================
+
+bool FileSystem::Exists(const std::string& path) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    return Resolve(path, [](const IFileProvider& provider, const std::string& lookupPath) {
+        return provider.Exists(lookupPath);
+    });
+}
+
+FileData FileSystem::ReadFile(const std::string& path) const
+{
+    FileData result;
+    TryReadFile(path, result);
+    return result;
 }
 
-bool FileSystem::WriteFile(const std::string& path, const void* data, size_t size)
+bool FileSystem::TryReadFile(const std::string& path, FileData& data) const
 {
-    std::string normalized = NormalizePath(path);
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    data = FileData{};
+    return Resolve(path, [&data](const IFileProvider& provider, const std::string& lookupPath) {
+        return provider.TryRead(lookupPath, data);
+    });
+}
+
+FileView FileSystem::ReadFileView(const std::string& path) const
+{
+    FileView result;
+    TryReadFileView(path, result);
+    return result;
+}
+
+bool FileSystem::TryReadFileView(const std::string& path, FileView& view) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    view = FileView{};
+    return Resolve(path, [&view](const IFileProvider& provider, const std::string& lookupPath) {
+        return provider.TryReadView(lookupPath, view);
+    });
+}
+
+bool FileSystem::GetFileSize(const std::string& path, size_t& size) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    size = 0;
+    return Resolve(path, [&size](const IFileProvider& provider, const std::string& lookupPath) {
+        return provider.GetSize(lookupPath, size);
+    });
+}
 
-    for (auto& mount : m_mounts)
+size_t FileSystem::ReadFileInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    size_t written = 0;
+    Resolve(path, [&](const IFileProvider& provider, const std::string& lookupPath) {
+        if (!provider.Exists(lookupPath))
+            return false;
+        written = provider.ReadInto(lookupPath, destination);
+        return true;
+    });
+    return written;
+}
+
+size_t FileSystem::ReadFileRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    size_t written = 0;
+    Resolve(path, [&](const IFileProvider& provider, const std::string& lookupPath) {
+        if (!provider.Exists(lookupPath))
+            return false;
+        written = provider.ReadRange(lookupPath, offset, destination);
+        return true;
+    });
+    return written;
+}
+
+std::vector<FileView> FileSystem::ReadFileBatch(std::span<const std::string> paths) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+    std::vector<FileView> results(paths.size());
+
+    // プロバイダーごとにパスをまとめる (出現順を保つ)
+    struct Group
+    {
+        const IFileProvider* provider;
+        std::vector<std::string> lookupPaths;
+        std::vector<size_t> indices;
+    };
+    std::vector<Group> groups;
+    for (size_t i = 0; i < paths.size(); ++i)
     {
-        if (mount.mountPoint.empty() ||
-            (normalized.size() >= mount.mountPoint.size() &&
-             normalized.compare(0, mount.mountPoint.size(), mount.mountPoint) == 0))
+        std::string lookupPath;
+        const IFileProvider* provider = nullptr;
+        Resolve(paths[i], [&](const IFileProvider& candidate, const std::string& candidatePath) {
+            if (!candidate.Exists(candidatePath))
+                return false;
+            provider = &candidate;
+            lookupPath = candidatePath;
+            return true;
+        });
+        if (!provider)
+            continue;
+
+        auto it = std::find_if(groups.begin(), groups.end(),
+            [provider](const Group& g) { return g.provider == provider; });
+        if (it == groups.end())
         {
-            std::string relativePath = mount.mountPoint.empty()
-                ? normalized
-                : normalized.substr(mount.mountPoint.size());
-            while (!relativePath.empty() && relativePath[0] == '/')
-                relativePath.erase(relativePath.begin());
-
-            const std::string& writePath = relativePath.empty() ? normalized : relativePath;
-            if (mount.provider->Write(writePath, data, size))
-                return true;
+            groups.push_back({ provider, {}, {} });
+            it = groups.end() - 1;
         }
+        it->lookupPaths.push_back(std::move(lookupPath));
+        it->indices.push_back(i);
     }
 
-    return false;
+    std::vector<FileView> groupResults;
+    for (const Group& group : groups)
+    {
+        groupResults.assign(group.indices.size(), FileView{});
+        group.provider->ReadBatch(group.lookupPaths, groupResults);
+        for (size_t k = 0; k < group.indices.size(); ++k)
+            results[group.indices[k]] = std::move(groupResults[k]);
+    }
+    return results;
 }
 
-void FileSystem::Clear()
+bool FileSystem::WriteFile(const std::string& path, const void* data, size_t size)
 {
-    m_mounts.clear();
+    std::shared_lock<std::shared_mutex> lock(m_mountMutex);
+
+    const std::string normalized = NormalizePath(path);
+    std::vector<MountMatch> matches;
+    MatchMounts(normalized, matches);
+    for (const MountMatch& match : matches)
+    {
+        if (m_mounts[match.mount].provider->Write(match.lookupPath, data, size))
+        {
+            InvalidateLookupCache(normalized);
+            return true;
+        }
+    }
+
+    return false;
 }
 
 } // namespace GX
@@ -4,9 +4,27 @@
 ///
 /// マウントポイントにプロバイダーを登録し、パス解決を行うシングルトンVFS。
 /// 物理ファイル、暗号化アーカイブなど複数のソースを統一的にアクセスできる。
+///
+/// 読み込みAPIは3種類ある:
+/// - ReadFile : 所有バッファ (FileData) を返す。
+/// - ReadFileView : FileView を返す。メモリマップや非圧縮アーカイブエントリはコピーなしで参照する。
+/// - ReadFileInto : 呼び出し側のバッファへ直接読み込む。
+///
+/// パス解決はマウントポイントのトライ木で候補を絞り、アーカイブ系プロバイダーは
+/// マウント時に作るパス索引で判定する。どのプロバイダーにも無かったパスは記憶しておき、
+/// 次回からプロバイダーに問い合わせない (マウント変更・書き込み・WatchDirectory() の通知で破棄)。
+/// 記憶するのは、マッチした全プロバイダーが索引済みか WatchDirectory() で監視されている場合だけ
+/// (監視していないディスク上のディレクトリは外部でファイルが増えても気付けないため)。
+
+#include <span>
+#include <string_view>
+#include <shared_mutex>
+#include <unordered_set>
 
 namespace GX {
 
+class FileWatcher;
+
 /// @brief ファイルデータコンテナ (プロバイダーから返される)
 struct FileData
 {
@@ -27,6 +45,82 @@ struct FileData
     /// @brief データを文字列として取得する
     /// @return UTF-8文字列
     std::string AsString() const { return std::string(data.begin(), data.end()); }
+
+    /// @brief データを文字列ビューとして取得する (コピーなし)
+    /// @return UTF-8文字列ビュー (FileDataが生きている間のみ有効)
+    std::string_view AsStringView() const
+    {
+        return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+};
+
+/// @brief 読み取り専用のファイルデータビュー (参照カウント付き)
+///
+/// メモリマップ、プールバッファ、所有バッファのいずれかを参照する。
+/// 参照先の解放は owner (shared_ptr) の参照カウントで管理され、
+/// 最後のFileViewが破棄された時点で owner のデリータが走る
+/// (マッピング解除、プールへの返却、vectorの解放など)。
+class FileView
+{
+public:
+    FileView() = default;
+
+    /// @brief 外部メモリを参照するビューを作成する
+    /// @param data 先頭ポインタ
+    /// @param size バイト数
+    /// @param owner dataの寿命を保証するオブジェクト (nullptrなら無効なビュー)
+    FileView(const uint8_t* data, size_t size, std::shared_ptr<const void> owner)
+        : m_data(data), m_size(size), m_owner(std::move(owner)) {}
+
+    /// @brief バッファの所有権を移してビューを作成する
+    /// @param data 所有するバイト列
+    /// @return バッファを所有するビュー
+    static FileView FromVector(std::vector<uint8_t>&& data)
+    {
+        auto owned = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+        return FileView(owned->data(), owned->size(), owned);
+    }
+
+    /// @brief FileDataのバッファを引き取ってビューを作成する
+    static FileView FromFileData(FileData&& fileData)
+    {
+        return fileData.IsValid() ? FromVector(std::move(fileData.data)) : FileView{};
+    }
+
+    /// @brief データが有効かどうか判定する (FileDataと同じく空データは無効)
+    bool IsValid() const { return m_owner != nullptr && m_size > 0; }
+
+    /// @brief データへのポインタを取得する
+    const uint8_t* Data() const { return m_data; }
+
+    /// @brief データサイズを取得する
+    size_t Size() const { return m_size; }
+
+    /// @brief バイト列として取得する
+    std::span<const uint8_t> AsSpan() const { return { m_data, m_size }; }
+
+    /// @brief 文字列ビューとして取得する (コピーなし)
+    std::string_view AsStringView() const
+    {
+        return std::string_view(reinterpret_cast<const char*>(m_data), m_size);
+    }
+
+    /// @brief 部分範囲のビューを取得する (同じownerを共有する)
+    /// @param offset 開始オフセット
+    /// @param size バイト数 (範囲外は切り詰める)
+    FileView SubView(size_t offset, size_t size) const
+    {
+        if (offset > m_size) return FileView{};
+        return FileView(m_data + offset, (std::min)(size, m_size - offset), m_owner);
+    }
+
+    /// @brief 寿命管理オブジェクトを取得する
+    const std::shared_ptr<const void>& Owner() const { return m_owner; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    std::shared_ptr<const void> m_owner;
 };
 
 /// @brief ファイルプロバイダーの抽象インターフェース
@@ -48,6 +142,97 @@ public:
     /// @return ファイルデータ (失敗時はIsValid()==false)
     virtual FileData Read(const std::string& path) const = 0;
 
+    /// @brief 存在確認と読み込みを1回の呼び出しで行う
+    /// @details デフォルト実装はExists()とRead()を順に呼ぶ。
+    ///          ディスクプロバイダーはファイルを開けるかどうかで判定する (stat + open が open だけになる)。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @param data 出力: ファイルデータ
+    /// @return ファイルが存在すればtrue (空ファイルでもtrue)
+    virtual bool TryRead(const std::string& path, FileData& data) const
+    {
+        if (!Exists(path))
+            return false;
+        data = Read(path);
+        return true;
+    }
+
+    /// @brief 存在確認とビューの読み込みを1回の呼び出しで行う
+    /// @details デフォルト実装はExists()とReadView()を順に呼ぶ。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @param view 出力: ファイルビュー
+    /// @return ファイルが存在すればtrue (空ファイルでもtrue)
+    virtual bool TryReadView(const std::string& path, FileView& view) const
+    {
+        if (!Exists(path))
+            return false;
+        view = ReadView(path);
+        return true;
+    }
+
+    /// @brief ファイルをビューとして読み込む
+    /// @details デフォルト実装はRead()の結果を所有するビューを返す。
+    ///          マップや非圧縮エントリを持つプロバイダーはコピーなしのビューを返す。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @return ファイルビュー (失敗時はIsValid()==false)
+    virtual FileView ReadView(const std::string& path) const
+    {
+        return FileView::FromFileData(Read(path));
+    }
+
+    /// @brief ファイルサイズを取得する (読み込み後のバイト数)
+    /// @details デフォルト実装はRead()で全体を読む。ReadInto用のバッファ確保に使う。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @param size 出力: バイト数
+    /// @return ファイルが存在すればtrue
+    virtual bool GetSize(const std::string& path, size_t& size) const
+    {
+        FileData data = Read(path);
+        size = data.Size();
+        return data.IsValid();
+    }
+
+    /// @brief ファイルを呼び出し側のバッファへ読み込む
+    /// @details デフォルト実装はRead()の結果をコピーする。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @param destination 書き込み先 (GetSize()以上)
+    /// @return 書き込んだバイト数 (失敗・バッファ不足時は0)
+    virtual size_t ReadInto(const std::string& path, std::span<uint8_t> destination) const
+    {
+        FileData data = Read(path);
+        if (!data.IsValid() || data.Size() > destination.size())
+            return 0;
+        memcpy(destination.data(), data.Data(), data.Size());
+        return data.Size();
+    }
+
+    /// @brief ファイルの一部を呼び出し側のバッファへ読み込む (ストリーミング用)
+    /// @details デフォルト実装はRead()で全体を読んでから切り出す。
+    ///          ディスクやチャンク形式のアーカイブエントリは必要な部分だけを読む。
+    /// @param path ファイルパス (マウントポイント相対)
+    /// @param offset 読み込み開始位置 (展開後のバイト位置)
+    /// @param destination 書き込み先 (ファイル末尾を越える分は書き込まない)
+    /// @return 書き込んだバイト数 (失敗・範囲外は0)
+    virtual size_t ReadRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const
+    {
+        FileData data = Read(path);
+        if (!data.IsValid() || offset >= data.Size())
+            return 0;
+        const size_t length = (std::min)(destination.size(), static_cast<size_t>(data.Size() - offset));
+        memcpy(destination.data(), data.Data() + offset, length);
+        return length;
+    }
+
+    /// @brief 複数ファイルをまとめて読み込む
+    /// @details デフォルト実装はReadView()を順に呼ぶ。アーカイブ系プロバイダーは
+    ///          データ位置順に並べ替えて先読みをまとめて要求し、ディスクプロバイダーは非同期読み込みをまとめて発行する。
+    /// @param paths ファイルパス (マウントポイント相対)
+    /// @param results 出力: pathsと同じ順のビュー (失敗した要素はIsValid()==false)
+    virtual void ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const
+    {
+        for (size_t i = 0; i < paths.size() && i < results.size(); ++i)
+            results[i] = ReadView(paths[i]);
+    }
+
     /// @brief ファイルを書き込む
     /// @param path ファイルパス (マウントポイント相対)
     /// @param data 書き込むデータ
@@ -56,14 +241,25 @@ public:
     virtual bool Write(const std::string& path, const void* data, size_t size) = 0;
 
     /// @brief プロバイダーの優先度を取得する (高い値が優先)
+    /// @details マウント時に一度だけ読まれる。
     /// @return 優先度 (デフォルト: 0)
     virtual int Priority() const { return 0; }
+
+    /// @brief 全ファイルのパスを列挙する (内容が変わらないプロバイダー用)
+    /// @details アーカイブ系プロバイダーはTOCのパスを返す。FileSystemはマウント時にこれを
+    ///          パス索引へ統合し、以降このプロバイダーへのExists()を省く。
+    ///          デフォルト実装はfalse (ディスクなど一覧が変わるプロバイダーは索引しない)。
+    /// @param paths 出力: ファイルパス (マウントポイント相対)
+    /// @return 一覧を返した場合true
+    virtual bool ListFiles(std::vector<std::string>& paths) const { return false; }
 };
 
 /// @brief シングルトン仮想ファイルシステム
 ///
 /// マウントポイントにプロバイダーを登録し、優先度順にファイルアクセスを解決する。
-/// 同じパスに複数のプロバイダーがマッチする場合、Priority() が高いものが優先される。
+/// 同じパスに複数のプロバイダーがマッチする場合、Priority() が高いものが優先される
+/// (同じ優先度ならマウントした順)。マウントポイントはパスの区切り単位で照合する。
+/// 読み込みは複数スレッドから呼べる。マウントの変更は読み込みと排他される。
 class FileSystem
 {
 public:
@@ -90,6 +286,49 @@ public:
     /// @return ファイルデータ (失敗時はIsValid()==false)
     FileData ReadFile(const std::string& path) const;
 
+    /// @brief ファイルを読み込む (存在確認と読み込みを各プロバイダー1回の呼び出しで行う)
+    /// @param path ファイルパス
+    /// @param data 出力: ファイルデータ
+    /// @return ファイルが見つかった場合true (空ファイルでもtrue)
+    bool TryReadFile(const std::string& path, FileData& data) const;
+
+    /// @brief ファイルをビューとして読み込む (TryReadFile()のビュー版)
+    /// @param path ファイルパス
+    /// @param view 出力: ファイルビュー
+    /// @return ファイルが見つかった場合true (空ファイルでもtrue)
+    bool TryReadFileView(const std::string& path, FileView& view) const;
+
+    /// @brief ファイルをビューとして読み込む (可能ならコピーなし)
+    /// @param path ファイルパス
+    /// @return ファイルビュー (失敗時はIsValid()==false)
+    FileView ReadFileView(const std::string& path) const;
+
+    /// @brief ファイルサイズを取得する
+    /// @param path ファイルパス
+    /// @param size 出力: バイト数
+    /// @return ファイルが存在すればtrue
+    bool GetFileSize(const std::string& path, size_t& size) const;
+
+    /// @brief ファイルを呼び出し側のバッファへ読み込む
+    /// @param path ファイルパス
+    /// @param destination 書き込み先 (GetFileSize()以上)
+    /// @return 書き込んだバイト数 (失敗・バッファ不足時は0)
+    size_t ReadFileInto(const std::string& path, std::span<uint8_t> destination) const;
+
+    /// @brief ファイルの一部を呼び出し側のバッファへ読み込む
+    /// @param path ファイルパス
+    /// @param offset 読み込み開始位置
+    /// @param destination 書き込み先 (ファイル末尾を越える分は書き込まない)
+    /// @return 書き込んだバイト数 (失敗・範囲外は0)
+    size_t ReadFileRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const;
+
+    /// @brief 複数ファイルをまとめて読み込む
+    /// @details プロバイダーごとにまとめてIFileProvider::ReadBatch()へ渡す。
+    ///          小さなファイルを大量に読む場合、1件ずつReadFileView()を呼ぶより速い。
+    /// @param paths ファイルパス
+    /// @return pathsと同じ順のビュー (見つからない・失敗した要素はIsValid()==false)
+    std::vector<FileView> ReadFileBatch(std::span<const std::string> paths) const;
+
     /// @brief ファイルを書き込む
     /// @param path ファイルパス
     /// @param data 書き込むデータ
@@ -100,14 +339,67 @@ public:
     /// @brief 全マウントポイントを解除する
     void Clear();
 
+    /// @brief 見つからなかったパスの記憶を破棄する
+    /// @param path ファイルパス (空なら全て破棄する)
+    void InvalidateLookupCache(const std::string& path = {});
+
+    /// @brief ディスク上のディレクトリの変更を監視し、見つからなかったパスの記憶を破棄する
+    /// @details 呼んだ時点でmountPointにマウントされている索引なしプロバイダーを監視済みとし、
+    ///          そのプロバイダーで見つからなかったパスも記憶するようにする (マウント後に呼ぶこと)。
+    ///          watcherのUpdate()を毎フレーム呼ぶこと。
+    /// @param watcher 変更を通知するFileWatcher
+    /// @param mountPoint directoryを読むプロバイダーのマウントポイント
+    /// @param directory 監視するディレクトリ (PhysicalFileProviderのルート)
+    void WatchDirectory(FileWatcher& watcher, const std::string& mountPoint, const std::string& directory);
+
+    /// 記憶する「見つからなかったパス」の上限 (超えたら全て破棄する)
+    static constexpr size_t k_MaxMissingPaths = 4096;
+
 private:
     FileSystem() = default;
 
     struct MountEntry {
-        std::string mountPoint;
+        std::string mountPoint;                 ///< 正規化済み (区切りは1つの '/'、前後の '/' なし)
         std::shared_ptr<IFileProvider> provider;
+        int priority = 0;                       ///< マウント時のPriority()
+        uint64_t sequence = 0;                  ///< マウント順
+        bool indexed = false;                   ///< m_pathIndexに全ファイルが登録されている
+        bool watched = false;                   ///< WatchDirectory()で変更が通知される
+    };
+
+    /// マウントポイントのトライ木のノード (パスの区切りごとに1段)
+    struct MountNode {
+        std::unordered_map<std::string, std::unique_ptr<MountNode>> children;
+        std::vector<uint32_t> mounts;           ///< このノードにマウントされたm_mountsの番号
     };
-    std::vector<MountEntry> m_mounts;
+
+    std::vector<MountEntry> m_mounts;           ///< 優先度の高い順 (同じ優先度はマウント順)
+    MountNode m_mountRoot;
+    std::unordered_map<std::string, uint32_t> m_pathIndex; ///< 索引済みプロバイダーのパス → 最優先のm_mounts番号
+    uint64_t m_nextSequence = 0;
+    mutable std::shared_mutex m_mountMutex;     ///< マウント表・索引 (読み込みは共有ロック)
+
+    mutable std::unordered_set<std::string> m_missingPaths; ///< どのプロバイダーにも無かったパス
+    mutable uint64_t m_missingGeneration = 0;               ///< 破棄のたびに進む (解決中に破棄された結果を記憶しない)
+    mutable std::mutex m_missingMutex;
+
+    /// m_mountsからトライ木とパス索引を作り直し、見つからなかったパスの記憶を破棄する (m_mountMutex排他ロック)
+    void RebuildMountTable();
+
+    /// パスにマッチしたマウント
+    struct MountMatch {
+        uint32_t mount;                         ///< m_mountsの番号
+        std::string lookupPath;                 ///< マウントポイント相対パス
+    };
+
+    /// 正規化済みパスにマッチするマウントを優先度順に集める (m_mountMutex共有ロック保持)
+    void MatchMounts(const std::string& normalized, std::vector<MountMatch>& matches) const;
+
+    /// パスにマッチするプロバイダーへ優先度順にprobeを試す (probeがtrueを返したら終了、m_mountMutex共有ロック保持)
+    /// probeにはプロバイダーとマウントポイント相対パスが渡る。
+    /// @return いずれかのprobeがtrueを返した場合true
+    bool Resolve(const std::string& path,
+                 const std::function<bool(const IFileProvider&, const std::string&)>& probe) const;
 
     static std::string NormalizePath(const std::string& path);
 };
@@ -2,6 +2,7 @@
 /// @brief GXPAK バンドルプロバイダー実装 — gxloader::PakLoader への委譲
 #include "pch.h"
 #include "IO/PakFileProvider.h"
+#include <numeric>
 
 namespace GX {
 
@@ -10,6 +11,14 @@ bool PakFileProvider::Open(const std::string& pakPath)
     return m_loader.Open(pakPath);
 }
 
+bool PakFileProvider::Open(const std::string& patchPath, const std::string& basePath)
+{
+    auto base = std::make_shared<gxloader::PakLoader>();
+    if (!base->Open(basePath))
+        return false;
+    return m_loader.Open(patchPath, std::move(base));
+}
+
 bool PakFileProvider::Exists(const std::string& path) const
 {
     return m_loader.Contains(path);
@@ -22,4 +31,66 @@ FileData PakFileProvider::Read(const std::string& path) const
     return result;
 }
 
+FileView PakFileProvider::ReadView(const std::string& path) const
+{
+    const gxfmt::GxpakEntry* entry = m_loader.Find(path);
+    return entry ? ReadEntryView(*entry) : FileView{};
+}
+
+FileView PakFileProvider::ReadEntryView(const gxfmt::GxpakEntry& entry) const
+{
+    gxloader::MappedView view = m_loader.ReadView(entry.pathHash);
+    if (view.IsValid())
+        return FileView(view.data, view.size, std::move(view.owner));
+    return FileView::FromVector(m_loader.Read(entry.pathHash));
+}
+
+bool PakFileProvider::GetSize(const std::string& path, size_t& size) const
+{
+    const gxfmt::GxpakEntry* entry = m_loader.Find(path);
+    size = entry ? entry->originalSize : 0;
+    return entry != nullptr;
+}
+
+size_t PakFileProvider::ReadInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    const gxfmt::GxpakEntry* entry = m_loader.Find(path);
+    if (!entry || !m_loader.ReadInto(entry->pathHash, destination))
+        return 0;
+    return entry->originalSize;
+}
+
+void PakFileProvider::ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const
+{
+    const size_t count = (std::min)(paths.size(), results.size());
+    std::vector<const gxfmt::GxpakEntry*> entries(count);
+    for (size_t i = 0; i < count; ++i)
+        entries[i] = m_loader.Find(paths[i]);
+
+    // 先読みをまとめて要求し、データ位置順に取り出す
+    m_loader.Prefetch(entries);
+
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        uint64_t offsetA = entries[a] ? entries[a]->dataOffset : 0;
+        uint64_t offsetB = entries[b] ? entries[b]->dataOffset : 0;
+        return offsetA < offsetB;
+    });
+
+    for (size_t i : order)
+        results[i] = entries[i] ? ReadEntryView(*entries[i]) : FileView{};
+}
+
+bool PakFileProvider::ListFiles(std::vector<std::string>& paths) const
+{
+    const auto entries = m_loader.GetEntries();
+    if (entries.empty())
+        return false;
+    paths.reserve(paths.size() + entries.size());
+    for (const auto& entry : entries)
+        paths.emplace_back(entry.path);
+    return true;
+}
+
 } // namespace GX
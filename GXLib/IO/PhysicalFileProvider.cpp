@@ -1,9 +1,33 @@
 #include "pch.h"
 #include "IO/PhysicalFileProvider.h"
 #include "Core/Logger.h"
+#include <mapped_file.h>
 
 namespace GX {
 
+namespace {
+
+/// ReadBatch()の1件分の非同期読み込み
+/// (ReadFileExはhEventを使わないので、完了ルーチンへ自身を渡すのに使う)
+struct BatchRead
+{
+    OVERLAPPED overlapped = {};
+    HANDLE file = INVALID_HANDLE_VALUE;
+    std::vector<uint8_t> data;
+    size_t index = 0;
+    DWORD error = ERROR_IO_PENDING;     ///< 完了時のエラーコード (ERROR_IO_PENDINGなら未完了)
+    DWORD transferred = 0;
+};
+
+void CALLBACK OnBatchReadComplete(DWORD error, DWORD transferred, LPOVERLAPPED overlapped)
+{
+    auto* read = static_cast<BatchRead*>(overlapped->hEvent);
+    read->error = error;
+    read->transferred = transferred;
+}
+
+} // namespace
+
 PhysicalFileProvider::PhysicalFileProvider(const std::string& rootDir)
     : m_rootDir(rootDir)
 {
@@ -25,24 +49,201 @@ bool PhysicalFileProvider::Exists(const std::string& path) const
 }
 
 FileData PhysicalFileProvider::Read(const std::string& path) const
+{
+    FileData result;
+    TryRead(path, result);
+    return result;
+}
+
+bool PhysicalFileProvider::TryRead(const std::string& path, FileData& data) const
 {
     std::string fullPath = ResolvePath(path);
     std::ifstream file(fullPath, std::ios::binary | std::ios::ate);
     if (!file.is_open())
-        return FileData{};
+        return false;
 
     auto fileSize = file.tellg();
-    if (fileSize <= 0)
-        return FileData{};
+    if (fileSize < 0)
+        return false;
 
-    FileData result;
-    result.data.resize(static_cast<size_t>(fileSize));
-    file.seekg(0);
-    file.read(reinterpret_cast<char*>(result.data.data()), fileSize);
+    data.data.resize(static_cast<size_t>(fileSize));
+    if (fileSize > 0)
+    {
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data.data()), fileSize);
+    }
+    return true;
+}
 
+FileView PhysicalFileProvider::ReadView(const std::string& path) const
+{
+    FileView result;
+    TryReadView(path, result);
     return result;
 }
 
+bool PhysicalFileProvider::TryReadView(const std::string& path, FileView& view) const
+{
+    // 開いたハンドルでサイズを調べ、小さいファイルはそのまま読む
+    std::string fullPath = ResolvePath(path);
+    std::ifstream file(fullPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    auto fileSize = file.tellg();
+    if (fileSize < 0)
+        return false;
+    const size_t size = static_cast<size_t>(fileSize);
+    if (size == 0)
+    {
+        view = FileView{};
+        return true;
+    }
+
+    if (size >= k_MapThreshold)
+    {
+        file.close();
+        if (auto mapped = gxloader::MappedFile::Open(fullPath))
+        {
+            view = FileView(mapped->Data(), static_cast<size_t>(mapped->Size()), mapped);
+            return true;
+        }
+        file.open(fullPath, std::ios::binary);
+        if (!file.is_open())
+            return false;
+    }
+
+    std::vector<uint8_t> data(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), fileSize);
+    view = FileView::FromVector(std::move(data));
+    return true;
+}
+
+bool PhysicalFileProvider::GetSize(const std::string& path, size_t& size) const
+{
+    std::string fullPath = ResolvePath(path);
+    WIN32_FILE_ATTRIBUTE_DATA attrib{};
+    if (!GetFileAttributesExA(fullPath.c_str(), GetFileExInfoStandard, &attrib) ||
+        (attrib.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        size = 0;
+        return false;
+    }
+    size = static_cast<size_t>((static_cast<uint64_t>(attrib.nFileSizeHigh) << 32) | attrib.nFileSizeLow);
+    return true;
+}
+
+size_t PhysicalFileProvider::ReadInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    std::string fullPath = ResolvePath(path);
+    std::ifstream file(fullPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return 0;
+
+    auto fileSize = file.tellg();
+    if (fileSize <= 0 || static_cast<size_t>(fileSize) > destination.size())
+        return 0;
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(destination.data()), fileSize);
+    return file.good() ? static_cast<size_t>(fileSize) : 0;
+}
+
+size_t PhysicalFileProvider::ReadRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const
+{
+    std::string fullPath = ResolvePath(path);
+    std::ifstream file(fullPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return 0;
+
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    if (offset >= fileSize)
+        return 0;
+
+    const size_t length = static_cast<size_t>((std::min<uint64_t>)(destination.size(), fileSize - offset));
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(destination.data()), static_cast<std::streamsize>(length));
+    return file.good() ? length : 0;
+}
+
+void PhysicalFileProvider::ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const
+{
+    const size_t count = (std::min)(paths.size(), results.size());
+
+    // 発行中の読み込みはバッファとOVERLAPPEDのアドレスが動かないよう件数分を先に確保する
+    std::vector<BatchRead> reads(count);
+    std::vector<BatchRead*> inFlight;
+    inFlight.reserve(k_MaxBatchInFlight);
+
+    // 完了ルーチンはアラート可能な待機中にこのスレッドで呼ばれる
+    auto waitForCompletions = [&]() {
+        SleepEx(INFINITE, TRUE);
+        for (auto it = inFlight.begin(); it != inFlight.end(); )
+        {
+            BatchRead* read = *it;
+            if (read->error == ERROR_IO_PENDING)
+            {
+                ++it;
+                continue;
+            }
+            CloseHandle(read->file);
+            read->file = INVALID_HANDLE_VALUE;
+            if (read->error == ERROR_SUCCESS && read->transferred == read->data.size())
+                results[read->index] = FileView::FromVector(std::move(read->data));
+            it = inFlight.erase(it);
+        }
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = FileView{};
+
+        // Read (ifstream) と同じく、他プロセスが書き込み中のファイルも開けるようにする
+        const std::string fullPath = ResolvePath(paths[i]);
+        HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            continue;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            continue;
+        }
+
+        // 大きいファイルはマップする (コピーなし)
+        if (static_cast<uint64_t>(fileSize.QuadPart) >= k_MapThreshold)
+        {
+            CloseHandle(file);
+            results[i] = ReadView(paths[i]);
+            continue;
+        }
+
+        BatchRead& read = reads[i];
+        read.file = file;
+        read.index = i;
+        read.data.resize(static_cast<size_t>(fileSize.QuadPart));
+        read.overlapped.hEvent = &read;
+        if (!ReadFileEx(file, read.data.data(), static_cast<DWORD>(read.data.size()),
+                        &read.overlapped, OnBatchReadComplete))
+        {
+            CloseHandle(file);
+            read.file = INVALID_HANDLE_VALUE;
+            continue;
+        }
+        inFlight.push_back(&read);
+
+        while (inFlight.size() >= k_MaxBatchInFlight)
+            waitForCompletions();
+    }
+
+    // 全ての読み込みが終わるまで戻らない (バッファはこの関数のローカル)
+    while (!inFlight.empty())
+        waitForCompletions();
+}
+
 bool PhysicalFileProvider::Write(const std::string& path, const void* data, size_t size)
 {
     std::string fullPath = ResolvePath(path);
@@ -27,6 +27,40 @@ public:
     /// @return ファイルデータ（失敗時はIsValid()==false）
     FileData Read(const std::string& path) const override;
 
+    /// @brief ファイルを開けたら読み込む (存在確認の stat を省く)
+    bool TryRead(const std::string& path, FileData& data) const override;
+
+    /// @brief ファイルを開けたらビューとして読み込む (ReadView()と同じく大きいファイルはマップする)
+    bool TryReadView(const std::string& path, FileView& view) const override;
+
+    /// @brief ファイルをビューとして読み込む
+    /// @details k_MapThreshold以上のファイルはメモリマップで参照する (コピーなし)。
+    ///          小さいファイルはマップの方が高くつくため通常の読み込みを行う。
+    /// @param path ファイルパス（ルートディレクトリ相対）
+    /// @return ファイルビュー（失敗時はIsValid()==false）
+    FileView ReadView(const std::string& path) const override;
+
+    /// @brief ファイルサイズを取得する (ファイル属性から取得、読み込みなし)
+    bool GetSize(const std::string& path, size_t& size) const override;
+
+    /// @brief バッファへ直接読み込む
+    size_t ReadInto(const std::string& path, std::span<uint8_t> destination) const override;
+
+    /// @brief ファイルの一部を読み込む (シークして必要な部分だけ読む)
+    size_t ReadRange(const std::string& path, uint64_t offset, std::span<uint8_t> destination) const override;
+
+    /// @brief 複数ファイルをまとめて読み込む
+    /// @details 小さいファイルはオーバーラップI/O (ReadFileEx) で最大k_MaxBatchInFlight件を同時に発行し、
+    ///          呼び出しスレッドが完了ルーチンで受け取る (スレッドを増やさずにファイルごとの待ち時間を重ねる)。
+    ///          k_MapThreshold以上のファイルはReadView()と同じくメモリマップする。
+    void ReadBatch(std::span<const std::string> paths, std::span<FileView> results) const override;
+
+    /// @brief これ以上のサイズのファイルはReadViewでメモリマップする (64KB)
+    static constexpr size_t k_MapThreshold = 64 * 1024;
+
+    /// @brief ReadBatchで同時に発行する読み込みの上限
+    static constexpr uint32_t k_MaxBatchInFlight = 32;
+
     /// @brief ファイルを書き込む
     /// @param path ファイルパス（ルートディレクトリ相対）
     /// @param data 書き込むデータ
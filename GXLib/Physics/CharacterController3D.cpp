@@ -0,0 +1,309 @@
+/// @file CharacterController3D.cpp
+/// @brief キャラクターコントローラーの実装
+#include "pch.h"
+#include "Physics/CharacterController3D.h"
+#include "Core/Logger.h"
+
+// Jolt Physics ヘッダー（PIMPLのためここでのみインクルード）
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystem.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Character/CharacterVirtual.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+
+JPH_SUPPRESS_WARNINGS
+
+namespace
+{
+
+inline JPH::Vec3 ToJolt(const GX::Vector3& v) { return JPH::Vec3(v.x, v.y, v.z); }
+inline JPH::Quat ToJolt(const GX::Quaternion& q) { return JPH::Quat(q.x, q.y, q.z, q.w); }
+inline GX::Vector3 FromJoltV(const JPH::Vec3& v) { return { v.GetX(), v.GetY(), v.GetZ() }; }
+inline GX::Vector3 FromJoltR(const JPH::RVec3& v) { return { static_cast<float>(v.GetX()), static_cast<float>(v.GetY()), static_cast<float>(v.GetZ()) }; }
+inline GX::Quaternion FromJoltQ(const JPH::Quat& q) { return { q.GetX(), q.GetY(), q.GetZ(), q.GetW() }; }
+
+/// キャラクターが衝突するオブジェクトレイヤー (PhysicsBodySettings::layer の Moving と同じ)
+constexpr JPH::ObjectLayer k_CharacterLayer = 1;
+
+/// 1ジョブあたりの最小キャラクター数 (これ未満なら分割しない)
+constexpr uint32_t k_MinCharactersPerJob = 16;
+
+/// スレッドごとの一時アロケータ容量
+constexpr uint32_t k_TempAllocatorSize = 2 * 1024 * 1024;
+
+/// 呼び出しスレッド専用の一時アロケータを取得する
+/// (TempAllocatorImplはスレッドセーフではないため、ワーカーごとに持つ)
+JPH::TempAllocator& GetThreadTempAllocator()
+{
+    thread_local JPH::TempAllocatorImpl allocator(k_TempAllocatorSize);
+    return allocator;
+}
+
+} // anonymous namespace
+
+namespace GX
+{
+
+struct CharacterController3D::Impl
+{
+    JPH::Ref<JPH::CharacterVirtual> character;
+    JPH::PhysicsSystem* system = nullptr;
+    CharacterControllerSettings settings;
+
+    /// 重力の加算と ExtendedUpdate を行う (任意のスレッドから呼べる)
+    void Step(float deltaTime, JPH::TempAllocator& allocator)
+    {
+        JPH::CharacterVirtual& ch = *character;
+        const JPH::Vec3 gravity = system->GetGravity();
+
+        ch.UpdateGroundVelocity();
+
+        if (settings.applyGravity)
+        {
+            JPH::Vec3 velocity = ch.GetLinearVelocity();
+            if (ch.GetGroundState() == JPH::CharacterVirtual::EGroundState::OnGround)
+            {
+                // 接地中は地面にめり込む方向の速度だけ打ち消す (ジャンプは残す)
+                const float groundVelY = ch.GetGroundVelocity().GetY();
+                if (velocity.GetY() < groundVelY)
+                    velocity.SetY(groundVelY);
+            }
+            else
+            {
+                velocity += gravity * deltaTime;
+            }
+            ch.SetLinearVelocity(velocity);
+        }
+
+        JPH::CharacterVirtual::ExtendedUpdateSettings updateSettings;
+        updateSettings.mStickToFloorStepDown = JPH::Vec3(0.0f, -settings.stickToFloorDistance, 0.0f);
+        updateSettings.mWalkStairsStepUp = JPH::Vec3(0.0f, settings.maxStepHeight, 0.0f);
+
+        ch.ExtendedUpdate(deltaTime, gravity, updateSettings,
+            system->GetDefaultBroadPhaseLayerFilter(k_CharacterLayer),
+            system->GetDefaultLayerFilter(k_CharacterLayer),
+            JPH::BodyFilter{},
+            JPH::ShapeFilter{},
+            allocator);
+    }
+};
+
+CharacterController3D::CharacterController3D() = default;
+
+CharacterController3D::~CharacterController3D()
+{
+    Destroy();
+}
+
+bool CharacterController3D::Create(PhysicsWorld3D* world, const CharacterControllerSettings& settings,
+                                   const Vector3& position, const Quaternion& rotation)
+{
+    Destroy();
+    if (!world)
+        return false;
+
+    auto* system = static_cast<JPH::PhysicsSystem*>(world->GetInternalSystem());
+    if (!system)
+    {
+        GX_LOG_ERROR("CharacterController3D: PhysicsWorld3D is not initialized");
+        return false;
+    }
+    if (settings.radius <= 0.0f || settings.height <= 0.0f)
+    {
+        GX_LOG_ERROR("CharacterController3D: Invalid capsule dimensions");
+        return false;
+    }
+
+    // カプセルの底面がキャラクター位置に来るよう持ち上げる
+    const float halfHeight = std::max(0.01f, settings.height * 0.5f - settings.radius);
+    JPH::RotatedTranslatedShapeSettings shapeSettings(
+        JPH::Vec3(0.0f, halfHeight + settings.radius, 0.0f),
+        JPH::Quat::sIdentity(),
+        new JPH::CapsuleShape(halfHeight, settings.radius));
+    auto shapeResult = shapeSettings.Create();
+    if (!shapeResult.IsValid())
+    {
+        GX_LOG_ERROR("CharacterController3D: failed to create capsule shape");
+        return false;
+    }
+
+    JPH::CharacterVirtualSettings charSettings;
+    charSettings.mShape = shapeResult.Get();
+    charSettings.mMass = settings.mass;
+    charSettings.mMaxStrength = settings.maxStrength;
+    charSettings.mMaxSlopeAngle = JPH::DegreesToRadians(settings.maxSlopeAngle);
+    charSettings.mCharacterPadding = settings.characterPadding;
+    charSettings.mPredictiveContactDistance = settings.predictiveContactDistance;
+    // 下側の半球で触れた面だけを「支え」として扱う
+    charSettings.mSupportingVolume = JPH::Plane(JPH::Vec3::sAxisY(), -settings.radius);
+
+    m_impl = std::make_unique<Impl>();
+    m_impl->system = system;
+    m_impl->settings = settings;
+    m_impl->character = new JPH::CharacterVirtual(&charSettings,
+        JPH::RVec3(position.x, position.y, position.z),
+        ToJolt(rotation),
+        static_cast<JPH::uint64>(reinterpret_cast<uintptr_t>(settings.userData)),
+        system);
+
+    m_world = world;
+    return true;
+}
+
+void CharacterController3D::Destroy()
+{
+    m_impl.reset();
+    m_world = nullptr;
+}
+
+bool CharacterController3D::IsValid() const
+{
+    return m_impl && m_impl->character != nullptr;
+}
+
+void CharacterController3D::Update(float deltaTime)
+{
+    if (!IsValid() || deltaTime <= 0.0f)
+        return;
+    m_impl->Step(deltaTime, GetThreadTempAllocator());
+}
+
+bool CharacterController3D::UpdateBatch(CharacterController3D* const* controllers, uint32_t count, float deltaTime)
+{
+    if (!controllers || count == 0 || deltaTime <= 0.0f)
+        return true;
+
+    // 件数によって処理経路が変わっても結果が同じになるよう、ワールドの混在は先に弾く
+    PhysicsWorld3D* world = nullptr;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const CharacterController3D* c = controllers[i];
+        if (!c || !c->IsValid())
+            continue;
+        if (!world)
+            world = c->m_world;
+        else if (c->m_world != world)
+        {
+            GX_LOG_ERROR("CharacterController3D: UpdateBatch called with controllers from different worlds");
+            return false;
+        }
+    }
+    if (!world)
+        return true;
+
+    auto* jobSystem = static_cast<JPH::JobSystem*>(world->GetInternalJobSystem());
+    if (!jobSystem || count < k_MinCharactersPerJob * 2)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (controllers[i])
+                controllers[i]->Update(deltaTime);
+        }
+        return true;
+    }
+
+    // キャラクター同士は干渉しないので、連続区間ごとにジョブへ分割する
+    const uint32_t maxJobs = static_cast<uint32_t>(std::max(1, jobSystem->GetMaxConcurrency()));
+    const uint32_t numJobs = std::min(maxJobs, count / k_MinCharactersPerJob);
+    const uint32_t perJob = (count + numJobs - 1) / numJobs;
+
+    JPH::JobSystem::Barrier* barrier = jobSystem->CreateBarrier();
+    for (uint32_t begin = 0; begin < count; begin += perJob)
+    {
+        const uint32_t end = std::min(count, begin + perJob);
+        JPH::JobHandle job = jobSystem->CreateJob("CharacterController3D", JPH::Color::sGreen,
+            [controllers, begin, end, deltaTime]()
+            {
+                JPH::TempAllocator& allocator = GetThreadTempAllocator();
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    CharacterController3D* c = controllers[i];
+                    if (c && c->IsValid())
+                        c->m_impl->Step(deltaTime, allocator);
+                }
+            });
+        barrier->AddJob(job);
+    }
+    jobSystem->WaitForJobs(barrier);
+    jobSystem->DestroyBarrier(barrier);
+    return true;
+}
+
+void CharacterController3D::SetPosition(const Vector3& pos)
+{
+    if (!IsValid()) return;
+    m_impl->character->SetPosition(JPH::RVec3(pos.x, pos.y, pos.z));
+}
+
+Vector3 CharacterController3D::GetPosition() const
+{
+    if (!IsValid()) return {};
+    return FromJoltR(m_impl->character->GetPosition());
+}
+
+void CharacterController3D::SetRotation(const Quaternion& rot)
+{
+    if (!IsValid()) return;
+    m_impl->character->SetRotation(ToJolt(rot));
+}
+
+Quaternion CharacterController3D::GetRotation() const
+{
+    if (!IsValid()) return {};
+    return FromJoltQ(m_impl->character->GetRotation());
+}
+
+void CharacterController3D::SetLinearVelocity(const Vector3& vel)
+{
+    if (!IsValid()) return;
+    m_impl->character->SetLinearVelocity(ToJolt(vel));
+}
+
+Vector3 CharacterController3D::GetLinearVelocity() const
+{
+    if (!IsValid()) return {};
+    return FromJoltV(m_impl->character->GetLinearVelocity());
+}
+
+CharacterGroundState CharacterController3D::GetGroundState() const
+{
+    if (!IsValid()) return CharacterGroundState::InAir;
+    switch (m_impl->character->GetGroundState())
+    {
+    case JPH::CharacterVirtual::EGroundState::OnGround:      return CharacterGroundState::OnGround;
+    case JPH::CharacterVirtual::EGroundState::OnSteepGround: return CharacterGroundState::OnSteepGround;
+    case JPH::CharacterVirtual::EGroundState::NotSupported:  return CharacterGroundState::NotSupported;
+    default:                                                 return CharacterGroundState::InAir;
+    }
+}
+
+Vector3 CharacterController3D::GetGroundNormal() const
+{
+    if (!IsValid()) return {};
+    return FromJoltV(m_impl->character->GetGroundNormal());
+}
+
+Vector3 CharacterController3D::GetGroundVelocity() const
+{
+    if (!IsValid()) return {};
+    return FromJoltV(m_impl->character->GetGroundVelocity());
+}
+
+PhysicsBodyID CharacterController3D::GetGroundBody() const
+{
+    PhysicsBodyID result;
+    if (!IsValid()) return result;
+    const JPH::BodyID groundID = m_impl->character->GetGroundBodyID();
+    if (!groundID.IsInvalid())
+        result.id = groundID.GetIndexAndSequenceNumber();
+    return result;
+}
+
+void* CharacterController3D::GetUserData() const
+{
+    return IsValid() ? m_impl->settings.userData : nullptr;
+}
+
+} // namespace GX
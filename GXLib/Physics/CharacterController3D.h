@@ -0,0 +1,143 @@
+#pragma once
+/// @file CharacterController3D.h
+/// @brief カプセル型キャラクターコントローラー (JPH::CharacterVirtual ラッパー)
+///
+/// 物理ボディを持たない「仮想キャラクター」をPhysicsWorld3D上で移動させる。
+/// 接地判定は移動時の接触情報から求めるため、足元へのレイキャストを何本も
+/// 飛ばす必要がない。階段の昇降・斜面の角度制限・地面への吸着に対応する。
+///
+/// @note 所属するPhysicsWorld3DのStep()と同時に Update()/UpdateBatch() を呼ばないこと。
+
+#include "Physics/PhysicsWorld3D.h"
+
+namespace GX
+{
+
+/// @brief キャラクターの接地状態
+enum class CharacterGroundState
+{
+    OnGround,       ///< 歩ける地面の上にいる
+    OnSteepGround,  ///< 急斜面 (maxSlopeAngle超) に接している
+    NotSupported,   ///< 何かに触れているが支えられていない
+    InAir           ///< 空中
+};
+
+/// @brief キャラクターコントローラーの作成設定
+struct CharacterControllerSettings
+{
+    float radius = 0.3f;                ///< カプセル半径
+    float height = 1.8f;                ///< カプセル全高 (半球を含む)
+    float mass = 70.0f;                 ///< 質量 (押した剛体への影響に使用)
+    float maxStrength = 100.0f;         ///< 剛体を押す最大の力 (N)
+    float maxSlopeAngle = 45.0f;        ///< 歩ける最大斜面角度 (度)
+    float maxStepHeight = 0.4f;         ///< 自動で登れる段差の高さ (0で階段処理なし)
+    float stickToFloorDistance = 0.5f;  ///< 下り坂で地面に吸着する距離 (0で吸着なし)
+    float characterPadding = 0.02f;     ///< 形状と周囲との間に保つ余白
+    float predictiveContactDistance = 0.1f; ///< 先読みで接触を集める距離
+    bool applyGravity = true;           ///< 空中でワールドの重力を速度に加算するか
+    void* userData = nullptr;           ///< ユーザー任意データポインタ
+};
+
+/// @brief カプセル型キャラクターコントローラー
+///
+/// Create()で作成し、毎フレーム SetLinearVelocity() で希望速度を与えてから
+/// Update() (多数ある場合は UpdateBatch()) を呼ぶ。
+class CharacterController3D
+{
+public:
+    CharacterController3D();
+    ~CharacterController3D();
+
+    CharacterController3D(const CharacterController3D&) = delete;
+    CharacterController3D& operator=(const CharacterController3D&) = delete;
+
+    /// @brief キャラクターを作成する
+    /// @param world 物理ワールド (初期化済みであること)
+    /// @param settings 作成設定
+    /// @param position 初期位置 (カプセル底面の位置)
+    /// @param rotation 初期回転
+    /// @return 作成に成功した場合true
+    bool Create(PhysicsWorld3D* world, const CharacterControllerSettings& settings,
+                const Vector3& position, const Quaternion& rotation = {});
+
+    /// @brief キャラクターを破棄する
+    void Destroy();
+
+    /// @brief 有効なキャラクターかどうか判定する
+    /// @return 有効ならtrue
+    bool IsValid() const;
+
+    /// @brief キャラクターを1ステップ移動させる
+    /// @param deltaTime 経過時間 (秒)
+    void Update(float deltaTime);
+
+    /// @brief 複数のキャラクターをまとめて移動させる
+    ///
+    /// 物理ワールドのジョブシステムに分配して並列に処理する。
+    /// 全員が同じPhysicsWorld3Dに属している必要があり、混在している場合は誰も更新しない。
+    /// キャラクター同士の衝突は解決しない (剛体・静的形状とのみ衝突する)。
+    /// @param controllers コントローラー配列 (nullptr/無効な要素はスキップ)
+    /// @param count 要素数
+    /// @param deltaTime 経過時間 (秒)
+    /// @return 異なるワールドのコントローラーが混在していた場合false
+    static bool UpdateBatch(CharacterController3D* const* controllers, uint32_t count, float deltaTime);
+
+    /// @brief 位置を設定する (テレポート)
+    /// @param pos 新しい位置
+    void SetPosition(const Vector3& pos);
+
+    /// @brief 現在の位置を取得する
+    /// @return カプセル底面の位置
+    Vector3 GetPosition() const;
+
+    /// @brief 回転を設定する
+    /// @param rot 新しい回転クォータニオン
+    void SetRotation(const Quaternion& rot);
+
+    /// @brief 現在の回転を取得する
+    /// @return 回転クォータニオン
+    Quaternion GetRotation() const;
+
+    /// @brief 線速度を設定する (次のUpdate()で適用)
+    /// @param vel 線速度ベクトル
+    void SetLinearVelocity(const Vector3& vel);
+
+    /// @brief 現在の線速度を取得する
+    /// @return 線速度ベクトル
+    Vector3 GetLinearVelocity() const;
+
+    /// @brief 直近のUpdate()時点の接地状態を取得する
+    /// @return 接地状態
+    CharacterGroundState GetGroundState() const;
+
+    /// @brief 歩ける地面の上にいるかどうか判定する
+    /// @return 接地していればtrue
+    bool IsOnGround() const { return GetGroundState() == CharacterGroundState::OnGround; }
+
+    /// @brief 接地面の法線を取得する
+    /// @return 法線 (空中では不定)
+    Vector3 GetGroundNormal() const;
+
+    /// @brief 接地面の速度を取得する (動く床の上で使用)
+    /// @return 地面の速度
+    Vector3 GetGroundVelocity() const;
+
+    /// @brief 接地しているボディのIDを取得する
+    /// @return ボディID (空中なら無効ID)
+    PhysicsBodyID GetGroundBody() const;
+
+    /// @brief 作成時に指定したユーザーデータを取得する
+    /// @return ユーザーデータ
+    void* GetUserData() const;
+
+    /// @brief 所属する物理ワールドを取得する
+    /// @return 物理ワールドへのポインタ
+    PhysicsWorld3D* GetWorld() const { return m_world; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+    PhysicsWorld3D* m_world = nullptr;  ///< 所属する物理ワールド
+};
+
+} // namespace GX
@@ -0,0 +1,542 @@
+/// @file ConvexDecomposition.cpp
+/// @brief 近似凸分解の実装
+#include "pch.h"
+#include "Physics/ConvexDecomposition.h"
+#include "Core/Logger.h"
+#include "IO/FileSystem.h"
+#include <limits>
+#include <unordered_set>
+
+// 凸包の体積計算と頂点削減に Jolt の ConvexHullBuilder を使う
+#include <Jolt/Jolt.h>
+#include <Jolt/Geometry/ConvexHullBuilder.h>
+
+JPH_SUPPRESS_WARNINGS
+
+namespace GX
+{
+
+namespace
+{
+
+constexpr uint32_t k_CacheMagic   = 0x44435847; // "GXCD"
+constexpr uint32_t k_CacheVersion = 1;
+
+/// キャッシュから読むパーツ数と1パーツの頂点数の上限 (壊れたファイルで巨大な確保をしない)
+constexpr uint32_t k_MaxCachedHulls        = 1024;
+constexpr uint32_t k_MaxCachedHullVertices = 4096;
+
+/// 1軸あたりの分割平面の候補数
+constexpr int k_SplitCandidatesPerAxis = 7;
+
+struct Voxel
+{
+    uint16_t x, y, z;
+};
+
+struct VoxelGrid
+{
+    int      dim[3] = { 0, 0, 0 };
+    float    size = 1.0f;
+    XMFLOAT3 origin = { 0.0f, 0.0f, 0.0f };
+
+    size_t Index(int x, int y, int z) const
+    {
+        return (static_cast<size_t>(z) * dim[1] + y) * dim[0] + x;
+    }
+};
+
+/// 分解途中のパーツ
+struct Part
+{
+    std::vector<Voxel> voxels;
+    float concavity = 0.0f;
+    bool  splittable = true;
+};
+
+/// メッシュをボクセル化し、内部を塗りつぶしたボクセル集合を返す
+bool Voxelize(const Vector3* vertices, uint32_t vertexCount,
+              const uint32_t* indices, uint32_t indexCount,
+              uint32_t resolution, VoxelGrid& grid, std::vector<Voxel>& outVoxels)
+{
+    XMFLOAT3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    XMFLOAT3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        bmin.x = std::min(bmin.x, vertices[i].x); bmax.x = std::max(bmax.x, vertices[i].x);
+        bmin.y = std::min(bmin.y, vertices[i].y); bmax.y = std::max(bmax.y, vertices[i].y);
+        bmin.z = std::min(bmin.z, vertices[i].z); bmax.z = std::max(bmax.z, vertices[i].z);
+    }
+    const float extent[3] = { bmax.x - bmin.x, bmax.y - bmin.y, bmax.z - bmin.z };
+    const float longest = std::max({ extent[0], extent[1], extent[2] });
+    if (longest <= 0.0f)
+        return false;
+
+    resolution = std::clamp(resolution, 4u, 256u);
+    grid.size = longest / static_cast<float>(resolution);
+    // 外側の塗りつぶしのため、周囲に1ボクセルの余白を取る
+    grid.origin = { bmin.x - grid.size, bmin.y - grid.size, bmin.z - grid.size };
+    for (int a = 0; a < 3; ++a)
+        grid.dim[a] = static_cast<int>(std::ceil(extent[a] / grid.size)) + 3;
+
+    enum : uint8_t { Empty = 0, Surface = 1, Outside = 2 };
+    std::vector<uint8_t> cells(static_cast<size_t>(grid.dim[0]) * grid.dim[1] * grid.dim[2], Empty);
+
+    auto mark = [&](const XMVECTOR& p)
+    {
+        XMFLOAT3 f;
+        XMStoreFloat3(&f, p);
+        int c[3] = {
+            static_cast<int>((f.x - grid.origin.x) / grid.size),
+            static_cast<int>((f.y - grid.origin.y) / grid.size),
+            static_cast<int>((f.z - grid.origin.z) / grid.size)
+        };
+        for (int a = 0; a < 3; ++a)
+            c[a] = std::clamp(c[a], 1, grid.dim[a] - 2);
+        cells[grid.Index(c[0], c[1], c[2])] = Surface;
+    };
+
+    // 表面: 三角形をボクセルの半分の間隔でサンプリングして塗る
+    const float step = grid.size * 0.5f;
+    for (uint32_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        if (indices[t] >= vertexCount || indices[t + 1] >= vertexCount || indices[t + 2] >= vertexCount)
+            continue;
+        XMVECTOR a = XMLoadFloat3(&vertices[indices[t]]);
+        XMVECTOR b = XMLoadFloat3(&vertices[indices[t + 1]]);
+        XMVECTOR c = XMLoadFloat3(&vertices[indices[t + 2]]);
+        const float maxEdge = std::max({
+            XMVectorGetX(XMVector3Length(b - a)),
+            XMVectorGetX(XMVector3Length(c - a)),
+            XMVectorGetX(XMVector3Length(c - b)) });
+        const int n = std::max(1, static_cast<int>(std::ceil(maxEdge / step)));
+        const float inv = 1.0f / static_cast<float>(n);
+        for (int i = 0; i <= n; ++i)
+        {
+            for (int j = 0; i + j <= n; ++j)
+                mark(a + (b - a) * (i * inv) + (c - a) * (j * inv));
+        }
+    }
+
+    // 外側: 角から塗りつぶし、届かなかった空セルを内部とみなす
+    std::vector<size_t> stack;
+    stack.push_back(0);
+    cells[0] = Outside;
+    while (!stack.empty())
+    {
+        const size_t idx = stack.back();
+        stack.pop_back();
+        const int x = static_cast<int>(idx % grid.dim[0]);
+        const int y = static_cast<int>((idx / grid.dim[0]) % grid.dim[1]);
+        const int z = static_cast<int>(idx / (static_cast<size_t>(grid.dim[0]) * grid.dim[1]));
+        const int nb[6][3] = {
+            { x - 1, y, z }, { x + 1, y, z },
+            { x, y - 1, z }, { x, y + 1, z },
+            { x, y, z - 1 }, { x, y, z + 1 }
+        };
+        for (const auto& n : nb)
+        {
+            if (n[0] < 0 || n[1] < 0 || n[2] < 0 ||
+                n[0] >= grid.dim[0] || n[1] >= grid.dim[1] || n[2] >= grid.dim[2])
+                continue;
+            const size_t ni = grid.Index(n[0], n[1], n[2]);
+            if (cells[ni] != Empty)
+                continue;
+            cells[ni] = Outside;
+            stack.push_back(ni);
+        }
+    }
+
+    outVoxels.clear();
+    for (int z = 0; z < grid.dim[2]; ++z)
+    {
+        for (int y = 0; y < grid.dim[1]; ++y)
+        {
+            for (int x = 0; x < grid.dim[0]; ++x)
+            {
+                if (cells[grid.Index(x, y, z)] != Outside)
+                    outVoxels.push_back({ static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(z) });
+            }
+        }
+    }
+    return !outVoxels.empty();
+}
+
+/// ボクセル集合の凸包を張る点を集める
+/// X方向の各行について両端ボクセルの角だけを使えば、全ボクセルの凸包と一致する
+void CollectHullPoints(const VoxelGrid& grid, const std::vector<Voxel>& voxels, JPH::Array<JPH::Vec3>& outPoints)
+{
+    std::unordered_map<uint32_t, std::pair<uint16_t, uint16_t>> rows;
+    rows.reserve(voxels.size() / 4 + 1);
+    for (const Voxel& v : voxels)
+    {
+        const uint32_t key = (static_cast<uint32_t>(v.z) << 16) | v.y;
+        auto [it, inserted] = rows.try_emplace(key, v.x, v.x);
+        if (!inserted)
+        {
+            it->second.first = std::min(it->second.first, v.x);
+            it->second.second = std::max(it->second.second, v.x);
+        }
+    }
+
+    // 隣接行で共有される角は整数座標で重複を除く
+    std::unordered_set<uint64_t> corners;
+    corners.reserve(rows.size() * 8);
+    for (const auto& [key, range] : rows)
+    {
+        const uint64_t y = key & 0xFFFF;
+        const uint64_t z = key >> 16;
+        const uint64_t xs[2] = { range.first, static_cast<uint64_t>(range.second) + 1 };
+        for (uint64_t x : xs)
+        {
+            for (uint64_t dy = 0; dy < 2; ++dy)
+            {
+                for (uint64_t dz = 0; dz < 2; ++dz)
+                    corners.insert(x | ((y + dy) << 20) | ((z + dz) << 40));
+            }
+        }
+    }
+
+    outPoints.clear();
+    outPoints.reserve(corners.size());
+    for (uint64_t c : corners)
+    {
+        const float x = static_cast<float>(c & 0xFFFFF);
+        const float y = static_cast<float>((c >> 20) & 0xFFFFF);
+        const float z = static_cast<float>(c >> 40);
+        outPoints.push_back(JPH::Vec3(grid.origin.x + x * grid.size,
+                                      grid.origin.y + y * grid.size,
+                                      grid.origin.z + z * grid.size));
+    }
+}
+
+float ComputeHullVolume(const JPH::Array<JPH::Vec3>& points, float tolerance)
+{
+    if (points.size() < 4)
+        return 0.0f;
+
+    JPH::ConvexHullBuilder builder(points);
+    const char* error = nullptr;
+    auto result = builder.Initialize(std::numeric_limits<int>::max(), tolerance, error);
+    if (result != JPH::ConvexHullBuilder::EResult::Success &&
+        result != JPH::ConvexHullBuilder::EResult::MaxVerticesReached)
+        return 0.0f;
+
+    JPH::Vec3 centerOfMass;
+    float volume = 0.0f;
+    builder.GetCenterOfMassAndVolume(centerOfMass, volume);
+    return volume;
+}
+
+/// パーツの凹み = (凸包体積 - ボクセル体積) / 全体積
+float ComputeConcavity(const VoxelGrid& grid, const std::vector<Voxel>& voxels,
+                       float totalVolume, JPH::Array<JPH::Vec3>& scratch)
+{
+    CollectHullPoints(grid, voxels, scratch);
+    const float voxelVolume = grid.size * grid.size * grid.size;
+    const float hullVolume = ComputeHullVolume(scratch, grid.size * 0.01f);
+    const float solidVolume = static_cast<float>(voxels.size()) * voxelVolume;
+    return std::max(0.0f, hullVolume - solidVolume) / totalVolume;
+}
+
+/// 凹みの合計が最小になる軸平行平面で分割する
+bool SplitPart(const VoxelGrid& grid, const Part& part, float totalVolume,
+               Part& outLeft, Part& outRight)
+{
+    uint16_t lo[3] = { 0xFFFF, 0xFFFF, 0xFFFF };
+    uint16_t hi[3] = { 0, 0, 0 };
+    for (const Voxel& v : part.voxels)
+    {
+        const uint16_t c[3] = { v.x, v.y, v.z };
+        for (int a = 0; a < 3; ++a)
+        {
+            lo[a] = std::min(lo[a], c[a]);
+            hi[a] = std::max(hi[a], c[a]);
+        }
+    }
+
+    JPH::Array<JPH::Vec3> scratch;
+    std::vector<Voxel> left, right;
+    float bestCost = FLT_MAX;
+    bool found = false;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int span = hi[axis] - lo[axis];
+        if (span <= 0)
+            continue;
+        const int numCandidates = std::min(k_SplitCandidatesPerAxis, span);
+        for (int i = 1; i <= numCandidates; ++i)
+        {
+            // lo < plane <= hi となる位置 (座標が plane 未満なら左)
+            const int plane = lo[axis] + (span * i + numCandidates) / (numCandidates + 1);
+            left.clear();
+            right.clear();
+            for (const Voxel& v : part.voxels)
+            {
+                const uint16_t c = (axis == 0) ? v.x : (axis == 1) ? v.y : v.z;
+                (c < plane ? left : right).push_back(v);
+            }
+            if (left.empty() || right.empty())
+                continue;
+
+            const float leftConcavity = ComputeConcavity(grid, left, totalVolume, scratch);
+            const float rightConcavity = ComputeConcavity(grid, right, totalVolume, scratch);
+            const float cost = leftConcavity + rightConcavity;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                found = true;
+                outLeft.voxels = left;
+                outLeft.concavity = leftConcavity;
+                outRight.voxels = right;
+                outRight.concavity = rightConcavity;
+            }
+        }
+    }
+    return found;
+}
+
+/// 凸包を頂点数上限つきで作り、面に使われた頂点だけを取り出す
+bool BuildHullVertices(const JPH::Array<JPH::Vec3>& points, uint32_t maxVertices,
+                       float tolerance, std::vector<Vector3>& outHull)
+{
+    if (points.size() < 4)
+        return false;
+
+    JPH::ConvexHullBuilder builder(points);
+    const char* error = nullptr;
+    auto result = builder.Initialize(static_cast<int>(std::max(maxVertices, 4u)), tolerance, error);
+    if (result != JPH::ConvexHullBuilder::EResult::Success &&
+        result != JPH::ConvexHullBuilder::EResult::MaxVerticesReached)
+        return false;
+
+    std::vector<bool> used(points.size(), false);
+    for (const JPH::ConvexHullBuilder::Face* face : builder.GetFaces())
+    {
+        if (face->mRemoved)
+            continue;
+        const JPH::ConvexHullBuilder::Edge* edge = face->mFirstEdge;
+        do
+        {
+            used[edge->mStartIdx] = true;
+            edge = edge->mNextEdge;
+        } while (edge != face->mFirstEdge);
+    }
+
+    outHull.clear();
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        if (used[i])
+            outHull.push_back({ points[i].GetX(), points[i].GetY(), points[i].GetZ() });
+    }
+    return outHull.size() >= 4;
+}
+
+/// FNV-1a 64bit
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+namespace ConvexDecomposition {
+
+bool Decompose(const Vector3* vertices, uint32_t vertexCount,
+               const uint32_t* indices, uint32_t indexCount,
+               const ConvexDecompositionDesc& desc,
+               std::vector<std::vector<Vector3>>& outHulls)
+{
+    outHulls.clear();
+    if (!vertices || vertexCount == 0 || !indices || indexCount < 3)
+        return false;
+
+    VoxelGrid grid;
+    Part root;
+    if (!Voxelize(vertices, vertexCount, indices, indexCount, desc.resolution, grid, root.voxels))
+        return false;
+
+    const float totalVolume = static_cast<float>(root.voxels.size()) * grid.size * grid.size * grid.size;
+    JPH::Array<JPH::Vec3> scratch;
+    root.concavity = ComputeConcavity(grid, root.voxels, totalVolume, scratch);
+
+    std::vector<Part> parts;
+    parts.push_back(std::move(root));
+
+    // 最も凹んだパーツから順に、上限数か許容値に達するまで分割する
+    const uint32_t maxParts = std::max(desc.maxParts, 1u);
+    while (parts.size() < maxParts)
+    {
+        size_t worst = parts.size();
+        for (size_t i = 0; i < parts.size(); ++i)
+        {
+            if (!parts[i].splittable || parts[i].voxels.size() < 2)
+                continue;
+            if (worst == parts.size() || parts[i].concavity > parts[worst].concavity)
+                worst = i;
+        }
+        if (worst == parts.size() || parts[worst].concavity <= desc.maxConcavity)
+            break;
+
+        Part left, right;
+        if (!SplitPart(grid, parts[worst], totalVolume, left, right))
+        {
+            parts[worst].splittable = false;
+            continue;
+        }
+        parts[worst] = std::move(left);
+        parts.push_back(std::move(right));
+    }
+
+    for (const Part& part : parts)
+    {
+        CollectHullPoints(grid, part.voxels, scratch);
+        std::vector<Vector3> hull;
+        if (BuildHullVertices(scratch, desc.maxHullVertices, grid.size * 0.01f, hull))
+            outHulls.push_back(std::move(hull));
+    }
+
+    if (outHulls.empty())
+    {
+        GX_LOG_WARN("ConvexDecomposition: failed to produce any convex part");
+        return false;
+    }
+    return true;
+}
+
+uint64_t ComputeSourceHash(const Vector3* vertices, uint32_t vertexCount,
+                           const uint32_t* indices, uint32_t indexCount,
+                           const ConvexDecompositionDesc& desc)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = HashBytes(hash, &k_CacheVersion, sizeof(k_CacheVersion));
+    if (vertices)
+        hash = HashBytes(hash, vertices, sizeof(Vector3) * vertexCount);
+    if (indices)
+        hash = HashBytes(hash, indices, sizeof(uint32_t) * indexCount);
+    hash = HashBytes(hash, &desc.resolution, sizeof(desc.resolution));
+    hash = HashBytes(hash, &desc.maxParts, sizeof(desc.maxParts));
+    hash = HashBytes(hash, &desc.maxConcavity, sizeof(desc.maxConcavity));
+    hash = HashBytes(hash, &desc.maxHullVertices, sizeof(desc.maxHullVertices));
+    return hash;
+}
+
+std::string GetCachePath(const std::string& modelPath)
+{
+    const size_t slash = modelPath.find_last_of("/\\");
+    const size_t dot = modelPath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return modelPath + ".gxcd";
+    return modelPath.substr(0, dot) + ".gxcd";
+}
+
+bool SaveCache(const std::string& path, uint64_t sourceHash,
+               const std::vector<std::vector<Vector3>>& hulls)
+{
+    const uint32_t hullCount = static_cast<uint32_t>(hulls.size());
+    std::vector<uint8_t> blob;
+    auto append = [&blob](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        blob.insert(blob.end(), bytes, bytes + size);
+    };
+    append(&k_CacheMagic, sizeof(k_CacheMagic));
+    append(&k_CacheVersion, sizeof(k_CacheVersion));
+    append(&sourceHash, sizeof(sourceHash));
+    append(&hullCount, sizeof(hullCount));
+    for (const auto& hull : hulls)
+    {
+        const uint32_t count = static_cast<uint32_t>(hull.size());
+        append(&count, sizeof(count));
+        append(hull.data(), sizeof(Vector3) * count);
+    }
+
+    // マウント先 (書き込み可能なディレクトリ) を優先し、無ければ直接書く
+    if (FileSystem::Instance().WriteFile(path, blob.data(), blob.size()))
+        return true;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open())
+    {
+        GX_LOG_ERROR("ConvexDecomposition: Cannot write cache: %s", path.c_str());
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    return out.good();
+}
+
+bool LoadCache(const std::string& path, uint64_t sourceHash,
+               std::vector<std::vector<Vector3>>& outHulls)
+{
+    outHulls.clear();
+
+    // .gxpak等にマウントされたモデルの隣のキャッシュも見つかるようFileSystem経由で読む
+    FileView view;
+    std::vector<uint8_t> direct;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (FileSystem::Instance().TryReadFileView(path, view))
+    {
+        data = view.Data();
+        size = view.Size();
+    }
+    else
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in.is_open())
+            return false;
+        direct.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(direct.data()), static_cast<std::streamsize>(direct.size()));
+        if (!in)
+            return false;
+        data = direct.data();
+        size = direct.size();
+    }
+
+    size_t pos = 0;
+    auto read = [&](void* dst, size_t bytes) {
+        if (bytes > size - pos)
+            return false;
+        memcpy(dst, data + pos, bytes);
+        pos += bytes;
+        return true;
+    };
+
+    uint32_t magic = 0, version = 0, hullCount = 0;
+    uint64_t hash = 0;
+    if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version)) ||
+        !read(&hash, sizeof(hash)) || !read(&hullCount, sizeof(hullCount)))
+        return false;
+    if (magic != k_CacheMagic || version != k_CacheVersion || hash != sourceHash ||
+        hullCount > k_MaxCachedHulls)
+        return false;
+
+    outHulls.resize(hullCount);
+    for (auto& hull : outHulls)
+    {
+        uint32_t count = 0;
+        if (!read(&count, sizeof(count)) || count > k_MaxCachedHullVertices)
+        {
+            outHulls.clear();
+            return false;
+        }
+        hull.resize(count);
+        if (!read(hull.data(), sizeof(Vector3) * count))
+        {
+            outHulls.clear();
+            return false;
+        }
+    }
+    return !outHulls.empty();
+}
+
+} // namespace ConvexDecomposition
+
+} // namespace GX
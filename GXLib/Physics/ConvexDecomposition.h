@@ -0,0 +1,74 @@
+#pragma once
+/// @file ConvexDecomposition.h
+/// @brief 近似凸分解（V-HACD風）とディスクキャッシュ
+///
+/// 凹形状のメッシュをボクセル化し、凹みが大きいパーツを軸平行な平面で
+/// 再帰的に分割して、複数の凸包の集合で近似する。
+/// 動的ボディでも三角形メッシュの当たり判定コストを払わずに凹形状を扱える。
+
+#include "Math/Vector3.h"
+
+namespace GX
+{
+
+/// @brief 凸分解の設定
+struct ConvexDecompositionDesc
+{
+    uint32_t resolution = 32;       ///< ボクセル化の解像度（最長辺のボクセル数）
+    uint32_t maxParts = 16;         ///< 凸パーツ数の上限
+    float maxConcavity = 0.01f;     ///< 許容する凹み（全体積に対する「凸包体積-実体積」の比率）
+    uint32_t maxHullVertices = 32;  ///< 1パーツの凸包頂点数の上限
+};
+
+/// @brief 近似凸分解ユーティリティ
+///
+/// Decompose() の結果は SaveCache()/LoadCache() でモデルの隣に保存できる。
+/// 入力メッシュと設定のハッシュを記録し、変わっていればキャッシュを無効とみなす。
+namespace ConvexDecomposition {
+
+    /// @brief 三角形メッシュを凸パーツに分解する
+    /// @note Jolt のアロケータを使うため、PhysicsWorld3D の初期化後に呼ぶこと
+    /// @param vertices 頂点配列
+    /// @param vertexCount 頂点数
+    /// @param indices インデックス配列（3つで1三角形）
+    /// @param indexCount インデックス数
+    /// @param desc 分解設定
+    /// @param outHulls 出力: パーツごとの凸包頂点
+    /// @return 1つ以上のパーツが得られた場合true
+    bool Decompose(const Vector3* vertices, uint32_t vertexCount,
+                   const uint32_t* indices, uint32_t indexCount,
+                   const ConvexDecompositionDesc& desc,
+                   std::vector<std::vector<Vector3>>& outHulls);
+
+    /// @brief 入力メッシュと設定からキャッシュ照合用のハッシュを計算する
+    /// @return 64bitハッシュ
+    uint64_t ComputeSourceHash(const Vector3* vertices, uint32_t vertexCount,
+                               const uint32_t* indices, uint32_t indexCount,
+                               const ConvexDecompositionDesc& desc);
+
+    /// @brief モデルのパスから既定のキャッシュパスを作る（拡張子を .gxcd に置き換え）
+    /// @param modelPath モデルファイルのパス（例: "Assets/crate.gxmd"）
+    /// @return キャッシュパス（例: "Assets/crate.gxcd"）
+    std::string GetCachePath(const std::string& modelPath);
+
+    /// @brief 分解結果をキャッシュファイルに保存する
+    /// @details FileSystem::WriteFile() で書き、書き込めるマウントが無ければ直接ファイルに書く。
+    /// @param path 保存先
+    /// @param sourceHash ComputeSourceHash() の値
+    /// @param hulls 分解結果
+    /// @return 成功時true
+    bool SaveCache(const std::string& path, uint64_t sourceHash,
+                   const std::vector<std::vector<Vector3>>& hulls);
+
+    /// @brief キャッシュファイルから分解結果を読み込む
+    /// @details FileSystem経由で読むため、.gxpak等にマウントしたモデルの隣のキャッシュも使える。
+    /// @param path キャッシュファイル
+    /// @param sourceHash 期待するハッシュ（一致しなければ失敗）
+    /// @param outHulls 出力: 分解結果
+    /// @return 有効なキャッシュを読めた場合true
+    bool LoadCache(const std::string& path, uint64_t sourceHash,
+                   std::vector<std::vector<Vector3>>& outHulls);
+
+} // namespace ConvexDecomposition
+
+} // namespace GX
@@ -2,6 +2,7 @@
 /// @brief メッシュコライダーヘルパーの実装
 #include "pch.h"
 #include "Physics/MeshCollider.h"
+#include "Core/Logger.h"
 #include "Graphics/3D/Model.h"
 #include "Graphics/3D/Animator.h"
 #include "Graphics/3D/AnimationPlayer.h"
@@ -157,10 +158,9 @@ static bool BuildBoneMatrices(const Model& model,
     return true;
 }
 
-static bool BakeSkinnedVertices(const Model& model,
+static bool SkinVertexPositions(const Model& model,
                                 const std::vector<XMFLOAT4X4>& globalTransforms,
-                                std::vector<Vector3>& outVertices,
-                                std::vector<uint32_t>& outIndices)
+                                std::vector<Vector3>& outVertices)
 {
     const MeshCPUData* cpu = model.GetCPUData();
     if (!cpu || cpu->skinnedVertices.empty())
@@ -170,7 +170,6 @@ static bool BakeSkinnedVertices(const Model& model,
     if (!BuildBoneMatrices(model, globalTransforms, bones))
         return false;
 
-    outIndices = cpu->indices;
     outVertices.resize(cpu->skinnedVertices.size());
 
     for (size_t i = 0; i < cpu->skinnedVertices.size(); ++i)
@@ -196,7 +195,18 @@ static bool BakeSkinnedVertices(const Model& model,
         XMStoreFloat3(&out, skinned);
         outVertices[i] = { out.x, out.y, out.z };
     }
+    return true;
+}
 
+static bool BakeSkinnedVertices(const Model& model,
+                                const std::vector<XMFLOAT4X4>& globalTransforms,
+                                std::vector<Vector3>& outVertices,
+                                std::vector<uint32_t>& outIndices)
+{
+    if (!SkinVertexPositions(model, globalTransforms, outVertices))
+        return false;
+
+    outIndices = model.GetCPUData()->indices;
     if (outIndices.empty())
     {
         outIndices.resize(outVertices.size());
@@ -206,10 +216,134 @@ static bool BakeSkinnedVertices(const Model& model,
     return !outVertices.empty();
 }
 
+/// ボーンローカル空間の頂点群から、パーツのシェイプとジョイント空間での変換を作る
+static PhysicsShape* CreatePartShape(PhysicsWorld3D& world,
+                                     std::vector<Vector3>& localVertices,
+                                     const SkinnedColliderDesc& desc,
+                                     XMFLOAT4X4& outLocalOffset)
+{
+    XMStoreFloat4x4(&outLocalOffset, XMMatrixIdentity());
+
+    if (desc.partType == SkinnedColliderPart::ConvexHull)
+    {
+        DeduplicateVertices(localVertices, 0.0001f);
+        ReducePoints(localVertices, desc.maxHullVertices);
+        if (localVertices.size() < 4)
+            return nullptr;
+        return world.CreateConvexHullShape(localVertices.data(),
+                                           static_cast<uint32_t>(localVertices.size()),
+                                           desc.maxConvexRadius);
+    }
+
+    // カプセル: AABBの最長軸に沿わせ、残り2軸の大きい方を半径にする
+    XMFLOAT3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    XMFLOAT3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const auto& v : localVertices)
+    {
+        bmin.x = std::min(bmin.x, v.x); bmax.x = std::max(bmax.x, v.x);
+        bmin.y = std::min(bmin.y, v.y); bmax.y = std::max(bmax.y, v.y);
+        bmin.z = std::min(bmin.z, v.z); bmax.z = std::max(bmax.z, v.z);
+    }
+    const float half[3] = {
+        (bmax.x - bmin.x) * 0.5f, (bmax.y - bmin.y) * 0.5f, (bmax.z - bmin.z) * 0.5f
+    };
+    int axis = 1;
+    if (half[0] > half[axis]) axis = 0;
+    if (half[2] > half[axis]) axis = 2;
+
+    float radius = 0.0f;
+    for (int a = 0; a < 3; ++a)
+    {
+        if (a != axis)
+            radius = std::max(radius, half[a]);
+    }
+    if (radius <= 0.0f)
+        return nullptr;
+    const float halfHeight = half[axis] - radius;
+
+    // Joltのカプセルは Y 軸方向なので、最長軸へ回す
+    XMMATRIX rot = XMMatrixIdentity();
+    if (axis == 0)      rot = XMMatrixRotationZ(-XM_PIDIV2);
+    else if (axis == 2) rot = XMMatrixRotationX(XM_PIDIV2);
+    XMMATRIX trans = XMMatrixTranslation((bmin.x + bmax.x) * 0.5f,
+                                         (bmin.y + bmax.y) * 0.5f,
+                                         (bmin.z + bmax.z) * 0.5f);
+    XMStoreFloat4x4(&outLocalOffset, rot * trans);
+
+    if (halfHeight < 0.001f)
+        return world.CreateSphereShape(radius);
+    return world.CreateCapsuleShape(halfHeight, radius);
+}
+
+/// パーツ変換 × ジョイント変換 を位置と回転に分解する（スケールは捨てる）
+static void ComputePartTransform(const XMFLOAT4X4& localOffset, const XMMATRIX& joint,
+                                 Vector3& outPosition, Quaternion& outRotation)
+{
+    XMVECTOR scale, rotation, translation;
+    XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&localOffset) * joint);
+    XMStoreFloat3(&outPosition, translation);
+    XMStoreFloat4(&outRotation, rotation);
+}
+
+static PhysicsShape* CreateDecomposedShape(PhysicsWorld3D& world,
+                                           const std::vector<Vector3>& vertices,
+                                           const std::vector<uint32_t>& indices,
+                                           const MeshColliderDesc& desc,
+                                           bool allowCache)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+    // 入力と設定が同じならキャッシュを使い、分解を省く
+    std::vector<std::vector<Vector3>> hulls;
+    const bool useCache = allowCache && !desc.decompositionCachePath.empty();
+    const uint64_t sourceHash = useCache
+        ? ConvexDecomposition::ComputeSourceHash(vertices.data(), vertexCount, indices.data(), indexCount,
+                                                 desc.decomposition)
+        : 0;
+    if (!useCache || !ConvexDecomposition::LoadCache(desc.decompositionCachePath, sourceHash, hulls))
+    {
+        if (!ConvexDecomposition::Decompose(vertices.data(), vertexCount, indices.data(), indexCount,
+                                            desc.decomposition, hulls))
+            return nullptr;
+        if (useCache)
+            ConvexDecomposition::SaveCache(desc.decompositionCachePath, sourceHash, hulls);
+    }
+
+    std::vector<PhysicsCompoundChild> children;
+    children.reserve(hulls.size());
+    for (const auto& hull : hulls)
+    {
+        PhysicsShape* part = world.CreateConvexHullShape(hull.data(), static_cast<uint32_t>(hull.size()),
+                                                         desc.maxConvexRadius);
+        if (!part)
+            continue;
+        if (!part->internal)
+        {
+            world.DestroyShape(part);
+            continue;
+        }
+        PhysicsCompoundChild child;
+        child.shape = part;
+        children.push_back(child);
+    }
+
+    PhysicsShape* compound = nullptr;
+    if (!children.empty())
+        compound = world.CreateCompoundShape(children.data(), static_cast<uint32_t>(children.size()));
+
+    // 子シェイプは複合形状が参照を保持しているのでハンドルは不要
+    for (auto& child : children)
+        world.DestroyShape(child.shape);
+    return compound;
+}
+
+/// allowDecompositionCache=false はポーズごとに形が変わるスキン焼き込み用 (キャッシュは当たらないので読み書きしない)
 static PhysicsShape* CreateShapeFromData(PhysicsWorld3D& world,
                                          std::vector<Vector3> vertices,
                                          const std::vector<uint32_t>& indices,
-                                         const MeshColliderDesc& desc)
+                                         const MeshColliderDesc& desc,
+                                         bool allowDecompositionCache = true)
 {
     if (vertices.empty())
         return nullptr;
@@ -227,6 +361,9 @@ static PhysicsShape* CreateShapeFromData(PhysicsWorld3D& world,
     if (indices.empty())
         return nullptr;
 
+    if (desc.type == MeshColliderType::Decomposed)
+        return CreateDecomposedShape(world, vertices, indices, desc, allowDecompositionCache);
+
     return world.CreateMeshShape(vertices.data(),
                                  static_cast<uint32_t>(vertices.size()),
                                  indices.data(),
@@ -253,6 +390,8 @@ bool MeshCollider::BuildFromModel(PhysicsWorld3D& world, const Model& model, con
     if (m_shape)
         world.DestroyShape(m_shape);
     m_shape = newShape;
+    m_parts.clear();
+    ResetRefitCache();
     return true;
 }
 
@@ -264,7 +403,7 @@ bool MeshCollider::BuildFromSkinnedModel(PhysicsWorld3D& world, const Model& mod
     if (!BakeSkinnedVertices(model, animator.GetGlobalTransforms(), vertices, indices))
         return false;
 
-    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc);
+    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc, false);
     if (!newShape || !newShape->internal)
     {
         if (newShape)
@@ -275,6 +414,8 @@ bool MeshCollider::BuildFromSkinnedModel(PhysicsWorld3D& world, const Model& mod
     if (m_shape)
         world.DestroyShape(m_shape);
     m_shape = newShape;
+    m_parts.clear();
+    ResetRefitCache();
     return true;
 }
 
@@ -286,7 +427,7 @@ bool MeshCollider::BuildFromSkinnedModel(PhysicsWorld3D& world, const Model& mod
     if (!BakeSkinnedVertices(model, player.GetGlobalTransforms(), vertices, indices))
         return false;
 
-    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc);
+    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc, false);
     if (!newShape || !newShape->internal)
     {
         if (newShape)
@@ -297,6 +438,8 @@ bool MeshCollider::BuildFromSkinnedModel(PhysicsWorld3D& world, const Model& mod
     if (m_shape)
         world.DestroyShape(m_shape);
     m_shape = newShape;
+    m_parts.clear();
+    ResetRefitCache();
     return true;
 }
 
@@ -304,12 +447,19 @@ bool MeshCollider::UpdateFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID b
                                           const Model& model, const Animator& animator,
                                           const MeshColliderDesc& desc, bool activate)
 {
+    // 近似凸分解は毎フレーム行える速さではない (ボーン追従は BuildSkinnedParts を使う)
+    if (desc.type == MeshColliderType::Decomposed)
+    {
+        GX_LOG_ERROR("MeshCollider::UpdateFromSkinnedModel: Decomposed is not supported (use BuildSkinnedParts)");
+        return false;
+    }
+
     std::vector<Vector3> vertices;
     std::vector<uint32_t> indices;
     if (!BakeSkinnedVertices(model, animator.GetGlobalTransforms(), vertices, indices))
         return false;
 
-    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc);
+    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc, false);
     if (!newShape || !newShape->internal)
     {
         if (newShape)
@@ -326,6 +476,8 @@ bool MeshCollider::UpdateFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID b
     if (m_shape)
         world.DestroyShape(m_shape);
     m_shape = newShape;
+    m_parts.clear();
+    ResetRefitCache();
     return true;
 }
 
@@ -333,12 +485,19 @@ bool MeshCollider::UpdateFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID b
                                           const Model& model, const AnimationPlayer& player,
                                           const MeshColliderDesc& desc, bool activate)
 {
+    // 近似凸分解は毎フレーム行える速さではない (ボーン追従は BuildSkinnedParts を使う)
+    if (desc.type == MeshColliderType::Decomposed)
+    {
+        GX_LOG_ERROR("MeshCollider::UpdateFromSkinnedModel: Decomposed is not supported (use BuildSkinnedParts)");
+        return false;
+    }
+
     std::vector<Vector3> vertices;
     std::vector<uint32_t> indices;
     if (!BakeSkinnedVertices(model, player.GetGlobalTransforms(), vertices, indices))
         return false;
 
-    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc);
+    PhysicsShape* newShape = CreateShapeFromData(world, std::move(vertices), indices, desc, false);
     if (!newShape || !newShape->internal)
     {
         if (newShape)
@@ -355,6 +514,200 @@ bool MeshCollider::UpdateFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID b
     if (m_shape)
         world.DestroyShape(m_shape);
     m_shape = newShape;
+    m_parts.clear();
+    ResetRefitCache();
+    return true;
+}
+
+bool MeshCollider::BuildSkinnedParts(PhysicsWorld3D& world, const Model& model, const SkinnedColliderDesc& desc)
+{
+    const MeshCPUData* cpu = model.GetCPUData();
+    const Skeleton* skeleton = model.GetSkeleton();
+    if (!cpu || cpu->skinnedVertices.empty() || !skeleton)
+        return false;
+
+    const uint32_t jointCount = skeleton->GetJointCount();
+    if (jointCount == 0)
+        return false;
+    const auto& joints = skeleton->GetJoints();
+
+    // 頂点を最大影響ボーンに割り当て、そのボーンのローカル空間へ戻す
+    std::vector<std::vector<Vector3>> boneVertices(jointCount);
+    for (const auto& vtx : cpu->skinnedVertices)
+    {
+        const uint32_t vj[4] = { vtx.joints.x, vtx.joints.y, vtx.joints.z, vtx.joints.w };
+        const float vw[4] = { vtx.weights.x, vtx.weights.y, vtx.weights.z, vtx.weights.w };
+        int best = 0;
+        for (int k = 1; k < 4; ++k)
+        {
+            if (vw[k] > vw[best])
+                best = k;
+        }
+        if (vw[best] < desc.minWeight || vj[best] >= jointCount)
+            continue;
+
+        XMVECTOR pos = XMVectorSet(vtx.position.x, vtx.position.y, vtx.position.z, 1.0f);
+        XMVECTOR local = XMVector3TransformCoord(pos, XMLoadFloat4x4(&joints[vj[best]].inverseBindMatrix));
+        XMFLOAT3 out;
+        XMStoreFloat3(&out, local);
+        boneVertices[vj[best]].push_back({ out.x, out.y, out.z });
+    }
+
+    std::vector<SkinnedPart> parts;
+    std::vector<PhysicsCompoundChild> children;
+    const uint32_t minVertices = std::max(desc.minVerticesPerBone, 1u);
+    for (uint32_t j = 0; j < jointCount; ++j)
+    {
+        if (boneVertices[j].size() < minVertices)
+            continue;
+
+        SkinnedPart part;
+        part.joint = j;
+        PhysicsShape* partShape = CreatePartShape(world, boneVertices[j], desc, part.localOffset);
+        if (!partShape || !partShape->internal)
+        {
+            if (partShape)
+                world.DestroyShape(partShape);
+            continue;
+        }
+
+        // バインドポーズのジョイント変換 = 逆バインド行列の逆
+        XMMATRIX bindGlobal = XMMatrixInverse(nullptr, XMLoadFloat4x4(&joints[j].inverseBindMatrix));
+        PhysicsCompoundChild child;
+        child.shape = partShape;
+        ComputePartTransform(part.localOffset, bindGlobal, child.position, child.rotation);
+
+        parts.push_back(part);
+        children.push_back(child);
+    }
+
+    PhysicsShape* newShape = nullptr;
+    if (!children.empty())
+        newShape = world.CreateCompoundShape(children.data(), static_cast<uint32_t>(children.size()), true);
+
+    // 子シェイプは複合形状が参照を保持しているのでハンドルは不要
+    for (auto& child : children)
+        world.DestroyShape(child.shape);
+
+    if (!newShape || !newShape->internal)
+    {
+        if (newShape)
+            world.DestroyShape(newShape);
+        return false;
+    }
+
+    if (m_shape)
+        world.DestroyShape(m_shape);
+    m_shape = newShape;
+    m_parts = std::move(parts);
+    m_partPositions.resize(m_parts.size());
+    m_partRotations.resize(m_parts.size());
+    ResetRefitCache();
+    return true;
+}
+
+bool MeshCollider::UpdateSkinnedParts(PhysicsWorld3D& world, PhysicsBodyID body,
+                                      const Animator& animator, bool activate)
+{
+    return UpdateSkinnedPartsInternal(world, body, animator.GetGlobalTransforms(), activate);
+}
+
+bool MeshCollider::UpdateSkinnedParts(PhysicsWorld3D& world, PhysicsBodyID body,
+                                      const AnimationPlayer& player, bool activate)
+{
+    return UpdateSkinnedPartsInternal(world, body, player.GetGlobalTransforms(), activate);
+}
+
+bool MeshCollider::UpdateSkinnedPartsInternal(PhysicsWorld3D& world, PhysicsBodyID body,
+                                              const std::vector<XMFLOAT4X4>& globalTransforms,
+                                              bool activate)
+{
+    if (!m_shape || m_parts.empty())
+        return false;
+
+    for (size_t i = 0; i < m_parts.size(); ++i)
+    {
+        const SkinnedPart& part = m_parts[i];
+        if (part.joint >= globalTransforms.size())
+            return false;
+        ComputePartTransform(part.localOffset, XMLoadFloat4x4(&globalTransforms[part.joint]),
+                             m_partPositions[i], m_partRotations[i]);
+    }
+
+    return world.ModifyCompoundShape(m_shape, 0, static_cast<uint32_t>(m_parts.size()),
+                                     m_partPositions.data(), m_partRotations.data(),
+                                     body, activate);
+}
+
+bool MeshCollider::RefitFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID body,
+                                         const Model& model, const Animator& animator, bool activate)
+{
+    return RefitInternal(world, body, model, animator.GetGlobalTransforms(), activate);
+}
+
+bool MeshCollider::RefitFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID body,
+                                         const Model& model, const AnimationPlayer& player, bool activate)
+{
+    return RefitInternal(world, body, model, player.GetGlobalTransforms(), activate);
+}
+
+bool MeshCollider::RefitInternal(PhysicsWorld3D& world, PhysicsBodyID body, const Model& model,
+                                 const std::vector<XMFLOAT4X4>& globalTransforms, bool activate)
+{
+    if (!SkinVertexPositions(model, globalTransforms, m_refitVertices))
+        return false;
+
+    // トポロジはポーズで変わらないので、モデルと頂点数・インデックス数が同じ間は使い回す
+    const auto& sourceIndices = model.GetCPUData()->indices;
+    if (m_refitModel != &model || m_refitVertexCount != m_refitVertices.size() ||
+        m_refitSourceIndexCount != sourceIndices.size() || m_refitIndices.empty())
+    {
+        m_refitIndices = sourceIndices;
+        if (m_refitIndices.empty())
+        {
+            m_refitIndices.resize(m_refitVertices.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_refitVertices.size()); ++i)
+                m_refitIndices[i] = i;
+        }
+
+        // CreateMeshShape(favorBuildSpeed=true) は入力を検証しないのでここで範囲を確かめる
+        for (uint32_t index : m_refitIndices)
+        {
+            if (index >= m_refitVertices.size())
+            {
+                m_refitIndices.clear();
+                m_refitModel = nullptr;
+                return false;
+            }
+        }
+        m_refitModel = &model;
+        m_refitVertexCount = m_refitVertices.size();
+        m_refitSourceIndexCount = sourceIndices.size();
+    }
+
+    PhysicsShape* newShape = world.CreateMeshShape(m_refitVertices.data(),
+                                                   static_cast<uint32_t>(m_refitVertices.size()),
+                                                   m_refitIndices.data(),
+                                                   static_cast<uint32_t>(m_refitIndices.size()),
+                                                   true);
+    if (!newShape || !newShape->internal)
+    {
+        if (newShape)
+            world.DestroyShape(newShape);
+        return false;
+    }
+
+    // 三角形メッシュは静的ボディ専用なので質量の再計算は不要
+    if (!world.SetBodyShape(body, newShape, false, activate))
+    {
+        world.DestroyShape(newShape);
+        return false;
+    }
+
+    if (m_shape)
+        world.DestroyShape(m_shape);
+    m_shape = newShape;
+    m_parts.clear();
     return true;
 }
 
@@ -365,6 +718,19 @@ void MeshCollider::Release(PhysicsWorld3D& world)
         world.DestroyShape(m_shape);
         m_shape = nullptr;
     }
+    m_parts.clear();
+    m_partPositions.clear();
+    m_partRotations.clear();
+    ResetRefitCache();
+    m_refitVertices.clear();
+}
+
+void MeshCollider::ResetRefitCache()
+{
+    m_refitIndices.clear();
+    m_refitModel = nullptr;
+    m_refitVertexCount = 0;
+    m_refitSourceIndexCount = 0;
 }
 
 } // namespace GX
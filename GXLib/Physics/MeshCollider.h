@@ -3,6 +3,7 @@
 /// @brief メッシュコライダー用ヘルパー（静的/凸包 + スキン焼き込み）
 
 #include "Physics/PhysicsWorld3D.h"
+#include "Physics/ConvexDecomposition.h"
 
 namespace GX
 {
@@ -14,8 +15,9 @@ class AnimationPlayer;
 /// @brief メッシュコライダー種別
 enum class MeshColliderType
 {
-    Static,  ///< 三角形メッシュ（静的専用、凹形状OK）
-    Convex   ///< 凸包（動的向け、凸形状のみ）
+    Static,     ///< 三角形メッシュ（静的専用、凹形状OK）
+    Convex,     ///< 凸包（動的向け、凸形状のみ）
+    Decomposed  ///< 近似凸分解した凸包の複合形状（動的向け、凹形状OK）
 };
 
 /// @brief メッシュコライダーの生成設定
@@ -26,6 +28,28 @@ struct MeshColliderDesc
     float weldTolerance = 0.0001f;  ///< 重複判定の許容誤差
     uint32_t maxConvexVertices = 256; ///< 凸包頂点数の上限（0=既定256）
     float maxConvexRadius = 0.0f;   ///< 凸半径（0=Jolt既定値）
+    ConvexDecompositionDesc decomposition;  ///< Decomposed 用の凸分解設定
+    /// Decomposed 用の分解結果キャッシュ（空=キャッシュしない）。
+    /// 通常は ConvexDecomposition::GetCachePath("xxx.gxmd") でモデルの隣を指定する。
+    /// ポーズで形が変わるスキンドモデルの焼き込みでは読み書きしない
+    std::string decompositionCachePath;
+};
+
+/// @brief スキンドコライダーのパーツ形状
+enum class SkinnedColliderPart
+{
+    ConvexHull, ///< ボーンに割り当てた頂点の凸包（形状に忠実）
+    Capsule     ///< 頂点のAABBに合わせたカプセル（最も軽量）
+};
+
+/// @brief ボーン追従型スキンドコライダーの生成設定
+struct SkinnedColliderDesc
+{
+    SkinnedColliderPart partType = SkinnedColliderPart::ConvexHull; ///< パーツ形状
+    float minWeight = 0.5f;             ///< 最大影響ボーンの重みがこれ以上の頂点だけを割り当てる
+    uint32_t minVerticesPerBone = 4;    ///< 割り当て頂点数がこれ未満のボーンにはパーツを作らない
+    uint32_t maxHullVertices = 32;      ///< パーツ凸包の頂点数上限
+    float maxConvexRadius = 0.0f;       ///< 凸半径（0=Jolt既定値）
 };
 
 /// @brief メッシュコライダー生成クラス
@@ -63,6 +87,7 @@ public:
                                const MeshColliderDesc& desc = {});
 
     /// @brief 既存ボディのシェイプをAnimatorの現在ポーズで更新する
+    /// @note MeshColliderType::Decomposed は非対応（毎回の凸分解は重すぎるため失敗する）
     /// @param world 物理ワールド
     /// @param body 更新するボディのID
     /// @param model スキンドモデル
@@ -75,6 +100,7 @@ public:
                                 const MeshColliderDesc& desc = {}, bool activate = true);
 
     /// @brief 既存ボディのシェイプをAnimationPlayerの現在ポーズで更新する
+    /// @note MeshColliderType::Decomposed は非対応
     /// @param world 物理ワールド
     /// @param body 更新するボディのID
     /// @param model スキンドモデル
@@ -86,6 +112,66 @@ public:
                                 const Model& model, const AnimationPlayer& player,
                                 const MeshColliderDesc& desc = {}, bool activate = true);
 
+    // ----- ボーン追従パーツ（頂点の再スキニングなし） -----
+
+    /// @brief 頂点ウェイトからボーンごとのパーツを生成し、バインドポーズの複合形状を作成する
+    ///
+    /// 各頂点を最も影響の大きいボーンに割り当て、ボーンローカル空間で凸包/カプセルを作る。
+    /// 以後は UpdateSkinnedParts() でボーン変換を渡すだけで形状が追従する。
+    /// @param world 物理ワールド
+    /// @param model スキンドモデル
+    /// @param desc 生成設定
+    /// @return 成功時true（パーツが1つも作れない場合はfalse）
+    bool BuildSkinnedParts(PhysicsWorld3D& world, const Model& model, const SkinnedColliderDesc& desc = {});
+
+    /// @brief Animatorの現在ポーズでパーツの位置/回転を更新する
+    /// @param world 物理ワールド
+    /// @param body このコライダーを使っているボディのID
+    /// @param animator アニメーター
+    /// @param activate trueでボディを起動状態にする
+    /// @return 成功時true
+    bool UpdateSkinnedParts(PhysicsWorld3D& world, PhysicsBodyID body,
+                            const Animator& animator, bool activate = true);
+
+    /// @brief AnimationPlayerの現在ポーズでパーツの位置/回転を更新する
+    /// @param world 物理ワールド
+    /// @param body このコライダーを使っているボディのID
+    /// @param player アニメーションプレイヤー
+    /// @param activate trueでボディを起動状態にする
+    /// @return 成功時true
+    bool UpdateSkinnedParts(PhysicsWorld3D& world, PhysicsBodyID body,
+                            const AnimationPlayer& player, bool activate = true);
+
+    /// @brief 生成済みのパーツ数を取得する
+    /// @return パーツ数（BuildSkinnedParts未実行なら0）
+    uint32_t GetSkinnedPartCount() const { return static_cast<uint32_t>(m_parts.size()); }
+
+    // ----- 三角形メッシュのリフィット（厳密な当たり判定用） -----
+
+    /// @brief Animatorの現在ポーズで三角形メッシュ形状を作り直す
+    ///
+    /// UpdateFromSkinnedModel() と違い、三角形トポロジと作業バッファを保持して使い回し、
+    /// 重複頂点の統合を省いた高速構築でメッシュを作る。静的メッシュ専用。
+    /// 別のモデル (LOD等) や頂点数・インデックス数の違うモデルを渡すとトポロジを作り直す。
+    /// @param world 物理ワールド
+    /// @param body 更新するボディのID
+    /// @param model スキンドモデル
+    /// @param animator アニメーター
+    /// @param activate trueでボディを起動状態にする
+    /// @return 成功時true
+    bool RefitFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID body,
+                               const Model& model, const Animator& animator, bool activate = true);
+
+    /// @brief AnimationPlayerの現在ポーズで三角形メッシュ形状を作り直す
+    /// @param world 物理ワールド
+    /// @param body 更新するボディのID
+    /// @param model スキンドモデル
+    /// @param player アニメーションプレイヤー
+    /// @param activate trueでボディを起動状態にする
+    /// @return 成功時true
+    bool RefitFromSkinnedModel(PhysicsWorld3D& world, PhysicsBodyID body,
+                               const Model& model, const AnimationPlayer& player, bool activate = true);
+
     /// @brief コライダーシェイプを解放する
     /// @param world 物理ワールド
     void Release(PhysicsWorld3D& world);
@@ -95,7 +181,30 @@ public:
     PhysicsShape* GetShape() const { return m_shape; }
 
 private:
+    /// @brief ボーンに追従するパーツ
+    struct SkinnedPart
+    {
+        uint32_t   joint = 0;       ///< 追従するジョイント
+        XMFLOAT4X4 localOffset;     ///< ジョイント空間でのパーツ変換
+    };
+
+    bool UpdateSkinnedPartsInternal(PhysicsWorld3D& world, PhysicsBodyID body,
+                                    const std::vector<XMFLOAT4X4>& globalTransforms, bool activate);
+    bool RefitInternal(PhysicsWorld3D& world, PhysicsBodyID body, const Model& model,
+                       const std::vector<XMFLOAT4X4>& globalTransforms, bool activate);
+    void ResetRefitCache();
+
     PhysicsShape* m_shape = nullptr; ///< 保持しているコライダーシェイプ
+
+    std::vector<SkinnedPart> m_parts;           ///< ボーン追従パーツ（複合形状の子と同順）
+    std::vector<Vector3>     m_partPositions;   ///< パーツ更新用の作業バッファ
+    std::vector<Quaternion>  m_partRotations;   ///< パーツ更新用の作業バッファ
+
+    std::vector<uint32_t> m_refitIndices;   ///< リフィット用にキャッシュした三角形インデックス
+    const Model*          m_refitModel = nullptr;      ///< m_refitIndicesを作ったモデル
+    size_t                m_refitVertexCount = 0;      ///< m_refitIndicesを作ったときの頂点数
+    size_t                m_refitSourceIndexCount = 0; ///< m_refitIndicesを作ったときのモデルのインデックス数
+    std::vector<Vector3>  m_refitVertices;  ///< リフィット用のスキニング結果バッファ
 };
 
 } // namespace GX
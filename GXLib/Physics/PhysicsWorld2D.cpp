@@ -3,6 +3,31 @@
 
 namespace GX {
 
+namespace {
+
+void CaptureBodyState(const RigidBody2D& body, uint32_t index, PhysicsSnapshot2D::BodyState& out)
+{
+    out.index = index;
+    out.position = body.position;
+    out.rotation = body.rotation;
+    out.velocity = body.velocity;
+    out.angularVelocity = body.angularVelocity;
+    out.forceAccum = body.m_forceAccum;
+    out.torqueAccum = body.m_torqueAccum;
+}
+
+bool IsSameBodyState(const PhysicsSnapshot2D::BodyState& a, const PhysicsSnapshot2D::BodyState& b)
+{
+    return a.position.x == b.position.x && a.position.y == b.position.y &&
+           a.rotation == b.rotation &&
+           a.velocity.x == b.velocity.x && a.velocity.y == b.velocity.y &&
+           a.angularVelocity == b.angularVelocity &&
+           a.forceAccum.x == b.forceAccum.x && a.forceAccum.y == b.forceAccum.y &&
+           a.torqueAccum == b.torqueAccum;
+}
+
+} // namespace
+
 PhysicsWorld2D::PhysicsWorld2D() = default;
 PhysicsWorld2D::~PhysicsWorld2D() = default;
 
@@ -303,4 +328,56 @@ void PhysicsWorld2D::QueryAABB(const AABB2D& area, std::vector<RigidBody2D*>& re
     }
 }
 
+void PhysicsWorld2D::SaveSnapshot(PhysicsSnapshot2D& out) const
+{
+    const uint32_t count = static_cast<uint32_t>(m_bodies.size());
+    out.bodies.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+        CaptureBodyState(*m_bodies[i], i, out.bodies[i]);
+    out.bodyCount = count;
+    out.gravity = m_gravity;
+    out.isDelta = false;
+}
+
+bool PhysicsWorld2D::SaveDeltaSnapshot(const PhysicsSnapshot2D& base, PhysicsSnapshot2D& out) const
+{
+    const uint32_t count = static_cast<uint32_t>(m_bodies.size());
+    if (base.isDelta || base.bodyCount != count || base.bodies.size() != count)
+        return false;
+
+    out.bodies.clear();
+    PhysicsSnapshot2D::BodyState state;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        CaptureBodyState(*m_bodies[i], i, state);
+        if (!IsSameBodyState(state, base.bodies[i]))
+            out.bodies.push_back(state);
+    }
+    out.bodyCount = count;
+    out.gravity = m_gravity;
+    out.isDelta = true;
+    return true;
+}
+
+bool PhysicsWorld2D::RestoreSnapshot(const PhysicsSnapshot2D& snapshot)
+{
+    if (snapshot.bodyCount != m_bodies.size())
+        return false;
+
+    for (const auto& state : snapshot.bodies)
+    {
+        if (state.index >= m_bodies.size())
+            return false;
+        RigidBody2D& body = *m_bodies[state.index];
+        body.position = state.position;
+        body.rotation = state.rotation;
+        body.velocity = state.velocity;
+        body.angularVelocity = state.angularVelocity;
+        body.m_forceAccum = state.forceAccum;
+        body.m_torqueAccum = state.torqueAccum;
+    }
+    m_gravity = snapshot.gravity;
+    return true;
+}
+
 } // namespace GX
@@ -20,6 +20,35 @@ struct ContactInfo2D {
     float depth = 0.0f;             ///< めり込み深さ
 };
 
+/// @brief 2D物理ワールドのスナップショット
+///
+/// 各ボディの動的状態 (位置・回転・速度・蓄積力) を平たい配列で保持する。
+/// 形状や質量などの設定値は含まないため、復元先は保存時と同じボディ構成であること。
+struct PhysicsSnapshot2D {
+    /// @brief 1ボディ分の動的状態
+    struct BodyState {
+        uint32_t index = 0;             ///< ワールド内のボディ番号 (AddBody順)
+        Vector2 position;               ///< 位置
+        float rotation = 0.0f;          ///< 回転角度
+        Vector2 velocity;               ///< 線速度
+        float angularVelocity = 0.0f;   ///< 角速度
+        Vector2 forceAccum;             ///< 蓄積された力
+        float torqueAccum = 0.0f;       ///< 蓄積されたトルク
+    };
+
+    std::vector<BodyState> bodies;      ///< 保存したボディ (差分では変化したものだけ)
+    uint32_t bodyCount = 0;             ///< 保存時のワールドのボディ総数
+    Vector2 gravity;                    ///< 保存時の重力
+    bool isDelta = false;               ///< 差分スナップショットならtrue
+
+    /// @brief 内容を空にする (容量は保持)
+    void Clear() { bodies.clear(); bodyCount = 0; isDelta = false; }
+
+    /// @brief 保持データのおおよそのバイト数を取得する
+    /// @return バイト数
+    size_t GetSize() const { return sizeof(BodyState) * bodies.size(); }
+};
+
 /// @brief 2D物理ワールド
 class PhysicsWorld2D
 {
@@ -66,6 +95,25 @@ public:
     /// @param results 見つかったボディの出力先
     void QueryAABB(const AABB2D& area, std::vector<RigidBody2D*>& results);
 
+    // ----- スナップショット -----
+
+    /// @brief 全ボディの動的状態を保存する
+    /// @param out 出力先 (容量は再利用される)
+    void SaveSnapshot(PhysicsSnapshot2D& out) const;
+
+    /// @brief 基準スナップショットから変化したボディだけを保存する
+    /// @param base 基準となる完全スナップショット
+    /// @param out 出力先
+    /// @return 基準が完全スナップショットでボディ数が一致する場合true
+    bool SaveDeltaSnapshot(const PhysicsSnapshot2D& base, PhysicsSnapshot2D& out) const;
+
+    /// @brief スナップショットの状態を復元する
+    ///
+    /// 差分スナップショットは、その基準を先に復元してから適用すること。
+    /// @param snapshot 復元するスナップショット
+    /// @return ボディ数が一致して復元できた場合true
+    bool RestoreSnapshot(const PhysicsSnapshot2D& snapshot);
+
     /// @brief 衝突発生時のコールバック
     std::function<void(const ContactInfo2D&)> onCollision;
     /// @brief トリガー開始時のコールバック
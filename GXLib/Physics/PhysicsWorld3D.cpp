@@ -10,11 +10,14 @@
 #include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/StateRecorder.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
 #include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <Jolt/Physics/Collision/Shape/MutableCompoundShape.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Collision/RayCast.h>
@@ -159,6 +162,130 @@ public:
     }
 };
 
+// std::vector<uint8_t> に直接読み書きする StateRecorder (StateRecorderImpl の文字列コピーを避ける)
+class VectorStateRecorder final : public JPH::StateRecorder
+{
+public:
+    // 書き込み用
+    explicit VectorStateRecorder(std::vector<uint8_t>& buffer) : m_writeBuffer(&buffer) {}
+    // 読み込み用
+    VectorStateRecorder(const uint8_t* data, size_t size) : m_readData(data), m_readSize(size) {}
+
+    void WriteBytes(const void* inData, size_t inNumBytes) override
+    {
+        const auto* bytes = static_cast<const uint8_t*>(inData);
+        m_writeBuffer->insert(m_writeBuffer->end(), bytes, bytes + inNumBytes);
+    }
+
+    void ReadBytes(void* outData, size_t inNumBytes) override
+    {
+        if (m_readPos + inNumBytes > m_readSize)
+        {
+            m_failed = true;
+            memset(outData, 0, inNumBytes);
+            return;
+        }
+        memcpy(outData, m_readData + m_readPos, inNumBytes);
+        m_readPos += inNumBytes;
+    }
+
+    bool IsEOF() const override { return m_readPos >= m_readSize; }
+    bool IsFailed() const override { return m_failed; }
+
+private:
+    std::vector<uint8_t>* m_writeBuffer = nullptr;
+    const uint8_t* m_readData = nullptr;
+    size_t m_readSize = 0;
+    size_t m_readPos = 0;
+    bool m_failed = false;
+};
+
+// ボディの動的状態の指紋 (差分スナップショットで変化の有無を判定する)
+uint64_t ComputeBodyFingerprint(const JPH::Body& body)
+{
+    const JPH::RVec3 pos = body.GetPosition();
+    const JPH::Quat rot = body.GetRotation();
+    const JPH::Vec3 linVel = body.GetLinearVelocity();
+    const JPH::Vec3 angVel = body.GetAngularVelocity();
+    const JPH::Real position[3] = { pos.GetX(), pos.GetY(), pos.GetZ() };
+    const float motion[11] = {
+        rot.GetX(), rot.GetY(), rot.GetZ(), rot.GetW(),
+        linVel.GetX(), linVel.GetY(), linVel.GetZ(),
+        angVel.GetX(), angVel.GetY(), angVel.GetZ(),
+        body.IsActive() ? 1.0f : 0.0f
+    };
+
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+    };
+    mix(position, sizeof(position));
+    mix(motion, sizeof(motion));
+    return hash;
+}
+
+// 基準スナップショットと指紋が異なるボディだけを保存するフィルタ
+class DeltaStateFilter final : public JPH::StateRecorderFilter
+{
+public:
+    explicit DeltaStateFilter(const std::vector<std::pair<uint32_t, uint64_t>>& baseFingerprints)
+        : m_base(baseFingerprints) {}
+
+    bool ShouldSaveBody(const JPH::Body& inBody) const override
+    {
+        const uint32_t id = inBody.GetID().GetIndexAndSequenceNumber();
+        auto it = std::lower_bound(m_base.begin(), m_base.end(), id,
+            [](const std::pair<uint32_t, uint64_t>& e, uint32_t key) { return e.first < key; });
+        if (it == m_base.end() || it->first != id)
+            return true; // 基準に無いボディは常に保存
+        return it->second != ComputeBodyFingerprint(inBody);
+    }
+
+private:
+    const std::vector<std::pair<uint32_t, uint64_t>>& m_base;
+};
+
+// PhysicsBodySettings → Jolt のボディ作成設定へ変換する (AddBody/AddBodies共通)
+JPH::BodyCreationSettings MakeBodyCreationSettings(GX::PhysicsShape* shape, const GX::PhysicsBodySettings& settings)
+{
+    auto* shapeRef = static_cast<JPH::ShapeRefC*>(shape->internal);
+
+    JPH::EMotionType motionType;
+    JPH::ObjectLayer layer;
+    switch (settings.motionType)
+    {
+    case GX::MotionType3D::Static:    motionType = JPH::EMotionType::Static;    layer = ObjectLayers::NON_MOVING; break;
+    case GX::MotionType3D::Kinematic: motionType = JPH::EMotionType::Kinematic; layer = ObjectLayers::MOVING; break;
+    default:                          motionType = JPH::EMotionType::Dynamic;   layer = ObjectLayers::MOVING; break;
+    }
+
+    JPH::BodyCreationSettings bodySettings(
+        *shapeRef,
+        JPH::RVec3(settings.position.x, settings.position.y, settings.position.z),
+        ToJolt(settings.rotation),
+        motionType,
+        layer
+    );
+    bodySettings.mFriction = settings.friction;
+    bodySettings.mRestitution = settings.restitution;
+    bodySettings.mLinearDamping = settings.linearDamping;
+    bodySettings.mAngularDamping = settings.angularDamping;
+    bodySettings.mUserData = static_cast<JPH::uint64>(reinterpret_cast<uintptr_t>(settings.userData));
+    if (settings.motionType == GX::MotionType3D::Dynamic && settings.mass > 0.0f)
+    {
+        bodySettings.mOverrideMassProperties = JPH::EOverrideMassProperties::CalculateInertia;
+        bodySettings.mMassPropertiesOverride.mMass = settings.mass;
+    }
+    return bodySettings;
+}
+
 } // anonymous namespace
 
 namespace GX {
@@ -323,24 +450,48 @@ PhysicsShape* PhysicsWorld3D::CreateCapsuleShape(float halfHeight, float radius)
 }
 
 PhysicsShape* PhysicsWorld3D::CreateMeshShape(const Vector3* vertices, uint32_t vertexCount,
-                                                const uint32_t* indices, uint32_t indexCount)
+                                                const uint32_t* indices, uint32_t indexCount,
+                                                bool favorBuildSpeed)
 {
-    JPH::TriangleList triangles;
-    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    auto* shape = new PhysicsShape();
+
+    JPH::Shape::ShapeResult result;
+    if (favorBuildSpeed)
     {
-        const Vector3& v0 = vertices[indices[i]];
-        const Vector3& v1 = vertices[indices[i + 1]];
-        const Vector3& v2 = vertices[indices[i + 2]];
-        triangles.push_back(JPH::Triangle(
-            JPH::Float3(v0.x, v0.y, v0.z),
-            JPH::Float3(v1.x, v1.y, v1.z),
-            JPH::Float3(v2.x, v2.y, v2.z)
-        ));
+        // 頂点/インデックスをそのまま渡し、Indexify/Sanitize を省いて高速に構築する
+        JPH::Ref<JPH::MeshShapeSettings> settings = new JPH::MeshShapeSettings();
+        settings->mTriangleVertices.reserve(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+            settings->mTriangleVertices.push_back(JPH::Float3(vertices[i].x, vertices[i].y, vertices[i].z));
+        settings->mIndexedTriangles.reserve(indexCount / 3);
+        for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+                continue;
+            settings->mIndexedTriangles.push_back(JPH::IndexedTriangle(indices[i], indices[i + 1], indices[i + 2]));
+        }
+        settings->mBuildQuality = JPH::MeshShapeSettings::EBuildQuality::FavorBuildSpeed;
+        result = settings->Create();
+    }
+    else
+    {
+        JPH::TriangleList triangles;
+        for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const Vector3& v0 = vertices[indices[i]];
+            const Vector3& v1 = vertices[indices[i + 1]];
+            const Vector3& v2 = vertices[indices[i + 2]];
+            triangles.push_back(JPH::Triangle(
+                JPH::Float3(v0.x, v0.y, v0.z),
+                JPH::Float3(v1.x, v1.y, v1.z),
+                JPH::Float3(v2.x, v2.y, v2.z)
+            ));
+        }
+
+        JPH::MeshShapeSettings settings(triangles);
+        result = settings.Create();
     }
 
-    auto* shape = new PhysicsShape();
-    JPH::MeshShapeSettings settings(triangles);
-    auto result = settings.Create();
     if (result.IsValid())
     {
         auto jphShape = new JPH::ShapeRefC(result.Get());
@@ -374,47 +525,136 @@ PhysicsShape* PhysicsWorld3D::CreateConvexHullShape(const Vector3* vertices, uin
     return shape;
 }
 
-PhysicsBodyID PhysicsWorld3D::AddBody(PhysicsShape* shape, const PhysicsBodySettings& settings)
+PhysicsShape* PhysicsWorld3D::CreateCompoundShape(const PhysicsCompoundChild* children, uint32_t count,
+                                                   bool mutableShape)
 {
-    PhysicsBodyID result;
-    if (!m_impl->initialized || !shape || !shape->internal) return result;
+    if (!children || count == 0)
+        return nullptr;
 
-    auto* shapeRef = static_cast<JPH::ShapeRefC*>(shape->internal);
+    JPH::Ref<JPH::CompoundShapeSettings> settings;
+    if (mutableShape)
+        settings = new JPH::MutableCompoundShapeSettings();
+    else
+        settings = new JPH::StaticCompoundShapeSettings();
 
-    JPH::EMotionType motionType;
-    JPH::ObjectLayer layer;
-    switch (settings.motionType)
+    for (uint32_t i = 0; i < count; ++i)
     {
-    case MotionType3D::Static:    motionType = JPH::EMotionType::Static;    layer = ObjectLayers::NON_MOVING; break;
-    case MotionType3D::Kinematic: motionType = JPH::EMotionType::Kinematic; layer = ObjectLayers::MOVING; break;
-    default:                      motionType = JPH::EMotionType::Dynamic;   layer = ObjectLayers::MOVING; break;
+        const PhysicsCompoundChild& child = children[i];
+        if (!child.shape || !child.shape->internal)
+        {
+            GX_LOG_ERROR("PhysicsWorld3D: Invalid compound child shape (index %u)", i);
+            return nullptr;
+        }
+        auto* childRef = static_cast<JPH::ShapeRefC*>(child.shape->internal);
+        settings->AddShape(ToJolt(child.position), ToJolt(child.rotation).Normalized(), childRef->GetPtr());
     }
 
-    JPH::BodyCreationSettings bodySettings(
-        *shapeRef,
-        JPH::RVec3(settings.position.x, settings.position.y, settings.position.z),
-        ToJolt(settings.rotation),
-        motionType,
-        layer
-    );
-    bodySettings.mFriction = settings.friction;
-    bodySettings.mRestitution = settings.restitution;
-    bodySettings.mLinearDamping = settings.linearDamping;
-    bodySettings.mAngularDamping = settings.angularDamping;
-    if (settings.motionType == MotionType3D::Dynamic && settings.mass > 0.0f)
+    auto* shape = new PhysicsShape();
+    auto result = settings->Create();
+    if (result.IsValid())
     {
-        bodySettings.mOverrideMassProperties = JPH::EOverrideMassProperties::CalculateInertia;
-        bodySettings.mMassPropertiesOverride.mMass = settings.mass;
+        auto jphShape = new JPH::ShapeRefC(result.Get());
+        shape->internal = jphShape;
+    }
+    else
+    {
+        GX_LOG_ERROR("PhysicsWorld3D: Failed to create compound shape: %s", result.GetError().c_str());
+    }
+    m_impl->ownedShapes.push_back(shape);
+    return shape;
+}
+
+bool PhysicsWorld3D::ModifyCompoundShape(PhysicsShape* compound, uint32_t startIndex, uint32_t count,
+                                         const Vector3* positions, const Quaternion* rotations,
+                                         PhysicsBodyID body, bool activate)
+{
+    if (!m_impl->initialized || !compound || !compound->internal || !positions || !rotations)
+        return false;
+
+    auto* shapeRef = static_cast<JPH::ShapeRefC*>(compound->internal);
+    if ((*shapeRef)->GetSubType() != JPH::EShapeSubType::MutableCompound)
+        return false;
+
+    // ShapeRefC は const 参照だが、可変複合形状はこの用途のために書き換えを許している
+    auto* mutableShape = const_cast<JPH::MutableCompoundShape*>(
+        static_cast<const JPH::MutableCompoundShape*>(shapeRef->GetPtr()));
+    if (startIndex + count > mutableShape->GetNumSubShapes())
+        return false;
+
+    // GX::Vector3 は12バイト、JPH::Vec3 は16バイトなので詰め替える
+    JPH::Array<JPH::Vec3> jphPositions(count);
+    JPH::Array<JPH::Quat> jphRotations(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        jphPositions[i] = ToJolt(positions[i]);
+        jphRotations[i] = ToJolt(rotations[i]).Normalized();
+    }
+
+    const JPH::Vec3 previousCOM = mutableShape->GetCenterOfMass();
+    mutableShape->ModifyShapes(startIndex, count, jphPositions.data(), jphRotations.data());
+
+    if (body.IsValid())
+    {
+        m_impl->physicsSystem->GetBodyInterface().NotifyShapeChanged(
+            JPH::BodyID(body.id), previousCOM, false,
+            activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
     }
+    return true;
+}
+
+PhysicsBodyID PhysicsWorld3D::AddBody(PhysicsShape* shape, const PhysicsBodySettings& settings)
+{
+    PhysicsBodyID result;
+    if (!m_impl->initialized || !shape || !shape->internal) return result;
 
     JPH::BodyInterface& bodyInterface = m_impl->physicsSystem->GetBodyInterface();
-    JPH::BodyID bodyID = bodyInterface.CreateAndAddBody(bodySettings, JPH::EActivation::Activate);
+    JPH::BodyID bodyID = bodyInterface.CreateAndAddBody(
+        MakeBodyCreationSettings(shape, settings), JPH::EActivation::Activate);
 
     if (bodyID.IsInvalid()) return result;
     result.id = bodyID.GetIndexAndSequenceNumber();
     return result;
 }
 
+uint32_t PhysicsWorld3D::AddBodies(PhysicsShape* const* shapes, const PhysicsBodySettings* settings,
+                                   uint32_t count, PhysicsBodyID* outIDs, bool activate)
+{
+    if (!outIDs) return 0;
+    for (uint32_t i = 0; i < count; ++i)
+        outIDs[i] = PhysicsBodyID{};
+    if (!m_impl->initialized || !shapes || !settings || count == 0) return 0;
+
+    JPH::BodyInterface& bodyInterface = m_impl->physicsSystem->GetBodyInterface();
+
+    // ボディを生成だけしておき、ブロードフェーズへの挿入はまとめて行う
+    JPH::BodyIDVector bodyIDs;
+    bodyIDs.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        PhysicsShape* shape = shapes[i];
+        if (!shape || !shape->internal) continue;
+
+        JPH::Body* body = bodyInterface.CreateBody(MakeBodyCreationSettings(shape, settings[i]));
+        if (!body)
+        {
+            GX_LOG_WARN("PhysicsWorld3D: AddBodies ran out of bodies at %u/%u", i, count);
+            break;
+        }
+        outIDs[i].id = body->GetID().GetIndexAndSequenceNumber();
+        bodyIDs.push_back(body->GetID());
+    }
+
+    if (bodyIDs.empty()) return 0;
+
+    // Prepare は配列を並べ替えることがあるため、outIDs は上で確定させておく
+    const int numBodies = static_cast<int>(bodyIDs.size());
+    JPH::BodyInterface::AddState addState = bodyInterface.AddBodiesPrepare(bodyIDs.data(), numBodies);
+    bodyInterface.AddBodiesFinalize(bodyIDs.data(), numBodies, addState,
+        activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
+
+    return static_cast<uint32_t>(numBodies);
+}
+
 void PhysicsWorld3D::RemoveBody(PhysicsBodyID id)
 {
     if (!m_impl->initialized || !id.IsValid()) return;
@@ -424,6 +664,25 @@ void PhysicsWorld3D::RemoveBody(PhysicsBodyID id)
     bodyInterface.DestroyBody(bodyID);
 }
 
+void PhysicsWorld3D::RemoveBodies(const PhysicsBodyID* ids, uint32_t count)
+{
+    if (!m_impl->initialized || !ids || count == 0) return;
+
+    JPH::BodyIDVector bodyIDs;
+    bodyIDs.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (ids[i].IsValid())
+            bodyIDs.push_back(JPH::BodyID(ids[i].id));
+    }
+    if (bodyIDs.empty()) return;
+
+    JPH::BodyInterface& bodyInterface = m_impl->physicsSystem->GetBodyInterface();
+    const int numBodies = static_cast<int>(bodyIDs.size());
+    bodyInterface.RemoveBodies(bodyIDs.data(), numBodies);
+    bodyInterface.DestroyBodies(bodyIDs.data(), numBodies);
+}
+
 void PhysicsWorld3D::DestroyShape(PhysicsShape* shape)
 {
     if (!shape) return;
@@ -557,6 +816,34 @@ bool PhysicsWorld3D::IsActive(PhysicsBodyID id) const
     return m_impl->physicsSystem->GetBodyInterface().IsActive(JPH::BodyID(id.id));
 }
 
+uint32_t PhysicsWorld3D::GetActiveBodyTransforms(std::vector<PhysicsBodyTransform>& outTransforms) const
+{
+    outTransforms.clear();
+    if (!m_impl->initialized) return 0;
+
+    // constメソッドから共有メンバを書き換えないよう、作業領域はスレッドごとに持つ
+    // (毎フレーム呼ばれても確保は初回のみ)
+    thread_local JPH::BodyIDVector activeIDs;
+    m_impl->physicsSystem->GetActiveBodies(JPH::EBodyType::RigidBody, activeIDs);
+    outTransforms.reserve(activeIDs.size());
+
+    // Step()外で呼ばれる前提なのでロックなしインターフェースで直接読む
+    const JPH::BodyLockInterfaceNoLock& lockInterface = m_impl->physicsSystem->GetBodyLockInterfaceNoLock();
+    for (const JPH::BodyID& bodyID : activeIDs)
+    {
+        JPH::BodyLockRead lock(lockInterface, bodyID);
+        if (!lock.Succeeded()) continue;
+
+        const JPH::Body& body = lock.GetBody();
+        PhysicsBodyTransform& t = outTransforms.emplace_back();
+        t.id.id = bodyID.GetIndexAndSequenceNumber();
+        t.userData = reinterpret_cast<void*>(static_cast<uintptr_t>(body.GetUserData()));
+        t.position = FromJoltR(body.GetPosition());
+        t.rotation = FromJoltQ(body.GetRotation());
+    }
+    return static_cast<uint32_t>(outTransforms.size());
+}
+
 PhysicsWorld3D::RaycastResult PhysicsWorld3D::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance)
 {
     RaycastResult result;
@@ -589,4 +876,71 @@ PhysicsWorld3D::RaycastResult PhysicsWorld3D::Raycast(const Vector3& origin, con
     return result;
 }
 
+bool PhysicsWorld3D::SaveSnapshot(PhysicsSnapshot3D& out) const
+{
+    out.Clear();
+    if (!m_impl->initialized) return false;
+
+    VectorStateRecorder recorder(out.data);
+    m_impl->physicsSystem->SaveState(recorder, JPH::EStateRecorderState::All);
+
+    // 後で差分を取れるよう、全ボディの指紋を記録する
+    JPH::BodyIDVector bodyIDs;
+    m_impl->physicsSystem->GetBodies(bodyIDs);
+    const JPH::BodyLockInterfaceNoLock& lockInterface = m_impl->physicsSystem->GetBodyLockInterfaceNoLock();
+    out.bodyFingerprints.reserve(bodyIDs.size());
+    for (const JPH::BodyID& bodyID : bodyIDs)
+    {
+        JPH::BodyLockRead lock(lockInterface, bodyID);
+        if (lock.Succeeded())
+            out.bodyFingerprints.emplace_back(bodyID.GetIndexAndSequenceNumber(), ComputeBodyFingerprint(lock.GetBody()));
+    }
+    std::sort(out.bodyFingerprints.begin(), out.bodyFingerprints.end());
+    return !recorder.IsFailed();
+}
+
+bool PhysicsWorld3D::SaveDeltaSnapshot(const PhysicsSnapshot3D& base, PhysicsSnapshot3D& out) const
+{
+    out.Clear();
+    if (!m_impl->initialized || base.isDelta) return false;
+
+    // ボディは変化したものだけに絞り、接触キャッシュと拘束は全件保存する
+    // (基準の接触・ウォームスタート状態が残ると、巻き戻し後の再シミュレーションが一致しない)
+    const auto state = static_cast<JPH::EStateRecorderState>(
+        static_cast<JPH::uint8>(JPH::EStateRecorderState::Global) |
+        static_cast<JPH::uint8>(JPH::EStateRecorderState::Bodies) |
+        static_cast<JPH::uint8>(JPH::EStateRecorderState::Contacts) |
+        static_cast<JPH::uint8>(JPH::EStateRecorderState::Constraints));
+
+    VectorStateRecorder recorder(out.data);
+    DeltaStateFilter filter(base.bodyFingerprints);
+    m_impl->physicsSystem->SaveState(recorder, state, &filter);
+    out.isDelta = true;
+    return !recorder.IsFailed();
+}
+
+bool PhysicsWorld3D::RestoreSnapshot(const PhysicsSnapshot3D& snapshot)
+{
+    if (!m_impl->initialized || snapshot.data.empty()) return false;
+
+    VectorStateRecorder recorder(snapshot.data.data(), snapshot.data.size());
+    if (!m_impl->physicsSystem->RestoreState(recorder) || recorder.IsFailed())
+    {
+        GX_LOG_ERROR("PhysicsWorld3D: Failed to restore snapshot (body layout mismatch?)");
+        return false;
+    }
+    return true;
+}
+
+void* PhysicsWorld3D::GetInternalSystem() const
+{
+    return m_impl->initialized ? m_impl->physicsSystem.get() : nullptr;
+}
+
+void* PhysicsWorld3D::GetInternalJobSystem() const
+{
+    if (!m_impl->initialized) return nullptr;
+    return static_cast<JPH::JobSystem*>(m_impl->jobSystem.get());
+}
+
 } // namespace GX
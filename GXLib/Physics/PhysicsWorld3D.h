@@ -41,6 +41,39 @@ struct PhysicsBodySettings {
     void* userData = nullptr;                           ///< ユーザー任意データポインタ
 };
 
+/// @brief 複合形状の子シェイプ (CreateCompoundShape()の入力要素)
+struct PhysicsCompoundChild {
+    PhysicsShape* shape = nullptr;  ///< 子シェイプ (複合形状が参照を保持するので作成後に破棄してよい)
+    Vector3 position;               ///< 複合形状空間での子の位置
+    Quaternion rotation;            ///< 複合形状空間での子の回転
+};
+
+/// @brief 一括読み出し用のボディ変換 (GetActiveBodyTransforms()の出力要素)
+struct PhysicsBodyTransform {
+    PhysicsBodyID id;           ///< ボディID
+    void* userData = nullptr;   ///< 作成時に指定したユーザーデータ
+    Vector3 position;           ///< ワールド位置
+    Quaternion rotation;        ///< ワールド回転
+};
+
+/// @brief 3D物理ワールドのスナップショット (Jolt の SaveState によるバイナリ)
+///
+/// ボディの変換・速度・スリープ状態に加え、接触キャッシュと拘束の状態も含む
+/// (差分スナップショットでも接触と拘束は全件)。復元先は保存時と同じボディ構成 (同じボディID) であること。
+struct PhysicsSnapshot3D {
+    std::vector<uint8_t> data;      ///< シリアライズされた状態
+    /// 差分判定用のボディ指紋 (ボディIDの昇順、完全スナップショットのみ)
+    std::vector<std::pair<uint32_t, uint64_t>> bodyFingerprints;
+    bool isDelta = false;           ///< 差分スナップショットならtrue
+
+    /// @brief 内容を空にする (容量は保持)
+    void Clear() { data.clear(); bodyFingerprints.clear(); isDelta = false; }
+
+    /// @brief シリアライズされた状態のバイト数を取得する
+    /// @return バイト数
+    size_t GetSize() const { return data.size(); }
+};
+
 /// @brief 3D物理ワールド (Jolt Physics ラッパー)
 class PhysicsWorld3D
 {
@@ -91,9 +124,12 @@ public:
     /// @param vertexCount 頂点数
     /// @param indices インデックス配列
     /// @param indexCount インデックス数
+    /// @param favorBuildSpeed trueで重複頂点の統合を省き、BVHを高速構築する
+    ///        (毎フレーム作り直すスキンメッシュ向け。クエリ性能はやや落ちる)
     /// @return 作成されたシェイプ
     PhysicsShape* CreateMeshShape(const Vector3* vertices, uint32_t vertexCount,
-                                   const uint32_t* indices, uint32_t indexCount);
+                                   const uint32_t* indices, uint32_t indexCount,
+                                   bool favorBuildSpeed = false);
 
     /// @brief 凸包形状を作成する (Dynamic/Convex用)
     /// @param vertices 頂点配列
@@ -103,6 +139,29 @@ public:
     PhysicsShape* CreateConvexHullShape(const Vector3* vertices, uint32_t vertexCount,
                                         float maxConvexRadius = 0.0f);
 
+    /// @brief 複合形状を作成する (複数の凸形状を1つのボディにまとめる)
+    /// @param children 子シェイプ配列
+    /// @param count 子の数
+    /// @param mutableShape trueで作成後に子の変換を ModifyCompoundShape() で動かせる形状にする
+    /// @return 作成されたシェイプ
+    PhysicsShape* CreateCompoundShape(const PhysicsCompoundChild* children, uint32_t count,
+                                      bool mutableShape = false);
+
+    /// @brief 可変複合形状の子の変換を書き換える
+    ///
+    /// 形状を作り直さずに子の位置/回転だけを更新するため、ボーン追従などに向く。
+    /// @param compound CreateCompoundShape(..., true) で作成したシェイプ
+    /// @param startIndex 更新する最初の子のインデックス
+    /// @param count 更新する子の数
+    /// @param positions 新しい位置の配列 (count個)
+    /// @param rotations 新しい回転の配列 (count個)
+    /// @param body このシェイプを使っているボディ (有効なら形状変更を通知する)
+    /// @param activate trueでボディを起動状態にする
+    /// @return 成功時true
+    bool ModifyCompoundShape(PhysicsShape* compound, uint32_t startIndex, uint32_t count,
+                             const Vector3* positions, const Quaternion* rotations,
+                             PhysicsBodyID body = {}, bool activate = true);
+
     // ----- ボディ管理 -----
 
     /// @brief ワールドにボディを追加する
@@ -115,6 +174,24 @@ public:
     /// @param id 削除するボディのID
     void RemoveBody(PhysicsBodyID id);
 
+    /// @brief 複数のボディをまとめてワールドに追加する
+    ///
+    /// Joltのバッチ追加 (AddBodiesPrepare/Finalize) を使うため、1個ずつAddBody()するより
+    /// ブロードフェーズの更新コストが大幅に小さい。レベルのストリーミング向け。
+    /// @param shapes シェイプ配列 (count個)
+    /// @param settings ボディ設定配列 (count個)
+    /// @param count ボディ数
+    /// @param outIDs 作成されたボディIDの出力先 (count個、失敗した要素は無効ID)
+    /// @param activate trueで追加時にボディを起動状態にする
+    /// @return 追加に成功したボディ数
+    uint32_t AddBodies(PhysicsShape* const* shapes, const PhysicsBodySettings* settings,
+                       uint32_t count, PhysicsBodyID* outIDs, bool activate = true);
+
+    /// @brief 複数のボディをまとめてワールドから削除する
+    /// @param ids 削除するボディIDの配列 (無効IDはスキップ)
+    /// @param count ID数
+    void RemoveBodies(const PhysicsBodyID* ids, uint32_t count);
+
     /// @brief シェイプを破棄する
     /// @param shape 破棄するシェイプ
     void DestroyShape(PhysicsShape* shape);
@@ -197,6 +274,15 @@ public:
     /// @return アクティブの場合true
     bool IsActive(PhysicsBodyID id) const;
 
+    /// @brief アクティブな (直前のStep()で動いた可能性がある) 全ボディの変換を一括取得する
+    ///
+    /// ボディごとのロックを取らずに連続配列へ書き出すため、GetPosition()/GetRotation()を
+    /// ボディ数だけ呼ぶより高速。スリープ中のボディは含まれない。
+    /// Step()と同じスレッドから、シミュレーション中でないときに呼ぶこと。
+    /// @param outTransforms 出力先 (内容は上書きされ、容量は再利用される)
+    /// @return 書き出したボディ数
+    uint32_t GetActiveBodyTransforms(std::vector<PhysicsBodyTransform>& outTransforms) const;
+
     // ----- レイキャスト -----
 
     /// @brief レイキャスト結果
@@ -215,6 +301,32 @@ public:
     /// @return レイキャスト結果
     RaycastResult Raycast(const Vector3& origin, const Vector3& direction, float maxDistance);
 
+    // ----- スナップショット -----
+
+    /// @brief ワールド全体の状態を保存する (ロールバック・リセット用)
+    ///
+    /// ボディはロックなしで読むため、Step()と並行して呼ばないこと。
+    /// @param out 出力先 (バッファの容量は再利用される)
+    /// @return 成功時true
+    bool SaveSnapshot(PhysicsSnapshot3D& out) const;
+
+    /// @brief 基準スナップショットから変化したボディだけを保存する
+    ///
+    /// 接触キャッシュと拘束は全件含むため、基準→差分の順に復元すれば
+    /// 差分保存時からの再シミュレーションが元の結果と一致する (ロールバック用)。
+    /// @param base 基準となる完全スナップショット
+    /// @param out 出力先
+    /// @return 成功時true
+    bool SaveDeltaSnapshot(const PhysicsSnapshot3D& base, PhysicsSnapshot3D& out) const;
+
+    /// @brief スナップショットの状態を復元する
+    ///
+    /// 差分スナップショットは、その基準を先に復元してから適用すること。
+    /// Step()の実行中に呼ばないこと。
+    /// @param snapshot 復元するスナップショット
+    /// @return 成功時true
+    bool RestoreSnapshot(const PhysicsSnapshot3D& snapshot);
+
     // ----- コールバック -----
 
     /// @brief 接触開始時のコールバック
@@ -222,6 +334,16 @@ public:
     /// @brief 接触終了時のコールバック
     std::function<void(PhysicsBodyID, PhysicsBodyID)> onContactRemoved;
 
+    // ----- 内部アクセス (GXLib内の拡張クラス用) -----
+
+    /// @brief 内部のJolt物理システムを取得する
+    /// @return JPH::PhysicsSystem* (未初期化ならnullptr)
+    void* GetInternalSystem() const;
+
+    /// @brief 内部のJoltジョブシステムを取得する
+    /// @return JPH::JobSystem* (未初期化ならnullptr)
+    void* GetInternalJobSystem() const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
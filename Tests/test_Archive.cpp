@@ -0,0 +1,904 @@
+/// @file test_Archive.cpp
+/// @brief .gxarc (Archive) / .gxpak (PakLoader) のTOC検索・FileSystemのパス解決 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "IO/Archive.h"
+#include "IO/ArchiveFileProvider.h"
+#include "IO/FileWatcher.h"
+#include <pak_loader.h>
+#include "ThirdParty/lz4.h"
+#include "zstd.h"
+
+using namespace GX;
+
+namespace
+{
+
+std::string TempPath(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string MakeContent(int i)
+{
+    // 圧縮が効くよう繰り返しの多い内容にする
+    std::string s;
+    for (int k = 0; k < 8; ++k)
+        s += "entry-" + std::to_string(i) + ";";
+    return s;
+}
+
+/// WritePak() で書き出したバンドルの情報 (パッチのベースとして渡す)
+struct WrittenPak
+{
+    uint64_t packId = 0;
+    std::unordered_map<std::string, std::pair<uint64_t, uint32_t>> storedByContent; ///< 内容 → (オフセット, 格納サイズ)
+};
+
+/// テスト用の .gxpak を書き出す (gxpakツールと同じレイアウト)
+/// dictを指定すると各エントリをその辞書を使ったdictCodec (LZ4Dict / ZstdDict) で格納する。
+/// 同じ内容のエントリは1つのデータを共有し、baseを指定するとベースにある内容はベース内を指すパッチになる
+WrittenPak WritePak(const std::string& filePath, uint32_t version, const std::vector<std::pair<std::string, std::string>>& files,
+                    const std::string& dict = {}, const WrittenPak* base = nullptr,
+                    gxfmt::GxpakCodec dictCodec = gxfmt::GxpakCodec::LZ4Dict)
+{
+    std::ofstream out(filePath, std::ios::binary);
+
+    gxfmt::GxpakHeader header{};
+    header.magic = gxfmt::k_GxpakMagic;
+    header.version = version;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    gxfmt::GxpakTocHeader tocHeader{};
+    if (!dict.empty())
+    {
+        tocHeader.dictOffset = static_cast<uint64_t>(out.tellp());
+        tocHeader.dictSize = static_cast<uint32_t>(dict.size());
+        out.write(dict.data(), dict.size());
+    }
+
+    WrittenPak written;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> storedSizes;
+    std::vector<uint8_t> entryFlags;
+    for (const auto& [path, data] : files)
+    {
+        // ベースまたは書き出し済みのエントリと同じ内容ならそのデータを指す
+        uint8_t flags = 0;
+        const std::pair<uint64_t, uint32_t>* shared = nullptr;
+        if (base && base->storedByContent.count(data))
+        {
+            flags = gxfmt::k_GxpakEntryFlagInBase;
+            shared = &base->storedByContent.at(data);
+        }
+        else if (written.storedByContent.count(data))
+        {
+            shared = &written.storedByContent.at(data);
+        }
+        entryFlags.push_back(flags);
+        if (shared)
+        {
+            offsets.push_back(shared->first);
+            storedSizes.push_back(shared->second);
+            continue;
+        }
+
+        std::string stored = data;
+        if (!dict.empty() && dictCodec == gxfmt::GxpakCodec::ZstdDict)
+        {
+            stored.resize(ZSTD_compressBound(data.size()));
+            ZSTD_CCtx* cctx = ZSTD_createCCtx();
+            size_t size = ZSTD_compress_usingDict(cctx, stored.data(), stored.size(), data.data(), data.size(),
+                                                  dict.data(), dict.size(), 3);
+            ZSTD_freeCCtx(cctx);
+            stored.resize(size);
+        }
+        else if (!dict.empty())
+        {
+            stored.resize(LZ4_compressBound(static_cast<int>(data.size())));
+            LZ4_stream_t* stream = LZ4_createStream();
+            LZ4_loadDict(stream, dict.data(), static_cast<int>(dict.size()));
+            int size = LZ4_compress_fast_continue(stream, data.data(), stored.data(),
+                                                  static_cast<int>(data.size()), static_cast<int>(stored.size()), 1);
+            LZ4_freeStream(stream);
+            stored.resize(size);
+        }
+        offsets.push_back(static_cast<uint64_t>(out.tellp()));
+        storedSizes.push_back(static_cast<uint32_t>(stored.size()));
+        written.storedByContent.emplace(data, std::make_pair(offsets.back(), storedSizes.back()));
+        out.write(stored.data(), stored.size());
+    }
+
+    // 識別子はパスと内容から作る (0は「識別子なし」)
+    std::string idSource;
+    for (const auto& [path, data] : files)
+        idSource += path + '\n' + data + '\n';
+    written.packId = gxfmt::HashContent(idSource.data(), idSource.size()) | 1;
+    const bool legacy = version == 1;   // v1: TOCヘッダ・ハッシュ・エントリフラグなし
+    if (!legacy)
+    {
+        tocHeader.packId = written.packId;
+        tocHeader.basePackId = base ? base->packId : 0;
+    }
+
+    header.tocOffset = static_cast<uint64_t>(out.tellp());
+    if (!legacy)
+        out.write(reinterpret_cast<const char*>(&tocHeader), sizeof(tocHeader));
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const std::string& path = files[i].first;
+        uint32_t pathLen = static_cast<uint32_t>(path.size());
+        const auto codec = dict.empty() ? gxfmt::GxpakCodec::None : dictCodec;
+        uint8_t fixed[4] = { static_cast<uint8_t>(gxfmt::DetectAssetType(path.c_str())), static_cast<uint8_t>(codec),
+                             legacy ? uint8_t(0) : entryFlags[i], 0 };
+        uint32_t size = static_cast<uint32_t>(files[i].second.size());
+        out.write(reinterpret_cast<const char*>(&pathLen), 4);
+        out.write(path.data(), pathLen);
+        out.write(reinterpret_cast<const char*>(fixed), 4);
+        out.write(reinterpret_cast<const char*>(&offsets[i]), 8);
+        out.write(reinterpret_cast<const char*>(&storedSizes[i]), 4);
+        out.write(reinterpret_cast<const char*>(&size), 4);
+        if (!legacy)
+        {
+            uint64_t hash = gxfmt::HashPath(path.data(), path.size());
+            out.write(reinterpret_cast<const char*>(&hash), 8);
+            uint64_t contentHash = gxfmt::HashContent(files[i].second.data(), files[i].second.size());
+            out.write(reinterpret_cast<const char*>(&contentHash), 8);
+        }
+    }
+    header.tocSize = static_cast<uint64_t>(out.tellp()) - header.tocOffset;
+
+    header.flags = base ? gxfmt::k_GxpakFlagPatch : 0;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return written;
+}
+
+/// 問い合わせ回数を数えるメモリ上プロバイダー
+class CountingProvider : public IFileProvider
+{
+public:
+    explicit CountingProvider(int priority = 0) : m_priority(priority) {}
+
+    void Add(const std::string& path, const std::string& content) { m_files[path] = content; }
+    int Probes() const { return m_probes; }
+
+    bool Exists(const std::string& path) const override
+    {
+        ++m_probes;
+        return m_files.count(path) > 0;
+    }
+
+    FileData Read(const std::string& path) const override
+    {
+        FileData result;
+        auto it = m_files.find(path);
+        if (it != m_files.end())
+            result.data.assign(it->second.begin(), it->second.end());
+        return result;
+    }
+
+    bool Write(const std::string& path, const void* data, size_t size) override
+    {
+        m_files[path].assign(static_cast<const char*>(data), size);
+        return true;
+    }
+
+    int Priority() const override { return m_priority; }
+
+private:
+    std::unordered_map<std::string, std::string> m_files;
+    mutable int m_probes = 0;
+    int m_priority;
+};
+
+} // namespace
+
+// ============================================================================
+// Archive (.gxarc)
+// ============================================================================
+
+TEST(ArchiveTest, LookupByPathAndHash)
+{
+    const std::string archivePath = TempPath("gx_test_hashed.gxarc");
+
+    ArchiveWriter writer;
+    for (int i = 0; i < 2000; ++i)
+    {
+        const std::string content = MakeContent(i);
+        writer.AddFile("data/file" + std::to_string(i) + ".bin", content.data(), content.size());
+    }
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(archivePath));
+    ASSERT_EQ(archive.GetEntries().size(), 2000u);
+
+    for (int i = 0; i < 2000; i += 97)
+    {
+        const std::string path = "data/file" + std::to_string(i) + ".bin";
+        EXPECT_TRUE(archive.Contains(path));
+
+        // パス指定とハッシュ指定で同じ内容が得られる
+        FileData byPath = archive.Read(path);
+        FileData byHash = archive.Read(Archive::HashPath(path));
+        ASSERT_TRUE(byPath.IsValid());
+        ASSERT_TRUE(byHash.IsValid());
+        EXPECT_EQ(byPath.AsString(), MakeContent(i));
+        EXPECT_EQ(byHash.AsString(), MakeContent(i));
+    }
+
+    EXPECT_FALSE(archive.Contains("data/file2000.bin"));
+    EXPECT_FALSE(archive.Contains(Archive::HashPath("data/missing.bin")));
+    EXPECT_FALSE(archive.Read("data/missing.bin").IsValid());
+
+    archive.Close();
+    std::filesystem::remove(archivePath);
+}
+
+namespace
+{
+
+/// バージョン導入前の形式 (予約フィールド=version、サイズ32bit、圧縮はLZ4) の .gxarc を書き出す
+void WriteLegacyArchive(const std::string& filePath, uint32_t version,
+                        const std::vector<std::pair<std::string, std::string>>& files)
+{
+    std::vector<uint8_t> toc;
+    std::string data;
+    auto append = [&toc](const void* p, size_t size) {
+        toc.insert(toc.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + size);
+    };
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const auto& [path, content] = files[i];
+
+        // 奇数番目はLZ4で圧縮する
+        std::string stored = content;
+        uint8_t flags = 0;
+        if (i % 2)
+        {
+            stored.resize(LZ4_compressBound(static_cast<int>(content.size())));
+            stored.resize(LZ4_compress_default(content.data(), stored.data(),
+                                               static_cast<int>(content.size()), static_cast<int>(stored.size())));
+            flags = 0x01;
+        }
+
+        const uint16_t pathLen = static_cast<uint16_t>(path.size());
+        const uint64_t offset = data.size();
+        const uint32_t storedSize = static_cast<uint32_t>(stored.size());
+        const uint32_t originalSize = static_cast<uint32_t>(content.size());
+        append(&pathLen, 2);
+        append(path.data(), pathLen);
+        append(&offset, 8);
+        append(&storedSize, 4);
+        append(&originalSize, 4);
+        append(&flags, 1);
+        data += stored;
+    }
+
+    std::ofstream out(filePath, std::ios::binary);
+    const char magic[8] = { 'G', 'X', 'A', 'R', 'C', 0, 0, 0 };
+    const uint32_t header[4] = { static_cast<uint32_t>(files.size()), static_cast<uint32_t>(toc.size()), 0x02, version };
+    out.write(magic, 8);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(toc.data()), toc.size());
+    out.write(data.data(), data.size());
+}
+
+} // namespace
+
+TEST(ArchiveTest, ReadsLegacyToc)
+{
+    // バージョン導入前の形式 (0/1) はハッシュを読み込み時に計算し、圧縮エントリをLZ4として展開する
+    const std::string archivePath = TempPath("gx_test_legacy.gxarc");
+    const std::vector<std::pair<std::string, std::string>> files = {
+        { "a.txt", MakeContent(1) }, { "dir/b.bin", MakeContent(2) }, { "c.txt", MakeContent(3) },
+    };
+    for (uint32_t version : { 0u, 1u })
+    {
+        WriteLegacyArchive(archivePath, version, files);
+        Archive archive;
+        ASSERT_TRUE(archive.Open(archivePath)) << version;
+        ASSERT_EQ(archive.GetEntries().size(), files.size());
+        for (const auto& [path, content] : files)
+        {
+            EXPECT_EQ(archive.Read(Archive::HashPath(path)).AsString(), content) << path;
+            EXPECT_EQ(archive.Find(path)->contentHash, 0u);
+        }
+        EXPECT_EQ(archive.Find("dir/b.bin")->codec, gxfmt::GxpakCodec::LZ4);
+    }
+
+    // 現行より新しいバージョンは読まない
+    WriteLegacyArchive(archivePath, 3, files);
+    Archive archive;
+    EXPECT_FALSE(archive.Open(archivePath));
+    std::filesystem::remove(archivePath);
+}
+
+// ============================================================================
+// PakLoader (.gxpak)
+// ============================================================================
+
+TEST(PakLoaderTest, LookupByPathAndHash)
+{
+    const std::string pakPath = TempPath("gx_test_hashed.gxpak");
+    std::vector<std::pair<std::string, std::string>> files;
+    for (int i = 0; i < 500; ++i)
+        files.push_back({ "models/m" + std::to_string(i) + ".gxmd", MakeContent(i) });
+    WritePak(pakPath, gxfmt::k_GxpakVersion, files);
+
+    gxloader::PakLoader loader;
+    ASSERT_TRUE(loader.Open(pakPath));
+
+    for (int i = 0; i < 500; i += 31)
+    {
+        const std::string& path = files[i].first;
+        const gxfmt::GxpakEntry* entry = loader.Find(gxfmt::HashPath(path.c_str()));
+        ASSERT_NE(entry, nullptr);
+        EXPECT_STREQ(entry->path, path.c_str());
+        EXPECT_EQ(entry->assetType, gxfmt::GxpakAssetType::Model);
+
+        auto data = loader.Read(path);
+        EXPECT_EQ(std::string(data.begin(), data.end()), files[i].second);
+    }
+    EXPECT_FALSE(loader.Contains("models/m500.gxmd"));
+    EXPECT_EQ(loader.Find(gxfmt::HashPath("models/missing.gxmd")), nullptr);
+
+    loader.Close();
+    std::filesystem::remove(pakPath);
+}
+
+TEST(PakLoaderTest, ReadsVersion1Toc)
+{
+    // ハッシュを持たない旧形式のTOCは読み込み時にハッシュを計算する
+    const std::string pakPath = TempPath("gx_test_v1.gxpak");
+    WritePak(pakPath, 1, { { "a.txt", "alpha" }, { "dir/b.png", "bravo" } });
+
+    gxloader::PakLoader loader;
+    ASSERT_TRUE(loader.Open(pakPath));
+    EXPECT_TRUE(loader.Contains("dir/b.png"));
+    EXPECT_TRUE(loader.Contains(gxfmt::HashPath("a.txt")));
+
+    auto data = loader.Read(gxfmt::HashPath("dir/b.png"));
+    EXPECT_EQ(std::string(data.begin(), data.end()), "bravo");
+
+    // 読めるのはv1と現行バージョンのみ
+    loader.Close();
+    WritePak(pakPath, gxfmt::k_GxpakVersion + 1, { { "a.txt", "alpha" } });
+    EXPECT_FALSE(loader.Open(pakPath));
+    std::filesystem::remove(pakPath);
+}
+
+TEST(PakLoaderTest, SharedDictionary)
+{
+    // 共有辞書付きのエントリ (LZ4Dict / ZstdDict) は辞書を使って展開される
+    const std::string dict = "{\"type\":\"button\",\"style\":{\"font\":\"Roboto\",\"size\":14}}";
+    std::vector<std::pair<std::string, std::string>> files;
+    for (int i = 0; i < 8; ++i)
+        files.push_back({ "ui/b" + std::to_string(i) + ".json",
+                          "{\"type\":\"button\",\"id\":" + std::to_string(i) + ",\"style\":{\"font\":\"Roboto\",\"size\":14}}" });
+    const std::string pakPath = TempPath("gx_test_dict.gxpak");
+
+    for (gxfmt::GxpakCodec codec : { gxfmt::GxpakCodec::LZ4Dict, gxfmt::GxpakCodec::ZstdDict })
+    {
+        WritePak(pakPath, gxfmt::k_GxpakVersion, files, dict, nullptr, codec);
+
+        gxloader::PakLoader loader;
+        ASSERT_TRUE(loader.Open(pakPath));
+        for (const auto& [path, content] : files)
+        {
+            const gxfmt::GxpakEntry* entry = loader.Find(path);
+            ASSERT_NE(entry, nullptr);
+            EXPECT_EQ(entry->codec, codec);
+            EXPECT_LT(entry->compressedSize, entry->originalSize);
+            EXPECT_FALSE(loader.ReadView(path).IsValid()); // 圧縮エントリはビューを返さない
+
+            auto data = loader.Read(path);
+            EXPECT_EQ(std::string(data.begin(), data.end()), content);
+        }
+        loader.Close();
+    }
+
+    std::filesystem::remove(pakPath);
+}
+
+TEST(PakLoaderTest, DedupAndPatch)
+{
+    // 同じ内容のエントリは1つのデータを共有する
+    const std::string basePath = TempPath("gx_test_base.gxpak");
+    const WrittenPak base = WritePak(basePath, gxfmt::k_GxpakVersion,
+                                     { { "a.txt", "shared" }, { "b.txt", "shared" }, { "c.txt", "old" } });
+    auto baseLoader = std::make_shared<gxloader::PakLoader>();
+    ASSERT_TRUE(baseLoader->Open(basePath));
+    EXPECT_EQ(baseLoader->GetPackId(), base.packId);
+    EXPECT_FALSE(baseLoader->IsPatch());
+    EXPECT_EQ(baseLoader->Find("a.txt")->dataOffset, baseLoader->Find("b.txt")->dataOffset);
+    auto b = baseLoader->Read("b.txt");
+    EXPECT_EQ(std::string(b.begin(), b.end()), "shared");
+
+    // パッチはベースにない内容だけを持ち、残りはベース内のデータを指す
+    const std::string patchPath = TempPath("gx_test_patch.gxpak");
+    WritePak(patchPath, gxfmt::k_GxpakVersion,
+             { { "a.txt", "shared" }, { "c.txt", "new" }, { "d.txt", "old" } }, {}, &base);
+
+    gxloader::PakLoader patch;
+    EXPECT_FALSE(patch.Open(patchPath)); // ベースが必要
+
+    auto otherBase = std::make_shared<gxloader::PakLoader>();
+    const std::string otherPath = TempPath("gx_test_other.gxpak");
+    WritePak(otherPath, gxfmt::k_GxpakVersion, { { "a.txt", "shared" } });
+    ASSERT_TRUE(otherBase->Open(otherPath));
+    EXPECT_FALSE(patch.Open(patchPath, otherBase)); // 別のバンドルはベースにできない
+
+    ASSERT_TRUE(patch.Open(patchPath, baseLoader));
+    EXPECT_TRUE(patch.IsPatch());
+    EXPECT_EQ(patch.Find("b.txt"), nullptr);
+    for (const auto& [path, content] : { std::pair<std::string, std::string>{ "a.txt", "shared" },
+                                         { "c.txt", "new" }, { "d.txt", "old" } })
+    {
+        auto data = patch.Read(path);
+        EXPECT_EQ(std::string(data.begin(), data.end()), content) << path;
+    }
+    EXPECT_NE(patch.Find("d.txt")->flags & gxfmt::k_GxpakEntryFlagInBase, 0);
+    EXPECT_EQ(patch.Find("c.txt")->flags & gxfmt::k_GxpakEntryFlagInBase, 0);
+    patch.Close();
+
+    // ベースを参照しないバンドルにInBaseエントリがあれば不正
+    {
+        std::fstream f(patchPath, std::ios::binary | std::ios::in | std::ios::out);
+        gxfmt::GxpakHeader header{};
+        f.read(reinterpret_cast<char*>(&header), sizeof(header));
+        const uint64_t zero = 0;
+        f.seekp(static_cast<std::streamoff>(header.tocOffset + offsetof(gxfmt::GxpakTocHeader, basePackId)));
+        f.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+    }
+    EXPECT_FALSE(patch.Open(patchPath));
+    EXPECT_FALSE(patch.Open(patchPath, baseLoader));
+
+    baseLoader->Close();
+    otherBase->Close();
+    std::filesystem::remove(patchPath);
+    std::filesystem::remove(basePath);
+    std::filesystem::remove(otherPath);
+}
+
+// ============================================================================
+// マップからの読み込み (ReadView / ReadInto)
+// ============================================================================
+
+TEST(ArchiveTest, ViewAndReadInto)
+{
+    const std::string archivePath = TempPath("gx_test_view.gxarc");
+    const std::string packed = MakeContent(1) + MakeContent(2);   // 圧縮される
+    const std::string raw = "raw-bytes";          // 64バイト以下は非圧縮
+
+    ArchiveWriter writer;
+    writer.AddFile("packed.txt", packed.data(), packed.size());
+    writer.AddFile("raw.txt", raw.data(), raw.size());
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(archivePath));
+
+    // 圧縮エントリはビューにできないが、バッファへ直接伸長できる
+    EXPECT_FALSE(archive.ReadView("packed.txt").IsValid());
+    std::vector<uint8_t> buffer(packed.size());
+    ASSERT_TRUE(archive.ReadInto("packed.txt", buffer));
+    EXPECT_EQ(std::string(buffer.begin(), buffer.end()), packed);
+
+    // バッファ不足は失敗する
+    std::vector<uint8_t> small(packed.size() - 1);
+    EXPECT_FALSE(archive.ReadInto("packed.txt", small));
+
+    // 非圧縮エントリのビューはClose後も有効
+    gxloader::MappedView view = archive.ReadView(Archive::HashPath("raw.txt"));
+    ASSERT_TRUE(view.IsValid());
+    archive.Close();
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.data), view.size), raw);
+
+    view = {};
+    std::filesystem::remove(archivePath);
+}
+
+TEST(ArchiveTest, ChunkedEntryReadRange)
+{
+    const std::string archivePath = TempPath("gx_test_chunked.gxarc");
+
+    // 64KBチャンク x 16 + 端数 (圧縮が効く区間と効かない区間を混ぜる)
+    std::vector<uint8_t> blob(16 * 64 * 1024 + 1234);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < blob.size(); ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        blob[i] = (i / 65536) % 2 ? static_cast<uint8_t>(state >> 24) : static_cast<uint8_t>(i % 7);
+    }
+
+    ArchiveWriter writer;
+    writer.SetChunkSize(64 * 1024);
+    writer.AddFile("audio/bgm.raw", blob.data(), blob.size());
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(archivePath));
+    const ArchiveEntry* entry = archive.Find("audio/bgm.raw");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->originalSize, blob.size());
+    EXPECT_FALSE(archive.ReadView("audio/bgm.raw").IsValid());
+
+    // 全体の読み込み (複数スレッドで展開される)
+    FileData whole = archive.Read("audio/bgm.raw");
+    ASSERT_TRUE(whole.IsValid());
+    EXPECT_TRUE(std::equal(blob.begin(), blob.end(), whole.data.begin()));
+
+    // チャンク境界をまたぐ範囲・末尾で切り詰められる範囲
+    FileData part = archive.ReadRange("audio/bgm.raw", 65536 - 100, 200);
+    ASSERT_EQ(part.Size(), 200u);
+    EXPECT_TRUE(std::equal(part.data.begin(), part.data.end(), blob.begin() + 65536 - 100));
+
+    FileData tail = archive.ReadRange(entry->pathHash, blob.size() - 10, 4096);
+    ASSERT_EQ(tail.Size(), 10u);
+    EXPECT_TRUE(std::equal(tail.data.begin(), tail.data.end(), blob.end() - 10));
+    EXPECT_FALSE(archive.ReadRange("audio/bgm.raw", blob.size(), 1).IsValid());
+
+    // 複数チャンクにまたがる範囲をバッファへ
+    std::vector<uint8_t> buffer(5 * 65536);
+    ASSERT_EQ(archive.ReadRangeInto("audio/bgm.raw", 3 * 65536 + 7, buffer), buffer.size());
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), blob.begin() + 3 * 65536 + 7));
+
+    archive.Close();
+    std::filesystem::remove(archivePath);
+}
+
+TEST(ArchiveTest, PipelinedSaveAndIncrementalRepack)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "gx_test_repack";
+    std::filesystem::create_directories(dir);
+    const std::string basePath = TempPath("gx_test_repack_base.gxarc");
+    const std::string nextPath = TempPath("gx_test_repack_next.gxarc");
+
+    // ディスク上のファイル (Save() 時に読み込まれる) とチャンク形式になる大きなファイル
+    std::vector<std::pair<std::string, std::string>> files;
+    for (int i = 0; i < 40; ++i)
+        files.push_back({ "f" + std::to_string(i) + ".txt", MakeContent(i) + MakeContent(i + 1) });
+    std::string large;
+    for (int i = 0; i < 40000; ++i)
+        large += MakeContent(i % 300);
+    files.push_back({ "large.bin", large });
+
+    auto writeFiles = [&]() {
+        for (const auto& [name, content] : files)
+            std::ofstream(dir / name, std::ios::binary).write(content.data(), content.size());
+    };
+    auto addFiles = [&](ArchiveWriter& writer) {
+        for (const auto& [name, content] : files)
+            writer.AddFile(name, (dir / name).string());
+        writer.AddFile("memory.txt", "in-memory", 9);
+    };
+    writeFiles();
+
+    ArchiveWriter first;
+    first.SetPassword("secret");
+    first.SetCodec({ gxfmt::GxpakCodec::Zstd, 3 });
+    first.SetThreadCount(3);
+    addFiles(first);
+    ASSERT_TRUE(first.Save(basePath));
+
+    // 1ファイルだけ変更し、圧縮レベルを変えて差分再パックする
+    files[7].second = "changed content changed content changed content changed content";
+    writeFiles();
+
+    ArchiveWriter next;
+    next.SetPassword("secret");
+    next.SetCodec({ gxfmt::GxpakCodec::Zstd, 9 });
+    ASSERT_TRUE(next.SetBaseArchive(basePath, "secret"));
+    addFiles(next);
+    ASSERT_TRUE(next.Save(nextPath));
+
+    Archive base, archive;
+    ASSERT_TRUE(base.Open(basePath, "secret"));
+    ASSERT_TRUE(archive.Open(nextPath, "secret"));
+    ASSERT_EQ(archive.GetEntries().size(), files.size() + 1);
+    EXPECT_EQ(archive.Read("memory.txt").AsString(), "in-memory");
+
+    for (const auto& [name, content] : files)
+    {
+        FileData data = archive.Read(name);
+        ASSERT_TRUE(data.IsValid()) << name;
+        EXPECT_EQ(data.AsString(), content);
+
+        const ArchiveEntry* entry = archive.Find(name);
+        const ArchiveEntry* baseEntry = base.Find(name);
+        EXPECT_EQ(entry->contentHash, gxfmt::HashContent(content.data(), content.size()));
+
+        // 変更のないエントリは元の格納データがそのまま使われる
+        auto stored = archive.GetStoredData(*entry);
+        auto baseStored = base.GetStoredData(*baseEntry);
+        const bool same = std::equal(stored.begin(), stored.end(), baseStored.begin(), baseStored.end());
+        EXPECT_EQ(same, name != files[7].first) << name;
+    }
+    EXPECT_TRUE(archive.Find("large.bin")->flags & 0x02); // チャンク形式
+    EXPECT_EQ(archive.Find("large.bin")->codec, gxfmt::GxpakCodec::Zstd);
+
+    base.Close();
+    archive.Close();
+    std::filesystem::remove(basePath);
+    std::filesystem::remove(nextPath);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ArchiveTest, PerEntryCodecs)
+{
+    const std::string basePath = TempPath("gx_test_codecs_base.gxarc");
+    const std::string nextPath = TempPath("gx_test_codecs_next.gxarc");
+
+    // 差分再パックで内容ごとに元エントリを引けるよう、ファイルごとに内容を変える
+    auto textOf = [](const std::string& name) {
+        std::string text = name;
+        for (int i = 0; i < 200; ++i)
+            text += MakeContent(i % 50);
+        return text;
+    };
+    auto add = [&](ArchiveWriter& writer, const std::string& name, const ArchiveCodec* codec) {
+        const std::string text = textOf(name);
+        if (codec)
+            writer.AddFile(name, text.data(), text.size(), *codec);
+        else
+            writer.AddFile(name, text.data(), text.size());
+    };
+    std::string large;
+    for (int i = 0; i < 30000; ++i)
+        large += MakeContent(i % 400);
+
+    // 既定のコーデック (LZ4) とファイルごとの指定を混ぜる。辞書付きの指定は辞書なしの版になる
+    ArchiveWriter writer;
+    writer.SetChunkSize(64 * 1024);
+    const ArchiveCodec none{ gxfmt::GxpakCodec::None }, hc{ gxfmt::GxpakCodec::LZ4HC, 12 };
+    const ArchiveCodec zstd{ gxfmt::GxpakCodec::Zstd, 19 }, zstdDict{ gxfmt::GxpakCodec::ZstdDict };
+    add(writer, "lz4.txt", nullptr);
+    add(writer, "none.txt", &none);
+    add(writer, "hc.txt", &hc);
+    add(writer, "zstd.txt", &zstd);
+    add(writer, "dict.txt", &zstdDict);
+    writer.AddFile("large.bin", large.data(), large.size(), { gxfmt::GxpakCodec::Zstd });
+    ASSERT_TRUE(writer.Save(basePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(basePath));
+    const std::pair<const char*, gxfmt::GxpakCodec> expected[] = {
+        { "lz4.txt", gxfmt::GxpakCodec::LZ4 },   { "none.txt", gxfmt::GxpakCodec::None },
+        { "hc.txt", gxfmt::GxpakCodec::LZ4HC },  { "zstd.txt", gxfmt::GxpakCodec::Zstd },
+        { "dict.txt", gxfmt::GxpakCodec::Zstd }, { "large.bin", gxfmt::GxpakCodec::Zstd },
+    };
+    for (const auto& [name, codec] : expected)
+    {
+        const ArchiveEntry* entry = archive.Find(name);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->codec, codec) << name;
+        EXPECT_EQ(archive.Read(name).AsString(), name == std::string("large.bin") ? large : textOf(name)) << name;
+    }
+    EXPECT_LT(archive.Find("hc.txt")->compressedSize, archive.Find("lz4.txt")->compressedSize);
+    EXPECT_LT(archive.Find("zstd.txt")->compressedSize, archive.Find("hc.txt")->compressedSize);
+
+    // チャンク形式のZstdエントリも範囲読み込みできる
+    FileData part = archive.ReadRange("large.bin", 3 * 65536 - 50, 100);
+    ASSERT_EQ(part.Size(), 100u);
+    EXPECT_EQ(part.AsString(), large.substr(3 * 65536 - 50, 100));
+
+    // 差分再パックはコーデックが同じエントリだけを再利用する
+    ArchiveWriter next;
+    next.SetChunkSize(64 * 1024);
+    ASSERT_TRUE(next.SetBaseArchive(basePath));
+    const ArchiveCodec zstdFast{ gxfmt::GxpakCodec::Zstd, 3 };
+    add(next, "lz4.txt", &zstdFast);
+    add(next, "zstd.txt", &zstdFast);
+    ASSERT_TRUE(next.Save(nextPath));
+
+    Archive repacked;
+    ASSERT_TRUE(repacked.Open(nextPath));
+    EXPECT_EQ(repacked.Find("lz4.txt")->codec, gxfmt::GxpakCodec::Zstd);
+    EXPECT_EQ(repacked.Read("lz4.txt").AsString(), textOf("lz4.txt"));
+    auto stored = repacked.GetStoredData(*repacked.Find("zstd.txt"));
+    auto baseStored = archive.GetStoredData(*archive.Find("zstd.txt"));
+    EXPECT_TRUE(std::equal(stored.begin(), stored.end(), baseStored.begin(), baseStored.end()));
+
+    archive.Close();
+    repacked.Close();
+    std::filesystem::remove(basePath);
+    std::filesystem::remove(nextPath);
+}
+
+TEST(PakLoaderTest, ViewAndReadInto)
+{
+    const std::string pakPath = TempPath("gx_test_view.gxpak");
+    WritePak(pakPath, gxfmt::k_GxpakVersion, { { "a.txt", "alpha" }, { "b.txt", "bravo!" } });
+
+    gxloader::PakLoader loader;
+    ASSERT_TRUE(loader.Open(pakPath));
+
+    const gxfmt::GxpakEntry* entry = loader.Find("b.txt");
+    ASSERT_NE(entry, nullptr);
+    std::vector<uint8_t> buffer(entry->originalSize);
+    ASSERT_TRUE(loader.ReadInto(entry->pathHash, buffer));
+    EXPECT_EQ(std::string(buffer.begin(), buffer.end()), "bravo!");
+    EXPECT_FALSE(loader.ReadInto("missing.txt", buffer));
+
+    gxloader::MappedView view = loader.ReadView("a.txt");
+    ASSERT_TRUE(view.IsValid());
+    loader.Close();
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.data), view.size), "alpha");
+
+    view = {};
+    std::filesystem::remove(pakPath);
+}
+
+// ============================================================================
+// VFS (FileView / ReadFileInto)
+// ============================================================================
+
+TEST(FileViewTest, OwnsVectorAndSharesSubViews)
+{
+    FileView view = FileView::FromVector({ 'a', 'b', 'c', 'd' });
+    ASSERT_TRUE(view.IsValid());
+    EXPECT_EQ(view.AsStringView(), "abcd");
+
+    // 部分ビューは同じバッファを共有し、元のビューより長生きできる
+    FileView sub = view.SubView(1, 10);
+    view = FileView{};
+    EXPECT_EQ(sub.AsStringView(), "bcd");
+    EXPECT_FALSE(sub.SubView(5, 1).IsValid());
+    EXPECT_FALSE(FileView::FromFileData(FileData{}).IsValid());
+}
+
+TEST(FileViewTest, ReadThroughArchiveProvider)
+{
+    const std::string archivePath = TempPath("gx_test_vfs.gxarc");
+    const std::string packed = MakeContent(3) + MakeContent(4);
+    const std::string raw = "<root/>";
+
+    ArchiveWriter writer;
+    writer.AddFile("ui/theme.css", packed.data(), packed.size());
+    writer.AddFile("ui/layout.xml", raw.data(), raw.size());
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    auto provider = std::make_shared<ArchiveFileProvider>();
+    ASSERT_TRUE(provider->Open(archivePath));
+    FileSystem::Instance().Mount("pack", provider);
+
+    // 非圧縮エントリはマップを直接参照し、圧縮エントリは展開済みバッファを所有する
+    FileView rawView = FileSystem::Instance().ReadFileView("pack/ui/layout.xml");
+    FileView packedView = FileSystem::Instance().ReadFileView("pack/ui/theme.css");
+    EXPECT_EQ(rawView.AsStringView(), raw);
+    EXPECT_EQ(packedView.AsStringView(), packed);
+
+    size_t size = 0;
+    ASSERT_TRUE(FileSystem::Instance().GetFileSize("pack/ui/theme.css", size));
+    EXPECT_EQ(size, packed.size());
+    std::vector<uint8_t> buffer(size);
+    EXPECT_EQ(FileSystem::Instance().ReadFileInto("pack/ui/theme.css", buffer), packed.size());
+    EXPECT_EQ(std::string(buffer.begin(), buffer.end()), packed);
+    EXPECT_EQ(FileSystem::Instance().ReadFileInto("pack/ui/missing.css", buffer), 0u);
+
+    FileSystem::Instance().Unmount("pack");
+    provider.reset();
+    EXPECT_EQ(rawView.AsStringView(), raw); // アンマウント後もビューは有効
+
+    rawView = FileView{};
+    std::filesystem::remove(archivePath);
+}
+
+TEST(FileViewTest, ReadBatchKeepsRequestOrder)
+{
+    const std::string archivePath = TempPath("gx_test_batch.gxarc");
+
+    ArchiveWriter writer;
+    for (int i = 0; i < 64; ++i)
+    {
+        const std::string content = MakeContent(i);
+        writer.AddFile("cfg/c" + std::to_string(i) + ".txt", content.data(), content.size());
+    }
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    auto provider = std::make_shared<ArchiveFileProvider>();
+    ASSERT_TRUE(provider->Open(archivePath));
+    FileSystem::Instance().Mount("batch", provider);
+
+    // データ位置と逆の順で要求しても、結果は要求順に並ぶ
+    std::vector<std::string> paths;
+    for (int i = 63; i >= 0; i -= 3)
+        paths.push_back("batch/cfg/c" + std::to_string(i) + ".txt");
+    paths.push_back("batch/cfg/missing.txt");
+
+    std::vector<FileView> views = FileSystem::Instance().ReadFileBatch(paths);
+    ASSERT_EQ(views.size(), paths.size());
+    for (size_t k = 0; k + 1 < paths.size(); ++k)
+        EXPECT_EQ(views[k].AsStringView(), MakeContent(63 - static_cast<int>(k) * 3));
+    EXPECT_FALSE(views.back().IsValid());
+
+    FileSystem::Instance().Unmount("batch");
+    views.clear();
+    provider.reset();
+    std::filesystem::remove(archivePath);
+}
+
+// ============================================================================
+// FileSystem (マウント表・パス索引・見つからなかったパスの記憶)
+// ============================================================================
+
+TEST(FileSystemTest, MountIndexAndMissingCache)
+{
+    const std::string archivePath = TempPath("gx_test_mounts.gxarc");
+    ArchiveWriter writer;
+    writer.AddFile("ui/a.txt", "archive-a", 9);
+    ASSERT_TRUE(writer.Save(archivePath));
+
+    auto archive = std::make_shared<ArchiveFileProvider>();
+    ASSERT_TRUE(archive->Open(archivePath));
+    auto loose = std::make_shared<CountingProvider>();
+    loose->Add("ui/a.txt", "loose-a");
+    loose->Add("ui/b.txt", "loose-b");
+    auto root = std::make_shared<CountingProvider>();
+    root->Add("assetsX/c.txt", "root-c");
+    auto overlay = std::make_shared<CountingProvider>();
+    overlay->Add("ui/b.txt", "override-b");
+
+    FileSystem& fs = FileSystem::Instance();
+    fs.Mount("", root);
+    fs.Mount("assets", loose);
+    fs.Mount("assets", archive);             // 優先度100
+    fs.Mount("assets/", overlay);           // looseと同じ優先度: 先にマウントしたlooseが優先
+
+    // アーカイブにあるパスは索引で解決し、他のプロバイダーに問い合わせない
+    EXPECT_EQ(fs.ReadFile("assets/ui/a.txt").AsString(), "archive-a");
+    EXPECT_EQ(loose->Probes(), 0);
+    EXPECT_EQ(root->Probes(), 0);
+
+    FileData data;
+    ASSERT_TRUE(fs.TryReadFile("assets//ui\\b.txt", data));
+    EXPECT_EQ(data.AsString(), "loose-b");
+    EXPECT_EQ(overlay->Probes(), 0);
+
+    // マウントポイントは区切り単位で照合する
+    EXPECT_EQ(fs.ReadFile("assetsX/c.txt").AsString(), "root-c");
+    EXPECT_EQ(loose->Probes(), 1);
+
+    // 索引も監視もないプロバイダーで見つからなかったパスは記憶しない (外部で追加されたファイルに気付ける)
+    auto totalProbes = [&] { return loose->Probes() + root->Probes() + overlay->Probes(); };
+    int before = totalProbes();
+    EXPECT_FALSE(fs.Exists("assets/ui/late.txt"));
+    EXPECT_EQ(totalProbes() - before, 3);
+    loose->Add("ui/late.txt", "late");
+    EXPECT_EQ(fs.ReadFile("assets/ui/late.txt").AsString(), "late");
+
+    // 監視済みのプロバイダーだけなら、見つからなかったパスは2回目以降どのプロバイダーにも問い合わせない
+    FileWatcher watcher;
+    const std::string watchDirectory = std::filesystem::temp_directory_path().string();
+    fs.WatchDirectory(watcher, "", watchDirectory);
+    fs.WatchDirectory(watcher, "assets", watchDirectory);
+    before = totalProbes();
+    EXPECT_FALSE(fs.Exists("assets/ui/missing.txt"));
+    const int firstMiss = totalProbes() - before;
+    EXPECT_EQ(firstMiss, 3);
+    EXPECT_FALSE(fs.TryReadFile("assets/ui/missing.txt", data));
+    EXPECT_FALSE(fs.ReadFileView("assets/ui/missing.txt").IsValid());
+    EXPECT_EQ(totalProbes() - before, firstMiss);
+
+    // 書き込みと明示的な破棄で記憶が消える
+    EXPECT_TRUE(fs.WriteFile("assets/ui/missing.txt", "new", 3));
+    EXPECT_EQ(fs.ReadFile("assets/ui/missing.txt").AsString(), "new");
+    EXPECT_FALSE(fs.Exists("assets/ui/later.txt"));
+    loose->Add("ui/later.txt", "later");
+    EXPECT_FALSE(fs.Exists("assets/ui/later.txt"));
+    fs.InvalidateLookupCache("assets/ui");
+    EXPECT_EQ(fs.ReadFile("assets/ui/later.txt").AsString(), "later");
+
+    // アンマウントで索引から外れる
+    fs.Unmount("assets");
+    EXPECT_FALSE(fs.Exists("assets/ui/a.txt"));
+    fs.Unmount("");
+
+    archive.reset();
+    std::filesystem::remove(archivePath);
+}
@@ -0,0 +1,182 @@
+/// @file test_AsyncLoader.cpp
+/// @brief AsyncLoader (優先度・キャンセル・読み込みの統合・デコードステージ) 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "IO/AsyncLoader.h"
+#include "ThirdParty/lz4.h"
+
+using namespace GX;
+
+namespace
+{
+
+/// テスト用のメモリ上プロバイダー。"gate" の読み込みは Open() まで待機する
+class GatedMemoryProvider : public IFileProvider
+{
+public:
+    void Add(const std::string& path, const std::string& content) { m_files[path] = content; }
+
+    void Open()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+        }
+        m_cv.notify_all();
+    }
+
+    /// 読み込まれたパスを順に返す
+    std::vector<std::string> GetReadLog() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_readLog;
+    }
+
+    bool Exists(const std::string& path) const override { return m_files.count(path) > 0; }
+
+    FileData Read(const std::string& path) const override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (path == "gate")
+            m_cv.wait(lock, [this]() { return m_open; });
+        m_readLog.push_back(path);
+
+        FileData result;
+        auto it = m_files.find(path);
+        if (it != m_files.end())
+            result.data.assign(it->second.begin(), it->second.end());
+        return result;
+    }
+
+    bool Write(const std::string&, const void*, size_t) override { return false; }
+
+private:
+    std::unordered_map<std::string, std::string> m_files;
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    mutable std::vector<std::string> m_readLog;
+    bool m_open = false;
+};
+
+/// 全リクエストが完了するまで Update() を回す
+void Drain(AsyncLoader& loader)
+{
+    for (int i = 0; i < 2000 && loader.GetActiveCount() > 0; ++i)
+    {
+        loader.Update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loader.Update();
+}
+
+class AsyncLoaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_provider = std::make_shared<GatedMemoryProvider>();
+        m_provider->Add("gate", "g");
+        for (const char* name : { "a", "b", "c", "d" })
+            m_provider->Add(name, std::string("data-") + name);
+        FileSystem::Instance().Mount("mem", m_provider);
+    }
+
+    void TearDown() override
+    {
+        m_provider->Open();
+        FileSystem::Instance().Unmount("mem");
+    }
+
+    std::shared_ptr<GatedMemoryProvider> m_provider;
+};
+
+} // namespace
+
+TEST_F(AsyncLoaderTest, PriorityCancelAndCoalescing)
+{
+    AsyncLoaderConfig config;
+    config.ioThreadCount = 1;
+    config.decodeThreadCount = 1;
+    AsyncLoader loader(config);
+
+    // I/Oスレッドを "gate" で止めてからキューを積む
+    std::vector<std::string> completed;
+    auto record = [&completed](LoadResult& result) {
+        ASSERT_EQ(result.status, LoadStatus::Complete);
+        completed.emplace_back(result.data.AsStringView());
+    };
+    uint32_t gate = loader.Load({ "mem/gate", 0, nullptr, nullptr });
+    while (loader.GetStatus(gate) != LoadStatus::Loading)
+        std::this_thread::yield();
+
+    uint32_t a  = loader.Load({ "mem/a", 0, nullptr, record });
+    uint32_t b  = loader.Load({ "mem/b", 5, nullptr, record });
+    uint32_t c  = loader.Load({ "mem/c", 1, nullptr, record });
+    uint32_t d  = loader.Load({ "mem/d", 9, nullptr, record });
+    uint32_t b2 = loader.Load({ "mem/b", 0, nullptr, record });   // bのI/Oに相乗り
+
+    EXPECT_TRUE(loader.SetPriority(a, 10));
+    EXPECT_TRUE(loader.Cancel(d));
+    EXPECT_FALSE(loader.Cancel(d));
+    EXPECT_EQ(loader.GetStatus(d), LoadStatus::Cancelled);
+
+    m_provider->Open();
+    Drain(loader);
+
+    // 優先度順 (a=10, b=5, c=1) に読まれ、bは1回だけ、キャンセルしたdは読まれない
+    std::vector<std::string> expected = { "gate", "a", "b", "c" };
+    EXPECT_EQ(m_provider->GetReadLog(), expected);
+    EXPECT_EQ(completed.size(), 4u);
+    EXPECT_EQ(std::count(completed.begin(), completed.end(), "data-b"), 2);
+    EXPECT_EQ(loader.GetStatus(b2), LoadStatus::Complete);
+    EXPECT_EQ(loader.GetStatus(c), LoadStatus::Complete);
+    EXPECT_EQ(loader.GetStatus(b), LoadStatus::Complete);
+}
+
+TEST_F(AsyncLoaderTest, DecodeStageAndLegacyCallback)
+{
+    // LZ4で圧縮したデータをデコードステージで展開する
+    std::string original;
+    for (int i = 0; i < 64; ++i)
+        original += "block-" + std::to_string(i % 4);
+    std::string packed(LZ4_compressBound(static_cast<int>(original.size())), '\0');
+    int packedSize = LZ4_compress_default(original.data(), packed.data(),
+                                          static_cast<int>(original.size()), static_cast<int>(packed.size()));
+    packed.resize(packedSize);
+    m_provider->Add("packed", packed);
+    m_provider->Open();
+
+    AsyncLoader loader;
+
+    std::string unpacked;
+    LoadRequestDesc desc;
+    desc.path = "mem/packed";
+    desc.decoder = AsyncLoader::DecodeLZ4(original.size());
+    desc.onComplete = [&unpacked](LoadResult& result) {
+        if (auto* bytes = result.GetDecoded<std::vector<uint8_t>>())
+            unpacked.assign(bytes->begin(), bytes->end());
+    };
+    uint32_t packedId = loader.Load(desc);
+
+    // 失敗したデコードはErrorになる
+    LoadStatus failedStatus = LoadStatus::Pending;
+    desc.path = "mem/a";
+    desc.decoder = [](const FileView&) -> std::shared_ptr<void> { return nullptr; };
+    desc.onComplete = [&failedStatus](LoadResult& result) { failedStatus = result.status; };
+    loader.Load(desc);
+
+    // 従来のFileDataコールバック (存在しないファイルは空のFileData)
+    std::string legacy = "unset";
+    bool missingValid = true;
+    loader.Load("mem/c", [&legacy](FileData& data) { legacy = data.AsString(); });
+    loader.Load("mem/missing", [&missingValid](FileData& data) { missingValid = data.IsValid(); });
+
+    Drain(loader);
+
+    EXPECT_EQ(loader.GetStatus(packedId), LoadStatus::Complete);
+    EXPECT_EQ(unpacked, original);
+    EXPECT_EQ(failedStatus, LoadStatus::Error);
+    EXPECT_EQ(legacy, "data-c");
+    EXPECT_FALSE(missingValid);
+}
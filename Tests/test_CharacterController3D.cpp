@@ -0,0 +1,246 @@
+/// @file test_CharacterController3D.cpp
+/// @brief キャラクターコントローラーの段差・斜面・地面吸着・一括更新 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "Math/MathUtil.h"
+#include "Physics/CharacterController3D.h"
+
+using namespace GX;
+
+namespace
+{
+
+constexpr float k_Dt = 1.0f / 60.0f;
+
+/// 上面が y=0 の広い床だけを置いたワールドを作る
+void InitWorld(PhysicsWorld3D& world)
+{
+    ASSERT_TRUE(world.Initialize());
+    PhysicsBodySettings floor;
+    floor.motionType = MotionType3D::Static;
+    floor.layer = 0;
+    floor.position = { 0.0f, -0.5f, 0.0f };
+    world.AddBody(world.CreateBoxShape({ 20.0f, 0.5f, 20.0f }), floor);
+}
+
+void AddStaticBox(PhysicsWorld3D& world, const Vector3& halfExtents, const Vector3& position,
+                  const Quaternion& rotation = {})
+{
+    PhysicsBodySettings settings;
+    settings.motionType = MotionType3D::Static;
+    settings.layer = 0;
+    settings.position = position;
+    settings.rotation = rotation;
+    world.AddBody(world.CreateBoxShape(halfExtents), settings);
+}
+
+/// x=2 の床から +x 方向に angleDeg 度で上る斜面を置く
+void AddRamp(PhysicsWorld3D& world, float angleDeg)
+{
+    const float angle = MathUtil::DegreesToRadians(angleDeg);
+    AddStaticBox(world, { 4.0f, 0.5f, 3.0f }, { 2.0f + 0.5f / std::sin(angle), 0.0f, 0.0f },
+                 Quaternion::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, angle));
+}
+
+/// 縦方向の速度 (重力) を残したまま、水平速度 vx で frames フレーム歩かせる
+void Walk(PhysicsWorld3D& world, CharacterController3D& character, float vx, int frames,
+          int* framesOnGround = nullptr)
+{
+    for (int i = 0; i < frames; ++i)
+    {
+        world.Step(k_Dt);
+        const Vector3 velocity = character.GetLinearVelocity();
+        character.SetLinearVelocity({ vx, velocity.y, 0.0f });
+        character.Update(k_Dt);
+        if (framesOnGround && character.IsOnGround())
+            ++*framesOnGround;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// 段差
+// ============================================================================
+
+TEST(CharacterController3DTest, ClimbsStepsUpToMaxStepHeight)
+{
+    for (float stepHeight : { 0.3f, 0.6f })
+    {
+        PhysicsWorld3D world;
+        InitWorld(world);
+        AddStaticBox(world, { 2.0f, stepHeight * 0.5f, 3.0f }, { 4.0f, stepHeight * 0.5f, 0.0f });
+
+        CharacterControllerSettings settings;
+        settings.maxStepHeight = 0.4f;
+        CharacterController3D character;
+        ASSERT_TRUE(character.Create(&world, settings, { 0.0f, 0.01f, 0.0f }));
+        Walk(world, character, 0.0f, 10);
+        EXPECT_TRUE(character.IsOnGround());
+
+        Walk(world, character, 2.0f, 90);
+        const Vector3 pos = character.GetPosition();
+        if (stepHeight < settings.maxStepHeight)
+        {
+            // 段差に上って先へ進んでいる
+            EXPECT_GT(pos.x, 2.5f);
+            EXPECT_NEAR(pos.y, stepHeight, 0.05f);
+            EXPECT_TRUE(character.IsOnGround());
+        }
+        else
+        {
+            // 高すぎる段差は壁として止まる
+            EXPECT_LT(pos.x, 2.0f);
+            EXPECT_LT(pos.y, 0.1f);
+        }
+    }
+}
+
+// ============================================================================
+// 斜面の角度制限
+// ============================================================================
+
+TEST(CharacterController3DTest, SlopeLimitBlocksSteepRamps)
+{
+    for (float angle : { 30.0f, 60.0f })
+    {
+        PhysicsWorld3D world;
+        InitWorld(world);
+        AddRamp(world, angle);
+
+        // 段差処理で急斜面をよじ登らないよう、斜面判定だけを見る
+        CharacterControllerSettings settings;
+        settings.maxSlopeAngle = 45.0f;
+        settings.maxStepHeight = 0.0f;
+        CharacterController3D character;
+        ASSERT_TRUE(character.Create(&world, settings, { 0.0f, 0.01f, 0.0f }));
+        Walk(world, character, 0.0f, 10);
+        Walk(world, character, 2.0f, 120);
+
+        const Vector3 pos = character.GetPosition();
+        if (angle < settings.maxSlopeAngle)
+        {
+            EXPECT_GT(pos.y, 0.8f) << angle;
+            EXPECT_TRUE(character.IsOnGround()) << angle;
+        }
+        else
+        {
+            EXPECT_LT(pos.x, 2.2f) << angle;
+            EXPECT_LT(pos.y, 0.3f) << angle;
+        }
+    }
+}
+
+// ============================================================================
+// 地面への吸着
+// ============================================================================
+
+TEST(CharacterController3DTest, StickToFloorKeepsGroundOnDescent)
+{
+    for (float stickDistance : { 0.5f, 0.0f })
+    {
+        PhysicsWorld3D world;
+        InitWorld(world);
+        AddRamp(world, 30.0f);
+
+        // 斜面の途中 (x=4.5) に置き、1フレームに0.06ほど下がる速さで斜面を駆け下りる
+        CharacterControllerSettings settings;
+        settings.stickToFloorDistance = stickDistance;
+        const float surfaceY = 2.5f * std::tan(MathUtil::DegreesToRadians(30.0f));
+        CharacterController3D character;
+        ASSERT_TRUE(character.Create(&world, settings, { 4.5f, surfaceY + 0.06f, 0.0f }));
+        Walk(world, character, 0.0f, 10);
+        ASSERT_TRUE(character.IsOnGround());
+
+        int framesOnGround = 0;
+        Walk(world, character, -6.0f, 20, &framesOnGround);
+        if (stickDistance > 0.0f)
+            EXPECT_EQ(framesOnGround, 20);
+        else
+            EXPECT_LT(framesOnGround, 20);
+    }
+}
+
+// ============================================================================
+// 一括更新
+// ============================================================================
+
+namespace
+{
+
+/// 段差へ向かって40体を歩かせ、最終位置を返す (batchでUpdateBatch、それ以外は1体ずつUpdate)
+std::vector<Vector3> RunCrowd(bool batch)
+{
+    PhysicsWorld3D world;
+    InitWorld(world);
+    AddStaticBox(world, { 1.0f, 0.15f, 20.0f }, { 3.0f, 0.15f, 0.0f });
+
+    constexpr int k_Count = 40;
+    std::vector<std::unique_ptr<CharacterController3D>> characters;
+    std::vector<CharacterController3D*> pointers;
+    for (int i = 0; i < k_Count; ++i)
+    {
+        auto character = std::make_unique<CharacterController3D>();
+        const Vector3 start = { -0.5f + 0.02f * i, 0.01f, -15.0f + 0.75f * i };
+        EXPECT_TRUE(character->Create(&world, {}, start));
+        character->SetLinearVelocity({ 2.0f + 0.05f * i, 0.0f, 0.0f });
+        pointers.push_back(character.get());
+        characters.push_back(std::move(character));
+    }
+
+    for (int frame = 0; frame < 60; ++frame)
+    {
+        world.Step(k_Dt);
+        if (batch)
+            EXPECT_TRUE(CharacterController3D::UpdateBatch(pointers.data(), k_Count, k_Dt));
+        else
+            for (auto* character : pointers)
+                character->Update(k_Dt);
+    }
+
+    std::vector<Vector3> positions;
+    for (auto* character : pointers)
+        positions.push_back(character->GetPosition());
+    return positions;
+}
+
+} // namespace
+
+TEST(CharacterController3DTest, UpdateBatchMatchesSerialUpdate)
+{
+    const std::vector<Vector3> serial = RunCrowd(false);
+    const std::vector<Vector3> batched = RunCrowd(true);
+    ASSERT_EQ(serial.size(), batched.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(serial[i].x, batched[i].x) << i;
+        EXPECT_FLOAT_EQ(serial[i].y, batched[i].y) << i;
+        EXPECT_FLOAT_EQ(serial[i].z, batched[i].z) << i;
+    }
+}
+
+TEST(CharacterController3DTest, UpdateBatchRejectsMixedWorlds)
+{
+    PhysicsWorld3D worldA, worldB;
+    InitWorld(worldA);
+    InitWorld(worldB);
+
+    // ジョブ分割される件数でも少数でも、混在していれば誰も動かさない
+    for (uint32_t count : { 4u, 40u })
+    {
+        std::vector<std::unique_ptr<CharacterController3D>> characters;
+        std::vector<CharacterController3D*> pointers;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto character = std::make_unique<CharacterController3D>();
+            ASSERT_TRUE(character->Create(i % 2 ? &worldB : &worldA, {}, { 0.0f, 1.0f, 0.5f * i }));
+            pointers.push_back(character.get());
+            characters.push_back(std::move(character));
+        }
+
+        EXPECT_FALSE(CharacterController3D::UpdateBatch(pointers.data(), count, k_Dt));
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(pointers[i]->GetPosition().y, 1.0f);
+    }
+}
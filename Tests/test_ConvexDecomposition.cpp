@@ -0,0 +1,190 @@
+/// @file test_ConvexDecomposition.cpp
+/// @brief 近似凸分解とキャッシュファイル 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "Physics/ConvexDecomposition.h"
+#include "Physics/PhysicsWorld3D.h"
+
+using namespace GX;
+
+namespace
+{
+
+std::string TempPath(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/// 軸平行な箱 (8頂点・12三角形) をメッシュに追加する
+void AppendBox(const Vector3& bmin, const Vector3& bmax,
+               std::vector<Vector3>& vertices, std::vector<uint32_t>& indices)
+{
+    const uint32_t base = static_cast<uint32_t>(vertices.size());
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        vertices.push_back({ (i & 1) ? bmax.x : bmin.x,
+                             (i & 2) ? bmax.y : bmin.y,
+                             (i & 4) ? bmax.z : bmin.z });
+    }
+    static const uint32_t k_Faces[12][3] = {
+        { 0, 2, 1 }, { 1, 2, 3 }, { 4, 5, 6 }, { 5, 7, 6 }, // -Z / +Z
+        { 0, 1, 4 }, { 1, 5, 4 }, { 2, 6, 3 }, { 3, 6, 7 }, // -Y / +Y
+        { 0, 4, 2 }, { 2, 4, 6 }, { 1, 3, 5 }, { 3, 7, 5 }, // -X / +X
+    };
+    for (const auto& face : k_Faces)
+    {
+        for (uint32_t v : face)
+            indices.push_back(base + v);
+    }
+}
+
+/// U字形: 幅4・高さ3の土台付きで、x=1～3 の上側が空いている
+void BuildUShape(std::vector<Vector3>& vertices, std::vector<uint32_t>& indices)
+{
+    AppendBox({ 0.0f, 0.0f, 0.0f }, { 4.0f, 1.0f, 1.0f }, vertices, indices);
+    AppendBox({ 0.0f, 1.0f, 0.0f }, { 1.0f, 3.0f, 1.0f }, vertices, indices);
+    AppendBox({ 3.0f, 1.0f, 0.0f }, { 4.0f, 3.0f, 1.0f }, vertices, indices);
+}
+
+std::vector<std::vector<Vector3>> MakeHulls()
+{
+    return {
+        { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } },
+        { { 2, 2, 2 }, { 3, 2, 2 }, { 2, 3, 2 }, { 2, 2, 3 }, { 3, 3, 3 } },
+    };
+}
+
+} // namespace
+
+// ============================================================================
+// 分解
+// ============================================================================
+
+TEST(ConvexDecompositionTest, SplitsUShapeIntoHullsInsideBounds)
+{
+    // 凸包の構築に Jolt のアロケータを使うため、ワールドを初期化しておく
+    PhysicsWorld3D world;
+    ASSERT_TRUE(world.Initialize());
+
+    std::vector<Vector3> vertices;
+    std::vector<uint32_t> indices;
+    BuildUShape(vertices, indices);
+
+    ConvexDecompositionDesc desc;
+    std::vector<std::vector<Vector3>> hulls;
+    ASSERT_TRUE(ConvexDecomposition::Decompose(vertices.data(), static_cast<uint32_t>(vertices.size()),
+                                               indices.data(), static_cast<uint32_t>(indices.size()),
+                                               desc, hulls));
+    EXPECT_GE(hulls.size(), 2u);
+    EXPECT_LE(hulls.size(), desc.maxParts);
+
+    // ボクセルの角を使うので、元のAABBから最大1ボクセル (最長辺4 / 解像度) はみ出しうる
+    const float tolerance = 4.0f / static_cast<float>(desc.resolution) + 1e-4f;
+    for (const auto& hull : hulls)
+    {
+        ASSERT_GE(hull.size(), 4u);
+        EXPECT_LE(hull.size(), desc.maxHullVertices);
+        float minX = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        for (const Vector3& v : hull)
+        {
+            EXPECT_GE(v.x, -tolerance);
+            EXPECT_LE(v.x, 4.0f + tolerance);
+            EXPECT_GE(v.y, -tolerance);
+            EXPECT_LE(v.y, 3.0f + tolerance);
+            EXPECT_GE(v.z, -tolerance);
+            EXPECT_LE(v.z, 1.0f + tolerance);
+            minX = (std::min)(minX, v.x);
+            maxX = (std::max)(maxX, v.x);
+            maxY = (std::max)(maxY, v.y);
+        }
+
+        // 土台より上に伸びるパーツが、U字の両腕をまたいで隙間を埋めていない
+        if (maxY > 1.5f)
+            EXPECT_FALSE(minX < 1.0f && maxX > 3.0f);
+    }
+}
+
+TEST(ConvexDecompositionTest, RejectsEmptyInput)
+{
+    PhysicsWorld3D world;
+    ASSERT_TRUE(world.Initialize());
+
+    std::vector<std::vector<Vector3>> hulls = MakeHulls();
+    EXPECT_FALSE(ConvexDecomposition::Decompose(nullptr, 0, nullptr, 0, {}, hulls));
+    EXPECT_TRUE(hulls.empty());
+}
+
+// ============================================================================
+// キャッシュ
+// ============================================================================
+
+TEST(ConvexDecompositionTest, SourceHashTracksMeshAndSettings)
+{
+    std::vector<Vector3> vertices;
+    std::vector<uint32_t> indices;
+    BuildUShape(vertices, indices);
+    const uint32_t vc = static_cast<uint32_t>(vertices.size());
+    const uint32_t ic = static_cast<uint32_t>(indices.size());
+
+    ConvexDecompositionDesc desc;
+    const uint64_t hash = ConvexDecomposition::ComputeSourceHash(vertices.data(), vc, indices.data(), ic, desc);
+    EXPECT_EQ(hash, ConvexDecomposition::ComputeSourceHash(vertices.data(), vc, indices.data(), ic, desc));
+
+    ConvexDecompositionDesc finer = desc;
+    finer.resolution = 64;
+    EXPECT_NE(hash, ConvexDecomposition::ComputeSourceHash(vertices.data(), vc, indices.data(), ic, finer));
+
+    vertices[0].x -= 0.5f;
+    EXPECT_NE(hash, ConvexDecomposition::ComputeSourceHash(vertices.data(), vc, indices.data(), ic, desc));
+
+    EXPECT_EQ(ConvexDecomposition::GetCachePath("Assets/crate.gxmd"), "Assets/crate.gxcd");
+    EXPECT_EQ(ConvexDecomposition::GetCachePath("Assets.v2/crate"), "Assets.v2/crate.gxcd");
+}
+
+TEST(ConvexDecompositionTest, CacheRoundTrip)
+{
+    const std::string path = TempPath("gx_test_roundtrip.gxcd");
+    const auto hulls = MakeHulls();
+    ASSERT_TRUE(ConvexDecomposition::SaveCache(path, 0x1234, hulls));
+
+    std::vector<std::vector<Vector3>> loaded;
+    ASSERT_TRUE(ConvexDecomposition::LoadCache(path, 0x1234, loaded));
+    ASSERT_EQ(loaded.size(), hulls.size());
+    for (size_t i = 0; i < hulls.size(); ++i)
+    {
+        ASSERT_EQ(loaded[i].size(), hulls[i].size());
+        for (size_t j = 0; j < hulls[i].size(); ++j)
+        {
+            EXPECT_EQ(loaded[i][j].x, hulls[i][j].x);
+            EXPECT_EQ(loaded[i][j].y, hulls[i][j].y);
+            EXPECT_EQ(loaded[i][j].z, hulls[i][j].z);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ConvexDecompositionTest, LoadCacheRejectsStaleAndTruncatedFiles)
+{
+    const std::string path = TempPath("gx_test_stale.gxcd");
+    ASSERT_TRUE(ConvexDecomposition::SaveCache(path, 0x1234, MakeHulls()));
+
+    // ハッシュが違えば古いキャッシュとして捨てる
+    std::vector<std::vector<Vector3>> loaded;
+    EXPECT_FALSE(ConvexDecomposition::LoadCache(path, 0x5678, loaded));
+    EXPECT_TRUE(loaded.empty());
+
+    // 途中で切れたファイルは、どこで切れていても読まない
+    const auto fullSize = std::filesystem::file_size(path);
+    for (uintmax_t size : { fullSize - 1, fullSize - sizeof(Vector3), uintmax_t(22), uintmax_t(10) })
+    {
+        ASSERT_TRUE(ConvexDecomposition::SaveCache(path, 0x1234, MakeHulls()));
+        std::filesystem::resize_file(path, size);
+        EXPECT_FALSE(ConvexDecomposition::LoadCache(path, 0x1234, loaded)) << size;
+        EXPECT_TRUE(loaded.empty()) << size;
+    }
+
+    EXPECT_FALSE(ConvexDecomposition::LoadCache(TempPath("gx_test_missing.gxcd"), 0x1234, loaded));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,258 @@
+/// @file test_CrowdManager.cpp
+/// @brief CrowdManager（ORCA 局所回避による群衆シミュレーション）単体テストとベンチマーク
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include "AI/CrowdManager.h"
+#include "AI/NavMesh.h"
+
+using namespace GX;
+
+namespace
+{
+
+constexpr float k_DeltaTime = 1.0f / 60.0f;
+
+float DistanceXZ(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    const float dx = a.x - b.x, dz = a.z - b.z;
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+/// 全エージェント間の最小距離（XZ 平面）
+float MinPairDistance(const CrowdManager& crowd, const std::vector<CrowdAgentId>& ids)
+{
+    float minDist = FLT_MAX;
+    for (size_t i = 0; i < ids.size(); ++i)
+        for (size_t j = i + 1; j < ids.size(); ++j)
+            minDist = std::min(minDist, DistanceXZ(crowd.GetPosition(ids[i]), crowd.GetPosition(ids[j])));
+    return minDist;
+}
+
+} // namespace
+
+// ============================================================================
+// 回避
+// ============================================================================
+
+TEST(CrowdManager, HeadOnAgentsPassWithoutCollision)
+{
+    CrowdManager crowd;
+    crowd.Initialize(2);
+
+    CrowdAgentParams params;
+    params.radius = 0.5f;
+    std::vector<CrowdAgentId> ids = {
+        crowd.AddAgent({ -10.0f, 0.0f, 0.0f }, params),
+        crowd.AddAgent({ 10.0f, 0.0f, 0.0f }, params),
+    };
+    ASSERT_TRUE(crowd.SetTarget(ids[0], { 10.0f, 0.0f, 0.0f }));
+    ASSERT_TRUE(crowd.SetTarget(ids[1], { -10.0f, 0.0f, 0.0f }));
+
+    // 正面衝突のコースでも、すれ違いながら互いに重ならない
+    float minDist = FLT_MAX;
+    for (int frame = 0; frame < 60 * 20; ++frame)
+    {
+        crowd.Update(k_DeltaTime);
+        minDist = std::min(minDist, MinPairDistance(crowd, ids));
+    }
+    EXPECT_GT(minDist, 2.0f * params.radius * 0.95f);
+    EXPECT_TRUE(crowd.HasReachedTarget(ids[0]));
+    EXPECT_TRUE(crowd.HasReachedTarget(ids[1]));
+    EXPECT_LT(DistanceXZ(crowd.GetPosition(ids[0]), { 10.0f, 0.0f, 0.0f }), 0.5f);
+}
+
+TEST(CrowdManager, CircleSwapHasNoOverlaps)
+{
+    // 対称な配置は先読みが短いと中心付近で詰まるため、視野と先読みを長めにする
+    CrowdConfig config;
+    config.neighbourDist = 10.0f;
+    config.timeHorizon = 5.0f;
+    config.workerCount = 3;
+    CrowdManager crowd;
+    crowd.Initialize(64, config);
+
+    // 円周上のエージェントが対岸へ移動する（中心で全員が交差する）
+    constexpr int k_Count = 40;
+    constexpr float k_Radius = 20.0f;
+    CrowdAgentParams params;
+    params.radius = 0.5f;
+    params.maxSpeed = 2.0f;
+    std::vector<CrowdAgentId> ids;
+    for (int i = 0; i < k_Count; ++i)
+    {
+        const float angle = XM_2PI * i / k_Count;
+        ids.push_back(crowd.AddAgent({ std::cos(angle) * k_Radius, 0.0f, std::sin(angle) * k_Radius }, params));
+    }
+    for (int i = 0; i < k_Count; ++i)
+    {
+        const XMFLOAT3 p = crowd.GetPosition(ids[i]);
+        crowd.SetTarget(ids[i], { -p.x, 0.0f, -p.z });
+    }
+
+    float minDist = FLT_MAX;
+    int frame = 0;
+    for (; frame < 60 * 60; ++frame)
+    {
+        crowd.Update(k_DeltaTime);
+        minDist = std::min(minDist, MinPairDistance(crowd, ids));
+
+        bool allArrived = true;
+        for (CrowdAgentId id : ids)
+            allArrived &= crowd.HasReachedTarget(id);
+        if (allArrived)
+            break;
+    }
+    EXPECT_LT(frame, 60 * 60) << "all agents should arrive";
+    EXPECT_GT(minDist, 2.0f * params.radius * 0.9f);
+}
+
+TEST(CrowdManager, AgentsStayOnWalkableCells)
+{
+    // 中央の壁に 4 セル幅の隙間がある 40x20 のグリッド
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 40.0f, 20.0f, 1.0f);
+    for (int z = 0; z < 20; ++z)
+    {
+        if (z < 8 || z >= 12)
+            navMesh.SetCellWalkable(20, z, false);
+    }
+
+    CrowdManager crowd;
+    crowd.Initialize(16);
+    crowd.SetNavMesh(&navMesh);
+
+    std::vector<CrowdAgentId> ids;
+    for (int i = 0; i < 8; ++i)
+    {
+        ids.push_back(crowd.AddAgent({ 3.5f + (i % 4) * 1.5f, 0.0f, 4.5f + (i / 4) * 10.0f }));
+        ASSERT_TRUE(crowd.SetTarget(ids.back(), { 36.5f, 0.0f, 4.5f + (i / 4) * 10.0f }));
+    }
+
+    // 隙間に殺到しても壁を抜けない
+    for (int frame = 0; frame < 60 * 40; ++frame)
+    {
+        crowd.Update(k_DeltaTime);
+        for (CrowdAgentId id : ids)
+            ASSERT_TRUE(navMesh.IsWalkable(crowd.GetPosition(id))) << "agent " << id << " frame " << frame;
+    }
+    for (CrowdAgentId id : ids)
+        EXPECT_GT(crowd.GetPosition(id).x, 20.0f);
+}
+
+// ============================================================================
+// ハンドル管理
+// ============================================================================
+
+TEST(CrowdManager, RemoveKeepsOtherHandlesValid)
+{
+    CrowdManager crowd;
+    crowd.Initialize(8);
+
+    std::vector<CrowdAgentId> ids;
+    for (int i = 0; i < 5; ++i)
+        ids.push_back(crowd.AddAgent({ i * 10.0f, 0.0f, 0.0f }));
+    EXPECT_EQ(crowd.GetAgentCount(), 5u);
+
+    // 先頭を削除すると末尾が詰められるが、ハンドルは変わらない
+    crowd.RemoveAgent(ids[0]);
+    crowd.RemoveAgent(ids[2]);
+    EXPECT_EQ(crowd.GetAgentCount(), 3u);
+    EXPECT_FLOAT_EQ(crowd.GetPosition(ids[1]).x, 10.0f);
+    EXPECT_FLOAT_EQ(crowd.GetPosition(ids[3]).x, 30.0f);
+    EXPECT_FLOAT_EQ(crowd.GetPosition(ids[4]).x, 40.0f);
+    EXPECT_FALSE(crowd.SetTarget(ids[0], { 0.0f, 0.0f, 0.0f }));
+
+    // 空いたハンドルは再利用される
+    CrowdAgentId reused = crowd.AddAgent({ 99.0f, 0.0f, 0.0f });
+    EXPECT_TRUE(reused == ids[0] || reused == ids[2]);
+    EXPECT_FLOAT_EQ(crowd.GetPosition(reused).x, 99.0f);
+    EXPECT_EQ(crowd.GetAgentCount(), 4u);
+}
+
+// ============================================================================
+// 並列更新の決定性
+// ============================================================================
+
+namespace
+{
+
+/// ランダムな群衆を frames フレーム進め、最終位置を返す
+std::vector<XMFLOAT3> RunRandomCrowd(uint32_t workerCount, int agents, int frames)
+{
+    CrowdConfig config;
+    config.workerCount = workerCount;
+    CrowdManager crowd;
+    crowd.Initialize(agents, config);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(0.0f, 40.0f);
+    std::vector<CrowdAgentId> ids;
+    for (int i = 0; i < agents; ++i)
+    {
+        ids.push_back(crowd.AddAgent({ coord(rng), 0.0f, coord(rng) }));
+        crowd.SetTarget(ids.back(), { coord(rng), 0.0f, coord(rng) });
+    }
+    for (int frame = 0; frame < frames; ++frame)
+        crowd.Update(k_DeltaTime);
+
+    std::vector<XMFLOAT3> positions;
+    for (CrowdAgentId id : ids)
+        positions.push_back(crowd.GetPosition(id));
+    return positions;
+}
+
+} // namespace
+
+TEST(CrowdManager, ResultsDoNotDependOnWorkerCount)
+{
+    // 空間ハッシュの構築も並列化されているが、結果はスレッド数によらず一致する
+    const auto serial   = RunRandomCrowd(1, 600, 30);
+    const auto parallel = RunRandomCrowd(4, 600, 30);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        EXPECT_EQ(serial[i].x, parallel[i].x) << i;
+        EXPECT_EQ(serial[i].z, parallel[i].z) << i;
+    }
+}
+
+// ============================================================================
+// ベンチマーク（5,000 エージェント、既定では実行しない）
+// 実行: GXLibTests --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* --gtest_output=xml
+// ============================================================================
+
+TEST(CrowdManagerBenchmark, DISABLED_FiveThousandAgents)
+{
+    CrowdManager crowd;
+    crowd.Initialize(5000);
+
+    // 100x100 の領域にランダム配置し、ランダムな目標へ向かわせる
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(0.0f, 100.0f);
+    std::vector<CrowdAgentId> ids;
+    for (int i = 0; i < 5000; ++i)
+    {
+        ids.push_back(crowd.AddAgent({ coord(rng), 0.0f, coord(rng) }));
+        crowd.SetTarget(ids.back(), { coord(rng), 0.0f, coord(rng) });
+    }
+
+    for (int frame = 0; frame < 10; ++frame)
+        crowd.Update(k_DeltaTime);
+
+    using Clock = std::chrono::steady_clock;
+    constexpr int k_Frames = 60;
+    auto t0 = Clock::now();
+    for (int frame = 0; frame < k_Frames; ++frame)
+        crowd.Update(k_DeltaTime);
+    const double msPerUpdate = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / k_Frames;
+
+    RecordProperty("Threads", static_cast<int>(crowd.GetWorkerCount() + 1));
+    RecordProperty("MsPerUpdate", std::to_string(msPerUpdate));
+
+    // 目標: 8コアで 5,000 エージェントの Update が 2ms 未満 (Releaseビルド)。
+    // コア数が足りない環境では計測値の記録のみ行う
+    if (crowd.GetWorkerCount() + 1 >= 8)
+        EXPECT_LT(msPerUpdate, 2.0);
+}
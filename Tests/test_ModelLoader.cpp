@@ -0,0 +1,209 @@
+/// @file test_ModelLoader.cpp
+/// @brief GXMD量子化頂点フォーマットのエンコード/デコードとgxloaderでの展開 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <model_loader.h>
+
+namespace
+{
+
+/// 量子化メッシュ1つだけのGXMDをメモリ上に組み立てる
+std::vector<uint8_t> BuildGxmd(const std::vector<gxfmt::VertexSkinned>& vertices, uint32_t flags)
+{
+    const gxfmt::VertexLayout layout = gxfmt::GetVertexLayout(flags);
+
+    gxfmt::MeshChunk chunk{};
+    chunk.nameIndex = gxfmt::k_InvalidStringIndex;
+    chunk.vertexCount = static_cast<uint32_t>(vertices.size());
+    chunk.indexCount = static_cast<uint32_t>(vertices.size());
+    chunk.vertexFormatFlags = flags;
+    chunk.vertexStride = layout.stride;
+    chunk.indexFormat = gxfmt::IndexFormat::UInt32;
+    for (int j = 0; j < 3; ++j)
+    {
+        chunk.aabbMin[j] = 1e30f;
+        chunk.aabbMax[j] = -1e30f;
+        for (auto& v : vertices)
+        {
+            chunk.aabbMin[j] = (std::min)(chunk.aabbMin[j], v.position[j]);
+            chunk.aabbMax[j] = (std::max)(chunk.aabbMax[j], v.position[j]);
+        }
+    }
+
+    std::vector<uint8_t> vertexData(vertices.size() * layout.stride);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const auto& v = vertices[i];
+        uint8_t* dst = vertexData.data() + i * layout.stride;
+        uint16_t pos[4];
+        gxfmt::QuantizePosition(v.position, chunk.aabbMin, chunk.aabbMax, pos);
+        std::memcpy(dst + layout.position, pos, 8);
+        int16_t n[2];
+        gxfmt::EncodeOctNormal(v.normal, n);
+        std::memcpy(dst + layout.normal, n, 4);
+        const uint16_t uv[2] = { gxfmt::FloatToHalf(v.uv0[0]), gxfmt::FloatToHalf(v.uv0[1]) };
+        std::memcpy(dst + layout.uv0, uv, 4);
+        int16_t t[2];
+        gxfmt::EncodeOctTangent(v.tangent, t);
+        std::memcpy(dst + layout.tangent, t, 4);
+        uint32_t w[4];
+        gxfmt::QuantizeWeights(v.weights, 255, w);
+        for (int j = 0; j < 4; ++j)
+        {
+            dst[layout.joints + j] = static_cast<uint8_t>(v.joints[j]);
+            dst[layout.weights + j] = static_cast<uint8_t>(w[j]);
+        }
+    }
+
+    gxfmt::FileHeader header{};
+    header.magic = gxfmt::k_GxmdMagic;
+    header.version = gxfmt::k_GxmdVersion;
+    header.meshCount = 1;
+    header.stringTableOffset = sizeof(gxfmt::FileHeader);
+    header.meshChunkOffset = header.stringTableOffset + 4;
+    header.materialChunkOffset = header.meshChunkOffset + sizeof(gxfmt::MeshChunk);
+    header.vertexDataOffset = header.materialChunkOffset;
+    header.indexDataOffset = header.vertexDataOffset + vertexData.size();
+    header.vertexDataSize = static_cast<uint32_t>(vertexData.size());
+    header.indexDataSize = chunk.indexCount * 4;
+
+    std::vector<uint8_t> data(header.indexDataOffset + header.indexDataSize, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + header.meshChunkOffset, &chunk, sizeof(chunk));
+    std::memcpy(data.data() + header.vertexDataOffset, vertexData.data(), vertexData.size());
+    for (uint32_t i = 0; i < chunk.indexCount; ++i)
+        std::memcpy(data.data() + header.indexDataOffset + i * 4, &i, 4);
+    return data;
+}
+
+} // namespace
+
+// ============================================================================
+// gxfmt 量子化ヘルパー
+// ============================================================================
+
+TEST(VertexQuantizeTest, LayoutStrides)
+{
+    using namespace gxfmt;
+    EXPECT_EQ(GetVertexLayout(VF_Standard).stride, 48u);
+    EXPECT_EQ(GetVertexLayout(VF_Skinned).stride, 80u);
+    EXPECT_EQ(GetVertexLayout(VF_Standard | VF_PositionQ16 | VF_NormalOct | VF_UV0Half | VF_TangentOct).stride, 20u);
+    EXPECT_EQ(GetVertexLayout(VF_Skinned | (VF_QuantizedMask & ~VF_WeightsU16)).stride, 28u);
+    EXPECT_EQ(GetVertexLayout(VF_Skinned | (VF_QuantizedMask & ~VF_WeightsU8)).stride, 32u);
+    EXPECT_EQ(GetVertexLayout(VF_Position).normal, k_NoVertexAttribute);
+}
+
+TEST(VertexQuantizeTest, HalfRoundTrip)
+{
+    // 全ての有限halfはfloat経由で同じビット列に戻る
+    for (uint32_t h = 0; h < 0x10000; ++h)
+    {
+        if (((h >> 10) & 0x1F) == 0x1F)
+            continue;
+        ASSERT_EQ(gxfmt::FloatToHalf(gxfmt::HalfToFloat(static_cast<uint16_t>(h))), h);
+    }
+    EXPECT_EQ(gxfmt::FloatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(gxfmt::FloatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(gxfmt::FloatToHalf(1e6f), 0x7BFF); // 飽和
+    EXPECT_FLOAT_EQ(gxfmt::HalfToFloat(gxfmt::FloatToHalf(0.333f)), 0.33300781f);
+}
+
+TEST(VertexQuantizeTest, OctahedralNormalAndTangent)
+{
+    const float dirs[][3] = {
+        { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { 0, -1, 0 },
+        { 0.577350f, -0.577350f, -0.577350f }, { -0.267261f, 0.534522f, 0.801784f },
+    };
+    for (auto& d : dirs)
+    {
+        int16_t n[2];
+        float out[3];
+        gxfmt::EncodeOctNormal(d, n);
+        gxfmt::DecodeOctNormal(n, out);
+        for (int j = 0; j < 3; ++j)
+            EXPECT_NEAR(out[j], d[j], 1e-4f);
+
+        for (float sign : { 1.0f, -1.0f })
+        {
+            const float t[4] = { d[0], d[1], d[2], sign };
+            int16_t e[2];
+            float tout[4];
+            gxfmt::EncodeOctTangent(t, e);
+            gxfmt::DecodeOctTangent(e, tout);
+            for (int j = 0; j < 3; ++j)
+                EXPECT_NEAR(tout[j], d[j], 2e-4f);
+            EXPECT_EQ(tout[3], sign);
+        }
+    }
+}
+
+TEST(VertexQuantizeTest, WeightsKeepSum)
+{
+    const float w[4] = { 0.333f, 0.333f, 0.334f, 0.0f };
+    for (uint32_t maxValue : { 255u, 65535u })
+    {
+        uint32_t q[4];
+        gxfmt::QuantizeWeights(w, maxValue, q);
+        EXPECT_EQ(q[0] + q[1] + q[2] + q[3], maxValue);
+        for (int j = 0; j < 4; ++j)
+            EXPECT_NEAR(q[j] / static_cast<float>(maxValue), w[j], 2.0f / maxValue);
+    }
+}
+
+// ============================================================================
+// gxloader 展開
+// ============================================================================
+
+TEST(ModelLoaderTest, DecodesQuantizedVertices)
+{
+    std::vector<gxfmt::VertexSkinned> vertices(3);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        auto& v = vertices[i];
+        const float f = static_cast<float>(i);
+        v.position[0] = -2.0f + f * 3.0f;
+        v.position[1] = 10.0f;
+        v.position[2] = f * 0.25f;
+        v.normal[2] = 1.0f;
+        v.uv0[0] = 0.125f * f;
+        v.uv0[1] = 1.0f - 0.5f * f;
+        v.tangent[0] = 1.0f;
+        v.tangent[3] = i == 1 ? -1.0f : 1.0f;
+        v.joints[0] = static_cast<uint32_t>(i);
+        v.joints[1] = 200;
+        v.weights[0] = 0.75f;
+        v.weights[1] = 0.25f;
+    }
+
+    const uint32_t flags = gxfmt::VF_Skinned | gxfmt::VF_PositionQ16 | gxfmt::VF_NormalOct
+                         | gxfmt::VF_UV0Half | gxfmt::VF_TangentOct | gxfmt::VF_Joints8 | gxfmt::VF_WeightsU8;
+    const std::vector<uint8_t> data = BuildGxmd(vertices, flags);
+
+    auto model = gxloader::LoadGxmdFromMemory(data.data(), data.size());
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->version, gxfmt::k_GxmdVersion);
+    ASSERT_TRUE(model->isSkinned);
+    ASSERT_EQ(model->skinnedVertices.size(), vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const auto& expected = vertices[i];
+        const auto& actual = model->skinnedVertices[i];
+        for (int j = 0; j < 3; ++j)
+        {
+            EXPECT_NEAR(actual.position[j], expected.position[j], 1e-4f);
+            EXPECT_NEAR(actual.normal[j], expected.normal[j], 1e-4f);
+            EXPECT_NEAR(actual.tangent[j], expected.tangent[j], 1e-4f);
+        }
+        EXPECT_EQ(actual.tangent[3], expected.tangent[3]);
+        EXPECT_FLOAT_EQ(actual.uv0[0], expected.uv0[0]);
+        EXPECT_FLOAT_EQ(actual.uv0[1], expected.uv0[1]);
+        for (int j = 0; j < 4; ++j)
+        {
+            EXPECT_EQ(actual.joints[j], expected.joints[j]);
+            EXPECT_NEAR(actual.weights[j], expected.weights[j], 1.0f / 255.0f);
+        }
+    }
+}
@@ -0,0 +1,903 @@
+/// @file test_NavMesh.cpp
+/// @brief NavMesh 経路探索（A*/JPS/HPA*/フローフィールド/非同期リクエスト）単体テストとベンチマーク
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <queue>
+#include "AI/NavMesh.h"
+#include "AI/PathQueryContext.h"
+#include "AI/FlowField.h"
+#include "AI/NavAgent.h"
+#include "AI/PathRequestQueue.h"
+#include "gxnav.h"
+
+using namespace GX;
+
+namespace
+{
+
+/// テスト用のグリッド定義（NavMesh に流し込む元データ）
+struct TestGrid
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> walkable;
+    std::vector<float> cost;
+
+    bool IsOpen(int x, int z) const
+    {
+        return x >= 0 && x < width && z >= 0 && z < height && walkable[z * width + x];
+    }
+};
+
+/// ランダムな障害物（とコスト）を持つグリッドを作る
+TestGrid MakeRandomGrid(int width, int height, float blockedRatio, float costRatio, uint32_t seed)
+{
+    TestGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.walkable.assign(width * height, 1);
+    grid.cost.assign(width * height, 1.0f);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int i = 0; i < width * height; ++i)
+    {
+        if (dist(rng) < blockedRatio)
+            grid.walkable[i] = 0;
+        else if (dist(rng) < costRatio)
+            grid.cost[i] = 1.5f + dist(rng) * 2.0f;
+    }
+    return grid;
+}
+
+/// 開けた領域に矩形の障害物を並べたグリッドを作る（屋外マップ相当）
+TestGrid MakeBlockGrid(int width, int height, int blockCount, uint32_t seed)
+{
+    TestGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.walkable.assign(width * height, 1);
+    grid.cost.assign(width * height, 1.0f);
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> px(0, width - 1), pz(0, height - 1), size(2, 24);
+    for (int i = 0; i < blockCount; ++i)
+    {
+        int x0 = px(rng), z0 = pz(rng), w = size(rng), h = size(rng);
+        for (int z = z0; z < std::min(height, z0 + h); ++z)
+            for (int x = x0; x < std::min(width, x0 + w); ++x)
+                grid.walkable[z * width + x] = 0;
+    }
+    return grid;
+}
+
+/// 1セル = 1ワールド単位の NavMesh に TestGrid を反映する
+void ApplyGrid(NavMesh& navMesh, const TestGrid& grid)
+{
+    navMesh.Build(0.0f, 0.0f, static_cast<float>(grid.width), static_cast<float>(grid.height), 1.0f);
+    for (int z = 0; z < grid.height; ++z)
+    {
+        for (int x = 0; x < grid.width; ++x)
+        {
+            navMesh.SetCellWalkable(x, z, grid.walkable[z * grid.width + x] != 0);
+            navMesh.SetCellCost(x, z, grid.cost[z * grid.width + x]);
+        }
+    }
+}
+
+XMFLOAT3 CellCenter(int x, int z)
+{
+    return { x + 0.5f, 0.0f, z + 0.5f };
+}
+
+/// 以前の実装と同じ素朴な A*（毎回グリッド全体の配列を確保する）。正解値とベースラインに使う
+float ReferenceAStar(const TestGrid& grid, int sx, int sz, int ex, int ez)
+{
+    static const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    static const int dz[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static const float moveCost[] = { 1.414f, 1.0f, 1.414f, 1.0f, 1.0f, 1.414f, 1.0f, 1.414f };
+
+    auto heuristic = [](int x1, int z1, int x2, int z2) {
+        int ax = std::abs(x2 - x1), az = std::abs(z2 - z1);
+        return static_cast<float>(std::max(ax, az)) + 0.414f * static_cast<float>(std::min(ax, az));
+    };
+
+    const size_t size = static_cast<size_t>(grid.width) * grid.height;
+    std::vector<bool> closed(size, false);
+    std::vector<float> gScore(size, FLT_MAX);
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    gScore[sz * grid.width + sx] = 0.0f;
+    open.push({ heuristic(sx, sz, ex, ez), sz * grid.width + sx });
+
+    while (!open.empty())
+    {
+        int cur = open.top().second;
+        open.pop();
+        if (closed[cur]) continue;
+        closed[cur] = true;
+
+        int cx = cur % grid.width, cz = cur / grid.width;
+        if (cx == ex && cz == ez)
+            return gScore[cur];
+
+        for (int d = 0; d < 8; ++d)
+        {
+            int nx = cx + dx[d], nz = cz + dz[d];
+            if (!grid.IsOpen(nx, nz)) continue;
+            if (dx[d] != 0 && dz[d] != 0 && (!grid.IsOpen(nx, cz) || !grid.IsOpen(cx, nz)))
+                continue;
+
+            int n = nz * grid.width + nx;
+            float g = gScore[cur] + moveCost[d] * grid.cost[n];
+            if (g < gScore[n])
+            {
+                gScore[n] = g;
+                open.push({ g + heuristic(nx, nz, ex, ez), n });
+            }
+        }
+    }
+    return -1.0f;
+}
+
+/// 経路（セル中心の列）を検証し、そのコストを返す。不正な移動があれば -1
+float MeasurePath(const TestGrid& grid, const std::vector<XMFLOAT3>& path)
+{
+    float total = 0.0f;
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        int px = static_cast<int>(std::floor(path[i - 1].x)), pz = static_cast<int>(std::floor(path[i - 1].z));
+        int x = static_cast<int>(std::floor(path[i].x)), z = static_cast<int>(std::floor(path[i].z));
+        int ax = std::abs(x - px), az = std::abs(z - pz);
+        if (ax > 1 || az > 1 || (ax == 0 && az == 0) || !grid.IsOpen(x, z))
+            return -1.0f;
+        if (ax == 1 && az == 1 && (!grid.IsOpen(x, pz) || !grid.IsOpen(px, z)))
+            return -1.0f;
+        total += (ax + az == 2 ? 1.414f : 1.0f) * grid.cost[z * grid.width + x];
+    }
+    return total;
+}
+
+/// 歩行可能なセルをランダムに選ぶ
+void PickOpenCell(const TestGrid& grid, std::mt19937& rng, int& x, int& z)
+{
+    std::uniform_int_distribution<int> dx(0, grid.width - 1), dz(0, grid.height - 1);
+    do { x = dx(rng); z = dz(rng); } while (!grid.IsOpen(x, z));
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// PathQueryContext（世代スタンプ付きノード配列 + インデックス付き二分ヒープ）
+// ============================================================================
+
+TEST(PathQueryContextTest, DecreaseKeyReordersHeap)
+{
+    PathQueryContext ctx;
+    ctx.Begin(8);
+    ctx.Push(0, 5.0f, 5.0f, -1);
+    ctx.Push(1, 3.0f, 3.0f, -1);
+    ctx.Push(2, 4.0f, 4.0f, -1);
+
+    // 既にヒープにあるノードのキーを下げる
+    EXPECT_TRUE(ctx.Push(0, 1.0f, 1.0f, 2));
+    // 悪化する更新は無視される
+    EXPECT_FALSE(ctx.Push(1, 9.0f, 9.0f, 0));
+
+    EXPECT_EQ(ctx.PopMin(), 0);
+    EXPECT_EQ(ctx.GetParent(0), 2);
+    EXPECT_EQ(ctx.PopMin(), 1);
+    EXPECT_EQ(ctx.PopMin(), 2);
+    EXPECT_EQ(ctx.PopMin(), -1);
+    EXPECT_TRUE(ctx.IsClosed(1));
+}
+
+TEST(PathQueryContextTest, BeginInvalidatesPreviousQuery)
+{
+    PathQueryContext ctx;
+    ctx.Begin(4);
+    ctx.Push(3, 2.0f, 2.0f, -1);
+    ctx.PopMin();
+    EXPECT_TRUE(ctx.IsClosed(3));
+
+    ctx.Begin(4);
+    EXPECT_FALSE(ctx.IsTouched(3));
+    EXPECT_EQ(ctx.GetCost(3), FLT_MAX);
+    EXPECT_TRUE(ctx.IsOpenEmpty());
+}
+
+// ============================================================================
+// FindPath（A* / JPS）
+// ============================================================================
+
+TEST(NavMeshTest, JumpPointSearchMatchesReferenceCost)
+{
+    TestGrid grid = MakeRandomGrid(64, 64, 0.25f, 0.0f, 1234);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+
+    std::mt19937 rng(42);
+    std::vector<XMFLOAT3> path;
+    for (int i = 0; i < 200; ++i)
+    {
+        int sx, sz, ex, ez;
+        PickOpenCell(grid, rng, sx, sz);
+        PickOpenCell(grid, rng, ex, ez);
+
+        float expected = ReferenceAStar(grid, sx, sz, ex, ez);
+        bool found = navMesh.FindPath(CellCenter(sx, sz), CellCenter(ex, ez), path);
+        ASSERT_EQ(found, expected >= 0.0f);
+        if (!found || (sx == ex && sz == ez)) continue;
+
+        EXPECT_NEAR(MeasurePath(grid, path), expected, 1e-3f);
+    }
+}
+
+TEST(NavMeshTest, MixedCostRegionsMatchReferenceCost)
+{
+    TestGrid grid = MakeRandomGrid(48, 48, 0.2f, 0.15f, 777);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+
+    std::mt19937 rng(7);
+    std::vector<XMFLOAT3> path;
+    for (int i = 0; i < 200; ++i)
+    {
+        int sx, sz, ex, ez;
+        PickOpenCell(grid, rng, sx, sz);
+        PickOpenCell(grid, rng, ex, ez);
+
+        float expected = ReferenceAStar(grid, sx, sz, ex, ez);
+        bool found = navMesh.FindPath(CellCenter(sx, sz), CellCenter(ex, ez), path);
+        ASSERT_EQ(found, expected >= 0.0f);
+        if (!found || (sx == ex && sz == ez)) continue;
+
+        EXPECT_NEAR(MeasurePath(grid, path), expected, 1e-3f);
+    }
+}
+
+// ============================================================================
+// HPA*（クラスタ階層）
+// ============================================================================
+
+TEST(NavMeshTest, HierarchyFindsValidNearOptimalPaths)
+{
+    TestGrid grid = MakeRandomGrid(96, 96, 0.2f, 0.05f, 99);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+    ASSERT_TRUE(navMesh.BuildHierarchy(16));
+
+    std::mt19937 rng(3);
+    std::vector<XMFLOAT3> path;
+    for (int i = 0; i < 100; ++i)
+    {
+        int sx, sz, ex, ez;
+        PickOpenCell(grid, rng, sx, sz);
+        PickOpenCell(grid, rng, ex, ez);
+
+        float expected = ReferenceAStar(grid, sx, sz, ex, ez);
+        bool found = navMesh.FindPath(CellCenter(sx, sz), CellCenter(ex, ez), path);
+        ASSERT_EQ(found, expected >= 0.0f);
+        if (!found || (sx == ex && sz == ez)) continue;
+
+        float cost = MeasurePath(grid, path);
+        EXPECT_GE(cost, expected - 1e-3f);
+        EXPECT_LE(cost, expected * 1.3f + 2.0f);
+    }
+}
+
+TEST(NavMeshTest, HierarchyInvalidatesEditedClusters)
+{
+    // 中央に壁があり、1セルの隙間だけが通れるマップ
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 32.0f, 32.0f, 1.0f);
+    for (int z = 0; z < 32; ++z)
+        navMesh.SetCellWalkable(16, z, z == 5);
+    ASSERT_TRUE(navMesh.BuildHierarchy(8));
+
+    std::vector<XMFLOAT3> path;
+    ASSERT_TRUE(navMesh.FindPath(CellCenter(2, 20), CellCenter(30, 20), path));
+
+    // 隙間を塞ぐと到達不能になる
+    navMesh.SetCellWalkable(16, 5, false);
+    EXPECT_FALSE(navMesh.FindPath(CellCenter(2, 20), CellCenter(30, 20), path));
+
+    // 別の場所を開けると、その隙間を通る経路になる
+    navMesh.SetCellWalkable(16, 25, true);
+    ASSERT_TRUE(navMesh.FindPath(CellCenter(2, 20), CellCenter(30, 20), path));
+    bool crossesGap = false;
+    for (const auto& p : path)
+        crossesGap |= (static_cast<int>(p.x) == 16 && static_cast<int>(p.z) == 25);
+    EXPECT_TRUE(crossesGap);
+}
+
+// ============================================================================
+// シリアライズ（.gxnav）
+// ============================================================================
+
+TEST(NavMeshSerializeTest, RoundTripPreservesPathsAndHierarchy)
+{
+    // コストは 1/16 単位で量子化されるため、表現できる値だけを使う
+    TestGrid grid = MakeRandomGrid(64, 64, 0.2f, 0.1f, 21);
+    for (float& c : grid.cost)
+        c = std::round(c * 16.0f) / 16.0f;
+
+    NavMesh source;
+    ApplyGrid(source, grid);
+    ASSERT_TRUE(source.BuildHierarchy(8));
+
+    std::vector<uint8_t> blob;
+    ASSERT_TRUE(source.Serialize(blob));
+    EXPECT_EQ(blob.size(), 64u + 16u + 64u * 64u * 4u);
+
+    NavMesh loaded;
+    ASSERT_TRUE(loaded.LoadFromMemory(blob.data(), blob.size()));
+    EXPECT_EQ(loaded.GetGridWidth(), 64);
+    EXPECT_EQ(loaded.GetGridHeight(), 64);
+    EXPECT_FLOAT_EQ(loaded.GetCellSize(), 1.0f);
+    EXPECT_EQ(loaded.GetClusterSize(), 8);
+
+    std::mt19937 rng(6);
+    std::vector<XMFLOAT3> pathA, pathB;
+    for (int i = 0; i < 50; ++i)
+    {
+        int sx, sz, ex, ez;
+        PickOpenCell(grid, rng, sx, sz);
+        PickOpenCell(grid, rng, ex, ez);
+        const bool foundA = source.FindPath(CellCenter(sx, sz), CellCenter(ex, ez), pathA);
+        const bool foundB = loaded.FindPath(CellCenter(sx, sz), CellCenter(ex, ez), pathB);
+        ASSERT_EQ(foundA, foundB);
+        if (foundA && !(sx == ex && sz == ez))
+            EXPECT_NEAR(MeasurePath(grid, pathA), MeasurePath(grid, pathB), 1e-3f);
+    }
+}
+
+TEST(NavMeshSerializeTest, HighCostsSurviveRoundTrip)
+{
+    // 10 を超えるコスト (水を避ける等) は対数域で保存され、ほぼ同じ値に戻る
+    for (float cost : { 1.5f, 10.0f, 20.0f, 50.0f, 300.0f, 2000.0f })
+    {
+        const uint8_t value = gxfmt::EncodeGxnavCost(cost);
+        EXPECT_NEAR(gxfmt::DecodeGxnavCost(value), cost, cost * 0.03f) << cost;
+    }
+    EXPECT_FLOAT_EQ(gxfmt::DecodeGxnavCost(gxfmt::EncodeGxnavCost(1.0f)), 1.0f);
+    EXPECT_FLOAT_EQ(gxfmt::DecodeGxnavCost(gxfmt::EncodeGxnavCost(20.0f)), 20.0f);
+    EXPECT_EQ(gxfmt::EncodeGxnavCost(1e6f), 255);
+
+    // 高コストの帯 (コスト50) を迂回する経路が読み込み後も変わらない
+    NavMesh source;
+    source.Build(0.0f, 0.0f, 32.0f, 32.0f, 1.0f);
+    for (int z = 0; z < 28; ++z)
+        for (int x = 14; x < 18; ++x)
+            source.SetCellCost(x, z, 50.0f);
+
+    std::vector<uint8_t> blob;
+    ASSERT_TRUE(source.Serialize(blob));
+    NavMesh loaded;
+    ASSERT_TRUE(loaded.LoadFromMemory(blob.data(), blob.size()));
+
+    std::vector<XMFLOAT3> pathA, pathB;
+    ASSERT_TRUE(source.FindPath(CellCenter(2, 2), CellCenter(29, 2), pathA));
+    ASSERT_TRUE(loaded.FindPath(CellCenter(2, 2), CellCenter(29, 2), pathB));
+    ASSERT_EQ(pathA.size(), pathB.size());
+    for (size_t i = 0; i < pathA.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(pathA[i].x, pathB[i].x);
+        EXPECT_FLOAT_EQ(pathA[i].z, pathB[i].z);
+    }
+    // 迂回しているので帯の端 (z=28) より先を通る
+    float maxZ = 0.0f;
+    for (const auto& p : pathB)
+        maxZ = std::max(maxZ, p.z);
+    EXPECT_GE(maxZ, 28.0f);
+}
+
+TEST(NavMeshSerializeTest, HeightsAreQuantizedTo16Bits)
+{
+    // X 方向に 0 → 8 の高さで傾いた 32x32 の板
+    const float vertices[] = {
+        0.0f, 0.0f, 0.0f,   32.0f, 8.0f, 0.0f,   32.0f, 8.0f, 32.0f,   0.0f, 0.0f, 32.0f,
+    };
+    const int indices[] = { 0, 2, 1, 0, 3, 2 };
+    NavMesh source;
+    ASSERT_TRUE(source.BuildFromGeometry(vertices, 4, indices, 6));
+
+    std::vector<uint8_t> blob;
+    ASSERT_TRUE(source.Serialize(blob));
+    NavMesh loaded;
+    ASSERT_TRUE(loaded.LoadFromMemory(blob.data(), blob.size()));
+
+    std::vector<XMFLOAT3> pathA, pathB;
+    ASSERT_TRUE(source.FindPath({ 1.0f, 0.0f, 16.0f }, { 31.0f, 8.0f, 16.0f }, pathA));
+    ASSERT_TRUE(loaded.FindPath({ 1.0f, 0.0f, 16.0f }, { 31.0f, 8.0f, 16.0f }, pathB));
+    ASSERT_EQ(pathA.size(), pathB.size());
+    for (size_t i = 0; i < pathA.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(pathA[i].x, pathB[i].x);
+        EXPECT_NEAR(pathA[i].y, pathB[i].y, 8.0f / 65535.0f);
+    }
+}
+
+TEST(NavMeshSerializeTest, RejectsCorruptBlobs)
+{
+    NavMesh source;
+    source.Build(0.0f, 0.0f, 16.0f, 16.0f, 1.0f);
+    std::vector<uint8_t> blob;
+    ASSERT_TRUE(source.Serialize(blob));
+
+    NavMesh target;
+    target.Build(0.0f, 0.0f, 8.0f, 8.0f, 1.0f);
+
+    // 途中で切れたデータ
+    EXPECT_FALSE(target.LoadFromMemory(blob.data(), blob.size() - 1));
+    EXPECT_FALSE(target.LoadFromMemory(blob.data(), 32));
+
+    // 識別子とバージョンの不一致
+    std::vector<uint8_t> bad = blob;
+    bad[0] ^= 0xFF;
+    EXPECT_FALSE(target.LoadFromMemory(bad.data(), bad.size()));
+    bad = blob;
+    bad[4] = 99;
+    EXPECT_FALSE(target.LoadFromMemory(bad.data(), bad.size()));
+
+    // 失敗しても元のグリッドは残る
+    EXPECT_EQ(target.GetGridWidth(), 8);
+    EXPECT_TRUE(target.LoadFromMemory(blob.data(), blob.size()));
+    EXPECT_EQ(target.GetGridWidth(), 16);
+}
+
+// ============================================================================
+// フローフィールド
+// ============================================================================
+
+namespace
+{
+
+/// セクタの計算を待ってからサンプルする
+FlowFieldStatus SampleAndWait(FlowField& field, const XMFLOAT3& position, XMFLOAT3& direction)
+{
+    // 1 回目でゴール、2 回目でセクタの計算が始まる
+    FlowFieldStatus status = field.Sample(position, direction);
+    for (int i = 0; i < 2 && status == FlowFieldStatus::Pending; ++i)
+    {
+        field.WaitIdle();
+        status = field.Sample(position, direction);
+    }
+    return status;
+}
+
+/// 方向場をセル単位でたどり、ゴールに着くまでのコストを返す（着かなければ -1）
+float FollowField(FlowField& field, const TestGrid& grid, int sx, int sz, int ex, int ez)
+{
+    float total = 0.0f;
+    int x = sx, z = sz;
+    for (int step = 0; step < grid.width * grid.height; ++step)
+    {
+        if (x == ex && z == ez)
+            return total;
+
+        XMFLOAT3 dir;
+        if (SampleAndWait(field, CellCenter(x, z), dir) != FlowFieldStatus::Ready)
+            return -1.0f;
+        const int nx = x + (dir.x > 0.1f ? 1 : dir.x < -0.1f ? -1 : 0);
+        const int nz = z + (dir.z > 0.1f ? 1 : dir.z < -0.1f ? -1 : 0);
+        if (!grid.IsOpen(nx, nz) || (nx == x && nz == z))
+            return -1.0f;
+        if (nx != x && nz != z && (!grid.IsOpen(nx, z) || !grid.IsOpen(x, nz)))
+            return -1.0f;
+        total += (nx != x && nz != z ? 1.414f : 1.0f) * grid.cost[nz * grid.width + nx];
+        x = nx;
+        z = nz;
+    }
+    return -1.0f;
+}
+
+} // anonymous namespace
+
+TEST(FlowFieldTest, WholeGridFieldMatchesReferenceCost)
+{
+    TestGrid grid = MakeRandomGrid(48, 48, 0.2f, 0.1f, 5);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+
+    int ex, ez;
+    std::mt19937 rng(8);
+    PickOpenCell(grid, rng, ex, ez);
+
+    FlowField field;
+    ASSERT_TRUE(field.Initialize(&navMesh));
+    field.SetGoal(CellCenter(ex, ez));
+
+    // 階層なしではグリッド全体が 1 セクタ。積分値は最短経路コストと一致する
+    for (int i = 0; i < 60; ++i)
+    {
+        int sx, sz;
+        PickOpenCell(grid, rng, sx, sz);
+        const float expected = ReferenceAStar(grid, sx, sz, ex, ez);
+
+        XMFLOAT3 dir;
+        const FlowFieldStatus status = SampleAndWait(field, CellCenter(sx, sz), dir);
+        if (expected < 0.0f)
+        {
+            EXPECT_EQ(status, FlowFieldStatus::Unreachable);
+            continue;
+        }
+        ASSERT_EQ(status, FlowFieldStatus::Ready);
+
+        float cost = 0.0f;
+        ASSERT_TRUE(field.GetCostToGoal(CellCenter(sx, sz), cost));
+        EXPECT_NEAR(cost, expected, 1e-2f);
+        EXPECT_NEAR(FollowField(field, grid, sx, sz, ex, ez), expected, 1e-2f);
+    }
+    EXPECT_EQ(field.GetSectorCount(), 1u);
+}
+
+TEST(FlowFieldTest, SectorsAreComputedOnDemand)
+{
+    TestGrid grid = MakeRandomGrid(96, 96, 0.2f, 0.05f, 99);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+    ASSERT_TRUE(navMesh.BuildHierarchy(16));
+
+    int ex = 90, ez = 90;
+    grid.walkable[ez * grid.width + ex] = 1;
+    navMesh.SetCellWalkable(ex, ez, true);
+
+    FlowField field;
+    ASSERT_TRUE(field.Initialize(&navMesh));
+    field.SetGoal(CellCenter(ex, ez));
+    field.WaitIdle();
+    ASSERT_EQ(field.GetSectorCount(), 36u);
+    EXPECT_EQ(field.GetComputedSectorCount(), 0u);
+
+    // 左上の 1 セクタからたどると、通過するセクタだけが計算される
+    int sx, sz;
+    std::mt19937 rng(4);
+    do { sx = rng() % 16; sz = rng() % 16; } while (!grid.IsOpen(sx, sz));
+
+    const float expected = ReferenceAStar(grid, sx, sz, ex, ez);
+    ASSERT_GT(expected, 0.0f);
+    const float cost = FollowField(field, grid, sx, sz, ex, ez);
+    EXPECT_GE(cost, expected - 1e-3f);
+    EXPECT_LE(cost, expected * 1.3f + 2.0f);
+
+    const uint32_t computed = field.GetComputedSectorCount();
+    EXPECT_GE(computed, 6u);
+    EXPECT_LT(computed, 36u);
+}
+
+TEST(FlowFieldTest, SameGoalCellReusesField)
+{
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 64.0f, 64.0f, 1.0f);
+    ASSERT_TRUE(navMesh.BuildHierarchy(16));
+
+    FlowField field;
+    ASSERT_TRUE(field.Initialize(&navMesh));
+    field.SetGoal({ 60.2f, 0.0f, 60.2f });
+
+    XMFLOAT3 dir;
+    ASSERT_EQ(SampleAndWait(field, CellCenter(2, 2), dir), FlowFieldStatus::Ready);
+    EXPECT_GT(dir.x, 0.5f);
+    EXPECT_GT(dir.z, 0.5f);
+    const uint32_t revision = field.GetGoalRevision();
+    const uint32_t computed = field.GetComputedSectorCount();
+
+    // 同じセル内での移動は計算済みのセクタをそのまま使う
+    field.SetGoal({ 60.8f, 0.0f, 60.7f });
+    EXPECT_EQ(field.GetGoalRevision(), revision);
+    EXPECT_EQ(field.GetComputedSectorCount(), computed);
+    EXPECT_EQ(field.Sample(CellCenter(2, 2), dir), FlowFieldStatus::Ready);
+
+    // 別のセルに移ると作り直す
+    field.SetGoal({ 3.5f, 0.0f, 60.5f });
+    EXPECT_NE(field.GetGoalRevision(), revision);
+    ASSERT_EQ(SampleAndWait(field, CellCenter(2, 2), dir), FlowFieldStatus::Ready);
+    EXPECT_GT(dir.z, 0.5f);
+    float cost = 0.0f;
+    ASSERT_TRUE(field.GetCostToGoal(CellCenter(2, 2), cost));
+    EXPECT_NEAR(cost, 58.414f, 2.0f);
+}
+
+TEST(FlowFieldTest, AgentsFollowSharedField)
+{
+    // 中央に隙間のある壁
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 48.0f, 48.0f, 1.0f);
+    for (int z = 0; z < 48; ++z)
+        navMesh.SetCellWalkable(24, z, z >= 40 && z < 44);
+    ASSERT_TRUE(navMesh.BuildHierarchy(8));
+
+    FlowField field;
+    ASSERT_TRUE(field.Initialize(&navMesh));
+    const XMFLOAT3 goal = { 44.5f, 0.0f, 4.5f };
+    field.SetGoal(goal);
+
+    std::vector<NavAgent> agents(6);
+    for (size_t i = 0; i < agents.size(); ++i)
+    {
+        agents[i].Initialize(&navMesh);
+        agents[i].SetPosition({ 3.5f + i * 3.0f, 0.0f, 3.5f + i * 2.0f });
+        agents[i].SetFlowField(&field);
+        EXPECT_TRUE(agents[i].IsFollowingFlowField());
+    }
+
+    for (int frame = 0; frame < 60 * 60; ++frame)
+    {
+        bool allReached = true;
+        for (auto& agent : agents)
+        {
+            agent.Update(1.0f / 60.0f);
+            ASSERT_TRUE(navMesh.IsWalkable(agent.GetPosition()));
+            allReached &= agent.HasReachedDestination();
+        }
+        if (allReached)
+            break;
+        // ワーカーの計算完了を待つ（実ゲームでは次フレーム以降に反映される）
+        field.WaitIdle();
+    }
+
+    for (const auto& agent : agents)
+    {
+        EXPECT_TRUE(agent.HasReachedDestination());
+        const XMFLOAT3 p = agent.GetPosition();
+        EXPECT_LT(std::abs(p.x - goal.x) + std::abs(p.z - goal.z), 0.5f);
+    }
+}
+
+// ============================================================================
+// 非同期リクエスト（PathRequestQueue）
+// ============================================================================
+
+namespace
+{
+
+/// Update() を回しながら結果が出るまで待つ（タイムアウト時は Pending）
+PathRequestStatus WaitForResult(PathRequestQueue& queue, uint32_t ticket, std::vector<XMFLOAT3>& path)
+{
+    for (int i = 0; i < 5000; ++i)
+    {
+        queue.Update();
+        const PathRequestStatus status = queue.Poll(ticket, path);
+        if (status != PathRequestStatus::Pending)
+            return status;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return PathRequestStatus::Pending;
+}
+
+/// 待ち行列の長さが expected になるまで待つ
+bool WaitForPendingCount(const PathRequestQueue& queue, uint32_t expected)
+{
+    for (int i = 0; i < 5000 && queue.GetPendingCount() != expected; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return queue.GetPendingCount() == expected;
+}
+
+} // anonymous namespace
+
+TEST(PathRequestQueueTest, IdenticalRequestsShareOneSearch)
+{
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 32.0f, 32.0f, 1.0f);
+    PathRequestQueue queue;
+    ASSERT_TRUE(queue.Initialize(&navMesh, 1));
+
+    // 同じセル同士の要求は1つの探索にまとめられ、高さは要求ごとに合わせて配られる
+    queue.Pause();
+    const uint32_t a = queue.Request({ 2.5f, 1.0f, 2.5f }, { 29.5f, 2.0f, 29.5f });
+    const uint32_t b = queue.Request({ 2.2f, 5.0f, 2.8f }, { 29.1f, 6.0f, 29.9f });
+    const uint32_t c = queue.Request({ 2.5f, 0.0f, 2.5f }, { 29.5f, 0.0f, 2.5f });
+    ASSERT_NE(a, 0u);
+    ASSERT_NE(b, a);
+    EXPECT_EQ(queue.GetPendingCount(), 2u);
+    queue.Resume();
+
+    std::vector<XMFLOAT3> pathA, pathB, pathC;
+    ASSERT_EQ(WaitForResult(queue, a, pathA), PathRequestStatus::Succeeded);
+    ASSERT_EQ(queue.Poll(b, pathB), PathRequestStatus::Succeeded);
+    ASSERT_EQ(pathA.size(), pathB.size());
+    EXPECT_EQ(pathA.front().y, 1.0f);
+    EXPECT_EQ(pathA.back().y, 2.0f);
+    EXPECT_EQ(pathB.front().y, 5.0f);
+    EXPECT_EQ(pathB.back().y, 6.0f);
+
+    // 取りに来ない結果も、何フレーム経っても消えない
+    ASSERT_TRUE(WaitForPendingCount(queue, 0));
+    queue.Pause();
+    queue.Resume();
+    for (int frame = 0; frame < 32; ++frame)
+        queue.Update();
+    EXPECT_EQ(queue.Poll(c, pathC), PathRequestStatus::Succeeded);
+    EXPECT_FALSE(pathC.empty());
+
+    // 受け取ったチケットは消費される
+    EXPECT_EQ(queue.Poll(a, pathA), PathRequestStatus::Unknown);
+}
+
+TEST(PathRequestQueueTest, CancelWhileRunningDiscardsResult)
+{
+    // 閉じ込められたゴール: 探索は到達可能な全域を調べてから最寄りセルへ探し直す
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 512.0f, 512.0f, 1.0f);
+    navMesh.SetJumpPointSearch(false);
+    for (int z = 499; z <= 501; ++z)
+        for (int x = 499; x <= 501; ++x)
+            navMesh.SetCellWalkable(x, z, x == 500 && z == 500);
+
+    PathRequestQueue queue;
+    ASSERT_TRUE(queue.Initialize(&navMesh, 1));
+    queue.SetFrameBudget(0.0f);
+
+    const XMFLOAT3 start = CellCenter(2, 2);
+    const XMFLOAT3 goal = CellCenter(500, 500);
+    const uint32_t ticket = queue.Request(start, goal);
+    ASSERT_NE(ticket, 0u);
+    ASSERT_TRUE(WaitForPendingCount(queue, 0)); // ワーカーが取り出した
+    queue.Cancel(ticket);
+
+    std::vector<XMFLOAT3> path;
+    EXPECT_EQ(queue.Poll(ticket, path), PathRequestStatus::Unknown);
+
+    // 探索が終わって公開されても、取り消したチケットには届かない
+    queue.Pause();
+    queue.Resume();
+    queue.Update();
+    EXPECT_EQ(queue.Poll(ticket, path), PathRequestStatus::Unknown);
+    EXPECT_TRUE(path.empty());
+
+    // 同じ要求を出し直せば結果を受け取れる (ゴールには届かないので Failed)
+    const uint32_t retry = queue.Request(start, goal);
+    EXPECT_EQ(WaitForResult(queue, retry, path), PathRequestStatus::Failed);
+}
+
+TEST(PathRequestQueueTest, PauseAllowsEditingCells)
+{
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 32.0f, 32.0f, 1.0f);
+    PathRequestQueue queue;
+    ASSERT_TRUE(queue.Initialize(&navMesh, 2));
+
+    // 一時停止中は探索が始まらない
+    queue.Pause();
+    const uint32_t ticket = queue.Request(CellCenter(2, 16), CellCenter(29, 16));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Update();
+    std::vector<XMFLOAT3> path;
+    EXPECT_EQ(queue.Poll(ticket, path), PathRequestStatus::Pending);
+    EXPECT_EQ(queue.GetPendingCount(), 1u);
+
+    // 一時停止中に壁を立てると、再開後の探索は壁を避ける
+    for (int z = 0; z < 31; ++z)
+        navMesh.SetCellWalkable(16, z, false);
+    queue.Resume();
+
+    ASSERT_EQ(WaitForResult(queue, ticket, path), PathRequestStatus::Succeeded);
+    bool throughGap = false;
+    for (const XMFLOAT3& p : path)
+    {
+        EXPECT_TRUE(navMesh.IsWalkable(p));
+        throughGap |= p.z >= 31.0f;
+    }
+    EXPECT_TRUE(throughGap);
+}
+
+TEST(PathRequestQueueTest, FrameBudgetLimitsSearchesPerUpdate)
+{
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 64.0f, 64.0f, 1.0f);
+    navMesh.SetJumpPointSearch(false);
+    PathRequestQueue queue;
+    ASSERT_TRUE(queue.Initialize(&navMesh, 1));
+
+    // 予算1us: 1フレームに1件だけ探索し、Update() で予算が戻るまで次を始めない
+    queue.SetFrameBudget(0.001f);
+    queue.Pause();
+    std::vector<uint32_t> tickets;
+    for (int i = 0; i < 4; ++i)
+        tickets.push_back(queue.Request(CellCenter(1, 1 + i), CellCenter(62, 62 - i)));
+    queue.Resume();
+
+    ASSERT_TRUE(WaitForPendingCount(queue, 3));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(queue.GetPendingCount(), 3u);
+
+    queue.Update();
+    ASSERT_TRUE(WaitForPendingCount(queue, 2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(queue.GetPendingCount(), 2u);
+
+    // 無制限にすると残りも全て届く
+    queue.SetFrameBudget(0.0f);
+    std::vector<XMFLOAT3> path;
+    for (uint32_t ticket : tickets)
+        EXPECT_EQ(WaitForResult(queue, ticket, path), PathRequestStatus::Succeeded);
+}
+
+TEST(PathRequestQueueTest, AgentRequestsAgainWhenTicketIsLost)
+{
+    NavMesh navMesh;
+    navMesh.Build(0.0f, 0.0f, 32.0f, 32.0f, 1.0f);
+    PathRequestQueue queue;
+    ASSERT_TRUE(queue.Initialize(&navMesh, 1));
+
+    NavAgent agent;
+    agent.Initialize(&navMesh);
+    agent.SetRequestQueue(&queue);
+    agent.SetPosition(CellCenter(2, 2));
+    const XMFLOAT3 goal = CellCenter(28, 20);
+    agent.SetDestination(goal);
+    EXPECT_TRUE(agent.IsPathPending());
+
+    // キューを作り直すとチケットが失われる。エージェントは要求を出し直す
+    queue.Initialize(&navMesh, 1);
+    agent.Update(1.0f / 60.0f);
+    EXPECT_TRUE(agent.IsPathPending());
+
+    for (int frame = 0; frame < 60 * 30 && !agent.HasReachedDestination(); ++frame)
+    {
+        queue.Update();
+        agent.Update(1.0f / 60.0f);
+        if (agent.IsPathPending())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(agent.HasReachedDestination());
+    const XMFLOAT3 p = agent.GetPosition();
+    EXPECT_LT(std::abs(p.x - goal.x) + std::abs(p.z - goal.z), 0.5f);
+}
+
+// ============================================================================
+// ベンチマーク（ランダムな始点/終点ペア、既定では実行しない）
+// 実行: GXLibTests --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* --gtest_output=xml
+// ============================================================================
+
+TEST(NavMeshBenchmark, DISABLED_RandomPairsSpeedup)
+{
+    TestGrid grid = MakeBlockGrid(512, 512, 400, 2024);
+    NavMesh navMesh;
+    ApplyGrid(navMesh, grid);
+
+    std::mt19937 rng(11);
+    std::vector<std::array<int, 4>> pairs(64);
+    for (auto& p : pairs)
+    {
+        PickOpenCell(grid, rng, p[0], p[1]);
+        PickOpenCell(grid, rng, p[2], p[3]);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto measure = [&](auto&& fn) {
+        auto t0 = Clock::now();
+        for (const auto& p : pairs) fn(p);
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    };
+
+    std::vector<XMFLOAT3> path;
+    auto findPath = [&](const std::array<int, 4>& p) {
+        navMesh.FindPath(CellCenter(p[0], p[1]), CellCenter(p[2], p[3]), path);
+    };
+
+    // コンテキストのバッファ確保を計測から外す
+    findPath(pairs[0]);
+
+    double referenceMs = measure([&](const std::array<int, 4>& p) {
+        ReferenceAStar(grid, p[0], p[1], p[2], p[3]);
+    });
+
+    navMesh.SetJumpPointSearch(false);
+    double contextMs = measure(findPath);
+
+    navMesh.SetJumpPointSearch(true);
+    double jpsMs = measure(findPath);
+
+    RecordProperty("ReferenceMs", std::to_string(referenceMs));
+    RecordProperty("ContextMs", std::to_string(contextMs));
+    RecordProperty("JpsMs", std::to_string(jpsMs));
+
+    // コンテキスト付きA*とJPSは、どちらも毎回確保する素朴なA*より遅くない
+    EXPECT_LE(contextMs, referenceMs);
+    EXPECT_LE(jpsMs, referenceMs);
+}
@@ -0,0 +1,364 @@
+/// @file test_NavPolyMesh.cpp
+/// @brief NavPolyMesh（ポリゴンナビメッシュ生成・経路探索）単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "AI/NavPolyMesh.h"
+#include "AI/NavAgent.h"
+
+using namespace GX;
+
+namespace
+{
+
+/// テスト用の三角形スープ
+struct TestGeometry
+{
+    std::vector<float> vertices;
+    std::vector<int> indices;
+
+    int Base() const { return static_cast<int>(vertices.size() / 3); }
+
+    void AddVertex(float x, float y, float z)
+    {
+        vertices.push_back(x);
+        vertices.push_back(y);
+        vertices.push_back(z);
+    }
+
+    /// 水平な床（x0..x1, z0..z1）
+    void AddFloor(float x0, float z0, float x1, float z1, float y)
+    {
+        AddSlope(x0, z0, x1, z1, y, y);
+    }
+
+    /// X方向に y0 から y1 へ傾いた板（スロープ）
+    void AddSlope(float x0, float z0, float x1, float z1, float y0, float y1)
+    {
+        const int b = Base();
+        AddVertex(x0, y0, z0);
+        AddVertex(x1, y1, z0);
+        AddVertex(x1, y1, z1);
+        AddVertex(x0, y0, z1);
+        for (int i : { 0, 1, 2, 0, 2, 3 })
+            indices.push_back(b + i);
+    }
+
+    /// 軸並行ボックス（障害物）
+    void AddBox(float x0, float z0, float x1, float z1, float height)
+    {
+        const int b = Base();
+        const float c[8][3] = {
+            { x0, 0, z0 }, { x1, 0, z0 }, { x1, 0, z1 }, { x0, 0, z1 },
+            { x0, height, z0 }, { x1, height, z0 }, { x1, height, z1 }, { x0, height, z1 } };
+        for (const auto& p : c)
+            AddVertex(p[0], p[1], p[2]);
+        const int faces[12][3] = {
+            { 0, 1, 2 }, { 0, 2, 3 }, { 4, 6, 5 }, { 4, 7, 6 }, { 0, 4, 5 }, { 0, 5, 1 },
+            { 1, 5, 6 }, { 1, 6, 2 }, { 2, 6, 7 }, { 2, 7, 3 }, { 3, 7, 4 }, { 3, 4, 0 } };
+        for (const auto& f : faces)
+            for (int i : f)
+                indices.push_back(b + i);
+    }
+
+    bool Build(NavPolyMesh& mesh, const NavPolyMeshConfig& config = {}) const
+    {
+        return mesh.Build(vertices.data(), Base(), indices.data(), static_cast<int>(indices.size()), config);
+    }
+};
+
+/// 線分 a-b が XZ 平面上で矩形（障害物）と交差するか
+bool SegmentHitsRect(const XMFLOAT3& a, const XMFLOAT3& b, float x0, float z0, float x1, float z1)
+{
+    const int steps = 200;
+    for (int i = 0; i <= steps; ++i)
+    {
+        const float t = static_cast<float>(i) / steps;
+        const float x = a.x + (b.x - a.x) * t;
+        const float z = a.z + (b.z - a.z) * t;
+        if (x > x0 && x < x1 && z > z0 && z < z1)
+            return true;
+    }
+    return false;
+}
+
+/// 扉（z=13..17）と抜け道（z=26..30）のある壁で仕切られた部屋
+TestGeometry MakeDoorScene()
+{
+    TestGeometry geo;
+    geo.AddFloor(0.0f, 0.0f, 60.0f, 30.0f, 0.0f);
+    geo.AddBox(28.0f, 0.0f, 32.0f, 13.0f, 1.5f);
+    geo.AddBox(28.0f, 17.0f, 32.0f, 26.0f, 1.5f);
+    return geo;
+}
+
+/// 経路が扉（x=28..32, z=13..17）を通るか
+bool PassesDoor(const std::vector<XMFLOAT3>& path)
+{
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+    {
+        if (SegmentHitsRect(path[i], path[i + 1], 28.0f, 12.0f, 32.0f, 18.0f))
+            return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// 生成
+// ============================================================================
+
+TEST(NavPolyMeshTest, BuildsTiledConvexPolygons)
+{
+    TestGeometry geo;
+    geo.AddFloor(0.0f, 0.0f, 60.0f, 60.0f, 0.0f);
+    geo.AddBox(25.0f, 25.0f, 35.0f, 35.0f, 1.5f);
+
+    NavPolyMeshConfig config;
+    config.tileSize = 48;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+    EXPECT_GT(mesh.GetTileCountX(), 1);
+    EXPECT_GT(mesh.GetTileCountZ(), 1);
+
+    for (int t = 0; t < mesh.GetTileCountX() * mesh.GetTileCountZ(); ++t)
+    {
+        const NavPolyTile* tile = mesh.GetTile(t);
+        if (!tile) continue;
+        for (const auto& poly : tile->polys)
+        {
+            ASSERT_GE(poly.vertCount, 3);
+            ASSERT_LE(poly.vertCount, NavPolyTile::k_MaxVertsPerPoly);
+
+            // 凸性：全ての辺で外積の符号が揃う
+            int positive = 0, negative = 0;
+            for (int i = 0; i < poly.vertCount; ++i)
+            {
+                const XMFLOAT3& a = tile->vertices[poly.verts[i]];
+                const XMFLOAT3& b = tile->vertices[poly.verts[(i + 1) % poly.vertCount]];
+                const XMFLOAT3& c = tile->vertices[poly.verts[(i + 2) % poly.vertCount]];
+                const float cross = (b.x - a.x) * (c.z - b.z) - (b.z - a.z) * (c.x - b.x);
+                if (cross > 1e-4f) ++positive;
+                if (cross < -1e-4f) ++negative;
+            }
+            EXPECT_TRUE(positive == 0 || negative == 0);
+        }
+    }
+
+    // 障害物（高さ1.5）は段差として登れず、内部も天井が低いため床の高さにポリゴンはない
+    EXPECT_EQ(mesh.FindNearestPoly({ 30.0f, 0.0f, 30.0f }, { 0.2f, 1.0f, 0.2f }), k_InvalidNavPolyRef);
+    EXPECT_NE(mesh.FindNearestPoly({ 10.0f, 0.0f, 10.0f }, { 0.2f, 1.0f, 0.2f }), k_InvalidNavPolyRef);
+}
+
+// ============================================================================
+// 経路探索（A* + ファネル）
+// ============================================================================
+
+TEST(NavPolyMeshTest, StringPulledPathAvoidsObstacles)
+{
+    TestGeometry geo;
+    geo.AddFloor(0.0f, 0.0f, 60.0f, 60.0f, 0.0f);
+    geo.AddBox(10.0f, 0.0f, 14.0f, 45.0f, 1.5f);   // z=45..60 に隙間のある壁
+    geo.AddBox(30.0f, 15.0f, 34.0f, 60.0f, 1.5f);  // z=0..15 に隙間のある壁
+
+    NavPolyMeshConfig config;
+    config.tileSize = 48;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+
+    std::vector<XMFLOAT3> path;
+    ASSERT_TRUE(mesh.FindPath({ 3.0f, 0.0f, 5.0f }, { 55.0f, 0.0f, 5.0f }, path));
+    ASSERT_GE(path.size(), 3u);
+    EXPECT_NEAR(path.front().x, 3.0f, 1e-3f);
+    EXPECT_NEAR(path.back().x, 55.0f, 1e-3f);
+
+    // 角だけが残る（セル単位の経路よりずっと少ない）
+    EXPECT_LT(path.size(), 10u);
+
+    float length = 0.0f;
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+    {
+        EXPECT_FALSE(SegmentHitsRect(path[i], path[i + 1], 10.0f, 0.0f, 14.0f, 45.0f));
+        EXPECT_FALSE(SegmentHitsRect(path[i], path[i + 1], 30.0f, 15.0f, 34.0f, 60.0f));
+        const float dx = path[i + 1].x - path[i].x;
+        const float dz = path[i + 1].z - path[i].z;
+        length += std::sqrt(dx * dx + dz * dz);
+    }
+
+    // 壁の端点を回る最短経路（約 3,5 → 12,45 → 32,15 → 55,5）に近い
+    const float optimal = std::sqrt(9.0f * 9.0f + 40.0f * 40.0f) +
+                          std::sqrt(20.0f * 20.0f + 30.0f * 30.0f) +
+                          std::sqrt(23.0f * 23.0f + 10.0f * 10.0f);
+    EXPECT_LT(length, optimal * 1.1f);
+}
+
+TEST(NavPolyMeshTest, OverlappingFloorsConnectedByRamp)
+{
+    TestGeometry geo;
+    geo.AddFloor(0.0f, 0.0f, 60.0f, 40.0f, 0.0f);
+    geo.AddFloor(20.0f, 10.0f, 50.0f, 20.0f, 5.0f);          // 地面の上に架かる橋
+    geo.AddSlope(5.0f, 10.0f, 20.0f, 20.0f, 0.0f, 5.0f);     // 橋へのスロープ
+
+    NavPolyMeshConfig config;
+    config.tileSize = 32;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+
+    // 同じ XZ に橋と地面の2枚のポリゴンがある
+    XMFLOAT3 onDeck, onGround;
+    const NavPolyRef deck   = mesh.FindNearestPoly({ 35.0f, 5.0f, 15.0f }, { 1.0f, 1.0f, 1.0f }, &onDeck);
+    const NavPolyRef ground = mesh.FindNearestPoly({ 35.0f, 0.0f, 15.0f }, { 1.0f, 1.0f, 1.0f }, &onGround);
+    ASSERT_NE(deck, k_InvalidNavPolyRef);
+    ASSERT_NE(ground, k_InvalidNavPolyRef);
+    EXPECT_NE(deck, ground);
+    EXPECT_GT(onDeck.y, onGround.y + 4.0f);
+
+    // 地面から橋の上へはスロープを経由する
+    std::vector<XMFLOAT3> path;
+    ASSERT_TRUE(mesh.FindPath({ 45.0f, 0.0f, 30.0f }, { 45.0f, 5.0f, 15.0f }, path));
+    bool viaRamp = false;
+    for (const auto& p : path)
+        viaRamp |= p.x < 21.0f;
+    EXPECT_TRUE(viaRamp);
+    EXPECT_NEAR(path.back().y, onDeck.y, 0.5f);
+}
+
+TEST(NavPolyMeshTest, ParallelBuildMatchesSingleThreaded)
+{
+    TestGeometry geo;
+    geo.AddFloor(0.0f, 0.0f, 120.0f, 120.0f, 0.0f);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(5.0f, 110.0f);
+    for (int i = 0; i < 60; ++i)
+    {
+        const float x = dist(rng), z = dist(rng);
+        geo.AddBox(x, z, x + 3.0f, z + 3.0f, 2.5f);
+    }
+
+    NavPolyMeshConfig config;
+    config.workerCount = 1;
+    NavPolyMesh single;
+    ASSERT_TRUE(geo.Build(single, config));
+
+    config.workerCount = 4;
+    NavPolyMesh parallel;
+    ASSERT_TRUE(geo.Build(parallel, config));
+
+    EXPECT_EQ(single.GetPolyCount(), parallel.GetPolyCount());
+
+    std::vector<XMFLOAT3> a, b;
+    for (int i = 0; i < 50; ++i)
+    {
+        const XMFLOAT3 start = { dist(rng), 0.0f, dist(rng) };
+        const XMFLOAT3 end   = { dist(rng), 0.0f, dist(rng) };
+        const bool foundA = single.FindPath(start, end, a);
+        const bool foundB = parallel.FindPath(start, end, b);
+        ASSERT_EQ(foundA, foundB);
+        ASSERT_EQ(a.size(), b.size());
+    }
+}
+
+// ============================================================================
+// 動的障害物（タイルの再構築と差し替え）
+// ============================================================================
+
+TEST(NavPolyMeshTest, ObstacleRebuildsTilesAndReroutes)
+{
+    TestGeometry geo = MakeDoorScene();
+    NavPolyMeshConfig config;
+    config.tileSize = 32;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+
+    const XMFLOAT3 start = { 10.0f, 0.0f, 15.0f };
+    const XMFLOAT3 goal  = { 50.0f, 0.0f, 15.0f };
+    std::vector<XMFLOAT3> path;
+    ASSERT_TRUE(mesh.FindPath(start, goal, path));
+    EXPECT_TRUE(PassesDoor(path));
+
+    // 扉を閉じる：Update() までは古いタイルのまま
+    const uint32_t revision = mesh.GetRevision();
+    const NavObstacleId door = mesh.AddBoxObstacle({ 30.0f, 0.5f, 15.0f }, { 2.5f, 1.0f, 2.5f });
+    EXPECT_NE(door, 0u);
+    EXPECT_TRUE(mesh.IsRebuildPending());
+    EXPECT_EQ(mesh.GetRevision(), revision);
+
+    mesh.WaitForRebuilds();
+    EXPECT_FALSE(mesh.IsRebuildPending());
+    EXPECT_NE(mesh.GetRevision(), revision);
+
+    // 抜け道へ迂回する
+    ASSERT_TRUE(mesh.FindPath(start, goal, path));
+    EXPECT_FALSE(PassesDoor(path));
+
+    // 円柱で抜け道も塞ぐと到達不能
+    const NavObstacleId pillar = mesh.AddCylinderObstacle({ 30.0f, 0.0f, 28.0f }, 3.0f, 2.0f);
+    mesh.WaitForRebuilds();
+    EXPECT_FALSE(mesh.FindPath(start, goal, path));
+
+    // 扉を開けると元の経路に戻る
+    EXPECT_TRUE(mesh.RemoveObstacle(door));
+    EXPECT_FALSE(mesh.RemoveObstacle(door));
+    mesh.WaitForRebuilds();
+    ASSERT_TRUE(mesh.FindPath(start, goal, path));
+    EXPECT_TRUE(PassesDoor(path));
+    EXPECT_TRUE(mesh.RemoveObstacle(pillar));
+}
+
+TEST(NavPolyMeshTest, QueriesDuringRebuildSeeConsistentTiles)
+{
+    TestGeometry geo = MakeDoorScene();
+    NavPolyMeshConfig config;
+    config.tileSize = 32;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+
+    // 別スレッドで探索し続けている間に扉を開閉してタイルを差し替える
+    std::atomic<bool> stop{ false };
+    std::atomic<int> failures{ 0 };
+    std::thread searcher([&]() {
+        std::vector<XMFLOAT3> path;
+        while (!stop.load())
+        {
+            if (!mesh.FindPath({ 10.0f, 0.0f, 15.0f }, { 50.0f, 0.0f, 15.0f }, path))
+                failures.fetch_add(1);
+        }
+    });
+
+    for (int i = 0; i < 10; ++i)
+    {
+        const NavObstacleId door = mesh.AddBoxObstacle({ 30.0f, 0.5f, 15.0f }, { 2.5f, 1.0f, 2.5f });
+        mesh.WaitForRebuilds();
+        mesh.RemoveObstacle(door);
+        mesh.WaitForRebuilds();
+    }
+    stop = true;
+    searcher.join();
+
+    // 抜け道が常に開いているので、どのスナップショットでも経路は見つかる
+    EXPECT_EQ(failures.load(), 0);
+}
+
+TEST(NavPolyMeshTest, AgentReplansWhenPathTileIsRebuilt)
+{
+    TestGeometry geo = MakeDoorScene();
+    NavPolyMeshConfig config;
+    config.tileSize = 32;
+    NavPolyMesh mesh;
+    ASSERT_TRUE(geo.Build(mesh, config));
+
+    NavAgent agent;
+    agent.Initialize(&mesh);
+    agent.SetPosition({ 10.0f, 0.0f, 15.0f });
+    agent.SetDestination({ 50.0f, 0.0f, 15.0f });
+    ASSERT_TRUE(agent.HasPath());
+    EXPECT_TRUE(PassesDoor(agent.GetPath()));
+
+    mesh.AddBoxObstacle({ 30.0f, 0.5f, 15.0f }, { 2.5f, 1.0f, 2.5f });
+    mesh.WaitForRebuilds();
+
+    agent.Update(0.016f);
+    ASSERT_TRUE(agent.HasPath());
+    EXPECT_FALSE(PassesDoor(agent.GetPath()));
+}
@@ -0,0 +1,158 @@
+/// @file test_PhysicsWorld2D.cpp
+/// @brief 2D物理ワールドのスナップショット保存/復元 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "Physics/PhysicsWorld2D.h"
+
+using namespace GX;
+
+namespace
+{
+
+/// 床1枚と、落下する円・箱を並べたワールドを作る
+void BuildScene(PhysicsWorld2D& world, int dynamicCount)
+{
+    world.SetGravity({ 0.0f, -9.81f });
+
+    RigidBody2D* floor = world.AddBody();
+    floor->bodyType = BodyType2D::Static;
+    floor->shape.type = ShapeType2D::AABB;
+    floor->shape.halfExtents = { 50.0f, 0.5f };
+    floor->position = { 0.0f, -0.5f };
+
+    for (int i = 0; i < dynamicCount; ++i)
+    {
+        RigidBody2D* body = world.AddBody();
+        body->position = { -10.0f + 2.0f * i, 2.0f + 0.7f * i };
+        body->angularVelocity = 0.1f * i;
+        if (i % 2)
+        {
+            body->shape.type = ShapeType2D::AABB;
+            body->shape.halfExtents = { 0.4f, 0.4f };
+        }
+    }
+}
+
+void ExpectSameState(const PhysicsSnapshot2D& a, const PhysicsSnapshot2D& b)
+{
+    ASSERT_EQ(a.bodies.size(), b.bodies.size());
+    for (size_t i = 0; i < a.bodies.size(); ++i)
+    {
+        const auto& sa = a.bodies[i];
+        const auto& sb = b.bodies[i];
+        EXPECT_EQ(sa.index, sb.index);
+        EXPECT_EQ(sa.position.x, sb.position.x);
+        EXPECT_EQ(sa.position.y, sb.position.y);
+        EXPECT_EQ(sa.rotation, sb.rotation);
+        EXPECT_EQ(sa.velocity.x, sb.velocity.x);
+        EXPECT_EQ(sa.velocity.y, sb.velocity.y);
+        EXPECT_EQ(sa.angularVelocity, sb.angularVelocity);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// 完全スナップショット
+// ============================================================================
+
+TEST(PhysicsSnapshot2DTest, RestoreReplaysIdentically)
+{
+    PhysicsWorld2D world;
+    BuildScene(world, 8);
+    for (int i = 0; i < 10; ++i)
+        world.Step(1.0f / 60.0f);
+
+    PhysicsSnapshot2D saved;
+    world.SaveSnapshot(saved);
+    EXPECT_FALSE(saved.isDelta);
+    EXPECT_EQ(saved.bodyCount, 9u);
+
+    // 保存時点から進めた結果を記録し、巻き戻して同じだけ進め直す
+    for (int i = 0; i < 30; ++i)
+        world.Step(1.0f / 60.0f);
+    PhysicsSnapshot2D first;
+    world.SaveSnapshot(first);
+
+    world.SetGravity({ 0.0f, 5.0f });
+    ASSERT_TRUE(world.RestoreSnapshot(saved));
+    EXPECT_EQ(world.GetGravity().y, -9.81f);
+    for (int i = 0; i < 30; ++i)
+        world.Step(1.0f / 60.0f);
+    PhysicsSnapshot2D second;
+    world.SaveSnapshot(second);
+
+    ExpectSameState(first, second);
+}
+
+TEST(PhysicsSnapshot2DTest, RejectsMismatchedBodyCount)
+{
+    PhysicsWorld2D world;
+    BuildScene(world, 3);
+    PhysicsSnapshot2D saved;
+    world.SaveSnapshot(saved);
+
+    world.AddBody();
+    EXPECT_FALSE(world.RestoreSnapshot(saved));
+
+    PhysicsSnapshot2D delta;
+    EXPECT_FALSE(world.SaveDeltaSnapshot(saved, delta));
+}
+
+// ============================================================================
+// 差分スナップショット
+// ============================================================================
+
+TEST(PhysicsSnapshot2DTest, DeltaHoldsOnlyChangedBodies)
+{
+    PhysicsWorld2D world;
+    BuildScene(world, 6);
+
+    PhysicsSnapshot2D base;
+    world.SaveSnapshot(base);
+
+    // 何も動かしていなければ差分は空
+    PhysicsSnapshot2D delta;
+    ASSERT_TRUE(world.SaveDeltaSnapshot(base, delta));
+    EXPECT_TRUE(delta.isDelta);
+    EXPECT_TRUE(delta.bodies.empty());
+
+    // 動的ボディだけが動き、静的な床は差分に入らない
+    world.Step(1.0f / 60.0f);
+    ASSERT_TRUE(world.SaveDeltaSnapshot(base, delta));
+    EXPECT_EQ(delta.bodies.size(), 6u);
+    for (const auto& state : delta.bodies)
+        EXPECT_NE(state.index, 0u);
+    EXPECT_LT(delta.GetSize(), base.GetSize());
+
+    // 差分は完全スナップショットの上にしか作れない
+    PhysicsSnapshot2D nested;
+    EXPECT_FALSE(world.SaveDeltaSnapshot(delta, nested));
+}
+
+TEST(PhysicsSnapshot2DTest, BasePlusDeltaRestoresState)
+{
+    PhysicsWorld2D world;
+    BuildScene(world, 6);
+    PhysicsSnapshot2D base;
+    world.SaveSnapshot(base);
+
+    for (int i = 0; i < 20; ++i)
+        world.Step(1.0f / 60.0f);
+    PhysicsSnapshot2D expected;
+    world.SaveSnapshot(expected);
+    PhysicsSnapshot2D delta;
+    ASSERT_TRUE(world.SaveDeltaSnapshot(base, delta));
+
+    for (int i = 0; i < 20; ++i)
+        world.Step(1.0f / 60.0f);
+
+    // 基準 → 差分の順に適用すると差分保存時の状態に戻る
+    ASSERT_TRUE(world.RestoreSnapshot(base));
+    ASSERT_TRUE(world.RestoreSnapshot(delta));
+    PhysicsSnapshot2D actual;
+    world.SaveSnapshot(actual);
+
+    ExpectSameState(expected, actual);
+}
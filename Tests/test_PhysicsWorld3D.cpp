@@ -0,0 +1,187 @@
+/// @file test_PhysicsWorld3D.cpp
+/// @brief 3D物理ワールドのスナップショット保存/復元 単体テスト
+
+#include "pch.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include "Physics/PhysicsWorld3D.h"
+
+using namespace GX;
+
+namespace
+{
+
+constexpr float k_Dt = 1.0f / 60.0f;
+
+/// 床と、積み上げた箱・落下する球を並べたワールドを作る
+std::vector<PhysicsBodyID> BuildScene(PhysicsWorld3D& world, int towers, int boxesPerTower)
+{
+    std::vector<PhysicsBodyID> ids;
+
+    PhysicsBodySettings floor;
+    floor.motionType = MotionType3D::Static;
+    floor.layer = 0;
+    floor.position = { 0.0f, -0.5f, 0.0f };
+    ids.push_back(world.AddBody(world.CreateBoxShape({ 200.0f, 0.5f, 200.0f }), floor));
+
+    PhysicsShape* box = world.CreateBoxShape({ 0.5f, 0.5f, 0.5f });
+    PhysicsShape* sphere = world.CreateSphereShape(0.4f);
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(towers))));
+    for (int t = 0; t < towers; ++t)
+    {
+        const float x = (t % side) * 3.0f - side * 1.5f;
+        const float z = (t / side) * 3.0f - side * 1.5f;
+        for (int i = 0; i < boxesPerTower; ++i)
+        {
+            PhysicsBodySettings settings;
+            settings.position = { x + 0.05f * (i % 2), 0.5f + 1.01f * i, z };
+            ids.push_back(world.AddBody(box, settings));
+        }
+        PhysicsBodySettings ball;
+        ball.position = { x + 0.3f, 1.0f + 1.01f * boxesPerTower + 2.0f, z };
+        ids.push_back(world.AddBody(sphere, ball));
+    }
+    return ids;
+}
+
+struct BodyState
+{
+    Vector3 position;
+    Quaternion rotation;
+};
+
+std::vector<BodyState> CaptureState(const PhysicsWorld3D& world, const std::vector<PhysicsBodyID>& ids)
+{
+    std::vector<BodyState> states;
+    for (PhysicsBodyID id : ids)
+        states.push_back({ world.GetPosition(id), world.GetRotation(id) });
+    return states;
+}
+
+void ExpectSameState(const std::vector<BodyState>& a, const std::vector<BodyState>& b)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(a[i].position.x, b[i].position.x) << i;
+        EXPECT_EQ(a[i].position.y, b[i].position.y) << i;
+        EXPECT_EQ(a[i].position.z, b[i].position.z) << i;
+        EXPECT_EQ(a[i].rotation.x, b[i].rotation.x) << i;
+        EXPECT_EQ(a[i].rotation.y, b[i].rotation.y) << i;
+        EXPECT_EQ(a[i].rotation.z, b[i].rotation.z) << i;
+        EXPECT_EQ(a[i].rotation.w, b[i].rotation.w) << i;
+    }
+}
+
+void StepFrames(PhysicsWorld3D& world, int frames)
+{
+    for (int i = 0; i < frames; ++i)
+        world.Step(k_Dt);
+}
+
+} // namespace
+
+// ============================================================================
+// 完全スナップショット
+// ============================================================================
+
+TEST(PhysicsSnapshot3DTest, RestoreReplaysIdentically)
+{
+    PhysicsWorld3D world;
+    ASSERT_TRUE(world.Initialize());
+    const auto ids = BuildScene(world, 4, 4);
+    StepFrames(world, 20);
+
+    PhysicsSnapshot3D saved;
+    ASSERT_TRUE(world.SaveSnapshot(saved));
+    EXPECT_FALSE(saved.isDelta);
+    EXPECT_EQ(saved.bodyFingerprints.size(), ids.size());
+
+    StepFrames(world, 30);
+    const auto first = CaptureState(world, ids);
+
+    world.SetGravity({ 0.0f, 5.0f, 0.0f });
+    ASSERT_TRUE(world.RestoreSnapshot(saved));
+    EXPECT_EQ(world.GetGravity().y, -9.81f);
+    StepFrames(world, 30);
+
+    ExpectSameState(first, CaptureState(world, ids));
+}
+
+// ============================================================================
+// 差分スナップショット
+// ============================================================================
+
+TEST(PhysicsSnapshot3DTest, BasePlusDeltaReplaysIdentically)
+{
+    PhysicsWorld3D world;
+    ASSERT_TRUE(world.Initialize());
+    const auto ids = BuildScene(world, 4, 4);
+
+    // 接触が生じてから基準を取り、さらに進めた時点を差分として保存する
+    StepFrames(world, 20);
+    PhysicsSnapshot3D base;
+    ASSERT_TRUE(world.SaveSnapshot(base));
+    StepFrames(world, 10);
+    PhysicsSnapshot3D delta;
+    ASSERT_TRUE(world.SaveDeltaSnapshot(base, delta));
+    EXPECT_TRUE(delta.isDelta);
+
+    StepFrames(world, 30);
+    const auto expected = CaptureState(world, ids);
+
+    // 基準 → 差分の順に戻し、同じフレーム数を進め直すと一致する (接触キャッシュも戻っている)
+    StepFrames(world, 15);
+    ASSERT_TRUE(world.RestoreSnapshot(base));
+    ASSERT_TRUE(world.RestoreSnapshot(delta));
+    StepFrames(world, 30);
+
+    ExpectSameState(expected, CaptureState(world, ids));
+
+    // 差分は完全スナップショットの上にしか作れない
+    PhysicsSnapshot3D nested;
+    EXPECT_FALSE(world.SaveDeltaSnapshot(delta, nested));
+}
+
+// ============================================================================
+// 復元時間の計測 (既定では実行しない)
+// 実行: GXLibTests --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* --gtest_output=xml
+// ============================================================================
+
+TEST(PhysicsSnapshot3DBenchmark, DISABLED_RestoreThousandsOfBodies)
+{
+    PhysicsWorld3D world;
+    ASSERT_TRUE(world.Initialize());
+    const auto ids = BuildScene(world, 400, 8);
+    ASSERT_GE(ids.size(), 3000u);
+    StepFrames(world, 30);
+
+    PhysicsSnapshot3D base;
+    ASSERT_TRUE(world.SaveSnapshot(base));
+    StepFrames(world, 5);
+    PhysicsSnapshot3D delta;
+    ASSERT_TRUE(world.SaveDeltaSnapshot(base, delta));
+
+    constexpr int k_Iterations = 20;
+    using Clock = std::chrono::steady_clock;
+    Clock::duration fullTime{}, deltaTime{};
+    for (int i = 0; i < k_Iterations; ++i)
+    {
+        auto t0 = Clock::now();
+        ASSERT_TRUE(world.RestoreSnapshot(base));
+        auto t1 = Clock::now();
+        ASSERT_TRUE(world.RestoreSnapshot(delta));
+        auto t2 = Clock::now();
+        fullTime += t1 - t0;
+        deltaTime += t2 - t1;
+    }
+
+    const auto fullUs = std::chrono::duration_cast<std::chrono::microseconds>(fullTime).count() / k_Iterations;
+    const auto deltaUs = std::chrono::duration_cast<std::chrono::microseconds>(deltaTime).count() / k_Iterations;
+    RecordProperty("bodies", static_cast<int>(ids.size()));
+    RecordProperty("full_restore_us", static_cast<int>(fullUs));
+    RecordProperty("delta_restore_us", static_cast<int>(deltaUs));
+
+    // 目標: 数千ボディの巻き戻し (基準+差分) が1ミリ秒を十分に下回る (Releaseビルド)
+    EXPECT_LT(fullUs + deltaUs, 1000);
+}
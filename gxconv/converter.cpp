@@ -5,6 +5,7 @@
 #include "intermediate/scene.h"
 #include "importers/obj_importer.h"
 #include "exporters/gxmd_exporter.h"
+#include "optimizers/mesh_optimizer.h"
 #include "gxmd.h"
 #include "gxan.h"
 
@@ -41,6 +42,72 @@ static std::string ChangeExtension(const std::string& path, const std::string& n
     return path.substr(0, dot) + newExt;
 }
 
+/// 拡張子に応じたインポーターで中間表現を読み込む
+static bool ImportScene(const std::string& path, Scene& scene)
+{
+    std::string ext = GetExtension(path);
+    if (ext == ".obj")
+    {
+        ObjImporter importer;
+        return importer.Import(path, scene);
+    }
+#if defined(GXCONV_HAS_FBX)
+    if (ext == ".fbx")
+    {
+        FbxImporter importer;
+        return importer.Import(path, scene);
+    }
+#endif
+#if defined(GXCONV_HAS_GLTF)
+    if (ext == ".gltf" || ext == ".glb")
+    {
+        GltfImporter importer;
+        return importer.Import(path, scene);
+    }
+#endif
+    fprintf(stderr, "Error: Unsupported input format: %s\n", ext.c_str());
+    return false;
+}
+
+/// 変換オプションからメッシュ最適化オプションを作る
+static MeshOptimizeOptions MakeOptimizeOptions(const ConvertOptions& options)
+{
+    MeshOptimizeOptions optimizeOpts;
+    optimizeOpts.weld = options.weldVertices;
+    return optimizeOpts;
+}
+
+/// メッシュ1つ分の最適化結果を表示する
+static void PrintOptimizeReport(size_t meshIndex, const IntermediateMesh& mesh, const MeshOptimizeReport& report)
+{
+    printf("  Mesh[%zu]: \"%s\" tris=%zu verts %u -> %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+           meshIndex, mesh.name.c_str(), mesh.indices.size() / 3,
+           report.verticesBefore, report.verticesAfter,
+           report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+}
+
+int Converter::ShowOptimizeInfo(const ConvertOptions& options)
+{
+    Scene scene;
+    if (!ImportScene(options.inputPath, scene))
+    {
+        fprintf(stderr, "Error: Failed to import %s\n", options.inputPath.c_str());
+        return 1;
+    }
+
+    printf("Model: %s\n", options.inputPath.c_str());
+    printf("  Meshes: %zu, Materials: %zu, Bones: %zu, Animations: %zu\n",
+           scene.meshes.size(), scene.materials.size(), scene.skeleton.size(), scene.animations.size());
+
+    // 最適化しない場合も同じ形式で現状の値を表示する
+    MeshOptimizeOptions optimizeOpts = MakeOptimizeOptions(options);
+    if (!options.optimizeMeshes)
+        optimizeOpts = { false, false, false, false };
+    for (size_t i = 0; i < scene.meshes.size(); ++i)
+        PrintOptimizeReport(i, scene.meshes[i], OptimizeMesh(scene.meshes[i], optimizeOpts));
+    return 0;
+}
+
 int Converter::ShowInfo(const std::string& path)
 {
     std::string ext = GetExtension(path);
@@ -83,14 +150,35 @@ int Converter::ShowInfo(const std::string& path)
         };
 
         // Read mesh chunks
+        std::vector<gxfmt::MeshChunk> meshChunks(header.meshCount);
         fseek(f, static_cast<long>(header.meshChunkOffset), SEEK_SET);
+        fread(meshChunks.data(), sizeof(gxfmt::MeshChunk), meshChunks.size(), f);
         for (uint32_t i = 0; i < header.meshCount; ++i)
         {
-            gxfmt::MeshChunk mc{};
-            fread(&mc, sizeof(mc), 1, f);
-            printf("  Mesh[%u]: \"%s\" verts=%u idx=%u mat=%u stride=%u\n",
+            const gxfmt::MeshChunk& mc = meshChunks[i];
+            printf("  Mesh[%u]: \"%s\" verts=%u idx=%u mat=%u stride=%u format=0x%X%s\n",
                    i, getString(mc.nameIndex), mc.vertexCount, mc.indexCount,
-                   mc.materialIndex, mc.vertexStride);
+                   mc.materialIndex, mc.vertexStride, mc.vertexFormatFlags,
+                   (mc.vertexFormatFlags & gxfmt::VF_QuantizedMask) ? " (quantized)" : "");
+
+            // 頂点キャッシュ効率と、三角形を並べ替えた場合の値
+            std::vector<uint32_t> indices(mc.indexCount);
+            fseek(f, static_cast<long>(header.indexDataOffset + mc.indexOffset), SEEK_SET);
+            if (mc.indexFormat == gxfmt::IndexFormat::UInt16)
+            {
+                std::vector<uint16_t> indices16(mc.indexCount);
+                fread(indices16.data(), sizeof(uint16_t), indices16.size(), f);
+                std::copy(indices16.begin(), indices16.end(), indices.begin());
+            }
+            else
+            {
+                fread(indices.data(), sizeof(uint32_t), indices.size(), f);
+            }
+            VertexCacheStats current = AnalyzeVertexCache(indices, mc.vertexCount);
+            OptimizeVertexCache(indices, mc.vertexCount);
+            VertexCacheStats reordered = AnalyzeVertexCache(indices, mc.vertexCount);
+            printf("           ACMR %.3f, ATVR %.3f (reordered: ACMR %.3f, ATVR %.3f)\n",
+                   current.acmr, current.atvr, reordered.acmr, reordered.atvr);
         }
 
         // Read material chunks
@@ -150,10 +238,10 @@ int Converter::ShowInfo(const std::string& path)
 
 int Converter::Run(const ConvertOptions& options)
 {
+    std::string ext = GetExtension(options.inputPath);
     if (options.infoOnly)
-        return ShowInfo(options.inputPath);
+        return (ext == ".gxmd" || ext == ".gxan") ? ShowInfo(options.inputPath) : ShowOptimizeInfo(options);
 
-    std::string ext = GetExtension(options.inputPath);
     std::string outputPath = options.outputPath;
 
     // Determine output extension
@@ -167,34 +255,7 @@ int Converter::Run(const ConvertOptions& options)
 
     // Import
     Scene scene;
-    bool imported = false;
-
-    if (ext == ".obj")
-    {
-        ObjImporter importer;
-        imported = importer.Import(options.inputPath, scene);
-    }
-#if defined(GXCONV_HAS_FBX)
-    else if (ext == ".fbx")
-    {
-        FbxImporter importer;
-        imported = importer.Import(options.inputPath, scene);
-    }
-#endif
-#if defined(GXCONV_HAS_GLTF)
-    else if (ext == ".gltf" || ext == ".glb")
-    {
-        GltfImporter importer;
-        imported = importer.Import(options.inputPath, scene);
-    }
-#endif
-    else
-    {
-        fprintf(stderr, "Error: Unsupported input format: %s\n", ext.c_str());
-        return 1;
-    }
-
-    if (!imported)
+    if (!ImportScene(options.inputPath, scene))
     {
         fprintf(stderr, "Error: Failed to import %s\n", options.inputPath.c_str());
         return 1;
@@ -216,6 +277,15 @@ int Converter::Run(const ConvertOptions& options)
             mat.params.outlineWidth = options.toonOutlineWidth;
     }
 
+    // メッシュ最適化 (溶接・三角形の並べ替え・頂点の並べ替え)
+    if (options.optimizeMeshes && !options.animOnly)
+    {
+        const MeshOptimizeOptions optimizeOpts = MakeOptimizeOptions(options);
+        printf("Optimizing meshes:\n");
+        for (size_t i = 0; i < scene.meshes.size(); ++i)
+            PrintOptimizeReport(i, scene.meshes[i], OptimizeMesh(scene.meshes[i], optimizeOpts));
+    }
+
     // Export
 #if defined(GXCONV_HAS_GLTF)
     if (options.animOnly)
@@ -234,6 +304,8 @@ int Converter::Run(const ConvertOptions& options)
     ExportOptions exportOpts;
     exportOpts.useIndex16 = options.useIndex16;
     exportOpts.excludeAnimations = options.excludeAnimations;
+    exportOpts.quantizeVertices = options.quantizeVertices;
+    exportOpts.weights16 = options.weights16;
 
     GxmdExporter exporter;
     if (!exporter.Export(scene, outputPath, exportOpts))
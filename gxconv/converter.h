@@ -22,6 +22,10 @@ struct ConvertOptions
     bool hasShaderModelOverride = false;   ///< シェーダーモデル上書きが指定されたか
     gxfmt::ShaderModel shaderModelOverride = gxfmt::ShaderModel::Standard; ///< 上書き用シェーダーモデル
     float toonOutlineWidth = 0.0f;         ///< Toonアウトライン幅 (0=未指定)
+    bool optimizeMeshes  = true;           ///< メッシュ最適化パスを実行する
+    bool weldVertices    = true;           ///< 最適化パスで頂点を溶接する
+    bool quantizeVertices = false;         ///< 頂点属性を量子化して格納する (位置16bit・八面体法線/接線・half UV等)
+    bool weights16       = false;          ///< 量子化時にボーンウェイトをunorm16で格納する (既定unorm8)
 };
 
 /// @brief 変換処理の統括クラス
@@ -36,9 +40,15 @@ public:
 
 private:
     /// @brief .gxmd/.gxanファイルの情報を表示する (--infoオプション)
+    /// @details .gxmdは各メッシュの頂点キャッシュ効率 (ACMR/ATVR) と三角形を並べ替えた場合の値を表示する。
     /// @param path 対象ファイルパス
     /// @return 終了コード (0=成功)
     int ShowInfo(const std::string& path);
+
+    /// @brief 入力モデルを読み込み、メッシュ最適化前後の頂点数とACMR/ATVRを表示する (--infoオプション)
+    /// @param options 変換オプション (最適化の有無を含む)
+    /// @return 終了コード (0=成功)
+    int ShowOptimizeInfo(const ConvertOptions& options);
 };
 
 } // namespace gxconv
@@ -12,6 +12,7 @@
 #include <array>
 #include <map>
 #include <algorithm>
+#include <cmath>
 
 namespace gxconv
 {
@@ -97,6 +98,157 @@ private:
     uint64_t m_offset = 0;
 };
 
+// ============================================================
+// Vertex encoding
+// ============================================================
+
+// Half UVs keep at least ~1/2048 precision inside this range; meshes with
+// larger (tiled) UVs stay float even when quantizing.
+static constexpr float k_HalfUvRange = 4.0f;
+
+struct MeshBounds
+{
+    float min[3];
+    float max[3];
+};
+
+static MeshBounds ComputeBounds(const IntermediateMesh& mesh)
+{
+    MeshBounds b;
+    b.min[0] = b.min[1] = b.min[2] = 1e30f;
+    b.max[0] = b.max[1] = b.max[2] = -1e30f;
+    for (auto& v : mesh.vertices)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            if (v.position[j] < b.min[j]) b.min[j] = v.position[j];
+            if (v.position[j] > b.max[j]) b.max[j] = v.position[j];
+        }
+    }
+    return b;
+}
+
+static uint32_t SelectQuantizedFlags(const IntermediateMesh& mesh, const MeshBounds& bounds,
+                                     bool hasSkinning, bool weights16)
+{
+    uint32_t flags = gxfmt::VF_NormalOct | gxfmt::VF_TangentOct;
+
+    // A NaN/Inf position would make the AABB unusable as a quantization range
+    bool finiteBounds = true;
+    for (int j = 0; j < 3; ++j)
+        finiteBounds = finiteBounds && std::isfinite(bounds.min[j]) && std::isfinite(bounds.max[j]);
+    if (finiteBounds)
+        flags |= gxfmt::VF_PositionQ16;
+
+    bool uvInRange = true;
+    bool jointsFit8 = true;
+    for (auto& v : mesh.vertices)
+    {
+        if (!(std::fabs(v.texcoord[0]) <= k_HalfUvRange && std::fabs(v.texcoord[1]) <= k_HalfUvRange))
+            uvInRange = false;
+        for (int j = 0; j < 4; ++j)
+            if (v.joints[j] > 255) jointsFit8 = false;
+    }
+    if (uvInRange)
+        flags |= gxfmt::VF_UV0Half;
+    else
+        printf("  Mesh \"%s\": UVs exceed +/-%.0f, keeping float UVs\n", mesh.name.c_str(), k_HalfUvRange);
+
+    if (hasSkinning)
+    {
+        if (jointsFit8)
+            flags |= gxfmt::VF_Joints8;
+        else
+            printf("  Mesh \"%s\": joint index > 255, keeping 32-bit joints\n", mesh.name.c_str());
+        flags |= weights16 ? gxfmt::VF_WeightsU16 : gxfmt::VF_WeightsU8;
+    }
+    return flags;
+}
+
+// Writes one vertex in the layout described by flags (float or quantized per attribute)
+static void EncodeVertex(const IntermediateVertex& v, uint32_t flags, const gxfmt::VertexLayout& layout,
+                         const MeshBounds& bounds, uint8_t* dst)
+{
+    if (flags & gxfmt::VF_PositionQ16)
+    {
+        uint16_t q[4];
+        gxfmt::QuantizePosition(v.position, bounds.min, bounds.max, q);
+        std::memcpy(dst + layout.position, q, 8);
+    }
+    else
+    {
+        std::memcpy(dst + layout.position, v.position, 12);
+    }
+
+    if (flags & gxfmt::VF_NormalOct)
+    {
+        int16_t n[2];
+        gxfmt::EncodeOctNormal(v.normal, n);
+        std::memcpy(dst + layout.normal, n, 4);
+    }
+    else
+    {
+        std::memcpy(dst + layout.normal, v.normal, 12);
+    }
+
+    if (flags & gxfmt::VF_UV0Half)
+    {
+        const uint16_t uv[2] = { gxfmt::FloatToHalf(v.texcoord[0]), gxfmt::FloatToHalf(v.texcoord[1]) };
+        std::memcpy(dst + layout.uv0, uv, 4);
+    }
+    else
+    {
+        std::memcpy(dst + layout.uv0, v.texcoord, 8);
+    }
+
+    if (flags & gxfmt::VF_TangentOct)
+    {
+        int16_t t[2];
+        gxfmt::EncodeOctTangent(v.tangent, t);
+        std::memcpy(dst + layout.tangent, t, 4);
+    }
+    else
+    {
+        std::memcpy(dst + layout.tangent, v.tangent, 16);
+    }
+
+    if (!(flags & gxfmt::VF_Joints))
+        return;
+
+    if (flags & gxfmt::VF_Joints8)
+    {
+        for (int j = 0; j < 4; ++j)
+            dst[layout.joints + j] = static_cast<uint8_t>(v.joints[j]);
+    }
+    else
+    {
+        std::memcpy(dst + layout.joints, v.joints, 16);
+    }
+
+    if (flags & (gxfmt::VF_WeightsU8 | gxfmt::VF_WeightsU16))
+    {
+        const bool u16 = (flags & gxfmt::VF_WeightsU16) != 0;
+        uint32_t w[4];
+        gxfmt::QuantizeWeights(v.weights, u16 ? 65535u : 255u, w);
+        for (int j = 0; j < 4; ++j)
+        {
+            if (u16)
+            {
+                const uint16_t w16 = static_cast<uint16_t>(w[j]);
+                std::memcpy(dst + layout.weights + j * 2, &w16, 2);
+            }
+            else
+            {
+                dst[layout.weights + j] = static_cast<uint8_t>(w[j]);
+            }
+        }
+    }
+    else
+    {
+        std::memcpy(dst + layout.weights, v.weights, 16);
+    }
+}
+
 // ============================================================
 
 bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
@@ -146,19 +298,31 @@ bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
     for (auto& mesh : scene.meshes)
         if (mesh.hasSkinning) hasSkinning = true;
 
-    uint32_t vertexStride = hasSkinning ? sizeof(gxfmt::VertexSkinned) : sizeof(gxfmt::VertexStandard);
-    uint32_t vertexFlags = hasSkinning ? gxfmt::VF_Skinned : gxfmt::VF_Standard;
+    uint32_t baseVertexFlags = hasSkinning ? gxfmt::VF_Skinned : gxfmt::VF_Standard;
+
+    // Per-mesh AABB and vertex format (quantization is decided per mesh)
+    std::vector<MeshBounds> meshBounds;
+    std::vector<uint32_t> meshVertexFlags;
+    for (auto& mesh : scene.meshes)
+    {
+        meshBounds.push_back(ComputeBounds(mesh));
+        uint32_t flags = baseVertexFlags;
+        if (options.quantizeVertices)
+            flags |= SelectQuantizedFlags(mesh, meshBounds.back(), hasSkinning, options.weights16);
+        meshVertexFlags.push_back(flags);
+    }
 
     // Compute vertex/index data sizes
     uint64_t totalVertexBytes = 0;
     uint64_t totalIndexBytes = 0;
     std::vector<uint64_t> meshVertexOffsets, meshIndexOffsets;
 
-    for (auto& mesh : scene.meshes)
+    for (size_t i = 0; i < scene.meshes.size(); ++i)
     {
+        auto& mesh = scene.meshes[i];
         meshVertexOffsets.push_back(totalVertexBytes);
         meshIndexOffsets.push_back(totalIndexBytes);
-        totalVertexBytes += mesh.vertices.size() * vertexStride;
+        totalVertexBytes += mesh.vertices.size() * gxfmt::GetVertexLayout(meshVertexFlags[i]).stride;
 
         bool use16 = options.useIndex16 && mesh.vertices.size() <= 65535;
         gxfmt::IndexFormat idxFmt = use16 ? gxfmt::IndexFormat::UInt16 : gxfmt::IndexFormat::UInt32;
@@ -259,8 +423,8 @@ bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
         chunk.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
         chunk.indexCount = static_cast<uint32_t>(mesh.indices.size());
         chunk.materialIndex = mesh.materialIndex;
-        chunk.vertexFormatFlags = vertexFlags;
-        chunk.vertexStride = vertexStride;
+        chunk.vertexFormatFlags = meshVertexFlags[i];
+        chunk.vertexStride = gxfmt::GetVertexLayout(meshVertexFlags[i]).stride;
         chunk.vertexOffset = meshVertexOffsets[i];
         chunk.indexOffset = meshIndexOffsets[i];
 
@@ -268,17 +432,8 @@ bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
         chunk.indexFormat = use16 ? gxfmt::IndexFormat::UInt16 : gxfmt::IndexFormat::UInt32;
         chunk.topology = gxfmt::PrimitiveTopology::TriangleList;
 
-        // Compute AABB
-        chunk.aabbMin[0] = chunk.aabbMin[1] = chunk.aabbMin[2] = 1e30f;
-        chunk.aabbMax[0] = chunk.aabbMax[1] = chunk.aabbMax[2] = -1e30f;
-        for (auto& v : mesh.vertices)
-        {
-            for (int j = 0; j < 3; ++j)
-            {
-                if (v.position[j] < chunk.aabbMin[j]) chunk.aabbMin[j] = v.position[j];
-                if (v.position[j] > chunk.aabbMax[j]) chunk.aabbMax[j] = v.position[j];
-            }
-        }
+        std::memcpy(chunk.aabbMin, meshBounds[i].min, 12);
+        std::memcpy(chunk.aabbMax, meshBounds[i].max, 12);
 
         writer.Write(chunk);
     }
@@ -300,34 +455,18 @@ bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
     }
 
     // Vertex data
-    for (auto& mesh : scene.meshes)
+    std::vector<uint8_t> vertexBytes;
+    for (size_t i = 0; i < scene.meshes.size(); ++i)
     {
-        if (hasSkinning)
-        {
-            for (auto& v : mesh.vertices)
-            {
-                gxfmt::VertexSkinned sv{};
-                std::memcpy(sv.position, v.position, 12);
-                std::memcpy(sv.normal, v.normal, 12);
-                std::memcpy(sv.uv0, v.texcoord, 8);
-                std::memcpy(sv.tangent, v.tangent, 16);
-                std::memcpy(sv.joints, v.joints, 16);
-                std::memcpy(sv.weights, v.weights, 16);
-                writer.Write(sv);
-            }
-        }
-        else
+        auto& mesh = scene.meshes[i];
+        const gxfmt::VertexLayout layout = gxfmt::GetVertexLayout(meshVertexFlags[i]);
+        vertexBytes.assign(mesh.vertices.size() * layout.stride, 0);
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
         {
-            for (auto& v : mesh.vertices)
-            {
-                gxfmt::VertexStandard sv{};
-                std::memcpy(sv.position, v.position, 12);
-                std::memcpy(sv.normal, v.normal, 12);
-                std::memcpy(sv.uv0, v.texcoord, 8);
-                std::memcpy(sv.tangent, v.tangent, 16);
-                writer.Write(sv);
-            }
+            EncodeVertex(mesh.vertices[v], meshVertexFlags[i], layout, meshBounds[i],
+                         vertexBytes.data() + v * layout.stride);
         }
+        writer.Write(vertexBytes.data(), vertexBytes.size());
     }
 
     // Index data
@@ -438,6 +577,15 @@ bool GxmdExporter::Export(const Scene& scene, const std::string& outputPath,
     printf("Exported: %s\n", outputPath.c_str());
     printf("  Meshes: %u, Materials: %u, Bones: %u, Animations: %u\n",
            header.meshCount, header.materialCount, header.boneCount, header.animationCount);
+    if (options.quantizeVertices)
+    {
+        uint64_t floatVertexBytes = 0;
+        for (auto& mesh : scene.meshes)
+            floatVertexBytes += mesh.vertices.size() * gxfmt::GetVertexLayout(baseVertexFlags).stride;
+        printf("  Vertex data: %llu bytes (float layout: %llu bytes)\n",
+               static_cast<unsigned long long>(totalVertexBytes),
+               static_cast<unsigned long long>(floatVertexBytes));
+    }
 
     return true;
 }
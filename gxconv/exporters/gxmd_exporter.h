@@ -13,6 +13,8 @@ struct ExportOptions
 {
     bool useIndex16 = false;     // force 16-bit indices
     bool excludeAnimations = false;
+    bool quantizeVertices = false; // 16-bit AABB positions, octahedral normals/tangents, half UVs, uint8 joints
+    bool weights16 = false;        // with quantizeVertices: unorm16 weights instead of unorm8
 };
 
 class GxmdExporter
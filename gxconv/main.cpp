@@ -17,11 +17,17 @@ static void PrintUsage()
     printf("Output: .gxmd (default) or .gxan (with --anim-only)\n\n");
     printf("Options:\n");
     printf("  --info              Show file info without converting\n");
+    printf("                      (.gxmd: vertex cache ACMR/ATVR; models: before/after mesh optimization)\n");
     printf("  --shader-model <N>  Force shader model (standard/unlit/toon/phong/subsurface/clearcoat)\n");
     printf("  --toon-outline <W>  Toon outline width\n");
     printf("  --index16           Use 16-bit indices\n");
     printf("  --no-anim           Exclude animation data\n");
     printf("  --anim-only         Export animations as .gxan (Phase 5)\n");
+    printf("  --no-optimize       Skip mesh optimization (weld, vertex cache/overdraw/fetch reordering)\n");
+    printf("  --no-weld           Optimize without welding duplicate vertices\n");
+    printf("  --quantize          Store compact vertices (16-bit positions, octahedral normals/tangents,\n");
+    printf("                      half UVs, 8-bit joints, 8-bit weights)\n");
+    printf("  --weights16         With --quantize, store 16-bit bone weights\n");
     printf("  --help              Show this help\n");
 }
 
@@ -60,6 +66,22 @@ int main(int argc, char* argv[])
         {
             options.animOnly = true;
         }
+        else if (strcmp(argv[i], "--no-optimize") == 0)
+        {
+            options.optimizeMeshes = false;
+        }
+        else if (strcmp(argv[i], "--no-weld") == 0)
+        {
+            options.weldVertices = false;
+        }
+        else if (strcmp(argv[i], "--quantize") == 0)
+        {
+            options.quantizeVertices = true;
+        }
+        else if (strcmp(argv[i], "--weights16") == 0)
+        {
+            options.weights16 = true;
+        }
         else if (strcmp(argv[i], "--shader-model") == 0)
         {
             if (i + 1 >= argc) { fprintf(stderr, "Error: --shader-model requires an argument\n"); return 1; }
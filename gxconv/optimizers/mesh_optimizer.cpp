@@ -0,0 +1,510 @@
+/// @file mesh_optimizer.cpp
+/// @brief メッシュ最適化パスの実装
+
+#include "mesh_optimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace gxconv
+{
+
+// ============================================================
+// 頂点キャッシュ統計
+// ============================================================
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0 || vertexCount == 0 || cacheSize == 0)
+        return stats;
+
+    // 各頂点がFIFOに入った時刻で判定する (時刻の差がキャッシュサイズ未満ならヒット)
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    uint64_t time = cacheSize + 1;
+    uint32_t misses = 0;
+    uint32_t uniqueVertices = 0;
+    for (size_t i = 0; i < triCount * 3; ++i)
+    {
+        const uint32_t v = indices[i];
+        if (v >= vertexCount)
+            continue;
+        if (!referenced[v])
+        {
+            referenced[v] = 1;
+            ++uniqueVertices;
+        }
+        if (time - insertedAt[v] > cacheSize)
+        {
+            insertedAt[v] = time++;
+            ++misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triCount);
+    stats.atvr = uniqueVertices > 0 ? static_cast<float>(misses) / static_cast<float>(uniqueVertices) : 0.0f;
+    return stats;
+}
+
+// ============================================================
+// 頂点の溶接
+// ============================================================
+
+namespace
+{
+
+/// 溶接用のキー (許容誤差の格子に量子化した属性)
+struct WeldKey
+{
+    int64_t q[15];
+    uint32_t joints[4];
+    uint32_t tangentSign;
+    uint32_t _pad;      // memcmp・ハッシュの対象に未初期化の詰め物を含めない
+
+    bool operator==(const WeldKey& other) const
+    {
+        return std::memcmp(this, &other, sizeof(WeldKey)) == 0;
+    }
+};
+
+struct WeldKeyHash
+{
+    size_t operator()(const WeldKey& key) const
+    {
+        // FNV-1a
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&key);
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t i = 0; i < sizeof(WeldKey); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+int64_t Quantize(float value, float tolerance)
+{
+    if (tolerance <= 0.0f)
+    {
+        // 許容誤差0は完全一致 (ビット列で比較、-0と+0は同じ)
+        if (value == 0.0f) return 0;
+        uint32_t bits;
+        std::memcpy(&bits, &value, 4);
+        return bits;
+    }
+    return static_cast<int64_t>(std::floor(value / tolerance));
+}
+
+WeldKey MakeWeldKey(const IntermediateVertex& v, const WeldTolerance& tolerance)
+{
+    WeldKey key{};
+    int n = 0;
+    for (int i = 0; i < 3; ++i) key.q[n++] = Quantize(v.position[i], tolerance.position);
+    for (int i = 0; i < 3; ++i) key.q[n++] = Quantize(v.normal[i], tolerance.normal);
+    for (int i = 0; i < 2; ++i) key.q[n++] = Quantize(v.texcoord[i], tolerance.texcoord);
+    for (int i = 0; i < 3; ++i) key.q[n++] = Quantize(v.tangent[i], tolerance.tangent);
+    for (int i = 0; i < 4; ++i) key.q[n++] = Quantize(v.weights[i], tolerance.weight);
+    for (int i = 0; i < 4; ++i) key.joints[i] = v.weights[i] != 0.0f ? v.joints[i] : 0; // ウェイト0のジョイントは無視
+    key.tangentSign = v.tangent[3] < 0.0f ? 1 : 0;
+    return key;
+}
+
+} // namespace
+
+uint32_t WeldVertices(IntermediateMesh& mesh, const WeldTolerance& tolerance)
+{
+    const size_t vertexCount = mesh.vertices.size();
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> unique;
+    unique.reserve(vertexCount);
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<IntermediateVertex> welded;
+    welded.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        auto [it, inserted] = unique.emplace(MakeWeldKey(mesh.vertices[i], tolerance),
+                                             static_cast<uint32_t>(welded.size()));
+        if (inserted)
+            welded.push_back(mesh.vertices[i]); // 最初に現れた頂点の属性を残す
+        remap[i] = it->second;
+    }
+
+    if (welded.size() == vertexCount)
+        return static_cast<uint32_t>(vertexCount);
+
+    for (auto& index : mesh.indices)
+    {
+        if (index < vertexCount)
+            index = remap[index];
+    }
+    mesh.vertices = std::move(welded);
+    return static_cast<uint32_t>(mesh.vertices.size());
+}
+
+// ============================================================
+// 頂点キャッシュ最適化 (Forsyth)
+// ============================================================
+
+namespace
+{
+
+constexpr uint32_t k_ForsythCacheSize     = 32;    // スコア計算で想定するLRUキャッシュのサイズ
+constexpr float    k_CacheDecayPower      = 1.5f;
+constexpr float    k_LastTriScore         = 0.75f; // 直前の三角形の頂点 (あえて少し低くする)
+constexpr float    k_ValenceBoostScale    = 2.0f;
+constexpr float    k_ValenceBoostPower    = 0.5f;
+
+/// 頂点スコア: キャッシュ内の位置が新しいほど、残りの三角形が少ないほど高い
+float ForsythVertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            score = k_LastTriScore;
+        }
+        else
+        {
+            const float scaler = 1.0f / static_cast<float>(k_ForsythCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, k_CacheDecayPower);
+        }
+    }
+    // 残りが少ない頂点を早く片付ける (孤立した三角形を残さない)
+    score += k_ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -k_ValenceBoostPower);
+    return score;
+}
+
+} // namespace
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0)
+        return;
+    for (size_t i = 0; i < triCount * 3; ++i)
+    {
+        if (indices[i] >= vertexCount)
+            return;
+    }
+
+    // 頂点 → 未出力の三角形の隣接リスト (remaining[v]個が有効、出力したものは末尾へ寄せる)
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triCount * 3; ++i)
+        ++remaining[indices[i]];
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<uint32_t> adjacency(triCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+
+    std::vector<float> triScore(triCount);
+    std::vector<uint8_t> emitted(triCount, 0);
+    int64_t best = 0;
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (triScore[t] > triScore[best])
+            best = static_cast<int64_t>(t);
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(triCount * 3);
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(k_ForsythCacheSize + 3);
+    nextCache.reserve(k_ForsythCacheSize + 3);
+    size_t scanCursor = 0;
+
+    while (best >= 0)
+    {
+        const size_t tri = static_cast<size_t>(best);
+        emitted[tri] = 1;
+        const uint32_t corners[3] = { indices[tri * 3], indices[tri * 3 + 1], indices[tri * 3 + 2] };
+        result.insert(result.end(), corners, corners + 3);
+
+        // 出力した三角形を各頂点の隣接リストから外す
+        for (uint32_t v : corners)
+        {
+            uint32_t* list = adjacency.data() + offsets[v];
+            for (uint32_t k = 0; k < remaining[v]; ++k)
+            {
+                if (list[k] == tri)
+                {
+                    std::swap(list[k], list[remaining[v] - 1]);
+                    --remaining[v];
+                    break;
+                }
+            }
+        }
+
+        // LRUキャッシュを更新する (今の三角形の頂点を先頭へ)
+        nextCache.assign(corners, corners + 3);
+        for (uint32_t v : cache)
+        {
+            if (v != corners[0] && v != corners[1] && v != corners[2])
+                nextCache.push_back(v);
+        }
+
+        // キャッシュ内の頂点 (押し出されたものを含む) のスコアと、その三角形のスコアを更新する
+        for (size_t i = 0; i < nextCache.size(); ++i)
+        {
+            const uint32_t v = nextCache[i];
+            cachePosition[v] = i < k_ForsythCacheSize ? static_cast<int>(i) : -1;
+            const float score = ForsythVertexScore(cachePosition[v], remaining[v]);
+            const float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (uint32_t k = 0; k < remaining[v]; ++k)
+                triScore[adjacency[offsets[v] + k]] += delta;
+        }
+        if (nextCache.size() > k_ForsythCacheSize)
+            nextCache.resize(k_ForsythCacheSize);
+        cache.swap(nextCache);
+
+        // 次はキャッシュ内の頂点を使う三角形から最もスコアの高いものを選ぶ
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache)
+        {
+            for (uint32_t k = 0; k < remaining[v]; ++k)
+            {
+                const uint32_t t = adjacency[offsets[v] + k];
+                if (triScore[t] > bestScore)
+                {
+                    bestScore = triScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        // 行き止まりなら未出力の三角形を先頭から探す
+        if (best < 0)
+        {
+            while (scanCursor < triCount && emitted[scanCursor])
+                ++scanCursor;
+            if (scanCursor < triCount)
+                best = static_cast<int64_t>(scanCursor);
+        }
+    }
+
+    indices.swap(result);
+}
+
+// ============================================================
+// オーバードロー最適化 (クラスタの並べ替え)
+// ============================================================
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<IntermediateVertex>& vertices,
+                      float threshold)
+{
+    const size_t triCount = indices.size() / 3;
+    const size_t vertexCount = vertices.size();
+    if (triCount < 2)
+        return;
+    for (size_t i = 0; i < triCount * 3; ++i)
+    {
+        if (indices[i] >= vertexCount)
+            return;
+    }
+
+    // FIFOキャッシュで三角形ごとのミス数を数える (reset=trueでキャッシュを空にしてから)
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    uint64_t time = 0;
+    auto countMisses = [&](size_t tri, bool reset) {
+        if (reset)
+            time += k_VertexCacheStatsSize + 1;
+        uint32_t misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[tri * 3 + k];
+            if (insertedAt[v] == 0 || time - insertedAt[v] >= k_VertexCacheStatsSize)
+            {
+                insertedAt[v] = ++time;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+
+    // 1. 全ての頂点がミスする三角形 (キャッシュが空から始まるのと同じ位置) で分割する
+    std::vector<size_t> hardBoundaries = { 0 };
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        if (countMisses(t, t == 0) == 3 && t > 0)
+            hardBoundaries.push_back(t);
+    }
+    hardBoundaries.push_back(triCount);
+
+    // 2. 各クラスタの中で、そこで切ってもACMRの悪化がthreshold倍以内の位置でさらに分割する
+    std::vector<size_t> clusterStarts;
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+    {
+        const size_t begin = hardBoundaries[h];
+        const size_t end = hardBoundaries[h + 1];
+
+        uint32_t clusterMisses = 0;
+        for (size_t t = begin; t < end; ++t)
+            clusterMisses += countMisses(t, t == begin);
+        const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        clusterStarts.push_back(begin);
+        uint32_t misses = 0;
+        size_t start = begin;
+        for (size_t t = begin; t < end; ++t)
+        {
+            misses += countMisses(t, t == start);
+            const size_t count = t + 1 - start;
+            if (t + 1 < end && count >= 8 &&
+                static_cast<float>(misses) / static_cast<float>(count) <= clusterAcmr * threshold)
+            {
+                start = t + 1;
+                misses = 0;
+                clusterStarts.push_back(start);
+            }
+        }
+    }
+    clusterStarts.push_back(triCount);
+
+    // 3. クラスタの面積加重の重心と法線から、メッシュ中心に対して外を向くクラスタを先に描く
+    const size_t clusterCount = clusterStarts.size() - 1;
+    struct Cluster
+    {
+        size_t begin, end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(clusterCount);
+    std::vector<float> centroids(clusterCount * 3, 0.0f);
+    std::vector<float> normals(clusterCount * 3, 0.0f);
+    float meshCentroid[3] = {};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        clusters[c].begin = clusterStarts[c];
+        clusters[c].end = clusterStarts[c + 1];
+        float area = 0.0f;
+        for (size_t t = clusters[c].begin; t < clusters[c].end; ++t)
+        {
+            const float* p0 = vertices[indices[t * 3]].position;
+            const float* p1 = vertices[indices[t * 3 + 1]].position;
+            const float* p2 = vertices[indices[t * 3 + 2]].position;
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1],
+                                 e1[2] * e2[0] - e1[0] * e2[2],
+                                 e1[0] * e2[1] - e1[1] * e2[0] };
+            const float triArea = 0.5f * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; ++k)
+            {
+                centroids[c * 3 + k] += (p0[k] + p1[k] + p2[k]) * (triArea / 3.0f);
+                normals[c * 3 + k] += n[k];
+            }
+            area += triArea;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            meshCentroid[k] += centroids[c * 3 + k];
+            if (area > 0.0f)
+                centroids[c * 3 + k] /= area;
+        }
+        meshArea += area;
+    }
+    if (meshArea <= 0.0f)
+        return;
+    for (float& value : meshCentroid)
+        value /= meshArea;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const float* n = &normals[c * 3];
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float key = 0.0f;
+        if (length > 0.0f)
+        {
+            for (int k = 0; k < 3; ++k)
+                key += (centroids[c * 3 + k] - meshCentroid[k]) * n[k];
+            key /= length;
+        }
+        clusters[c].sortKey = key;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    indices.swap(result);
+}
+
+// ============================================================
+// 頂点フェッチ最適化
+// ============================================================
+
+void OptimizeVertexFetch(IntermediateMesh& mesh)
+{
+    const size_t vertexCount = mesh.vertices.size();
+    constexpr uint32_t k_Unassigned = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertexCount, k_Unassigned);
+    std::vector<IntermediateVertex> ordered;
+    ordered.reserve(vertexCount);
+    for (auto& index : mesh.indices)
+    {
+        if (index >= vertexCount)
+            return; // 範囲外のインデックスがあれば何もしない (途中まで書き換えないよう先に確認する)
+    }
+    for (auto& index : mesh.indices)
+    {
+        if (remap[index] == k_Unassigned)
+        {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(ordered);
+}
+
+// ============================================================
+// まとめて実行
+// ============================================================
+
+MeshOptimizeReport OptimizeMesh(IntermediateMesh& mesh, const MeshOptimizeOptions& options)
+{
+    MeshOptimizeReport report;
+    report.verticesBefore = static_cast<uint32_t>(mesh.vertices.size());
+    report.before = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+    if (options.weld)
+        WeldVertices(mesh, options.tolerance);
+    if (options.vertexCache)
+        OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+    if (options.vertexCache && options.overdraw)
+        OptimizeOverdraw(mesh.indices, mesh.vertices, options.overdrawThreshold);
+    if (options.vertexFetch)
+        OptimizeVertexFetch(mesh);
+
+    report.verticesAfter = static_cast<uint32_t>(mesh.vertices.size());
+    report.after = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+    return report;
+}
+
+} // namespace gxconv
@@ -0,0 +1,101 @@
+#pragma once
+/// @file mesh_optimizer.h
+/// @brief メッシュ最適化パス (頂点の溶接・三角形の並べ替え・頂点の並べ替え)
+///
+/// インポーターが出力した中間表現をエクスポート前に最適化する。
+/// 三角形の集合と各頂点の属性は許容誤差の範囲で変わらず、順序だけが変わる。
+///
+/// 1. WeldVertices        : 属性が許容誤差内で一致する頂点をハッシュで統合する
+/// 2. OptimizeVertexCache : 変換後頂点キャッシュのヒット率が上がるよう三角形を並べ替える (Forsyth法)
+/// 3. OptimizeOverdraw    : キャッシュ効率を保てる単位のクラスタを外向きのものから描く順に並べ替える
+/// 4. OptimizeVertexFetch : 頂点を初めて参照される順に並べ替え、未使用の頂点を除く
+
+#include <cstdint>
+#include <vector>
+#include "intermediate/scene.h"
+
+namespace gxconv
+{
+
+/// @brief 頂点溶接の許容誤差 (各成分の差がこれ未満なら同じ頂点とみなす)
+/// @details 属性を許容誤差の格子に量子化してハッシュするため、格子の境界をまたぐ頂点は統合されない。
+struct WeldTolerance
+{
+    float position = 1e-6f;  ///< 位置
+    float normal   = 1e-3f;  ///< 法線
+    float texcoord = 1e-5f;  ///< UV
+    float tangent  = 1e-3f;  ///< 接線 (wの符号は完全一致)
+    float weight   = 1e-4f;  ///< スキンウェイト (ジョイント番号は完全一致)
+};
+
+/// @brief メッシュ最適化のオプション
+struct MeshOptimizeOptions
+{
+    bool weld        = true;            ///< 頂点を溶接する
+    bool vertexCache = true;            ///< 頂点キャッシュ順に三角形を並べ替える
+    bool overdraw    = true;            ///< オーバードローが減るようクラスタを並べ替える
+    bool vertexFetch = true;            ///< 頂点を参照順に並べ替える
+    float overdrawThreshold = 1.05f;    ///< クラスタ分割で許すACMRの悪化率 (1.0で分割しない)
+    WeldTolerance tolerance;            ///< 溶接の許容誤差
+};
+
+/// @brief 頂点キャッシュの効率 (FIFOキャッシュのシミュレーション結果)
+struct VertexCacheStats
+{
+    float acmr = 0.0f;  ///< 三角形あたりのキャッシュミス数 (0.5～3.0、小さいほど良い)
+    float atvr = 0.0f;  ///< 参照される頂点あたりのキャッシュミス数 (1.0が最良)
+};
+
+/// @brief OptimizeMesh() の結果
+struct MeshOptimizeReport
+{
+    uint32_t verticesBefore = 0;    ///< 最適化前の頂点数
+    uint32_t verticesAfter  = 0;    ///< 最適化後の頂点数
+    VertexCacheStats before;        ///< 最適化前のキャッシュ効率
+    VertexCacheStats after;         ///< 最適化後のキャッシュ効率
+};
+
+/// 統計に使うFIFOキャッシュのサイズ (一般的なGPUの変換後キャッシュ相当)
+static constexpr uint32_t k_VertexCacheStatsSize = 16;
+
+/// @brief インデックス列の頂点キャッシュ効率を求める
+/// @param indices 三角形リストのインデックス
+/// @param vertexCount 頂点数
+/// @param cacheSize シミュレーションするFIFOキャッシュのサイズ
+/// @return ACMR / ATVR
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                     uint32_t cacheSize = k_VertexCacheStatsSize);
+
+/// @brief 属性が許容誤差内で一致する頂点を1つにまとめ、インデックスを付け替える
+/// @param mesh 対象メッシュ
+/// @param tolerance 属性ごとの許容誤差
+/// @return 溶接後の頂点数
+uint32_t WeldVertices(IntermediateMesh& mesh, const WeldTolerance& tolerance);
+
+/// @brief 変換後頂点キャッシュのヒット率が上がるよう三角形を並べ替える
+/// @details Tom Forsyth "Linear-Speed Vertex Cache Optimisation" の方式。
+///          範囲外のインデックスを含む場合は何もしない。
+/// @param indices 三角形リストのインデックス (並べ替えて上書き)
+/// @param vertexCount 頂点数
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+/// @brief キャッシュ最適化済みの三角形列をクラスタに分け、外向きのクラスタから描く順に並べ替える
+/// @details Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" の方式。
+///          キャッシュが空から始まる位置と、ACMRの悪化がthreshold倍以内に収まる位置で分割する。
+/// @param indices OptimizeVertexCache() 済みのインデックス (並べ替えて上書き)
+/// @param vertices 頂点 (位置のみ使う)
+/// @param threshold 分割で許すACMRの悪化率
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<IntermediateVertex>& vertices,
+                      float threshold);
+
+/// @brief 頂点を初めて参照される順に並べ替え、参照されない頂点を除く
+/// @param mesh 対象メッシュ
+void OptimizeVertexFetch(IntermediateMesh& mesh);
+
+/// @brief オプションに従って全ての最適化を順に行う
+/// @param mesh 対象メッシュ (三角形リスト)
+/// @param options 最適化オプション
+/// @return 最適化前後の頂点数とキャッシュ効率
+MeshOptimizeReport OptimizeMesh(IntermediateMesh& mesh, const MeshOptimizeOptions& options);
+
+} // namespace gxconv
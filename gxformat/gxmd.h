@@ -5,6 +5,7 @@
 /// .gxmdファイルはメッシュ・マテリアル・スケルトン・アニメーションを
 /// 単一バイナリにまとめた3Dモデル形式。gxconvで生成し、gxloaderで読み込む。
 
+#include <cmath>
 #include "types.h"
 #include "shader_model.h"
 
@@ -16,7 +17,7 @@ namespace gxfmt
 // ============================================================
 
 static constexpr uint32_t k_GxmdMagic   = 0x444D5847; ///< ファイル識別子 'GXMD'
-static constexpr uint32_t k_GxmdVersion = 2;           ///< 現在のフォーマットバージョン
+static constexpr uint32_t k_GxmdVersion = 3;           ///< 現在のフォーマットバージョン (3=量子化頂点フォーマット追加)
 
 // ============================================================
 // 頂点フォーマットフラグ
@@ -34,8 +35,19 @@ enum VertexFormat : uint32_t
     VF_UV1       = 1 << 6,  ///< テクスチャ座標1 (float2)
     VF_Color     = 1 << 7,  ///< 頂点カラー
 
+    // 量子化フラグ (v3以降): 対応する属性フラグと併せて立て、その属性の格納形式を変える
+    VF_PositionQ16 = 1 << 8,  ///< 位置をMeshChunkのAABB基準のunorm16x4で格納 (wは0)
+    VF_NormalOct   = 1 << 9,  ///< 法線を八面体エンコードのsnorm16x2で格納
+    VF_UV0Half     = 1 << 10, ///< テクスチャ座標0をhalf2で格納
+    VF_TangentOct  = 1 << 11, ///< 接線を八面体エンコードのsnorm16x2で格納 (yの符号=従法線の符号)
+    VF_Joints8     = 1 << 12, ///< ボーンインデックスをuint8x4で格納
+    VF_WeightsU8   = 1 << 13, ///< ボーンウェイトをunorm8x4で格納
+    VF_WeightsU16  = 1 << 14, ///< ボーンウェイトをunorm16x4で格納
+
     VF_Standard  = VF_Position | VF_Normal | VF_UV0 | VF_Tangent, ///< 標準頂点 (48B)
     VF_Skinned   = VF_Standard | VF_Joints | VF_Weights,          ///< スキニング頂点 (80B)
+    VF_QuantizedMask = VF_PositionQ16 | VF_NormalOct | VF_UV0Half | VF_TangentOct
+                     | VF_Joints8 | VF_WeightsU8 | VF_WeightsU16, ///< 量子化フラグ全体
 };
 
 /// @brief インデックスバッファのフォーマット
@@ -80,6 +92,283 @@ struct VertexSkinned
 
 static_assert(sizeof(VertexSkinned) == 80, "VertexSkinned must be 80 bytes");
 
+// ============================================================
+// 頂点レイアウト
+// ============================================================
+
+static constexpr uint32_t k_NoVertexAttribute = 0xFFFFFFFF; ///< 属性を含まないことを示すオフセット
+
+/// @brief 頂点フォーマットフラグから求めた1頂点内の属性オフセット
+/// @details 属性は位置・法線・UV0・接線・ジョイント・ウェイトの順に詰めて並ぶ。
+///          量子化フラグがなければVertexStandard/VertexSkinnedと同じ配置になる。
+///          量子化した標準頂点は20B、スキニング頂点は28B (ウェイト16bitなら32B)。
+struct VertexLayout
+{
+    uint32_t position = k_NoVertexAttribute; ///< 位置のオフセット
+    uint32_t normal   = k_NoVertexAttribute; ///< 法線のオフセット
+    uint32_t uv0      = k_NoVertexAttribute; ///< テクスチャ座標0のオフセット
+    uint32_t tangent  = k_NoVertexAttribute; ///< 接線のオフセット
+    uint32_t joints   = k_NoVertexAttribute; ///< ボーンインデックスのオフセット
+    uint32_t weights  = k_NoVertexAttribute; ///< ボーンウェイトのオフセット
+    uint32_t stride   = 0;                   ///< 1頂点あたりのバイト数
+};
+
+/// @brief 頂点フォーマットフラグから属性の配置を求める
+/// @param flags VertexFormatのビットマスク (UV1/Colorは対象外)
+/// @return 属性オフセットとストライド
+inline constexpr VertexLayout GetVertexLayout(uint32_t flags)
+{
+    VertexLayout layout;
+    uint32_t offset = 0;
+    if (flags & VF_Position)
+    {
+        layout.position = offset;
+        offset += (flags & VF_PositionQ16) ? 8 : 12;
+    }
+    if (flags & VF_Normal)
+    {
+        layout.normal = offset;
+        offset += (flags & VF_NormalOct) ? 4 : 12;
+    }
+    if (flags & VF_UV0)
+    {
+        layout.uv0 = offset;
+        offset += (flags & VF_UV0Half) ? 4 : 8;
+    }
+    if (flags & VF_Tangent)
+    {
+        layout.tangent = offset;
+        offset += (flags & VF_TangentOct) ? 4 : 16;
+    }
+    if (flags & VF_Joints)
+    {
+        layout.joints = offset;
+        offset += (flags & VF_Joints8) ? 4 : 16;
+    }
+    if (flags & VF_Weights)
+    {
+        layout.weights = offset;
+        offset += (flags & VF_WeightsU8) ? 4 : (flags & VF_WeightsU16) ? 8 : 16;
+    }
+    layout.stride = offset;
+    return layout;
+}
+
+static_assert(GetVertexLayout(VF_Standard).stride == sizeof(VertexStandard), "VF_Standard layout mismatch");
+static_assert(GetVertexLayout(VF_Skinned).stride == sizeof(VertexSkinned), "VF_Skinned layout mismatch");
+
+// ============================================================
+// 頂点量子化ヘルパー (gxconvのエンコードとgxloaderのデコードで共用)
+// ============================================================
+
+/// @brief floatをhalfに変換する (最近接偶数丸め、範囲外は最大有限値に飽和)
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t f;
+    std::memcpy(&f, &value, 4);
+    const uint32_t sign = (f >> 16) & 0x8000;
+    const uint32_t exponent = (f >> 23) & 0xFF;
+    uint32_t mantissa = f & 0x7FFFFF;
+
+    if (exponent == 0xFF)
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0)); // Inf/NaN
+
+    const int32_t e = static_cast<int32_t>(exponent) - 127 + 15;
+    if (e >= 31)
+        return static_cast<uint16_t>(sign | 0x7BFF);
+    if (e <= 0)
+    {
+        // halfの非正規化数 (またはゼロ)
+        if (e < -10)
+            return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - e);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rem = mantissa & ((1u << shift) - 1);
+        const uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1)))
+            ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(e) << 10) | (mantissa >> 13);
+    const uint32_t rem = mantissa & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+        ++half; // 仮数の桁上がりは指数に繰り上がる
+    if (half >= 0x7C00)
+        half = 0x7BFF;
+    return static_cast<uint16_t>(sign | half);
+}
+
+/// @brief halfをfloatに変換する
+inline float HalfToFloat(uint16_t half)
+{
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+
+    uint32_t f;
+    if (exponent == 0)
+    {
+        const float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 31)
+        f = sign | 0x7F800000 | (mantissa << 13);
+    else
+        f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float value;
+    std::memcpy(&value, &f, 4);
+    return value;
+}
+
+/// @brief [-1,1] をsnorm16に変換する
+inline int16_t FloatToSnorm16(float value)
+{
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+/// @brief snorm16を [-1,1] に戻す (-32768は-1として扱う)
+inline float Snorm16ToFloat(int16_t value)
+{
+    const float f = static_cast<float>(value) / 32767.0f;
+    return f < -1.0f ? -1.0f : f;
+}
+
+/// @brief 単位ベクトルを八面体エンコードする
+/// @param v 単位ベクトル (xyz)
+/// @param out 八面体座標 ([-1,1]の2成分)
+inline void OctEncode(const float v[3], float out[2])
+{
+    const float l1 = std::fabs(v[0]) + std::fabs(v[1]) + std::fabs(v[2]);
+    if (l1 <= 0.0f)
+    {
+        out[0] = out[1] = 0.0f; // 長さ0は+Z扱い
+        return;
+    }
+    const float x = v[0] / l1;
+    const float y = v[1] / l1;
+    if (v[2] >= 0.0f)
+    {
+        out[0] = x;
+        out[1] = y;
+    }
+    else
+    {
+        // 下半球は対角線で折り返す
+        out[0] = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        out[1] = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+}
+
+/// @brief 八面体座標を単位ベクトルに戻す
+/// @param e 八面体座標 ([-1,1]の2成分)
+/// @param out 単位ベクトル (xyz)
+inline void OctDecode(const float e[2], float out[3])
+{
+    float x = e[0];
+    float y = e[1];
+    const float z = 1.0f - std::fabs(x) - std::fabs(y);
+    if (z < 0.0f)
+    {
+        x = (1.0f - std::fabs(e[1])) * (e[0] >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::fabs(e[0])) * (e[1] >= 0.0f ? 1.0f : -1.0f);
+    }
+    const float len = std::sqrt(x * x + y * y + z * z);
+    out[0] = x / len;
+    out[1] = y / len;
+    out[2] = z / len;
+}
+
+/// @brief 法線を八面体エンコードのsnorm16x2に変換する (VF_NormalOct)
+inline void EncodeOctNormal(const float n[3], int16_t out[2])
+{
+    float e[2];
+    OctEncode(n, e);
+    out[0] = FloatToSnorm16(e[0]);
+    out[1] = FloatToSnorm16(e[1]);
+}
+
+/// @brief VF_NormalOctの法線をデコードする
+inline void DecodeOctNormal(const int16_t in[2], float out[3])
+{
+    const float e[2] = { Snorm16ToFloat(in[0]), Snorm16ToFloat(in[1]) };
+    OctDecode(e, out);
+}
+
+/// @brief 接線を八面体エンコードのsnorm16x2に変換する (VF_TangentOct)
+/// @details yは八面体座標を [0,1] に写して1～32767の15bitで持ち、従法線の符号をyの符号で表す。
+///          シェーダーでSNORMとして読む場合: s=sign(y), e.y=(|y|*32767-1)/32766*2-1
+/// @param t 接線 (xyz, w=従法線の符号)
+/// @param out エンコード結果
+inline void EncodeOctTangent(const float t[4], int16_t out[2])
+{
+    float e[2];
+    OctEncode(t, e);
+    out[0] = FloatToSnorm16(e[0]);
+    float u = e[1] * 0.5f + 0.5f;
+    u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+    const int32_t q = 1 + static_cast<int32_t>(std::lround(u * 32766.0f));
+    out[1] = static_cast<int16_t>(t[3] < 0.0f ? -q : q);
+}
+
+/// @brief VF_TangentOctの接線をデコードする
+/// @param in エンコード済みの接線
+/// @param out 接線 (xyz, w=従法線の符号 ±1)
+inline void DecodeOctTangent(const int16_t in[2], float out[4])
+{
+    const int32_t q = in[1] < 0 ? -static_cast<int32_t>(in[1]) : in[1];
+    const float u = static_cast<float>((q > 0 ? q : 1) - 1) / 32766.0f;
+    const float e[2] = { Snorm16ToFloat(in[0]), u * 2.0f - 1.0f };
+    OctDecode(e, out);
+    out[3] = in[1] < 0 ? -1.0f : 1.0f;
+}
+
+/// @brief 位置をAABB基準のunorm16x4に変換する (VF_PositionQ16、wは0)
+inline void QuantizePosition(const float p[3], const float aabbMin[3], const float aabbMax[3], uint16_t out[4])
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        const float extent = aabbMax[i] - aabbMin[i];
+        float u = extent > 0.0f ? (p[i] - aabbMin[i]) / extent : 0.0f;
+        u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+        out[i] = static_cast<uint16_t>(std::lround(u * 65535.0f));
+    }
+    out[3] = 0;
+}
+
+/// @brief VF_PositionQ16の位置をデコードする
+inline void DequantizePosition(const uint16_t in[4], const float aabbMin[3], const float aabbMax[3], float out[3])
+{
+    for (int i = 0; i < 3; ++i)
+        out[i] = aabbMin[i] + (aabbMax[i] - aabbMin[i]) * (static_cast<float>(in[i]) / 65535.0f);
+}
+
+/// @brief ウェイトを合計がmaxValueになるよう整数化する (VF_WeightsU8/VF_WeightsU16)
+/// @details 丸め誤差は最大のウェイトに寄せ、デコード後の合計が1.0からずれないようにする。
+/// @param w ウェイト (合計1.0に正規化済み)
+/// @param maxValue 255 (unorm8) または 65535 (unorm16)
+/// @param out 整数化したウェイト
+inline void QuantizeWeights(const float w[4], uint32_t maxValue, uint32_t out[4])
+{
+    int32_t sum = 0;
+    int largest = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const float c = w[i] < 0.0f ? 0.0f : (w[i] > 1.0f ? 1.0f : w[i]);
+        out[i] = static_cast<uint32_t>(std::lround(c * static_cast<float>(maxValue)));
+        sum += static_cast<int32_t>(out[i]);
+        if (w[i] > w[largest])
+            largest = i;
+    }
+    if (sum == 0)
+        return;
+    const int32_t fixedValue = static_cast<int32_t>(out[largest]) + static_cast<int32_t>(maxValue) - sum;
+    out[largest] = static_cast<uint32_t>(fixedValue < 0 ? 0 : fixedValue);
+}
+
 // ============================================================
 // ファイルヘッダ (128B)
 // ============================================================
@@ -89,7 +378,7 @@ static_assert(sizeof(VertexSkinned) == 80, "VertexSkinned must be 80 bytes");
 struct FileHeader
 {
     uint32_t magic;               ///< ファイル識別子 0x444D5847 ('GXMD')
-    uint32_t version;             ///< フォーマットバージョン (現在2)
+    uint32_t version;             ///< フォーマットバージョン (現在3)
     uint32_t flags;               ///< 予約フラグ
     uint32_t meshCount;           ///< メッシュ数
     uint32_t materialCount;       ///< マテリアル数
@@ -127,14 +416,14 @@ struct MeshChunk
     uint32_t indexCount;          ///< インデックス数
     uint32_t materialIndex;       ///< 対応するMaterialChunkのインデックス
     uint32_t vertexFormatFlags;   ///< 頂点属性のビットマスク (VertexFormat)
-    uint32_t vertexStride;        ///< 1頂点あたりのバイト数
+    uint32_t vertexStride;        ///< 1頂点あたりのバイト数 (GetVertexLayout(vertexFormatFlags).stride)
     uint64_t vertexOffset;        ///< 頂点データブロック内のバイトオフセット
     uint64_t indexOffset;         ///< インデックスデータブロック内のバイトオフセット
     IndexFormat     indexFormat;   ///< インデックスフォーマット (16bit/32bit)
     PrimitiveTopology topology;   ///< プリミティブトポロジー
     uint8_t  _pad[2];
-    float    aabbMin[3];          ///< バウンディングボックス最小値
-    float    aabbMax[3];          ///< バウンディングボックス最大値
+    float    aabbMin[3];          ///< バウンディングボックス最小値 (VF_PositionQ16の基準)
+    float    aabbMax[3];          ///< バウンディングボックス最大値 (VF_PositionQ16の基準)
 };
 
 /// @brief マテリアル1つ分の定義
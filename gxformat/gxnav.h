@@ -0,0 +1,162 @@
+#pragma once
+/// @file gxnav.h
+/// @brief GXNAVナビメッシュ形式の定義
+///
+/// .gxnavファイルはビルド済みのナビゲーションデータ。起動時のジオメトリ
+/// ラスタライズや傾斜フィルタを省略するため、オフラインで生成して保存する。
+/// セクションテーブル方式のため、ポリゴンナビメッシュ等のデータは
+/// バージョンを上げずにセクションとして追加できる。
+/// ファイル全体をメモリ(メモリマップや.gxpakエントリ)に置いたまま解析できる。
+
+#include <cmath>
+#include <cstdint>
+
+namespace gxfmt
+{
+
+// ============================================================
+// 定数
+// ============================================================
+
+static constexpr uint32_t k_GxnavMagic   = 0x564E5847; ///< ファイル識別子 'GXNV'
+static constexpr uint32_t k_GxnavVersion = 1;           ///< 現在のフォーマットバージョン
+
+/// @brief コスト倍率の量子化単位 (線形域: cost = 値 / 16、16 = 1.0)
+static constexpr float k_GxnavCostScale = 16.0f;
+
+/// @brief 線形域の最大値 (160 = 10.0)。これを超える値は対数域
+static constexpr uint8_t k_GxnavCostLinearMax = 160;
+
+/// @brief 対数域の1オクターブ (コスト2倍) あたりの段数
+static constexpr float k_GxnavCostStepsPerOctave = 12.0f;
+
+/// @brief 表現できるコスト倍率の範囲
+/// @details 1/16～10 は1/16刻みで正確に、10～約2416 (値255) は約6%刻みの対数で保存する。
+///          範囲外の値は端に丸められる。
+static constexpr float k_GxnavCostMin = 1.0f / 16.0f;
+static constexpr float k_GxnavCostMax = 2416.0f;
+
+/// @brief GxnavCell::cost の値をコスト倍率に戻す
+inline float DecodeGxnavCost(uint8_t value)
+{
+    if (value <= k_GxnavCostLinearMax)
+        return (value > 0 ? value : 1) / k_GxnavCostScale;
+    const float linearMax = k_GxnavCostLinearMax / k_GxnavCostScale;
+    return linearMax * std::exp2((value - k_GxnavCostLinearMax) / k_GxnavCostStepsPerOctave);
+}
+
+/// @brief コスト倍率を GxnavCell::cost の値にする (範囲外は端に丸める)
+inline uint8_t EncodeGxnavCost(float cost)
+{
+    const float linear = std::round(cost * k_GxnavCostScale);
+    if (!(linear > 1.0f))
+        return 1;
+    if (linear <= k_GxnavCostLinearMax)
+        return static_cast<uint8_t>(linear);
+    const float linearMax = k_GxnavCostLinearMax / k_GxnavCostScale;
+    const float steps = std::round(std::log2(cost / linearMax) * k_GxnavCostStepsPerOctave);
+    const float value = k_GxnavCostLinearMax + steps;
+    return static_cast<uint8_t>(value < 255.0f ? value : 255.0f);
+}
+
+// ============================================================
+// ヘッダ (64B)
+// ============================================================
+
+/// @brief GXNAVファイルの先頭に配置されるヘッダ (64B固定)
+struct GxnavHeader
+{
+    uint32_t magic;              ///< ファイル識別子 0x564E5847 ('GXNV')
+    uint32_t version;            ///< フォーマットバージョン (現在1)
+    uint32_t flags;              ///< 予約 (0)
+    uint32_t sectionCount;       ///< セクション数
+    uint32_t gridWidth;          ///< グリッドのセル数 (X)
+    uint32_t gridHeight;         ///< グリッドのセル数 (Z)
+    float    cellSize;           ///< セルの一辺 (ワールド単位)
+    float    worldMinX;          ///< グリッド原点 X
+    float    worldMinZ;          ///< グリッド原点 Z
+    float    heightMin;          ///< 量子化高さの基準値
+    float    heightScale;        ///< 量子化高さ1あたりの高さ (height = heightMin + q * heightScale)
+    uint32_t clusterSize;        ///< HPA*クラスタサイズ (0 = 階層なし)
+    uint64_t sectionTableOffset; ///< GxnavSection配列のファイル先頭からのオフセット
+    uint8_t  _reserved[8];      ///< 64Bパディング用予約
+};
+
+static_assert(sizeof(GxnavHeader) == 64, "GxnavHeader must be 64 bytes");
+
+// ============================================================
+// セクション
+// ============================================================
+
+/// @brief セクション種別
+enum class GxnavSectionType : uint32_t
+{
+    GridCells    = 1,   ///< GxnavCell[gridWidth * gridHeight] (行優先、Z→X)
+    Polys        = 2,   ///< GxnavPoly[count] (ポリゴンナビメッシュ用に予約)
+    PolyVertices = 3,   ///< float[3][count] (ポリゴンナビメッシュ用に予約)
+    Links        = 4,   ///< GxnavLink[count] (ポリゴンナビメッシュ用に予約)
+};
+
+/// @brief セクションテーブルのエントリ (16B)
+/// @details 読み込み側は未知の種別を無視する。
+struct GxnavSection
+{
+    GxnavSectionType type;       ///< セクション種別
+    uint32_t         count;      ///< 要素数
+    uint64_t         offset;     ///< データのファイル先頭からのオフセット (16Bアライン)
+};
+
+static_assert(sizeof(GxnavSection) == 16, "GxnavSection must be 16 bytes");
+
+// ============================================================
+// グリッドセル (4B)
+// ============================================================
+
+static constexpr uint8_t k_GxnavCellWalkable = 0x01; ///< GxnavCell::flags: 歩行可能
+
+/// @brief 量子化されたグリッドセル
+struct GxnavCell
+{
+    uint16_t height;             ///< 量子化高さ (GxnavHeader::heightMin / heightScale)
+    uint8_t  flags;              ///< k_GxnavCellWalkable
+    uint8_t  cost;               ///< コスト倍率 (EncodeGxnavCost()、1～255)
+};
+
+static_assert(sizeof(GxnavCell) == 4, "GxnavCell must be 4 bytes");
+
+// ============================================================
+// ポリゴン / リンク (予約)
+// ============================================================
+
+/// @brief ポリゴン (16B)
+struct GxnavPoly
+{
+    uint32_t firstVertex;        ///< PolyVertices内の先頭頂点
+    uint32_t firstLink;          ///< Links内の先頭リンク
+    uint8_t  vertexCount;        ///< 頂点数
+    uint8_t  linkCount;          ///< リンク数
+    uint8_t  area;               ///< エリア種別
+    uint8_t  _pad;
+    uint32_t tile;               ///< 所属タイル
+};
+
+static_assert(sizeof(GxnavPoly) == 16, "GxnavPoly must be 16 bytes");
+
+/// @brief ポリゴン間リンク (8B)
+struct GxnavLink
+{
+    uint32_t targetPoly;         ///< 接続先ポリゴン
+    uint8_t  edge;               ///< 自ポリゴン側の辺番号
+    uint8_t  _pad[3];
+};
+
+static_assert(sizeof(GxnavLink) == 8, "GxnavLink must be 8 bytes");
+
+// ============================================================
+// Binary layout:
+//   [GxnavHeader 64B]
+//   [GxnavSection x sectionCount at sectionTableOffset]
+//   [Section data blocks (16B aligned)]
+// ============================================================
+
+} // namespace gxfmt
@@ -3,11 +3,17 @@
 /// @brief GXPAKアセットバンドル形式の定義
 ///
 /// .gxpakファイルは複数のアセット(.gxmd, .gxan, テクスチャ等)を
-/// 単一アーカイブにまとめる形式。エントリ単位でLZ4圧縮に対応する。
+/// 単一アーカイブにまとめる形式。エントリごとにコーデック (非圧縮 / LZ4 / LZ4HC / Zstd と、
+/// それぞれの辞書付き版) を選べる。LZ4HCは展開速度をLZ4のまま圧縮率を上げ、Zstdは展開が遅い代わりに
+/// さらに小さくなる。辞書付きは小さく似たファイルが多いバンドル向けで、辞書はバンドルに1つ格納される。
+/// データは内容ハッシュで重複排除され、同じ内容の複数パスは同じデータ位置を指す。
+/// パッチバンドルはベースバンドルに無いデータだけを持ち、残りのエントリはベースのデータを参照する。
 /// gxpakツールで生成し、gxloader::PakLoaderまたはPakFileProviderで読み込む。
 
 #include "types.h"
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 namespace gxfmt
 {
@@ -17,7 +23,39 @@ namespace gxfmt
 // ============================================================
 
 static constexpr uint32_t k_GxpakMagic   = 0x4B505847; ///< ファイル識別子 'GXPK'
-static constexpr uint32_t k_GxpakVersion = 1;           ///< 現在のフォーマットバージョン
+static constexpr uint32_t k_GxpakVersion = 2;           ///< 現在のフォーマットバージョン (1は旧形式として読み込み可)
+
+static constexpr uint32_t k_GxpakFlagCompressed = 0x01; ///< GxpakHeader::flags: 圧縮エントリあり
+static constexpr uint32_t k_GxpakFlagDictionary = 0x02; ///< GxpakHeader::flags: 圧縮辞書あり
+static constexpr uint32_t k_GxpakFlagPatch      = 0x04; ///< GxpakHeader::flags: ベースバンドルを参照するパッチ
+
+static constexpr uint8_t k_GxpakEntryFlagInBase = 0x01; ///< GxpakEntry::flags: データはベースバンドル内にある
+static constexpr uint32_t k_GxpakMaxDictSize = 256 * 1024; ///< 辞書の最大サイズ (LZ4Dictが参照するのは末尾64KBまで)
+
+// ============================================================
+// コーデック
+// ============================================================
+
+/// @brief エントリの圧縮コーデック (TOCの1バイト)
+/// @details バージョン1の「圧縮フラグ=1」はLZ4としてそのまま読める。
+///          共有辞書はZDICTで学習したZstd形式の辞書で、LZ4Dictは辞書全体を直前のデータとして参照する。
+enum class GxpakCodec : uint8_t
+{
+    None     = 0,   ///< 非圧縮
+    LZ4      = 1,   ///< LZ4ブロック
+    LZ4Dict  = 2,   ///< バンドル共有辞書付きLZ4ブロック (GxpakTocHeader::dictOffset)
+    LZ4HC    = 3,   ///< LZ4HCで圧縮したLZ4ブロック (展開はLZ4と同じ)
+    Zstd     = 4,   ///< Zstdフレーム
+    ZstdDict = 5,   ///< バンドル共有辞書付きZstdフレーム
+};
+
+static constexpr uint8_t k_GxpakCodecCount = 6; ///< GxpakCodecの値の数 (これ以上の値は不正)
+
+/// @brief バンドル共有辞書を使うコーデックか
+inline bool GxpakCodecUsesDict(GxpakCodec codec)
+{
+    return codec == GxpakCodec::LZ4Dict || codec == GxpakCodec::ZstdDict;
+}
 
 // ============================================================
 // アセット種別
@@ -40,9 +78,9 @@ enum class GxpakAssetType : uint8_t
 struct GxpakHeader
 {
     uint32_t magic;           ///< ファイル識別子 0x4B505847 ('GXPK')
-    uint32_t version;         ///< フォーマットバージョン (現在1)
+    uint32_t version;         ///< フォーマットバージョン (現在2、1も読み込み可)
     uint32_t entryCount;      ///< エントリ数
-    uint32_t flags;           ///< フラグ (bit0: LZ4圧縮エントリあり)
+    uint32_t flags;           ///< フラグ (k_GxpakFlagCompressed / k_GxpakFlagDictionary / k_GxpakFlagPatch)
     uint64_t tocOffset;       ///< TOCのファイル先頭からのオフセット (ファイル末尾に配置)
     uint64_t tocSize;         ///< TOCのバイト数
 };
@@ -53,18 +91,35 @@ static_assert(sizeof(GxpakHeader) == 32, "GxpakHeader must be 32 bytes");
 // TOCエントリ (ファイル末尾に配置)
 // ============================================================
 
+/// @brief TOCの先頭に置かれる情報 (バージョン1には無い)
+struct GxpakTocHeader
+{
+    uint64_t dictOffset;      ///< 圧縮辞書のファイル先頭からのオフセット (dictSize == 0 なら無効)
+    uint32_t dictSize;        ///< 圧縮辞書のバイト数 (k_GxpakMaxDictSize以下)
+    uint32_t _reserved;
+    uint64_t packId;          ///< このバンドルの識別子 (TOCと辞書の内容ハッシュ)
+    uint64_t basePackId;      ///< パッチが参照するベースのpackId (パッチでなければ0)
+};
+
+static_assert(sizeof(GxpakTocHeader) == 32, "GxpakTocHeader must be 32 bytes");
+
 /// @brief TOCのディスク上シリアライズ形式 (可変長)
 /// @details pathLengthの直後にpathLength バイトのUTF-8パス文字列が続く。
+///          バージョン1は pathHash と contentHash を持たず (pathHashは読み込み時に計算)、
+///          codec は圧縮フラグ、flags と level は0埋めのパディング。
 struct GxpakTocEntry
 {
     uint32_t       pathLength;       ///< パス文字列のバイト長 (null終端含まず)
     // ↓ pathLengthバイトのUTF-8パス文字列 (null終端)
     GxpakAssetType assetType;        ///< アセット種別
-    uint8_t        compressed;       ///< LZ4圧縮フラグ (1=圧縮済み)
-    uint8_t        _pad[2];
-    uint64_t       dataOffset;       ///< データのファイル先頭からのオフセット
+    GxpakCodec     codec;            ///< 圧縮コーデック (v1では圧縮フラグ: 1=LZ4)
+    uint8_t        flags;            ///< k_GxpakEntryFlagInBase
+    uint8_t        level;            ///< 圧縮レベル (LZ4HC・Zstd系のみ。展開には使わない)
+    uint64_t       dataOffset;       ///< データのファイル先頭からのオフセット (InBaseならベース内、複数エントリで共有され得る)
     uint32_t       compressedSize;   ///< ディスク上のサイズ (圧縮後)
     uint32_t       originalSize;     ///< 非圧縮時のサイズ
+    uint64_t       pathHash;         ///< HashPath(path) (パック時に計算)
+    uint64_t       contentHash;      ///< HashContent(展開後データ)
 };
 
 /// @brief TOCエントリのメモリ上表現 (固定長)
@@ -73,19 +128,112 @@ struct GxpakEntry
 {
     char           path[260];        ///< バンドル内のUTF-8パス
     GxpakAssetType assetType;        ///< アセット種別
-    bool           compressed;       ///< LZ4圧縮フラグ
-    uint64_t       dataOffset;       ///< データのファイル先頭からのオフセット
+    GxpakCodec     codec;            ///< 圧縮コーデック
+    uint8_t        flags;            ///< k_GxpakEntryFlagInBase
+    uint8_t        level;            ///< 圧縮レベル (v1・LZ4系は0)
+    uint64_t       dataOffset;       ///< データのファイル先頭からのオフセット (InBaseならベース内)
     uint32_t       compressedSize;   ///< ディスク上のサイズ
     uint32_t       originalSize;     ///< 非圧縮時のサイズ
+    uint64_t       pathHash;         ///< HashPath(path)
+    uint64_t       contentHash;      ///< HashContent(展開後データ) (v1は0)
 };
 
 // ============================================================
 // Binary layout:
 //   [GxpakHeader 32B]
-//   [Entry data blocks (contiguous, per-entry)]
-//   [TOC at tocOffset: serialized GxpakTocEntry array]
+//   [Dictionary (optional, dictSize bytes)]
+//   [Entry data blocks (contiguous, one per unique content)]
+//   [TOC at tocOffset: GxpakTocHeader (v2) + serialized GxpakTocEntry array]
 // ============================================================
 
+/// @brief バンドル内パスの64bitハッシュ (FNV-1a)
+/// @details パック時にTOCへ格納され、読み込み側はこの値でエントリを引く。
+///          パスはバイト列のまま扱う (大文字小文字・区切り文字の正規化はしない)。
+///          ランタイムで使うパスのハッシュを事前計算しておけば文字列比較を省ける。
+/// @param path UTF-8パス
+/// @param length パスのバイト長
+/// @return 64bitハッシュ値
+inline uint64_t HashPath(const char* path, size_t length)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<uint8_t>(path[i]);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/// @brief null終端パスの64bitハッシュ
+inline uint64_t HashPath(const char* path)
+{
+    size_t length = 0;
+    while (path[length]) ++length;
+    return HashPath(path, length);
+}
+
+/// @brief データ内容の64bitハッシュ (XXH64、シード0)
+/// @details 差分再パックで変更のないエントリを見分けるためにTOCへ格納する。
+///          暗号学的な強度はないため、サイズの一致と併せて判定に使う。
+/// @param data データ
+/// @param size バイト数
+/// @return 64bitハッシュ値
+inline uint64_t HashContent(const void* data, size_t size)
+{
+    constexpr uint64_t k_P1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t k_P2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t k_P3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t k_P4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t k_P5 = 0x27D4EB2F165667C5ull;
+
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto read64 = [](const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; };
+    auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * k_P2, 31) * k_P1; };
+
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+    if (size >= 32)
+    {
+        uint64_t v1 = k_P1 + k_P2, v2 = k_P2, v3 = 0, v4 = 0 - k_P1;
+        for (; p + 32 <= end; p += 32)
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        const uint64_t lanes[4] = { v1, v2, v3, v4 };
+        for (uint64_t v : lanes)
+            h = (h ^ round(0, v)) * k_P1 + k_P4;
+    }
+    else
+    {
+        h = k_P5;
+    }
+
+    h += size;
+    for (; p + 8 <= end; p += 8)
+        h = rotl(h ^ round(0, read64(p)), 27) * k_P1 + k_P4;
+    if (p + 4 <= end)
+    {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        h = rotl(h ^ (v * k_P1), 23) * k_P2 + k_P3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+        h = rotl(h ^ (*p * k_P5), 11) * k_P1;
+
+    h ^= h >> 33;
+    h *= k_P2;
+    h ^= h >> 29;
+    h *= k_P3;
+    h ^= h >> 32;
+    return h;
+}
+
 /// @brief ファイル拡張子からアセット種別を判定する
 /// @param path ファイルパス (拡張子部分のみ使用)
 /// @return 判定されたアセット種別。不明な場合はOther
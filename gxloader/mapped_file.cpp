@@ -0,0 +1,123 @@
+/// @file mapped_file.cpp
+/// @brief 読み取り専用メモリマップドファイルの実装
+
+#include "mapped_file.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gxloader
+{
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const std::string& filePath)
+{
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    mapped->m_file = file;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) return nullptr;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return nullptr;
+    mapped->m_mapping = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) return nullptr;
+    mapped->m_data = static_cast<const uint8_t*>(view);
+    mapped->m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return nullptr; }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // マッピングはfdを閉じても有効
+    if (view == MAP_FAILED) return nullptr;
+    mapped->m_data = static_cast<const uint8_t*>(view);
+    mapped->m_size = static_cast<uint64_t>(st.st_size);
+#endif
+
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+#else
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+#endif
+}
+
+void MappedFile::Prefetch(std::vector<MappedRange> ranges) const
+{
+    if (!m_data || ranges.empty())
+        return;
+
+    // オフセット順に並べ、重なる・近接する範囲を結合する
+    std::sort(ranges.begin(), ranges.end(),
+        [](const MappedRange& a, const MappedRange& b) { return a.offset < b.offset; });
+
+    std::vector<MappedRange> merged;
+    merged.reserve(ranges.size());
+    for (const MappedRange& r : ranges)
+    {
+        if (r.offset >= m_size || r.size == 0)
+            continue;
+        const uint64_t end = (std::min)(r.offset + r.size, m_size);
+        if (!merged.empty() && r.offset <= merged.back().offset + merged.back().size + k_PrefetchMergeGap)
+        {
+            MappedRange& last = merged.back();
+            last.size = (std::max)(last.offset + last.size, end) - last.offset;
+        }
+        else
+        {
+            merged.push_back({ r.offset, end - r.offset });
+        }
+    }
+    if (merged.empty())
+        return;
+
+#ifdef _WIN32
+    std::vector<WIN32_MEMORY_RANGE_ENTRY> entries(merged.size());
+    for (size_t i = 0; i < merged.size(); ++i)
+    {
+        entries[i].VirtualAddress = const_cast<uint8_t*>(m_data + merged[i].offset);
+        entries[i].NumberOfBytes = static_cast<SIZE_T>(merged[i].size);
+    }
+    PrefetchVirtualMemory(GetCurrentProcess(), entries.size(), entries.data(), 0);
+#else
+    // madviseはページ境界に揃えたアドレスを要求する
+    const uint64_t pageMask = static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) - 1;
+    for (const MappedRange& r : merged)
+    {
+        const uint64_t begin = r.offset & ~pageMask;
+        madvise(const_cast<uint8_t*>(m_data + begin), static_cast<size_t>(r.offset + r.size - begin),
+                MADV_WILLNEED);
+    }
+#endif
+}
+
+} // namespace gxloader
@@ -0,0 +1,80 @@
+#pragma once
+/// @file mapped_file.h
+/// @brief 読み取り専用メモリマップドファイル
+///
+/// ファイル全体を一度だけマップし、複数のエントリ読み込みで共有する。
+/// Windows は CreateFileMapping/MapViewOfFile、それ以外は mmap を使う。
+/// MappedView が shared_ptr でマッピングを保持するため、
+/// ローダーを閉じた後もビューが生きている間はメモリが有効なまま残る。
+/// 多数の小さなエントリを読む前に Prefetch() でまとめて先読みを要求できる。
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace gxloader
+{
+
+/// @brief ファイル内のバイト範囲 (Prefetch用)
+struct MappedRange
+{
+    uint64_t offset = 0;    ///< ファイル先頭からのオフセット
+    uint64_t size   = 0;    ///< バイト数
+};
+
+/// @brief 読み取り専用でマップされたファイル
+/// @details Open()でのみ生成できる。破棄時にマッピングを解放する。
+class MappedFile
+{
+public:
+    /// @brief ファイルを読み取り専用でマップする
+    /// @param filePath ファイルパス
+    /// @return マッピング。失敗時 (存在しない・空ファイル等) はnullptr
+    static std::shared_ptr<const MappedFile> Open(const std::string& filePath);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief マップ先頭のポインタ
+    const uint8_t* Data() const { return m_data; }
+
+    /// @brief ファイルサイズ (バイト)
+    uint64_t Size() const { return m_size; }
+
+    /// @brief 複数範囲の先読みを1回の要求でOSに依頼する
+    /// @details 範囲をオフセット順に並べ、近接する範囲 (k_PrefetchMergeGap以内) を結合してから
+    ///          Windows は PrefetchVirtualMemory、それ以外は madvise(MADV_WILLNEED) で要求する。
+    ///          ページフォルトごとの同期読み込みを減らすためのヒントで、失敗しても読み込みには影響しない。
+    /// @param ranges 先読みする範囲 (ファイル外は切り詰める)
+    void Prefetch(std::vector<MappedRange> ranges) const;
+
+    /// @brief この距離以内の範囲は1つの先読み要求に結合する
+    static constexpr uint64_t k_PrefetchMergeGap = 64 * 1024;
+
+private:
+    MappedFile() = default;
+
+    const uint8_t* m_data = nullptr;
+    uint64_t       m_size = 0;
+#ifdef _WIN32
+    void*          m_file    = nullptr;   ///< HANDLE
+    void*          m_mapping = nullptr;   ///< HANDLE
+#endif
+};
+
+/// @brief マップ済みメモリの一部を参照するビュー (コピーなし)
+/// @details ownerがマッピングを保持するため、ビューが生きている間dataは有効。
+struct MappedView
+{
+    const uint8_t* data = nullptr;              ///< 先頭ポインタ
+    size_t         size = 0;                    ///< バイト数
+    std::shared_ptr<const MappedFile> owner;    ///< マッピングの寿命管理
+
+    /// @brief ビューが有効か (サイズ0のエントリも有効)
+    bool IsValid() const { return owner != nullptr; }
+};
+
+} // namespace gxloader
@@ -16,6 +16,104 @@ static std::string ReadString(const uint8_t* stringData, uint32_t stringSize, ui
     return std::string(reinterpret_cast<const char*>(stringData + offset));
 }
 
+/// 量子化フラグ付きの頂点を1つfloat形式 (VertexSkinned) に展開する
+static void DecodeVertex(const uint8_t* src, const gxfmt::MeshChunk& mc, const gxfmt::VertexLayout& layout,
+                         gxfmt::VertexSkinned& dst)
+{
+    const uint32_t flags = mc.vertexFormatFlags;
+    dst = {};
+
+    if (layout.position != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_PositionQ16)
+        {
+            uint16_t q[4];
+            std::memcpy(q, src + layout.position, 8);
+            gxfmt::DequantizePosition(q, mc.aabbMin, mc.aabbMax, dst.position);
+        }
+        else
+        {
+            std::memcpy(dst.position, src + layout.position, 12);
+        }
+    }
+
+    if (layout.normal != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_NormalOct)
+        {
+            int16_t n[2];
+            std::memcpy(n, src + layout.normal, 4);
+            gxfmt::DecodeOctNormal(n, dst.normal);
+        }
+        else
+        {
+            std::memcpy(dst.normal, src + layout.normal, 12);
+        }
+    }
+
+    if (layout.uv0 != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_UV0Half)
+        {
+            uint16_t uv[2];
+            std::memcpy(uv, src + layout.uv0, 4);
+            dst.uv0[0] = gxfmt::HalfToFloat(uv[0]);
+            dst.uv0[1] = gxfmt::HalfToFloat(uv[1]);
+        }
+        else
+        {
+            std::memcpy(dst.uv0, src + layout.uv0, 8);
+        }
+    }
+
+    if (layout.tangent != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_TangentOct)
+        {
+            int16_t t[2];
+            std::memcpy(t, src + layout.tangent, 4);
+            gxfmt::DecodeOctTangent(t, dst.tangent);
+        }
+        else
+        {
+            std::memcpy(dst.tangent, src + layout.tangent, 16);
+        }
+    }
+
+    if (layout.joints != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_Joints8)
+        {
+            for (int j = 0; j < 4; ++j)
+                dst.joints[j] = src[layout.joints + j];
+        }
+        else
+        {
+            std::memcpy(dst.joints, src + layout.joints, 16);
+        }
+    }
+
+    if (layout.weights != gxfmt::k_NoVertexAttribute)
+    {
+        if (flags & gxfmt::VF_WeightsU8)
+        {
+            for (int j = 0; j < 4; ++j)
+                dst.weights[j] = src[layout.weights + j] / 255.0f;
+        }
+        else if (flags & gxfmt::VF_WeightsU16)
+        {
+            uint16_t w[4];
+            std::memcpy(w, src + layout.weights, 8);
+            for (int j = 0; j < 4; ++j)
+                dst.weights[j] = w[j] / 65535.0f;
+        }
+        else
+        {
+            std::memcpy(dst.weights, src + layout.weights, 16);
+        }
+    }
+}
+
 std::unique_ptr<LoadedModel> LoadGxmdFromMemory(const uint8_t* data, size_t size)
 {
     if (size < sizeof(gxfmt::FileHeader))
@@ -109,12 +207,33 @@ std::unique_ptr<LoadedModel> LoadGxmdFromMemory(const uint8_t* data, size_t size
 
         // Copy vertices
         const uint8_t* vSrc = vertexBase + mc.vertexOffset;
-        if (isSkinned)
-            std::memcpy(&model->skinnedVertices[globalVertexOffset], vSrc,
-                        mc.vertexCount * sizeof(gxfmt::VertexSkinned));
+        const uint32_t expectedFlags = isSkinned ? gxfmt::VF_Skinned : gxfmt::VF_Standard;
+        if (mc.vertexFormatFlags == expectedFlags)
+        {
+            if (isSkinned)
+                std::memcpy(&model->skinnedVertices[globalVertexOffset], vSrc,
+                            mc.vertexCount * sizeof(gxfmt::VertexSkinned));
+            else
+                std::memcpy(&model->standardVertices[globalVertexOffset], vSrc,
+                            mc.vertexCount * sizeof(gxfmt::VertexStandard));
+        }
         else
-            std::memcpy(&model->standardVertices[globalVertexOffset], vSrc,
-                        mc.vertexCount * sizeof(gxfmt::VertexStandard));
+        {
+            // 量子化頂点 (v3) はfloat形式に展開する
+            const gxfmt::VertexLayout layout = gxfmt::GetVertexLayout(mc.vertexFormatFlags);
+            if (layout.stride == 0 || layout.stride > mc.vertexStride)
+                return nullptr;
+            gxfmt::VertexSkinned decoded;
+            for (uint32_t v = 0; v < mc.vertexCount; ++v)
+            {
+                DecodeVertex(vSrc + static_cast<size_t>(v) * mc.vertexStride, mc, layout, decoded);
+                if (isSkinned)
+                    model->skinnedVertices[globalVertexOffset + v] = decoded;
+                else
+                    std::memcpy(&model->standardVertices[globalVertexOffset + v], &decoded,
+                                sizeof(gxfmt::VertexStandard));
+            }
+        }
 
         // インデックスのコピー: メッシュごとのフォーマット混在に対応
         const uint8_t* iSrc = indexBase + mc.indexOffset;
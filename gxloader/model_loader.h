@@ -70,6 +70,7 @@ struct LoadedAnimation
 
 /// @brief GXMDから読み込んだモデルデータ一式
 /// @details GPU非依存のCPUデータ。頂点はstandardVerticesかskinnedVerticesのどちらかが使われる。
+///          量子化頂点フォーマット (VF_PositionQ16等) のメッシュは読み込み時にfloat形式へ展開される。
 struct LoadedModel
 {
     // 頂点データ (どちらか一方が使われる)
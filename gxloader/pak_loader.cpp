@@ -2,125 +2,342 @@
 /// @brief GXPAKバンドルローダーの実装
 
 #include "pak_loader.h"
-#include <cstdio>
 #include <cstring>
+#include <algorithm>
 
-// LZ4 for decompression
+// LZ4 / Zstd for decompression (LZ4HCの出力はLZ4ブロックなのでLZ4で展開する)
 #include "lz4.h"
+#include "zstd.h"
 
 namespace gxloader
 {
 
-bool PakLoader::Open(const std::string& filePath)
+namespace
 {
-    FILE* f = fopen(filePath.c_str(), "rb");
-    if (!f) return false;
 
-    // Read header
+/// スレッドごとのZstd展開コンテキスト (展開ごとに作り直さない)
+ZSTD_DCtx* ThreadDCtx()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    return dctx.get();
+}
+
+} // namespace
+
+bool PakLoader::Open(const std::string& filePath, std::shared_ptr<const PakLoader> base)
+{
+    Close();
+
+    // ファイル全体を一度だけマップする (以降のReadはマップから直接読む)
+    std::shared_ptr<const MappedFile> file = MappedFile::Open(filePath);
+    if (!file || file->Size() < sizeof(gxfmt::GxpakHeader)) return false;
+
     gxfmt::GxpakHeader header{};
-    fread(&header, sizeof(header), 1, f);
+    memcpy(&header, file->Data(), sizeof(header));
 
-    if (header.magic != gxfmt::k_GxpakMagic)
-    {
-        fclose(f);
+    if (header.magic != gxfmt::k_GxpakMagic ||
+        (header.version != 1 && header.version != gxfmt::k_GxpakVersion))
         return false;
-    }
-
-    m_filePath = filePath;
-    m_entries.clear();
+    const bool legacy = header.version == 1;
 
     // TOCはファイル末尾に配置されている
-    fseek(f, 0, SEEK_END);
-    long fileSize = ftell(f);
-    (void)fileSize;
+    if (header.tocOffset > file->Size() || header.tocSize > file->Size() - header.tocOffset)
+        return false;
+    const uint8_t* toc = file->Data() + header.tocOffset;
+    const size_t tocSize = static_cast<size_t>(header.tocSize);
+    size_t pos = 0;
 
-    _fseeki64(f, static_cast<long long>(header.tocOffset), SEEK_SET);
+    // TOC先頭に辞書の位置とバンドルの識別子を持つ (v1には無い)
+    const uint8_t* dict = nullptr;
+    uint32_t dictSize = 0;
+    gxfmt::GxpakTocHeader tocHeader{};
+    if (!legacy)
+    {
+        if (tocSize < sizeof(tocHeader)) return false;
+        memcpy(&tocHeader, toc, sizeof(tocHeader));
+        pos = sizeof(tocHeader);
+
+        if (tocHeader.dictSize > 0)
+        {
+            if (tocHeader.dictSize > gxfmt::k_GxpakMaxDictSize ||
+                tocHeader.dictOffset > file->Size() || tocHeader.dictSize > file->Size() - tocHeader.dictOffset)
+                return false;
+            dict = file->Data() + tocHeader.dictOffset;
+            dictSize = tocHeader.dictSize;
+        }
+    }
+
+    // パッチは参照先のベースと一緒でなければ開けない
+    if (tocHeader.basePackId != 0 && (!base || base->GetPackId() != tocHeader.basePackId))
+        return false;
+    if (tocHeader.basePackId == 0)
+        base.reset();
+
+    // 固定フィールド: assetType(1) + codec(1) + flags(1) + level(1) + dataOffset(8) + sizes(4+4) + pathHash(8) + contentHash(8)
+    // (v1はハッシュを持たず、codecは圧縮フラグ、flags/levelはパディング)
+    const size_t fixedSize = legacy ? 20 : 36;
 
-    // TOCエントリを1つずつ読み込む (可変長シリアライズ)
+    m_entries.reserve(header.entryCount);
+    bool usesZstdDict = false;
     for (uint32_t i = 0; i < header.entryCount; ++i)
     {
-        // Read path length
         uint32_t pathLen = 0;
-        fread(&pathLen, 4, 1, f);
-
-        // Read path
-        std::vector<char> pathBuf(pathLen + 1, '\0');
-        fread(pathBuf.data(), 1, pathLen, f);
-
-        // Read fixed fields
-        gxfmt::GxpakAssetType assetType;
-        uint8_t compressed;
-        uint8_t pad[2];
-        uint64_t dataOffset;
-        uint32_t compressedSize;
-        uint32_t originalSize;
-
-        fread(&assetType, 1, 1, f);
-        fread(&compressed, 1, 1, f);
-        fread(pad, 1, 2, f);
-        fread(&dataOffset, 8, 1, f);
-        fread(&compressedSize, 4, 1, f);
-        fread(&originalSize, 4, 1, f);
+        if (pos + 4 > tocSize) return false;
+        memcpy(&pathLen, &toc[pos], 4);
+        pos += 4;
+        if (pathLen > tocSize - pos || tocSize - pos - pathLen < fixedSize) return false;
+        const char* path = reinterpret_cast<const char*>(&toc[pos]);
+        pos += pathLen;
 
         gxfmt::GxpakEntry entry{};
-        strncpy(entry.path, pathBuf.data(), sizeof(entry.path) - 1);
-        entry.assetType = assetType;
-        entry.compressed = (compressed != 0);
-        entry.dataOffset = dataOffset;
-        entry.compressedSize = compressedSize;
-        entry.originalSize = originalSize;
+        memcpy(entry.path, path, std::min<size_t>(pathLen, sizeof(entry.path) - 1));
+        entry.assetType = static_cast<gxfmt::GxpakAssetType>(toc[pos]);
+        entry.codec = static_cast<gxfmt::GxpakCodec>(toc[pos + 1]);
+        memcpy(&entry.dataOffset, &toc[pos + 4], 8);
+        memcpy(&entry.compressedSize, &toc[pos + 12], 4);
+        memcpy(&entry.originalSize, &toc[pos + 16], 4);
+        if (legacy)
+        {
+            entry.pathHash = gxfmt::HashPath(path, pathLen);
+        }
+        else
+        {
+            entry.flags = toc[pos + 2];
+            entry.level = toc[pos + 3];
+            memcpy(&entry.pathHash, &toc[pos + 20], 8);
+            memcpy(&entry.contentHash, &toc[pos + 28], 8);
+        }
+        pos += fixedSize;
+
+        // 読み込み時に範囲チェックを省けるよう、ここでデータ範囲とコーデックを検証する
+        // (ベース内のエントリはベースのファイル・辞書に対して検証する)
+        // ベースが付いていないパックのInBaseエントリは参照先がないので不正とする
+        const bool inBase = (entry.flags & gxfmt::k_GxpakEntryFlagInBase) != 0;
+        if (inBase && !base)
+        {
+            m_entries.clear();
+            return false;
+        }
+        const uint64_t dataSize = inBase ? base->m_file->Size() : file->Size();
+        const uint8_t* entryDict = inBase ? base->m_dict : dict;
+        const uint8_t codecCount = legacy ? 2 : gxfmt::k_GxpakCodecCount;
+        if (entry.dataOffset > dataSize || entry.compressedSize > dataSize - entry.dataOffset ||
+            static_cast<uint8_t>(entry.codec) >= codecCount ||
+            (gxfmt::GxpakCodecUsesDict(entry.codec) && !entryDict))
+        {
+            m_entries.clear();
+            return false;
+        }
+        usesZstdDict |= entry.codec == gxfmt::GxpakCodec::ZstdDict && !inBase;
 
         m_entries.push_back(entry);
     }
 
-    fclose(f);
+    // ZstdDictのエントリがあれば辞書を一度だけ索引する (展開ごとに辞書を解析しない)
+    if (usesZstdDict)
+    {
+        m_zstdDict.reset(ZSTD_createDDict(dict, dictSize), &ZSTD_freeDDict);
+        if (!m_zstdDict)
+        {
+            m_entries.clear();
+            return false;
+        }
+    }
+
+    m_file = std::move(file);
+    m_dict = dict;
+    m_dictSize = dictSize;
+    m_packId = tocHeader.packId;
+    m_base = std::move(base);
+    BuildIndex();
     return true;
 }
 
 void PakLoader::Close()
 {
     m_entries.clear();
-    m_filePath.clear();
+    m_slots.clear();
+    m_file.reset();
+    m_dict = nullptr;
+    m_dictSize = 0;
+    m_zstdDict.reset();
+    m_packId = 0;
+    m_base.reset();
+}
+
+void PakLoader::BuildIndex()
+{
+    size_t capacity = 16;
+    while (capacity < m_entries.size() * 2) capacity <<= 1;
+    m_slots.assign(capacity, Slot{ 0, k_EmptySlot });
+
+    const size_t mask = capacity - 1;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_entries.size()); ++i)
+    {
+        const uint64_t hash = m_entries[i].pathHash;
+        size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+        while (m_slots[slot].index != k_EmptySlot)
+            slot = (slot + 1) & mask;
+        m_slots[slot] = { hash, i };
+    }
+}
+
+const gxfmt::GxpakEntry* PakLoader::Find(uint64_t pathHash) const
+{
+    if (m_slots.empty()) return nullptr;
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(pathHash ^ (pathHash >> 32)) & mask;
+         m_slots[slot].index != k_EmptySlot; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot].hash == pathHash)
+            return &m_entries[m_slots[slot].index];
+    }
+    return nullptr;
+}
+
+const gxfmt::GxpakEntry* PakLoader::Find(const std::string& path) const
+{
+    if (m_slots.empty()) return nullptr;
+
+    // ハッシュ一致後にパスも照合する (v1バンドルではハッシュ衝突があり得る)
+    const uint64_t hash = gxfmt::HashPath(path.data(), path.size());
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+         m_slots[slot].index != k_EmptySlot; slot = (slot + 1) & mask)
+    {
+        const gxfmt::GxpakEntry& entry = m_entries[m_slots[slot].index];
+        if (m_slots[slot].hash == hash && path == entry.path)
+            return &entry;
+    }
+    return nullptr;
 }
 
 bool PakLoader::Contains(const std::string& path) const
 {
-    for (auto& e : m_entries)
-        if (path == e.path) return true;
-    return false;
+    return Find(path) != nullptr;
+}
+
+bool PakLoader::Contains(uint64_t pathHash) const
+{
+    return Find(pathHash) != nullptr;
 }
 
 std::vector<uint8_t> PakLoader::Read(const std::string& path) const
 {
-    for (auto& entry : m_entries)
+    return ReadEntry(Find(path));
+}
+
+std::vector<uint8_t> PakLoader::Read(uint64_t pathHash) const
+{
+    return ReadEntry(Find(pathHash));
+}
+
+MappedView PakLoader::ReadView(const std::string& path) const
+{
+    return ReadEntryView(Find(path));
+}
+
+MappedView PakLoader::ReadView(uint64_t pathHash) const
+{
+    return ReadEntryView(Find(pathHash));
+}
+
+bool PakLoader::ReadInto(const std::string& path, std::span<uint8_t> destination) const
+{
+    const gxfmt::GxpakEntry* entry = Find(path);
+    return entry && ReadEntryInto(*entry, destination);
+}
+
+bool PakLoader::ReadInto(uint64_t pathHash, std::span<uint8_t> destination) const
+{
+    const gxfmt::GxpakEntry* entry = Find(pathHash);
+    return entry && ReadEntryInto(*entry, destination);
+}
+
+void PakLoader::Prefetch(std::span<const gxfmt::GxpakEntry* const> entries) const
+{
+    if (!m_file) return;
+
+    // 共有されたデータは同じ範囲になるが、結合時にまとめられる
+    std::vector<MappedRange> ranges, baseRanges;
+    ranges.reserve(entries.size());
+    for (const gxfmt::GxpakEntry* entry : entries)
     {
-        if (path != entry.path) continue;
+        if (!entry) continue;
+        auto& target = (entry->flags & gxfmt::k_GxpakEntryFlagInBase) ? baseRanges : ranges;
+        target.push_back({ entry->dataOffset, entry->compressedSize });
+    }
+    m_file->Prefetch(std::move(ranges));
+    if (!baseRanges.empty())
+        m_base->m_file->Prefetch(std::move(baseRanges));
+}
 
-        FILE* f = fopen(m_filePath.c_str(), "rb");
-        if (!f) return {};
+const PakLoader& PakLoader::DataOwner(const gxfmt::GxpakEntry& entry) const
+{
+    return (entry.flags & gxfmt::k_GxpakEntryFlagInBase) ? *m_base : *this;
+}
 
-        _fseeki64(f, static_cast<long long>(entry.dataOffset), SEEK_SET);
+std::vector<uint8_t> PakLoader::ReadEntry(const gxfmt::GxpakEntry* entry) const
+{
+    if (!entry) return {};
 
-        std::vector<uint8_t> rawData(entry.compressedSize);
-        fread(rawData.data(), 1, entry.compressedSize, f);
-        fclose(f);
+    std::vector<uint8_t> data(entry->originalSize);
+    if (!ReadEntryInto(*entry, data)) return {};
+    return data;
+}
 
-        if (entry.compressed) // LZ4圧縮されたエントリを展開
-        {
-            std::vector<uint8_t> decompressed(entry.originalSize);
-            int result = LZ4_decompress_safe(
-                reinterpret_cast<const char*>(rawData.data()),
-                reinterpret_cast<char*>(decompressed.data()),
-                static_cast<int>(entry.compressedSize),
-                static_cast<int>(entry.originalSize));
-
-            if (result < 0) return {};
-            return decompressed;
-        }
+MappedView PakLoader::ReadEntryView(const gxfmt::GxpakEntry* entry) const
+{
+    if (!entry || entry->codec != gxfmt::GxpakCodec::None) return {};
 
-        return rawData;
+    const PakLoader& owner = DataOwner(*entry);
+    MappedView view;
+    view.data = owner.m_file->Data() + entry->dataOffset;
+    view.size = entry->originalSize;
+    view.owner = owner.m_file;
+    return view;
+}
+
+bool PakLoader::ReadEntryInto(const gxfmt::GxpakEntry& entry, std::span<uint8_t> destination) const
+{
+    if (destination.size() < entry.originalSize) return false;
+
+    const PakLoader& owner = DataOwner(entry);
+    const uint8_t* src = owner.m_file->Data() + entry.dataOffset;
+    if (entry.codec == gxfmt::GxpakCodec::LZ4 || entry.codec == gxfmt::GxpakCodec::LZ4HC) // マップから直接展開
+    {
+        int result = LZ4_decompress_safe(
+            reinterpret_cast<const char*>(src),
+            reinterpret_cast<char*>(destination.data()),
+            static_cast<int>(entry.compressedSize),
+            static_cast<int>(entry.originalSize));
+        return result == static_cast<int>(entry.originalSize);
     }
-    return {};
+    if (entry.codec == gxfmt::GxpakCodec::LZ4Dict) // バンドル共有辞書を参照して展開
+    {
+        int result = LZ4_decompress_safe_usingDict(
+            reinterpret_cast<const char*>(src),
+            reinterpret_cast<char*>(destination.data()),
+            static_cast<int>(entry.compressedSize),
+            static_cast<int>(entry.originalSize),
+            reinterpret_cast<const char*>(owner.m_dict),
+            static_cast<int>(owner.m_dictSize));
+        return result == static_cast<int>(entry.originalSize);
+    }
+    if (entry.codec == gxfmt::GxpakCodec::Zstd || entry.codec == gxfmt::GxpakCodec::ZstdDict)
+    {
+        size_t result = entry.codec == gxfmt::GxpakCodec::Zstd
+            ? ZSTD_decompressDCtx(ThreadDCtx(), destination.data(), entry.originalSize, src, entry.compressedSize)
+            : ZSTD_decompress_usingDDict(ThreadDCtx(), destination.data(), entry.originalSize,
+                                         src, entry.compressedSize, owner.m_zstdDict.get());
+        return result == entry.originalSize;
+    }
+
+    if (entry.compressedSize != entry.originalSize) return false;
+    if (entry.originalSize > 0)
+        memcpy(destination.data(), src, entry.originalSize);
+    return true;
 }
 
 std::vector<gxfmt::GxpakEntry> PakLoader::GetEntries() const
@@ -3,13 +3,21 @@
 /// @brief GXPAKバンドルランタイムローダー
 ///
 /// .gxpakアーカイブのTOCを読み込み、パス指定でエントリを取り出す。
-/// LZ4圧縮されたエントリは自動的に展開される。
+/// 圧縮されたエントリ (LZ4 / LZ4HC / Zstd と共有辞書付きの各版) は自動的に展開される。
+/// TOCはパスハッシュのオープンアドレス法テーブルで索引され、
+/// gxfmt::HashPath()で事前計算したハッシュでも検索できる。
+/// ファイルはOpen()時に一度だけメモリマップされ、以降の読み込みはマップから直接行う。
+/// パッチバンドルはベースバンドルのPakLoaderと一緒に開き、ベース内のデータはベースのマップから読む。
 
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <span>
 #include "gxpak.h"
+#include "mapped_file.h"
+
+struct ZSTD_DDict_s;
 
 namespace gxloader
 {
@@ -22,8 +30,9 @@ class PakLoader
 public:
     /// @brief GXPAKファイルを開いてTOCを読み込む
     /// @param filePath .gxpakファイルパス
-    /// @return 成功時true
-    bool Open(const std::string& filePath);
+    /// @param base パッチの場合はベースバンドル (GetPackId()がパッチの参照先と一致すること)
+    /// @return 成功時true。パッチをベースなし・別のベースで開いた場合はfalse
+    bool Open(const std::string& filePath, std::shared_ptr<const PakLoader> base = nullptr);
 
     /// @brief アーカイブを閉じてTOCを解放する
     void Close();
@@ -33,11 +42,61 @@ public:
     /// @return 存在すればtrue
     bool Contains(const std::string& path) const;
 
-    /// @brief 指定パスのエントリデータを読み込む (LZ4自動展開)
+    /// @brief 指定ハッシュのエントリが存在するか確認する
+    /// @param pathHash gxfmt::HashPath()で計算したパスハッシュ
+    /// @return 存在すればtrue
+    bool Contains(uint64_t pathHash) const;
+
+    /// @brief 指定パスのエントリを検索する
+    /// @param path バンドル内のパス
+    /// @return エントリへのポインタ。見つからない場合はnullptr
+    const gxfmt::GxpakEntry* Find(const std::string& path) const;
+
+    /// @brief 事前計算したパスハッシュでエントリを検索する (文字列比較なし)
+    /// @param pathHash gxfmt::HashPath()で計算したパスハッシュ
+    /// @return エントリへのポインタ。見つからない場合はnullptr
+    const gxfmt::GxpakEntry* Find(uint64_t pathHash) const;
+
+    /// @brief 指定パスのエントリデータを読み込む (圧縮エントリは自動展開)
     /// @param path バンドル内のパス
     /// @return エントリのバイトデータ。見つからない場合は空
     std::vector<uint8_t> Read(const std::string& path) const;
 
+    /// @brief 事前計算したパスハッシュでエントリデータを読み込む (圧縮エントリは自動展開)
+    /// @param pathHash gxfmt::HashPath()で計算したパスハッシュ
+    /// @return エントリのバイトデータ。見つからない場合は空
+    std::vector<uint8_t> Read(uint64_t pathHash) const;
+
+    /// @brief 非圧縮エントリをコピーせずにマップ上で参照する
+    /// @param path バンドル内のパス
+    /// @return マップ上のビュー。見つからない・圧縮エントリの場合は無効 (IsValid()==false)
+    MappedView ReadView(const std::string& path) const;
+
+    /// @brief 事前計算したパスハッシュで非圧縮エントリを参照する
+    MappedView ReadView(uint64_t pathHash) const;
+
+    /// @brief エントリを呼び出し側のバッファへ直接読み込む (中間バッファなし)
+    /// @details 圧縮エントリはマップから直接destinationへ展開する。
+    ///          必要なサイズはFind()->originalSizeで得られる。
+    /// @param path バンドル内のパス
+    /// @param destination 書き込み先 (originalSize以上)
+    /// @return 成功時true。見つからない・バッファ不足・展開失敗時false
+    bool ReadInto(const std::string& path, std::span<uint8_t> destination) const;
+
+    /// @brief 事前計算したパスハッシュでエントリをバッファへ読み込む
+    bool ReadInto(uint64_t pathHash, std::span<uint8_t> destination) const;
+
+    /// @brief 複数エントリのデータ領域の先読みをまとめて要求する
+    /// @details データ位置順に並べて近接する範囲を結合し、1回の要求でOSに渡す。
+    /// @param entries Find()で得たエントリ (nullptrは無視)
+    void Prefetch(std::span<const gxfmt::GxpakEntry* const> entries) const;
+
+    /// @brief バンドルの識別子を返す (パッチのベース照合用、v1は0)
+    uint64_t GetPackId() const { return m_packId; }
+
+    /// @brief パッチとして開いている場合true
+    bool IsPatch() const { return m_base != nullptr; }
+
     /// @brief 全エントリの一覧を返す
     /// @return エントリ配列のコピー
     std::vector<gxfmt::GxpakEntry> GetEntries() const;
@@ -48,8 +107,33 @@ public:
     std::vector<gxfmt::GxpakEntry> GetEntriesByType(gxfmt::GxpakAssetType type) const;
 
 private:
-    std::string m_filePath;                   ///< 開いているアーカイブのパス
+    /// @brief ハッシュテーブルのスロット (index == k_EmptySlot で空き)
+    struct Slot
+    {
+        uint64_t hash;
+        uint32_t index;
+    };
+    static constexpr uint32_t k_EmptySlot = 0xFFFFFFFF;
+
+    /// m_entriesからハッシュテーブルを構築する (負荷率50%以下、線形探索)
+    void BuildIndex();
+
+    /// エントリのデータを持つローダー (ベース内のエントリならベース)
+    const PakLoader& DataOwner(const gxfmt::GxpakEntry& entry) const;
+
+    /// エントリのデータをdestinationへ展開する
+    bool ReadEntryInto(const gxfmt::GxpakEntry& entry, std::span<uint8_t> destination) const;
+    std::vector<uint8_t> ReadEntry(const gxfmt::GxpakEntry* entry) const;
+    MappedView ReadEntryView(const gxfmt::GxpakEntry* entry) const;
+
+    std::shared_ptr<const MappedFile> m_file; ///< 開いているアーカイブのマッピング
     std::vector<gxfmt::GxpakEntry> m_entries; ///< メモリ上のTOC
+    std::vector<Slot> m_slots;                ///< パスハッシュ → エントリ番号 (サイズは2の冪)
+    const uint8_t* m_dict = nullptr;          ///< 共有圧縮辞書 (マップ内、なければnullptr)
+    uint32_t m_dictSize = 0;                  ///< 共有圧縮辞書のバイト数
+    std::shared_ptr<ZSTD_DDict_s> m_zstdDict; ///< ZstdDict用に索引した共有辞書 (使うエントリがなければnullptr)
+    uint64_t m_packId = 0;                    ///< GxpakTocHeader::packId
+    std::shared_ptr<const PakLoader> m_base;  ///< パッチのベース (パッチでなければnullptr)
 };
 
 } // namespace gxloader
@@ -2,12 +2,17 @@
 /// @brief gxpak CLIツール — GXPAKアセットバンドルの作成・展開・一覧表示
 ///
 /// 使い方:
-///   gxpak pack   -o output.gxpak -d input_dir/ [--compress]  ... パック
+///   gxpak pack   -o output.gxpak -d input_dir/ [--codec none|lz4|lz4hc|zstd|lz4dict|zstddict|auto] ... パック
+///                (--incremental / --base で前回の出力から変更のないエントリを再利用、
+///                 --patch-base でベースに無いデータだけを持つパッチを作成)
 ///   gxpak unpack -i input.gxpak  -d output_dir/              ... 展開
-///   gxpak list   -i input.gxpak                              ... 一覧表示
+///   gxpak list   -i input.gxpak                              ... 一覧表示 (展開速度の計測つき)
 
 #include "gxpak.h"
 #include "lz4.h"
+#include "lz4hc.h"
+#include "zstd.h"
+#include "zdict.h"
 
 #include <cstdio>
 #include <cstring>
@@ -16,6 +21,12 @@
 #include <vector>
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -24,10 +35,241 @@ static void PrintUsage()
 {
     printf("Usage:\n");
     printf("  gxpak pack   -o output.gxpak -d input_dir/ [--compress]\n");
-    printf("  gxpak unpack -i input.gxpak  -d output_dir/\n");
-    printf("  gxpak list   -i input.gxpak\n");
+    printf("               [--codec none|lz4|lz4hc|zstd|lz4dict|zstddict|auto]\n");
+    printf("               [--auto] [--level N] [--dict-size BYTES] [--bandwidth MBPS]\n");
+    printf("               [--threads N] [--incremental | --base old.gxpak] [--patch-base base.gxpak]\n");
+    printf("  gxpak unpack -i input.gxpak  -d output_dir/ [--patch-base base.gxpak]\n");
+    printf("  gxpak list   -i input.gxpak  [--patch-base base.gxpak]\n");
     printf("  gxpak add    -i input.gxpak  -f file -p \"path/in/pak\"\n");
     printf("  gxpak remove -i input.gxpak  -p \"path/in/pak\"\n");
+    printf("\n");
+    printf("  --compress      same as --codec lz4\n");
+    printf("  --auto          same as --codec auto: try every codec on samples and pick the one\n");
+    printf("                  per asset type with the lowest size / bandwidth + decode time\n");
+    printf("  --level N       lz4hc level (3-12, default 9) / zstd level (1-22, default 3)\n");
+    printf("  --dict-size N   shared dictionary size for lz4dict/zstddict, trained with ZDICT\n");
+    printf("                  (default 65536, max 262144; lz4dict uses the last 64KB)\n");
+    printf("  --bandwidth M   assumed read/download speed in MB/s for --auto (default 100)\n");
+    printf("  --threads N     read/compress worker threads (default: all cores)\n");
+    printf("  --base FILE     reuse stored data of unchanged entries (same content hash) from FILE\n");
+    printf("  --incremental   same as --base with the output file, if it exists\n");
+    printf("  --patch-base F  pack: write a patch that stores only data missing from F\n");
+    printf("                  list/unpack: base pack to read a patch's shared data from\n");
+}
+
+// ============================================================
+// コーデック
+// ============================================================
+
+static const char* CodecName(gxfmt::GxpakCodec codec)
+{
+    switch (codec) {
+    case gxfmt::GxpakCodec::None: return "none";
+    case gxfmt::GxpakCodec::LZ4: return "lz4";
+    case gxfmt::GxpakCodec::LZ4Dict: return "lz4dict";
+    case gxfmt::GxpakCodec::LZ4HC: return "lz4hc";
+    case gxfmt::GxpakCodec::Zstd: return "zstd";
+    case gxfmt::GxpakCodec::ZstdDict: return "zstddict";
+    default: return "unknown";
+    }
+}
+
+/// コーデック名に圧縮レベルを付けた表示用の文字列 ("zstd:19" など、レベルがなければ名前のみ)
+static std::string CodecLabel(gxfmt::GxpakCodec codec, int level)
+{
+    std::string label = CodecName(codec);
+    if (level > 0)
+        label += ":" + std::to_string(level);
+    return label;
+}
+
+/// スレッドごとのZstd圧縮コンテキスト (エントリごとに作り直さない)
+static ZSTD_CCtx* ThreadCCtx()
+{
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    return cctx.get();
+}
+
+/// スレッドごとのZstd展開コンテキスト
+static ZSTD_DCtx* ThreadDCtx()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    return dctx.get();
+}
+
+/// @brief エントリを圧縮する (共有辞書はコンストラクタで一度だけ読み込む。Compressは複数スレッドから呼べる)
+class Compressor
+{
+public:
+    /// @param level LZ4HC・Zstd系の圧縮レベル (0 = 各コーデックの既定値)
+    /// @param dict 共有辞書 (空なら辞書付きコーデックは使えない)
+    Compressor(int level, const std::vector<uint8_t>& dict)
+        : m_level(level)
+    {
+        if (dict.empty()) return;
+        m_dictStream = LZ4_createStream();
+        // 辞書は一度だけ時間をかけて索引し、各エントリではアタッチ・参照するだけにする
+        LZ4_loadDictSlow(m_dictStream, reinterpret_cast<const char*>(dict.data()), static_cast<int>(dict.size()));
+        m_zstdDict = ZSTD_createCDict(dict.data(), dict.size(), Level(gxfmt::GxpakCodec::ZstdDict));
+    }
+
+    ~Compressor()
+    {
+        if (m_dictStream) LZ4_freeStream(m_dictStream);
+        if (m_zstdDict) ZSTD_freeCDict(m_zstdDict);
+    }
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    bool HasDictionary() const { return m_dictStream != nullptr && m_zstdDict != nullptr; }
+
+    /// コーデックで使う圧縮レベル (レベルを持たないコーデックは0)
+    int Level(gxfmt::GxpakCodec codec) const
+    {
+        switch (codec)
+        {
+        case gxfmt::GxpakCodec::LZ4HC:
+            return m_level > 0 ? std::clamp(m_level, LZ4HC_CLEVEL_MIN, LZ4HC_CLEVEL_MAX) : LZ4HC_CLEVEL_DEFAULT;
+        case gxfmt::GxpakCodec::Zstd:
+        case gxfmt::GxpakCodec::ZstdDict:
+            return m_level > 0 ? std::clamp(m_level, 1, ZSTD_maxCLevel()) : ZSTD_CLEVEL_DEFAULT;
+        default:
+            return 0;
+        }
+    }
+
+    /// 圧縮結果を返す。小さくならなかった・失敗した場合は空
+    std::vector<uint8_t> Compress(gxfmt::GxpakCodec codec, const std::vector<uint8_t>& src) const
+    {
+        if (codec == gxfmt::GxpakCodec::None || src.size() <= 64) // 小さすぎると効果が薄い
+            return {};
+        if (gxfmt::GxpakCodecUsesDict(codec) && !HasDictionary())
+            return {};
+
+        std::vector<uint8_t> dst;
+        size_t size = 0;
+        if (codec == gxfmt::GxpakCodec::Zstd || codec == gxfmt::GxpakCodec::ZstdDict)
+        {
+            // バンドルの辞書は1つだけなので、フレームに辞書IDは書かない
+            ZSTD_CCtx* cctx = ThreadCCtx();
+            ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+            if (codec == gxfmt::GxpakCodec::ZstdDict)
+                ZSTD_CCtx_refCDict(cctx, m_zstdDict); // レベルは辞書の索引時に決めたもの
+            else
+                ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, Level(codec));
+
+            dst.resize(ZSTD_compressBound(src.size()));
+            const size_t result = ZSTD_compress2(cctx, dst.data(), dst.size(), src.data(), src.size());
+            size = ZSTD_isError(result) ? 0 : result;
+        }
+        else
+        {
+            const int srcSize = static_cast<int>(src.size());
+            dst.resize(LZ4_compressBound(srcSize));
+            const char* in = reinterpret_cast<const char*>(src.data());
+            char* out = reinterpret_cast<char*>(dst.data());
+            int result = 0;
+            if (codec == gxfmt::GxpakCodec::LZ4)
+            {
+                result = LZ4_compress_default(in, out, srcSize, static_cast<int>(dst.size()));
+            }
+            else if (codec == gxfmt::GxpakCodec::LZ4HC)
+            {
+                result = LZ4_compress_HC(in, out, srcSize, static_cast<int>(dst.size()), Level(codec));
+            }
+            else
+            {
+                // 辞書ストリームは読み取り専用で共有し、作業用ストリームは呼び出しごとに用意する
+                LZ4_stream_t work;
+                LZ4_initStream(&work, sizeof(work));
+                LZ4_attach_dictionary(&work, m_dictStream);
+                result = LZ4_compress_fast_continue(&work, in, out, srcSize, static_cast<int>(dst.size()), 1);
+            }
+            size = result > 0 ? static_cast<size_t>(result) : 0;
+        }
+
+        if (size == 0 || size >= src.size()) return {};
+        dst.resize(size);
+        return dst;
+    }
+
+private:
+    int m_level = 0;
+    LZ4_stream_t* m_dictStream = nullptr;
+    ZSTD_CDict* m_zstdDict = nullptr;
+};
+
+/// @brief エントリを展開する (ZstdDict用の辞書はコンストラクタで一度だけ索引する。Decodeは複数スレッドから呼べる)
+class Decoder
+{
+public:
+    /// @param dict 共有辞書 (Decoderより長く生存すること。空なら辞書付きエントリは展開できない)
+    explicit Decoder(const std::vector<uint8_t>& dict)
+        : m_dict(dict)
+    {
+        if (!dict.empty())
+            m_zstdDict = ZSTD_createDDict(dict.data(), dict.size());
+    }
+
+    ~Decoder()
+    {
+        if (m_zstdDict) ZSTD_freeDDict(m_zstdDict);
+    }
+
+    Decoder(const Decoder&) = delete;
+    Decoder& operator=(const Decoder&) = delete;
+
+    /// エントリを展開する (非圧縮はそのままコピー)
+    bool Decode(gxfmt::GxpakCodec codec, const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t dstSize) const
+    {
+        switch (codec)
+        {
+        case gxfmt::GxpakCodec::None:
+            if (srcSize != dstSize) return false;
+            memcpy(dst, src, srcSize);
+            return true;
+        case gxfmt::GxpakCodec::LZ4:
+        case gxfmt::GxpakCodec::LZ4HC: // LZ4HCの出力はLZ4ブロック
+            return LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                                       static_cast<int>(srcSize), static_cast<int>(dstSize)) == static_cast<int>(dstSize);
+        case gxfmt::GxpakCodec::LZ4Dict:
+            if (m_dict.empty()) return false;
+            return LZ4_decompress_safe_usingDict(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                                                 static_cast<int>(srcSize), static_cast<int>(dstSize),
+                                                 reinterpret_cast<const char*>(m_dict.data()),
+                                                 static_cast<int>(m_dict.size())) == static_cast<int>(dstSize);
+        case gxfmt::GxpakCodec::Zstd:
+            return ZSTD_decompressDCtx(ThreadDCtx(), dst, dstSize, src, srcSize) == dstSize;
+        case gxfmt::GxpakCodec::ZstdDict:
+            if (!m_zstdDict) return false;
+            return ZSTD_decompress_usingDDict(ThreadDCtx(), dst, dstSize, src, srcSize, m_zstdDict) == dstSize;
+        default:
+            return false;
+        }
+    }
+
+private:
+    const std::vector<uint8_t>& m_dict;
+    ZSTD_DDict* m_zstdDict = nullptr;
+};
+
+/// 展開にかかる時間 (秒) を計測する。小さいエントリは繰り返して平均を取る
+static double MeasureDecodeSeconds(const Decoder& decoder, gxfmt::GxpakCodec codec,
+                                   const std::vector<uint8_t>& packed, uint32_t originalSize)
+{
+    std::vector<uint8_t> out(originalSize);
+    const int repeat = static_cast<int>(std::clamp<uint64_t>((1u << 20) / (originalSize + 1), 1, 64));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i)
+    {
+        if (!decoder.Decode(codec, packed.data(), static_cast<uint32_t>(packed.size()), out.data(), originalSize))
+            return -1.0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeat;
 }
 
 // ============================================================
@@ -39,30 +281,38 @@ struct PakEntry
 {
     std::string path;                    ///< バンドル内の相対パス
     gxfmt::GxpakAssetType assetType;     ///< アセット種別
-    bool compressed;                      ///< LZ4圧縮済みか
-    uint64_t dataOffset;                  ///< データのファイル内オフセット
+    gxfmt::GxpakCodec codec;             ///< 圧縮コーデック
+    uint8_t flags = 0;                    ///< gxfmt::k_GxpakEntryFlagInBase
+    uint8_t level = 0;                    ///< 圧縮レベル (LZ4HC・Zstd系のみ)
+    uint64_t dataOffset;                  ///< データのファイル内オフセット (InBaseならベース内)
     uint32_t compressedSize;              ///< 圧縮後サイズ
     uint32_t originalSize;                ///< 元サイズ
+    uint64_t pathHash;                    ///< gxfmt::HashPath(path)
+    uint64_t contentHash = 0;             ///< gxfmt::HashContent(元データ) (v1は0)
 };
 
-/// TOCエントリ1つをファイルに書き出す (可変長パス + 固定フィールド)
-static void WriteTocEntry(FILE* f, const PakEntry& entry)
+/// TOCエントリ1つをバッファに追加する (可変長パス + 固定フィールド)
+static void AppendTocEntry(std::vector<uint8_t>& toc, const PakEntry& entry)
 {
+    auto append = [&toc](const void* data, size_t size) {
+        toc.insert(toc.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    };
     uint32_t pathLen = static_cast<uint32_t>(entry.path.size());
-    fwrite(&pathLen, 4, 1, f);
-    fwrite(entry.path.data(), 1, pathLen, f);
-    fwrite(&entry.assetType, 1, 1, f);
-    uint8_t comp = entry.compressed ? 1 : 0;
-    fwrite(&comp, 1, 1, f);
-    uint8_t pad[2] = {};
-    fwrite(pad, 1, 2, f);
-    fwrite(&entry.dataOffset, 8, 1, f);
-    fwrite(&entry.compressedSize, 4, 1, f);
-    fwrite(&entry.originalSize, 4, 1, f);
+    append(&pathLen, 4);
+    append(entry.path.data(), pathLen);
+    append(&entry.assetType, 1);
+    append(&entry.codec, 1);
+    append(&entry.flags, 1);
+    append(&entry.level, 1);
+    append(&entry.dataOffset, 8);
+    append(&entry.compressedSize, 4);
+    append(&entry.originalSize, 4);
+    append(&entry.pathHash, 8);
+    append(&entry.contentHash, 8);
 }
 
-/// ファイルからTOCエントリ1つを読み込む
-static PakEntry ReadTocEntry(FILE* f)
+/// ファイルからTOCエントリ1つを読み込む (バージョン1はハッシュをここで計算する)
+static PakEntry ReadTocEntry(FILE* f, uint32_t version)
 {
     PakEntry entry;
     uint32_t pathLen = 0;
@@ -72,124 +322,747 @@ static PakEntry ReadTocEntry(FILE* f)
     entry.path = pathBuf.data();
 
     fread(&entry.assetType, 1, 1, f);
-    uint8_t comp;
-    fread(&comp, 1, 1, f);
-    entry.compressed = (comp != 0);
-    uint8_t pad[2];
-    fread(pad, 1, 2, f);
+    fread(&entry.codec, 1, 1, f); // v1の圧縮フラグ(1)はLZ4と同じ値
+    uint8_t flagsAndLevel[2];
+    fread(flagsAndLevel, 1, 2, f);
     fread(&entry.dataOffset, 8, 1, f);
     fread(&entry.compressedSize, 4, 1, f);
     fread(&entry.originalSize, 4, 1, f);
+    if (version == 1)
+    {
+        // v1のflags/levelはパディング
+        entry.pathHash = gxfmt::HashPath(entry.path.data(), entry.path.size());
+        return entry;
+    }
+    entry.flags = flagsAndLevel[0];
+    entry.level = flagsAndLevel[1];
+    fread(&entry.pathHash, 8, 1, f);
+    fread(&entry.contentHash, 8, 1, f);
     return entry;
 }
 
+/// ヘッダを読んで検証し、TOCと辞書を読み込む
+static bool ReadPak(FILE* f, gxfmt::GxpakHeader& header, gxfmt::GxpakTocHeader& tocHeader,
+                    std::vector<PakEntry>& entries, std::vector<uint8_t>& dict)
+{
+    fread(&header, sizeof(header), 1, f);
+    if (header.magic != gxfmt::k_GxpakMagic)
+    {
+        fprintf(stderr, "Error: Not a GXPAK file\n");
+        return false;
+    }
+    if (header.version != 1 && header.version != gxfmt::k_GxpakVersion)
+    {
+        fprintf(stderr, "Error: Unsupported GXPAK version %u\n", header.version);
+        return false;
+    }
+
+    _fseeki64(f, static_cast<long long>(header.tocOffset), SEEK_SET);
+    tocHeader = {};
+    if (header.version != 1)
+        fread(&tocHeader, sizeof(tocHeader), 1, f);
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+        entries.push_back(ReadTocEntry(f, header.version));
+
+    if (tocHeader.dictSize > 0)
+    {
+        if (tocHeader.dictSize > gxfmt::k_GxpakMaxDictSize)
+        {
+            fprintf(stderr, "Error: Dictionary too large (%u bytes)\n", tocHeader.dictSize);
+            return false;
+        }
+        dict.resize(tocHeader.dictSize);
+        _fseeki64(f, static_cast<long long>(tocHeader.dictOffset), SEEK_SET);
+        fread(dict.data(), 1, dict.size(), f);
+    }
+    return true;
+}
+
+/// @brief 読み込み用に開いたバンドル (list/unpack、差分再パック・パッチのベース)
+struct PakReader
+{
+    FILE* file = nullptr;
+    gxfmt::GxpakHeader header{};
+    gxfmt::GxpakTocHeader tocHeader{};
+    std::vector<PakEntry> entries;
+    std::vector<uint8_t> dict;
+    std::unique_ptr<Decoder> decoder;                        ///< dictで展開するデコーダー (Open後に有効)
+    std::unordered_map<uint64_t, const PakEntry*> byContent; ///< 内容ハッシュ → このファイル内にデータを持つエントリ
+    std::mutex mutex;                                        ///< fileの読み込み (ワーカー間で共有)
+
+    PakReader() = default;
+    PakReader(const PakReader&) = delete;
+    PakReader& operator=(const PakReader&) = delete;
+    ~PakReader() { if (file) fclose(file); }
+
+    bool Open(const std::string& path)
+    {
+        file = fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            fprintf(stderr, "Error: Cannot open %s\n", path.c_str());
+            return false;
+        }
+        if (!ReadPak(file, header, tocHeader, entries, dict))
+            return false;
+        decoder = std::make_unique<Decoder>(dict);
+        for (const auto& entry : entries)
+        {
+            // v1のエントリ (内容ハッシュなし) とベース内のエントリは再利用の対象外
+            if (entry.contentHash != 0 && !(entry.flags & gxfmt::k_GxpakEntryFlagInBase))
+                byContent.emplace(entry.contentHash, &entry);
+        }
+        return true;
+    }
+
+    bool IsPatch() const { return tocHeader.basePackId != 0; }
+
+    /// 格納データ (圧縮されたまま) を読み込む
+    bool ReadStored(const PakEntry& entry, std::vector<uint8_t>& data)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        data.resize(entry.compressedSize);
+        _fseeki64(file, static_cast<long long>(entry.dataOffset), SEEK_SET);
+        return fread(data.data(), 1, data.size(), file) == data.size();
+    }
+};
+
+/// パッチのベースを開いて照合する (パッチでなければnullptrを返して成功)
+static bool OpenPatchBase(const PakReader& pak, const std::string& basePath, std::unique_ptr<PakReader>& base)
+{
+    if (!pak.IsPatch() || basePath.empty())
+        return true;
+    base = std::make_unique<PakReader>();
+    if (!base->Open(basePath))
+        return false;
+    if (base->tocHeader.packId != pak.tocHeader.basePackId)
+    {
+        fprintf(stderr, "Error: %s is not the base of this patch\n", basePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================
+// 辞書の学習
+// ============================================================
+
+/// @brief 小さなファイル群からZDICTで共有辞書を学習する
+/// @details 結果はZstd形式の辞書 (エントロピー表 + 内容)。内容部分は辞書の末尾にあり、
+///          有用な区間ほど末尾の近くに置かれるため、LZ4Dictは辞書全体を直前のデータとしてそのまま参照できる。
+/// @return 辞書。学習できなかった場合は空
+static std::vector<uint8_t> TrainDictionary(const std::vector<std::vector<uint8_t>>& samples, size_t dictSize)
+{
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> sampleSizes;
+    for (const auto& sample : samples)
+    {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sampleSizes.push_back(sample.size());
+    }
+
+    std::vector<uint8_t> dict(dictSize);
+    const size_t size = ZDICT_trainFromBuffer(dict.data(), dict.size(), buffer.data(), sampleSizes.data(),
+                                              static_cast<unsigned>(sampleSizes.size()));
+    if (ZDICT_isError(size))
+    {
+        printf("  (dictionary training failed: %s)\n", ZDICT_getErrorName(size));
+        return {};
+    }
+    dict.resize(size);
+    return dict;
+}
+
 // ============================================================
 // packコマンド: ディレクトリ内のファイルをGXPAKにまとめる
 // ============================================================
 
-static int CmdPack(const std::string& outputPath, const std::string& inputDir, bool compress)
+/// @brief packコマンドの設定
+struct PackOptions
 {
-    std::vector<std::pair<std::string, fs::path>> files; // (バンドル内相対パス, ディスクパス)
+    std::string codec = "none";      ///< none / lz4 / lz4hc / zstd / lz4dict / zstddict / auto
+    int level = 0;                   ///< LZ4HC・Zstd系の圧縮レベル (0 = 各コーデックの既定値)
+    size_t dictSize = 64 * 1024;     ///< 共有辞書のサイズ
+    double bandwidthMBps = 100.0;    ///< --autoで仮定する読み込み速度
+    uint32_t threads = 0;            ///< 読み込み・圧縮スレッド数 (0 = 論理コア数)
+    std::string basePath;            ///< 差分再パックの元 (空なら無効)
+    bool incremental = false;        ///< 出力先の既存ファイルを差分再パックの元にする
+    std::string patchBasePath;       ///< パッチのベース (空ならパッチを作らない)
+};
+
+/// 辞書学習に使うファイルの最大サイズ (これより大きいファイルは辞書の恩恵が小さい)
+static constexpr size_t k_DictSampleMaxSize = 32 * 1024;
+
+/// 辞書を学習するのに必要な最小サンプル数
+static constexpr size_t k_DictMinSamples = 8;
+
+/// 辞書学習・--autoの評価に読み込むサンプルの合計サイズの上限 (全ファイルは読まない)
+static constexpr uint64_t k_SampleBudget = 32ull * 1024 * 1024;
+
+/// 書き出し待ちのデータ量の上限 (これを超えるとワーカーは次のファイルを取らない)
+static constexpr uint64_t k_MaxPendingBytes = 256ull * 1024 * 1024;
+
+/// @brief 入力ファイル (内容はパイプラインのワーカーが読み込む)
+struct SourceFile
+{
+    std::string relPath;
+    fs::path diskPath;
+    uint64_t size = 0;
+    gxfmt::GxpakAssetType assetType;
+};
+
+/// ファイル全体を読み込む
+static bool ReadWholeFile(const fs::path& path, std::vector<uint8_t>& data)
+{
+    FILE* f = fopen(path.string().c_str(), "rb");
+    if (!f) return false;
+    _fseeki64(f, 0, SEEK_END);
+    long long size = _ftelli64(f);
+    _fseeki64(f, 0, SEEK_SET);
+    data.resize(static_cast<size_t>(size));
+    const bool ok = fread(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return ok;
+}
+
+/// 候補から合計がbudgetに収まるよう等間隔にファイルを選んで読み込む
+static std::vector<std::vector<uint8_t>> ReadSamples(const std::vector<const SourceFile*>& candidates, uint64_t budget)
+{
+    uint64_t total = 0;
+    for (const auto* src : candidates) total += src->size;
+    const size_t step = total > budget ? static_cast<size_t>((total + budget - 1) / budget) : 1;
+
+    std::vector<std::vector<uint8_t>> samples;
+    uint64_t used = 0;
+    for (size_t i = 0; i < candidates.size() && used < budget; i += step)
+    {
+        std::vector<uint8_t> data;
+        if (!ReadWholeFile(candidates[i]->diskPath, data)) continue;
+        used += data.size();
+        samples.push_back(std::move(data));
+    }
+    return samples;
+}
+
+static const char* AssetTypeName(gxfmt::GxpakAssetType type)
+{
+    switch (type) {
+    case gxfmt::GxpakAssetType::Model: return "Model";
+    case gxfmt::GxpakAssetType::Animation: return "Anim";
+    case gxfmt::GxpakAssetType::Texture: return "Tex";
+    default: return "Other";
+    }
+}
+
+/// --auto: アセット種別ごとに、推定ロード時間 (サイズ/帯域 + 展開時間) が最小のコーデックを選ぶ
+/// (種別ごとにサンプルを読み込んで全コーデックで試し圧縮し、展開時間を実測する。
+///  帯域が狭いほど圧縮率の高いZstd系が、広いほど展開の速いLZ4系が選ばれやすい)
+static std::unordered_map<gxfmt::GxpakAssetType, gxfmt::GxpakCodec> SelectCodecsAuto(
+    const std::vector<SourceFile>& sources, const Compressor& compressor,
+    const Decoder& decoder, double bandwidthMBps)
+{
+    const gxfmt::GxpakAssetType types[] = {
+        gxfmt::GxpakAssetType::Model, gxfmt::GxpakAssetType::Animation,
+        gxfmt::GxpakAssetType::Texture, gxfmt::GxpakAssetType::Other,
+    };
+    std::vector<gxfmt::GxpakCodec> candidates = {
+        gxfmt::GxpakCodec::None, gxfmt::GxpakCodec::LZ4, gxfmt::GxpakCodec::LZ4HC, gxfmt::GxpakCodec::Zstd,
+    };
+    if (compressor.HasDictionary())
+    {
+        candidates.push_back(gxfmt::GxpakCodec::LZ4Dict);
+        candidates.push_back(gxfmt::GxpakCodec::ZstdDict);
+    }
+
+    std::unordered_map<gxfmt::GxpakAssetType, gxfmt::GxpakCodec> selected;
+    const double bytesPerSecond = bandwidthMBps * 1024.0 * 1024.0;
+    for (gxfmt::GxpakAssetType type : types)
+    {
+        std::vector<const SourceFile*> group;
+        for (const auto& src : sources)
+        {
+            if (src.assetType == type)
+                group.push_back(&src);
+        }
+        if (group.empty()) continue;
+
+        const std::vector<std::vector<uint8_t>> samples = ReadSamples(group, k_SampleBudget);
+        uint64_t originalBytes = 0;
+        for (const auto& sample : samples) originalBytes += sample.size();
+
+        gxfmt::GxpakCodec best = gxfmt::GxpakCodec::None;
+        double bestCost = 0.0;
+        for (gxfmt::GxpakCodec codec : candidates)
+        {
+            uint64_t bytes = 0;
+            double decodeSeconds = 0.0;
+            for (const auto& sample : samples)
+            {
+                std::vector<uint8_t> packed = compressor.Compress(codec, sample);
+                if (packed.empty())
+                {
+                    bytes += sample.size(); // 圧縮できないファイルは非圧縮で格納される
+                    continue;
+                }
+                bytes += packed.size();
+                decodeSeconds += MeasureDecodeSeconds(decoder, codec, packed, static_cast<uint32_t>(sample.size()));
+            }
+
+            const double cost = bytes / bytesPerSecond + decodeSeconds;
+            printf("  [auto] %-6s %-11s %llu -> %llu bytes (%zu of %zu files), est. %.2f ms\n",
+                   AssetTypeName(type), CodecLabel(codec, compressor.Level(codec)).c_str(),
+                   static_cast<unsigned long long>(originalBytes),
+                   static_cast<unsigned long long>(bytes), samples.size(), group.size(), cost * 1000.0);
+            if (codec == candidates.front() || cost < bestCost)
+            {
+                best = codec;
+                bestCost = cost;
+            }
+        }
+        selected[type] = best;
+    }
+    return selected;
+}
+
+/// @brief ワーカーが作る書き出し単位
+struct PackedBlock
+{
+    std::vector<uint8_t> data;       ///< 格納データ
+    gxfmt::GxpakCodec codec = gxfmt::GxpakCodec::None;
+    uint8_t level = 0;
+    uint32_t originalSize = 0;
+    uint64_t contentHash = 0;
+    bool reused = false;
+    bool shared = false;                 ///< 既存のデータ (パッチのベース・書き出し済み) を参照する
+};
+
+static int CmdPack(const std::string& outputPath, const std::string& inputDir, const PackOptions& options)
+{
+    std::vector<SourceFile> sources;
 
     for (auto& entry : fs::recursive_directory_iterator(inputDir))
     {
         if (!entry.is_regular_file()) continue;
         fs::path rel = fs::relative(entry.path(), inputDir);
-        std::string relStr = rel.generic_string();
-        files.push_back({relStr, entry.path()});
+        SourceFile source;
+        source.relPath = rel.generic_string();
+        source.diskPath = entry.path();
+        source.size = entry.file_size();
+        source.assetType = gxfmt::DetectAssetType(source.relPath.c_str());
+        sources.push_back(std::move(source));
     }
 
-    if (files.empty())
+    if (sources.empty())
     {
         fprintf(stderr, "Error: No files found in %s\n", inputDir.c_str());
         return 1;
     }
 
-    std::sort(files.begin(), files.end());
+    std::sort(sources.begin(), sources.end(),
+              [](const SourceFile& a, const SourceFile& b) { return a.relPath < b.relPath; });
+
+    // パスハッシュの衝突を検出する (ランタイムはハッシュのみでエントリを引けるため)
+    std::vector<std::pair<uint64_t, size_t>> hashes;
+    hashes.reserve(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i)
+        hashes.push_back({gxfmt::HashPath(sources[i].relPath.data(), sources[i].relPath.size()), i});
+    std::sort(hashes.begin(), hashes.end());
+    for (size_t i = 1; i < hashes.size(); ++i)
+    {
+        if (hashes[i].first == hashes[i - 1].first)
+        {
+            fprintf(stderr, "Error: Path hash collision: %s / %s\n",
+                    sources[hashes[i - 1].second].relPath.c_str(), sources[hashes[i].second].relPath.c_str());
+            return 1;
+        }
+    }
+
+    // 差分再パックの元を開く
+    std::unique_ptr<PakReader> base;
+    const std::string basePath = options.incremental ? outputPath : options.basePath;
+    if (!basePath.empty() && fs::exists(basePath))
+    {
+        base = std::make_unique<PakReader>();
+        if (!base->Open(basePath))
+            return 1;
+        printf("  Base: %s (%zu entries)\n", basePath.c_str(), base->entries.size());
+    }
+
+    // パッチのベースを開く (ベースにある内容はデータを持たずにベースを参照する)
+    std::unique_ptr<PakReader> patchBase;
+    if (!options.patchBasePath.empty())
+    {
+        patchBase = std::make_unique<PakReader>();
+        if (!patchBase->Open(options.patchBasePath))
+            return 1;
+        if (patchBase->tocHeader.packId == 0 || patchBase->IsPatch())
+        {
+            fprintf(stderr, "Error: %s cannot be a patch base (pack it with version %u, not as a patch)\n",
+                    options.patchBasePath.c_str(), gxfmt::k_GxpakVersion);
+            return 1;
+        }
+        printf("  Patch base: %s (%zu entries)\n", options.patchBasePath.c_str(), patchBase->entries.size());
+    }
+
+    // 書き出したデータ: 内容ハッシュ → 最初にそのデータを書いたエントリ (重複排除用、パイプラインのmutexで保護)
+    struct WrittenData
+    {
+        size_t entryIndex;
+        uint32_t originalSize;
+    };
+    std::mutex mutex;
+    std::unordered_map<uint64_t, WrittenData> writtenByContent;
+
+    // 共有辞書: 元バンドルの辞書があれば引き継ぎ (辞書付きエントリを再利用できるように)、なければ学習する
+    std::vector<uint8_t> dict;
+    bool dictFromBase = false;
+    if (options.codec == "lz4dict" || options.codec == "zstddict" || options.codec == "auto")
+    {
+        if (base && !base->dict.empty())
+        {
+            dict = base->dict;
+            dictFromBase = true;
+            printf("  Dictionary: %zu bytes from base\n", dict.size());
+        }
+        else
+        {
+            std::vector<const SourceFile*> candidates;
+            for (const auto& src : sources)
+            {
+                if (src.size > 0 && src.size <= k_DictSampleMaxSize)
+                    candidates.push_back(&src);
+            }
+            const std::vector<std::vector<uint8_t>> samples = ReadSamples(candidates, k_SampleBudget);
+            if (samples.size() >= k_DictMinSamples)
+                dict = TrainDictionary(samples, options.dictSize);
+            else
+                printf("  (not enough small files to train a dictionary)\n");
+            if (!dict.empty())
+                printf("  Dictionary: %zu bytes from %zu samples\n", dict.size(), samples.size());
+        }
+    }
+
+    // 各ファイルに試すコーデックを決める
+    const Compressor compressor(options.level, dict);
+    const Decoder decoder(dict);
+    std::unordered_map<gxfmt::GxpakAssetType, gxfmt::GxpakCodec> codecByType;
+    gxfmt::GxpakCodec fixedCodec = gxfmt::GxpakCodec::None;
+    if (options.codec == "auto")
+        codecByType = SelectCodecsAuto(sources, compressor, decoder, options.bandwidthMBps);
+    else if (options.codec == "lz4")
+        fixedCodec = gxfmt::GxpakCodec::LZ4;
+    else if (options.codec == "lz4hc")
+        fixedCodec = gxfmt::GxpakCodec::LZ4HC;
+    else if (options.codec == "zstd")
+        fixedCodec = gxfmt::GxpakCodec::Zstd;
+    else if (options.codec == "lz4dict")
+        fixedCodec = compressor.HasDictionary() ? gxfmt::GxpakCodec::LZ4Dict : gxfmt::GxpakCodec::LZ4;
+    else if (options.codec == "zstddict")
+        fixedCodec = compressor.HasDictionary() ? gxfmt::GxpakCodec::ZstdDict : gxfmt::GxpakCodec::Zstd;
+    auto codecFor = [&](const SourceFile& src) {
+        auto it = codecByType.find(src.assetType);
+        return it != codecByType.end() ? it->second : fixedCodec;
+    };
+
+    // ワーカー: 読み込み → 内容ハッシュ → 元バンドルの格納データを再利用 or 圧縮
+    auto buildBlock = [&](const SourceFile& src, PackedBlock& block) -> bool {
+        std::vector<uint8_t> data;
+        if (!ReadWholeFile(src.diskPath, data))
+        {
+            fprintf(stderr, "Error: Cannot read %s\n", src.diskPath.string().c_str());
+            return false;
+        }
+        if (data.size() > 0xFFFFFFFFull)
+        {
+            fprintf(stderr, "Error: File too large (4GB or more): %s\n", src.relPath.c_str());
+            return false;
+        }
+        block.originalSize = static_cast<uint32_t>(data.size());
+        block.contentHash = gxfmt::HashContent(data.data(), data.size());
 
-    FILE* f = fopen(outputPath.c_str(), "wb");
-    if (!f) { fprintf(stderr, "Error: Cannot open %s\n", outputPath.c_str()); return 1; }
+        // パッチのベースまたは書き出し済みのデータと同じ内容なら圧縮しない (書き出し時に参照を張る)
+        if (patchBase)
+        {
+            auto it = patchBase->byContent.find(block.contentHash);
+            if (it != patchBase->byContent.end() && it->second->originalSize == data.size())
+            {
+                block.shared = true;
+                return true;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = writtenByContent.find(block.contentHash);
+            if (it != writtenByContent.end() && it->second.originalSize == data.size())
+            {
+                block.shared = true;
+                return true;
+            }
+        }
+
+        const gxfmt::GxpakCodec codec = codecFor(src);
+        if (base)
+        {
+            // 同じコーデックで格納されていたものだけを使う (圧縮レベルは比較しない)。非圧縮で格納されていたものは
+            // 圧縮を試していない可能性があるため、圧縮する設定なら作り直す
+            auto it = base->byContent.find(block.contentHash);
+            if (it != base->byContent.end() && it->second->originalSize == data.size() &&
+                it->second->codec == codec &&
+                (!gxfmt::GxpakCodecUsesDict(codec) || dictFromBase) &&
+                base->ReadStored(*it->second, block.data))
+            {
+                block.codec = codec;
+                block.level = it->second->level;
+                block.reused = true;
+                return true;
+            }
+        }
+
+        block.data = compressor.Compress(codec, data);
+        block.codec = block.data.empty() ? gxfmt::GxpakCodec::None : codec; // 小さくならなければ非圧縮
+        block.level = static_cast<uint8_t>(compressor.Level(block.codec));
+        if (block.data.empty())
+            block.data = std::move(data);
+        return true;
+    };
 
-    // 仮ヘッダ書き出し (tocOffset/tocSizeは後で上書き)
+    // 同じ場所へ出力する場合に元バンドルを壊さないよう、一時ファイルに書いてから置き換える
+    const std::string tempPath = outputPath + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) { fprintf(stderr, "Error: Cannot open %s\n", tempPath.c_str()); return 1; }
+
+    // 仮ヘッダ書き出し (flags/tocOffset/tocSizeは後で上書き)
     gxfmt::GxpakHeader header{};
     header.magic = gxfmt::k_GxpakMagic;
     header.version = gxfmt::k_GxpakVersion;
-    header.entryCount = static_cast<uint32_t>(files.size());
-    header.flags = compress ? 1 : 0;
+    header.entryCount = static_cast<uint32_t>(sources.size());
     fwrite(&header, sizeof(header), 1, f);
 
-    // データエントリを書き出し (LZ4圧縮で小さくなる場合のみ圧縮)
-    std::vector<PakEntry> entries;
-    uint64_t dataStart = sizeof(gxfmt::GxpakHeader);
-
-    for (auto& [relPath, fullPath] : files)
+    // 辞書はヘッダの直後に置く
+    gxfmt::GxpakTocHeader tocHeader{};
+    if (!dict.empty())
     {
-        // Read source file
-        FILE* src = fopen(fullPath.string().c_str(), "rb");
-        if (!src) continue;
-
-        fseek(src, 0, SEEK_END);
-        long srcSize = ftell(src);
-        fseek(src, 0, SEEK_SET);
+        tocHeader.dictOffset = static_cast<uint64_t>(_ftelli64(f));
+        tocHeader.dictSize = static_cast<uint32_t>(dict.size());
+        fwrite(dict.data(), 1, dict.size(), f);
+    }
 
-        std::vector<uint8_t> srcData(srcSize);
-        fread(srcData.data(), 1, srcSize, src);
-        fclose(src);
+    // ワーカーが読み込み・圧縮し、このスレッドがパス順に書き出す。
+    // ワーカーは書き出し待ちが上限を超えない範囲で先のファイルを取る
+    const size_t fileCount = sources.size();
+    uint32_t threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<uint32_t>(std::min<size_t>(threadCount, fileCount));
+    const size_t maxAhead = static_cast<size_t>(threadCount) * 4;
 
-        PakEntry entry;
-        entry.path = relPath;
-        entry.assetType = gxfmt::DetectAssetType(relPath.c_str());
-        entry.originalSize = static_cast<uint32_t>(srcSize);
-        entry.dataOffset = static_cast<uint64_t>(ftell(f));
+    std::condition_variable cv;
+    std::vector<PackedBlock> blocks(fileCount);
+    std::vector<uint8_t> ready(fileCount, 0);
+    size_t nextFile = 0;
+    size_t writtenCount = 0;
+    uint64_t pendingBytes = 0;
+    bool failed = false;
 
-        if (compress && srcSize > 64)
+    auto worker = [&]() {
+        for (;;)
         {
-            int maxDst = LZ4_compressBound(static_cast<int>(srcSize));
-            std::vector<uint8_t> compData(maxDst);
-            int compSize = LZ4_compress_default(
-                reinterpret_cast<const char*>(srcData.data()),
-                reinterpret_cast<char*>(compData.data()),
-                static_cast<int>(srcSize), maxDst);
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() {
+                    return failed || nextFile >= fileCount ||
+                           (nextFile - writtenCount < maxAhead &&
+                            (pendingBytes == 0 || pendingBytes + sources[nextFile].size <= k_MaxPendingBytes));
+                });
+                if (failed || nextFile >= fileCount) return;
+                index = nextFile++;
+                pendingBytes += sources[index].size;
+            }
 
-            if (compSize > 0 && compSize < static_cast<int>(srcSize))
+            PackedBlock block;
+            const bool ok = buildBlock(sources[index], block);
             {
-                entry.compressed = true;
-                entry.compressedSize = static_cast<uint32_t>(compSize);
-                fwrite(compData.data(), 1, compSize, f);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok)
+                {
+                    blocks[index] = std::move(block);
+                    ready[index] = 1;
+                }
+                else
+                {
+                    failed = true;
+                }
             }
-            else
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threadCount; ++t)
+        workers.emplace_back(worker);
+
+    // データエントリを書き出し
+    std::vector<PakEntry> entries;
+    entries.reserve(fileCount);
+    uint64_t codecBytes[gxfmt::k_GxpakCodecCount] = {};
+    uint32_t codecCounts[gxfmt::k_GxpakCodecCount] = {};
+    uint32_t reusedCount = 0;
+    uint32_t dedupCount = 0, inBaseCount = 0;
+    uint64_t dedupBytes = 0, inBaseBytes = 0;
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        PackedBlock block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return failed || ready[i]; });
+            if (failed) break;
+            block = std::move(blocks[i]);
+        }
+
+        PakEntry entry;
+        entry.path = sources[i].relPath;
+        entry.pathHash = gxfmt::HashPath(entry.path.data(), entry.path.size());
+        entry.contentHash = block.contentHash;
+        entry.assetType = sources[i].assetType;
+        entry.originalSize = block.originalSize;
+
+        // 同じ内容のデータが既にあればそれを指す (パッチのベースを優先)
+        const PakEntry* sharedEntry = nullptr;
+        if (patchBase)
+        {
+            auto it = patchBase->byContent.find(block.contentHash);
+            if (it != patchBase->byContent.end() && it->second->originalSize == block.originalSize)
+                sharedEntry = it->second;
+        }
+        bool newData = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = writtenByContent.find(block.contentHash);
+            if (!sharedEntry && it != writtenByContent.end() && it->second.originalSize == block.originalSize)
+                sharedEntry = &entries[it->second.entryIndex];
+            else if (!sharedEntry && it == writtenByContent.end())
+                newData = true;
+        }
+
+        if (sharedEntry)
+        {
+            const bool inBase = patchBase && sharedEntry >= patchBase->entries.data() &&
+                                sharedEntry < patchBase->entries.data() + patchBase->entries.size();
+            entry.codec = sharedEntry->codec;
+            entry.level = sharedEntry->level;
+            entry.dataOffset = sharedEntry->dataOffset;
+            entry.compressedSize = sharedEntry->compressedSize;
+            entry.flags = inBase ? gxfmt::k_GxpakEntryFlagInBase : 0;
+            (inBase ? inBaseCount : dedupCount) += 1;
+            (inBase ? inBaseBytes : dedupBytes) += sharedEntry->compressedSize;
+        }
+        else if (block.shared)
+        {
+            // ワーカーが参照できると判断したデータは必ず書き出し済み
+            fprintf(stderr, "Error: Shared data not found for %s\n", entry.path.c_str());
             {
-                entry.compressed = false;
-                entry.compressedSize = entry.originalSize;
-                fwrite(srcData.data(), 1, srcSize, f);
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
             }
+            cv.notify_all();
+            break;
         }
         else
         {
-            entry.compressed = false;
-            entry.compressedSize = entry.originalSize;
-            fwrite(srcData.data(), 1, srcSize, f);
-        }
+            entry.codec = block.codec;
+            entry.level = block.level;
+            entry.dataOffset = static_cast<uint64_t>(_ftelli64(f));
+            entry.compressedSize = static_cast<uint32_t>(block.data.size());
+            fwrite(block.data.data(), 1, block.data.size(), f);
 
+            codecBytes[static_cast<int>(block.codec)] += block.data.size();
+            ++codecCounts[static_cast<int>(block.codec)];
+            if (block.reused) ++reusedCount;
+        }
         entries.push_back(entry);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (newData)
+                writtenByContent.emplace(block.contentHash, WrittenData{ entries.size() - 1, block.originalSize });
+            writtenCount = i + 1;
+            pendingBytes -= sources[i].size;
+        }
+        cv.notify_all();
+    }
+
+    for (auto& t : workers)
+        t.join();
+
+    if (failed)
+    {
+        fclose(f);
+        fs::remove(tempPath);
+        return 1;
     }
 
-    // TOCをファイル末尾に書き出す
-    uint64_t tocOffset = static_cast<uint64_t>(ftell(f));
+    // 辞書を使うエントリがなければ辞書は参照しない (領域は残るが読み込まれない)
+    bool usesDict = false, anyCompressed = false;
+    for (const auto& e : entries)
+    {
+        if (e.flags & gxfmt::k_GxpakEntryFlagInBase) continue;
+        usesDict |= gxfmt::GxpakCodecUsesDict(e.codec);
+        anyCompressed |= e.codec != gxfmt::GxpakCodec::None;
+    }
+    if (!usesDict)
+        tocHeader = {};
+
+    // TOCを組み立て、識別子 (TOCと辞書の内容ハッシュ) を付けてファイル末尾に書き出す
+    std::vector<uint8_t> tocEntries;
     for (auto& e : entries)
-        WriteTocEntry(f, e);
-    uint64_t tocSize = static_cast<uint64_t>(ftell(f)) - tocOffset;
+        AppendTocEntry(tocEntries, e);
+    std::vector<uint8_t> idSource = tocEntries;
+    if (usesDict)
+        idSource.insert(idSource.end(), dict.begin(), dict.end());
+    tocHeader.packId = gxfmt::HashContent(idSource.data(), idSource.size());
+    if (tocHeader.packId == 0) tocHeader.packId = 1; // 0は「識別子なし」
+    tocHeader.basePackId = patchBase ? patchBase->tocHeader.packId : 0;
+
+    uint64_t tocOffset = static_cast<uint64_t>(_ftelli64(f));
+    fwrite(&tocHeader, sizeof(tocHeader), 1, f);
+    fwrite(tocEntries.data(), 1, tocEntries.size(), f);
+    uint64_t tocSize = static_cast<uint64_t>(_ftelli64(f)) - tocOffset;
 
-    // ヘッダを更新 (TOCオフセット/サイズを確定値で上書き)
+    // ヘッダを更新 (フラグ・TOCオフセット/サイズを確定値で上書き)
+    header.flags = (anyCompressed ? gxfmt::k_GxpakFlagCompressed : 0) |
+                   (usesDict ? gxfmt::k_GxpakFlagDictionary : 0) |
+                   (patchBase ? gxfmt::k_GxpakFlagPatch : 0);
     header.tocOffset = tocOffset;
     header.tocSize = tocSize;
-    fseek(f, 0, SEEK_SET);
+    _fseeki64(f, 0, SEEK_SET);
     fwrite(&header, sizeof(header), 1, f);
 
+    const bool writeOk = ferror(f) == 0;
     fclose(f);
+    base.reset(); // 出力先と同じファイルを開いている場合があるため、置き換える前に閉じる
+    std::error_code ec;
+    if (!writeOk || (fs::rename(tempPath, outputPath, ec), ec))
+    {
+        fprintf(stderr, "Error: Cannot write %s\n", outputPath.c_str());
+        fs::remove(tempPath, ec);
+        return 1;
+    }
 
-    printf("Packed %zu files into %s\n", entries.size(), outputPath.c_str());
-    if (compress) printf("  (LZ4 compression enabled)\n");
+    printf("Packed %zu files into %s (%u threads", entries.size(), outputPath.c_str(), threadCount);
+    if (!basePath.empty())
+        printf(", %u reused", reusedCount);
+    printf(")\n");
+    if (dedupCount > 0)
+        printf("  dedup    %u files share existing data, %llu bytes saved\n",
+               dedupCount, static_cast<unsigned long long>(dedupBytes));
+    if (patchBase)
+        printf("  in base  %u files, %llu bytes not stored\n",
+               inBaseCount, static_cast<unsigned long long>(inBaseBytes));
+    for (int c = 0; c < gxfmt::k_GxpakCodecCount; ++c)
+    {
+        if (codecCounts[c] > 0)
+            printf("  %-8s %u files, %llu bytes\n", CodecName(static_cast<gxfmt::GxpakCodec>(c)),
+                   codecCounts[c], static_cast<unsigned long long>(codecBytes[c]));
+    }
 
     return 0;
 }
@@ -198,48 +1071,104 @@ static int CmdPack(const std::string& outputPath, const std::string& inputDir, b
 // listコマンド: GXPAKの内容一覧を表示する
 // ============================================================
 
-static int CmdList(const std::string& inputPath)
+static int CmdList(const std::string& inputPath, const std::string& patchBasePath)
 {
-    FILE* f = fopen(inputPath.c_str(), "rb");
-    if (!f) { fprintf(stderr, "Error: Cannot open %s\n", inputPath.c_str()); return 1; }
+    PakReader pak;
+    if (!pak.Open(inputPath))
+        return 1;
+    std::unique_ptr<PakReader> base;
+    if (!OpenPatchBase(pak, patchBasePath, base))
+        return 1;
 
-    gxfmt::GxpakHeader header{};
-    fread(&header, sizeof(header), 1, f);
+    const auto& entries = pak.entries;
+    printf("GXPAK: %s\n", inputPath.c_str());
+    printf("  Version: %u, Entries: %u", pak.header.version, pak.header.entryCount);
+    if (!pak.dict.empty())
+        printf(", Dictionary: %zu bytes", pak.dict.size());
+    if (pak.IsPatch())
+        printf(", Patch of %016llx%s", static_cast<unsigned long long>(pak.tocHeader.basePackId),
+               base ? "" : " (base not given)");
+    printf("\n\n");
 
-    if (header.magic != gxfmt::k_GxpakMagic)
+    // 展開速度をコーデックごとに集計する
+    double decodeSeconds[gxfmt::k_GxpakCodecCount] = {};
+    uint64_t decodeBytes[gxfmt::k_GxpakCodecCount] = {};
+
+    for (uint32_t i = 0; i < entries.size(); ++i)
     {
-        fprintf(stderr, "Error: Not a GXPAK file\n");
-        fclose(f);
-        return 1;
-    }
+        const PakEntry& e = entries[i];
+        const bool inBase = (e.flags & gxfmt::k_GxpakEntryFlagInBase) != 0;
+        printf("  [%u] %-8s %s", i, AssetTypeName(e.assetType), e.path.c_str());
+        if (e.codec == gxfmt::GxpakCodec::None)
+        {
+            printf("  (%u bytes%s)\n", e.originalSize, inBase ? ", in base" : "");
+            continue;
+        }
 
-    printf("GXPAK: %s\n", inputPath.c_str());
-    printf("  Version: %u, Entries: %u\n\n", header.version, header.entryCount);
+        printf("  (%s, %u -> %u bytes, %.1f%%", CodecLabel(e.codec, e.level).c_str(), e.originalSize, e.compressedSize,
+               100.0f * e.compressedSize / (e.originalSize > 0 ? e.originalSize : 1));
+        if (inBase)
+            printf(", in base");
 
-    _fseeki64(f, static_cast<long long>(header.tocOffset), SEEK_SET);
+        // ベース内のデータはベースが指定されたときだけ計測する
+        PakReader* owner = inBase ? base.get() : &pak;
+        if (!owner)
+        {
+            printf(")\n");
+            continue;
+        }
+        std::vector<uint8_t> packed;
+        owner->ReadStored(e, packed);
+        double seconds = MeasureDecodeSeconds(*owner->decoder, e.codec, packed, e.originalSize);
+        if (seconds < 0.0)
+        {
+            printf(", DECODE FAILED)\n");
+            continue;
+        }
+        if (seconds > 0.0)
+            printf(", %.0f MB/s", e.originalSize / seconds / (1024.0 * 1024.0));
+        printf(")\n");
 
-    auto typeStr = [](gxfmt::GxpakAssetType t) -> const char* {
-        switch (t) {
-        case gxfmt::GxpakAssetType::Model: return "Model";
-        case gxfmt::GxpakAssetType::Animation: return "Anim";
-        case gxfmt::GxpakAssetType::Texture: return "Tex";
-        default: return "Other";
+        if (static_cast<int>(e.codec) < gxfmt::k_GxpakCodecCount)
+        {
+            decodeSeconds[static_cast<int>(e.codec)] += seconds;
+            decodeBytes[static_cast<int>(e.codec)] += e.originalSize;
         }
-    };
+    }
 
-    for (uint32_t i = 0; i < header.entryCount; ++i)
+    for (int c = 1; c < gxfmt::k_GxpakCodecCount; ++c)
     {
-        PakEntry e = ReadTocEntry(f);
-        printf("  [%u] %-8s %s", i, typeStr(e.assetType), e.path.c_str());
-        if (e.compressed)
-            printf("  (%u -> %u bytes, %.1f%%)", e.originalSize, e.compressedSize,
-                   100.0f * e.compressedSize / (e.originalSize > 0 ? e.originalSize : 1));
-        else
-            printf("  (%u bytes)", e.originalSize);
-        printf("\n");
+        if (decodeBytes[c] > 0 && decodeSeconds[c] > 0.0)
+            printf("\n  %s decode: %.0f MB/s (%llu bytes)", CodecName(static_cast<gxfmt::GxpakCodec>(c)),
+                   decodeBytes[c] / decodeSeconds[c] / (1024.0 * 1024.0),
+                   static_cast<unsigned long long>(decodeBytes[c]));
     }
+    printf("\n");
+
+    // 重複排除の集計: 同じデータ (同じ場所) を指すエントリをまとめる
+    std::unordered_map<uint64_t, uint32_t> refsByLocation[2];
+    uint32_t sharedFiles = 0, inBaseFiles = 0;
+    uint64_t savedBytes = 0, inBaseBytes = 0;
+    for (const auto& e : entries)
+    {
+        const bool inBase = (e.flags & gxfmt::k_GxpakEntryFlagInBase) != 0;
+        if (inBase)
+        {
+            ++inBaseFiles;
+            inBaseBytes += e.compressedSize;
+        }
+        if (++refsByLocation[inBase ? 1 : 0][e.dataOffset] > 1 && e.compressedSize > 0)
+        {
+            ++sharedFiles;
+            savedBytes += e.compressedSize;
+        }
+    }
+    if (sharedFiles > 0)
+        printf("  Dedup: %u files share data, %llu bytes saved\n",
+               sharedFiles, static_cast<unsigned long long>(savedBytes));
+    if (pak.IsPatch())
+        printf("  In base: %u files, %llu bytes\n", inBaseFiles, static_cast<unsigned long long>(inBaseBytes));
 
-    fclose(f);
     return 0;
 }
 
@@ -247,55 +1176,37 @@ static int CmdList(const std::string& inputPath)
 // unpackコマンド: GXPAKの全エントリをディレクトリに展開する
 // ============================================================
 
-static int CmdUnpack(const std::string& inputPath, const std::string& outputDir)
+static int CmdUnpack(const std::string& inputPath, const std::string& outputDir, const std::string& patchBasePath)
 {
-    FILE* f = fopen(inputPath.c_str(), "rb");
-    if (!f) { fprintf(stderr, "Error: Cannot open %s\n", inputPath.c_str()); return 1; }
-
-    gxfmt::GxpakHeader header{};
-    fread(&header, sizeof(header), 1, f);
-
-    if (header.magic != gxfmt::k_GxpakMagic)
+    PakReader pak;
+    if (!pak.Open(inputPath))
+        return 1;
+    std::unique_ptr<PakReader> base;
+    if (!OpenPatchBase(pak, patchBasePath, base))
+        return 1;
+    if (pak.IsPatch() && !base)
     {
-        fprintf(stderr, "Error: Not a GXPAK file\n");
-        fclose(f);
+        fprintf(stderr, "Error: %s is a patch; specify its base with --patch-base\n", inputPath.c_str());
         return 1;
     }
 
-    // Read TOC
-    _fseeki64(f, static_cast<long long>(header.tocOffset), SEEK_SET);
-    std::vector<PakEntry> entries;
-    for (uint32_t i = 0; i < header.entryCount; ++i)
-        entries.push_back(ReadTocEntry(f));
-
     // Extract each entry
-    for (auto& entry : entries)
+    for (auto& entry : pak.entries)
     {
         fs::path outPath = fs::path(outputDir) / entry.path;
         fs::create_directories(outPath.parent_path());
 
-        _fseeki64(f, static_cast<long long>(entry.dataOffset), SEEK_SET);
-        std::vector<uint8_t> rawData(entry.compressedSize);
-        fread(rawData.data(), 1, entry.compressedSize, f);
+        // ベース内のエントリはベースのデータと辞書で展開する
+        PakReader& owner = (entry.flags & gxfmt::k_GxpakEntryFlagInBase) ? *base : pak;
+        std::vector<uint8_t> rawData;
+        owner.ReadStored(entry, rawData);
 
-        std::vector<uint8_t> fileData;
-        if (entry.compressed)
-        {
-            fileData.resize(entry.originalSize);
-            int result = LZ4_decompress_safe(
-                reinterpret_cast<const char*>(rawData.data()),
-                reinterpret_cast<char*>(fileData.data()),
-                static_cast<int>(entry.compressedSize),
-                static_cast<int>(entry.originalSize));
-            if (result < 0)
-            {
-                fprintf(stderr, "Error: Failed to decompress %s\n", entry.path.c_str());
-                continue;
-            }
-        }
-        else
+        std::vector<uint8_t> fileData(entry.originalSize);
+        if (!owner.decoder->Decode(entry.codec, rawData.data(), entry.compressedSize,
+                                   fileData.data(), entry.originalSize))
         {
-            fileData = std::move(rawData);
+            fprintf(stderr, "Error: Failed to decompress %s (%s)\n", entry.path.c_str(), CodecName(entry.codec));
+            continue;
         }
 
         FILE* out = fopen(outPath.string().c_str(), "wb");
@@ -307,8 +1218,7 @@ static int CmdUnpack(const std::string& inputPath, const std::string& outputDir)
         }
     }
 
-    fclose(f);
-    printf("Unpacked %zu files to %s\n", entries.size(), outputDir.c_str());
+    printf("Unpacked %zu files to %s\n", pak.entries.size(), outputDir.c_str());
     return 0;
 }
 
@@ -328,7 +1238,7 @@ int main(int argc, char* argv[])
 
     // Parse arguments
     std::string inputPath, outputPath, dirPath, filePath, pakPath;
-    bool compress = false;
+    PackOptions options;
 
     for (int i = 2; i < argc; ++i)
     {
@@ -343,7 +1253,25 @@ int main(int argc, char* argv[])
         else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
             pakPath = argv[++i];
         else if (strcmp(argv[i], "--compress") == 0)
-            compress = true;
+            options.codec = "lz4";
+        else if (strcmp(argv[i], "--auto") == 0)
+            options.codec = "auto";
+        else if (strcmp(argv[i], "--codec") == 0 && i + 1 < argc)
+            options.codec = argv[++i];
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            options.level = (std::max)(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--dict-size") == 0 && i + 1 < argc)
+            options.dictSize = std::clamp<size_t>(strtoul(argv[++i], nullptr, 10), 1024, gxfmt::k_GxpakMaxDictSize);
+        else if (strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc)
+            options.bandwidthMBps = (std::max)(0.1, atof(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.threads = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--base") == 0 && i + 1 < argc)
+            options.basePath = argv[++i];
+        else if (strcmp(argv[i], "--incremental") == 0)
+            options.incremental = true;
+        else if (strcmp(argv[i], "--patch-base") == 0 && i + 1 < argc)
+            options.patchBasePath = argv[++i];
     }
 
     if (cmd == "pack")
@@ -353,12 +1281,19 @@ int main(int argc, char* argv[])
             fprintf(stderr, "Error: pack requires -o and -d\n");
             return 1;
         }
-        return CmdPack(outputPath, dirPath, compress);
+        static const char* const k_Codecs[] = { "none", "lz4", "lz4hc", "zstd", "lz4dict", "zstddict", "auto" };
+        if (std::none_of(std::begin(k_Codecs), std::end(k_Codecs),
+                         [&](const char* name) { return options.codec == name; }))
+        {
+            fprintf(stderr, "Error: Unknown codec: %s\n", options.codec.c_str());
+            return 1;
+        }
+        return CmdPack(outputPath, dirPath, options);
     }
     else if (cmd == "list")
     {
         if (inputPath.empty()) { fprintf(stderr, "Error: list requires -i\n"); return 1; }
-        return CmdList(inputPath);
+        return CmdList(inputPath, options.patchBasePath);
     }
     else if (cmd == "unpack")
     {
@@ -367,7 +1302,7 @@ int main(int argc, char* argv[])
             fprintf(stderr, "Error: unpack requires -i and -d\n");
             return 1;
         }
-        return CmdUnpack(inputPath, dirPath);
+        return CmdUnpack(inputPath, dirPath, options.patchBasePath);
     }
     else if (cmd == "add")
     {